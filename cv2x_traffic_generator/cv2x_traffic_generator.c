@@ -59,18 +59,24 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "srsran/mac/sl_sch.h"
 #include "srsran/phy/common/phy_common_sl.h"
 #include "srsran/phy/phch/pssch.h"
 #include "srsran/phy/phch/sci.h"
+#include "srsran/phy/resampling/channelizer.h"
 #include "srsran/phy/rf/rf.h"
 #include "srsran/phy/ue/ue_sync.h"
+#include "srsran/phy/utils/bit.h"
 #include "srsran/phy/utils/debug.h"
 #include "srsran/phy/utils/random.h"
+#include "srsran/phy/utils/sl_prof.h"
+#include "srsran/phy/utils/vec_alloc.h"
 #include "srsran/phy/utils/vector.h"
 #include "srsran/phy/ue/ue_sl.h"
 
 
 #define REP_INTERVL 100
+#define SL_SCH_LCID 1
 
 bool keep_running = true;
 bool debug_log = false;
@@ -80,6 +86,7 @@ typedef struct {
   bool   use_standard_lte_rates;
   char*  input_file_name;
   char*  log_file_name;
+  char*  prof_file_name;
   char*  rf_dev;
   char*  rf_args;
   double rf_freq;
@@ -90,6 +97,16 @@ typedef struct {
   uint32_t sub_channel_start_idx;
   uint32_t mcs_idx;
   uint32_t l_sub_channel;
+
+  // SL-SCH MAC PDU carried by every transport block
+  uint32_t src_id;
+  uint32_t sdu_len;
+  bool     seq_hdr;
+  uint16_t gen_id;
+
+  // Multi-carrier transmission
+  uint32_t nof_channels;
+  float    channel_spacing;
 } prog_args_t;
 
 typedef struct {
@@ -112,6 +129,7 @@ void args_default(prog_args_t* args)
   args->use_standard_lte_rates = false;
   args->input_file_name        = NULL;
   args->log_file_name          = NULL;
+  args->prof_file_name         = NULL;
   args->rf_dev                 = "";
   args->rf_args                = "";
   args->rf_freq                = 5.92e9;
@@ -120,6 +138,12 @@ void args_default(prog_args_t* args)
   args->mcs_idx                = 20;
   args->sub_channel_start_idx  = 0;
   args->l_sub_channel          = 2;
+  args->src_id                 = 1;
+  args->sdu_len                = 0;
+  args->seq_hdr                = false;
+  args->gen_id                 = 0;
+  args->nof_channels           = 1;
+  args->channel_spacing        = 10e6;
 }
 
 void sig_int_handler(int signo)
@@ -135,12 +159,17 @@ void sig_int_handler(int signo)
 
 void usage(prog_args_t* args, char* prog)
 {
-  fprintf(stdout, "Usage: %s [acdgilmnoprs] -f tx_frequency_hz -v verbose\n", prog);
+  fprintf(stdout, "Usage: %s [aBcdgHIiLlmnoprsWz] -f tx_frequency_hz -v verbose\n", prog);
   fprintf(stdout, "\t-a RF args [Default %s]\n", args->rf_args);
+  fprintf(stdout, "\t-B channel spacing in Hz for multi-carrier transmission [Default %.1f MHz]\n",
+          args->channel_spacing / 1e6);
   fprintf(stdout, "\t-c N_sl_id [Default %d]\n", cell_sl.N_sl_id);
   fprintf(stdout, "\t-d RF devicename [Default %s]\n", args->rf_dev);
   fprintf(stdout, "\t-g RF Gain [Default %.2f dB]\n", args->rf_gain);
+  fprintf(stdout, "\t-H generator ID, starts every transport block with a sequence header stamped at each transmission\n");
+  fprintf(stdout, "\t-I source Layer-2 ID of the first channel, the next channels count up [Default %d]\n", args->src_id);
   fprintf(stdout, "\t-i input_file_name for csv file containing sub_channel_start_idx and l_sub_channel.\n");
+  fprintf(stdout, "\t-L latency file, stage latency statistics published every second, e.g. /dev/shm/tg_prof\n");
   fprintf(stdout, "\t-l l_sub_channel [Default %d]. If input_file_name is specified this will be ignored.\n", args->l_sub_channel);
   fprintf(stdout, "\t-m mcs_idx [Default %d]\n", args->mcs_idx);
   fprintf(stdout, "\t-n num_sub_channel [Default for 50 prbs %d]\n", args->num_sub_channel);
@@ -148,6 +177,10 @@ void usage(prog_args_t* args, char* prog)
   fprintf(stdout, "\t-p nof_prb [Default %d]\n", cell_sl.nof_prb);
   fprintf(stdout, "\t-r use_standard_lte_rates [Default %i]\n", args->use_standard_lte_rates);
   fprintf(stdout, "\t-s sub_channel_start_idx [Default %d]. If input_file_name is specified this will be ignored.\n", args->sub_channel_start_idx);
+  fprintf(stdout, "\t-W number of adjacent channels transmitted around the TX frequency [Default %d]\n",
+          args->nof_channels);
+  fprintf(stdout, "\t-z MAC SDU size in bytes, 0 sends one SDU filling the transport block [Default %d]\n",
+          args->sdu_len);
   fflush(stdout);
 }
 
@@ -156,11 +189,14 @@ void parse_args(prog_args_t* args, int argc, char** argv)
   int opt;
   args_default(args);
 
-  while ((opt = getopt(argc, argv, "acdfgilmnoprsv")) != -1) {
+  while ((opt = getopt(argc, argv, "aBcdfgHIiLlmnoprsvWz")) != -1) {
     switch (opt) {
       case 'a':
         args->rf_args = argv[optind];
         break;
+      case 'B':
+        args->channel_spacing = strtof(argv[optind], NULL);
+        break;
       case 'c':
         cell_sl.N_sl_id = (int32_t)strtol(argv[optind], NULL, 10);
         break;
@@ -173,9 +209,19 @@ void parse_args(prog_args_t* args, int argc, char** argv)
       case 'g':
         args->rf_gain = strtof(argv[optind], NULL);
         break;
+      case 'H':
+        args->seq_hdr = true;
+        args->gen_id  = (uint16_t)strtol(argv[optind], NULL, 0);
+        break;
+      case 'I':
+        args->src_id = (uint32_t)strtol(argv[optind], NULL, 0);
+        break;
       case 'i':
         args->input_file_name = argv[optind];
         break;
+      case 'L':
+        args->prof_file_name = argv[optind];
+        break;
       case 'l':
         args->l_sub_channel = (uint32_t)strtol(argv[optind], NULL, 10);
         break;
@@ -200,6 +246,12 @@ void parse_args(prog_args_t* args, int argc, char** argv)
       case 'v':
         debug_log = true;
         break;
+      case 'W':
+        args->nof_channels = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'z':
+        args->sdu_len = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
 
       default:
         usage(args, argv[0]);
@@ -211,6 +263,21 @@ void parse_args(prog_args_t* args, int argc, char** argv)
     usage(args, argv[0]);
     exit(-1);
   }
+  if (args->nof_channels == 0 || args->nof_channels > SRSRAN_CHANNELIZER_MAX_CHANNELS) {
+    ERROR("Invalid number of channels %d\n", args->nof_channels);
+    usage(args, argv[0]);
+    exit(-1);
+  }
+  if (args->seq_hdr && args->sdu_len > 0 && args->sdu_len < SRSRAN_SL_SCH_SEQ_HDR_LEN) {
+    ERROR("The sequence header needs SDUs of at least %d bytes\n", SRSRAN_SL_SCH_SEQ_HDR_LEN);
+    usage(args, argv[0]);
+    exit(-1);
+  }
+  if (args->src_id + args->nof_channels - 1 > SRSRAN_SL_SCH_L2_ID_MASK) {
+    ERROR("Invalid source Layer-2 ID %d\n", args->src_id);
+    usage(args, argv[0]);
+    exit(-1);
+  }
 }
 
 void parse_input_file(char* filename, sf_config_t sf_config[REP_INTERVL], uint32_t num_subchannel)
@@ -294,6 +361,169 @@ void get_start_time(srsran_rf_t* rf, srsran_timestamp_t* t)
   srsran_timestamp_add(t, 0, 3 * 1e-3);
 }
 
+/* Digital upconversion of several carriers into one wideband subframe */
+typedef struct {
+  srsran_channelizer_synth_t synth;
+  uint32_t                   sf_len;   ///< Subframe length at the carrier rate
+  uint32_t                   delay;    ///< Group delay of the interpolation filter in carrier samples
+  cf_t*                      zeros;    ///< Flushes the interpolation filter at the end of a subframe
+  cf_t*                      wideband; ///< Synthesized subframe including the filter delay
+} wideband_tx_t;
+
+int wideband_tx_init(wideband_tx_t* q, prog_args_t* args, uint32_t sf_len, double srate, double* srate_rf)
+{
+  uint32_t nof_channels = args->nof_channels;
+  float    spacing      = args->channel_spacing;
+
+  // The burst covers all carriers plus one carrier bandwidth, same as the wideband receiver in pssch_ue
+  uint32_t interpolation = (uint32_t)ceil(((nof_channels - 1) * spacing + srate) / srate);
+  *srate_rf              = srate * interpolation;
+
+  float freq[SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    freq[k] = (float)(((float)k - (nof_channels - 1) / 2.0f) * spacing / *srate_rf);
+  }
+
+  // Pass the occupied band and reject the images between carriers
+  float occupied = cell_sl.nof_prb * SRSRAN_NRE * 15e3f;
+  if (srsran_channelizer_synth_init(&q->synth,
+                                    nof_channels,
+                                    freq,
+                                    interpolation,
+                                    (float)(spacing / 2.0 / *srate_rf),
+                                    (float)((spacing - occupied) / *srate_rf),
+                                    sf_len)) {
+    ERROR("Error initiating channel synthesizer\n");
+    return SRSRAN_ERROR;
+  }
+
+  q->sf_len   = sf_len;
+  q->delay    = srsran_channelizer_synth_get_delay(&q->synth);
+  q->zeros    = srsran_vec_cf_malloc(q->delay);
+  q->wideband = srsran_vec_cf_malloc((sf_len + q->delay) * interpolation);
+  if (!q->zeros || !q->wideband) {
+    return SRSRAN_ERROR;
+  }
+  srsran_vec_cf_zero(q->zeros, q->delay);
+
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    fprintf(stdout, "Channel %d: %.6f MHz\n", k, (args->rf_freq + freq[k] * *srate_rf) / 1e6);
+  }
+  fprintf(stdout,
+          "Wideband transmission of %d channels, interpolation %d, %d taps\n",
+          nof_channels,
+          interpolation,
+          q->synth.nof_taps);
+  fflush(stdout);
+
+  return SRSRAN_SUCCESS;
+}
+
+void wideband_tx_free(wideband_tx_t* q)
+{
+  if (q->zeros) {
+    free(q->zeros);
+  }
+  if (q->wideband) {
+    free(q->wideband);
+  }
+  srsran_channelizer_synth_free(&q->synth);
+}
+
+/* Synthesizes one subframe per carrier into output, which holds sf_len times the interpolation samples. Subframes are
+ * cached and sent as independent bursts, hence the filter starts from silence and its delay is removed, keeping the
+ * burst aligned to the subframe boundary. */
+int wideband_tx_synthesize(wideband_tx_t* q, const cf_t* input[SRSRAN_CHANNELIZER_MAX_CHANNELS], cf_t* output)
+{
+  uint32_t    interpolation                          = q->synth.interpolation;
+  const cf_t* zeros[SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
+  for (uint32_t k = 0; k < q->synth.nof_channels; k++) {
+    zeros[k] = q->zeros;
+  }
+
+  srsran_channelizer_synth_reset(&q->synth);
+  if (srsran_channelizer_synth_execute(&q->synth, input, q->wideband, q->sf_len) < 0 ||
+      srsran_channelizer_synth_execute(&q->synth, zeros, &q->wideband[q->sf_len * interpolation], q->delay) < 0) {
+    return SRSRAN_ERROR;
+  }
+
+  // Carriers add up, scale the sum to the amplitude of a single carrier
+  srsran_vec_sc_prod_cfc(
+      &q->wideband[q->delay * interpolation], 1.0f / q->synth.nof_channels, output, q->sf_len * interpolation);
+
+  return SRSRAN_SUCCESS;
+}
+
+/* Encodes the transport block of every carrier for subframe sf_idx into the burst sent for it */
+int encode_sf(srsran_ue_sl_t*    ue,
+              uint8_t*           tb[SRSRAN_CHANNELIZER_MAX_CHANNELS],
+              uint32_t           nof_channels,
+              const sf_config_t* sf_config,
+              uint32_t           sf_idx,
+              wideband_tx_t*     wideband,
+              cf_t*              output,
+              uint32_t           tx_len)
+{
+  srsran_pssch_data_t data = {};
+  srsran_sl_sf_cfg_t  sf   = {};
+  data.sub_channel_start_idx = sf_config->sub_channel_start_idx;
+  data.l_sub_channel         = sf_config->l_sub_channel;
+  sf.tti                     = sf_idx;
+
+  const cf_t* carrier[SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    data.ptr = tb[k];
+    if (srsran_ue_sl_encode(&ue[k], &sf, &data)) {
+      ERROR("Error encoding sidelink\n");
+      return SRSRAN_ERROR;
+    }
+    carrier[k] = ue[k].signal_buffer_tx;
+  }
+
+  // The wideband burst is cached like the single carrier subframe
+  if (nof_channels > 1) {
+    if (wideband_tx_synthesize(wideband, carrier, output)) {
+      ERROR("Error synthesizing wideband subframe\n");
+      return SRSRAN_ERROR;
+    }
+  } else {
+    memcpy(output, carrier[0], sizeof(cf_t) * tx_len);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+/* Transport blocks whose sequence header changes at every transmission. The MAC PDUs are kept packed, only the header
+ * is patched and the subframe re-encoded, once per repetition interval. */
+typedef struct {
+  uint16_t gen_id;
+  uint32_t seq[SRSRAN_CHANNELIZER_MAX_CHANNELS];
+  uint8_t* pdu[REP_INTERVL][SRSRAN_CHANNELIZER_MAX_CHANNELS];
+  uint32_t offset[REP_INTERVL][SRSRAN_CHANNELIZER_MAX_CHANNELS]; ///< Of the header in the PDU
+  uint32_t tb_len[REP_INTERVL][SRSRAN_CHANNELIZER_MAX_CHANNELS];
+  uint64_t tx_time_us[REP_INTERVL]; ///< Stamped in the cached burst, 0 if none
+} seq_tx_t;
+
+/* Stamps the next sequence number of every carrier and tx_time_us in subframe sf_idx and re-encodes its burst */
+int seq_tx_stamp(seq_tx_t*          q,
+                 srsran_ue_sl_t*    ue,
+                 uint8_t*           tb[SRSRAN_CHANNELIZER_MAX_CHANNELS],
+                 uint32_t           nof_channels,
+                 const sf_config_t* sf_config,
+                 uint32_t           sf_idx,
+                 uint64_t           tx_time_us,
+                 wideband_tx_t*     wideband,
+                 cf_t*              output,
+                 uint32_t           tx_len)
+{
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    srsran_sl_sch_seq_hdr_t hdr = {q->gen_id, q->seq[k]++, tx_time_us};
+    srsran_sl_sch_seq_hdr_pack(&hdr, &q->pdu[sf_idx][k][q->offset[sf_idx][k]]);
+    srsran_bit_unpack_vector(q->pdu[sf_idx][k], tb[k], q->tb_len[sf_idx][k]);
+  }
+  q->tx_time_us[sf_idx] = tx_time_us;
+  return encode_sf(ue, tb, nof_channels, sf_config, sf_idx, wideband, output, tx_len);
+}
+
 
 int main(int argc, char** argv)
 {
@@ -345,11 +575,17 @@ int main(int argc, char** argv)
     free(path);
   }
 
+  if (prog_args.prof_file_name && srsran_sl_prof_publish_init(prog_args.prof_file_name) != SRSRAN_SUCCESS) {
+    ERROR("Error creating latency file %s\n", prog_args.prof_file_name);
+    exit(-1);
+  }
+
   // write header
-  fprintf(logfile, "tx_timestamp_us,prb_start_idx,nof_prb,N_x_id,mcs_idx,rv_idx,sf_idx\n");
+  fprintf(logfile, "tx_timestamp_us,prb_start_idx,nof_prb,N_x_id,mcs_idx,rv_idx,sf_idx,channel_idx\n");
 
   /***** Init *******/
-  tx_metrics_t tx_metrics[REP_INTERVL] = {};
+  uint32_t            nof_channels                                          = prog_args.nof_channels;
+  static tx_metrics_t tx_metrics[REP_INTERVL][SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
 
   sf_config_t sf_config[REP_INTERVL] = {};
   // if input_file_name is specified, read values from file, else use prog_args values
@@ -388,41 +624,62 @@ int main(int argc, char** argv)
   fflush(stdout);
 
   int srate = srsran_sampling_freq_hz(cell_sl.nof_prb);
-  if (srate != -1) {
-    fprintf(stdout, "Setting sampling rate %.2f MHz\n", (float)srate / 1000000);
-    fflush(stdout);
-    float srate_rf = srsran_rf_set_tx_srate(&radio, (double)srate);
-    if (srate_rf != srate) {
-      ERROR("Could not set sampling rate\n");
-      exit(-1);
-    }
-  } else {
+  if (srate == -1) {
     ERROR("Invalid number of PRB %d\n", cell_sl.nof_prb);
     exit(-1);
   }
-  sleep(1);
+  uint32_t sf_len = SRSRAN_SF_LEN_PRB(cell_sl.nof_prb);
 
-  srsran_ue_sl_t srsue_vue_sl;
-  srsran_ue_sl_init(&srsue_vue_sl, cell_sl, sl_comm_resource_pool, 0);
+  // Several carriers are upconverted and summed into one burst at a multiple of the carrier rate
+  static wideband_tx_t wideband = {};
+  double               srate_tx = srate;
+  if (nof_channels > 1 && wideband_tx_init(&wideband, &prog_args, sf_len, srate, &srate_tx)) {
+    ERROR("Error initiating wideband transmission\n");
+    exit(-1);
+  }
+  uint32_t tx_len = (uint32_t)(srate_tx / 1000);
 
-  /***** prepare TX data *******/
-  srsran_set_sci(&srsue_vue_sl.sci_tx, 1, REP_INTERVL, 0, false, 0, 4);
+  fprintf(stdout, "Setting sampling rate %.2f MHz\n", srate_tx / 1000000);
+  fflush(stdout);
+  double srate_rf = srsran_rf_set_tx_srate(&radio, srate_tx);
+  if (srate_rf != srate_tx) {
+    ERROR("Could not set sampling rate\n");
+    exit(-1);
+  }
+  sleep(1);
 
-  // Randomize tx data to fill the transport block
-  // Transport block buffer
-  uint8_t tb[SRSRAN_SL_SCH_MAX_TB_LEN] = {};
-  struct timeval tv;
+  // Every carrier has its own sidelink UE and transport block, too large for the stack
+  static srsran_ue_sl_t srsue_vue_sl[SRSRAN_CHANNELIZER_MAX_CHANNELS];
+  static uint8_t        tb[SRSRAN_CHANNELIZER_MAX_CHANNELS][SRSRAN_SL_SCH_MAX_TB_LEN] = {};
+  static uint8_t        tb_bytes[SRSRAN_SL_SCH_MAX_TB_LEN / 8]                        = {};
+  static uint8_t        sdu_data[SRSRAN_SL_SCH_MAX_TB_LEN / 8]                        = {};
+  struct timeval        tv;
   gettimeofday(&tv, NULL);
   srsran_random_t random_gen = srsran_random_init(tv.tv_usec);
-  for (int i = 0; i < srsue_vue_sl.pssch_tx.sl_sch_tb_len; i++) {
-    tb[i] = srsran_random_uniform_int_dist(random_gen, 0, 1);
+
+  // Random SDU payload, shared by all SDUs
+  for (int i = 0; i < sizeof(sdu_data); i++) {
+    sdu_data[i] = (uint8_t)srsran_random_uniform_int_dist(random_gen, 0, 255);
   }
+  srsran_sl_sch_tx_t sl_sch_tx = srsran_sl_sch_tx_init();
 
-  srsran_pssch_data_t data;
-  data.ptr = tb;
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    if (srsran_ue_sl_init(&srsue_vue_sl[k], cell_sl, sl_comm_resource_pool, 0)) {
+      ERROR("Error initiating sidelink UE\n");
+      exit(-1);
+    }
 
-  srsran_sl_sf_cfg_t sf;
-  cf_t* signal_buffer_tx[REP_INTERVL] = {};
+    /***** prepare TX data *******/
+    srsran_set_sci(&srsue_vue_sl[k].sci_tx, 1, REP_INTERVL, 0, false, 0, 4);
+  }
+
+  cf_t*           signal_buffer_tx[REP_INTERVL]    = {};
+  uint8_t*        tb_ptr[SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
+  static seq_tx_t seq_tx                                = {};
+  seq_tx.gen_id                                         = prog_args.gen_id;
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    tb_ptr[k] = tb[k];
+  }
 
   fprintf(stdout, "creating signal buffers...\n");
   fflush(stdout);
@@ -433,27 +690,70 @@ int main(int argc, char** argv)
         fprintf(stdout, "signal_buffer %d\n", sf_idx);
         fflush(stdout);
       }
-      signal_buffer_tx[sf_idx] = srsran_vec_cf_malloc(srsue_vue_sl.sf_len);
+      signal_buffer_tx[sf_idx] = srsran_vec_cf_malloc(tx_len);
       if (!signal_buffer_tx[sf_idx]) {
         perror("malloc");
         exit(-1);
       }
 
-      data.sub_channel_start_idx = sf_config[sf_idx].sub_channel_start_idx;
-      data.l_sub_channel         = sf_config[sf_idx].l_sub_channel;
+      for (uint32_t k = 0; k < nof_channels; k++) {
+        // Fill the transport block with a MAC PDU from the source ID of this channel
+        uint32_t tb_len   = srsran_ue_sl_get_tbs(&srsue_vue_sl[k], sf_config[sf_idx].l_sub_channel);
+        int      nof_sdus = srsran_sl_sch_tx_build(sl_sch_tx,
+                                              prog_args.src_id + k,
+                                              SRSRAN_SL_SCH_DST_BROADCAST,
+                                              SL_SCH_LCID,
+                                              sdu_data,
+                                              prog_args.sdu_len,
+                                              tb_bytes,
+                                              tb_len / 8);
+        if (nof_sdus < 0) {
+          ERROR("Error building SL-SCH PDU of %d bytes\n", tb_len / 8);
+          exit(-1);
+        }
+        srsran_bit_unpack_vector(tb_bytes, tb[k], tb_len);
+        if (debug_log) {
+          fprintf(stdout, "SL-SCH: SRC=0x%06x, %d SDUs in %d bytes\n", prog_args.src_id + k, nof_sdus, tb_len / 8);
+        }
 
-      sf.tti = sf_idx;
-      if (srsran_ue_sl_encode(&srsue_vue_sl, &sf, &data)) {
-        ERROR("Error encoding sidelink\n");
-        exit(-1);
+        // Keep the PDU to stamp its header before every transmission
+        if (prog_args.seq_hdr) {
+          uint32_t sdu_len = 0;
+          int      offset  = srsran_sl_sch_first_sdu(tb_bytes, tb_len / 8, &sdu_len);
+          if (offset < 0 || sdu_len < SRSRAN_SL_SCH_SEQ_HDR_LEN) {
+            ERROR("No room for the sequence header in a transport block of %d bytes\n", tb_len / 8);
+            exit(-1);
+          }
+          seq_tx.pdu[sf_idx][k] = srsran_vec_u8_malloc(tb_len / 8);
+          if (!seq_tx.pdu[sf_idx][k]) {
+            perror("malloc");
+            exit(-1);
+          }
+          memcpy(seq_tx.pdu[sf_idx][k], tb_bytes, tb_len / 8);
+          seq_tx.offset[sf_idx][k] = (uint32_t)offset;
+          seq_tx.tb_len[sf_idx][k] = tb_len;
+        }
       }
 
-      write_tx_metrics(&srsue_vue_sl, &tx_metrics[sf_idx], sf_idx);
-
-      memcpy(signal_buffer_tx[sf_idx], srsue_vue_sl.signal_buffer_tx, sizeof(cf_t) * srsue_vue_sl.sf_len);
+      if (encode_sf(srsue_vue_sl,
+                    tb_ptr,
+                    nof_channels,
+                    &sf_config[sf_idx],
+                    sf_idx,
+                    &wideband,
+                    signal_buffer_tx[sf_idx],
+                    tx_len)) {
+        exit(-1);
+      }
+      for (uint32_t k = 0; k < nof_channels; k++) {
+        write_tx_metrics(&srsue_vue_sl[k], &tx_metrics[sf_idx][k], sf_idx);
+      }
     }
   }
 
+  srsran_sl_sch_tx_free(sl_sch_tx);
+  srsran_vec_alloc_fprint_stats(stdout);
+
   /***** timing *******/
   srsran_timestamp_t start_time, tx_time, now;
 
@@ -474,6 +774,7 @@ int main(int argc, char** argv)
       ERROR("tx_time is in the past (tx_time: %f, now: %f). Setting new start time.\n",
             srsran_timestamp_real(&tx_time), srsran_timestamp_real(&now));
       get_start_time(&radio, &start_time);
+      SRSRAN_SL_PROF_LATE();
 
       tx_sec_offset = 0;
       tx_msec_offset = 0;
@@ -481,31 +782,71 @@ int main(int argc, char** argv)
     else {
 
       // only if data to transmit
-      if (sf_config[tx_msec_offset % REP_INTERVL].l_sub_channel > 0) {
+      uint32_t sf_idx = tx_msec_offset % REP_INTERVL;
+      if (sf_config[sf_idx].l_sub_channel > 0) {
+        uint64_t tx_time_us = (uint64_t)round(srsran_timestamp_real(&tx_time) * 1e6);
+
+        // Normally stamped one interval ahead, not in the first interval or after a new start time
+        if (prog_args.seq_hdr && seq_tx.tx_time_us[sf_idx] != tx_time_us &&
+            seq_tx_stamp(&seq_tx,
+                         srsue_vue_sl,
+                         tb_ptr,
+                         nof_channels,
+                         &sf_config[sf_idx],
+                         sf_idx,
+                         tx_time_us,
+                         &wideband,
+                         signal_buffer_tx[sf_idx],
+                         tx_len)) {
+          exit(-1);
+        }
 
+        SRSRAN_SL_PROF_START(t_send);
         int ret = srsran_rf_send_timed2(&radio,
-                                        signal_buffer_tx[tx_msec_offset % REP_INTERVL],
-                                        srsue_vue_sl.sf_len,
+                                        signal_buffer_tx[sf_idx],
+                                        tx_len,
                                         tx_time.full_secs,
                                         tx_time.frac_secs,
                                         true,
                                         true);
+        SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_TX_SEND, t_send);
         if (ret < 0) {
           ERROR("Error sending data: %d\n", ret);
         }
 
-        // write logfile
-        fprintf(logfile,"%lu,%d,%d,%d,%d,%d,%d\n",
-                (uint64_t) round(srsran_timestamp_real(&tx_time) * 1e6),
-                tx_metrics->pssch_prb_start_idx,
-                tx_metrics->pssch_nof_prb,
-                tx_metrics->pssch_N_x_id,
-                tx_metrics->pssch_mcs_idx,
-                tx_metrics->pssch_rv_idx,
-                tx_metrics->sf_idx % 10);
-
-        if (debug_log) {
-          print_tx_metrics(&tx_metrics[tx_msec_offset % REP_INTERVL]);
+        // write logfile, one line per carrier
+        SRSRAN_SL_PROF_START(t_log);
+        for (uint32_t k = 0; k < nof_channels; k++) {
+          tx_metrics_t* m = &tx_metrics[sf_idx][k];
+          fprintf(logfile,
+                  "%lu,%d,%d,%d,%d,%d,%d,%d\n",
+                  tx_time_us,
+                  m->pssch_prb_start_idx,
+                  m->pssch_nof_prb,
+                  m->pssch_N_x_id,
+                  m->pssch_mcs_idx,
+                  m->pssch_rv_idx,
+                  m->sf_idx % 10,
+                  k);
+
+          if (debug_log) {
+            print_tx_metrics(m);
+          }
+        }
+        SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_TX_LOG, t_log);
+
+        // Re-encode the burst for its next transmission while the radio sends the ones ahead
+        if (prog_args.seq_hdr && seq_tx_stamp(&seq_tx,
+                                              srsue_vue_sl,
+                                              tb_ptr,
+                                              nof_channels,
+                                              &sf_config[sf_idx],
+                                              sf_idx,
+                                              tx_time_us + REP_INTERVL * 1000,
+                                              &wideband,
+                                              signal_buffer_tx[sf_idx],
+                                              tx_len)) {
+          exit(-1);
         }
       }
 
@@ -513,18 +854,34 @@ int main(int argc, char** argv)
       if (tx_msec_offset == 1000) {
         tx_sec_offset++;
         tx_msec_offset = 0;
+        if (prog_args.prof_file_name) {
+          srsran_sl_prof_publish();
+        }
       }
     }
 
   }
 
   fclose(logfile);
+  if (prog_args.prof_file_name) {
+    // Last, partial, period
+    srsran_sl_prof_publish();
+  }
+  srsran_sl_prof_publish_free();
 
   srsran_rf_close(&radio);
-  srsran_ue_sl_free(&srsue_vue_sl);
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    srsran_ue_sl_free(&srsue_vue_sl[k]);
+  }
+  if (nof_channels > 1) {
+    wideband_tx_free(&wideband);
+  }
 
   for (int i = 0; i < REP_INTERVL; i++) {
     free(signal_buffer_tx[i]);
+    for (uint32_t k = 0; k < nof_channels; k++) {
+      free(seq_tx.pdu[i][k]);
+    }
   }
 
   return SRSRAN_SUCCESS;
@@ -70,6 +70,10 @@ struct quant_cfg_s;
 // UE Capabilities
 struct ue_eutra_cap_s;
 
+// Sidelink V2X
+struct sl_v2x_precfg_comm_pool_r14_s;
+struct sl_v2x_precfg_freq_info_r14_s;
+
 } // namespace rrc
 } // namespace asn1
 
@@ -134,6 +138,18 @@ mbsfn_sf_cfg_t    make_mbsfn_sf_cfg(const asn1::rrc::mbsfn_sf_cfg_s& sf_cfg);
 mcch_msg_t        make_mcch_msg(const asn1::rrc::mcch_msg_s& asn1_type);
 sib13_t           make_sib13(const asn1::rrc::sib_type13_r9_s& asn1_type);
 
+/***************************
+ *   Sidelink V2X Config
+ **************************/
+int  make_sl_comm_resource_pool(srsran_sl_comm_resource_pool_t*                   pool,
+                                const srsran_cell_sl_t&                           cell,
+                                const asn1::rrc::sl_v2x_precfg_comm_pool_r14_s& asn1_type);
+void to_asn1(asn1::rrc::sl_v2x_precfg_comm_pool_r14_s* asn1_type, const srsran_sl_comm_resource_pool_t& pool);
+int  make_sl_v2x_precfg_freq(srsran_sl_v2x_precfg_freq_t*                      cfg,
+                             const srsran_cell_sl_t&                           cell,
+                             const asn1::rrc::sl_v2x_precfg_freq_info_r14_s& asn1_type);
+void to_asn1(asn1::rrc::sl_v2x_precfg_freq_info_r14_s* asn1_type, const srsran_sl_v2x_precfg_freq_t& cfg);
+
 } // namespace srsran
 
 /************************
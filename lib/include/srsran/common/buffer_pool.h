@@ -23,8 +23,10 @@
 #define SRSRAN_BUFFER_POOL_H
 
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <pthread.h>
+#include <time.h>
 #include <stack>
 #include <string>
 #include <vector>
@@ -168,6 +170,374 @@ private:
   uint32_t               capacity;
 };
 
+/******************************************************************************
+ * Lock-free buffer pool
+ *
+ * Same interface as buffer_pool. Each thread keeps a small magazine of
+ * buffers per pool that only it fills, and only goes to the shared free list,
+ * a bounded MPMC queue, to refill an empty magazine or to drain a full one,
+ * half of it at a time. A buffer freed by another thread than the one that
+ * allocated it ends in the magazine of the freeing thread.
+ *
+ * A thread that finds the shared list empty takes the buffers it needs out of
+ * the magazines of the other threads, so buffers held by an idle thread are
+ * not lost to the rest. Magazines are returned to the shared list when their
+ * thread exits. Only a blocking allocate on an empty pool takes a lock, to
+ * sleep until a buffer is returned.
+ *
+ * Buffers are allocated in one array, the ownership test of deallocate() is
+ * an address range check instead of a search of the used list.
+ *****************************************************************************/
+
+// Threads using a lockfree_buffer_pool at the same time with their own magazine, the others use the shared list
+#define SRSRAN_LOCKFREE_POOL_MAX_THREADS 64
+
+// Index of the calling thread among the threads with a magazine, or -1. Released when the thread exits
+int lockfree_pool_thread_idx();
+
+// Highest index handed out so far plus one, the magazines from there on have never been used
+int lockfree_pool_nof_thread_idx();
+
+// Called by an exiting thread for every registered pool, with the index the thread is giving up
+typedef void (*lockfree_pool_flush_t)(void* pool, int thread_idx);
+void lockfree_pool_register(void* pool, lockfree_pool_flush_t flush);
+void lockfree_pool_unregister(void* pool);
+
+template <class buffer_t>
+class lockfree_buffer_pool
+{
+public:
+  lockfree_buffer_pool(int capacity_ = -1)
+  {
+    capacity = POOL_SIZE;
+    if (capacity_ > 0) {
+      capacity = (uint32_t)capacity_;
+    }
+
+    // Twice the capacity, so an enqueue never finds a cell still held by a slow dequeue
+    queue_mask = 1;
+    while (queue_mask < 2 * capacity) {
+      queue_mask <<= 1;
+    }
+    queue = new queue_cell_t[queue_mask];
+    for (uint32_t i = 0; i < queue_mask; i++) {
+      queue[i].seq.store(i, std::memory_order_relaxed);
+      queue[i].b = NULL;
+    }
+    queue_mask--;
+    enqueue_pos.store(0, std::memory_order_relaxed);
+    dequeue_pos.store(0, std::memory_order_relaxed);
+
+    magazines = new magazine_t[SRSRAN_LOCKFREE_POOL_MAX_THREADS];
+    for (uint32_t i = 0; i < SRSRAN_LOCKFREE_POOL_MAX_THREADS; i++) {
+      for (uint32_t j = 0; j < MAGAZINE_SIZE; j++) {
+        magazines[i].buffers[j].store(NULL, std::memory_order_relaxed);
+      }
+      magazines[i].top = 0;
+    }
+
+    storage = new buffer_t[capacity];
+    in_use  = new std::atomic<bool>[capacity];
+    for (uint32_t i = 0; i < capacity; i++) {
+      in_use[i].store(false, std::memory_order_relaxed);
+      queue_push(&storage[i]);
+    }
+
+    waiters.store(0);
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cv_not_empty, NULL);
+    lockfree_pool_register(this, flush_thread);
+  }
+
+  ~lockfree_buffer_pool()
+  {
+    lockfree_pool_unregister(this);
+    // Buffers still in use are freed as well
+    delete[] storage;
+    delete[] in_use;
+    delete[] magazines;
+    delete[] queue;
+    pthread_cond_destroy(&cv_not_empty);
+    pthread_mutex_destroy(&mutex);
+  }
+
+  void print_all_buffers()
+  {
+    uint32_t nof_used = 0;
+    for (uint32_t i = 0; i < capacity; i++) {
+      nof_used += in_use[i].load(std::memory_order_relaxed) ? 1 : 0;
+    }
+    printf("%d buffers in queue\n", nof_used);
+#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+    std::map<std::string, uint32_t> buffer_cnt;
+    for (uint32_t i = 0; i < capacity; i++) {
+      if (in_use[i].load(std::memory_order_relaxed)) {
+        buffer_cnt[strlen(storage[i].debug_name) ? storage[i].debug_name : "Undefined"]++;
+      }
+    }
+    std::map<std::string, uint32_t>::iterator it;
+    for (it = buffer_cnt.begin(); it != buffer_cnt.end(); it++) {
+      printf(" - %dx %s\n", it->second, it->first.c_str());
+    }
+#endif
+  }
+
+  // Approximate while other threads allocate or deallocate
+  uint32_t nof_available_pdus()
+  {
+    uint32_t n              = queue_size();
+    int      nof_thread_idx = lockfree_pool_nof_thread_idx();
+    for (int i = 0; i < nof_thread_idx; i++) {
+      for (uint32_t j = 0; j < MAGAZINE_SIZE; j++) {
+        n += magazines[i].buffers[j].load(std::memory_order_relaxed) != NULL ? 1 : 0;
+      }
+    }
+    return std::min(n, capacity);
+  }
+
+  bool is_almost_empty() { return nof_available_pdus() < capacity / 20; }
+
+  buffer_t* allocate(const char* debug_name = NULL, bool blocking = false)
+  {
+    buffer_t* b = try_allocate();
+
+    if (b == NULL && blocking) {
+      // Deallocations skip the magazines while someone waits. A buffer returned after the last attempt, to the shared
+      // list or to a magazine, is announced under the mutex, which is only released by the wait
+      waiters.fetch_add(1);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      pthread_mutex_lock(&mutex);
+      while ((b = try_allocate()) == NULL) {
+        pthread_cond_wait(&cv_not_empty, &mutex);
+      }
+      pthread_mutex_unlock(&mutex);
+      waiters.fetch_sub(1);
+    } else if (b == NULL) {
+      printf("Error - buffer pool is empty\n");
+
+#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+      print_all_buffers();
+#endif
+      return NULL;
+    }
+
+    in_use[b - storage].store(true, std::memory_order_relaxed);
+#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+    if (debug_name) {
+      strncpy(b->debug_name, debug_name, SRSRAN_BUFFER_POOL_LOG_NAME_LEN);
+      b->debug_name[SRSRAN_BUFFER_POOL_LOG_NAME_LEN - 1] = 0;
+    }
+#endif
+    return b;
+  }
+
+  bool deallocate(buffer_t* b)
+  {
+    if (b < storage || b >= storage + capacity) {
+      return false;
+    }
+    // Also rejects a second deallocation of the same buffer
+    if (!in_use[b - storage].exchange(false, std::memory_order_relaxed)) {
+      return false;
+    }
+
+    magazine_t* m = own_magazine();
+    if (m == NULL || waiters.load(std::memory_order_relaxed) > 0) {
+      queue_push(b);
+      notify_waiters();
+      return true;
+    }
+
+    if (m->top == MAGAZINE_SIZE) {
+      for (uint32_t i = MAGAZINE_SIZE / 2; i < MAGAZINE_SIZE; i++) {
+        buffer_t* drained = m->buffers[i].exchange(NULL, std::memory_order_acquire);
+        if (drained != NULL) {
+          queue_push(drained);
+        }
+      }
+      m->top = MAGAZINE_SIZE / 2;
+    }
+    // A sequentially consistent exchange, so that a thread starting a blocking allocate after the check of the
+    // waiters below finds the buffer when it searches the magazines
+    m->buffers[m->top++].exchange(b);
+    if (waiters.load() > 0) {
+      notify_waiters();
+    }
+    return true;
+  }
+
+private:
+  static const int      POOL_SIZE     = 4096;
+  static const uint32_t MAGAZINE_SIZE = 16;
+
+  // Bounded MPMC queue after D. Vyukov, each cell carries the position it can be written or read at next
+  struct queue_cell_t {
+    std::atomic<uint32_t> seq;
+    buffer_t*             b;
+  };
+
+  // Only the owner thread stores buffers, any thread may take them out with an exchange. Hence a slot below top can
+  // be empty, the slots from top on always are
+  struct magazine_t {
+    std::atomic<buffer_t*> buffers[MAGAZINE_SIZE];
+    uint32_t               top;         // Only read and written by the owner thread
+    uint8_t                padding[64]; // Keeps the magazines of two threads off the same cache line
+  };
+
+  magazine_t* own_magazine()
+  {
+    int idx = lockfree_pool_thread_idx();
+    return idx < 0 ? NULL : &magazines[idx];
+  }
+
+  void flush_magazine(magazine_t* m)
+  {
+    bool flushed = false;
+    for (uint32_t i = 0; i < m->top; i++) {
+      buffer_t* b = m->buffers[i].exchange(NULL, std::memory_order_acquire);
+      if (b != NULL) {
+        queue_push(b);
+        flushed = true;
+      }
+    }
+    m->top = 0;
+    if (flushed) {
+      notify_waiters();
+    }
+  }
+
+  // Takes a buffer out of the magazine of another thread, the shared list is empty
+  buffer_t* steal(const magazine_t* own)
+  {
+    int nof_thread_idx = lockfree_pool_nof_thread_idx();
+    for (int i = 0; i < nof_thread_idx; i++) {
+      magazine_t* m = &magazines[i];
+      if (m == own) {
+        continue;
+      }
+      for (uint32_t j = 0; j < MAGAZINE_SIZE; j++) {
+        if (m->buffers[j].load(std::memory_order_relaxed) != NULL) {
+          buffer_t* b = m->buffers[j].exchange(NULL, std::memory_order_acquire);
+          if (b != NULL) {
+            return b;
+          }
+        }
+      }
+    }
+    return NULL;
+  }
+
+  static void flush_thread(void* pool, int thread_idx)
+  {
+    lockfree_buffer_pool* q = (lockfree_buffer_pool*)pool;
+    q->flush_magazine(&q->magazines[thread_idx]);
+  }
+
+  // Called after returning buffers to the shared list, pairs with the fence of a blocking allocate
+  void notify_waiters()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) > 0) {
+      pthread_mutex_lock(&mutex);
+      pthread_cond_broadcast(&cv_not_empty);
+      pthread_mutex_unlock(&mutex);
+    }
+  }
+
+  void queue_push(buffer_t* b)
+  {
+    uint32_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    while (true) {
+      queue_cell_t* cell = &queue[pos & queue_mask];
+      int32_t       diff = (int32_t)(cell->seq.load(std::memory_order_acquire) - pos);
+      if (diff == 0) {
+        if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          cell->b = b;
+          cell->seq.store(pos + 1, std::memory_order_release);
+          return;
+        }
+      } else {
+        // Never full, a lower sequence is a dequeue of the previous lap still finishing
+        pos = enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  buffer_t* queue_pop()
+  {
+    uint32_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    while (true) {
+      queue_cell_t* cell = &queue[pos & queue_mask];
+      int32_t       diff = (int32_t)(cell->seq.load(std::memory_order_acquire) - (pos + 1));
+      if (diff == 0) {
+        if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          buffer_t* b = cell->b;
+          cell->seq.store(pos + queue_mask + 1, std::memory_order_release);
+          return b;
+        }
+      } else if (diff < 0) {
+        return NULL;
+      } else {
+        pos = dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  uint32_t queue_size()
+  {
+    int32_t n = (int32_t)(enqueue_pos.load(std::memory_order_relaxed) - dequeue_pos.load(std::memory_order_relaxed));
+    return n > 0 ? (uint32_t)n : 0;
+  }
+
+  buffer_t* try_allocate()
+  {
+    magazine_t* m = own_magazine();
+    buffer_t*   b = NULL;
+    if (m == NULL) {
+      b = queue_pop();
+    } else {
+      while (m->top > 0) {
+        b = m->buffers[--m->top].exchange(NULL, std::memory_order_acquire);
+        if (b != NULL) {
+          return b;
+        }
+      }
+
+      // Refill half of the magazine from the shared list
+      b = queue_pop();
+      for (uint32_t i = 0; b != NULL && i < MAGAZINE_SIZE / 2; i++) {
+        buffer_t* next = queue_pop();
+        if (next == NULL) {
+          break;
+        }
+        m->buffers[m->top++].store(next, std::memory_order_release);
+      }
+    }
+
+    if (b == NULL) {
+      b = steal(m);
+    } else if (queue_size() < capacity / 20 && is_almost_empty()) {
+      printf("Warning buffer pool capacity is %f %%\n", (float)100 * nof_available_pdus() / capacity);
+    }
+    return b;
+  }
+
+  uint32_t               capacity;
+  buffer_t*              storage;
+  std::atomic<bool>*     in_use;
+  magazine_t*            magazines;
+  queue_cell_t*          queue;
+  uint32_t               queue_mask;
+  uint8_t                padding0[64];
+  std::atomic<uint32_t>  enqueue_pos;
+  uint8_t                padding1[64];
+  std::atomic<uint32_t>  dequeue_pos;
+  uint8_t                padding2[64];
+  std::atomic<uint32_t>  waiters;
+  pthread_mutex_t        mutex;
+  pthread_cond_t         cv_not_empty;
+};
+
 class byte_buffer_pool
 {
 public:
@@ -178,7 +548,7 @@ public:
   byte_buffer_pool(int capacity = -1)
   {
     log  = NULL;
-    pool = new buffer_pool<byte_buffer_t>(capacity);
+    pool = new lockfree_buffer_pool<byte_buffer_t>(capacity);
   }
   byte_buffer_pool(const byte_buffer_pool& other) = delete;
   byte_buffer_pool& operator=(const byte_buffer_pool& other) = delete;
@@ -215,7 +585,7 @@ public:
 
 private:
   srsran::log*                log;
-  buffer_pool<byte_buffer_t>* pool;
+  lockfree_buffer_pool<byte_buffer_t>* pool;
 };
 
 inline void byte_buffer_deleter::operator()(byte_buffer_t* buf) const
@@ -100,6 +100,20 @@ constexpr bool is_sdu(mch_lcid v)
   return v < mch_lcid::MCH_SCHED_INFO;
 }
 
+/* 3GPP 36.321 Table 6.2.1-3 */
+enum class sl_sch_lcid {
+  RESERVED = 0b00000,
+  //...
+  LCID_MAX = 0b01010,
+  //...
+  PADDING = 0b11111
+};
+const char*    to_string(sl_sch_lcid v);
+constexpr bool is_sdu(sl_sch_lcid v)
+{
+  return v > sl_sch_lcid::RESERVED and v <= sl_sch_lcid::LCID_MAX;
+}
+
 /* Common LCID type */
 struct lcid_t {
   enum class ch_type { dl_sch, ul_sch, mch } type;
@@ -468,6 +482,36 @@ private:
   }
 };
 
+/* SL-SCH MAC PDU for V2X, Section 6.1.6 of 36.321. The SL-SCH subheader (V/R/R/R/R/SRC/DST) precedes the MAC
+ * subheaders, which have the UL-SCH format. Parsing does not copy, the SDU pointers refer to the parsed buffer. */
+class sl_sch_pdu : public sch_pdu
+{
+public:
+  const static uint32_t SL_SCH_SUBHEADER_LEN = 7; // 24-bit SRC and DST
+  const static uint8_t  V2X_VERSION          = 0b0011;
+
+  sl_sch_pdu(uint32_t max_subh, const log_ref& log_h_) : sch_pdu(max_subh, log_h_) {}
+
+  /* pdu_len_bytes includes the SL-SCH subheader */
+  void init_rx(uint32_t pdu_len_bytes);
+  void init_tx(byte_buffer_t* buffer, uint32_t pdu_len_bytes, uint32_t src_id_, uint32_t dst_id_);
+
+  /* Returns false if the PDU is not a V2X SL-SCH PDU or its subheader L fields do not add up to its length, leaving
+   * no subheaders */
+  bool     parse_packet(uint8_t* ptr);
+  uint8_t* write_packet(srsran::log_ref log);
+
+  uint8_t  get_version() { return version; }
+  uint32_t get_src_id() { return src_id; }
+  uint32_t get_dst_id() { return dst_id; }
+  void     fprint(FILE* stream);
+
+private:
+  uint8_t  version = V2X_VERSION;
+  uint32_t src_id  = 0;
+  uint32_t dst_id  = 0;
+};
+
 } // namespace srsran
 
 #endif // MACPDU_H
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         sl_sch.h
+ *
+ *  Description:  C interface to the V2X SL-SCH MAC PDU of srsran::sl_sch_pdu.
+ *                The builder writes protocol-valid PDUs from fixed size SDUs,
+ *                the parser reads decoded transport blocks in place and counts
+ *                them per source Layer-2 ID. A sequence header at the start of
+ *                the first SDU lets the receiver measure loss, reordering and
+ *                one-way latency per source.
+ *
+ *  Reference:    3GPP TS 36.321 version 14.3.0 Release 14 Sec. 6.1.6
+ *****************************************************************************/
+
+#ifndef SRSRAN_SL_SCH_H
+#define SRSRAN_SL_SCH_H
+
+#include "srsran/config.h"
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SRSRAN_SL_SCH_L2_ID_MASK (0xffffff)
+#define SRSRAN_SL_SCH_DST_BROADCAST (0xffffff)
+
+#define SRSRAN_SL_SCH_SEQ_HDR_LEN 16
+#define SRSRAN_SL_SCH_LAT_NOF_BINS 64
+
+typedef void* srsran_sl_sch_tx_t;
+typedef void* srsran_sl_sch_rx_t;
+
+/* Written by the traffic generator in front of the payload of the first SDU, big endian after a magic and version */
+typedef struct SRSRAN_API {
+  uint16_t gen_id;
+  uint32_t seq;
+  uint64_t tx_time_us;
+} srsran_sl_sch_seq_hdr_t;
+
+typedef struct SRSRAN_API {
+  uint32_t src_id;
+  uint64_t nof_pdus;
+  uint64_t nof_sdus;
+  uint64_t nof_sdu_bytes;
+
+  // Sequence headers, only counted when enabled with srsran_sl_sch_rx_enable_seq()
+  uint16_t gen_id;
+  uint64_t nof_seq;
+  uint64_t nof_lost; ///< Sequence numbers skipped, less the ones received late
+  uint64_t nof_reordered;
+  uint64_t nof_duplicated;
+  uint32_t max_seq;
+  int64_t  lat_min_us;
+  int64_t  lat_max_us;
+  int64_t  lat_sum_us;
+  uint64_t lat_hist[SRSRAN_SL_SCH_LAT_NOF_BINS]; ///< Negative latencies in the first bin, too large in the last one
+} srsran_sl_sch_src_stats_t;
+
+SRSRAN_API srsran_sl_sch_tx_t srsran_sl_sch_tx_init(void);
+
+SRSRAN_API void srsran_sl_sch_tx_free(srsran_sl_sch_tx_t q);
+
+/* Writes a PDU of pdu_len bytes with as many SDUs of sdu_len bytes on logical channel lcid as fit, all carrying
+ * sdu_data, followed by padding. An sdu_len of 0 sends a single SDU filling the PDU, taken from the first pdu_len
+ * bytes of sdu_data. Returns the number of SDUs or SRSRAN_ERROR. */
+SRSRAN_API int srsran_sl_sch_tx_build(srsran_sl_sch_tx_t q,
+                                      uint32_t           src_id,
+                                      uint32_t           dst_id,
+                                      uint32_t           lcid,
+                                      const uint8_t*     sdu_data,
+                                      uint32_t           sdu_len,
+                                      uint8_t*           pdu,
+                                      uint32_t           pdu_len);
+
+/* Offset of the payload of the first SDU of a PDU, whose length is written to sdu_len. SRSRAN_ERROR if there is none */
+SRSRAN_API int srsran_sl_sch_first_sdu(const uint8_t* pdu, uint32_t pdu_len, uint32_t* sdu_len);
+
+SRSRAN_API void srsran_sl_sch_seq_hdr_pack(const srsran_sl_sch_seq_hdr_t* hdr, uint8_t* buffer);
+
+/* Returns SRSRAN_ERROR if the buffer does not start with a sequence header */
+SRSRAN_API int srsran_sl_sch_seq_hdr_unpack(const uint8_t* buffer, uint32_t len, srsran_sl_sch_seq_hdr_t* hdr);
+
+SRSRAN_API srsran_sl_sch_rx_t srsran_sl_sch_rx_init(uint32_t max_sources);
+
+SRSRAN_API void srsran_sl_sch_rx_free(srsran_sl_sch_rx_t q);
+
+/* Parses a decoded transport block without copying it and updates the counters of its source. Returns the source
+ * index in the statistics, or SRSRAN_ERROR if the PDU is not valid or its source does not fit in the table. */
+SRSRAN_API int srsran_sl_sch_rx_parse(srsran_sl_sch_rx_t q, uint8_t* pdu, uint32_t pdu_len);
+
+/* Reads the sequence header of the PDUs parsed next. Latencies are histogrammed in bins of lat_bin_us */
+SRSRAN_API void srsran_sl_sch_rx_enable_seq(srsran_sl_sch_rx_t q, uint32_t lat_bin_us);
+
+/* Reception time of the PDUs parsed next, the latency is measured against the TX time of their sequence header */
+SRSRAN_API void srsran_sl_sch_rx_set_time(srsran_sl_sch_rx_t q, uint64_t rx_time_us);
+
+/* Latency below which a fraction p of the sequence headers of a source were received, to the upper bin edge */
+SRSRAN_API int64_t srsran_sl_sch_rx_get_lat_percentile(srsran_sl_sch_rx_t               q,
+                                                      const srsran_sl_sch_src_stats_t* s,
+                                                      float                            p);
+
+/* Points stats to the per-source counters, in order of first reception, and returns how many there are */
+SRSRAN_API uint32_t srsran_sl_sch_rx_get_stats(srsran_sl_sch_rx_t q, const srsran_sl_sch_src_stats_t** stats);
+
+/* PDUs that were not V2X SL-SCH PDUs or carried a malformed MAC header */
+SRSRAN_API uint64_t srsran_sl_sch_rx_get_nof_invalid(srsran_sl_sch_rx_t q);
+
+/* Valid PDUs dropped because the source table was full */
+SRSRAN_API uint64_t srsran_sl_sch_rx_get_nof_overflow(srsran_sl_sch_rx_t q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SRSRAN_SL_SCH_H
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 
+#include "srsran/phy/ch_estimation/wiener_sl.h"
 #include "srsran/phy/common/phy_common_sl.h"
 #include "srsran/phy/resampling/interp.h"
 
@@ -36,12 +37,20 @@
 #define SRSRAN_SL_BASE_SEQUENCE_NUMBER 0
 #define SRSRAN_SL_MAX_DMRS_PERIOD_LENGTH 320
 
+typedef enum SRSRAN_API {
+  SRSRAN_SL_ESTIMATOR_ALG_LS = 0, ///< LS estimates averaged over each half of the subframe
+  SRSRAN_SL_ESTIMATOR_ALG_WIENER, ///< LS estimates filtered in frequency and time, see wiener_sl.h
+} srsran_chest_sl_estimator_alg_t;
+
 typedef struct SRSRAN_API {
   uint32_t prb_start_idx; // PRB start idx to map RE from RIV
   uint32_t nof_prb;       // PSSCH nof_prb, Length of continuous PRB to map RE (in the pool) from RIV
   uint32_t N_x_id;
   uint32_t sf_idx; // PSSCH sf_idx
   uint32_t cyclic_shift;
+
+  // PSCCH and PSSCH, only used by srsran_chest_sl_ls_estimate_equalize_symbols()
+  srsran_chest_sl_estimator_alg_t estimator_alg;
 } srsran_chest_sl_cfg_t;
 
 typedef struct SRSRAN_API {
@@ -78,13 +87,19 @@ typedef struct SRSRAN_API {
 
   cf_t* r_sequence_rx[SRSRAN_SL_MAX_DMRS_SYMB];
 
-  cf_t* ce;
-  cf_t* ce_average;
-  cf_t* noise_tmp;
-  float noise_estimated;
+  cf_t*  ce;
+  cf_t*  ce_average;
+  cf_t*  noise_tmp;
+  float  noise_estimated;
+  float* combining_gain; // Sum over the receive ports of |h|^2 at every data RE
 
   srsran_interp_linsrsran_vec_t lin_vec_sl;
 
+  srsran_wiener_sl_t* wiener_sl;
+  uint32_t            wiener_snr_bin;     // Bins used by the last Wiener estimation
+  uint32_t            wiener_doppler_bin;
+  float               wiener_phase_rad;   // Phase drift per symbol, from a residual frequency offset
+
   bool  sync_error_enable;
   bool  rsrp_enable;
   float sync_err;
@@ -117,6 +132,39 @@ SRSRAN_API void srsran_chest_sl_ls_equalize(srsran_chest_sl_t* q, cf_t* sf_buffe
 
 SRSRAN_API void srsran_chest_sl_ls_estimate_equalize(srsran_chest_sl_t* q, cf_t* sf_buffer, cf_t* equalized_sf_buffer);
 
+/**
+ * Single pass LS estimation, interpolation, noise estimation and MMSE equalization of the PSCCH or PSSCH allocation.
+ * Gives the same result as srsran_chest_sl_ls_estimate_equalize() followed by srsran_pscch_get() or srsran_pssch_get(),
+ * without the intermediate subframe sized buffers: the equalized data REs are written straight into scfdma_symbols, in
+ * SC-FDMA symbol order, followed by the zeroed last symbol. The estimates in q->ce are not updated, q->noise_estimated
+ * and, if q->rsrp_enable, q->rsrp_corr are.
+ *
+ * With the SRSRAN_SL_ESTIMATOR_ALG_WIENER estimator the LS estimates of every DMRS symbol are Wiener filtered in
+ * frequency and every data symbol gets its own Wiener combination of them, for the SNR given by the noise estimate and
+ * the Doppler given by the correlation between DMRS symbols. q->ce then holds the filtered estimates of the DMRS
+ * symbols, M REs each.
+ *
+ * @return number of data REs written, SRSRAN_ERROR for the PSBCH
+ */
+SRSRAN_API int
+srsran_chest_sl_ls_estimate_equalize_symbols(srsran_chest_sl_t* q, cf_t* sf_buffer, cf_t* scfdma_symbols);
+
+/**
+ * Same as srsran_chest_sl_ls_estimate_equalize_symbols() for nof_ports receive antennas, one resource grid each. Every
+ * port is estimated on its own and the data REs are maximum ratio combined,
+ *
+ *   x = sum_p conj(h_p) y_p / (sum_p |h_p|^2 + noise)
+ *
+ * with the noise averaged over the ports, which reduces to the single port MMSE equalizer for nof_ports = 1. Leaves
+ * q->noise_estimated and q->rsrp_corr averaged over the ports, and q->ce and the Wiener bins of the last port.
+ *
+ * @return number of data REs written, SRSRAN_ERROR for the PSBCH
+ */
+SRSRAN_API int srsran_chest_sl_ls_estimate_equalize_symbols_multi(srsran_chest_sl_t* q,
+                                                                  cf_t*              sf_buffer[SRSRAN_MAX_PORTS],
+                                                                  uint32_t           nof_ports,
+                                                                  cf_t*              scfdma_symbols);
+
 SRSRAN_API void srsran_chest_sl_free(srsran_chest_sl_t* q);
 
 #endif
\ No newline at end of file
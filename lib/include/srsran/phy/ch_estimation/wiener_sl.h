@@ -0,0 +1,102 @@
+/*
+ * Copyright 2013-2019 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         wiener_sl.h
+ *
+ *  Description:  Wiener (MMSE) filters for the sidelink PSCCH and PSSCH
+ *                channel estimation.
+ *
+ *                The LS estimates of each DMRS symbol are filtered in
+ *                frequency with a sliding window of SRSRAN_WIENER_SL_NOF_TAPS
+ *                subcarriers, and the estimate of every symbol of the
+ *                subframe is then a combination of the filtered DMRS
+ *                symbols. Both filters assume unit channel power. The
+ *                frequency filter assumes an exponential power delay profile
+ *                and the time filter a Jakes Doppler spectrum. Their
+ *                coefficients are computed once, for every window length,
+ *                SNR bin and Doppler bin, so estimation reduces to
+ *                matrix-vector products.
+ *
+ *  Reference:
+ *****************************************************************************/
+
+#ifndef SRSRAN_WIENER_SL_H
+#define SRSRAN_WIENER_SL_H
+
+#include "srsran/config.h"
+#include "srsran/phy/common/phy_common.h"
+
+// Frequency window, one PRB. Allocations narrower than this use a window as wide as the allocation
+#define SRSRAN_WIENER_SL_NOF_TAPS (12U)
+
+// SNR bins from SRSRAN_WIENER_SL_SNR_MIN_DB in steps of SRSRAN_WIENER_SL_SNR_STEP_DB
+#define SRSRAN_WIENER_SL_NOF_SNR_BINS (12U)
+#define SRSRAN_WIENER_SL_SNR_MIN_DB (-6.0f)
+#define SRSRAN_WIENER_SL_SNR_STEP_DB (3.0f)
+
+#define SRSRAN_WIENER_SL_NOF_DOPPLER_BINS (8U)
+#define SRSRAN_WIENER_SL_MAX_DMRS_SYMB (4U)
+#define SRSRAN_WIENER_SL_MAX_SYMB (SRSRAN_CP_NORM_SF_NSYMB)
+
+// RMS delay spread of the frequency filter, about the EVA channel model
+#define SRSRAN_WIENER_SL_DEFAULT_DELAY_SPREAD_NS (360.0f)
+
+typedef struct SRSRAN_API {
+  float delay_spread_ns;
+
+  // freq[w - 1][(snr * w + row) * w + tap]: estimate of subcarrier row of a window of w subcarriers
+  cf_t* freq[SRSRAN_WIENER_SL_NOF_TAPS];
+
+  // Noise power gain of the frequency filter away from the band edges
+  float freq_noise_gain[SRSRAN_WIENER_SL_NOF_SNR_BINS];
+
+  // Symbols of the subframe and the DMRS among them
+  uint32_t nof_symbols;
+  uint32_t nof_dmrs;
+  uint32_t dmrs_l[SRSRAN_WIENER_SL_MAX_DMRS_SYMB];
+  float    doppler_hz[SRSRAN_WIENER_SL_NOF_DOPPLER_BINS];
+
+  // Correlation between two consecutive DMRS symbols for every Doppler bin
+  float dmrs_corr[SRSRAN_WIENER_SL_NOF_DOPPLER_BINS];
+
+  // Weight of every filtered DMRS symbol in the estimate of symbol l
+  float time[SRSRAN_WIENER_SL_NOF_DOPPLER_BINS][SRSRAN_WIENER_SL_NOF_SNR_BINS][SRSRAN_WIENER_SL_MAX_SYMB]
+            [SRSRAN_WIENER_SL_MAX_DMRS_SYMB];
+} srsran_wiener_sl_t;
+
+SRSRAN_API int srsran_wiener_sl_init(srsran_wiener_sl_t* q, float delay_spread_ns);
+
+/* Computes the time filters for the DMRS symbols dmrs_l of a subframe with nof_symbols symbols */
+SRSRAN_API int
+srsran_wiener_sl_set_symbols(srsran_wiener_sl_t* q, uint32_t nof_symbols, const uint32_t* dmrs_l, uint32_t nof_dmrs);
+
+SRSRAN_API uint32_t srsran_wiener_sl_snr_bin(float snr_db);
+
+/* Doppler bin whose correlation between consecutive DMRS symbols is the closest to corr */
+SRSRAN_API uint32_t srsran_wiener_sl_doppler_bin(srsran_wiener_sl_t* q, float corr);
+
+/* Filters len LS estimates in frequency. Away from the band edges this is a SIMD convolution with a single row */
+SRSRAN_API void srsran_wiener_sl_filter_freq(srsran_wiener_sl_t* q, uint32_t snr_bin, const cf_t* ls, cf_t* h, uint32_t len);
+
+SRSRAN_API void srsran_wiener_sl_free(srsran_wiener_sl_t* q);
+
+#endif // SRSRAN_WIENER_SL_H
@@ -71,6 +71,14 @@ SRSRAN_API int srsran_channel_fading_init(srsran_channel_fading_t* q, double sra
 
 SRSRAN_API void srsran_channel_fading_free(srsran_channel_fading_t* q);
 
+/**
+ * Writes the tap delays and relative powers of a 36.104 delay profile, at most SRSRAN_CHANNEL_FADING_MAXTAPS, and
+ * returns the number of taps
+ */
+SRSRAN_API uint32_t srsran_channel_fading_get_profile(srsran_channel_fading_model_t model,
+                                                      float*                        delay_ns,
+                                                      float*                        power_db);
+
 SRSRAN_API double srsran_channel_fading_execute(srsran_channel_fading_t* q,
                                                 const cf_t*              in,
                                                 cf_t*                    out,
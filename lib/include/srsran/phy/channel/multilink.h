@@ -0,0 +1,114 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSRAN_MULTILINK_H
+#define SRSRAN_MULTILINK_H
+
+#include <srsran/phy/channel/fading.h>
+#include <srsran/srsran.h>
+
+#define SRSRAN_CHANNEL_MULTILINK_MAX_LINKS 256
+#define SRSRAN_CHANNEL_MULTILINK_MAX_THREADS 16
+#define SRSRAN_CHANNEL_MULTILINK_NTERMS 16
+
+/* Maximum phase rotation of the fastest Doppler term between two tap updates */
+#define SRSRAN_CHANNEL_MULTILINK_MAX_PHASE_STEP 0.05f
+
+typedef struct {
+  srsran_channel_fading_model_t model;        // None, EPA, EVA, ETU delay profile
+  float                         doppler_hz;   // Maximum doppler, e.g. 1400 Hz for 250 km/h relative speed at 5.9 GHz
+  float                         delay_us;     // Propagation delay added to every tap
+  float                         path_loss_db; // Attenuation of the link
+} srsran_channel_multilink_cfg_t;
+
+/*
+ * Emulates many independent links received by one antenna. Every link filters its own input with a sum-of-sinusoids
+ * (Jakes) fading channel and all links are added together.
+ *
+ * The Doppler terms of all links are kept as unit phasors in one array, so that advancing the channel of every link
+ * by one tap update is a single pass of vector products and sums. Links are split among coworker threads, each thread
+ * generating the taps and filtering its own links into a partial output.
+ */
+typedef struct {
+  // Configuration parameters
+  double   srate;
+  uint32_t nof_links;
+  uint32_t nof_threads;
+  uint32_t max_nsamples; // Maximum number of samples per call
+  uint32_t block_len;    // Number of samples between tap updates, divides max_nsamples
+
+  // Tap parametrisation, the taps of every link hold SRSRAN_CHANNEL_FADING_MAXTAPS entries
+  srsran_channel_multilink_cfg_t cfg[SRSRAN_CHANNEL_MULTILINK_MAX_LINKS];
+  uint32_t                       nof_taps[SRSRAN_CHANNEL_MULTILINK_MAX_LINKS];
+  uint32_t*                      tap_delay; // Delay of every tap in samples, including the link delay
+  float*                         tap_gain;  // Amplitude of every tap, including the path loss
+  uint32_t                       max_delay; // Longest tap delay, length of the input history
+
+  // Doppler terms of every tap, as [term][link][tap] so that summing the terms is a vertical vector operation
+  float* a_re;   // Rotating phasors whose real part is the in-phase term
+  float* a_im;
+  float* b_re;   // Rotating phasors whose imaginary part is the quadrature term
+  float* b_im;
+  float* rot_re; // Rotation of every phasor over one block
+  float* rot_im;
+  float* h_re;   // Taps of the current block, as [link][tap]
+  float* h_im;
+
+  // State variables
+  cf_t*    history[SRSRAN_CHANNEL_MULTILINK_MAX_LINKS];   // Link input history followed by the new samples
+  cf_t*    partial[SRSRAN_CHANNEL_MULTILINK_MAX_THREADS]; // Sum of the links of every coworker thread
+  uint64_t nof_blocks;                                    // Number of tap updates so far
+
+  void* workers;
+} srsran_channel_multilink_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SRSRAN_API int srsran_channel_multilink_init(srsran_channel_multilink_t*           q,
+                                             double                                srate,
+                                             const srsran_channel_multilink_cfg_t* cfg,
+                                             uint32_t                              nof_links,
+                                             uint32_t                              max_nsamples,
+                                             uint32_t                              nof_threads,
+                                             uint32_t                              seed);
+
+SRSRAN_API void srsran_channel_multilink_free(srsran_channel_multilink_t* q);
+
+/*
+ * Filters the input of every link and writes the sum of all links. nsamples must be a multiple of block_len.
+ */
+SRSRAN_API int srsran_channel_multilink_execute(srsran_channel_multilink_t* q,
+                                                const cf_t**                in,
+                                                cf_t*                       out,
+                                                uint32_t                    nsamples);
+
+/*
+ * Returns the current tap coefficient of a link, mainly for testing
+ */
+SRSRAN_API cf_t srsran_channel_multilink_get_tap(srsran_channel_multilink_t* q, uint32_t link, uint32_t tap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SRSRAN_MULTILINK_H
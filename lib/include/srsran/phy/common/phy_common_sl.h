@@ -63,6 +63,8 @@ typedef struct SRSRAN_API {
 } srsran_cell_sl_t;
 
 #define SRSRAN_SL_MAX_PERIOD_LENGTH 320 // SL-PeriodComm-r12 3GPP TS 36.331 Section 6.3.8
+#define SRSRAN_SL_DFN_PERIOD 10240      // Subframes from DFN 0 to DFN 1023
+#define SRSRAN_SL_MAX_NOF_SLSS_OFFSET 3 // syncOffsetIndicator1-r14 to syncOffsetIndicator3-r14
 // SL-CommResourcePool: 3GPP TS 36.331 version 15.6.0 Release 15 Section 6.3.8
 typedef struct SRSRAN_API {
   uint32_t period_length;
@@ -81,6 +83,16 @@ typedef struct SRSRAN_API {
 
   uint32_t sf_bitmap_tm34_len;
   uint8_t  sf_bitmap_tm34[SRSRAN_SL_MAX_PERIOD_LENGTH]; // sl_Subframe_r14: 3GPP 36.331 Section 6.3.8
+
+  uint32_t sl_offset_ind;        // sl-OffsetIndicator-r14, first subframe of the pool after DFN 0
+  uint32_t start_prb_pscch_pool; // startRB-PSCCH-Pool-r14, only used without adjacency
+
+  // Subframes carrying SLSS are in no pool, they repeat every SRSRAN_SL_V2X_SLSS_PERIOD
+  uint32_t nof_slss_offset;
+  uint32_t slss_offset[SRSRAN_SL_MAX_NOF_SLSS_OFFSET];
+
+  // Subframes of the DFN period in the pool, one bit each, filled by srsran_sl_comm_resource_pool_update_sf_map()
+  uint8_t sf_map[SRSRAN_SL_DFN_PERIOD / 8];
 } srsran_sl_comm_resource_pool_t;
 
 typedef enum SRSRAN_API {
@@ -97,6 +109,8 @@ typedef enum SRSRAN_API {
 #define SRSRAN_SLSS_SIDE_PEAK_THRESHOLD_HIGH (0.49f) // square(0.7), max 70% of main peak
 #define SRSRAN_SLSS_SIDE_PEAK_THRESHOLD_LOW (0.09f)  // square(0.3), min 30% of main peak
 
+#define SRSRAN_SL_V2X_SLSS_PERIOD (160) ///< SLSS period in subframes, 3GPP TS 36.331 Section 5.10.7.3
+
 #define SRSRAN_MAX_NUM_SUB_CHANNEL (20)
 
 #define SRSRAN_PSBCH_NOF_PRB (6)
@@ -189,4 +203,32 @@ SRSRAN_API int srsran_sl_comm_resource_pool_set_cfg(srsran_sl_comm_resource_pool
                                                     uint32_t                        start_prb_sub_channel,
                                                     bool                            adjacency_pscch_pssch);
 
+/**
+ * Maps the TM3/TM4 subframe bitmap onto the subframes of the DFN period, 3GPP TS 36.213 Section 14.1.5. The SLSS
+ * subframes and the reserved subframes are left out and the bitmap repeats over the rest, starting at sl_offset_ind.
+ * Must be called after changing sf_bitmap_tm34, sl_offset_ind or the SLSS offsets.
+ */
+SRSRAN_API int srsran_sl_comm_resource_pool_update_sf_map(srsran_sl_comm_resource_pool_t* q);
+
+/* Checks that the sub-channels, and the PSCCH resources of a non adjacent pool, fit in the cell */
+SRSRAN_API bool srsran_sl_comm_resource_pool_is_valid(const srsran_sl_comm_resource_pool_t* q, srsran_cell_sl_t cell);
+
+/* Whether subframe tti, counted from DFN 0, belongs to the pool */
+static inline bool srsran_sl_comm_resource_pool_sf_in_pool(const srsran_sl_comm_resource_pool_t* q, uint32_t tti)
+{
+  uint32_t sf = tti % SRSRAN_SL_DFN_PERIOD;
+  return (q->sf_map[sf / 8] >> (sf % 8)) & 1;
+}
+
+/* First PRB of the PSCCH resource of a sub-channel, 3GPP TS 36.213 Section 14.2.4 */
+SRSRAN_API uint32_t srsran_sl_comm_resource_pool_get_pscch_prb(const srsran_sl_comm_resource_pool_t* q,
+                                                               uint32_t                              sub_channel_idx);
+
+/* PRBs of a PSSCH taking L_subCH sub-channels from sub_channel_idx on, 3GPP TS 36.213 Section 14.1.1.4C */
+SRSRAN_API void srsran_sl_comm_resource_pool_get_pssch_prb(const srsran_sl_comm_resource_pool_t* q,
+                                                           uint32_t                              sub_channel_idx,
+                                                           uint32_t                              L_subCH,
+                                                           uint32_t*                             prb_start_idx,
+                                                           uint32_t*                             nof_prb);
+
 #endif // SRSRAN_PHY_COMMON_SL_H
\ No newline at end of file
@@ -58,6 +58,9 @@ SRSRAN_API void srsran_sequence_apply_s(const int16_t* in, int16_t* out, uint32_
 
 SRSRAN_API void srsran_sequence_apply_c(const int8_t* in, int8_t* out, uint32_t length, uint32_t seed);
 
+// Scrambles length bits packed MSB first, the remaining bits of the last byte are copied
+SRSRAN_API void srsran_sequence_apply_packed(const uint8_t* in, uint8_t* out, uint32_t length, uint32_t seed);
+
 SRSRAN_API int srsran_sequence_pbch(srsran_sequence_t* seq, srsran_cp_t cp, uint32_t cell_id);
 
 SRSRAN_API int srsran_sequence_pcfich(srsran_sequence_t* seq, uint32_t nslot, uint32_t cell_id);
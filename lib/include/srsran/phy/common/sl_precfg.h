@@ -0,0 +1,73 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         sl_precfg.h
+ *
+ *  Description:  Sidelink V2X resource pools of one carrier, as carried by
+ *                SL-V2X-PreconfigFreqInfo-r14, and a text file holding them.
+ *
+ *                The file has one key = value per line and a [rx_pool] or
+ *                [tx_pool] section per pool, # starts a comment. Keys are
+ *                the SL-V2X-PreconfigCommPool-r14 field names:
+ *
+ *                  sync_offset_ind = 0, 80   # SLSS subframes, all pools
+ *                  [rx_pool]
+ *                  sl_offset_ind = 0
+ *                  sl_subframe = 1111111111
+ *                  adjacency_pscch_pssch = 1
+ *                  size_subchannel = 10
+ *                  num_subchannel = 5
+ *                  start_rb_subchannel = 0
+ *                  start_rb_pscch_pool = 0
+ *
+ *                Keys left out of a pool keep the default configuration of
+ *                the cell.
+ *
+ *  Reference:    3GPP TS 36.331 version 15.6.0 Release 15 Section 9.3
+ *****************************************************************************/
+
+#ifndef SRSRAN_SL_PRECFG_H
+#define SRSRAN_SL_PRECFG_H
+
+#include "srsran/config.h"
+#include "srsran/phy/common/phy_common_sl.h"
+
+#define SRSRAN_SL_MAX_NOF_RX_POOLS 16 // SL-PreconfigV2X-RxPoolList-r14
+#define SRSRAN_SL_MAX_NOF_TX_POOLS 8  // SL-PreconfigV2X-TxPoolList-r14
+
+typedef struct SRSRAN_API {
+  uint32_t                       nof_rx_pools;
+  srsran_sl_comm_resource_pool_t rx_pools[SRSRAN_SL_MAX_NOF_RX_POOLS];
+  uint32_t                       nof_tx_pools;
+  srsran_sl_comm_resource_pool_t tx_pools[SRSRAN_SL_MAX_NOF_TX_POOLS];
+} srsran_sl_v2x_precfg_freq_t;
+
+/* Reads the pools of a cell, the subframe maps are filled and every pool is checked against the cell */
+SRSRAN_API int
+srsran_sl_v2x_precfg_freq_read_file(srsran_sl_v2x_precfg_freq_t* q, srsran_cell_sl_t cell, const char* path);
+
+SRSRAN_API int srsran_sl_v2x_precfg_freq_write_file(const srsran_sl_v2x_precfg_freq_t* q, const char* path);
+
+/* Whether subframe tti belongs to any RX pool */
+SRSRAN_API bool srsran_sl_v2x_precfg_freq_sf_in_rx_pools(const srsran_sl_v2x_precfg_freq_t* q, uint32_t tti);
+
+#endif // SRSRAN_SL_PRECFG_H
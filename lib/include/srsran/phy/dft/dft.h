@@ -54,13 +54,14 @@ typedef struct SRSRAN_API {
   void*             out;       // Output buffer
   void*             p;         // DFT plan
   bool              is_guru;
-  bool              forward; // Forward transform?
-  bool              mirror;  // Shift negative and positive frequencies?
-  bool              db;      // Provide output in dB?
-  bool              norm;    // Normalize output?
-  bool              dc;      // Handle insertion/removal of null DC carrier internally?
-  srsran_dft_dir_t  dir;     // Forward/Backward
-  srsran_dft_mode_t mode;    // Complex/Real
+  int               how_many; // Number of consecutive transforms computed by a batch plan
+  bool              forward;  // Forward transform?
+  bool              mirror;   // Shift negative and positive frequencies?
+  bool              db;       // Provide output in dB?
+  bool              norm;     // Normalize output?
+  bool              dc;       // Handle insertion/removal of null DC carrier internally?
+  srsran_dft_dir_t  dir;      // Forward/Backward
+  srsran_dft_mode_t mode;     // Complex/Real
 } srsran_dft_plan_t;
 
 SRSRAN_API int srsran_dft_plan(srsran_dft_plan_t* plan, int dft_points, srsran_dft_dir_t dir, srsran_dft_mode_t type);
@@ -78,6 +79,8 @@ SRSRAN_API int srsran_dft_plan_guru_c(srsran_dft_plan_t* plan,
                                       int                idist,
                                       int                odist);
 
+SRSRAN_API int srsran_dft_plan_batch_c(srsran_dft_plan_t* plan, int dft_points, int how_many, srsran_dft_dir_t dir);
+
 SRSRAN_API int srsran_dft_plan_r(srsran_dft_plan_t* plan, int dft_points, srsran_dft_dir_t dir);
 
 SRSRAN_API int srsran_dft_replan(srsran_dft_plan_t* plan, const int new_dft_points);
@@ -118,6 +121,9 @@ SRSRAN_API void srsran_dft_run_c(srsran_dft_plan_t* plan, const cf_t* in, cf_t*
 
 SRSRAN_API void srsran_dft_run_guru_c(srsran_dft_plan_t* plan);
 
+/* Computes how_many transforms of consecutive blocks of dft_points samples. Only the norm option is applied */
+SRSRAN_API void srsran_dft_run_batch_c(srsran_dft_plan_t* plan, const cf_t* in, cf_t* out);
+
 SRSRAN_API void srsran_dft_run_r(srsran_dft_plan_t* plan, const float* in, float* out);
 
 #endif // SRSRAN_DFT_H
@@ -38,19 +38,31 @@
 /* DFT-based Transform Precoding object */
 typedef struct SRSRAN_API {
 
+  uint32_t          min_prb;
   uint32_t          max_prb;
+  bool              is_tx;
   srsran_dft_plan_t dft_plan[SRSRAN_MAX_PRB + 1];
 
+  // Plans transforming all nof_batch_symbols symbols of an allocation at once, one per planned number of PRB
+  srsran_dft_plan_t batch_plan[SRSRAN_MAX_PRB + 1];
+  uint32_t          nof_batch_symbols;
+
 } srsran_dft_precoding_t;
 
+// Plans every valid number of PRB up to max_prb
 SRSRAN_API int srsran_dft_precoding_init(srsran_dft_precoding_t* q, uint32_t max_prb, bool is_tx);
 
+// Plans nof_prb only, for a channel with a fixed allocation size
+SRSRAN_API int srsran_dft_precoding_init_nof_prb(srsran_dft_precoding_t* q, uint32_t nof_prb, bool is_tx);
+
 SRSRAN_API int srsran_dft_precoding_init_tx(srsran_dft_precoding_t* q, uint32_t max_prb);
 
 SRSRAN_API int srsran_dft_precoding_init_rx(srsran_dft_precoding_t* q, uint32_t max_prb);
 
 SRSRAN_API void srsran_dft_precoding_free(srsran_dft_precoding_t* q);
 
+SRSRAN_API int srsran_dft_precoding_set_nof_symbols(srsran_dft_precoding_t* q, uint32_t nof_symbols);
+
 SRSRAN_API bool srsran_dft_precoding_valid_prb(uint32_t nof_prb);
 
 SRSRAN_API uint32_t srsran_dft_precoding_get_valid_prb(uint32_t nof_prb);
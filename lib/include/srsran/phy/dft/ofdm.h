@@ -58,6 +58,7 @@ typedef struct SRSRAN_API {
   float       freq_shift_f;     //< Frequency shift, normalised by sampling rate (used in UL)
   float       rx_window_offset; //< DFT Window offset in CP portion (0-1), RX only
   uint32_t    symbol_sz;        //< Symbol size, forces a given symbol size for the number of PRB
+  bool        sidelink;         //< Sidelink subframe, its last symbol is a guard neither transformed nor transmitted
 } srsran_ofdm_cfg_t;
 
 /**
@@ -82,6 +83,8 @@ typedef struct SRSRAN_API {
   uint32_t          window_offset_n;
   cf_t*             shift_buffer;
   cf_t*             window_offset_buffer;
+  srsran_dft_plan_t fft_plan_sl; // All symbols of a sidelink subframe but the guard, in one batch
+  cf_t*             sl_shift;    // Frequency shift of one symbol without CP, preceded by the longest CP
 } srsran_ofdm_t;
 
 SRSRAN_API int srsran_ofdm_rx_init_cfg(srsran_ofdm_t* q, srsran_ofdm_cfg_t* cfg);
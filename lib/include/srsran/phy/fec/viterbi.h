@@ -34,6 +34,13 @@
 #include "srsran/config.h"
 #include <stdbool.h>
 
+// Frames decoded at once by srsran_viterbi_decode_s_batch(), one per 16-bit SIMD lane
+#ifdef LV_HAVE_AVX512
+#define SRSRAN_VITERBI_BATCH_MAX_FRAMES 32
+#else /* LV_HAVE_AVX512 */
+#define SRSRAN_VITERBI_BATCH_MAX_FRAMES 16
+#endif /* LV_HAVE_AVX512 */
+
 typedef enum { SRSRAN_VITERBI_27 = 0, SRSRAN_VITERBI_29, SRSRAN_VITERBI_37, SRSRAN_VITERBI_39 } srsran_viterbi_type_t;
 
 typedef struct SRSRAN_API {
@@ -52,6 +59,8 @@ typedef struct SRSRAN_API {
   uint16_t* tmp_s;
   uint8_t*  symbols_uc;
   uint16_t* symbols_us;
+  int       poly[3];
+  void*     ptr_batch;
 } srsran_viterbi_t;
 
 SRSRAN_API int srsran_viterbi_init(srsran_viterbi_t*     q,
@@ -60,6 +69,9 @@ SRSRAN_API int srsran_viterbi_init(srsran_viterbi_t*     q,
                                    uint32_t              max_frame_length,
                                    bool                  tail_bitting);
 
+// Allocates the multi-frame decoder of srsran_viterbi_decode_s_batch(), for a tail biting decoder of type 37
+SRSRAN_API int srsran_viterbi_init_batch(srsran_viterbi_t* q);
+
 SRSRAN_API void srsran_viterbi_set_gain_quant(srsran_viterbi_t* q, float gain_quant);
 
 SRSRAN_API void srsran_viterbi_set_gain_quant_s(srsran_viterbi_t* q, int16_t gain_quant);
@@ -72,6 +84,20 @@ SRSRAN_API int srsran_viterbi_decode_s(srsran_viterbi_t* q, int16_t* symbols, ui
 
 SRSRAN_API int srsran_viterbi_decode_us(srsran_viterbi_t* q, uint16_t* symbols, uint8_t* data, uint32_t frame_length);
 
+/**
+ * Decodes up to SRSRAN_VITERBI_BATCH_MAX_FRAMES tail biting frames of the same length at once, one frame per SIMD
+ * lane, as the PSCCH candidates of a subframe. The lanes use the arithmetic of the 16-bit decoder behind
+ * srsran_viterbi_decode_s(). A handful of frames, or any number without srsran_viterbi_init_batch(), is simply decoded
+ * one by one.
+ *
+ * @return frame_length on success, SRSRAN_ERROR otherwise
+ */
+SRSRAN_API int srsran_viterbi_decode_s_batch(srsran_viterbi_t* q,
+                                             int16_t**         symbols,
+                                             uint8_t**         data,
+                                             uint32_t          nof_frames,
+                                             uint32_t          frame_length);
+
 SRSRAN_API int srsran_viterbi_decode_uc(srsran_viterbi_t* q, uint8_t* symbols, uint8_t* data, uint32_t frame_length);
 
 SRSRAN_API int srsran_viterbi_init_sse(srsran_viterbi_t*     q,
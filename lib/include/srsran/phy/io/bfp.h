@@ -0,0 +1,90 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         bfp.h
+ *
+ *  Description:  Block floating point compression of complex samples.
+ *                Each block of SRSRAN_BFP_BLOCK_LEN samples is stored as one
+ *                signed exponent byte e followed by the I and Q mantissas m,
+ *                interleaved, of 8 or 12 bits, so that a component is m * 2^e.
+ *                The exponent is the smallest that does not clip the largest
+ *                component of the block. 12 bit mantissas are packed in pairs,
+ *                first one in the lower bits, in 3 little endian bytes.
+ *
+ *                Files, written by srsran_filesink and read by
+ *                srsran_filesource as SRSRAN_COMPLEX_BFP8_BIN or
+ *                SRSRAN_COMPLEX_BFP12_BIN, start with a header followed by
+ *                records of SRSRAN_BFP_RECORD_LEN samples, every LTE subframe
+ *                being a whole number of records. Records have a fixed size,
+ *                the position of any sample is known without reading the file.
+ *
+ *  Reference:
+ *****************************************************************************/
+
+#ifndef SRSRAN_BFP_H
+#define SRSRAN_BFP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "srsran/config.h"
+
+#define SRSRAN_BFP_BLOCK_LEN 16
+#define SRSRAN_BFP_BLOCK_BYTES(BITS) (1 + 2 * SRSRAN_BFP_BLOCK_LEN * (BITS) / 8)
+#define SRSRAN_BFP_RECORD_LEN 1920
+
+#define SRSRAN_BFP_FILE_MAGIC 0x50464253 // "SBFP"
+#define SRSRAN_BFP_FILE_VERSION 1
+
+/* Header at the start of the files, little endian */
+typedef struct SRSRAN_API {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t header_size;  ///< Bytes before the first record
+  uint32_t bits;         ///< Mantissa width
+  uint32_t block_len;    ///< Samples per block
+  uint32_t record_len;   ///< Samples per record
+  uint32_t record_bytes; ///< Bytes per record
+  uint32_t reserved;
+  uint64_t nof_samples; ///< Written when the file is closed, 0 while it is written
+  uint8_t  padding[24];
+} srsran_bfp_file_header_t;
+
+/* Returns true for the mantissa widths supported */
+SRSRAN_API bool srsran_bfp_valid_bits(uint32_t bits);
+
+/* Bytes taking nof_samples samples, a multiple of SRSRAN_BFP_BLOCK_LEN */
+SRSRAN_API uint32_t srsran_bfp_nof_bytes(uint32_t nof_samples, uint32_t bits);
+
+/* Compresses nof_samples samples, a multiple of SRSRAN_BFP_BLOCK_LEN. Returns the bytes written to z */
+SRSRAN_API int srsran_bfp_encode(const cf_t* x, uint8_t* z, uint32_t nof_samples, uint32_t bits);
+
+/* Decompresses nof_samples samples, a multiple of SRSRAN_BFP_BLOCK_LEN. Returns the bytes read from x */
+SRSRAN_API int srsran_bfp_decode(const uint8_t* x, cf_t* z, uint32_t nof_samples, uint32_t bits);
+
+/* Fills the header of a file with records of the given mantissa width */
+SRSRAN_API void srsran_bfp_file_header_init(srsran_bfp_file_header_t* h, uint32_t bits);
+
+/* Checks a header read from a file */
+SRSRAN_API int srsran_bfp_file_header_check(const srsran_bfp_file_header_t* h);
+
+#endif // SRSRAN_BFP_H
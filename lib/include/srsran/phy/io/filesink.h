@@ -24,7 +24,8 @@
  *
  *  Description:  File sink.
  *                Supports writing floats, complex floats and complex shorts
- *                to file in text or binary formats.
+ *                to file in text or binary formats, and complex floats in
+ *                the block floating point format of bfp.h.
  *
  *  Reference:
  *****************************************************************************/
@@ -37,16 +38,24 @@
 #include <stdlib.h>
 
 #include "srsran/config.h"
+#include "srsran/phy/io/bfp.h"
 #include "srsran/phy/io/format.h"
 
 /* Low-level API */
 typedef struct SRSRAN_API {
   FILE*             f;
   srsran_datatype_t type;
+
+  // Block floating point records
+  srsran_bfp_file_header_t bfp_header;
+  cf_t*                    bfp_samples; ///< Samples of the record being filled
+  uint32_t                 bfp_fill;
+  uint8_t*                 bfp_record;
 } srsran_filesink_t;
 
 SRSRAN_API int srsran_filesink_init(srsran_filesink_t* q, char* filename, srsran_datatype_t type);
 
+/* Block floating point files get their last record, padded with zeros, and the number of samples written */
 SRSRAN_API void srsran_filesink_free(srsran_filesink_t* q);
 
 SRSRAN_API int srsran_filesink_write(srsran_filesink_t* q, void* buffer, int nsamples);
@@ -24,7 +24,8 @@
  *
  *  Description:  File source.
  *                Supports reading floats, complex floats and complex shorts
- *                from file in text or binary formats.
+ *                from file in text or binary formats, and complex floats in
+ *                the block floating point format of bfp.h.
  *
  *  Reference:
  *****************************************************************************/
@@ -33,23 +34,39 @@
 #define SRSRAN_FILESOURCE_H
 
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "srsran/config.h"
+#include "srsran/phy/io/bfp.h"
 #include "srsran/phy/io/format.h"
 
 /* Low-level API */
 typedef struct SRSRAN_API {
   FILE*             f;
   srsran_datatype_t type;
+
+  // Block floating point records
+  srsran_bfp_file_header_t bfp_header;
+  uint64_t                 bfp_record_idx; ///< Next record read from the file
+  cf_t*                    bfp_samples;    ///< Samples of the last record read
+  uint32_t                 bfp_len;        ///< Valid samples of the last record read
+  uint32_t                 bfp_pos;        ///< Next sample of the last record read
+  uint32_t                 bfp_skip;       ///< Samples to skip in the next record read, after a seek
+  uint8_t*                 bfp_record;
 } srsran_filesource_t;
 
+/* Block floating point files are read with the mantissa width of their header, either type can be given */
 SRSRAN_API int srsran_filesource_init(srsran_filesource_t* q, char* filename, srsran_datatype_t type);
 
 SRSRAN_API void srsran_filesource_free(srsran_filesource_t* q);
 
+/* Seeks to a byte offset, of the complex float file for block floating point ones */
 SRSRAN_API void srsran_filesource_seek(srsran_filesource_t* q, int pos);
 
+/* Seeks to a sample of a binary file, without reading the file */
+SRSRAN_API int srsran_filesource_seek_sample(srsran_filesource_t* q, uint64_t sample);
+
 SRSRAN_API int srsran_filesource_read(srsran_filesource_t* q, void* buffer, int nsamples);
 
 SRSRAN_API int srsran_filesource_read_multi(srsran_filesource_t* q, void** buffer, int nsamples, int nof_channels);
@@ -29,7 +29,9 @@ typedef enum {
   SRSRAN_COMPLEX_SHORT,
   SRSRAN_FLOAT_BIN,
   SRSRAN_COMPLEX_FLOAT_BIN,
-  SRSRAN_COMPLEX_SHORT_BIN
+  SRSRAN_COMPLEX_SHORT_BIN,
+  SRSRAN_COMPLEX_BFP8_BIN, ///< Block floating point, see bfp.h. Read with the mantissa width of the file
+  SRSRAN_COMPLEX_BFP12_BIN
 } srsran_datatype_t;
 
 #endif // SRSRAN_FORMAT_H
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         iq_capture.h
+ *
+ *  Description:  Triggered IQ capture.
+ *                The last seconds of received subframes are kept in memory,
+ *                one ring per antenna. The receiver gets its subframe buffers
+ *                from the ring, so recording costs no copy: committing a
+ *                subframe only stores its timestamp and advances an index.
+ *
+ *                Every commit carries the decode statistics of the subframe,
+ *                which are checked against the trigger rules. A trigger, from
+ *                a rule or from srsran_iq_capture_trigger(), which is async
+ *                signal safe, selects pre_sf subframes before and post_sf
+ *                subframes after it. Triggers inside the window of the last
+ *                capture are counted but do not start another one.
+ *
+ *                A background thread writes the windows as they fill, with
+ *                O_DIRECT where the file system supports it, to one file per
+ *                antenna, <prefix>_<n>_<antenna>.fc32, of complex floats that
+ *                srsran_filesource reads as SRSRAN_COMPLEX_FLOAT_BIN, or
+ *                <prefix>_<n>_<antenna>.bfp in the block floating point format
+ *                of bfp.h when bfp_bits is set. The
+ *                first sample of each file starts a subframe, described in
+ *                <prefix>_<n>.txt. Subframes are recorded as handed to the
+ *                decoder, so the samples ue_sync drops or repeats to adjust
+ *                the timing are not in the file.
+ *
+ *  Reference:
+ *****************************************************************************/
+
+#ifndef SRSRAN_IQ_CAPTURE_H
+#define SRSRAN_IQ_CAPTURE_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "srsran/config.h"
+#include "srsran/phy/common/phy_common.h"
+#include "srsran/phy/common/timestamp.h"
+
+#define SRSRAN_IQ_CAPTURE_MAX_QUEUE 8
+#define SRSRAN_IQ_CAPTURE_MAX_PREFIX 256
+
+typedef enum SRSRAN_API {
+  SRSRAN_IQ_CAPTURE_MANUAL = 0,
+  SRSRAN_IQ_CAPTURE_CRC_BURST,
+  SRSRAN_IQ_CAPTURE_SCI_SPIKE,
+  SRSRAN_IQ_CAPTURE_SYNC_LOSS,
+  SRSRAN_IQ_CAPTURE_NOF_REASONS,
+} srsran_iq_capture_reason_t;
+
+typedef struct SRSRAN_API {
+  uint32_t window_sf;      ///< Window of the CRC and SCI rules
+  uint32_t crc_fail_burst; ///< PSSCH CRC failures within the window that trigger, 0 disables
+  float    sci_spike;      ///< Ratio of the SCIs within the window to their long term average that triggers, 0 disables
+  uint32_t sci_spike_min;  ///< SCIs within the window below which the SCI rule never triggers
+  bool     sync_loss;      ///< Trigger when the receiver loses synchronization
+} srsran_iq_capture_rules_t;
+
+typedef struct SRSRAN_API {
+  uint32_t                  nof_ports;
+  uint32_t                  sf_len;     ///< Samples per subframe
+  uint32_t                  history_sf; ///< Subframes kept in memory
+  uint32_t                  pre_sf;     ///< Subframes written before the trigger
+  uint32_t                  post_sf;    ///< Subframes written after the trigger
+  double                    srate;      ///< Only recorded in the description
+  uint32_t                  bfp_bits;   ///< Mantissa width of block floating point files, 0 for complex floats
+  srsran_iq_capture_rules_t rules;
+} srsran_iq_capture_cfg_t;
+
+/* Decode statistics of a subframe */
+typedef struct SRSRAN_API {
+  uint32_t nof_sci;
+  uint32_t nof_crc_fail;
+  bool     synced;
+} srsran_iq_capture_sf_stats_t;
+
+typedef struct SRSRAN_API {
+  uint64_t nof_triggers[SRSRAN_IQ_CAPTURE_NOF_REASONS];
+  uint64_t nof_captures;   ///< Completely written
+  uint64_t nof_suppressed; ///< Triggers within the window of the previous capture
+  uint64_t nof_dropped;    ///< Triggers while the writer queue was full
+  uint64_t nof_overrun;    ///< Captures whose samples were overwritten before they were written
+  uint64_t nof_truncated;  ///< Captures stopped before the end of their window
+  uint64_t bytes_written;
+  uint64_t write_usec;
+} srsran_iq_capture_stats_t;
+
+/* Window waiting for, or being written by, the background thread */
+typedef struct SRSRAN_API {
+  uint64_t                   id;
+  uint64_t                   trigger_sf;
+  uint64_t                   first_sf;
+  uint64_t                   end_sf; ///< Exclusive
+  srsran_iq_capture_reason_t reason;
+} srsran_iq_capture_job_t;
+
+typedef struct SRSRAN_API {
+  srsran_iq_capture_cfg_t cfg;
+  char                    prefix[SRSRAN_IQ_CAPTURE_MAX_PREFIX];
+  cf_t*                   ring[SRSRAN_MAX_PORTS];
+  srsran_timestamp_t*     slot_time;
+  uint64_t                write_idx; ///< Subframes committed, read by the writer
+
+  // Trigger rules, evaluated in the receive thread
+  uint16_t*             sci_hist;
+  uint16_t*             crc_hist;
+  uint32_t              sci_window;
+  uint32_t              crc_window;
+  double                sci_avg; ///< SCIs per subframe, long term
+  bool                  synced;
+  uint64_t              capture_end; ///< End of the window of the last capture
+  volatile sig_atomic_t manual;
+
+  // Single producer, single consumer queue of windows
+  srsran_iq_capture_job_t queue[SRSRAN_IQ_CAPTURE_MAX_QUEUE];
+  uint64_t                queue_head; ///< Taken by the writer
+  uint64_t                queue_tail; ///< Added by the receive thread
+  uint64_t                nof_jobs;
+
+  pthread_t                 thread;
+  bool                      thread_running;
+  bool                      stop;
+  sem_t                     sem;
+  uint8_t*                  bounce;
+  uint8_t*                  encoded; ///< Chunk of an antenna in block floating point
+  srsran_iq_capture_stats_t stats;
+} srsran_iq_capture_t;
+
+SRSRAN_API void srsran_iq_capture_cfg_default(srsran_iq_capture_cfg_t* cfg);
+
+/* Overrides cfg with a comma separated list of history=<s>, pre=<ms>, post=<ms>, win=<ms>, crc=<failures>,
+ * sci=<ratio>, scimin=<SCIs>, sync and bfp=<bits> */
+SRSRAN_API int srsran_iq_capture_cfg_parse(srsran_iq_capture_cfg_t* cfg, const char* spec);
+
+/* Allocates, and pre-faults, the rings and starts the writer */
+SRSRAN_API int srsran_iq_capture_init(srsran_iq_capture_t* q, const srsran_iq_capture_cfg_t* cfg, const char* prefix);
+
+/* Writes the windows triggered so far with the subframes received, then stops the writer. Nothing can be committed
+ * afterwards, the statistics remain */
+SRSRAN_API void srsran_iq_capture_stop(srsran_iq_capture_t* q);
+
+SRSRAN_API void srsran_iq_capture_free(srsran_iq_capture_t* q);
+
+/* Buffer of the next subframe of an antenna, to receive into. It stays valid until the subframe is committed */
+SRSRAN_API cf_t* srsran_iq_capture_slot(srsran_iq_capture_t* q, uint32_t port);
+
+/* The buffer of the last committed subframe of an antenna */
+SRSRAN_API cf_t* srsran_iq_capture_last(srsran_iq_capture_t* q, uint32_t port);
+
+/* Adds the received subframe to the history and checks the trigger rules against its statistics */
+SRSRAN_API void
+srsran_iq_capture_commit(srsran_iq_capture_t* q, const srsran_timestamp_t* t, const srsran_iq_capture_sf_stats_t* s);
+
+/* Triggers a capture at the next commit, async signal safe */
+SRSRAN_API void srsran_iq_capture_trigger(srsran_iq_capture_t* q);
+
+SRSRAN_API void srsran_iq_capture_get_stats(srsran_iq_capture_t* q, srsran_iq_capture_stats_t* stats);
+
+SRSRAN_API void srsran_iq_capture_fprint_stats(FILE* f, srsran_iq_capture_t* q);
+
+SRSRAN_API const char* srsran_iq_capture_reason_string(srsran_iq_capture_reason_t reason);
+
+#endif // SRSRAN_IQ_CAPTURE_H
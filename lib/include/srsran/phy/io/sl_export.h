@@ -0,0 +1,143 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         sl_export.h
+ *
+ *  Description:  Shared memory ring of decoded sidelink traffic.
+ *                A single writer publishes one record per decoded SCI, with
+ *                its PSSCH transport block, into a file mapped with mmap(),
+ *                typically under /dev/shm. Any number of readers in other
+ *                processes follow the ring without system calls or parsing.
+ *
+ *                Layout, all fields little endian:
+ *
+ *                offset 0    srsran_sl_export_header_t, 128 bytes
+ *                offset 128  nof_records slots of record_size bytes, each a
+ *                            srsran_sl_export_record_t (64 bytes) followed by
+ *                            max_tb_bytes of packed transport block, MSB first
+ *
+ *                Record n lives in slot n % nof_records. The writer marks a
+ *                slot busy by setting its seq to 2n + 1, fills it and sets
+ *                seq to 2n + 2, then write_idx to n + 1. A reader copying a
+ *                slot checks seq before and after: a changed or odd seq means
+ *                the writer lapped it and the record is lost.
+ *
+ *  Reference:
+ *****************************************************************************/
+
+#ifndef SRSRAN_SL_EXPORT_H
+#define SRSRAN_SL_EXPORT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "srsran/config.h"
+
+#define SRSRAN_SL_EXPORT_MAGIC 0x31584c53 // "SLX1"
+#define SRSRAN_SL_EXPORT_VERSION 1
+#define SRSRAN_SL_EXPORT_HEADER_SIZE 128
+
+// Record flags
+#define SRSRAN_SL_EXPORT_TB_OK (1U << 0)   ///< The transport block decoded, tb_len bytes follow the record
+#define SRSRAN_SL_EXPORT_TB_SHED (1U << 1) ///< The PSSCH was not decoded, the decode budget was spent
+
+typedef struct SRSRAN_API {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t header_size;  ///< Offset of the first slot
+  uint32_t record_size;  ///< Slot size, a multiple of 64
+  uint32_t nof_records;  ///< Number of slots, a power of two
+  uint32_t max_tb_bytes; ///< Room for the transport block in every slot
+  uint8_t  reserved[40];
+  uint64_t write_idx; ///< Number of records published, on a cache line of its own
+  uint8_t  reserved2[56];
+} srsran_sl_export_header_t;
+
+typedef struct SRSRAN_API {
+  uint64_t seq;             ///< 2n + 1 while record n is written, 2n + 2 once complete
+  uint64_t timestamp_us;    ///< RX timestamp of the subframe
+  uint32_t channel_idx;     ///< Channel of a wideband capture
+  uint32_t sf_idx;          ///< Subframe index, 0 to 9
+  uint32_t sub_channel_idx; ///< Sub-channel of the PSCCH
+  uint32_t prb_start_idx;   ///< PSSCH allocation
+  uint32_t nof_prb;
+  uint32_t N_x_id; ///< PSSCH scrambling identity, from the SCI CRC
+  uint8_t  priority;
+  uint8_t  resource_reserv;
+  uint8_t  time_gap;
+  uint8_t  mcs_idx;
+  uint8_t  rv_idx;
+  uint8_t  retransmission;
+  uint8_t  transmission_format;
+  uint8_t  flags; ///< SRSRAN_SL_EXPORT_TB_OK, SRSRAN_SL_EXPORT_TB_SHED
+  uint16_t riv;
+  uint16_t reserved;
+  float    rsrp_db; ///< PSSCH DMRS received power
+  float    snr_db;
+  uint32_t tb_len; ///< Transport block bytes after the record, 0 unless SRSRAN_SL_EXPORT_TB_OK
+} srsran_sl_export_record_t;
+
+/* Writer */
+typedef struct SRSRAN_API {
+  int                        fd;
+  uint8_t*                   map;
+  uint64_t                   map_size;
+  srsran_sl_export_header_t* header;
+  uint64_t                   write_idx;
+} srsran_sl_export_t;
+
+/* Reader */
+typedef struct SRSRAN_API {
+  int                              fd;
+  uint8_t*                         map;
+  uint64_t                         map_size;
+  const srsran_sl_export_header_t* header;
+  uint64_t                         read_idx;
+  uint64_t                         nof_lost; ///< Records overwritten before they were read
+} srsran_sl_export_reader_t;
+
+/* Creates, or truncates, the ring at path with nof_records slots, rounded up to a power of two, able to hold
+ * transport blocks of max_tb_bytes */
+SRSRAN_API int srsran_sl_export_init(srsran_sl_export_t* q, const char* path, uint32_t nof_records, uint32_t max_tb_bytes);
+
+SRSRAN_API void srsran_sl_export_free(srsran_sl_export_t* q);
+
+/* Claims the next slot. The caller fills the returned record and, through tb, up to max_tb_bytes of transport block
+ * in place, then publishes it with srsran_sl_export_commit() */
+SRSRAN_API srsran_sl_export_record_t* srsran_sl_export_begin(srsran_sl_export_t* q, uint8_t** tb);
+
+SRSRAN_API void srsran_sl_export_commit(srsran_sl_export_t* q);
+
+/* Maps an existing ring read only. Reading starts at the oldest record still in the ring */
+SRSRAN_API int srsran_sl_export_reader_init(srsran_sl_export_reader_t* q, const char* path);
+
+SRSRAN_API void srsran_sl_export_reader_free(srsran_sl_export_reader_t* q);
+
+/* Copies the next record, and up to tb_size bytes of its transport block, out of the ring. Records overwritten before
+ * they were copied are skipped and counted in q->nof_lost.
+ *
+ * @return 1 if a record was read, 0 if there is no new record, SRSRAN_ERROR otherwise
+ */
+SRSRAN_API int
+srsran_sl_export_read(srsran_sl_export_reader_t* q, srsran_sl_export_record_t* record, uint8_t* tb, uint32_t tb_size);
+
+#endif // SRSRAN_SL_EXPORT_H
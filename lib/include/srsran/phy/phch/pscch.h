@@ -89,9 +89,24 @@ typedef struct SRSRAN_API {
 } srsran_pscch_t;
 
 SRSRAN_API int  srsran_pscch_init(srsran_pscch_t* q, uint32_t max_prb);
+// Allocates the multi-frame decoder of srsran_pscch_decode_batch(), without it the candidates are decoded one by one
+SRSRAN_API int  srsran_pscch_init_batch(srsran_pscch_t* q);
 SRSRAN_API int  srsran_pscch_set_cell(srsran_pscch_t* q, srsran_cell_sl_t cell);
 SRSRAN_API int  srsran_pscch_encode(srsran_pscch_t* q, uint8_t* sci, cf_t* sf_buffer, uint32_t prb_start_idx);
 SRSRAN_API int  srsran_pscch_decode(srsran_pscch_t* q, cf_t* equalized_sf_syms, uint8_t* sci, uint32_t prb_start_idx);
+// Decodes the equalized REs already in q->scfdma_symbols, see srsran_chest_sl_ls_estimate_equalize_symbols()
+SRSRAN_API int  srsran_pscch_decode_scfdma(srsran_pscch_t* q, uint8_t* sci);
+// Demodulates q->scfdma_symbols down to the 3 * (sci_len + SRSRAN_SCI_CRC_LEN) soft bits of the convolutional code
+SRSRAN_API int  srsran_pscch_demod_scfdma(srsran_pscch_t* q, int16_t* d_16);
+/**
+ * Channel decodes and CRC checks the soft bits of several candidates, given by srsran_pscch_demod_scfdma(), together.
+ * The convolutional decoder runs one candidate per SIMD lane, see srsran_viterbi_decode_s_batch(). Each c[k] holds
+ * SRSRAN_SCI_MAX_LEN + SRSRAN_SCI_CRC_LEN bits and gets the SCI of candidate k followed by its received CRC.
+ *
+ * @return number of candidates whose CRC matched, flagged in crc_ok, SRSRAN_ERROR otherwise
+ */
+SRSRAN_API int
+srsran_pscch_decode_batch(srsran_pscch_t* q, int16_t** d_16, uint8_t** c, bool* crc_ok, uint32_t nof_candidates);
 SRSRAN_API int  srsran_pscch_put(srsran_pscch_t* q, cf_t* sf_buffer, uint32_t prb_start_idx);
 SRSRAN_API int  srsran_pscch_get(srsran_pscch_t* q, cf_t* sf_buffer, uint32_t prb_start_idx);
 SRSRAN_API void srsran_pscch_free(srsran_pscch_t* q);
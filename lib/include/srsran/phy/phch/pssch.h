@@ -69,6 +69,7 @@ typedef struct SRSRAN_API {
 
   // data
   uint8_t* b;
+  uint8_t* b_bytes;
 
   // crc
   uint8_t*     c_r;
@@ -126,7 +127,11 @@ typedef struct SRSRAN_API {
 SRSRAN_API int  srsran_pssch_init(srsran_pssch_t* q, srsran_cell_sl_t cell, srsran_sl_comm_resource_pool_t sl_comm_resource_pool);
 SRSRAN_API int  srsran_pssch_set_cfg(srsran_pssch_t* q, srsran_pssch_cfg_t pssch_cfg);
 SRSRAN_API int  srsran_pssch_encode(srsran_pssch_t* q, uint8_t* input, uint32_t input_len, cf_t* sf_buffer);
+// Same as srsran_pssch_encode() with the transport block packed in bytes, MSB first. input_len is in bits
+SRSRAN_API int  srsran_pssch_encode_bytes(srsran_pssch_t* q, uint8_t* input, uint32_t input_len, cf_t* sf_buffer);
 SRSRAN_API int  srsran_pssch_decode(srsran_pssch_t* q, cf_t* equalized_sf_syms, uint8_t* output, uint32_t output_len);
+// Decodes the equalized REs already in q->scfdma_symbols, see srsran_chest_sl_ls_estimate_equalize_symbols()
+SRSRAN_API int  srsran_pssch_decode_scfdma(srsran_pssch_t* q, uint8_t* output, uint32_t output_len);
 SRSRAN_API int  srsran_pssch_put(srsran_pssch_t* q, cf_t* sf_buffer, cf_t* symbols);
 SRSRAN_API int  srsran_pssch_get(srsran_pssch_t* q, cf_t* sf_buffer, cf_t* symbols);
 SRSRAN_API void srsran_pssch_free(srsran_pssch_t* q);
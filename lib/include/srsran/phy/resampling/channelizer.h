@@ -0,0 +1,148 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         channelizer.h
+ *
+ *  Description:  Splits a wideband signal into several narrowband channels.
+ *                Each channel is shifted to baseband and filtered by a
+ *                polyphase decimator that only computes the kept outputs.
+ *                Channel center frequencies are arbitrary, so channels
+ *                spaced by 10 MHz can be extracted at LTE sampling rates,
+ *                which do not fit the bins of an FFT filter bank.
+ *                The synthesizer does the opposite: it interpolates several
+ *                narrowband channels with the same prototype, shifts them to
+ *                their center frequencies and sums them.
+ *
+ *  Reference:    Multirate Signal Processing for Communication Systems
+ *                fredric j. harris
+ *****************************************************************************/
+
+#ifndef SRSRAN_CHANNELIZER_H
+#define SRSRAN_CHANNELIZER_H
+
+#include <stdint.h>
+
+#include "srsran/config.h"
+
+#define SRSRAN_CHANNELIZER_MAX_CHANNELS 8
+#define SRSRAN_CHANNELIZER_ATTENUATION_DB 60.0f ///< Stop band attenuation of the prototype filter
+
+typedef struct SRSRAN_API {
+  uint32_t nof_channels;
+  uint32_t decimation;
+  uint32_t nof_taps;     ///< Prototype length, the group delay is an integer number of output samples
+  uint32_t nof_taps_pad; ///< Prototype length padded to the SIMD width
+  uint32_t max_nsamples; ///< Maximum number of input samples per call
+
+  float* prototype; ///< Low pass prototype with unity DC gain
+  float* taps;      ///< Reversed prototype with every tap duplicated, to filter interleaved complex samples
+
+  float  freq[SRSRAN_CHANNELIZER_MAX_CHANNELS];  ///< Channel center frequencies, normalized to the input rate
+  double phase[SRSRAN_CHANNELIZER_MAX_CHANNELS]; ///< Mixer phase in cycles
+  cf_t*  mixed[SRSRAN_CHANNELIZER_MAX_CHANNELS]; ///< Filter history followed by the mixed input samples
+} srsran_channelizer_t;
+
+typedef struct SRSRAN_API {
+  uint32_t nof_channels;
+  uint32_t interpolation;
+  uint32_t nof_taps;       ///< Prototype length, the group delay is an integer number of input samples
+  uint32_t nof_phase_taps; ///< Length of every polyphase branch, padded to the SIMD width
+  uint32_t max_nsamples;   ///< Maximum number of input samples per channel and call
+
+  float* prototype; ///< Low pass prototype with unity DC gain
+  float* taps;      ///< Polyphase branches scaled by the interpolation, reversed and with every tap duplicated
+
+  float  freq[SRSRAN_CHANNELIZER_MAX_CHANNELS];    ///< Channel center frequencies, normalized to the output rate
+  double phase[SRSRAN_CHANNELIZER_MAX_CHANNELS];   ///< Mixer phase in cycles
+  cf_t*  history[SRSRAN_CHANNELIZER_MAX_CHANNELS]; ///< Branch history followed by the channel input samples
+  cf_t*  interpolated;                             ///< Interpolated channel before it is added to the output
+} srsran_channelizer_synth_t;
+
+/**
+ * Initializes a channelizer.
+ * @param freq Channel center frequencies normalized to the input sampling rate, in (-0.5, 0.5)
+ * @param decimation Ratio between the input and the channel sampling rates
+ * @param cutoff Cut-off frequency (-6 dB) of the channel filter, normalized to the input sampling rate
+ * @param transition Width of the filter transition band, normalized to the input sampling rate
+ * @param max_nsamples Maximum number of input samples processed in one call
+ */
+SRSRAN_API int srsran_channelizer_init(srsran_channelizer_t* q,
+                                       uint32_t              nof_channels,
+                                       const float*          freq,
+                                       uint32_t              decimation,
+                                       float                 cutoff,
+                                       float                 transition,
+                                       uint32_t              max_nsamples);
+
+SRSRAN_API void srsran_channelizer_free(srsran_channelizer_t* q);
+
+SRSRAN_API void srsran_channelizer_reset(srsran_channelizer_t* q);
+
+/**
+ * Channelizes nsamples input samples, which must be a multiple of the decimation.
+ * Returns the number of samples written to each output or SRSRAN_ERROR_INVALID_INPUTS.
+ */
+SRSRAN_API int srsran_channelizer_execute(srsran_channelizer_t* q,
+                                          const cf_t*           input,
+                                          cf_t*                 output[SRSRAN_CHANNELIZER_MAX_CHANNELS],
+                                          uint32_t              nsamples);
+
+/** Returns the group delay of the channels in output samples */
+SRSRAN_API uint32_t srsran_channelizer_get_delay(const srsran_channelizer_t* q);
+
+/** Kaiser windowed-sinc low pass with unity DC gain and SRSRAN_CHANNELIZER_ATTENUATION_DB stop band attenuation */
+SRSRAN_API void srsran_channelizer_lowpass(float* h, uint32_t nof_taps, float cutoff);
+
+/** Returns the odd number of taps needed by srsran_channelizer_lowpass() for the given transition band */
+SRSRAN_API uint32_t srsran_channelizer_lowpass_nof_taps(float transition);
+
+/**
+ * Initializes a synthesizer, the parameters are the same as srsran_channelizer_init() with the rates swapped.
+ * @param freq Channel center frequencies normalized to the output sampling rate, in (-0.5, 0.5)
+ * @param interpolation Ratio between the output and the channel sampling rates
+ * @param max_nsamples Maximum number of input samples per channel processed in one call
+ */
+SRSRAN_API int srsran_channelizer_synth_init(srsran_channelizer_synth_t* q,
+                                             uint32_t                    nof_channels,
+                                             const float*                freq,
+                                             uint32_t                    interpolation,
+                                             float                       cutoff,
+                                             float                       transition,
+                                             uint32_t                    max_nsamples);
+
+SRSRAN_API void srsran_channelizer_synth_free(srsran_channelizer_synth_t* q);
+
+SRSRAN_API void srsran_channelizer_synth_reset(srsran_channelizer_synth_t* q);
+
+/**
+ * Interpolates nsamples samples of every channel and writes their sum, nsamples times the interpolation, to output.
+ * Returns the number of output samples or SRSRAN_ERROR_INVALID_INPUTS.
+ */
+SRSRAN_API int srsran_channelizer_synth_execute(srsran_channelizer_synth_t* q,
+                                                const cf_t*                 input[SRSRAN_CHANNELIZER_MAX_CHANNELS],
+                                                cf_t*                       output,
+                                                uint32_t                    nsamples);
+
+/** Returns the group delay of the channels in input samples */
+SRSRAN_API uint32_t srsran_channelizer_synth_get_delay(const srsran_channelizer_synth_t* q);
+
+#endif // SRSRAN_CHANNELIZER_H
@@ -81,6 +81,10 @@ SRSRAN_API int srsran_rf_close(srsran_rf_t* h);
 
 SRSRAN_API int srsran_rf_start_rx_stream(srsran_rf_t* h, bool now);
 
+SRSRAN_API int srsran_rf_start_rx_stream_timed(srsran_rf_t* h, time_t secs, double frac_secs);
+
+SRSRAN_API bool srsran_rf_has_start_rx_stream_timed(srsran_rf_t* h);
+
 SRSRAN_API int srsran_rf_stop_rx_stream(srsran_rf_t* h);
 
 SRSRAN_API void srsran_rf_flush_buffer(srsran_rf_t* h);
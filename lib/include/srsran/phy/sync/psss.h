@@ -40,6 +40,8 @@
 
 #define SRSRAN_PSSS_LEN 62
 
+#define SRSRAN_PSSS_TRACK_THRESHOLD (0.3f) ///< Minimum normalized correlation to accept a tracked PSSS
+
 typedef struct SRSRAN_API {
 
   cf_t psss_signal[2][SRSRAN_PSSS_LEN]; // One sequence for each N_id_2
@@ -61,6 +63,12 @@ typedef struct SRSRAN_API {
 
   uint32_t N_id_2;
 
+  // Time-domain replica of the two PSSS symbols (including CP), used for tracking
+  cf_t*    psss_time[2];
+  float    psss_time_energy[2];
+  uint32_t psss_time_start; ///< Offset of the first PSSS symbol (CP included) from the start of the subframe
+  uint32_t psss_time_len;
+
   srsran_dft_plan_t plan_input;
   srsran_dft_plan_t plan_out;
 
@@ -74,6 +82,8 @@ SRSRAN_API void srsran_psss_put_sf_buffer(cf_t* psss_signal, cf_t* sf_buffer, ui
 
 SRSRAN_API int srsran_psss_find(srsran_psss_t* q, cf_t* input, uint32_t nof_prb, srsran_cp_t cp);
 
+SRSRAN_API int srsran_psss_track(srsran_psss_t* q, const cf_t* input, uint32_t N_id_2, uint32_t max_offset);
+
 SRSRAN_API void srsran_psss_free(srsran_psss_t* q);
 
 #endif // SRSRAN_PSSS_H
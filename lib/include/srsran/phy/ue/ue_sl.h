@@ -129,6 +129,10 @@ SRSRAN_API int srsran_ue_sl_set_sl_comm_resource_pool(srsran_ue_sl_t* q, srsran_
 
 SRSRAN_API uint32_t srsran_n_x_id_from_crc(uint8_t *crc, uint32_t crc_len);
 
+SRSRAN_API uint32_t srsran_intvl_to_reserv(uint32_t resource_reserv_intvl);
+
+SRSRAN_API uint32_t srsran_intvl_from_reserv(uint32_t resource_reserv);
+
 SRSRAN_API void srsran_set_sci(srsran_sci_t* sci,
                                uint32_t priority,
                                uint32_t resource_reserv_itvl,
@@ -141,6 +145,9 @@ SRSRAN_API void srsran_set_sci_riv(srsran_ue_sl_t* q,
                                    uint32_t sub_channel_start_idx,
                                    uint32_t l_sub_channel);
 
+// Transport block size in bits of a PSSCH over l_sub_channel sub-channels, with the MCS of the SCI to transmit
+SRSRAN_API uint32_t srsran_ue_sl_get_tbs(srsran_ue_sl_t* q, uint32_t l_sub_channel);
+
 SRSRAN_API int srsran_ue_sl_encode(srsran_ue_sl_t* q,
                                    srsran_sl_sf_cfg_t* sf,
                                    srsran_pssch_data_t* data);
@@ -152,5 +159,14 @@ SRSRAN_API int srsran_ue_sl_decode_subch(srsran_ue_sl_t* q,
                                          uint32_t sub_channel_idx,
                                          srsran_ue_sl_res_t* sl_res);
 
+/**
+ * Decodes the PSCCH and PSSCH of every sub-channel of the pool. The PSCCH candidates of all sub-channels are channel
+ * decoded in one srsran_pscch_decode_batch() call, decoded[k] flags the sub-channels whose PSSCH was decoded.
+ *
+ * @return number of sub-channels with a decoded PSSCH, SRSRAN_ERROR otherwise
+ */
+SRSRAN_API int
+srsran_ue_sl_decode_sf(srsran_ue_sl_t* q, srsran_sl_sf_cfg_t* sf, srsran_ue_sl_res_t* sl_res, bool* decoded);
+
 
 #endif // SRSRAN_UE_SL_H
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         ue_sl_reservation.h
+ *
+ *  Description:  Sidelink resource reservation tracker.
+ *
+ *                Every decoded SCI format 1 announces the resources its sender
+ *                will use next: the same sub-channel one reservation period
+ *                later and, for an initial transmission, the retransmission
+ *                time_gap subframes later. The tracker turns them into
+ *                predicted PSCCH candidates, so that a receiver can try them
+ *                before the blind search.
+ *
+ *  Reference:    3GPP TS 36.213 version 15.6.0 Release 15 Section 14.1.1.4C
+ *                and Section 14.2.1
+ *****************************************************************************/
+
+#ifndef SRSRAN_UE_SL_RESERVATION_H
+#define SRSRAN_UE_SL_RESERVATION_H
+
+#include "srsran/config.h"
+#include "srsran/phy/common/phy_common_sl.h"
+#include "srsran/phy/phch/sci.h"
+
+// Number of subframes that can be predicted ahead, covers the longest reservation period of 1000 ms plus the time gap
+#define SRSRAN_UE_SL_RESERVATION_HORIZON (1024)
+
+typedef struct SRSRAN_API {
+  uint32_t sub_channel_idx;
+  uint32_t cyclic_shift;
+  uint32_t priority;
+} srsran_ue_sl_candidate_t;
+
+typedef struct SRSRAN_API {
+  uint32_t num_sub_channel;
+
+  // Calendar of predicted candidates, one slot per subframe modulo the horizon
+  uint32_t* slot_tti;      // Subframe the entries of the slot belong to
+  uint8_t*  slot_valid;    // [slot][sub_channel]
+  uint8_t*  slot_shift;    // [slot][sub_channel] cyclic shift the sender used
+  uint8_t*  slot_priority; // [slot][sub_channel]
+
+  uint64_t nof_predictions;
+} srsran_ue_sl_reservation_t;
+
+SRSRAN_API int srsran_ue_sl_reservation_init(srsran_ue_sl_reservation_t* q, uint32_t num_sub_channel);
+
+SRSRAN_API void srsran_ue_sl_reservation_free(srsran_ue_sl_reservation_t* q);
+
+SRSRAN_API void srsran_ue_sl_reservation_reset(srsran_ue_sl_reservation_t* q);
+
+/**
+ * Adds the resources reserved by an SCI format 1, as returned by srsran_sci_format1_unpack(), which was decoded in
+ * subframe tti on sub_channel_idx with the given PSCCH cyclic shift.
+ *
+ * @return number of predicted candidates
+ */
+SRSRAN_API int srsran_ue_sl_reservation_add(srsran_ue_sl_reservation_t* q,
+                                            const srsran_sci_t*         sci,
+                                            uint32_t                    tti,
+                                            uint32_t                    sub_channel_idx,
+                                            uint32_t                    cyclic_shift);
+
+/**
+ * Writes the candidates predicted for subframe tti, highest priority first. candidates must hold num_sub_channel
+ * entries.
+ *
+ * @return number of candidates
+ */
+SRSRAN_API uint32_t srsran_ue_sl_reservation_get(srsran_ue_sl_reservation_t* q,
+                                                 uint32_t                    tti,
+                                                 srsran_ue_sl_candidate_t*   candidates);
+
+#endif // SRSRAN_UE_SL_RESERVATION_H
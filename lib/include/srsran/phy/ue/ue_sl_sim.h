@@ -0,0 +1,248 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         ue_sl_sim.h
+ *
+ *  Description:  Sidelink mode 4 system level simulator with an abstracted PHY.
+ *
+ *                Vehicles drive on a highway whose ends are joined, each
+ *                sending a packet every reservation period on a semi
+ *                persistent resource chosen by sensing. No samples are
+ *                generated: every transmission carries the SCI format 1 it
+ *                would send, and each receiver in range decodes the PSCCH and
+ *                the PSSCH with a probability looked up in a BLER table from
+ *                its SINR. The SINR of every sub-channel adds the path loss,
+ *                shadowing and fading of all the transmissions of the subframe,
+ *                with the in-band emission of those on other sub-channels.
+ *                Fading is Rayleigh, constant over a subframe and a
+ *                sub-channel and independent between sub-channels. The PSSCH
+ *                is decoded at the SINR with the mean Shannon capacity of its
+ *                sub-channels, the PSCCH at the SINR of the first one.
+ *
+ *                Simplifications: a single receive antenna, so the only
+ *                diversity is across the sub-channels of the PSSCH; no
+ *                retransmissions; no fading within a sub-channel.
+ *
+ *                Transmissions wait in a calendar, one slot per subframe, and
+ *                subframes nobody transmits in are skipped. The receivers of a
+ *                subframe are split among worker threads by road cells. All
+ *                random draws of the receivers are hashes of the subframe and
+ *                the vehicles, so the results do not depend on the number of
+ *                threads.
+ *
+ *  Reference:    3GPP TS 36.213 version 15.6.0 Release 15 Section 14.1.1.6
+ *                3GPP TR 36.885 version 14.0.0 Annex A
+ *                3GPP TR 36.942 version 15.0.0 Annex A.1
+ *****************************************************************************/
+
+#ifndef SRSRAN_UE_SL_SIM_H
+#define SRSRAN_UE_SL_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "srsran/config.h"
+#include "srsran/phy/common/phy_common_sl.h"
+#include "srsran/phy/phch/sci.h"
+#include "srsran/phy/utils/random.h"
+
+#define SRSRAN_UE_SL_SIM_MAX_THREADS 64
+#define SRSRAN_UE_SL_SIM_MAX_BUCKETS 256
+
+// Calendar of transmissions, covers the longest reservation period of 1000 ms plus the selection window
+#define SRSRAN_UE_SL_SIM_HORIZON 2048
+
+// Slots of the sensing map of every vehicle, the selection window never exceeds 100 subframes
+#define SRSRAN_UE_SL_SIM_SENSING_SLOTS 100
+#define SRSRAN_UE_SL_SIM_SENSING_WINDOW 1000
+
+// SINR grid of the BLER tables, in dB
+#define SRSRAN_UE_SL_SIM_BLER_MIN_DB (-20.0f)
+#define SRSRAN_UE_SL_SIM_BLER_STEP_DB (0.1f)
+#define SRSRAN_UE_SL_SIM_BLER_LEN 601
+
+// The same tables indexed by the linear SINR from -21 dB to 42 dB, 64 entries per octave
+#define SRSRAN_UE_SL_SIM_BLER_LIN_BITS 6
+#define SRSRAN_UE_SL_SIM_BLER_LIN_LEN (21 << SRSRAN_UE_SL_SIM_BLER_LIN_BITS)
+
+// Path loss table up to the distance beyond which it falls with the fourth power, entries of the shadowing and fading
+// tables. All the tables of the receivers fit in the L1 cache
+#define SRSRAN_UE_SL_SIM_PL_STEP_M (0.1f)
+#define SRSRAN_UE_SL_SIM_PL_NEAR_M (50.0f)
+#define SRSRAN_UE_SL_SIM_PL_NEAR_LEN 500
+#define SRSRAN_UE_SL_SIM_TABLE_BITS 10
+#define SRSRAN_UE_SL_SIM_TABLE_LEN (1U << SRSRAN_UE_SL_SIM_TABLE_BITS)
+
+typedef enum SRSRAN_API {
+  SRSRAN_UE_SL_SIM_PSCCH = 0,
+  SRSRAN_UE_SL_SIM_PSSCH,
+  SRSRAN_UE_SL_SIM_NOF_CHANNELS,
+} srsran_ue_sl_sim_channel_t;
+
+typedef struct SRSRAN_API {
+  // Scenario, vehicles are spread evenly over the road and the lanes
+  uint32_t nof_vehicles;
+  float    road_length_m;
+  uint32_t nof_lanes; ///< Per direction
+  float    lane_width_m;
+  float    speed_kmph;
+
+  // Traffic, one transmission per packet without retransmissions
+  uint32_t period_ms; ///< Packet and reservation period, 20, 50 or 100 to 1000 in steps of 100
+  uint32_t mcs_idx;
+  uint32_t L_subCH; ///< Sub-channels of every transmission
+  uint32_t priority;
+  float    prob_keep;          ///< probResourceKeep
+  bool     sensing;            ///< Sensing based selection, random selection otherwise
+  float    rsrp_threshold_dbm; ///< First PSSCH-RSRP threshold of the exclusion, raised 3 dB at a time
+
+  // Link budget
+  float    tx_power_dbm;
+  float    noise_figure_db;
+  float    carrier_ghz;
+  float    shadowing_db; ///< Standard deviation of the log-normal shadowing
+  uint32_t shadowing_ms; ///< Time the shadowing of a pair of vehicles stays constant
+  bool     fading;       ///< Rayleigh block fading, drawn for every transmission and sub-channel
+  float    ibe_db;       ///< In-band emission on every other sub-channel, relative to the used ones
+  float    max_range_m;  ///< Farther vehicles neither receive nor interfere
+  float    distance_bucket_m;
+
+  uint32_t nof_threads;
+  uint32_t seed;
+} srsran_ue_sl_sim_cfg_t;
+
+typedef struct SRSRAN_API {
+  uint64_t nof_tx; ///< Transmissions to receivers within the bucket
+  uint64_t nof_rx; ///< Of them, decoded
+} srsran_ue_sl_sim_count_t;
+
+typedef struct SRSRAN_API {
+  uint64_t                 nof_subframes; ///< Simulated
+  uint64_t                 nof_busy;      ///< Subframes with at least one transmission
+  uint64_t                 nof_transmissions;
+  uint64_t                 nof_reselections;
+  uint64_t                 nof_links;       ///< Transmissions to receivers within max_range_m
+  uint64_t                 nof_half_duplex; ///< Lost because the receiver was transmitting
+  uint64_t                 nof_pscch_fail;
+  uint64_t                 nof_pssch_fail;
+  uint32_t                 nof_buckets;
+  srsran_ue_sl_sim_count_t distance[SRSRAN_UE_SL_SIM_MAX_BUCKETS];
+} srsran_ue_sl_sim_stats_t;
+
+/* Transmission of a subframe, as seen by its receivers */
+typedef struct SRSRAN_API {
+  uint32_t     vehicle;
+  uint32_t     cell;
+  float        x;
+  float        y;
+  uint32_t     sub_channel_idx; ///< Decoded from the SCI
+  uint32_t     L_subCH;
+  srsran_sci_t sci;
+} srsran_ue_sl_sim_tx_t;
+
+typedef struct SRSRAN_API {
+  srsran_ue_sl_sim_cfg_t         cfg;
+  srsran_cell_sl_t               cell;
+  srsran_sl_comm_resource_pool_t pool;
+
+  // Transport format, the same for all transmissions
+  uint32_t nof_prb;
+  uint32_t tbs;
+  float    code_rate;
+  float    bler[SRSRAN_UE_SL_SIM_NOF_CHANNELS][SRSRAN_UE_SL_SIM_BLER_LEN];
+  float    bler_lin[SRSRAN_UE_SL_SIM_NOF_CHANNELS][SRSRAN_UE_SL_SIM_BLER_LIN_LEN];
+
+  // Link budget tables
+  float    pl_near[SRSRAN_UE_SL_SIM_PL_NEAR_LEN]; ///< Received power in mW, every SRSRAN_UE_SL_SIM_PL_STEP_M
+  float    pl_far;                                ///< Received power in mW times the distance to the fourth
+  float    shadow[SRSRAN_UE_SL_SIM_TABLE_LEN];    ///< Linear shadowing, indexed by a hash of the pair of vehicles
+  float    fade[SRSRAN_UE_SL_SIM_TABLE_LEN];      ///< Exponential power of the Rayleigh fading, 1 without
+  float    noise_mw;                              ///< Per sub-channel
+  float    ibe;
+
+  // Vehicles
+  float*    x0;
+  float*    y;
+  float*    v; ///< Signed speed in m/ms
+  float*    x; ///< Position in the current subframe
+  uint32_t* cell_of;
+  uint64_t* gen_tti; ///< Generation of the next packet
+  uint64_t* tx_tti;  ///< Next transmission
+  uint32_t* sub_channel_idx;
+  uint32_t* counter; ///< Reselection counter
+  uint32_t* next;    ///< Calendar chain
+  uint32_t* sensing; ///< [slot][vehicle][sub_channel] subframe of the last SCI decoded and its PSSCH-RSRP, 0 if none
+
+  // Road cells, as long as the range at least, with the vehicles sorted by cell
+  uint32_t  nof_cells;
+  float     cell_len;
+  uint32_t* cell_start; ///< nof_cells + 1 entries
+  uint32_t* cell_vehicles;
+  uint32_t* tx_cell_start;
+
+  // Calendar of transmissions
+  uint32_t calendar[SRSRAN_UE_SL_SIM_HORIZON];
+  uint64_t tti;
+
+  // Transmissions of the current subframe, sorted by cell
+  srsran_ue_sl_sim_tx_t* batch;
+  srsran_ue_sl_sim_tx_t* batch_sorted;
+  uint32_t               nof_batch;
+
+  srsran_random_t          random;
+  void*                    workers;
+  srsran_ue_sl_sim_stats_t stats;
+} srsran_ue_sl_sim_t;
+
+SRSRAN_API void srsran_ue_sl_sim_cfg_default(srsran_ue_sl_sim_cfg_t* cfg);
+
+/* Places the vehicles and selects their first resources in the given pool */
+SRSRAN_API int srsran_ue_sl_sim_init(srsran_ue_sl_sim_t*                   q,
+                                     const srsran_ue_sl_sim_cfg_t*         cfg,
+                                     srsran_cell_sl_t                      cell,
+                                     const srsran_sl_comm_resource_pool_t* pool);
+
+SRSRAN_API void srsran_ue_sl_sim_free(srsran_ue_sl_sim_t* q);
+
+/**
+ * Replaces the BLER curve of a channel, by default derived from the code rate, with nof_points pairs of SINR in dB, in
+ * increasing order, and BLER. It is interpolated linearly in between and held constant outside.
+ */
+SRSRAN_API int srsran_ue_sl_sim_set_bler(srsran_ue_sl_sim_t*        q,
+                                         srsran_ue_sl_sim_channel_t channel,
+                                         const float*               sinr_db,
+                                         const float*               bler,
+                                         uint32_t                   nof_points);
+
+/* BLER of a channel at the given SINR */
+SRSRAN_API float
+srsran_ue_sl_sim_get_bler(const srsran_ue_sl_sim_t* q, srsran_ue_sl_sim_channel_t channel, float sinr_db);
+
+/* Simulates nof_subframes more subframes */
+SRSRAN_API int srsran_ue_sl_sim_run(srsran_ue_sl_sim_t* q, uint64_t nof_subframes);
+
+SRSRAN_API void srsran_ue_sl_sim_get_stats(srsran_ue_sl_sim_t* q, srsran_ue_sl_sim_stats_t* stats);
+
+SRSRAN_API void srsran_ue_sl_sim_fprint_stats(FILE* f, srsran_ue_sl_sim_t* q);
+
+#endif // SRSRAN_UE_SL_SIM_H
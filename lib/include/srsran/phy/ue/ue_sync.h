@@ -55,6 +55,11 @@
 #include "srsran/phy/dft/ofdm.h"
 #include "srsran/phy/common/timestamp.h"
 #include "srsran/phy/io/filesource.h"
+#include "srsran/phy/sync/psss.h"
+#include "srsran/phy/sync/ssss.h"
+#include "srsran/phy/phch/psbch.h"
+#include "srsran/phy/phch/mib_sl.h"
+#include "srsran/phy/ch_estimation/chest_sl.h"
 
 #define DEFAULT_SAMPLE_OFFSET_CORRECT_PERIOD  10
 #define DEFAULT_SFO_EMA_COEFF                 0.1
@@ -69,7 +74,9 @@
 
 #define DEFAULT_CFO_EMA_TRACK 0.05
 
-typedef enum SRSRAN_API { SYNC_MODE_PSS, SYNC_MODE_GNSS } srsran_ue_sync_mode_t;
+#define DEFAULT_SLSS_TRACK_MAX_LOST 3 // Number of consecutive missed SLSS periods before going back to find
+
+typedef enum SRSRAN_API { SYNC_MODE_PSS, SYNC_MODE_GNSS, SYNC_MODE_SLSS } srsran_ue_sync_mode_t;
 typedef enum SRSRAN_API { SF_FIND, SF_TRACK} srsran_ue_sync_state_t;
 
 //#define MEASURE_EXEC_TIME
@@ -91,6 +98,7 @@ typedef struct SRSRAN_API {
   void *stream_single;
   int (*recv_callback)(void*, cf_t* [SRSRAN_MAX_CHANNELS], uint32_t, srsran_timestamp_t*);
   int (*recv_callback_single)(void*, void*, uint32_t, srsran_timestamp_t*);
+  int (*start_rx_timed_callback)(void*, srsran_timestamp_t*); ///< Optional, starts streaming at a given time
   srsran_timestamp_t last_timestamp;
   
   uint32_t nof_rx_antennas; 
@@ -144,6 +152,30 @@ typedef struct SRSRAN_API {
   float sfo_ema; 
   
 
+  /* Sidelink synchronization signal (SLSS) based sync */
+  srsran_cell_sl_t  cell_sl;
+  srsran_psss_t     psss;
+  srsran_ssss_t     ssss;
+  srsran_psbch_t    psbch;
+  srsran_chest_sl_t psbch_chest;
+  srsran_ofdm_t     slss_fft;
+  cf_t*             slss_sf_time;
+  cf_t*             slss_sf_symbols;
+  cf_t*             slss_equalized;
+  bool              slss_is_init;
+  uint32_t          slss_sf_cnt;           ///< Subframes since the last SLSS occasion
+  uint32_t          slss_lost_cnt;         ///< Consecutive SLSS occasions not found while tracking
+  uint32_t          slss_miss_cnt;         ///< Consecutive subframes without SLSS while searching
+  uint32_t          slss_track_max_offset; ///< Half width (in samples) of the tracking window
+  uint64_t          slss_find_cnt;         ///< Number of full SLSS searches
+  uint64_t          slss_find_usec;        ///< Time spent in full SLSS searches
+  uint64_t          slss_track_cnt;        ///< Number of SLSS tracking correlations
+  uint64_t          slss_track_usec;       ///< Time spent in SLSS tracking correlations
+
+  /* GNSS alignment statistics, for the last acquisition */
+  uint64_t gnss_align_nof_samples; ///< Samples received and discarded to align to the second boundary
+  uint64_t gnss_align_usec;        ///< Wall-clock time of the alignment
+
   #ifdef MEASURE_EXEC_TIME
   float mean_exec_time;
   #endif
@@ -203,6 +235,8 @@ SRSRAN_API void srsran_ue_sync_file_wrap(srsran_ue_sync_t *q,
 SRSRAN_API int srsran_ue_sync_set_cell(srsran_ue_sync_t *q,
                                        srsran_cell_t cell);
 
+SRSRAN_API int srsran_ue_sync_set_cell_sl(srsran_ue_sync_t* q, srsran_cell_sl_t cell_sl);
+
 SRSRAN_API void srsran_ue_sync_cfo_reset(srsran_ue_sync_t* q, float init_cfo_hz);
 
 SRSRAN_API void srsran_ue_sync_reset(srsran_ue_sync_t *q);
@@ -221,6 +255,9 @@ SRSRAN_API int srsran_ue_sync_start_agc(srsran_ue_sync_t* q,
 
 SRSRAN_API uint32_t srsran_ue_sync_sf_len(srsran_ue_sync_t* q);
 
+SRSRAN_API void srsran_ue_sync_set_start_rx_timed_callback(srsran_ue_sync_t* q,
+                                                          int (*start_rx_timed_callback)(void*, srsran_timestamp_t*));
+
 SRSRAN_API void srsran_ue_sync_set_agc_period(srsran_ue_sync_t* q, uint32_t period);
 
 SRSRAN_API int
@@ -279,7 +316,16 @@ SRSRAN_API int srsran_ue_sync_run_find_gnss_mode(srsran_ue_sync_t* q,
 
 SRSRAN_API int srsran_ue_sync_run_track_gnss_mode(srsran_ue_sync_t* q, cf_t* input_buffer[SRSRAN_MAX_CHANNELS]);
 
+SRSRAN_API int srsran_ue_sync_run_find_slss_mode(srsran_ue_sync_t* q, cf_t* input_buffer[SRSRAN_MAX_CHANNELS]);
+
+SRSRAN_API int srsran_ue_sync_run_track_slss_mode(srsran_ue_sync_t* q, cf_t* input_buffer[SRSRAN_MAX_CHANNELS]);
+
+SRSRAN_API void srsran_ue_sync_slss_fprint_stats(FILE* f, srsran_ue_sync_t* q);
+
 SRSRAN_API int srsran_ue_sync_set_tti_from_timestamp(srsran_ue_sync_t* q, srsran_timestamp_t* rx_timestamp);
 
+/* Subframe of a GNSS time counted from DFN 0, 3GPP TS 36.331 Section 5.10.14 */
+SRSRAN_API uint32_t srsran_ue_sync_gnss_dfn_sf(const srsran_timestamp_t* t, uint32_t sfn_offset);
+
 #endif // SRSRAN_UE_SYNC_H
 
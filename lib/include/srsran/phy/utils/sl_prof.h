@@ -0,0 +1,142 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         sl_prof.h
+ *
+ *  Description:  Latency histograms of the sidelink TX and RX stages.
+ *                SRSRAN_SL_PROF_START() and SRSRAN_SL_PROF_STOP() time a
+ *                stage into a process wide histogram with 4 bins per octave,
+ *                updated with relaxed atomics so any thread can record
+ *                without locks. Both macros compile to nothing unless
+ *                ENABLE_TIMEPROF is defined, as for the C++ tprof.
+ *
+ *                srsran_sl_prof_publish() turns the measurements since the
+ *                previous call into p50, p99 and max per stage and copies
+ *                them, under a sequence count, into a page mapped from a
+ *                file, e.g. under /dev/shm, that another process polls with
+ *                srsran_sl_prof_reader_read().
+ *
+ *  Reference:
+ *****************************************************************************/
+
+#ifndef SRSRAN_SL_PROF_H
+#define SRSRAN_SL_PROF_H
+
+#include <stdint.h>
+#include <time.h>
+
+#include "srsran/config.h"
+
+#define SRSRAN_SL_PROF_MAGIC 0x31504c53 // "SLP1"
+#define SRSRAN_SL_PROF_VERSION 1
+
+// 4 bins per octave up to 2^33 ns, longer stages fall in the last bin
+#define SRSRAN_SL_PROF_NOF_BINS 128
+
+typedef enum SRSRAN_API {
+  SRSRAN_SL_PROF_RX_FFT = 0,
+  SRSRAN_SL_PROF_RX_PSCCH_CHEST, ///< Channel estimation and equalization of one PSCCH candidate
+  SRSRAN_SL_PROF_RX_PSCCH_DECODE,
+  SRSRAN_SL_PROF_RX_PSSCH_CHEST,
+  SRSRAN_SL_PROF_RX_PSSCH_DEMOD, ///< Transform predecoding, demodulation, descrambling and deinterleaving
+  SRSRAN_SL_PROF_RX_PSSCH_TURBO, ///< Rate matching, turbo decoding and CRC
+  SRSRAN_SL_PROF_RX_LOG,
+  SRSRAN_SL_PROF_RX_SUBFRAME, ///< Whole subframe, from the FFT to the last log line
+  SRSRAN_SL_PROF_TX_PSCCH_ENCODE,
+  SRSRAN_SL_PROF_TX_PSSCH_ENCODE,
+  SRSRAN_SL_PROF_TX_IFFT,
+  SRSRAN_SL_PROF_TX_SEND,
+  SRSRAN_SL_PROF_TX_LOG,
+  SRSRAN_SL_PROF_NOF_STAGES,
+} srsran_sl_prof_stage_t;
+
+typedef struct SRSRAN_API {
+  uint64_t count;       ///< Measurements in the last period
+  uint64_t total_count; ///< Measurements since start
+  uint64_t p50_ns;      ///< Upper edge of the bin holding the percentile, at most 25% above it, capped to max_ns
+  uint64_t p99_ns;
+  uint64_t max_ns; ///< Exact
+} srsran_sl_prof_stats_t;
+
+/* Published page. All fields little endian */
+typedef struct SRSRAN_API {
+  uint32_t               magic;
+  uint32_t               version;
+  uint32_t               nof_stages;
+  uint32_t               reserved;
+  uint64_t               seq;          ///< Odd while the writer updates the page
+  uint64_t               timestamp_us; ///< Wall clock time of the snapshot
+  uint64_t               period_us;    ///< Time covered by the snapshot
+  uint64_t               late;         ///< Subframes late in the last period
+  uint64_t               total_late;
+  srsran_sl_prof_stats_t stage[SRSRAN_SL_PROF_NOF_STAGES];
+} srsran_sl_prof_snapshot_t;
+
+typedef struct SRSRAN_API {
+  int                              fd;
+  const srsran_sl_prof_snapshot_t* page;
+} srsran_sl_prof_reader_t;
+
+static inline uint64_t srsran_sl_prof_now_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000UL + (uint64_t)ts.tv_nsec;
+}
+
+#ifdef ENABLE_TIMEPROF
+#define SRSRAN_SL_PROF_START(t) uint64_t t = srsran_sl_prof_now_ns()
+#define SRSRAN_SL_PROF_STOP(stage, t) srsran_sl_prof_add(stage, srsran_sl_prof_now_ns() - (t))
+#define SRSRAN_SL_PROF_LATE() srsran_sl_prof_add_late()
+#else
+#define SRSRAN_SL_PROF_START(t)
+#define SRSRAN_SL_PROF_STOP(stage, t)
+#define SRSRAN_SL_PROF_LATE()
+#endif /* ENABLE_TIMEPROF */
+
+SRSRAN_API const char* srsran_sl_prof_stage_name(srsran_sl_prof_stage_t stage);
+
+/* Records one measurement, safe from any thread */
+SRSRAN_API void srsran_sl_prof_add(srsran_sl_prof_stage_t stage, uint64_t duration_ns);
+
+/* Counts a subframe that missed its deadline */
+SRSRAN_API void srsran_sl_prof_add_late();
+
+/* Statistics of the measurements since the previous snapshot. Must be called from one thread only */
+SRSRAN_API void srsran_sl_prof_snapshot(srsran_sl_prof_snapshot_t* s);
+
+/* Creates, or truncates, the file the snapshots are published to */
+SRSRAN_API int srsran_sl_prof_publish_init(const char* path);
+
+/* Takes a snapshot and publishes it, if a file was set up with srsran_sl_prof_publish_init() */
+SRSRAN_API void srsran_sl_prof_publish();
+
+SRSRAN_API void srsran_sl_prof_publish_free();
+
+SRSRAN_API int srsran_sl_prof_reader_init(srsran_sl_prof_reader_t* q, const char* path);
+
+/* Copies the last published snapshot. Never blocks the publisher, retries while it updates the page */
+SRSRAN_API int srsran_sl_prof_reader_read(srsran_sl_prof_reader_t* q, srsran_sl_prof_snapshot_t* s);
+
+SRSRAN_API void srsran_sl_prof_reader_free(srsran_sl_prof_reader_t* q);
+
+#endif // SRSRAN_SL_PROF_H
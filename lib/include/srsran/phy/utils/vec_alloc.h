@@ -0,0 +1,105 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         vec_alloc.h
+ *
+ *  Description:  Backends of srsran_vec_malloc() and its typed wrappers.
+ *                The buffers are released with free() throughout the tree,
+ *                so every backend returns memory owned by the C library.
+ *
+ *                The default backend is posix_memalign(). The hugepage
+ *                backend aligns buffers of at least one hugepage to the
+ *                hugepage size and marks every buffer for transparent
+ *                hugepages, the smaller ones so that the kernel collapses
+ *                the heap ranges they fill.
+ *                Independently of the backend, buffers can be bound to a
+ *                NUMA node, per calling thread or per buffer, in which case
+ *                they are rounded to whole pages so the binding does not
+ *                spill onto their neighbours.
+ *
+ *                The backend is read from SRSRAN_VEC_ALLOC ("default" or
+ *                "hugepage") and the node of every thread from
+ *                SRSRAN_VEC_NUMA_NODE at the first allocation, unless the
+ *                API selected them before.
+ *
+ *  Reference:
+ *****************************************************************************/
+
+#ifndef SRSRAN_VEC_ALLOC_H
+#define SRSRAN_VEC_ALLOC_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "srsran/config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SRSRAN_VEC_ALLOC_MAX_NODES 8
+#define SRSRAN_VEC_ALLOC_NODE_ANY (-1)    ///< Left to the kernel, normally the node of the first thread touching it
+#define SRSRAN_VEC_ALLOC_NODE_THREAD (-2) ///< Node of the calling thread
+
+typedef enum SRSRAN_API {
+  SRSRAN_VEC_ALLOC_DEFAULT = 0,
+  SRSRAN_VEC_ALLOC_HUGEPAGE,
+  SRSRAN_VEC_ALLOC_CUSTOM,
+} srsran_vec_alloc_backend_t;
+
+/* A custom backend returns size bytes aligned to at least align, which free() must be able to release */
+typedef void* (*srsran_vec_alloc_func_t)(void* arg, size_t size, size_t align);
+
+typedef struct SRSRAN_API {
+  uint64_t nof_allocs;
+  uint64_t nof_failed;
+  uint64_t bytes;          ///< Requested
+  uint64_t bytes_hugepage; ///< In buffers marked for transparent hugepages
+  uint64_t bytes_node[SRSRAN_VEC_ALLOC_MAX_NODES];
+  uint64_t nof_bind_failed;
+} srsran_vec_alloc_stats_t;
+
+/* Applies to the buffers allocated afterwards, by any thread */
+SRSRAN_API void srsran_vec_alloc_set_backend(srsran_vec_alloc_backend_t backend);
+
+SRSRAN_API void srsran_vec_alloc_set_custom(srsran_vec_alloc_func_t func, void* arg);
+
+SRSRAN_API srsran_vec_alloc_backend_t srsran_vec_alloc_get_backend(void);
+
+/* NUMA node of the buffers allocated afterwards by the calling thread, SRSRAN_VEC_ALLOC_NODE_ANY to leave them to the
+ * kernel. Returns SRSRAN_ERROR if the node does not exist. */
+SRSRAN_API int srsran_vec_alloc_set_thread_node(int node);
+
+SRSRAN_API int srsran_vec_alloc_get_thread_node(void);
+
+/* Allocates with the current backend, aligned for SIMD, preferably on a NUMA node */
+SRSRAN_API void* srsran_vec_alloc(size_t size, int node);
+
+SRSRAN_API void srsran_vec_alloc_get_stats(srsran_vec_alloc_stats_t* stats);
+
+SRSRAN_API void srsran_vec_alloc_fprint_stats(FILE* f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SRSRAN_VEC_ALLOC_H
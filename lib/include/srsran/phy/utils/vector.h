@@ -79,6 +79,7 @@ SRSRAN_API void srsran_vec_xor_bbb(int8_t* x, int8_t* y, int8_t* z, const uint32
 SRSRAN_API float srsran_vec_acc_ff(const float* x, const uint32_t len);
 SRSRAN_API cf_t srsran_vec_acc_cc(const cf_t* x, const uint32_t len);
 
+/* Aligned for SIMD by the allocator selected in vec_alloc.h, released with free() */
 SRSRAN_API void* srsran_vec_malloc(uint32_t size);
 SRSRAN_API cf_t*  srsran_vec_cf_malloc(uint32_t size);
 SRSRAN_API float* srsran_vec_f_malloc(uint32_t size);
@@ -39,10 +39,12 @@ extern "C" {
 #include "srsran/phy/utils/convolution.h"
 #include "srsran/phy/utils/debug.h"
 #include "srsran/phy/utils/ringbuffer.h"
+#include "srsran/phy/utils/sl_prof.h"
 #include "srsran/phy/utils/vector.h"
 
 #include "srsran/phy/common/phy_common.h"
 #include "srsran/phy/common/sequence.h"
+#include "srsran/phy/common/sl_precfg.h"
 #include "srsran/phy/common/timestamp.h"
 #include "srsran/phy/utils/phy_logger.h"
 
@@ -77,6 +79,7 @@ extern "C" {
 #include "srsran/phy/io/filesource.h"
 #include "srsran/phy/io/netsink.h"
 #include "srsran/phy/io/netsource.h"
+#include "srsran/phy/io/sl_export.h"
 
 #include "srsran/phy/modem/demod_hard.h"
 #include "srsran/phy/modem/demod_soft.h"
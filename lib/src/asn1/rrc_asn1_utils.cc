@@ -976,6 +976,217 @@ sib13_t make_sib13(const asn1::rrc::sib_type13_r9_s& asn1_type)
   return sib13;
 }
 
+/***************************
+ *   Sidelink V2X Config
+ **************************/
+
+// The leftmost bit of SubframeBitmapSL-r14 is the first subframe
+static std::string make_sl_sf_bitmap(const asn1::rrc::sf_bitmap_sl_r14_c& asn1_type)
+{
+  using types = asn1::rrc::sf_bitmap_sl_r14_c::types_opts;
+  switch (asn1_type.type().value) {
+    case types::bs10_r14:
+      return asn1_type.bs10_r14().to_string();
+    case types::bs16_r14:
+      return asn1_type.bs16_r14().to_string();
+    case types::bs20_r14:
+      return asn1_type.bs20_r14().to_string();
+    case types::bs30_r14:
+      return asn1_type.bs30_r14().to_string();
+    case types::bs40_r14:
+      return asn1_type.bs40_r14().to_string();
+    case types::bs50_r14:
+      return asn1_type.bs50_r14().to_string();
+    case types::bs60_r14:
+      return asn1_type.bs60_r14().to_string();
+    case types::bs100_r14:
+      return asn1_type.bs100_r14().to_string();
+    default:
+      return "";
+  }
+}
+
+static bool to_asn1(asn1::rrc::sf_bitmap_sl_r14_c* asn1_type, const std::string& bitmap)
+{
+  using types = asn1::rrc::sf_bitmap_sl_r14_c::types_opts;
+  switch (bitmap.size()) {
+    case 10:
+      asn1_type->set_bs10_r14().from_string(bitmap);
+      break;
+    case 16:
+      asn1_type->set_bs16_r14().from_string(bitmap);
+      break;
+    case 20:
+      asn1_type->set_bs20_r14().from_string(bitmap);
+      break;
+    case 30:
+      asn1_type->set_bs30_r14().from_string(bitmap);
+      break;
+    case 40:
+      asn1_type->set_bs40_r14().from_string(bitmap);
+      break;
+    case 50:
+      asn1_type->set_bs50_r14().from_string(bitmap);
+      break;
+    case 60:
+      asn1_type->set_bs60_r14().from_string(bitmap);
+      break;
+    case 100:
+      asn1_type->set_bs100_r14().from_string(bitmap);
+      break;
+    default:
+      asn1_type->set(types::nulltype);
+      return false;
+  }
+  return true;
+}
+
+int make_sl_comm_resource_pool(srsran_sl_comm_resource_pool_t*                   pool,
+                               const srsran_cell_sl_t&                           cell,
+                               const asn1::rrc::sl_v2x_precfg_comm_pool_r14_s& asn1_type)
+{
+  if (srsran_sl_comm_resource_pool_get_default_config(pool, cell) != SRSRAN_SUCCESS) {
+    return SRSRAN_ERROR;
+  }
+
+  pool->sl_offset_ind = 0;
+  if (asn1_type.sl_offset_ind_r14_present) {
+    pool->sl_offset_ind = asn1_type.sl_offset_ind_r14.type().value == asn1::rrc::sl_offset_ind_r12_c::types::small_r12
+                              ? asn1_type.sl_offset_ind_r14.small_r12()
+                              : asn1_type.sl_offset_ind_r14.large_r12();
+  }
+
+  std::string bitmap = make_sl_sf_bitmap(asn1_type.sl_sf_r14);
+  if (bitmap.empty() || bitmap.size() > SRSRAN_SL_MAX_PERIOD_LENGTH) {
+    return SRSRAN_ERROR;
+  }
+  pool->sf_bitmap_tm34_len = bitmap.size();
+  for (uint32_t i = 0; i < bitmap.size(); ++i) {
+    pool->sf_bitmap_tm34[i] = bitmap[i] == '1';
+  }
+
+  pool->adjacency_pscch_pssch = asn1_type.adjacency_pscch_pssch_r14;
+  pool->size_sub_channel      = asn1_type.size_subch_r14.to_number();
+  pool->num_sub_channel       = asn1_type.num_subch_r14.to_number();
+  pool->start_prb_sub_channel = asn1_type.start_rb_subch_r14;
+  pool->start_prb_pscch_pool  = asn1_type.start_rb_pscch_pool_r14_present ? asn1_type.start_rb_pscch_pool_r14 : 0;
+  pool->nof_slss_offset       = 0;
+
+  if (srsran_sl_comm_resource_pool_update_sf_map(pool) != SRSRAN_SUCCESS ||
+      not srsran_sl_comm_resource_pool_is_valid(pool, cell)) {
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+void to_asn1(asn1::rrc::sl_v2x_precfg_comm_pool_r14_s* asn1_type, const srsran_sl_comm_resource_pool_t& pool)
+{
+  *asn1_type = {};
+  if (pool.sl_offset_ind > 0) {
+    asn1_type->sl_offset_ind_r14_present = true;
+    if (pool.sl_offset_ind < SRSRAN_SL_MAX_PERIOD_LENGTH) {
+      asn1_type->sl_offset_ind_r14.set_small_r12() = pool.sl_offset_ind;
+    } else {
+      asn1_type->sl_offset_ind_r14.set_large_r12() = pool.sl_offset_ind;
+    }
+  }
+
+  std::string bitmap(pool.sf_bitmap_tm34_len, '0');
+  for (uint32_t i = 0; i < pool.sf_bitmap_tm34_len; ++i) {
+    bitmap[i] = pool.sf_bitmap_tm34[i] ? '1' : '0';
+  }
+  if (not to_asn1(&asn1_type->sl_sf_r14, bitmap)) {
+    asn1::log_error("Subframe bitmap of %d bits has no SubframeBitmapSL-r14 equivalent\n", pool.sf_bitmap_tm34_len);
+  }
+
+  asn1_type->adjacency_pscch_pssch_r14 = pool.adjacency_pscch_pssch;
+  if (not asn1::number_to_enum(asn1_type->size_subch_r14, pool.size_sub_channel)) {
+    asn1::log_error("Sub-channel size %d has no sizeSubchannel-r14 equivalent\n", pool.size_sub_channel);
+  }
+  if (not asn1::number_to_enum(asn1_type->num_subch_r14, pool.num_sub_channel)) {
+    asn1::log_error("Number of sub-channels %d has no numSubchannel-r14 equivalent\n", pool.num_sub_channel);
+  }
+  asn1_type->start_rb_subch_r14 = pool.start_prb_sub_channel;
+  if (not pool.adjacency_pscch_pssch) {
+    asn1_type->start_rb_pscch_pool_r14_present = true;
+    asn1_type->start_rb_pscch_pool_r14         = pool.start_prb_pscch_pool;
+  }
+}
+
+int make_sl_v2x_precfg_freq(srsran_sl_v2x_precfg_freq_t*                      cfg,
+                            const srsran_cell_sl_t&                           cell,
+                            const asn1::rrc::sl_v2x_precfg_freq_info_r14_s& asn1_type)
+{
+  *cfg = {};
+  if (asn1_type.v2x_comm_rx_pool_list_r14.size() > SRSRAN_SL_MAX_NOF_RX_POOLS ||
+      asn1_type.v2x_comm_tx_pool_list_r14.size() > SRSRAN_SL_MAX_NOF_TX_POOLS) {
+    return SRSRAN_ERROR;
+  }
+
+  // The SLSS subframes of the carrier are in no pool
+  uint32_t slss_offset[SRSRAN_SL_MAX_NOF_SLSS_OFFSET] = {};
+  uint32_t nof_slss_offset                            = 0;
+  if (asn1_type.v2x_comm_precfg_sync_r14_present) {
+    const asn1::rrc::sl_v2x_sync_offset_inds_r14_s& inds = asn1_type.v2x_comm_precfg_sync_r14.sync_offset_inds_r14;
+    slss_offset[nof_slss_offset++]                        = inds.sync_offset_ind1_r14;
+    slss_offset[nof_slss_offset++]                        = inds.sync_offset_ind2_r14;
+    if (inds.sync_offset_ind3_r14_present) {
+      slss_offset[nof_slss_offset++] = inds.sync_offset_ind3_r14;
+    }
+  }
+
+  cfg->nof_rx_pools = asn1_type.v2x_comm_rx_pool_list_r14.size();
+  cfg->nof_tx_pools = asn1_type.v2x_comm_tx_pool_list_r14.size();
+  for (uint32_t i = 0; i < cfg->nof_rx_pools + cfg->nof_tx_pools; ++i) {
+    bool                            rx   = i < cfg->nof_rx_pools;
+    srsran_sl_comm_resource_pool_t* pool = rx ? &cfg->rx_pools[i] : &cfg->tx_pools[i - cfg->nof_rx_pools];
+    if (make_sl_comm_resource_pool(pool,
+                                   cell,
+                                   rx ? asn1_type.v2x_comm_rx_pool_list_r14[i]
+                                      : asn1_type.v2x_comm_tx_pool_list_r14[i - cfg->nof_rx_pools]) != SRSRAN_SUCCESS) {
+      return SRSRAN_ERROR;
+    }
+    pool->nof_slss_offset = nof_slss_offset;
+    std::copy(slss_offset, slss_offset + SRSRAN_SL_MAX_NOF_SLSS_OFFSET, pool->slss_offset);
+    if (srsran_sl_comm_resource_pool_update_sf_map(pool) != SRSRAN_SUCCESS) {
+      return SRSRAN_ERROR;
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+void to_asn1(asn1::rrc::sl_v2x_precfg_freq_info_r14_s* asn1_type, const srsran_sl_v2x_precfg_freq_t& cfg)
+{
+  asn1_type->v2x_comm_rx_pool_list_r14.resize(cfg.nof_rx_pools);
+  for (uint32_t i = 0; i < cfg.nof_rx_pools; ++i) {
+    to_asn1(&asn1_type->v2x_comm_rx_pool_list_r14[i], cfg.rx_pools[i]);
+  }
+  asn1_type->v2x_comm_tx_pool_list_r14.resize(cfg.nof_tx_pools);
+  for (uint32_t i = 0; i < cfg.nof_tx_pools; ++i) {
+    to_asn1(&asn1_type->v2x_comm_tx_pool_list_r14[i], cfg.tx_pools[i]);
+  }
+  // There are no pedestrian pools of their own, they transmit on the vehicle pools
+  asn1_type->p2x_comm_tx_pool_list_r14 = asn1_type->v2x_comm_tx_pool_list_r14;
+
+  // Two offsets are mandatory, a single one is sent twice
+  const srsran_sl_comm_resource_pool_t* first = cfg.nof_rx_pools ? &cfg.rx_pools[0] : &cfg.tx_pools[0];
+  asn1_type->v2x_comm_precfg_sync_r14_present = (cfg.nof_rx_pools || cfg.nof_tx_pools) && first->nof_slss_offset > 0;
+  if (asn1_type->v2x_comm_precfg_sync_r14_present) {
+    asn1::rrc::sl_v2x_sync_offset_inds_r14_s& inds = asn1_type->v2x_comm_precfg_sync_r14.sync_offset_inds_r14;
+
+    inds.sync_offset_ind1_r14         = first->slss_offset[0];
+    inds.sync_offset_ind2_r14         = first->slss_offset[first->nof_slss_offset > 1 ? 1 : 0];
+    inds.sync_offset_ind3_r14_present = first->nof_slss_offset > 2;
+    inds.sync_offset_ind3_r14         = first->nof_slss_offset > 2 ? first->slss_offset[2] : 0;
+
+    // Not part of the pools, the most common values keep the message encodable
+    using sync_s                                               = asn1::rrc::sl_precfg_v2x_sync_r14_s;
+    asn1_type->v2x_comm_precfg_sync_r14.filt_coef_r14          = asn1::rrc::filt_coef_opts::fc4;
+    asn1_type->v2x_comm_precfg_sync_r14.sync_ref_min_hyst_r14  = sync_s::sync_ref_min_hyst_r14_opts::db0;
+    asn1_type->v2x_comm_precfg_sync_r14.sync_ref_diff_hyst_r14 = sync_s::sync_ref_diff_hyst_r14_opts::db0;
+  }
+}
+
 } // namespace srsran
 
 namespace asn1 {
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+
+#include "srsran/asn1/rrc_asn1.h"
+#include "srsran/asn1/rrc_asn1_utils.h"
+#include "srsran/common/test_common.h"
+#include "srsran/phy/common/sl_precfg.h"
+
+using namespace asn1::rrc;
+
+static const srsran_cell_sl_t cell = {SRSRAN_SIDELINK_TM4, 0, 50, SRSRAN_CP_NORM};
+
+/* Pool of 3 sub-channels of 10 PRB from PRB 2, with a 20 subframe bitmap */
+static int make_pool(srsran_sl_comm_resource_pool_t* pool, uint32_t sl_offset_ind, bool adjacency)
+{
+  TESTASSERT(srsran_sl_comm_resource_pool_get_default_config(pool, cell) == SRSRAN_SUCCESS);
+  pool->sl_offset_ind         = sl_offset_ind;
+  pool->sf_bitmap_tm34_len    = 20;
+  pool->adjacency_pscch_pssch = adjacency;
+  pool->size_sub_channel      = 10;
+  pool->num_sub_channel       = 3;
+  pool->start_prb_sub_channel = 2;
+  pool->start_prb_pscch_pool  = adjacency ? 0 : 40;
+  for (uint32_t i = 0; i < pool->sf_bitmap_tm34_len; i++) {
+    pool->sf_bitmap_tm34[i] = (i % 3) != 1;
+  }
+  TESTASSERT(srsran_sl_comm_resource_pool_update_sf_map(pool) == SRSRAN_SUCCESS);
+  return SRSRAN_SUCCESS;
+}
+
+static int compare_pools(const srsran_sl_comm_resource_pool_t* a, const srsran_sl_comm_resource_pool_t* b)
+{
+  TESTASSERT(a->sl_offset_ind == b->sl_offset_ind);
+  TESTASSERT(a->sf_bitmap_tm34_len == b->sf_bitmap_tm34_len);
+  TESTASSERT(memcmp(a->sf_bitmap_tm34, b->sf_bitmap_tm34, a->sf_bitmap_tm34_len) == 0);
+  TESTASSERT(a->adjacency_pscch_pssch == b->adjacency_pscch_pssch);
+  TESTASSERT(a->size_sub_channel == b->size_sub_channel);
+  TESTASSERT(a->num_sub_channel == b->num_sub_channel);
+  TESTASSERT(a->start_prb_sub_channel == b->start_prb_sub_channel);
+  TESTASSERT(a->start_prb_pscch_pool == b->start_prb_pscch_pool);
+  TESTASSERT(a->nof_slss_offset == b->nof_slss_offset);
+  TESTASSERT(memcmp(a->slss_offset, b->slss_offset, a->nof_slss_offset * sizeof(uint32_t)) == 0);
+  TESTASSERT(memcmp(a->sf_map, b->sf_map, sizeof(a->sf_map)) == 0);
+  return SRSRAN_SUCCESS;
+}
+
+/* Pool to SL-V2X-PreconfigCommPool-r14, through UPER and back. sl-OffsetIndicator-r12 is small-r12 below 320 and
+ * large-r12 from there, and is absent for 0 */
+static int test_pool(uint32_t sl_offset_ind, bool adjacency)
+{
+  srsran_sl_comm_resource_pool_t pool = {};
+  TESTASSERT(make_pool(&pool, sl_offset_ind, adjacency) == SRSRAN_SUCCESS);
+
+  sl_v2x_precfg_comm_pool_r14_s asn1_pool;
+  srsran::to_asn1(&asn1_pool, pool);
+  TESTASSERT(asn1_pool.sl_offset_ind_r14_present == (sl_offset_ind > 0));
+  if (sl_offset_ind > 0) {
+    sl_offset_ind_r12_c::types expected =
+        sl_offset_ind < SRSRAN_SL_MAX_PERIOD_LENGTH ? sl_offset_ind_r12_c::types::small_r12
+                                                    : sl_offset_ind_r12_c::types::large_r12;
+    TESTASSERT(asn1_pool.sl_offset_ind_r14.type() == expected);
+  }
+  TESTASSERT(asn1_pool.start_rb_pscch_pool_r14_present == not adjacency);
+
+  uint8_t       buf[256];
+  asn1::bit_ref bref(buf, sizeof(buf));
+  TESTASSERT(asn1_pool.pack(bref) == asn1::SRSASN_SUCCESS);
+  sl_v2x_precfg_comm_pool_r14_s asn1_rx;
+  asn1::cbit_ref                cbref(buf, bref.distance_bytes());
+  TESTASSERT(asn1_rx.unpack(cbref) == asn1::SRSASN_SUCCESS);
+
+  srsran_sl_comm_resource_pool_t pool_rx = {};
+  TESTASSERT(srsran::make_sl_comm_resource_pool(&pool_rx, cell, asn1_rx) == SRSRAN_SUCCESS);
+  TESTASSERT(compare_pools(&pool, &pool_rx) == SRSRAN_SUCCESS);
+  return SRSRAN_SUCCESS;
+}
+
+/* Carrier of 2 RX and 1 TX pools sharing 3 SLSS offsets, through SL-V2X-Preconfiguration-r14 */
+static int test_freq()
+{
+  static srsran_sl_v2x_precfg_freq_t cfg = {};
+  cfg.nof_rx_pools                       = 2;
+  cfg.nof_tx_pools                       = 1;
+
+  // Offsets on both sides of the small-r12 and large-r12 boundary, the second pool is not adjacent
+  srsran_sl_comm_resource_pool_t* pools[]  = {&cfg.rx_pools[0], &cfg.rx_pools[1], &cfg.tx_pools[0]};
+  uint32_t                        offset[] = {0, SRSRAN_SL_MAX_PERIOD_LENGTH - 1, SRSRAN_SL_MAX_PERIOD_LENGTH};
+  for (uint32_t i = 0; i < 3; i++) {
+    TESTASSERT(make_pool(pools[i], offset[i], i != 1) == SRSRAN_SUCCESS);
+    pools[i]->nof_slss_offset = 3;
+    pools[i]->slss_offset[0]  = 2;
+    pools[i]->slss_offset[1]  = 80;
+    pools[i]->slss_offset[2]  = 159;
+    TESTASSERT(srsran_sl_comm_resource_pool_update_sf_map(pools[i]) == SRSRAN_SUCCESS);
+  }
+
+  sl_v2x_precfg_r14_s precfg;
+  precfg.v2x_precfg_freq_list_r14.resize(1);
+  sl_v2x_precfg_freq_info_r14_s& freq = precfg.v2x_precfg_freq_list_r14[0];
+  asn1::number_to_enum(freq.v2x_comm_precfg_general_r14.sl_bw_r12, cell.nof_prb);
+  freq.v2x_comm_precfg_general_r14.tdd_cfg_sl_r12.sf_assign_sl_r12 = tdd_cfg_sl_r12_s::sf_assign_sl_r12_opts::none;
+  freq.sync_prio_r14 = sl_v2x_precfg_freq_info_r14_s::sync_prio_r14_opts::gnss;
+  srsran::to_asn1(&freq, cfg);
+
+  uint8_t       buf[4096];
+  asn1::bit_ref bref(buf, sizeof(buf));
+  TESTASSERT(precfg.pack(bref) == asn1::SRSASN_SUCCESS);
+  sl_v2x_precfg_r14_s precfg_rx;
+  asn1::cbit_ref      cbref(buf, bref.distance_bytes());
+  TESTASSERT(precfg_rx.unpack(cbref) == asn1::SRSASN_SUCCESS);
+  TESTASSERT(precfg_rx.v2x_precfg_freq_list_r14.size() == 1);
+
+  static srsran_sl_v2x_precfg_freq_t cfg_rx;
+  TESTASSERT(srsran::make_sl_v2x_precfg_freq(&cfg_rx, cell, precfg_rx.v2x_precfg_freq_list_r14[0]) == SRSRAN_SUCCESS);
+  TESTASSERT(cfg_rx.nof_rx_pools == cfg.nof_rx_pools && cfg_rx.nof_tx_pools == cfg.nof_tx_pools);
+  for (uint32_t i = 0; i < cfg.nof_rx_pools; i++) {
+    TESTASSERT(compare_pools(&cfg.rx_pools[i], &cfg_rx.rx_pools[i]) == SRSRAN_SUCCESS);
+  }
+  TESTASSERT(compare_pools(&cfg.tx_pools[0], &cfg_rx.tx_pools[0]) == SRSRAN_SUCCESS);
+  return SRSRAN_SUCCESS;
+}
+
+int main()
+{
+  // Absent, both ends of small-r12, and both ends of large-r12
+  uint32_t offsets[] = {0, 1, SRSRAN_SL_MAX_PERIOD_LENGTH - 1, SRSRAN_SL_MAX_PERIOD_LENGTH, SRSRAN_SL_DFN_PERIOD - 1};
+  for (uint32_t offset : offsets) {
+    TESTASSERT(test_pool(offset, true) == SRSRAN_SUCCESS);
+    TESTASSERT(test_pool(offset, false) == SRSRAN_SUCCESS);
+  }
+  TESTASSERT(test_freq() == SRSRAN_SUCCESS);
+
+  printf("Ok\n");
+  return SRSRAN_SUCCESS;
+}
@@ -20,9 +20,12 @@
  */
 
 #include "srsran/common/buffer_pool.h"
+#include <atomic>
 #include <pthread.h>
 #include <stdio.h>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace srsran {
 
@@ -49,4 +52,77 @@ void byte_buffer_pool::cleanup(void)
   pthread_mutex_unlock(&instance_mutex);
 }
 
+static pthread_mutex_t   thread_idx_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<bool> thread_idx_used(SRSRAN_LOCKFREE_POOL_MAX_THREADS, false);
+
+static std::atomic<int> nof_thread_idx(0);
+
+// -1 until the first call, -2 once the thread is exiting
+static thread_local int thread_idx = -1;
+
+static std::vector<std::pair<void*, lockfree_pool_flush_t> > pools;
+
+void lockfree_pool_register(void* pool, lockfree_pool_flush_t flush)
+{
+  pthread_mutex_lock(&thread_idx_mutex);
+  pools.push_back(std::make_pair(pool, flush));
+  pthread_mutex_unlock(&thread_idx_mutex);
+}
+
+void lockfree_pool_unregister(void* pool)
+{
+  pthread_mutex_lock(&thread_idx_mutex);
+  for (size_t i = 0; i < pools.size(); i++) {
+    if (pools[i].first == pool) {
+      pools.erase(pools.begin() + i);
+      break;
+    }
+  }
+  pthread_mutex_unlock(&thread_idx_mutex);
+}
+
+// Returns the magazines of the thread to their pools and the index of the thread when it exits
+struct thread_idx_releaser {
+  ~thread_idx_releaser()
+  {
+    pthread_mutex_lock(&thread_idx_mutex);
+    if (thread_idx >= 0) {
+      for (size_t i = 0; i < pools.size(); i++) {
+        pools[i].second(pools[i].first, thread_idx);
+      }
+      thread_idx_used[thread_idx] = false;
+    }
+    thread_idx = -2;
+    pthread_mutex_unlock(&thread_idx_mutex);
+  }
+};
+
+int lockfree_pool_thread_idx()
+{
+  if (thread_idx != -1) {
+    return thread_idx < 0 ? -1 : thread_idx;
+  }
+
+  static thread_local thread_idx_releaser releaser;
+  pthread_mutex_lock(&thread_idx_mutex);
+  std::vector<bool>::iterator it = std::find(thread_idx_used.begin(), thread_idx_used.end(), false);
+  if (it != thread_idx_used.end()) {
+    *it        = true;
+    thread_idx = (int)(it - thread_idx_used.begin());
+    if (thread_idx >= nof_thread_idx.load(std::memory_order_relaxed)) {
+      nof_thread_idx.store(thread_idx + 1);
+    }
+  } else {
+    // Too many threads, this one always uses the shared list
+    thread_idx = -2;
+  }
+  pthread_mutex_unlock(&thread_idx_mutex);
+  return thread_idx < 0 ? -1 : thread_idx;
+}
+
+int lockfree_pool_nof_thread_idx()
+{
+  return nof_thread_idx.load();
+}
+
 } // namespace srsran
@@ -0,0 +1,291 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include <getopt.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "srsran/common/buffer_pool.h"
+#include "srsran/common/test_common.h"
+
+static uint32_t nof_iterations = 20000;
+
+struct test_buffer_t {
+  uint32_t owner;
+  uint8_t  data[120];
+#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+  char debug_name[SRSRAN_BUFFER_POOL_LOG_NAME_LEN];
+#endif
+};
+
+int test_single_thread()
+{
+  const uint32_t                              capacity = 100;
+  srsran::lockfree_buffer_pool<test_buffer_t> pool(capacity);
+  std::vector<test_buffer_t*>                 buffers;
+
+  // Every buffer can be allocated, also those refilled into the magazine of this thread
+  for (uint32_t i = 0; i < capacity; i++) {
+    test_buffer_t* b = pool.allocate();
+    TESTASSERT(b != NULL);
+    TESTASSERT(std::find(buffers.begin(), buffers.end(), b) == buffers.end());
+    buffers.push_back(b);
+  }
+  TESTASSERT(pool.nof_available_pdus() == 0);
+  TESTASSERT(pool.is_almost_empty());
+  TESTASSERT(pool.allocate() == NULL);
+
+  // Foreign buffers and double deallocations are rejected
+  test_buffer_t foreign;
+  TESTASSERT(not pool.deallocate(&foreign));
+  TESTASSERT(pool.deallocate(buffers[0]));
+  TESTASSERT(not pool.deallocate(buffers[0]));
+
+  for (uint32_t i = 1; i < capacity; i++) {
+    TESTASSERT(pool.deallocate(buffers[i]));
+  }
+  TESTASSERT(pool.nof_available_pdus() == capacity);
+  TESTASSERT(not pool.is_almost_empty());
+  return SRSRAN_SUCCESS;
+}
+
+/* Buffers cached by a thread are returned when the thread exits */
+int test_idle_thread()
+{
+  const uint32_t                              capacity = 64;
+  srsran::lockfree_buffer_pool<test_buffer_t> pool(capacity);
+
+  std::thread t([&pool]() {
+    std::vector<test_buffer_t*> buffers;
+    for (uint32_t i = 0; i < capacity / 2; i++) {
+      buffers.push_back(pool.allocate());
+    }
+    for (test_buffer_t* b : buffers) {
+      pool.deallocate(b);
+    }
+  });
+  t.join();
+
+  std::vector<test_buffer_t*> buffers;
+  for (uint32_t i = 0; i < capacity; i++) {
+    test_buffer_t* b = pool.allocate();
+    TESTASSERT(b != NULL);
+    buffers.push_back(b);
+  }
+  TESTASSERT(pool.allocate() == NULL);
+  for (test_buffer_t* b : buffers) {
+    TESTASSERT(pool.deallocate(b));
+  }
+  return SRSRAN_SUCCESS;
+}
+
+/* Buffers cached by a thread that is idle but alive are taken back by a thread that finds the pool empty */
+int test_idle_holder(bool blocking)
+{
+  const uint32_t                              capacity = 32;
+  srsran::lockfree_buffer_pool<test_buffer_t> pool(capacity);
+  std::atomic<uint32_t>                       step(0);
+
+  std::thread t([&pool, &step]() {
+    std::vector<test_buffer_t*> buffers;
+    for (uint32_t i = 0; i < capacity; i++) {
+      buffers.push_back(pool.allocate());
+    }
+    for (test_buffer_t* b : buffers) {
+      pool.deallocate(b);
+    }
+    step = 1;
+    while (step != 2) {
+      usleep(1000);
+    }
+  });
+  while (step != 1) {
+    usleep(1000);
+  }
+
+  TESTASSERT(pool.nof_available_pdus() == capacity);
+  std::vector<test_buffer_t*> buffers;
+  for (uint32_t i = 0; i < capacity; i++) {
+    test_buffer_t* b = pool.allocate(NULL, blocking);
+    TESTASSERT(b != NULL);
+    TESTASSERT(std::find(buffers.begin(), buffers.end(), b) == buffers.end());
+    buffers.push_back(b);
+  }
+  TESTASSERT(pool.nof_available_pdus() == 0);
+  TESTASSERT(pool.allocate() == NULL);
+  step = 2;
+  t.join();
+
+  for (test_buffer_t* b : buffers) {
+    TESTASSERT(pool.deallocate(b));
+  }
+  TESTASSERT(pool.nof_available_pdus() == capacity);
+  return SRSRAN_SUCCESS;
+}
+
+/* A blocking allocation returns once another thread deallocates */
+int test_blocking()
+{
+  const uint32_t                              capacity = 8;
+  srsran::lockfree_buffer_pool<test_buffer_t> pool(capacity);
+  std::vector<test_buffer_t*>                 buffers;
+  for (uint32_t i = 0; i < capacity; i++) {
+    buffers.push_back(pool.allocate());
+  }
+
+  std::thread t([&pool, &buffers]() {
+    usleep(10000);
+    pool.deallocate(buffers[3]);
+  });
+  test_buffer_t* b = pool.allocate(NULL, true);
+  t.join();
+  TESTASSERT(b == buffers[3]);
+
+  buffers[3] = b;
+  for (test_buffer_t* b : buffers) {
+    TESTASSERT(pool.deallocate(b));
+  }
+  return SRSRAN_SUCCESS;
+}
+
+/* Buffers allocated in one thread and deallocated in another are never handed out twice */
+int test_cross_thread()
+{
+  const uint32_t                              capacity = 256;
+  const uint32_t                              nof_threads = 8;
+  srsran::lockfree_buffer_pool<test_buffer_t> pool(capacity);
+  std::vector<test_buffer_t*>                 handoff(nof_threads * 16, NULL);
+  std::vector<std::thread>                    threads;
+  std::atomic<uint32_t>                       nof_errors(0);
+
+  for (uint32_t t = 0; t < nof_threads; t++) {
+    threads.emplace_back([&, t]() {
+      for (uint32_t i = 0; i < nof_iterations; i++) {
+        test_buffer_t* b = pool.allocate(NULL, true);
+        b->owner         = t;
+        std::this_thread::yield();
+        if (b->owner != t) {
+          nof_errors++;
+        }
+        // Pass the buffer to a neighbour slot, deallocate whatever was there
+        test_buffer_t* prev = __atomic_exchange_n(&handoff[(t * 16 + i) % handoff.size()], b, __ATOMIC_ACQ_REL);
+        if (prev != NULL && !pool.deallocate(prev)) {
+          nof_errors++;
+        }
+      }
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  for (test_buffer_t* b : handoff) {
+    if (b != NULL) {
+      TESTASSERT(pool.deallocate(b));
+    }
+  }
+  TESTASSERT(nof_errors == 0);
+  TESTASSERT(pool.nof_available_pdus() == capacity);
+  return SRSRAN_SUCCESS;
+}
+
+/* Every thread allocates a burst of buffers and deallocates them, as a PDU is built and sent */
+template <class pool_t>
+double benchmark_pool(uint32_t nof_threads)
+{
+  const uint32_t           burst = 8;
+  pool_t                   pool(4096);
+  std::vector<std::thread> threads;
+  struct timeval           t[3];
+
+  gettimeofday(&t[1], NULL);
+  for (uint32_t n = 0; n < nof_threads; n++) {
+    threads.emplace_back([&pool]() {
+      test_buffer_t* buffers[burst];
+      for (uint32_t i = 0; i < nof_iterations; i++) {
+        for (uint32_t j = 0; j < burst; j++) {
+          buffers[j] = pool.allocate();
+        }
+        for (uint32_t j = 0; j < burst; j++) {
+          pool.deallocate(buffers[j]);
+        }
+      }
+    });
+  }
+  for (std::thread& th : threads) {
+    th.join();
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+
+  // Allocations and deallocations per microsecond
+  return 2.0 * burst * nof_iterations * nof_threads / (t[0].tv_sec * 1e6 + t[0].tv_usec);
+}
+
+void benchmark()
+{
+  printf("%8s %16s %16s\n", "threads", "mutex Mops/s", "lockfree Mops/s");
+  for (uint32_t nof_threads = 1; nof_threads <= 16; nof_threads *= 2) {
+    double mutex_ops    = benchmark_pool<srsran::buffer_pool<test_buffer_t> >(nof_threads);
+    double lockfree_ops = benchmark_pool<srsran::lockfree_buffer_pool<test_buffer_t> >(nof_threads);
+    printf("%8d %16.1f %16.1f\n", nof_threads, mutex_ops, lockfree_ops);
+  }
+}
+
+void usage(char* prog)
+{
+  printf("Usage: %s\n", prog);
+  printf("\t-n iterations per thread [Default %d]\n", nof_iterations);
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "n")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_iterations = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  TESTASSERT(test_single_thread() == SRSRAN_SUCCESS);
+  TESTASSERT(test_idle_thread() == SRSRAN_SUCCESS);
+  TESTASSERT(test_idle_holder(false) == SRSRAN_SUCCESS);
+  TESTASSERT(test_idle_holder(true) == SRSRAN_SUCCESS);
+  TESTASSERT(test_blocking() == SRSRAN_SUCCESS);
+  TESTASSERT(test_cross_thread() == SRSRAN_SUCCESS);
+  benchmark();
+
+  printf("Ok\n");
+  return SRSRAN_SUCCESS;
+}
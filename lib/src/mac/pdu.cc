@@ -150,6 +150,23 @@ const char* to_string(mch_lcid v)
   }
 }
 
+/*************************
+ *       SL-SCH LCID
+ *************************/
+
+const char* to_string(sl_sch_lcid v)
+{
+  if (is_sdu(v)) {
+    return "SL Logical Channel";
+  }
+  switch (v) {
+    case sl_sch_lcid::PADDING:
+      return "Padding";
+    default:
+      return "Unrecognized SL-SCH LCID";
+  }
+}
+
 const char* lcid_t::to_string() const
 {
   switch (type) {
@@ -466,6 +483,95 @@ int sch_pdu::get_sdu_space()
   return ret;
 }
 
+/*************************
+ *       SL-SCH PDU
+ *************************/
+
+void sl_sch_pdu::init_rx(uint32_t pdu_len_bytes)
+{
+  // The MAC subheaders and SDUs follow the SL-SCH subheader
+  pdu::init_rx(pdu_len_bytes > SL_SCH_SUBHEADER_LEN ? pdu_len_bytes - SL_SCH_SUBHEADER_LEN : 0, true);
+}
+
+void sl_sch_pdu::init_tx(byte_buffer_t* buffer, uint32_t pdu_len_bytes, uint32_t src_id_, uint32_t dst_id_)
+{
+  version = V2X_VERSION;
+  src_id  = src_id_ & 0xffffff;
+  dst_id  = dst_id_ & 0xffffff;
+  pdu::init_tx(buffer, pdu_len_bytes > SL_SCH_SUBHEADER_LEN ? pdu_len_bytes - SL_SCH_SUBHEADER_LEN : 0, true);
+}
+
+void sl_sch_pdu::fprint(FILE* stream)
+{
+  fprintf(stream, "MAC SDU for SL-SCH. V=%d, SRC=0x%06x, DST=0x%06x. ", version, src_id, dst_id);
+  pdu::fprint(stream);
+}
+
+// Section 6.2.4
+bool sl_sch_pdu::parse_packet(uint8_t* ptr)
+{
+  nof_subheaders = 0;
+  if (pdu_len == 0) {
+    return false;
+  }
+
+  version = ptr[0] >> 4;
+  src_id  = (uint32_t)ptr[1] << 16 | (uint32_t)ptr[2] << 8 | ptr[3];
+  dst_id  = (uint32_t)ptr[4] << 16 | (uint32_t)ptr[5] << 8 | ptr[6];
+  if (version != V2X_VERSION) {
+    return false;
+  }
+
+  sch_pdu::parse_packet(ptr + SL_SCH_SUBHEADER_LEN);
+  if (nof_subheaders == 0) {
+    return false;
+  }
+
+  // The last payload is sized from the lengths the subheaders are expected to take, so the L fields only add up to the
+  // PDU length if it ends where the PDU does
+  sch_subh* last = &subheaders[nof_subheaders - 1];
+  if (last->get_sdu_ptr() + last->get_payload_size() != ptr + SL_SCH_SUBHEADER_LEN + pdu_len) {
+    INFO("Corrupted SL-SCH PDU - the L fields do not match pdu_len=%d\n", pdu_len);
+    if (log_h) {
+      log_h->info_hex(ptr,
+                      pdu_len + SL_SCH_SUBHEADER_LEN,
+                      "Corrupted SL-SCH PDU - the L fields do not match pdu_len=%d\n",
+                      pdu_len);
+    }
+    nof_subheaders = 0;
+    return false;
+  }
+  return true;
+}
+
+uint8_t* sl_sch_pdu::write_packet(srsran::log_ref log_h)
+{
+  if (sch_pdu::write_packet(log_h) == nullptr) {
+    return nullptr;
+  }
+
+  if (buffer_tx->get_headroom() < SL_SCH_SUBHEADER_LEN) {
+    log_h->error("Not enough headroom for SL-SCH subheader (%d < %d).\n",
+                 buffer_tx->get_headroom(),
+                 SL_SCH_SUBHEADER_LEN);
+    return nullptr;
+  }
+
+  // V/R/R/R/R, then the SRC and DST Layer-2 IDs, MSB first
+  buffer_tx->msg -= SL_SCH_SUBHEADER_LEN;
+  buffer_tx->N_bytes += SL_SCH_SUBHEADER_LEN;
+  uint8_t* ptr = buffer_tx->msg;
+  ptr[0]       = version << 4;
+  ptr[1]       = (uint8_t)(src_id >> 16);
+  ptr[2]       = (uint8_t)(src_id >> 8);
+  ptr[3]       = (uint8_t)src_id;
+  ptr[4]       = (uint8_t)(dst_id >> 16);
+  ptr[5]       = (uint8_t)(dst_id >> 8);
+  ptr[6]       = (uint8_t)dst_id;
+
+  return buffer_tx->msg;
+}
+
 void sch_subh::init()
 {
   lcid             = 0;
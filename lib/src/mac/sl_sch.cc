@@ -0,0 +1,352 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/mac/sl_sch.h"
+#include "srsran/mac/pdu.h"
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+// Bounds the MAC header of the PDUs written, and the subheaders read from a corrupted one
+#define SL_SCH_MAX_SUBHEADERS 128
+
+#define SL_SCH_SEQ_HDR_MAGIC 0xa5
+#define SL_SCH_SEQ_HDR_VERSION 1
+
+namespace {
+
+class sl_sch_tx
+{
+public:
+  sl_sch_tx() : pdu(SL_SCH_MAX_SUBHEADERS, srsran::log_ref{"MAC "}), log_h("MAC ") {}
+
+  int build(uint32_t       src_id,
+            uint32_t       dst_id,
+            uint32_t       lcid,
+            const uint8_t* sdu_data,
+            uint32_t       sdu_len,
+            uint8_t*       output,
+            uint32_t       pdu_len)
+  {
+    if (pdu_len > buffer.get_tailroom()) {
+      return SRSRAN_ERROR;
+    }
+
+    buffer.clear();
+    pdu.init_tx(&buffer, pdu_len, src_id, dst_id);
+
+    int nof_sdus = 0;
+    while (pdu.new_subh()) {
+      uint32_t nof_bytes = sdu_len ? sdu_len : (uint32_t)pdu.get_sdu_space();
+      if (nof_bytes == 0 || pdu.get()->set_sdu(lcid, nof_bytes, (uint8_t*)sdu_data) < 0) {
+        pdu.del_subh();
+        break;
+      }
+      nof_sdus++;
+      if (sdu_len == 0) {
+        break;
+      }
+    }
+
+    uint8_t* ptr = pdu.write_packet(log_h);
+    if (ptr == nullptr || buffer.N_bytes != pdu_len) {
+      return SRSRAN_ERROR;
+    }
+    memcpy(output, ptr, pdu_len);
+    return nof_sdus;
+  }
+
+private:
+  srsran::byte_buffer_t buffer;
+  srsran::sl_sch_pdu    pdu;
+  srsran::log_ref       log_h;
+};
+
+class sl_sch_rx
+{
+public:
+  explicit sl_sch_rx(uint32_t max_sources) : pdu(SL_SCH_MAX_SUBHEADERS, srsran::log_ref{})
+  {
+    // Open addressing, kept at most half full
+    uint32_t nof_slots = 1;
+    while (nof_slots < 2 * max_sources) {
+      nof_slots <<= 1;
+    }
+    slots.assign(nof_slots, -1);
+    stats.reserve(max_sources);
+    max_stats = max_sources;
+  }
+
+  int parse(uint8_t* ptr, uint32_t pdu_len)
+  {
+    pdu.init_rx(pdu_len);
+    if (!pdu.parse_packet(ptr)) {
+      nof_invalid++;
+      return SRSRAN_ERROR;
+    }
+
+    int idx = find(pdu.get_src_id());
+    if (idx < 0) {
+      nof_overflow++;
+      return SRSRAN_ERROR;
+    }
+
+    srsran_sl_sch_src_stats_t* s         = &stats[idx];
+    srsran::sch_subh*          first_sdu = nullptr;
+    s->nof_pdus++;
+    while (pdu.next()) {
+      srsran::sch_subh* subh = pdu.get();
+      if (srsran::is_sdu(static_cast<srsran::sl_sch_lcid>(subh->get_sdu_lcid()))) {
+        s->nof_sdus++;
+        s->nof_sdu_bytes += subh->get_payload_size();
+        if (first_sdu == nullptr) {
+          first_sdu = subh;
+        }
+      }
+    }
+
+    srsran_sl_sch_seq_hdr_t hdr;
+    if (lat_bin_us > 0 && first_sdu != nullptr &&
+        srsran_sl_sch_seq_hdr_unpack(first_sdu->get_sdu_ptr(), first_sdu->get_payload_size(), &hdr) == SRSRAN_SUCCESS) {
+      count_seq(s, &hdr);
+    }
+    return idx;
+  }
+
+  int64_t get_lat_percentile(const srsran_sl_sch_src_stats_t* s, float p)
+  {
+    uint64_t target = (uint64_t)ceil(p * s->nof_seq);
+    uint64_t count  = 0;
+    for (uint32_t i = 0; i < SRSRAN_SL_SCH_LAT_NOF_BINS - 1; i++) {
+      count += s->lat_hist[i];
+      if (count >= target && count > 0) {
+        return (int64_t)i * lat_bin_us;
+      }
+    }
+    return s->lat_max_us;
+  }
+
+  uint32_t get_stats(const srsran_sl_sch_src_stats_t** stats_)
+  {
+    *stats_ = stats.data();
+    return stats.size();
+  }
+
+  uint64_t nof_invalid  = 0;
+  uint64_t nof_overflow = 0;
+  uint32_t lat_bin_us   = 0;
+  uint64_t rx_time_us   = 0;
+
+private:
+  srsran::sl_sch_pdu                     pdu;
+  std::vector<int32_t>                   slots;
+  std::vector<srsran_sl_sch_src_stats_t> stats;
+  uint32_t                               max_stats = 0;
+
+  void count_seq(srsran_sl_sch_src_stats_t* s, const srsran_sl_sch_seq_hdr_t* hdr)
+  {
+    // Serial number arithmetic, a late sequence number fills the gap its absence opened. Late duplicates are only
+    // told apart from late packets by the gap count, which saturates at zero.
+    int32_t diff = (int32_t)(hdr->seq - s->max_seq);
+    if (s->nof_seq == 0 || diff > 0) {
+      s->nof_lost += s->nof_seq == 0 ? 0 : (uint64_t)(diff - 1);
+      s->max_seq = hdr->seq;
+    } else if (diff == 0) {
+      s->nof_duplicated++;
+    } else {
+      s->nof_reordered++;
+      s->nof_lost -= s->nof_lost > 0;
+    }
+    s->gen_id = hdr->gen_id;
+
+    int64_t lat = (int64_t)(rx_time_us - hdr->tx_time_us);
+    if (s->nof_seq == 0) {
+      s->lat_min_us = lat;
+      s->lat_max_us = lat;
+    }
+    s->lat_min_us = SRSRAN_MIN(s->lat_min_us, lat);
+    s->lat_max_us = SRSRAN_MAX(s->lat_max_us, lat);
+    s->lat_sum_us += lat;
+    s->nof_seq++;
+
+    uint64_t bin = lat < 0 ? 0 : 1 + (uint64_t)lat / lat_bin_us;
+    s->lat_hist[SRSRAN_MIN(bin, (uint64_t)SRSRAN_SL_SCH_LAT_NOF_BINS - 1)]++;
+  }
+
+  /* Index of the counters of src_id, which are created on first sight. Negative if the table is full */
+  int find(uint32_t src_id)
+  {
+    uint32_t mask = slots.size() - 1;
+    for (uint32_t i = (src_id * 2654435761U) & mask;; i = (i + 1) & mask) {
+      if (slots[i] < 0) {
+        if (stats.size() == max_stats) {
+          return SRSRAN_ERROR;
+        }
+        srsran_sl_sch_src_stats_t s = {};
+        s.src_id                    = src_id;
+        slots[i]                    = stats.size();
+        stats.push_back(s);
+        return slots[i];
+      }
+      if (stats[slots[i]].src_id == src_id) {
+        return slots[i];
+      }
+    }
+  }
+};
+
+} // namespace
+
+extern "C" {
+
+srsran_sl_sch_tx_t srsran_sl_sch_tx_init(void)
+{
+  return (srsran_sl_sch_tx_t)(new sl_sch_tx());
+}
+
+void srsran_sl_sch_tx_free(srsran_sl_sch_tx_t q)
+{
+  if (q) {
+    delete (sl_sch_tx*)q;
+  }
+}
+
+int srsran_sl_sch_tx_build(srsran_sl_sch_tx_t q,
+                           uint32_t           src_id,
+                           uint32_t           dst_id,
+                           uint32_t           lcid,
+                           const uint8_t*     sdu_data,
+                           uint32_t           sdu_len,
+                           uint8_t*           pdu,
+                           uint32_t           pdu_len)
+{
+  if (q == nullptr || sdu_data == nullptr || pdu == nullptr ||
+      !srsran::is_sdu(static_cast<srsran::sl_sch_lcid>(lcid))) {
+    return SRSRAN_ERROR;
+  }
+  return ((sl_sch_tx*)q)->build(src_id, dst_id, lcid, sdu_data, sdu_len, pdu, pdu_len);
+}
+
+int srsran_sl_sch_first_sdu(const uint8_t* pdu, uint32_t pdu_len, uint32_t* sdu_len)
+{
+  if (pdu == nullptr || sdu_len == nullptr) {
+    return SRSRAN_ERROR;
+  }
+
+  srsran::sl_sch_pdu rx(SL_SCH_MAX_SUBHEADERS, srsran::log_ref{});
+  rx.init_rx(pdu_len);
+  if (!rx.parse_packet((uint8_t*)pdu)) {
+    return SRSRAN_ERROR;
+  }
+  while (rx.next()) {
+    srsran::sch_subh* subh = rx.get();
+    if (srsran::is_sdu(static_cast<srsran::sl_sch_lcid>(subh->get_sdu_lcid()))) {
+      *sdu_len = subh->get_payload_size();
+      return (int)(subh->get_sdu_ptr() - pdu);
+    }
+  }
+  return SRSRAN_ERROR;
+}
+
+void srsran_sl_sch_seq_hdr_pack(const srsran_sl_sch_seq_hdr_t* hdr, uint8_t* buffer)
+{
+  buffer[0] = SL_SCH_SEQ_HDR_MAGIC;
+  buffer[1] = SL_SCH_SEQ_HDR_VERSION;
+  buffer[2] = (uint8_t)(hdr->gen_id >> 8);
+  buffer[3] = (uint8_t)hdr->gen_id;
+  for (uint32_t i = 0; i < 4; i++) {
+    buffer[4 + i] = (uint8_t)(hdr->seq >> (24 - 8 * i));
+  }
+  for (uint32_t i = 0; i < 8; i++) {
+    buffer[8 + i] = (uint8_t)(hdr->tx_time_us >> (56 - 8 * i));
+  }
+}
+
+int srsran_sl_sch_seq_hdr_unpack(const uint8_t* buffer, uint32_t len, srsran_sl_sch_seq_hdr_t* hdr)
+{
+  if (len < SRSRAN_SL_SCH_SEQ_HDR_LEN || buffer[0] != SL_SCH_SEQ_HDR_MAGIC || buffer[1] != SL_SCH_SEQ_HDR_VERSION) {
+    return SRSRAN_ERROR;
+  }
+  hdr->gen_id = (uint16_t)((buffer[2] << 8) | buffer[3]);
+  hdr->seq    = 0;
+  for (uint32_t i = 0; i < 4; i++) {
+    hdr->seq = (hdr->seq << 8) | buffer[4 + i];
+  }
+  hdr->tx_time_us = 0;
+  for (uint32_t i = 0; i < 8; i++) {
+    hdr->tx_time_us = (hdr->tx_time_us << 8) | buffer[8 + i];
+  }
+  return SRSRAN_SUCCESS;
+}
+
+srsran_sl_sch_rx_t srsran_sl_sch_rx_init(uint32_t max_sources)
+{
+  if (max_sources == 0) {
+    return nullptr;
+  }
+  return (srsran_sl_sch_rx_t)(new sl_sch_rx(max_sources));
+}
+
+void srsran_sl_sch_rx_free(srsran_sl_sch_rx_t q)
+{
+  if (q) {
+    delete (sl_sch_rx*)q;
+  }
+}
+
+int srsran_sl_sch_rx_parse(srsran_sl_sch_rx_t q, uint8_t* pdu, uint32_t pdu_len)
+{
+  if (q == nullptr || pdu == nullptr) {
+    return SRSRAN_ERROR;
+  }
+  return ((sl_sch_rx*)q)->parse(pdu, pdu_len);
+}
+
+void srsran_sl_sch_rx_enable_seq(srsran_sl_sch_rx_t q, uint32_t lat_bin_us)
+{
+  ((sl_sch_rx*)q)->lat_bin_us = SRSRAN_MAX(lat_bin_us, 1u);
+}
+
+void srsran_sl_sch_rx_set_time(srsran_sl_sch_rx_t q, uint64_t rx_time_us)
+{
+  ((sl_sch_rx*)q)->rx_time_us = rx_time_us;
+}
+
+int64_t srsran_sl_sch_rx_get_lat_percentile(srsran_sl_sch_rx_t q, const srsran_sl_sch_src_stats_t* s, float p)
+{
+  return ((sl_sch_rx*)q)->get_lat_percentile(s, p);
+}
+
+uint32_t srsran_sl_sch_rx_get_stats(srsran_sl_sch_rx_t q, const srsran_sl_sch_src_stats_t** stats)
+{
+  return ((sl_sch_rx*)q)->get_stats(stats);
+}
+
+uint64_t srsran_sl_sch_rx_get_nof_invalid(srsran_sl_sch_rx_t q)
+{
+  return ((sl_sch_rx*)q)->nof_invalid;
+}
+
+uint64_t srsran_sl_sch_rx_get_nof_overflow(srsran_sl_sch_rx_t q)
+{
+  return ((sl_sch_rx*)q)->nof_overflow;
+}
+}
@@ -0,0 +1,256 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "srsran/common/test_common.h"
+#include "srsran/mac/pdu.h"
+#include "srsran/mac/sl_sch.h"
+
+static uint32_t nof_iterations = 1000000;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [n]\n", prog);
+  printf("\t-n number of PDUs parsed in the benchmark [Default %d]\n", nof_iterations);
+}
+
+/* Builds a PDU with the C interface and checks it field by field with sl_sch_pdu */
+int test_build_parse(uint32_t sdu_len, uint32_t pdu_len)
+{
+  std::vector<uint8_t> sdu_data(pdu_len), pdu(pdu_len);
+  for (uint32_t i = 0; i < pdu_len; i++) {
+    sdu_data[i] = (uint8_t)(i * 7 + 3);
+  }
+
+  srsran_sl_sch_tx_t tx = srsran_sl_sch_tx_init();
+  int nof_sdus = srsran_sl_sch_tx_build(tx, 0x123456, 0xabcdef, 3, sdu_data.data(), sdu_len, pdu.data(), pdu_len);
+  srsran_sl_sch_tx_free(tx);
+  TESTASSERT(nof_sdus >= 0);
+
+  // Subheader, then the SDUs fit alongside their 2 or 3 byte MAC subheaders
+  TESTASSERT(pdu[0] == srsran::sl_sch_pdu::V2X_VERSION << 4);
+  if (sdu_len == 0) {
+    TESTASSERT(nof_sdus == 1);
+  } else {
+    // The last subheader has no length field
+    uint32_t header = srsran::sch_pdu::size_header_sdu(sdu_len);
+    TESTASSERT((uint32_t)nof_sdus == SRSRAN_MIN(127u, (pdu_len - 7 + header - 1) / (sdu_len + header)));
+  }
+
+  srsran::sl_sch_pdu rx(128, srsran::log_ref{});
+  rx.init_rx(pdu_len);
+  TESTASSERT(rx.parse_packet(pdu.data()));
+  TESTASSERT(rx.get_src_id() == 0x123456);
+  TESTASSERT(rx.get_dst_id() == 0xabcdef);
+
+  // The SDUs point into the PDU, nothing is copied
+  int nof_rx_sdus = 0;
+  while (rx.next()) {
+    srsran::sch_subh* subh = rx.get();
+    if (subh->get_sdu_lcid() == (uint32_t)srsran::sl_sch_lcid::PADDING) {
+      continue;
+    }
+    TESTASSERT(subh->get_sdu_lcid() == 3);
+    TESTASSERT(subh->get_sdu_ptr() >= pdu.data() && subh->get_sdu_ptr() < pdu.data() + pdu_len);
+    if (sdu_len == 0) {
+      TESTASSERT(subh->get_payload_size() == pdu_len - srsran::sl_sch_pdu::SL_SCH_SUBHEADER_LEN - 1);
+    } else {
+      TESTASSERT(subh->get_payload_size() == sdu_len);
+    }
+    TESTASSERT(memcmp(subh->get_sdu_ptr(), sdu_data.data(), subh->get_payload_size()) == 0);
+    nof_rx_sdus++;
+  }
+  TESTASSERT(nof_rx_sdus == nof_sdus);
+
+  return SRSRAN_SUCCESS;
+}
+
+int test_build_parse_sizes()
+{
+  TESTASSERT(test_build_parse(0, 20) == SRSRAN_SUCCESS);
+  TESTASSERT(test_build_parse(0, 6117) == SRSRAN_SUCCESS);
+  TESTASSERT(test_build_parse(300, 6117) == SRSRAN_SUCCESS);
+
+  // Every remainder, including the one and two byte paddings at the start of the header
+  for (uint32_t pdu_len = 12; pdu_len < 300; pdu_len++) {
+    TESTASSERT(test_build_parse(13, pdu_len) == SRSRAN_SUCCESS);
+    TESTASSERT(test_build_parse(127, pdu_len) == SRSRAN_SUCCESS);
+    TESTASSERT(test_build_parse(128, pdu_len) == SRSRAN_SUCCESS);
+  }
+
+  return SRSRAN_SUCCESS;
+}
+
+int test_rx_stats()
+{
+  const uint32_t       pdu_len = 200;
+  std::vector<uint8_t> sdu_data(pdu_len);
+  std::vector<uint8_t> pdu(pdu_len);
+
+  srsran_sl_sch_tx_t tx = srsran_sl_sch_tx_init();
+  srsran_sl_sch_rx_t rx = srsran_sl_sch_rx_init(2);
+
+  // Two sources fit, the third one overflows
+  uint32_t src[] = {0x000001, 0xff0001, 0x000001, 0x000003, 0xff0001};
+  int      idx[] = {0, 1, 0, SRSRAN_ERROR, 1};
+  for (uint32_t i = 0; i < 5; i++) {
+    TESTASSERT(srsran_sl_sch_tx_build(
+                   tx, src[i], SRSRAN_SL_SCH_DST_BROADCAST, 1, sdu_data.data(), 50, pdu.data(), pdu_len) == 3);
+    TESTASSERT(srsran_sl_sch_rx_parse(rx, pdu.data(), pdu_len) == idx[i]);
+  }
+
+  // Subheader L fields that do not add up to the PDU length: an SDU longer than the PDU, and a 15-bit L field whose
+  // extra byte shifts the payloads one byte past the end of the PDU
+  const uint32_t l_idx = srsran::sl_sch_pdu::SL_SCH_SUBHEADER_LEN + 1;
+  pdu[l_idx]           = 0x7f;
+  TESTASSERT(srsran_sl_sch_rx_parse(rx, pdu.data(), pdu_len) == SRSRAN_ERROR);
+  pdu[l_idx] = 50;
+  pdu.insert(pdu.begin() + l_idx, 0x80);
+  TESTASSERT(srsran_sl_sch_rx_parse(rx, pdu.data(), pdu_len) == SRSRAN_ERROR);
+  pdu.erase(pdu.begin() + l_idx);
+
+  // Not a V2X PDU, and a PDU shorter than the SL-SCH subheader
+  pdu[0] = 0b0001 << 4;
+  TESTASSERT(srsran_sl_sch_rx_parse(rx, pdu.data(), pdu_len) == SRSRAN_ERROR);
+  TESTASSERT(srsran_sl_sch_rx_parse(rx, pdu.data(), 5) == SRSRAN_ERROR);
+
+  const srsran_sl_sch_src_stats_t* stats = NULL;
+  TESTASSERT(srsran_sl_sch_rx_get_stats(rx, &stats) == 2);
+  TESTASSERT(stats[0].src_id == 0x000001 && stats[0].nof_pdus == 2);
+  TESTASSERT(stats[1].src_id == 0xff0001 && stats[1].nof_pdus == 2);
+  TESTASSERT(stats[0].nof_sdus == 6 && stats[0].nof_sdu_bytes == 300);
+  TESTASSERT(srsran_sl_sch_rx_get_nof_overflow(rx) == 1);
+  TESTASSERT(srsran_sl_sch_rx_get_nof_invalid(rx) == 4);
+
+  srsran_sl_sch_tx_free(tx);
+  srsran_sl_sch_rx_free(rx);
+  return SRSRAN_SUCCESS;
+}
+
+int test_seq()
+{
+  const uint32_t       pdu_len = 100;
+  std::vector<uint8_t> sdu_data(pdu_len);
+  std::vector<uint8_t> pdu(pdu_len);
+
+  srsran_sl_sch_tx_t tx = srsran_sl_sch_tx_init();
+  srsran_sl_sch_rx_t rx = srsran_sl_sch_rx_init(1);
+  srsran_sl_sch_rx_enable_seq(rx, 100);
+  TESTASSERT(srsran_sl_sch_tx_build(
+                 tx, 7, SRSRAN_SL_SCH_DST_BROADCAST, 1, sdu_data.data(), 40, pdu.data(), pdu_len) == 2);
+
+  uint32_t sdu_len = 0;
+  int      offset  = srsran_sl_sch_first_sdu(pdu.data(), pdu_len, &sdu_len);
+  TESTASSERT(offset > srsran::sl_sch_pdu::SL_SCH_SUBHEADER_LEN && sdu_len == 40);
+
+  // 4 is lost, 2 arrives late and 5 twice
+  uint32_t seq[]     = {1, 3, 5, 2, 5, 6};
+  int64_t  latency[] = {50, 150, -10, 20000, 250, 120};
+  for (uint32_t i = 0; i < 6; i++) {
+    srsran_sl_sch_seq_hdr_t hdr = {0x4242, seq[i], 1000000};
+    srsran_sl_sch_seq_hdr_pack(&hdr, &pdu[offset]);
+    srsran_sl_sch_rx_set_time(rx, hdr.tx_time_us + latency[i]);
+    TESTASSERT(srsran_sl_sch_rx_parse(rx, pdu.data(), pdu_len) == 0);
+  }
+
+  srsran_sl_sch_seq_hdr_t hdr = {};
+  TESTASSERT(srsran_sl_sch_seq_hdr_unpack(&pdu[offset], sdu_len, &hdr) == SRSRAN_SUCCESS);
+  TESTASSERT(hdr.gen_id == 0x4242 && hdr.seq == 6 && hdr.tx_time_us == 1000000);
+  TESTASSERT(srsran_sl_sch_seq_hdr_unpack(&pdu[offset], SRSRAN_SL_SCH_SEQ_HDR_LEN - 1, &hdr) == SRSRAN_ERROR);
+
+  const srsran_sl_sch_src_stats_t* stats = NULL;
+  TESTASSERT(srsran_sl_sch_rx_get_stats(rx, &stats) == 1);
+  TESTASSERT(stats[0].gen_id == 0x4242 && stats[0].nof_seq == 6 && stats[0].max_seq == 6);
+  TESTASSERT(stats[0].nof_lost == 1 && stats[0].nof_reordered == 1 && stats[0].nof_duplicated == 1);
+  TESTASSERT(stats[0].lat_min_us == -10 && stats[0].lat_max_us == 20000 && stats[0].lat_sum_us == 20560);
+  TESTASSERT(stats[0].lat_hist[0] == 1 && stats[0].lat_hist[1] == 1 && stats[0].lat_hist[2] == 2);
+  TESTASSERT(stats[0].lat_hist[3] == 1 && stats[0].lat_hist[SRSRAN_SL_SCH_LAT_NOF_BINS - 1] == 1);
+  TESTASSERT(srsran_sl_sch_rx_get_lat_percentile(rx, &stats[0], 0.5f) == 200);
+  TESTASSERT(srsran_sl_sch_rx_get_lat_percentile(rx, &stats[0], 1.0f) == 20000);
+
+  srsran_sl_sch_tx_free(tx);
+  srsran_sl_sch_rx_free(rx);
+  return SRSRAN_SUCCESS;
+}
+
+/* Parse rate of the largest sidelink transport blocks, spread over many sources */
+void benchmark()
+{
+  const uint32_t       pdu_len     = 6117;
+  const uint32_t       nof_sources = 1000;
+  std::vector<uint8_t> sdu_data(pdu_len);
+  std::vector<uint8_t> pdu(pdu_len * nof_sources);
+
+  srsran_sl_sch_tx_t tx = srsran_sl_sch_tx_init();
+  for (uint32_t i = 0; i < nof_sources; i++) {
+    srsran_sl_sch_tx_build(
+        tx, i * 4099, SRSRAN_SL_SCH_DST_BROADCAST, 1, sdu_data.data(), 300, &pdu[i * pdu_len], pdu_len);
+  }
+  srsran_sl_sch_tx_free(tx);
+
+  srsran_sl_sch_rx_t rx = srsran_sl_sch_rx_init(nof_sources);
+  struct timeval     t[3];
+  gettimeofday(&t[1], NULL);
+  for (uint32_t i = 0; i < nof_iterations; i++) {
+    srsran_sl_sch_rx_parse(rx, &pdu[(i % nof_sources) * pdu_len], pdu_len);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  srsran_sl_sch_rx_free(rx);
+
+  double usec = t[0].tv_sec * 1e6 + t[0].tv_usec;
+  printf(
+      "Parsed %d PDUs of %d bytes in %.0f us, %.2f MPDU/s\n", nof_iterations, pdu_len, usec, nof_iterations / usec);
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "n")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_iterations = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  TESTASSERT(test_build_parse_sizes() == SRSRAN_SUCCESS);
+  TESTASSERT(test_rx_stats() == SRSRAN_SUCCESS);
+  TESTASSERT(test_seq() == SRSRAN_SUCCESS);
+  benchmark();
+
+  printf("Ok\n");
+  return SRSRAN_SUCCESS;
+}
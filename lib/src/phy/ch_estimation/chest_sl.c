@@ -29,8 +29,11 @@
 #include "srsran/phy/ch_estimation/refsignal_ul.h"
 #include "srsran/phy/mimo/precoding.h"
 #include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/simd.h"
 #include "srsran/phy/utils/vector.h"
 
+static int chest_sl_wiener_set_symbols(srsran_chest_sl_t* q);
+
 static int chest_sl_init(srsran_chest_sl_t* q, uint32_t nof_cyclic_shift_seq)
 {
   q->sf_n_re = SRSRAN_CP_NSYMB(q->cell.cp) * SRSRAN_NRE * q->cell.nof_prb * 2;
@@ -89,6 +92,12 @@ static int chest_sl_init(srsran_chest_sl_t* q, uint32_t nof_cyclic_shift_seq)
     return SRSRAN_ERROR;
   }
 
+  q->combining_gain = srsran_vec_f_malloc(2 * SRSRAN_CP_NSYMB(SRSRAN_CP_NORM) * SRSRAN_NRE * SRSRAN_MAX_PRB);
+  if (!q->combining_gain) {
+    ERROR("Error allocating memory");
+    return SRSRAN_ERROR;
+  }
+
   q->sync_error_enable = true;
   q->rsrp_enable       = true;
 
@@ -1116,6 +1125,19 @@ int srsran_chest_sl_init(srsran_chest_sl_t*             q,
         ERROR("Invalid Sidelink channel");
         return SRSRAN_ERROR;
     }
+
+    if (channel != SRSRAN_SIDELINK_PSBCH) {
+      q->wiener_sl = calloc(sizeof(srsran_wiener_sl_t), 1);
+      if (q->wiener_sl == NULL) {
+        ERROR("Error allocating wiener filter\n");
+        return SRSRAN_ERROR;
+      }
+      if (srsran_wiener_sl_init(q->wiener_sl, SRSRAN_WIENER_SL_DEFAULT_DELAY_SPREAD_NS) != SRSRAN_SUCCESS ||
+          chest_sl_wiener_set_symbols(q) != SRSRAN_SUCCESS) {
+        ERROR("Error initializing wiener filter\n");
+        return SRSRAN_ERROR;
+      }
+    }
     ret = SRSRAN_SUCCESS;
   }
   return ret;
@@ -1164,6 +1186,8 @@ int srsran_chest_sl_set_cell(srsran_chest_sl_t* q, srsran_cell_sl_t cell)
       if (chest_sl_psbch_gen(q) != SRSRAN_SUCCESS) {
         return SRSRAN_ERROR;
       }
+    } else if (chest_sl_wiener_set_symbols(q) != SRSRAN_SUCCESS) {
+      return SRSRAN_ERROR;
     }
     ret = SRSRAN_SUCCESS;
   }
@@ -1252,6 +1276,617 @@ void srsran_chest_sl_ls_estimate_equalize(srsran_chest_sl_t* q, cf_t* sf_buffer,
   srsran_chest_sl_ls_equalize(q, sf_buffer, equalized_sf_buffer);
 }
 
+/* Every interpolated estimate of the PSCCH and PSSCH is a linear combination of the LS estimates at the DMRS symbols.
+ * Hence the half slot averages used for equalization reduce to fixed pilot weights, and the noise estimated by
+ * get_subband_noise() to a quadratic form of the pilots. */
+typedef struct {
+  uint32_t nof_symbols;
+  uint32_t nof_dmrs;
+  uint32_t dmrs_l[SRSRAN_SL_MAX_DMRS_SYMB];
+  uint32_t nof_data;
+  uint32_t data_l[SRSRAN_CP_NORM_SF_NSYMB];
+  float    w_avg[2][SRSRAN_SL_MAX_DMRS_SYMB];
+  float    g[SRSRAN_SL_MAX_DMRS_SYMB][SRSRAN_SL_MAX_DMRS_SYMB];
+} chest_sl_fused_weights_t;
+
+static bool chest_sl_is_symbol(srsran_chest_sl_t* q, srsran_sl_symbol_t type, uint32_t i)
+{
+  if (q->channel == SRSRAN_SIDELINK_PSCCH) {
+    return srsran_pscch_is_symbol(type, q->cell.tm, i, q->cell.cp);
+  }
+  return srsran_pssch_is_symbol(type, q->cell.tm, i, q->cell.cp);
+}
+
+static int chest_sl_fused_weights(srsran_chest_sl_t* q, chest_sl_fused_weights_t* w)
+{
+  bzero(w, sizeof(chest_sl_fused_weights_t));
+  w->nof_symbols = srsran_sl_get_num_symbols(q->cell.tm, q->cell.cp);
+  for (uint32_t i = 0; i < w->nof_symbols; i++) {
+    if (chest_sl_is_symbol(q, SRSRAN_SIDELINK_DMRS_SYMBOL, i) && w->nof_dmrs < SRSRAN_SL_MAX_DMRS_SYMB) {
+      w->dmrs_l[w->nof_dmrs++] = i;
+    }
+    if (chest_sl_is_symbol(q, SRSRAN_SIDELINK_DATA_SYMBOL, i)) {
+      w->data_l[w->nof_data++] = i;
+    }
+  }
+  if (w->nof_dmrs < 2) {
+    ERROR("Couldn't interpolate pilots. Invalid number of reference symbols.\n");
+    return SRSRAN_ERROR;
+  }
+
+  // Linear interpolation between consecutive pilots and extrapolation from the first and last pair, as done by
+  // srsran_interp_linear_vector3()
+  float a[SRSRAN_CP_NORM_SF_NSYMB][SRSRAN_SL_MAX_DMRS_SYMB] = {};
+  for (uint32_t l = 0; l < w->nof_symbols; l++) {
+    uint32_t p = 0;
+    while (p + 2 < w->nof_dmrs && l > w->dmrs_l[p + 1]) {
+      p++;
+    }
+    float t     = ((float)l - w->dmrs_l[p]) / (float)(w->dmrs_l[p + 1] - w->dmrs_l[p]);
+    a[l][p]     = 1.0f - t;
+    a[l][p + 1] = t;
+    uint32_t h  = (l < w->nof_symbols / 2) ? 0 : 1;
+    for (uint32_t n = 0; n < w->nof_dmrs; n++) {
+      w->w_avg[h][n] += a[l][n] * 2.0f / w->nof_symbols;
+    }
+  }
+
+  for (uint32_t l = 0; l < w->nof_symbols; l++) {
+    uint32_t h = (l < w->nof_symbols / 2) ? 0 : 1;
+    for (uint32_t n = 0; n < w->nof_dmrs; n++) {
+      for (uint32_t m = 0; m < w->nof_dmrs; m++) {
+        w->g[n][m] += (w->w_avg[h][n] - a[l][n]) * (w->w_avg[h][m] - a[l][m]);
+      }
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+/* Contiguous bands of the allocation, with the same split as chest_sl_pssch_ls_estimate() */
+static uint32_t chest_sl_fused_bands(srsran_chest_sl_t* q, uint32_t k_start[2], uint32_t len[2])
+{
+  if (q->channel == SRSRAN_SIDELINK_PSCCH) {
+    k_start[0] = q->chest_sl_cfg.prb_start_idx * SRSRAN_NRE;
+    len[0]     = q->M_sc_rs;
+    return 1;
+  }
+
+  k_start[0] = q->chest_sl_cfg.prb_start_idx * SRSRAN_NRE;
+  len[0]     = q->chest_sl_cfg.nof_prb * SRSRAN_NRE;
+  if (q->cell.tm >= SRSRAN_SIDELINK_TM3 || q->chest_sl_cfg.nof_prb <= q->sl_comm_resource_pool.prb_num) {
+    return 1;
+  }
+
+  len[0] = q->sl_comm_resource_pool.prb_num * SRSRAN_NRE;
+  if ((q->sl_comm_resource_pool.prb_num * 2) >
+      (q->sl_comm_resource_pool.prb_end - q->sl_comm_resource_pool.prb_start + 1)) {
+    k_start[1] = (q->sl_comm_resource_pool.prb_end + 1 - q->sl_comm_resource_pool.prb_num + 1) * SRSRAN_NRE;
+  } else {
+    k_start[1] = (q->sl_comm_resource_pool.prb_end + 1 - q->sl_comm_resource_pool.prb_num) * SRSRAN_NRE;
+  }
+  len[1] = (q->chest_sl_cfg.nof_prb - q->sl_comm_resource_pool.prb_num) * SRSRAN_NRE;
+  return 2;
+}
+
+/* LS estimates at the DMRS REs of one band, reduced to the two half slot averages which are stored in ce_average at
+ * offset and M + offset. Returns the noise power of the band, as accumulated by get_subband_noise(). */
+static float chest_sl_fused_pilots(srsran_chest_sl_t*              q,
+                                   const chest_sl_fused_weights_t* w,
+                                   cf_t*                           sf_buffer,
+                                   cf_t**                          r,
+                                   uint32_t                        k_start,
+                                   uint32_t                        len,
+                                   uint32_t                        offset,
+                                   uint32_t                        M)
+{
+  uint32_t n_re  = q->cell.nof_prb * SRSRAN_NRE;
+  cf_t*    h0    = &q->ce_average[offset];
+  cf_t*    h1    = &q->ce_average[M + offset];
+  float    noise = 0.0f;
+  uint32_t i     = 0;
+
+#if SRSRAN_SIMD_CF_SIZE
+  simd_f_t _noise = srsran_simd_f_zero();
+  for (; i + SRSRAN_SIMD_CF_SIZE <= len; i += SRSRAN_SIMD_CF_SIZE) {
+    simd_cf_t _ls[SRSRAN_SL_MAX_DMRS_SYMB];
+    simd_cf_t _h0 = srsran_simd_cf_zero();
+    simd_cf_t _h1 = srsran_simd_cf_zero();
+    for (uint32_t n = 0; n < w->nof_dmrs; n++) {
+      simd_cf_t _y = srsran_simd_cfi_loadu(&sf_buffer[w->dmrs_l[n] * n_re + k_start + i]);
+      _ls[n]       = srsran_simd_cf_conjprod(_y, srsran_simd_cfi_loadu(&r[n][offset + i]));
+      _h0          = srsran_simd_cf_add(_h0, srsran_simd_cf_mul(_ls[n], srsran_simd_f_set1(w->w_avg[0][n])));
+      _h1          = srsran_simd_cf_add(_h1, srsran_simd_cf_mul(_ls[n], srsran_simd_f_set1(w->w_avg[1][n])));
+      for (uint32_t m = 0; m <= n; m++) {
+        simd_f_t _c = srsran_simd_cf_re(srsran_simd_cf_conjprod(_ls[n], _ls[m]));
+        float    g  = (m == n) ? w->g[n][m] : 2.0f * w->g[n][m];
+        _noise      = srsran_simd_f_add(_noise, srsran_simd_f_mul(_c, srsran_simd_f_set1(g)));
+      }
+    }
+    srsran_simd_cfi_storeu(&h0[i], _h0);
+    srsran_simd_cfi_storeu(&h1[i], _h1);
+  }
+
+  __attribute__((aligned(64))) float noise_vector[SRSRAN_SIMD_F_SIZE];
+  srsran_simd_f_store(noise_vector, _noise);
+  for (uint32_t j = 0; j < SRSRAN_SIMD_F_SIZE; j++) {
+    noise += noise_vector[j];
+  }
+#endif
+
+  for (; i < len; i++) {
+    cf_t ls[SRSRAN_SL_MAX_DMRS_SYMB];
+    h0[i] = 0.0f;
+    h1[i] = 0.0f;
+    for (uint32_t n = 0; n < w->nof_dmrs; n++) {
+      ls[n] = sf_buffer[w->dmrs_l[n] * n_re + k_start + i] * conjf(r[n][offset + i]);
+      h0[i] += ls[n] * w->w_avg[0][n];
+      h1[i] += ls[n] * w->w_avg[1][n];
+      for (uint32_t m = 0; m <= n; m++) {
+        float g = (m == n) ? w->g[n][m] : 2.0f * w->g[n][m];
+        noise += g * __real__(ls[n] * conjf(ls[m]));
+      }
+    }
+  }
+
+  return noise / len;
+}
+
+/* MMSE equalization of the data REs of one band, written at offset of every SC-FDMA symbol of length M */
+static void chest_sl_fused_equalize(srsran_chest_sl_t*              q,
+                                    const chest_sl_fused_weights_t* w,
+                                    cf_t*                           sf_buffer,
+                                    uint32_t                        k_start,
+                                    uint32_t                        len,
+                                    uint32_t                        offset,
+                                    uint32_t                        M,
+                                    cf_t*                           scfdma_symbols)
+{
+  uint32_t n_re = q->cell.nof_prb * SRSRAN_NRE;
+  cf_t*    h0   = &q->ce_average[offset];
+  cf_t*    h1   = &q->ce_average[M + offset];
+  uint32_t i    = 0;
+
+#if SRSRAN_SIMD_CF_SIZE
+  const simd_f_t _noise = srsran_simd_f_set1(q->noise_estimated);
+  for (; i + SRSRAN_SIMD_CF_SIZE <= len; i += SRSRAN_SIMD_CF_SIZE) {
+    simd_cf_t _h[2]   = {srsran_simd_cfi_loadu(&h0[i]), srsran_simd_cfi_loadu(&h1[i])};
+    simd_f_t  _rcp[2] = {};
+    for (uint32_t h = 0; h < 2; h++) {
+      simd_f_t _hh = srsran_simd_cf_re(srsran_simd_cf_conjprod(_h[h], _h[h]));
+      _rcp[h]      = srsran_simd_f_rcp(srsran_simd_f_add(_hh, _noise));
+    }
+    for (uint32_t d = 0; d < w->nof_data; d++) {
+      uint32_t  l  = w->data_l[d];
+      uint32_t  h  = (l < w->nof_symbols / 2) ? 0 : 1;
+      simd_cf_t _y = srsran_simd_cfi_loadu(&sf_buffer[l * n_re + k_start + i]);
+      srsran_simd_cfi_storeu(&scfdma_symbols[d * M + offset + i],
+                             srsran_simd_cf_mul(srsran_simd_cf_conjprod(_y, _h[h]), _rcp[h]));
+    }
+  }
+#endif
+
+  for (; i < len; i++) {
+    cf_t  h[2]   = {h0[i], h1[i]};
+    float rcp[2] = {1.0f / (__real__(h[0] * conjf(h[0])) + q->noise_estimated),
+                    1.0f / (__real__(h[1] * conjf(h[1])) + q->noise_estimated)};
+    for (uint32_t d = 0; d < w->nof_data; d++) {
+      uint32_t l                         = w->data_l[d];
+      uint32_t j                         = (l < w->nof_symbols / 2) ? 0 : 1;
+      scfdma_symbols[d * M + offset + i] = sf_buffer[l * n_re + k_start + i] * conjf(h[j]) * rcp[j];
+    }
+  }
+}
+
+static int chest_sl_wiener_set_symbols(srsran_chest_sl_t* q)
+{
+  chest_sl_fused_weights_t w = {};
+  if (q->wiener_sl == NULL || chest_sl_fused_weights(q, &w) != SRSRAN_SUCCESS) {
+    return SRSRAN_ERROR;
+  }
+  return srsran_wiener_sl_set_symbols(q->wiener_sl, w.nof_symbols, w.dmrs_l, w.nof_dmrs);
+}
+
+/* Wiener filtered estimates of every DMRS symbol n of the allocation, stored in ce at n * M. The LS estimates they are
+ * filtered from go through noise_tmp. Chooses the SNR bin from the noise estimate and the Doppler bin from the
+ * correlation between consecutive DMRS symbols.
+ *
+ * The filters assume a channel centred on the FFT window and no frequency offset. The mean delay, seen as a phase slope
+ * across subcarriers, is removed before the frequency filter and restored after it, and the phase drift between DMRS
+ * symbols is kept for the time interpolation. */
+static void chest_sl_wiener_pilots(srsran_chest_sl_t*              q,
+                                   const chest_sl_fused_weights_t* w,
+                                   cf_t*                           sf_buffer,
+                                   cf_t**                          r,
+                                   const uint32_t*                 k_start,
+                                   const uint32_t*                 len,
+                                   uint32_t                        nof_bands,
+                                   uint32_t                        M)
+{
+  srsran_wiener_sl_t* wiener = q->wiener_sl;
+  uint32_t            n_re   = q->cell.nof_prb * SRSRAN_NRE;
+  cf_t*               ls     = q->noise_tmp;
+  cf_t*               hf     = q->ce;
+
+  for (uint32_t n = 0, offset = 0; n < w->nof_dmrs; n++, offset = 0) {
+    for (uint32_t b = 0; b < nof_bands; b++) {
+      srsran_vec_prod_conj_ccc(
+          &sf_buffer[w->dmrs_l[n] * n_re + k_start[b]], &r[n][offset], &ls[n * M + offset], len[b]);
+      offset += len[b];
+    }
+  }
+
+  float noise = q->noise_estimated;
+  float power = srsran_vec_avg_power_cf(ls, w->nof_dmrs * M);
+  float snr   = (noise > 0.0f) ? (power - noise) / noise : INFINITY;
+  q->wiener_snr_bin = srsran_wiener_sl_snr_bin(srsran_convert_power_to_dB(snr));
+
+  // Phase slope between adjacent subcarriers, only within a band
+  cf_t slope = 0.0f;
+  for (uint32_t n = 0, offset = 0; n < w->nof_dmrs; n++, offset = 0) {
+    for (uint32_t b = 0; b < nof_bands; b++) {
+      slope += srsran_vec_dot_prod_conj_ccc(&ls[n * M + offset + 1], &ls[n * M + offset], len[b] - 1);
+      offset += len[b];
+    }
+  }
+
+  // Powers of the unit slope phasor, doubling the filled part each step. They go in the buffer of the half slot
+  // averages, which the Wiener estimator does not use.
+  cf_t*    rot     = q->ce_average;
+  uint32_t rot_len = SRSRAN_MAX(len[0], len[1]);
+  float    mag     = cabsf(slope);
+  rot[0]           = 1.0f;
+  cf_t step        = (mag > 0.0f) ? slope / mag : 1.0f;
+  for (uint32_t k = 1; k < rot_len; k *= 2) {
+    srsran_vec_sc_prod_ccc(rot, rot[k - 1] * step, &rot[k], SRSRAN_MIN(k, rot_len - k));
+  }
+
+  for (uint32_t n = 0, offset = 0; n < w->nof_dmrs; n++, offset = 0) {
+    for (uint32_t b = 0; b < nof_bands; b++) {
+      cf_t* x = &ls[n * M + offset];
+      cf_t* y = &hf[n * M + offset];
+      srsran_vec_prod_conj_ccc(x, rot, x, len[b]);
+      srsran_wiener_sl_filter_freq(wiener, q->wiener_snr_bin, x, y, len[b]);
+      srsran_vec_prod_ccc(y, rot, y, len[b]);
+      offset += len[b];
+    }
+  }
+
+  // The magnitude ignores a residual frequency offset, the noise left by the frequency filter is removed
+  cf_t  corr     = 0.0f;
+  float hf_power = 0.0f;
+  for (uint32_t n = 0; n + 1 < w->nof_dmrs; n++) {
+    corr += srsran_vec_dot_prod_conj_ccc(&hf[(n + 1) * M], &hf[n * M], M);
+  }
+  float dmrs_gap      = (float)(w->dmrs_l[w->nof_dmrs - 1] - w->dmrs_l[0]) / (float)(w->nof_dmrs - 1);
+  q->wiener_phase_rad = cargf(corr) / dmrs_gap;
+
+  hf_power = srsran_vec_avg_power_cf(hf, w->nof_dmrs * M) * (w->nof_dmrs - 1) * M;
+  hf_power -= noise * wiener->freq_noise_gain[q->wiener_snr_bin] * (w->nof_dmrs - 1) * M;
+  float rho             = (hf_power > 0.0f) ? SRSRAN_MIN(cabsf(corr) / hf_power, 1.0f) : 1.0f;
+  q->wiener_doppler_bin = srsran_wiener_sl_doppler_bin(wiener, rho);
+}
+
+/* Time interpolation coefficients of every data symbol d, c[d][n] weighting the filtered estimates of DMRS symbol n.
+ * They follow the phase drift from each DMRS symbol to the data symbol. */
+static void chest_sl_wiener_time_coeffs(srsran_chest_sl_t*              q,
+                                        const chest_sl_fused_weights_t* w,
+                                        cf_t c[SRSRAN_CP_NORM_SF_NSYMB][SRSRAN_WIENER_SL_MAX_DMRS_SYMB])
+{
+  // Phase drift over 0 to nof_symbols - 1 symbols
+  cf_t drift[SRSRAN_WIENER_SL_MAX_SYMB];
+  drift[0]  = 1.0f;
+  cf_t step = cexpf(_Complex_I * q->wiener_phase_rad);
+  for (uint32_t m = 1; m < w->nof_symbols; m++) {
+    drift[m] = drift[m - 1] * step;
+  }
+
+  for (uint32_t d = 0; d < w->nof_data; d++) {
+    uint32_t     l  = w->data_l[d];
+    const float* tc = q->wiener_sl->time[q->wiener_doppler_bin][q->wiener_snr_bin][l];
+    for (uint32_t n = 0; n < w->nof_dmrs; n++) {
+      c[d][n] = tc[n] * (l >= w->dmrs_l[n] ? drift[l - w->dmrs_l[n]] : conjf(drift[w->dmrs_l[n] - l]));
+    }
+  }
+}
+
+/* Wiener estimate of one data symbol, h = sum_n c[n] hf[n * M] */
+static void
+chest_sl_wiener_interpolate(const cf_t* hf, const cf_t* c, uint32_t nof_dmrs, uint32_t M, cf_t* h, uint32_t len)
+{
+  uint32_t i = 0;
+
+#if SRSRAN_SIMD_CF_SIZE
+  for (; i + SRSRAN_SIMD_CF_SIZE <= len; i += SRSRAN_SIMD_CF_SIZE) {
+    simd_cf_t _h = srsran_simd_cf_zero();
+    for (uint32_t n = 0; n < nof_dmrs; n++) {
+      _h = srsran_simd_cf_add(_h,
+                              srsran_simd_cf_prod(srsran_simd_cfi_loadu(&hf[n * M + i]), srsran_simd_cf_set1(c[n])));
+    }
+    srsran_simd_cfi_storeu(&h[i], _h);
+  }
+#endif
+
+  for (; i < len; i++) {
+    h[i] = 0.0f;
+    for (uint32_t n = 0; n < nof_dmrs; n++) {
+      h[i] += hf[n * M + i] * c[n];
+    }
+  }
+}
+
+/* MMSE equalization of the data REs of one band with the per symbol Wiener estimates */
+static void chest_sl_wiener_equalize(srsran_chest_sl_t*              q,
+                                     const chest_sl_fused_weights_t* w,
+                                     cf_t*                           sf_buffer,
+                                     uint32_t                        k_start,
+                                     uint32_t                        len,
+                                     uint32_t                        offset,
+                                     uint32_t                        M,
+                                     cf_t*                           scfdma_symbols)
+{
+  uint32_t n_re = q->cell.nof_prb * SRSRAN_NRE;
+  cf_t*    hf   = &q->ce[offset];
+
+  cf_t c[SRSRAN_CP_NORM_SF_NSYMB][SRSRAN_WIENER_SL_MAX_DMRS_SYMB];
+  chest_sl_wiener_time_coeffs(q, w, c);
+
+  for (uint32_t d = 0; d < w->nof_data; d++) {
+    cf_t*    y = &sf_buffer[w->data_l[d] * n_re + k_start];
+    cf_t*    x = &scfdma_symbols[d * M + offset];
+    uint32_t i = 0;
+
+#if SRSRAN_SIMD_CF_SIZE
+    const simd_f_t _noise = srsran_simd_f_set1(q->noise_estimated);
+    for (; i + SRSRAN_SIMD_CF_SIZE <= len; i += SRSRAN_SIMD_CF_SIZE) {
+      simd_cf_t _h = srsran_simd_cf_zero();
+      for (uint32_t n = 0; n < w->nof_dmrs; n++) {
+        _h = srsran_simd_cf_add(
+            _h, srsran_simd_cf_prod(srsran_simd_cfi_loadu(&hf[n * M + i]), srsran_simd_cf_set1(c[d][n])));
+      }
+      simd_f_t _rcp = srsran_simd_f_rcp(srsran_simd_f_add(srsran_simd_cf_re(srsran_simd_cf_conjprod(_h, _h)), _noise));
+      srsran_simd_cfi_storeu(&x[i], srsran_simd_cf_mul(srsran_simd_cf_conjprod(srsran_simd_cfi_loadu(&y[i]), _h), _rcp));
+    }
+#endif
+
+    for (; i < len; i++) {
+      cf_t h = 0.0f;
+      for (uint32_t n = 0; n < w->nof_dmrs; n++) {
+        h += hf[n * M + i] * c[d][n];
+      }
+      x[i] = y[i] * conjf(h) / (__real__(h * conjf(h)) + q->noise_estimated);
+    }
+  }
+}
+
+/* Adds the matched filter output conj(h) y of one port to x and |h|^2 to g, or initializes them for the first port */
+static void chest_sl_combine_accumulate(const cf_t* h, const cf_t* y, cf_t* x, float* g, uint32_t len, bool first)
+{
+  uint32_t i = 0;
+
+#if SRSRAN_SIMD_CF_SIZE
+  for (; i + SRSRAN_SIMD_CF_SIZE <= len; i += SRSRAN_SIMD_CF_SIZE) {
+    simd_cf_t _h  = srsran_simd_cfi_loadu(&h[i]);
+    simd_cf_t _x  = srsran_simd_cf_conjprod(srsran_simd_cfi_loadu(&y[i]), _h);
+    simd_f_t  _hh = srsran_simd_cf_re(srsran_simd_cf_conjprod(_h, _h));
+    if (!first) {
+      _x  = srsran_simd_cf_add(_x, srsran_simd_cfi_loadu(&x[i]));
+      _hh = srsran_simd_f_add(_hh, srsran_simd_f_loadu(&g[i]));
+    }
+    srsran_simd_cfi_storeu(&x[i], _x);
+    srsran_simd_f_storeu(&g[i], _hh);
+  }
+#endif
+
+  for (; i < len; i++) {
+    float re  = __real__ h[i] * __real__ y[i] + __imag__ h[i] * __imag__ y[i];
+    float im  = __real__ h[i] * __imag__ y[i] - __imag__ h[i] * __real__ y[i];
+    float hh  = __real__ h[i] * __real__ h[i] + __imag__ h[i] * __imag__ h[i];
+    cf_t  acc = first ? 0.0f : x[i];
+    __real__ acc += re;
+    __imag__ acc += im;
+    x[i] = acc;
+    g[i] = first ? hh : g[i] + hh;
+  }
+}
+
+/* Accumulates one port into the combiner, every data RE of one band with the estimate of its symbol */
+static void chest_sl_combine_port(srsran_chest_sl_t*              q,
+                                  const chest_sl_fused_weights_t* w,
+                                  const cf_t                      c[SRSRAN_CP_NORM_SF_NSYMB][SRSRAN_WIENER_SL_MAX_DMRS_SYMB],
+                                  cf_t*                           sf_buffer,
+                                  uint32_t                        k_start,
+                                  uint32_t                        len,
+                                  uint32_t                        offset,
+                                  uint32_t                        M,
+                                  bool                            first,
+                                  cf_t*                           scfdma_symbols)
+{
+  uint32_t n_re = q->cell.nof_prb * SRSRAN_NRE;
+
+  for (uint32_t d = 0; d < w->nof_data; d++) {
+    uint32_t l = w->data_l[d];
+    cf_t*    h;
+    if (c != NULL) {
+      // The LS estimates in noise_tmp are no longer needed once filtered
+      h = q->noise_tmp;
+      chest_sl_wiener_interpolate(&q->ce[offset], c[d], w->nof_dmrs, M, h, len);
+    } else {
+      h = &q->ce_average[((l < w->nof_symbols / 2) ? 0 : M) + offset];
+    }
+    chest_sl_combine_accumulate(h,
+                                &sf_buffer[l * n_re + k_start],
+                                &scfdma_symbols[d * M + offset],
+                                &q->combining_gain[d * M + offset],
+                                len,
+                                first);
+  }
+}
+
+/* x = x / (g + noise) */
+static void chest_sl_combine_normalize(cf_t* x, const float* g, float noise, uint32_t len)
+{
+  uint32_t i = 0;
+
+#if SRSRAN_SIMD_CF_SIZE
+  const simd_f_t _noise = srsran_simd_f_set1(noise);
+  for (; i + SRSRAN_SIMD_CF_SIZE <= len; i += SRSRAN_SIMD_CF_SIZE) {
+    simd_f_t _rcp = srsran_simd_f_rcp(srsran_simd_f_add(srsran_simd_f_loadu(&g[i]), _noise));
+    srsran_simd_cfi_storeu(&x[i], srsran_simd_cf_mul(srsran_simd_cfi_loadu(&x[i]), _rcp));
+  }
+#endif
+
+  for (; i < len; i++) {
+    float rcp = 1.0f / (g[i] + noise);
+    __real__ x[i] *= rcp;
+    __imag__ x[i] *= rcp;
+  }
+}
+
+static bool chest_sl_use_wiener(srsran_chest_sl_t* q)
+{
+  return q->chest_sl_cfg.estimator_alg == SRSRAN_SL_ESTIMATOR_ALG_WIENER && q->wiener_sl != NULL;
+}
+
+/* Pilot part of the fused estimation of one port, shared by the single and the multi port equalizers. Returns the
+ * allocation length M, or SRSRAN_ERROR */
+static int chest_sl_fused_estimate(srsran_chest_sl_t*        q,
+                                   chest_sl_fused_weights_t* w,
+                                   cf_t*                     sf_buffer,
+                                   uint32_t                  k_start[2],
+                                   uint32_t                  len[2],
+                                   uint32_t*                 nof_bands)
+{
+  if (q->channel != SRSRAN_SIDELINK_PSCCH && q->channel != SRSRAN_SIDELINK_PSSCH) {
+    ERROR("Fused sidelink channel estimation is only supported for PSCCH and PSSCH\n");
+    return SRSRAN_ERROR;
+  }
+
+  if (chest_sl_fused_weights(q, w) != SRSRAN_SUCCESS) {
+    return SRSRAN_ERROR;
+  }
+
+  cf_t* r[SRSRAN_SL_MAX_DMRS_SYMB] = {};
+  for (uint32_t n = 0; n < w->nof_dmrs; n++) {
+    r[n] = q->r_sequence[n][q->channel == SRSRAN_SIDELINK_PSCCH ? q->chest_sl_cfg.cyclic_shift / 3 : 0];
+  }
+
+  *nof_bands = chest_sl_fused_bands(q, k_start, len);
+  uint32_t M = len[0] + (*nof_bands > 1 ? len[1] : 0);
+
+  // The noise is needed before equalizing the first RE, so the DMRS symbols are reduced first. They are a third of the
+  // REs and leave only the 2 * M half slot averages behind.
+  q->noise_estimated = 0.0f;
+  uint32_t offset    = 0;
+  for (uint32_t b = 0; b < *nof_bands; b++) {
+    q->noise_estimated += chest_sl_fused_pilots(q, w, sf_buffer, r, k_start[b], len[b], offset, M);
+    offset += len[b];
+  }
+  q->noise_estimated /= (float)w->nof_symbols;
+
+  if (chest_sl_use_wiener(q)) {
+    chest_sl_wiener_pilots(q, w, sf_buffer, r, k_start, len, *nof_bands, M);
+
+    // Received power of the filtered DMRS estimates
+    q->rsrp_corr = q->rsrp_enable ? srsran_vec_avg_power_cf(q->ce, w->nof_dmrs * M) : NAN;
+  } else {
+    // Received power of the half slot estimates, the interpolated estimates are not formed
+    q->rsrp_corr = q->rsrp_enable ? srsran_vec_avg_power_cf(q->ce_average, 2 * M) : NAN;
+  }
+
+  return (int)M;
+}
+
+int srsran_chest_sl_ls_estimate_equalize_symbols(srsran_chest_sl_t* q, cf_t* sf_buffer, cf_t* scfdma_symbols)
+{
+  if (q == NULL || sf_buffer == NULL || scfdma_symbols == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  chest_sl_fused_weights_t w          = {};
+  uint32_t                 k_start[2] = {};
+  uint32_t                 len[2]     = {};
+  uint32_t                 nof_bands  = 0;
+  int                      ret        = chest_sl_fused_estimate(q, &w, sf_buffer, k_start, len, &nof_bands);
+  if (ret < SRSRAN_SUCCESS) {
+    return SRSRAN_ERROR;
+  }
+  uint32_t M = (uint32_t)ret;
+
+  bool     wiener = chest_sl_use_wiener(q);
+  uint32_t offset = 0;
+  for (uint32_t b = 0; b < nof_bands; b++) {
+    if (wiener) {
+      chest_sl_wiener_equalize(q, &w, sf_buffer, k_start[b], len[b], offset, M, scfdma_symbols);
+    } else {
+      chest_sl_fused_equalize(q, &w, sf_buffer, k_start[b], len[b], offset, M, scfdma_symbols);
+    }
+    offset += len[b];
+  }
+
+  // Last symbol is used in channel processing but not transmitted
+  uint32_t nof_re = w.nof_data * M;
+  srsran_vec_cf_zero(&scfdma_symbols[nof_re], M);
+
+  return nof_re;
+}
+
+int srsran_chest_sl_ls_estimate_equalize_symbols_multi(srsran_chest_sl_t* q,
+                                                       cf_t*              sf_buffer[SRSRAN_MAX_PORTS],
+                                                       uint32_t           nof_ports,
+                                                       cf_t*              scfdma_symbols)
+{
+  if (q == NULL || sf_buffer == NULL || nof_ports == 0 || nof_ports > SRSRAN_MAX_PORTS || scfdma_symbols == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  if (nof_ports == 1) {
+    return srsran_chest_sl_ls_estimate_equalize_symbols(q, sf_buffer[0], scfdma_symbols);
+  }
+
+  // The ports are estimated one after the other, each reusing the estimation buffers, and combined as they go
+  chest_sl_fused_weights_t w          = {};
+  uint32_t                 k_start[2] = {};
+  uint32_t                 len[2]     = {};
+  uint32_t                 nof_bands  = 0;
+  uint32_t                 M          = 0;
+  float                    noise      = 0.0f;
+  float                    rsrp       = 0.0f;
+  for (uint32_t p = 0; p < nof_ports; p++) {
+    if (sf_buffer[p] == NULL) {
+      return SRSRAN_ERROR_INVALID_INPUTS;
+    }
+    int ret = chest_sl_fused_estimate(q, &w, sf_buffer[p], k_start, len, &nof_bands);
+    if (ret < SRSRAN_SUCCESS) {
+      return SRSRAN_ERROR;
+    }
+    M = (uint32_t)ret;
+    noise += q->noise_estimated;
+    rsrp += q->rsrp_corr;
+
+    cf_t  c_wiener[SRSRAN_CP_NORM_SF_NSYMB][SRSRAN_WIENER_SL_MAX_DMRS_SYMB];
+    cf_t(*c)[SRSRAN_WIENER_SL_MAX_DMRS_SYMB] = NULL;
+    if (chest_sl_use_wiener(q)) {
+      chest_sl_wiener_time_coeffs(q, &w, c_wiener);
+      c = c_wiener;
+    }
+
+    uint32_t offset = 0;
+    for (uint32_t b = 0; b < nof_bands; b++) {
+      chest_sl_combine_port(q, &w, c, sf_buffer[p], k_start[b], len[b], offset, M, p == 0, scfdma_symbols);
+      offset += len[b];
+    }
+  }
+  q->noise_estimated = noise / nof_ports;
+  q->rsrp_corr       = rsrp / nof_ports;
+
+  uint32_t nof_re = w.nof_data * M;
+  chest_sl_combine_normalize(scfdma_symbols, q->combining_gain, q->noise_estimated, nof_re);
+
+  // Last symbol is used in channel processing but not transmitted
+  srsran_vec_cf_zero(&scfdma_symbols[nof_re], M);
+
+  return nof_re;
+}
+
 void srsran_chest_sl_free(srsran_chest_sl_t* q)
 {
   if (q != NULL) {
@@ -1287,5 +1922,12 @@ void srsran_chest_sl_free(srsran_chest_sl_t* q)
     if (q->noise_tmp) {
       free(q->noise_tmp);
     }
+    if (q->combining_gain) {
+      free(q->combining_gain);
+    }
+    if (q->wiener_sl) {
+      srsran_wiener_sl_free(q->wiener_sl);
+      free(q->wiener_sl);
+    }
   }
 }
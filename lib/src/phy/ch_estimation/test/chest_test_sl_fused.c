@@ -0,0 +1,266 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/ch_estimation/chest_sl.h"
+#include "srsran/phy/phch/pscch.h"
+#include "srsran/phy/phch/pssch.h"
+#include "srsran/phy/utils/random.h"
+#include "srsran/srsran.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+static uint32_t nof_prb         = 50;
+static float    snr_db          = 20.0f;
+static uint32_t nof_repetitions = 1000;
+
+static srsran_random_t random_gen = NULL;
+
+/* Random grid through a frequency selective channel which rotates slowly along the subframe, plus AWGN */
+static void generate_grid(srsran_chest_sl_t* tx, cf_t* sf_buffer, srsran_cell_sl_t* cell)
+{
+  uint32_t n_re  = cell->nof_prb * SRSRAN_NRE;
+  uint32_t nsymb = srsran_sl_get_num_symbols(cell->tm, cell->cp);
+  float    std   = powf(10.0f, -snr_db / 20.0f) / sqrtf(2.0f);
+
+  srsran_random_uniform_complex_dist_vector(random_gen, sf_buffer, n_re * nsymb, -1.0f, 1.0f);
+  srsran_chest_sl_put_dmrs(tx, sf_buffer);
+
+  for (uint32_t k = 0; k < n_re; k++) {
+    cf_t h = cexpf(I * 2.0f * (float)M_PI * k / 37.0f) * (0.5f + 0.5f * (float)k / n_re);
+    for (uint32_t l = 0; l < nsymb; l++) {
+      cf_t noise = srsran_random_gauss_dist(random_gen, std) + I * srsran_random_gauss_dist(random_gen, std);
+      sf_buffer[l * n_re + k] = sf_buffer[l * n_re + k] * h * cexpf(I * 0.05f * l) + noise;
+    }
+  }
+}
+
+static float relative_error(cf_t* x, cf_t* y, uint32_t len)
+{
+  float err = 0.0f, pwr = 0.0f;
+  for (uint32_t i = 0; i < len; i++) {
+    err += __real__((x[i] - y[i]) * conjf(x[i] - y[i]));
+    pwr += __real__(y[i] * conjf(y[i]));
+  }
+  return sqrtf(err / pwr);
+}
+
+static double elapsed_ns(struct timeval* t)
+{
+  get_time_interval(t);
+  return (t[0].tv_sec * 1e6 + t[0].tv_usec) * 1e3 / nof_repetitions;
+}
+
+static int test_channel(srsran_cell_sl_t cell, srsran_sl_channels_t channel, srsran_chest_sl_cfg_t cfg, bool benchmark)
+{
+  int                            ret = SRSRAN_ERROR;
+  srsran_sl_comm_resource_pool_t pool;
+  srsran_chest_sl_t              tx = {}, rx = {};
+  srsran_pscch_t                 pscch = {};
+  srsran_pssch_t                 pssch = {};
+  uint32_t                       sf_n_re     = SRSRAN_SF_LEN_RE(cell.nof_prb, cell.cp);
+  cf_t*                          sf_buffer   = srsran_vec_cf_malloc(sf_n_re);
+  cf_t*                          equalized   = srsran_vec_cf_malloc(sf_n_re);
+  cf_t*                          ref_symbols = srsran_vec_cf_malloc(sf_n_re);
+  cf_t*                          scfdma      = NULL;
+  int                            nof_re      = 0;
+  uint32_t                       M           = 0;
+
+  srsran_sl_comm_resource_pool_get_default_config(&pool, cell);
+  if (!sf_buffer || !equalized || !ref_symbols || srsran_chest_sl_init(&tx, channel, cell, pool) ||
+      srsran_chest_sl_init(&rx, channel, cell, pool) || srsran_chest_sl_set_cfg(&tx, cfg) ||
+      srsran_chest_sl_set_cfg(&rx, cfg)) {
+    ERROR("Error initiating test\n");
+    goto clean_exit;
+  }
+
+  if (channel == SRSRAN_SIDELINK_PSCCH) {
+    if (srsran_pscch_init(&pscch, SRSRAN_MAX_PRB) || srsran_pscch_set_cell(&pscch, cell)) {
+      ERROR("Error initiating PSCCH\n");
+      goto clean_exit;
+    }
+    scfdma = pscch.scfdma_symbols;
+  } else {
+    srsran_pssch_cfg_t pssch_cfg = {cfg.prb_start_idx, cfg.nof_prb, cfg.N_x_id, 0, 0, cfg.sf_idx};
+    if (srsran_pssch_init(&pssch, cell, pool) || srsran_pssch_set_cfg(&pssch, pssch_cfg)) {
+      ERROR("Error initiating PSSCH\n");
+      goto clean_exit;
+    }
+    scfdma = pssch.scfdma_symbols;
+  }
+
+  generate_grid(&tx, sf_buffer, &cell);
+
+  // Reference: estimation and equalization of the whole grid followed by the RE extraction
+  srsran_chest_sl_ls_estimate_equalize(&rx, sf_buffer, equalized);
+  float ref_noise = rx.noise_estimated;
+  if (channel == SRSRAN_SIDELINK_PSCCH) {
+    M      = SRSRAN_NRE * pscch.pscch_nof_prb;
+    nof_re = srsran_pscch_get(&pscch, equalized, cfg.prb_start_idx);
+    srsran_vec_cf_copy(ref_symbols, scfdma, nof_re + M);
+  } else {
+    M      = SRSRAN_NRE * cfg.nof_prb;
+    nof_re = srsran_pssch_get(&pssch, equalized, ref_symbols);
+    srsran_vec_cf_zero(&ref_symbols[nof_re], M);
+  }
+
+  bzero(scfdma, sizeof(cf_t) * nof_re);
+  if (srsran_chest_sl_ls_estimate_equalize_symbols(&rx, sf_buffer, scfdma) != nof_re) {
+    ERROR("Wrong number of equalized REs\n");
+    goto clean_exit;
+  }
+
+  // Including the zeroed last symbol
+  float err = relative_error(scfdma, ref_symbols, nof_re + M);
+  printf("%s TM%d %s CP, %2d PRB at %2d: noise %.5f (ref %.5f), relative error %.2e\n",
+         channel == SRSRAN_SIDELINK_PSCCH ? "PSCCH" : "PSSCH",
+         cell.tm,
+         cell.cp == SRSRAN_CP_NORM ? "normal" : "extended",
+         M / SRSRAN_NRE,
+         cfg.prb_start_idx,
+         rx.noise_estimated,
+         ref_noise,
+         err);
+  if (fabsf(rx.noise_estimated - ref_noise) > 1e-3f * ref_noise || err > 1e-3f) {
+    ERROR("Fused estimation does not match the reference\n");
+    goto clean_exit;
+  }
+
+  if (benchmark) {
+    struct timeval t[3];
+    gettimeofday(&t[1], NULL);
+    for (uint32_t r = 0; r < nof_repetitions; r++) {
+      srsran_chest_sl_ls_estimate_equalize(&rx, sf_buffer, equalized);
+      if (channel == SRSRAN_SIDELINK_PSCCH) {
+        srsran_pscch_get(&pscch, equalized, cfg.prb_start_idx);
+      } else {
+        srsran_pssch_get(&pssch, equalized, scfdma);
+      }
+    }
+    gettimeofday(&t[2], NULL);
+    double separate = elapsed_ns(t);
+
+    gettimeofday(&t[1], NULL);
+    for (uint32_t r = 0; r < nof_repetitions; r++) {
+      srsran_chest_sl_ls_estimate_equalize_symbols(&rx, sf_buffer, scfdma);
+    }
+    gettimeofday(&t[2], NULL);
+    double fused = elapsed_ns(t);
+
+    printf("  %.0f ns separate passes, %.0f ns fused (%.2fx)\n", separate, fused, separate / fused);
+  }
+
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_chest_sl_free(&tx);
+  srsran_chest_sl_free(&rx);
+  if (channel == SRSRAN_SIDELINK_PSCCH) {
+    srsran_pscch_free(&pscch);
+  } else {
+    srsran_pssch_free(&pssch);
+  }
+  free(sf_buffer);
+  free(equalized);
+  free(ref_symbols);
+  return ret;
+}
+
+static void usage(char* prog)
+{
+  printf("Usage: %s\n", prog);
+  printf("\t-p nof_prb [Default %d]\n", nof_prb);
+  printf("\t-s SNR in dB [Default %.1f]\n", snr_db);
+  printf("\t-r nof_repetitions for the benchmark [Default %d]\n", nof_repetitions);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "psr")) != -1) {
+    switch (opt) {
+      case 'p':
+        nof_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        snr_db = strtof(argv[optind], NULL);
+        break;
+      case 'r':
+        nof_repetitions = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+  random_gen = srsran_random_init(0x1234);
+
+  srsran_cell_sl_t cell_tm4 = {.nof_prb = nof_prb, .N_sl_id = 168, .tm = SRSRAN_SIDELINK_TM4, .cp = SRSRAN_CP_NORM};
+  srsran_cell_sl_t cell_tm2 = {.nof_prb = nof_prb, .N_sl_id = 168, .tm = SRSRAN_SIDELINK_TM2, .cp = SRSRAN_CP_NORM};
+  srsran_cell_sl_t cell_ext = {.nof_prb = nof_prb, .N_sl_id = 168, .tm = SRSRAN_SIDELINK_TM2, .cp = SRSRAN_CP_EXT};
+
+  for (uint32_t cs = 0; cs <= 9; cs += 3) {
+    srsran_chest_sl_cfg_t cfg = {.prb_start_idx = 10, .cyclic_shift = cs};
+    TESTASSERT(test_channel(cell_tm4, SRSRAN_SIDELINK_PSCCH, cfg, cs == 0) == SRSRAN_SUCCESS);
+  }
+  srsran_chest_sl_cfg_t pscch_cfg = {.prb_start_idx = 3};
+  TESTASSERT(test_channel(cell_tm2, SRSRAN_SIDELINK_PSCCH, pscch_cfg, false) == SRSRAN_SUCCESS);
+  TESTASSERT(test_channel(cell_ext, SRSRAN_SIDELINK_PSCCH, pscch_cfg, false) == SRSRAN_SUCCESS);
+
+  // Full band PSSCH of a 50 PRB pool with sizeSubchannel=10, and a small odd sized allocation for the scalar tail
+  uint32_t prb = srsran_dft_precoding_get_valid_prb(nof_prb - 2);
+  for (uint32_t sf_idx = 0; sf_idx < 10; sf_idx += 3) {
+    srsran_chest_sl_cfg_t cfg = {.prb_start_idx = 2, .nof_prb = prb, .N_x_id = 1234 + sf_idx, .sf_idx = sf_idx};
+    TESTASSERT(test_channel(cell_tm4, SRSRAN_SIDELINK_PSSCH, cfg, sf_idx == 0) == SRSRAN_SUCCESS);
+  }
+  srsran_chest_sl_cfg_t small_cfg = {.prb_start_idx = 12, .nof_prb = 3, .N_x_id = 77, .sf_idx = 5};
+  TESTASSERT(test_channel(cell_tm4, SRSRAN_SIDELINK_PSSCH, small_cfg, false) == SRSRAN_SUCCESS);
+
+  srsran_chest_sl_cfg_t band_cfg = {.prb_start_idx = 1, .nof_prb = 5, .N_x_id = 42};
+  TESTASSERT(test_channel(cell_tm2, SRSRAN_SIDELINK_PSSCH, band_cfg, false) == SRSRAN_SUCCESS);
+
+  // TM2 allocations larger than prb_num are split in two bands, which do not overlap when starting at the pool start
+  band_cfg.prb_start_idx = 0;
+  band_cfg.nof_prb       = srsran_dft_precoding_get_valid_prb(nof_prb / 2 + 5);
+  TESTASSERT(test_channel(cell_tm2, SRSRAN_SIDELINK_PSSCH, band_cfg, false) == SRSRAN_SUCCESS);
+  TESTASSERT(test_channel(cell_ext, SRSRAN_SIDELINK_PSSCH, band_cfg, false) == SRSRAN_SUCCESS);
+
+  srsran_random_free(random_gen);
+  printf("Ok\n");
+  return SRSRAN_SUCCESS;
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/ch_estimation/chest_sl.h"
+#include "srsran/phy/phch/pscch.h"
+#include "srsran/phy/phch/pssch.h"
+#include "srsran/phy/utils/random.h"
+#include "srsran/srsran.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+#define NOF_PATHS 3
+#define MAX_PORTS 4
+
+static uint32_t nof_prb         = 50;
+static uint32_t nof_subframes   = 20;
+static float    doppler_hz      = 300.0f;
+static uint32_t nof_repetitions = 1000;
+
+static srsran_random_t       random_gen = NULL;
+static srsran_channel_awgn_t awgn       = {};
+
+static const float path_delay_ns[NOF_PATHS] = {0.0f, 300.0f, 900.0f};
+static const float path_gain_db[NOF_PATHS]  = {0.0f, -3.0f, -8.0f};
+
+/* The grid tx through an independent multipath channel with a Doppler shift per path, plus AWGN, as seen by one port */
+static void apply_channel(cf_t* tx, cf_t* sf_buffer, srsran_cell_sl_t* cell, float snr_db)
+{
+  uint32_t n_re  = cell->nof_prb * SRSRAN_NRE;
+  uint32_t nsymb = srsran_sl_get_num_symbols(cell->tm, cell->cp);
+
+  cf_t  a[NOF_PATHS];
+  float f[NOF_PATHS];
+  float norm = 0.0f;
+  for (uint32_t p = 0; p < NOF_PATHS; p++) {
+    float phase = srsran_random_uniform_real_dist(random_gen, 0.0f, 2.0f * (float)M_PI);
+    a[p]        = powf(10.0f, path_gain_db[p] / 20.0f) * cexpf(I * phase);
+    f[p]        = doppler_hz * cosf(srsran_random_uniform_real_dist(random_gen, 0.0f, 2.0f * (float)M_PI));
+    norm += powf(10.0f, path_gain_db[p] / 10.0f);
+  }
+
+  for (uint32_t l = 0; l < nsymb; l++) {
+    float t = 1e-3f * l / nsymb;
+    for (uint32_t k = 0; k < n_re; k++) {
+      cf_t h = 0.0f;
+      for (uint32_t p = 0; p < NOF_PATHS; p++) {
+        h += a[p] * cexpf(I * 2.0f * (float)M_PI * (f[p] * t - path_delay_ns[p] * 1e-9f * 15e3f * k));
+      }
+      sf_buffer[l * n_re + k] = tx[l * n_re + k] * h / sqrtf(norm);
+    }
+  }
+
+  srsran_channel_awgn_set_n0(&awgn, -snr_db);
+  srsran_channel_awgn_run_c(&awgn, sf_buffer, sf_buffer, n_re * nsymb);
+}
+
+static float mse(cf_t* x, cf_t* y, uint32_t len)
+{
+  float err = 0.0f;
+  for (uint32_t i = 0; i < len; i++) {
+    err += __real__((x[i] - y[i]) * conjf(x[i] - y[i]));
+  }
+  return err / len;
+}
+
+static double elapsed_ns(struct timeval* t)
+{
+  get_time_interval(t);
+  return (t[0].tv_sec * 1e6 + t[0].tv_usec) * 1e3 / nof_repetitions;
+}
+
+/* Mean squared error of the symbols combined from 1, 2 and 4 ports, over the same subframes, and time per call */
+static int test_channel(srsran_cell_sl_t                cell,
+                        srsran_sl_channels_t            channel,
+                        srsran_chest_sl_cfg_t           cfg,
+                        srsran_chest_sl_estimator_alg_t alg,
+                        float                           snr_db)
+{
+  int                            ret = SRSRAN_ERROR;
+  srsran_sl_comm_resource_pool_t pool;
+  srsran_chest_sl_t              dmrs = {}, rx = {};
+  srsran_pscch_t                 pscch = {};
+  srsran_pssch_t                 pssch = {};
+  uint32_t                       sf_n_re                     = SRSRAN_SF_LEN_RE(cell.nof_prb, cell.cp);
+  cf_t*                          tx                          = srsran_vec_cf_malloc(sf_n_re);
+  cf_t*                          sf_buffer[SRSRAN_MAX_PORTS] = {};
+  cf_t*                          tx_syms                     = srsran_vec_cf_malloc(sf_n_re);
+  cf_t*                          single                      = srsran_vec_cf_malloc(sf_n_re);
+  cf_t*                          scfdma                      = NULL;
+  float                          err[MAX_PORTS + 1]          = {};
+  int                            nof_re                      = 0;
+
+  for (uint32_t p = 0; p < MAX_PORTS; p++) {
+    sf_buffer[p] = srsran_vec_cf_malloc(sf_n_re);
+    if (!sf_buffer[p]) {
+      goto clean_exit;
+    }
+  }
+
+  srsran_sl_comm_resource_pool_get_default_config(&pool, cell);
+  cfg.estimator_alg = alg;
+  if (!tx || !tx_syms || !single || srsran_chest_sl_init(&dmrs, channel, cell, pool) ||
+      srsran_chest_sl_init(&rx, channel, cell, pool) || srsran_chest_sl_set_cfg(&dmrs, cfg) ||
+      srsran_chest_sl_set_cfg(&rx, cfg)) {
+    ERROR("Error initiating test\n");
+    goto clean_exit;
+  }
+
+  if (channel == SRSRAN_SIDELINK_PSCCH) {
+    if (srsran_pscch_init(&pscch, SRSRAN_MAX_PRB) || srsran_pscch_set_cell(&pscch, cell)) {
+      ERROR("Error initiating PSCCH\n");
+      goto clean_exit;
+    }
+    scfdma = pscch.scfdma_symbols;
+  } else {
+    srsran_pssch_cfg_t pssch_cfg = {cfg.prb_start_idx, cfg.nof_prb, cfg.N_x_id, 0, 0, cfg.sf_idx};
+    if (srsran_pssch_init(&pssch, cell, pool) || srsran_pssch_set_cfg(&pssch, pssch_cfg)) {
+      ERROR("Error initiating PSSCH\n");
+      goto clean_exit;
+    }
+    scfdma = pssch.scfdma_symbols;
+  }
+
+  for (uint32_t sf = 0; sf < nof_subframes; sf++) {
+    uint32_t n_re = cell.nof_prb * SRSRAN_NRE * srsran_sl_get_num_symbols(cell.tm, cell.cp);
+    srsran_random_uniform_complex_dist_vector(random_gen, tx, n_re, -1.0f, 1.0f);
+    srsran_vec_sc_prod_cfc(tx, sqrtf(1.5f), tx, n_re);
+    srsran_chest_sl_put_dmrs(&dmrs, tx);
+    for (uint32_t p = 0; p < MAX_PORTS; p++) {
+      apply_channel(tx, sf_buffer[p], &cell, snr_db);
+    }
+
+    if (channel == SRSRAN_SIDELINK_PSCCH) {
+      nof_re = srsran_pscch_get(&pscch, tx, cfg.prb_start_idx);
+      srsran_vec_cf_copy(tx_syms, scfdma, nof_re);
+    } else {
+      nof_re = srsran_pssch_get(&pssch, tx, tx_syms);
+    }
+
+    // A single port gives exactly the single port equalizer
+    TESTASSERT(srsran_chest_sl_ls_estimate_equalize_symbols(&rx, sf_buffer[0], single) == nof_re);
+    TESTASSERT(srsran_chest_sl_ls_estimate_equalize_symbols_multi(&rx, sf_buffer, 1, scfdma) == nof_re);
+    TESTASSERT(memcmp(single, scfdma, sizeof(cf_t) * nof_re) == 0);
+
+    for (uint32_t nof_ports = 1; nof_ports <= MAX_PORTS; nof_ports *= 2) {
+      TESTASSERT(srsran_chest_sl_ls_estimate_equalize_symbols_multi(&rx, sf_buffer, nof_ports, scfdma) == nof_re);
+      err[nof_ports] += mse(scfdma, tx_syms, nof_re) / nof_subframes;
+    }
+  }
+
+  printf("%s %2d PRB, %s, SNR %4.1f dB: MSE 1 port %.4f, 2 ports %.4f (%+.1f dB), 4 ports %.4f (%+.1f dB)\n",
+         channel == SRSRAN_SIDELINK_PSCCH ? "PSCCH" : "PSSCH",
+         channel == SRSRAN_SIDELINK_PSCCH ? pscch.pscch_nof_prb : cfg.nof_prb,
+         alg == SRSRAN_SL_ESTIMATOR_ALG_WIENER ? "Wiener" : "LS",
+         snr_db,
+         err[1],
+         err[2],
+         srsran_convert_power_to_dB(err[2] / err[1]),
+         err[4],
+         srsran_convert_power_to_dB(err[4] / err[1]));
+  if (!(err[2] < err[1] && err[4] < err[2])) {
+    ERROR("Combining more ports does not reduce the error\n");
+    goto clean_exit;
+  }
+
+  struct timeval t[3];
+  for (uint32_t nof_ports = 1; nof_ports <= MAX_PORTS && snr_db == 0.0f; nof_ports *= 2) {
+    gettimeofday(&t[1], NULL);
+    for (uint32_t r = 0; r < nof_repetitions; r++) {
+      srsran_chest_sl_ls_estimate_equalize_symbols_multi(&rx, sf_buffer, nof_ports, scfdma);
+    }
+    gettimeofday(&t[2], NULL);
+    double ns = elapsed_ns(t);
+    printf("  %d ports %.0f ns, %.0f ns per port\n", nof_ports, ns, ns / nof_ports);
+  }
+
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_chest_sl_free(&dmrs);
+  srsran_chest_sl_free(&rx);
+  if (channel == SRSRAN_SIDELINK_PSCCH) {
+    srsran_pscch_free(&pscch);
+  } else {
+    srsran_pssch_free(&pssch);
+  }
+  free(tx);
+  free(tx_syms);
+  free(single);
+  for (uint32_t p = 0; p < MAX_PORTS; p++) {
+    free(sf_buffer[p]);
+  }
+  return ret;
+}
+
+static void usage(char* prog)
+{
+  printf("Usage: %s\n", prog);
+  printf("\t-p nof_prb [Default %d]\n", nof_prb);
+  printf("\t-n nof_subframes per SNR [Default %d]\n", nof_subframes);
+  printf("\t-d maximum Doppler shift in Hz [Default %.0f]\n", doppler_hz);
+  printf("\t-r nof_repetitions for the benchmark [Default %d]\n", nof_repetitions);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "pndr")) != -1) {
+    switch (opt) {
+      case 'p':
+        nof_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'n':
+        nof_subframes = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'd':
+        doppler_hz = strtof(argv[optind], NULL);
+        break;
+      case 'r':
+        nof_repetitions = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+  random_gen = srsran_random_init(0x1234);
+  if (srsran_channel_awgn_init(&awgn, 0x1234) != SRSRAN_SUCCESS) {
+    ERROR("Error initializing AWGN channel\n");
+    return SRSRAN_ERROR;
+  }
+
+  srsran_cell_sl_t cell = {.nof_prb = nof_prb, .N_sl_id = 168, .tm = SRSRAN_SIDELINK_TM4, .cp = SRSRAN_CP_NORM};
+
+  for (uint32_t alg = 0; alg < 2; alg++) {
+    srsran_chest_sl_estimator_alg_t estimator = alg ? SRSRAN_SL_ESTIMATOR_ALG_WIENER : SRSRAN_SL_ESTIMATOR_ALG_LS;
+    for (float snr_db = 0.0f; snr_db <= 20.0f; snr_db += 10.0f) {
+      srsran_chest_sl_cfg_t pscch_cfg = {.prb_start_idx = 10, .cyclic_shift = 3};
+      TESTASSERT(test_channel(cell, SRSRAN_SIDELINK_PSCCH, pscch_cfg, estimator, snr_db) == SRSRAN_SUCCESS);
+
+      srsran_chest_sl_cfg_t pssch_cfg = {.prb_start_idx = 2, .nof_prb = 10, .N_x_id = 1234, .sf_idx = 3};
+      TESTASSERT(test_channel(cell, SRSRAN_SIDELINK_PSSCH, pssch_cfg, estimator, snr_db) == SRSRAN_SUCCESS);
+
+      pssch_cfg.nof_prb = srsran_dft_precoding_get_valid_prb(nof_prb - 2);
+      TESTASSERT(test_channel(cell, SRSRAN_SIDELINK_PSSCH, pssch_cfg, estimator, snr_db) == SRSRAN_SUCCESS);
+    }
+  }
+
+  srsran_channel_awgn_free(&awgn);
+  srsran_random_free(random_gen);
+  printf("Ok\n");
+  return SRSRAN_SUCCESS;
+}
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2013-2019 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdlib.h>
+#include <strings.h>
+
+#include "srsran/phy/ch_estimation/wiener_sl.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/simd.h"
+#include "srsran/phy/utils/vector.h"
+
+#define WIENER_SL_SC_SPACING_HZ 15e3
+
+static const float doppler_bins_hz[SRSRAN_WIENER_SL_NOF_DOPPLER_BINS] = {0, 100, 200, 350, 500, 700, 1000, 1400};
+
+static float snr_bin_lin(uint32_t snr_bin)
+{
+  return powf(10.0f, (SRSRAN_WIENER_SL_SNR_MIN_DB + SRSRAN_WIENER_SL_SNR_STEP_DB * snr_bin) / 10.0f);
+}
+
+/* Solves A x = b for the n x n Hermitian positive definite A, row major, by Cholesky decomposition */
+static void wiener_sl_solve(const double complex* A, const double complex* b, double complex* x, uint32_t n)
+{
+  double complex L[SRSRAN_WIENER_SL_NOF_TAPS * SRSRAN_WIENER_SL_NOF_TAPS] = {};
+  double complex y[SRSRAN_WIENER_SL_NOF_TAPS]                             = {};
+
+  for (uint32_t i = 0; i < n; i++) {
+    for (uint32_t j = 0; j <= i; j++) {
+      double complex s = A[i * n + j];
+      for (uint32_t k = 0; k < j; k++) {
+        s -= L[i * n + k] * conj(L[j * n + k]);
+      }
+      L[i * n + j] = (i == j) ? sqrt(creal(s)) : s / L[j * n + j];
+    }
+  }
+
+  // L y = b, then L^H x = y
+  for (uint32_t i = 0; i < n; i++) {
+    double complex s = b[i];
+    for (uint32_t k = 0; k < i; k++) {
+      s -= L[i * n + k] * y[k];
+    }
+    y[i] = s / L[i * n + i];
+  }
+  for (int i = (int)n - 1; i >= 0; i--) {
+    double complex s = y[i];
+    for (uint32_t k = i + 1; k < n; k++) {
+      s -= conj(L[k * n + i]) * x[k];
+    }
+    x[i] = s / L[i * n + i];
+  }
+}
+
+/* Correlation E[h(k + d) h(k)^*] of two subcarriers d apart for an exponential power delay profile */
+static double complex freq_corr(float delay_spread_ns, int d)
+{
+  return 1.0 / (1.0 + I * 2.0 * M_PI * delay_spread_ns * 1e-9 * WIENER_SL_SC_SPACING_HZ * d);
+}
+
+static void wiener_sl_freq_coeffs(srsran_wiener_sl_t* q, uint32_t w, uint32_t snr_bin, cf_t* coeffs)
+{
+  double complex A[SRSRAN_WIENER_SL_NOF_TAPS * SRSRAN_WIENER_SL_NOF_TAPS];
+  double complex p[SRSRAN_WIENER_SL_NOF_TAPS];
+  double complex x[SRSRAN_WIENER_SL_NOF_TAPS];
+
+  for (uint32_t t = 0; t < w; t++) {
+    for (uint32_t s = 0; s < w; s++) {
+      A[t * w + s] = freq_corr(q->delay_spread_ns, (int)t - (int)s) + ((t == s) ? 1.0 / snr_bin_lin(snr_bin) : 0.0);
+    }
+  }
+
+  // The estimate of subcarrier row is sum_t c[t] y[t] with c^T = p^T A^-1, p[t] = E[h(row) y(t)^*]
+  for (uint32_t row = 0; row < w; row++) {
+    for (uint32_t t = 0; t < w; t++) {
+      p[t] = conj(freq_corr(q->delay_spread_ns, (int)row - (int)t));
+    }
+    wiener_sl_solve(A, p, x, w);
+    for (uint32_t t = 0; t < w; t++) {
+      coeffs[row * w + t] = (cf_t)conj(x[t]);
+    }
+  }
+}
+
+int srsran_wiener_sl_init(srsran_wiener_sl_t* q, float delay_spread_ns)
+{
+  if (q == NULL || delay_spread_ns < 0.0f) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  bzero(q, sizeof(srsran_wiener_sl_t));
+  q->delay_spread_ns = delay_spread_ns;
+
+  for (uint32_t w = 1; w <= SRSRAN_WIENER_SL_NOF_TAPS; w++) {
+    q->freq[w - 1] = srsran_vec_cf_malloc(SRSRAN_WIENER_SL_NOF_SNR_BINS * w * w);
+    if (q->freq[w - 1] == NULL) {
+      ERROR("Error allocating memory\n");
+      srsran_wiener_sl_free(q);
+      return SRSRAN_ERROR;
+    }
+    for (uint32_t snr_bin = 0; snr_bin < SRSRAN_WIENER_SL_NOF_SNR_BINS; snr_bin++) {
+      wiener_sl_freq_coeffs(q, w, snr_bin, &q->freq[w - 1][snr_bin * w * w]);
+    }
+  }
+
+  uint32_t w    = SRSRAN_WIENER_SL_NOF_TAPS;
+  uint32_t half = w / 2;
+  for (uint32_t snr_bin = 0; snr_bin < SRSRAN_WIENER_SL_NOF_SNR_BINS; snr_bin++) {
+    const cf_t* c = &q->freq[w - 1][(snr_bin * w + half) * w];
+    q->freq_noise_gain[snr_bin] = srsran_vec_avg_power_cf(c, w) * w;
+  }
+
+  for (uint32_t d = 0; d < SRSRAN_WIENER_SL_NOF_DOPPLER_BINS; d++) {
+    q->doppler_hz[d] = doppler_bins_hz[d];
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int srsran_wiener_sl_set_symbols(srsran_wiener_sl_t* q, uint32_t nof_symbols, const uint32_t* dmrs_l, uint32_t nof_dmrs)
+{
+  if (q == NULL || dmrs_l == NULL || nof_symbols > SRSRAN_WIENER_SL_MAX_SYMB || nof_dmrs < 2 ||
+      nof_dmrs > SRSRAN_WIENER_SL_MAX_DMRS_SYMB) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  q->nof_symbols = nof_symbols;
+  q->nof_dmrs    = nof_dmrs;
+  for (uint32_t n = 0; n < nof_dmrs; n++) {
+    q->dmrs_l[n] = dmrs_l[n];
+  }
+
+  // Symbols are 1 ms / nof_symbols long including the cyclic prefix
+  double symbol_s = 1e-3 / nof_symbols;
+  double dmrs_gap = (double)(dmrs_l[nof_dmrs - 1] - dmrs_l[0]) / (nof_dmrs - 1);
+
+  for (uint32_t d = 0; d < SRSRAN_WIENER_SL_NOF_DOPPLER_BINS; d++) {
+    double wd       = 2.0 * M_PI * q->doppler_hz[d] * symbol_s;
+    q->dmrs_corr[d] = (float)j0(wd * dmrs_gap);
+
+    for (uint32_t snr_bin = 0; snr_bin < SRSRAN_WIENER_SL_NOF_SNR_BINS; snr_bin++) {
+      // Noise left by the frequency filter on every DMRS estimate
+      double         noise = q->freq_noise_gain[snr_bin] / snr_bin_lin(snr_bin);
+      double complex A[SRSRAN_WIENER_SL_MAX_DMRS_SYMB * SRSRAN_WIENER_SL_MAX_DMRS_SYMB];
+      double complex p[SRSRAN_WIENER_SL_MAX_DMRS_SYMB];
+      double complex x[SRSRAN_WIENER_SL_MAX_DMRS_SYMB];
+
+      for (uint32_t n = 0; n < nof_dmrs; n++) {
+        for (uint32_t m = 0; m < nof_dmrs; m++) {
+          A[n * nof_dmrs + m] = j0(wd * ((double)dmrs_l[n] - dmrs_l[m])) + ((n == m) ? noise : 0.0);
+        }
+      }
+      for (uint32_t l = 0; l < nof_symbols; l++) {
+        for (uint32_t n = 0; n < nof_dmrs; n++) {
+          p[n] = j0(wd * ((double)l - dmrs_l[n]));
+        }
+        wiener_sl_solve(A, p, x, nof_dmrs);
+        for (uint32_t n = 0; n < nof_dmrs; n++) {
+          q->time[d][snr_bin][l][n] = (float)creal(x[n]);
+        }
+      }
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+uint32_t srsran_wiener_sl_snr_bin(float snr_db)
+{
+  if (isnan(snr_db)) {
+    return 0;
+  }
+  float bin = roundf((snr_db - SRSRAN_WIENER_SL_SNR_MIN_DB) / SRSRAN_WIENER_SL_SNR_STEP_DB);
+  return (uint32_t)SRSRAN_MIN(SRSRAN_MAX(bin, 0.0f), SRSRAN_WIENER_SL_NOF_SNR_BINS - 1);
+}
+
+uint32_t srsran_wiener_sl_doppler_bin(srsran_wiener_sl_t* q, float corr)
+{
+  uint32_t best = 0;
+  for (uint32_t d = 1; d < SRSRAN_WIENER_SL_NOF_DOPPLER_BINS; d++) {
+    if (fabsf(q->dmrs_corr[d] - corr) < fabsf(q->dmrs_corr[best] - corr)) {
+      best = d;
+    }
+  }
+  return best;
+}
+
+/* Short dot product of an edge row, without the call and reduction overhead of the vector kernels */
+static inline cf_t wiener_sl_dot(const cf_t* c, const cf_t* x, uint32_t w)
+{
+  float re = 0.0f, im = 0.0f;
+  for (uint32_t t = 0; t < w; t++) {
+    re += __real__ c[t] * __real__ x[t] - __imag__ c[t] * __imag__ x[t];
+    im += __real__ c[t] * __imag__ x[t] + __imag__ c[t] * __real__ x[t];
+  }
+  return re + _Complex_I * im;
+}
+
+void srsran_wiener_sl_filter_freq(srsran_wiener_sl_t* q, uint32_t snr_bin, const cf_t* ls, cf_t* h, uint32_t len)
+{
+  if (len == 0) {
+    return;
+  }
+  uint32_t    w      = SRSRAN_MIN(len, SRSRAN_WIENER_SL_NOF_TAPS);
+  uint32_t    half   = w / 2;
+  const cf_t* coeffs = &q->freq[w - 1][SRSRAN_MIN(snr_bin, SRSRAN_WIENER_SL_NOF_SNR_BINS - 1) * w * w];
+
+  // Lower edge, the window stays at the start of the band
+  for (uint32_t i = 0; i < half; i++) {
+    h[i] = wiener_sl_dot(&coeffs[i * w], ls, w);
+  }
+
+  // Centre, the window slides with the estimated subcarrier
+  const cf_t* c   = &coeffs[half * w];
+  uint32_t    end = len - w + half;
+  uint32_t    i   = half;
+#if SRSRAN_SIMD_CF_SIZE
+  simd_cf_t _c[SRSRAN_WIENER_SL_NOF_TAPS];
+  for (uint32_t t = 0; t < w; t++) {
+    _c[t] = srsran_simd_cf_set1(c[t]);
+  }
+  for (; i + SRSRAN_SIMD_CF_SIZE <= end + 1; i += SRSRAN_SIMD_CF_SIZE) {
+    simd_cf_t acc = srsran_simd_cf_zero();
+    for (uint32_t t = 0; t < w; t++) {
+      acc = srsran_simd_cf_add(acc, srsran_simd_cf_prod(srsran_simd_cfi_loadu(&ls[i - half + t]), _c[t]));
+    }
+    srsran_simd_cfi_storeu(&h[i], acc);
+  }
+#endif
+  for (; i <= end; i++) {
+    h[i] = wiener_sl_dot(c, &ls[i - half], w);
+  }
+
+  // Upper edge, the window stays at the end of the band
+  for (i = end + 1; i < len; i++) {
+    h[i] = wiener_sl_dot(&coeffs[(i - (len - w)) * w], &ls[len - w], w);
+  }
+}
+
+void srsran_wiener_sl_free(srsran_wiener_sl_t* q)
+{
+  if (q == NULL) {
+    return;
+  }
+  for (uint32_t w = 0; w < SRSRAN_WIENER_SL_NOF_TAPS; w++) {
+    if (q->freq[w]) {
+      free(q->freq[w]);
+    }
+  }
+  bzero(q, sizeof(srsran_wiener_sl_t));
+}
@@ -335,6 +335,22 @@ void srsran_channel_fading_free(srsran_channel_fading_t* q)
   }
 }
 
+uint32_t srsran_channel_fading_get_profile(srsran_channel_fading_model_t model,
+                                           float*                        delay_ns,
+                                           float*                        power_db)
+{
+  if (model > srsran_channel_fading_model_etu) {
+    return 0;
+  }
+
+  for (uint32_t i = 0; i < nof_taps[model]; i++) {
+    delay_ns[i] = excess_tap_delay_ns[model][i];
+    power_db[i] = relative_power_db[model][i];
+  }
+
+  return nof_taps[model];
+}
+
 double srsran_channel_fading_execute(srsran_channel_fading_t* q,
                                      const cf_t*              in,
                                      cf_t*                    out,
@@ -0,0 +1,493 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/phy/channel/multilink.h"
+#include "srsran/phy/utils/random.h"
+#include "srsran/phy/utils/simd.h"
+#include "srsran/phy/utils/vector.h"
+#include <complex.h>
+#include <math.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MULTILINK_TAP_IDX(l, t) ((l)*SRSRAN_CHANNEL_FADING_MAXTAPS + (t))
+#define MULTILINK_TERM_IDX(q, n, l, t) ((n) * (q)->nof_links * SRSRAN_CHANNEL_FADING_MAXTAPS + MULTILINK_TAP_IDX(l, t))
+
+typedef struct {
+  /* Thread identifier: they must set before thread creation */
+  pthread_t                   pthread;
+  srsran_channel_multilink_t* q;
+  uint32_t                    link_begin;
+  uint32_t                    link_end;
+
+  /* Data pointers: they must be set before posting start semaphore */
+  cf_t*    out;
+  uint32_t nsamples;
+
+  /* Semaphores */
+  sem_t start;
+  sem_t finish;
+
+  /* Thread flags */
+  bool started;
+  bool quit;
+} multilink_worker_t;
+
+/*
+ * y[n] += sum_t h[t] * x[n - delay[t]] for n = 0 ... len - 1. Complex samples stay interleaved: every tap is applied
+ * as x * re(h) and swap(x) * im(h), combined with a single add-subtract at the end.
+ */
+static void
+multilink_filter(const cf_t* x, const uint32_t* delay, const cf_t* h, uint32_t nof_taps, cf_t* y, uint32_t len)
+{
+  const float* xf = (const float*)x;
+  float*       yf = (float*)y;
+  uint32_t     i  = 0;
+
+#if SRSRAN_SIMD_F_SIZE
+  simd_f_t h_re[SRSRAN_CHANNEL_FADING_MAXTAPS];
+  simd_f_t h_im[SRSRAN_CHANNEL_FADING_MAXTAPS];
+  for (uint32_t t = 0; t < nof_taps; t++) {
+    h_re[t] = srsran_simd_f_set1(__real__ h[t]);
+    h_im[t] = srsran_simd_f_set1(__imag__ h[t]);
+  }
+
+  for (; i + SRSRAN_SIMD_F_SIZE <= 2 * len; i += SRSRAN_SIMD_F_SIZE) {
+    simd_f_t acc_re = srsran_simd_f_zero();
+    simd_f_t acc_im = srsran_simd_f_zero();
+    for (uint32_t t = 0; t < nof_taps; t++) {
+      simd_f_t v = srsran_simd_f_loadu(xf + i - 2 * delay[t]);
+      acc_re     = srsran_simd_f_add(acc_re, srsran_simd_f_mul(v, h_re[t]));
+      acc_im     = srsran_simd_f_add(acc_im, srsran_simd_f_mul(srsran_simd_f_swap(v), h_im[t]));
+    }
+    simd_f_t r = srsran_simd_f_add(srsran_simd_f_loadu(&yf[i]), srsran_simd_f_addsub(acc_re, acc_im));
+    srsran_simd_f_storeu(&yf[i], r);
+  }
+#endif /* SRSRAN_SIMD_F_SIZE */
+
+  for (uint32_t n = i / 2; n < len; n++) {
+    cf_t acc = 0;
+    for (uint32_t t = 0; t < nof_taps; t++) {
+      acc += h[t] * *(x + n - delay[t]);
+    }
+    y[n] += acc;
+  }
+}
+
+/* Current tap of a link from its Doppler terms */
+static cf_t multilink_tap(srsran_channel_multilink_t* q, uint32_t l, uint32_t t)
+{
+  const float recN = 1.0f / sqrtf(SRSRAN_CHANNEL_MULTILINK_NTERMS);
+  float       re   = 0.0f;
+  float       im   = 0.0f;
+  for (uint32_t n = 0; n < SRSRAN_CHANNEL_MULTILINK_NTERMS; n++) {
+    re += q->a_re[MULTILINK_TERM_IDX(q, n, l, t)];
+    im += q->b_im[MULTILINK_TERM_IDX(q, n, l, t)];
+  }
+  return q->tap_gain[MULTILINK_TAP_IDX(l, t)] * recN * (re + _Complex_I * im);
+}
+
+#if SRSRAN_SIMD_F_SIZE
+/* Rotates one vector of phasors (re, im) in place */
+static inline void multilink_rotate_simd(float* re, float* im, simd_f_t r_re, simd_f_t r_im)
+{
+  simd_f_t x_re = srsran_simd_f_loadu(re);
+  simd_f_t x_im = srsran_simd_f_loadu(im);
+  srsran_simd_f_storeu(re, srsran_simd_f_sub(srsran_simd_f_mul(x_re, r_re), srsran_simd_f_mul(x_im, r_im)));
+  srsran_simd_f_storeu(im, srsran_simd_f_add(srsran_simd_f_mul(x_re, r_im), srsran_simd_f_mul(x_im, r_re)));
+}
+#endif /* SRSRAN_SIMD_F_SIZE */
+
+/*
+ * Writes the taps [begin, end) of the current block and advances their Doppler terms by one block. Terms are summed
+ * vertically, every vector holding the same term of consecutive taps.
+ */
+static void multilink_update_taps(srsran_channel_multilink_t* q, uint32_t begin, uint32_t end)
+{
+  const float recN   = 1.0f / sqrtf(SRSRAN_CHANNEL_MULTILINK_NTERMS);
+  uint32_t    stride = q->nof_links * SRSRAN_CHANNEL_FADING_MAXTAPS;
+  uint32_t    i      = begin;
+
+#if SRSRAN_SIMD_F_SIZE
+  for (; i + SRSRAN_SIMD_F_SIZE <= end; i += SRSRAN_SIMD_F_SIZE) {
+    simd_f_t acc_re = srsran_simd_f_zero();
+    simd_f_t acc_im = srsran_simd_f_zero();
+    for (uint32_t n = 0, k = i; n < SRSRAN_CHANNEL_MULTILINK_NTERMS; n++, k += stride) {
+      simd_f_t r_re = srsran_simd_f_loadu(&q->rot_re[k]);
+      simd_f_t r_im = srsran_simd_f_loadu(&q->rot_im[k]);
+      acc_re        = srsran_simd_f_add(acc_re, srsran_simd_f_loadu(&q->a_re[k]));
+      acc_im        = srsran_simd_f_add(acc_im, srsran_simd_f_loadu(&q->b_im[k]));
+      multilink_rotate_simd(&q->a_re[k], &q->a_im[k], r_re, r_im);
+      multilink_rotate_simd(&q->b_re[k], &q->b_im[k], r_re, r_im);
+    }
+    simd_f_t gain = srsran_simd_f_mul(srsran_simd_f_loadu(&q->tap_gain[i]), srsran_simd_f_set1(recN));
+    srsran_simd_f_storeu(&q->h_re[i], srsran_simd_f_mul(acc_re, gain));
+    srsran_simd_f_storeu(&q->h_im[i], srsran_simd_f_mul(acc_im, gain));
+  }
+#endif /* SRSRAN_SIMD_F_SIZE */
+
+  for (; i < end; i++) {
+    float re = 0.0f;
+    float im = 0.0f;
+    for (uint32_t n = 0, k = i; n < SRSRAN_CHANNEL_MULTILINK_NTERMS; n++, k += stride) {
+      re += q->a_re[k];
+      im += q->b_im[k];
+
+      cf_t rot = q->rot_re[k] + _Complex_I * q->rot_im[k];
+      cf_t a   = (q->a_re[k] + _Complex_I * q->a_im[k]) * rot;
+      cf_t b   = (q->b_re[k] + _Complex_I * q->b_im[k]) * rot;
+      q->a_re[k] = __real__ a;
+      q->a_im[k] = __imag__ a;
+      q->b_re[k] = __real__ b;
+      q->b_im[k] = __imag__ b;
+    }
+    q->h_re[i] = re * q->tap_gain[i] * recN;
+    q->h_im[i] = im * q->tap_gain[i] * recN;
+  }
+}
+
+/* Generates the taps and filters the links [link_begin, link_end) into out */
+static void multilink_run(srsran_channel_multilink_t* q, uint32_t link_begin, uint32_t link_end, cf_t* out, uint32_t n)
+{
+  srsran_vec_cf_zero(out, n);
+
+  for (uint32_t offset = 0; offset < n; offset += q->block_len) {
+    // The taps of all links at once
+    multilink_update_taps(q, MULTILINK_TAP_IDX(link_begin, 0), MULTILINK_TAP_IDX(link_end, 0));
+
+    for (uint32_t l = link_begin; l < link_end; l++) {
+      cf_t h[SRSRAN_CHANNEL_FADING_MAXTAPS];
+      for (uint32_t t = 0; t < q->nof_taps[l]; t++) {
+        h[t] = q->h_re[MULTILINK_TAP_IDX(l, t)] + _Complex_I * q->h_im[MULTILINK_TAP_IDX(l, t)];
+      }
+      multilink_filter(&q->history[l][q->max_delay + offset],
+                       &q->tap_delay[MULTILINK_TAP_IDX(l, 0)],
+                       h,
+                       q->nof_taps[l],
+                       &out[offset],
+                       q->block_len);
+    }
+  }
+
+  // Keep the phasors on the unit circle, a first order correction is enough for the rounding error of one call
+  for (uint32_t l = link_begin; l < link_end; l++) {
+    if (q->cfg[l].model == srsran_channel_fading_model_none) {
+      continue;
+    }
+    for (uint32_t n = 0; n < SRSRAN_CHANNEL_MULTILINK_NTERMS; n++) {
+      for (uint32_t k = MULTILINK_TERM_IDX(q, n, l, 0); k < MULTILINK_TERM_IDX(q, n, l + 1, 0); k++) {
+        float a = 1.5f - 0.5f * (q->a_re[k] * q->a_re[k] + q->a_im[k] * q->a_im[k]);
+        float b = 1.5f - 0.5f * (q->b_re[k] * q->b_re[k] + q->b_im[k] * q->b_im[k]);
+        q->a_re[k] *= a;
+        q->a_im[k] *= a;
+        q->b_re[k] *= b;
+        q->b_im[k] *= b;
+      }
+    }
+  }
+}
+
+static void* multilink_worker_thread(void* arg)
+{
+  multilink_worker_t* w = (multilink_worker_t*)arg;
+
+  sem_wait(&w->start);
+  while (!w->quit) {
+    multilink_run(w->q, w->link_begin, w->link_end, w->out, w->nsamples);
+
+    /* Post finish semaphore */
+    sem_post(&w->finish);
+
+    /* Wait for next loop */
+    sem_wait(&w->start);
+  }
+  sem_post(&w->finish);
+
+  pthread_exit(NULL);
+  return w;
+}
+
+/* Largest divisor of max_nsamples not exceeding the update period required by the fastest link */
+static uint32_t multilink_block_len(srsran_channel_multilink_t* q)
+{
+  float doppler_max = 0.0f;
+  for (uint32_t l = 0; l < q->nof_links; l++) {
+    if (q->cfg[l].model != srsran_channel_fading_model_none) {
+      doppler_max = SRSRAN_MAX(doppler_max, fabsf(q->cfg[l].doppler_hz));
+    }
+  }
+
+  uint32_t target = q->max_nsamples;
+  if (doppler_max > 0.0f) {
+    target = (uint32_t)(SRSRAN_CHANNEL_MULTILINK_MAX_PHASE_STEP * q->srate / (2.0 * M_PI * doppler_max));
+  }
+
+  uint32_t block_len = 1;
+  for (uint32_t d = 1; d <= SRSRAN_MIN(target, q->max_nsamples); d++) {
+    if (q->max_nsamples % d == 0) {
+      block_len = d;
+    }
+  }
+  return block_len;
+}
+
+int srsran_channel_multilink_init(srsran_channel_multilink_t*           q,
+                                  double                                srate,
+                                  const srsran_channel_multilink_cfg_t* cfg,
+                                  uint32_t                              nof_links,
+                                  uint32_t                              max_nsamples,
+                                  uint32_t                              nof_threads,
+                                  uint32_t                              seed)
+{
+  if (q == NULL || cfg == NULL || nof_links == 0 || nof_links > SRSRAN_CHANNEL_MULTILINK_MAX_LINKS ||
+      max_nsamples == 0 || nof_threads == 0 || nof_threads > SRSRAN_CHANNEL_MULTILINK_MAX_THREADS) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  memset(q, 0, sizeof(srsran_channel_multilink_t));
+
+  q->srate        = srate;
+  q->nof_links    = nof_links;
+  q->nof_threads  = SRSRAN_MIN(nof_threads, nof_links);
+  q->max_nsamples = max_nsamples;
+  memcpy(q->cfg, cfg, sizeof(srsran_channel_multilink_cfg_t) * nof_links);
+  q->block_len = multilink_block_len(q);
+
+  uint32_t nof_taps_total  = nof_links * SRSRAN_CHANNEL_FADING_MAXTAPS;
+  uint32_t nof_terms_total = nof_taps_total * SRSRAN_CHANNEL_MULTILINK_NTERMS;
+
+  q->tap_delay = calloc(nof_taps_total, sizeof(uint32_t));
+  q->tap_gain  = srsran_vec_f_malloc(nof_taps_total);
+  q->a_re      = srsran_vec_f_malloc(nof_terms_total);
+  q->a_im      = srsran_vec_f_malloc(nof_terms_total);
+  q->b_re      = srsran_vec_f_malloc(nof_terms_total);
+  q->b_im      = srsran_vec_f_malloc(nof_terms_total);
+  q->rot_re    = srsran_vec_f_malloc(nof_terms_total);
+  q->rot_im    = srsran_vec_f_malloc(nof_terms_total);
+  q->h_re      = srsran_vec_f_malloc(nof_taps_total);
+  q->h_im      = srsran_vec_f_malloc(nof_taps_total);
+  if (!q->tap_delay || !q->tap_gain || !q->a_re || !q->a_im || !q->b_re || !q->b_im || !q->rot_re || !q->rot_im ||
+      !q->h_re || !q->h_im) {
+    fprintf(stderr, "Error: allocating multilink taps\n");
+    goto clean_exit;
+  }
+  srsran_vec_f_zero(q->tap_gain, nof_taps_total);
+  srsran_vec_f_zero(q->a_re, nof_terms_total);
+  srsran_vec_f_zero(q->a_im, nof_terms_total);
+  srsran_vec_f_zero(q->b_re, nof_terms_total);
+  srsran_vec_f_zero(q->b_im, nof_terms_total);
+  srsran_vec_f_zero(q->h_re, nof_taps_total);
+  srsran_vec_f_zero(q->h_im, nof_taps_total);
+  for (uint32_t i = 0; i < nof_terms_total; i++) {
+    q->rot_re[i] = 1.0f;
+    q->rot_im[i] = 0.0f;
+  }
+
+  srsran_random_t random = srsran_random_init(seed);
+
+  for (uint32_t l = 0; l < nof_links; l++) {
+    float delay_ns[SRSRAN_CHANNEL_FADING_MAXTAPS] = {};
+    float power_db[SRSRAN_CHANNEL_FADING_MAXTAPS] = {};
+    q->nof_taps[l] = srsran_channel_fading_get_profile(cfg[l].model, delay_ns, power_db);
+    if (q->nof_taps[l] == 0) {
+      fprintf(stderr, "Error: invalid channel model for link %d\n", l);
+      srsran_random_free(random);
+      goto clean_exit;
+    }
+
+    // Taps are normalised to unit power before the path loss
+    float total_power = 0.0f;
+    for (uint32_t t = 0; t < q->nof_taps[l]; t++) {
+      total_power += srsran_convert_dB_to_power(power_db[t]);
+    }
+
+    for (uint32_t t = 0; t < q->nof_taps[l]; t++) {
+      uint32_t idx      = MULTILINK_TAP_IDX(l, t);
+      float    delay_s  = (cfg[l].delay_us * 1e-6f) + (delay_ns[t] * 1e-9f);
+      q->tap_delay[idx] = (uint32_t)roundf(delay_s * (float)srate);
+      q->tap_gain[idx]  = sqrtf(srsran_convert_dB_to_power(power_db[t]) / total_power) *
+                         srsran_convert_dB_to_amplitude(-cfg[l].path_loss_db);
+      q->max_delay = SRSRAN_MAX(q->max_delay, q->tap_delay[idx]);
+
+      if (cfg[l].model == srsran_channel_fading_model_none) {
+        // A single static term with unit power, rotating by exactly one
+        q->a_re[MULTILINK_TERM_IDX(q, 0, l, t)] = sqrtf(SRSRAN_CHANNEL_MULTILINK_NTERMS);
+        continue;
+      }
+
+      // Sum-of-sinusoids with random angles of arrival and phases
+      float theta = srsran_random_uniform_real_dist(random, -(float)M_PI, (float)M_PI);
+      for (uint32_t n = 0; n < SRSRAN_CHANNEL_MULTILINK_NTERMS; n++) {
+        uint32_t k     = MULTILINK_TERM_IDX(q, n, l, t);
+        float    alpha = (2.0f * (float)M_PI * (n + 1) - (float)M_PI + theta) /
+                      (4.0f * SRSRAN_CHANNEL_MULTILINK_NTERMS);
+        float    omega = 2.0f * (float)M_PI * cfg[l].doppler_hz * cosf(alpha) / (float)srate;
+        float    a     = srsran_random_uniform_real_dist(random, 0, 2.0f * (float)M_PI);
+        float    b     = srsran_random_uniform_real_dist(random, 0, 2.0f * (float)M_PI);
+        q->a_re[k]     = cosf(a);
+        q->a_im[k]     = sinf(a);
+        q->b_re[k]     = cosf(b);
+        q->b_im[k]     = sinf(b);
+        q->rot_re[k]   = cosf(omega * q->block_len);
+        q->rot_im[k]   = sinf(omega * q->block_len);
+      }
+    }
+  }
+
+  srsran_random_free(random);
+
+  for (uint32_t l = 0; l < nof_links; l++) {
+    q->history[l] = srsran_vec_cf_malloc(q->max_delay + max_nsamples);
+    if (!q->history[l]) {
+      fprintf(stderr, "Error: allocating multilink history\n");
+      goto clean_exit;
+    }
+    srsran_vec_cf_zero(q->history[l], q->max_delay + max_nsamples);
+  }
+
+  // The calling thread processes the first share of links, coworkers the rest
+  multilink_worker_t* workers = calloc(q->nof_threads, sizeof(multilink_worker_t));
+  if (!workers) {
+    fprintf(stderr, "Error: allocating multilink workers\n");
+    goto clean_exit;
+  }
+  q->workers = workers;
+
+  for (uint32_t i = 0; i < q->nof_threads; i++) {
+    workers[i].q          = q;
+    workers[i].link_begin = (nof_links * i) / q->nof_threads;
+    workers[i].link_end   = (nof_links * (i + 1)) / q->nof_threads;
+    if (i == 0) {
+      continue;
+    }
+
+    q->partial[i] = srsran_vec_cf_malloc(max_nsamples);
+    if (!q->partial[i]) {
+      fprintf(stderr, "Error: allocating multilink partial output\n");
+      goto clean_exit;
+    }
+
+    if (sem_init(&workers[i].start, 0, 0) || sem_init(&workers[i].finish, 0, 0)) {
+      fprintf(stderr, "Error: creating semaphore\n");
+      goto clean_exit;
+    }
+    if (pthread_create(&workers[i].pthread, NULL, multilink_worker_thread, &workers[i])) {
+      fprintf(stderr, "Error: creating multilink thread\n");
+      goto clean_exit;
+    }
+    workers[i].started = true;
+  }
+
+  return SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_channel_multilink_free(q);
+  return SRSRAN_ERROR;
+}
+
+void srsran_channel_multilink_free(srsran_channel_multilink_t* q)
+{
+  if (q == NULL) {
+    return;
+  }
+
+  multilink_worker_t* workers = (multilink_worker_t*)q->workers;
+  if (workers) {
+    for (uint32_t i = 1; i < q->nof_threads; i++) {
+      if (workers[i].started) {
+        workers[i].quit = true;
+        sem_post(&workers[i].start);
+        pthread_join(workers[i].pthread, NULL);
+        sem_destroy(&workers[i].start);
+        sem_destroy(&workers[i].finish);
+      }
+    }
+    free(workers);
+  }
+
+  for (uint32_t i = 0; i < SRSRAN_CHANNEL_MULTILINK_MAX_THREADS; i++) {
+    if (q->partial[i]) {
+      free(q->partial[i]);
+    }
+  }
+  for (uint32_t l = 0; l < SRSRAN_CHANNEL_MULTILINK_MAX_LINKS; l++) {
+    if (q->history[l]) {
+      free(q->history[l]);
+    }
+  }
+  if (q->tap_delay) {
+    free(q->tap_delay);
+  }
+  float* arrays[] = {q->tap_gain, q->a_re, q->a_im, q->b_re, q->b_im, q->rot_re, q->rot_im, q->h_re, q->h_im};
+  for (uint32_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++) {
+    if (arrays[i]) {
+      free(arrays[i]);
+    }
+  }
+
+  memset(q, 0, sizeof(srsran_channel_multilink_t));
+}
+
+int srsran_channel_multilink_execute(srsran_channel_multilink_t* q, const cf_t** in, cf_t* out, uint32_t nsamples)
+{
+  if (q == NULL || in == NULL || out == NULL || nsamples > q->max_nsamples || nsamples % q->block_len != 0) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  for (uint32_t l = 0; l < q->nof_links; l++) {
+    if (in[l] == NULL) {
+      return SRSRAN_ERROR_INVALID_INPUTS;
+    }
+    srsran_vec_cf_copy(&q->history[l][q->max_delay], in[l], nsamples);
+  }
+
+  multilink_worker_t* workers = (multilink_worker_t*)q->workers;
+  for (uint32_t i = 1; i < q->nof_threads; i++) {
+    workers[i].out      = q->partial[i];
+    workers[i].nsamples = nsamples;
+    sem_post(&workers[i].start);
+  }
+
+  multilink_run(q, workers[0].link_begin, workers[0].link_end, out, nsamples);
+
+  for (uint32_t i = 1; i < q->nof_threads; i++) {
+    sem_wait(&workers[i].finish);
+    srsran_vec_sum_ccc(out, q->partial[i], out, nsamples);
+  }
+
+  for (uint32_t l = 0; l < q->nof_links; l++) {
+    memmove(q->history[l], &q->history[l][nsamples], sizeof(cf_t) * q->max_delay);
+  }
+  q->nof_blocks += nsamples / q->block_len;
+
+  return SRSRAN_SUCCESS;
+}
+
+cf_t srsran_channel_multilink_get_tap(srsran_channel_multilink_t* q, uint32_t link, uint32_t tap)
+{
+  if (q == NULL || link >= q->nof_links || tap >= q->nof_taps[link]) {
+    return 0;
+  }
+  return multilink_tap(q, link, tap);
+}
@@ -0,0 +1,352 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/phy/channel/multilink.h"
+#include "srsran/phy/io/filesink.h"
+#include "srsran/phy/io/filesource.h"
+#include "srsran/phy/utils/random.h"
+#include "srsran/phy/utils/vector.h"
+#include <complex.h>
+#include <math.h>
+#include <srsran/phy/utils/debug.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return SRSRAN_ERROR;                                                                                             \
+    }                                                                                                                  \
+  } while (false)
+
+static uint32_t nof_links   = 32;
+static uint32_t duration_ms = 100;
+static uint32_t nof_threads = 2;
+static uint32_t srate       = (uint32_t)15.36e6;
+static float    doppler_hz  = 1400.0f; // 250 km/h relative speed at 5.9 GHz
+static uint32_t random_seed = 0x12345678;
+static char*    input_file  = NULL;
+static char*    output_file = NULL;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [dilorstT]\n", prog);
+  printf("\t-l Number of links: [Default %d]\n", nof_links);
+  printf("\t-t Simulation time in ms: [Default %d]\n", duration_ms);
+  printf("\t-T Number of threads: [Default %d]\n", nof_threads);
+  printf("\t-s Sampling rate in Hz: [Default %d]\n", srate);
+  printf("\t-d Maximum doppler in Hz: [Default %.0f]\n", doppler_hz);
+  printf("\t-r Random generator seed: [Default %d]\n", random_seed);
+  printf("\t-i Replay this file as the transmission of every link\n");
+  printf("\t-o Write the received sum of all links to this file\n");
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "dilorstT")) != -1) {
+    switch (opt) {
+      case 'd':
+        doppler_hz = strtof(argv[optind], NULL);
+        break;
+      case 'i':
+        input_file = argv[optind];
+        break;
+      case 'l':
+        nof_links = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'o':
+        output_file = argv[optind];
+        break;
+      case 'r':
+        random_seed = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        srate = (uint32_t)strtof(argv[optind], NULL);
+        break;
+      case 't':
+        duration_ms = (uint32_t)strtof(argv[optind], NULL);
+        break;
+      case 'T':
+        nof_threads = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+/* Vehicles at random distances: EVA profile, delay up to 2 us and path loss up to 30 dB */
+static void random_links(srsran_channel_multilink_cfg_t* cfg, uint32_t n, srsran_random_t random)
+{
+  for (uint32_t l = 0; l < n; l++) {
+    cfg[l].model        = srsran_channel_fading_model_eva;
+    cfg[l].doppler_hz   = srsran_random_uniform_real_dist(random, 0.5f, 1.0f) * doppler_hz;
+    cfg[l].delay_us     = srsran_random_uniform_real_dist(random, 0.0f, 2.0f);
+    cfg[l].path_loss_db = srsran_random_uniform_real_dist(random, 0.0f, 30.0f);
+  }
+}
+
+/* Non-fading link: the output must be the input attenuated and delayed */
+static int test_static_link(void)
+{
+  uint32_t                       sf_len = srate / 1000;
+  srsran_channel_multilink_t     ch     = {};
+  srsran_channel_multilink_cfg_t cfg    = {srsran_channel_fading_model_none, 0.0f, 10.0f, 6.0f};
+  TESTASSERT(srsran_channel_multilink_init(&ch, srate, &cfg, 1, sf_len, 1, random_seed) == SRSRAN_SUCCESS);
+
+  cf_t* in  = srsran_vec_cf_malloc(2 * sf_len);
+  cf_t* out = srsran_vec_cf_malloc(2 * sf_len);
+  TESTASSERT(in && out);
+  for (uint32_t i = 0; i < 2 * sf_len; i++) {
+    in[i] = cexpf(_Complex_I * 0.01f * i * i);
+  }
+  for (uint32_t sf = 0; sf < 2; sf++) {
+    const cf_t* ptr = &in[sf * sf_len];
+    TESTASSERT(srsran_channel_multilink_execute(&ch, &ptr, &out[sf * sf_len], sf_len) == SRSRAN_SUCCESS);
+  }
+
+  uint32_t delay = (uint32_t)roundf(10e-6f * srate);
+  float    gain  = srsran_convert_dB_to_amplitude(-6.0f);
+  float    err   = 0.0f;
+  for (uint32_t i = delay; i < 2 * sf_len; i++) {
+    err = SRSRAN_MAX(err, cabsf(out[i] - gain * in[i - delay]));
+  }
+  printf("Static link: delay %d samples, max error %.2e\n", delay, err);
+  TESTASSERT(err < 1e-5f);
+
+  free(in);
+  free(out);
+  srsran_channel_multilink_free(&ch);
+  return SRSRAN_SUCCESS;
+}
+
+/* Fading statistics: unit average power and Jakes time correlation J0(2 pi fd tau) */
+static int test_fading_statistics(void)
+{
+  uint32_t                       n_links = 32;
+  uint32_t                       nof_obs = 4000;
+  srsran_channel_multilink_cfg_t cfg[32] = {};
+  for (uint32_t l = 0; l < n_links; l++) {
+    cfg[l] = (srsran_channel_multilink_cfg_t){srsran_channel_fading_model_epa, doppler_hz, 0.0f, 0.0f};
+  }
+
+  srsran_channel_multilink_t ch = {};
+  TESTASSERT(srsran_channel_multilink_init(&ch, srate, cfg, n_links, srate / 1000, 1, random_seed) ==
+             SRSRAN_SUCCESS);
+
+  // Observe the first tap once per block, the input does not matter
+  uint32_t    block = ch.block_len;
+  cf_t*       zero  = srsran_vec_cf_malloc(block);
+  cf_t*       out   = srsran_vec_cf_malloc(block);
+  cf_t*       h     = srsran_vec_cf_malloc(n_links * nof_obs);
+  const cf_t* in[32];
+  TESTASSERT(zero && out && h);
+  srsran_vec_cf_zero(zero, block);
+  for (uint32_t l = 0; l < n_links; l++) {
+    in[l] = zero;
+  }
+  for (uint32_t n = 0; n < nof_obs; n++) {
+    for (uint32_t l = 0; l < n_links; l++) {
+      h[l * nof_obs + n] = srsran_channel_multilink_get_tap(&ch, l, 0);
+    }
+    TESTASSERT(srsran_channel_multilink_execute(&ch, in, out, block) == SRSRAN_SUCCESS);
+  }
+
+  // Lags where J0 is 0.5 and 0 respectively
+  float    tau_s[2] = {1.5211f / (2.0f * (float)M_PI * doppler_hz), 2.4048f / (2.0f * (float)M_PI * doppler_hz)};
+  float    tap_pow  = srsran_vec_avg_power_cf(h, n_links * nof_obs) / (ch.tap_gain[0] * ch.tap_gain[0]);
+  uint32_t lag[2];
+  float    corr[2] = {};
+  for (uint32_t k = 0; k < 2; k++) {
+    lag[k] = (uint32_t)roundf(tau_s[k] * srate / block);
+
+    cf_t acc = 0;
+    for (uint32_t l = 0; l < n_links; l++) {
+      acc += srsran_vec_dot_prod_conj_ccc(&h[l * nof_obs + lag[k]], &h[l * nof_obs], nof_obs - lag[k]);
+    }
+    corr[k] = crealf(acc) / (n_links * (nof_obs - lag[k])) / (ch.tap_gain[0] * ch.tap_gain[0] * tap_pow);
+  }
+
+  printf("Fading: update every %d samples, tap power %.2f, correlation %.2f at J0=0.5 and %.2f at J0=0\n",
+         block,
+         tap_pow,
+         corr[0],
+         corr[1]);
+  TESTASSERT(fabsf(srsran_convert_power_to_dB(tap_pow)) < 1.0f);
+  TESTASSERT(fabsf(corr[0] - j0f(2.0f * (float)M_PI * doppler_hz * lag[0] * block / srate)) < 0.15f);
+  TESTASSERT(fabsf(corr[1] - j0f(2.0f * (float)M_PI * doppler_hz * lag[1] * block / srate)) < 0.15f);
+
+  free(zero);
+  free(out);
+  free(h);
+  srsran_channel_multilink_free(&ch);
+  return SRSRAN_SUCCESS;
+}
+
+/* Runs nof_links random links on the given number of threads and returns the elapsed time in us */
+static int run_links(uint32_t threads, cf_t** in, cf_t* out, uint32_t nof_sf, uint64_t* usec, uint32_t* block)
+{
+  uint32_t                       sf_len = srate / 1000;
+  srsran_channel_multilink_cfg_t cfg[SRSRAN_CHANNEL_MULTILINK_MAX_LINKS];
+  srsran_random_t                random = srsran_random_init(random_seed);
+  random_links(cfg, nof_links, random);
+  srsran_random_free(random);
+
+  srsran_channel_multilink_t ch = {};
+  TESTASSERT(srsran_channel_multilink_init(&ch, srate, cfg, nof_links, sf_len, threads, random_seed) ==
+             SRSRAN_SUCCESS);
+  *block = ch.block_len;
+
+  struct timeval t[3] = {};
+  gettimeofday(&t[1], NULL);
+  for (uint32_t sf = 0; sf < nof_sf; sf++) {
+    const cf_t* ptr[SRSRAN_CHANNEL_MULTILINK_MAX_LINKS];
+    for (uint32_t l = 0; l < nof_links; l++) {
+      ptr[l] = &in[l][sf * sf_len];
+    }
+    TESTASSERT(srsran_channel_multilink_execute(&ch, ptr, &out[sf * sf_len], sf_len) == SRSRAN_SUCCESS);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  *usec = t[0].tv_sec * 1000000 + t[0].tv_usec;
+
+  srsran_channel_multilink_free(&ch);
+  return SRSRAN_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  int ret = SRSRAN_ERROR;
+
+  parse_args(argc, argv);
+  if (nof_links == 0 || nof_links > SRSRAN_CHANNEL_MULTILINK_MAX_LINKS || nof_threads == 0 ||
+      nof_threads > SRSRAN_CHANNEL_MULTILINK_MAX_THREADS) {
+    usage(argv[0]);
+    return SRSRAN_ERROR;
+  }
+
+  uint32_t sf_len = srate / 1000;
+  uint32_t len    = duration_ms * sf_len;
+  cf_t*    in[SRSRAN_CHANNEL_MULTILINK_MAX_LINKS] = {};
+  cf_t*    out_single                             = srsran_vec_cf_malloc(len);
+  cf_t*    out_multi                              = srsran_vec_cf_malloc(len);
+  if (!out_single || !out_multi) {
+    goto clean_exit;
+  }
+
+  if (test_static_link() || test_fading_statistics()) {
+    goto clean_exit;
+  }
+
+  // Every link transmits its own random signal, or the replayed file
+  srsran_random_t random = srsran_random_init(random_seed);
+  for (uint32_t l = 0; l < nof_links; l++) {
+    in[l] = srsran_vec_cf_malloc(len);
+    if (!in[l]) {
+      goto clean_exit;
+    }
+    if (input_file) {
+      if (l == 0) {
+        srsran_filesource_t fsrc = {};
+        if (srsran_filesource_init(&fsrc, input_file, SRSRAN_COMPLEX_FLOAT_BIN)) {
+          fprintf(stderr, "Error opening %s\n", input_file);
+          goto clean_exit;
+        }
+        srsran_vec_cf_zero(in[0], len);
+        int n = srsran_filesource_read(&fsrc, in[0], len);
+        srsran_filesource_free(&fsrc);
+        printf("Replaying %d samples of %s on every link\n", SRSRAN_MAX(n, 0), input_file);
+      } else {
+        srsran_vec_cf_copy(in[l], in[0], len);
+      }
+    } else {
+      srsran_random_uniform_complex_dist_vector(random, in[l], len, -1.0f, 1.0f);
+    }
+  }
+  srsran_random_free(random);
+
+  uint64_t usec_single = 0, usec_multi = 0;
+  uint32_t block = 0;
+  if (run_links(1, in, out_single, duration_ms, &usec_single, &block) ||
+      run_links(nof_threads, in, out_multi, duration_ms, &usec_multi, &block)) {
+    goto clean_exit;
+  }
+
+  // Threads only split the work, the result must be identical
+  float err = 0.0f;
+  for (uint32_t i = 0; i < len; i++) {
+    err = SRSRAN_MAX(err, cabsf(out_multi[i] - out_single[i]));
+  }
+  if (err > 1e-5f) {
+    printf("Thread mismatch, max error %.2e\n", err);
+    goto clean_exit;
+  }
+
+  double real_time_s = duration_ms / 1000.0;
+  for (uint32_t k = 0; k < 2; k++) {
+    uint32_t threads = k ? nof_threads : 1;
+    double   sec     = (k ? usec_multi : usec_single) / 1e6;
+    printf("%d links at %.2f MHz, %d thread(s): %.1f x real time, %.0f Mlink-samples/s, %.0f links in real time\n",
+           nof_links,
+           srate / 1e6,
+           threads,
+           real_time_s / sec,
+           nof_links * (double)len / sec / 1e6,
+           nof_links * real_time_s / sec);
+  }
+  printf("Taps updated every %d samples\n", block);
+
+  if (output_file) {
+    srsran_filesink_t fsink = {};
+    if (srsran_filesink_init(&fsink, output_file, SRSRAN_COMPLEX_FLOAT_BIN) == SRSRAN_SUCCESS) {
+      srsran_filesink_write(&fsink, out_multi, len);
+      srsran_filesink_free(&fsink);
+      printf("Received signal written to %s\n", output_file);
+    }
+  }
+
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  if (ret) {
+    printf("Error\n");
+  } else {
+    printf("Ok\n");
+  }
+
+  for (uint32_t l = 0; l < SRSRAN_CHANNEL_MULTILINK_MAX_LINKS; l++) {
+    if (in[l]) {
+      free(in[l]);
+    }
+  }
+  if (out_single) {
+    free(out_single);
+  }
+  if (out_multi) {
+    free(out_multi);
+  }
+  return ret;
+}
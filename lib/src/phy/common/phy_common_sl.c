@@ -369,6 +369,12 @@ int srsran_sl_comm_resource_pool_get_default_config(srsran_sl_comm_resource_pool
     bzero(q->sf_bitmap_tm34, SRSRAN_SL_MAX_PERIOD_LENGTH);
     memset(q->sf_bitmap_tm34, 1, q->sf_bitmap_tm34_len);
 
+    // Every subframe from DFN 0 on, no SLSS
+    q->sl_offset_ind        = 0;
+    q->start_prb_pscch_pool = 0;
+    q->nof_slss_offset      = 0;
+    srsran_sl_comm_resource_pool_update_sf_map(q);
+
     if (cell.tm == SRSRAN_SIDELINK_TM4) {
       switch (cell.nof_prb) {
         case 6:
@@ -420,7 +426,6 @@ int srsran_sl_comm_resource_pool_set_cfg(srsran_sl_comm_resource_pool_t* q,
       q->period_length = 160;
     }
 
-    // TODO: finish resource pool config
     // Use full Bandwidth
     q->prb_num   = (uint32_t)ceil(cell.nof_prb / 2.0);
     q->prb_start = 0;
@@ -448,7 +453,104 @@ int srsran_sl_comm_resource_pool_set_cfg(srsran_sl_comm_resource_pool_t* q,
     bzero(q->sf_bitmap_tm34, SRSRAN_SL_MAX_PERIOD_LENGTH);
     memset(q->sf_bitmap_tm34, 1, q->sf_bitmap_tm34_len);
 
+    // The PSCCH resources of a non adjacent pool follow each other from the first PRB
+    q->sl_offset_ind        = 0;
+    q->start_prb_pscch_pool = 0;
+    q->nof_slss_offset      = 0;
+    srsran_sl_comm_resource_pool_update_sf_map(q);
+
+    if (!srsran_sl_comm_resource_pool_is_valid(q, cell)) {
+      ERROR("Invalid sub-channel configuration for %d PRB\n", cell.nof_prb);
+      return SRSRAN_ERROR;
+    }
+
     ret = SRSRAN_SUCCESS;
   }
   return ret;
 }
+
+int srsran_sl_comm_resource_pool_update_sf_map(srsran_sl_comm_resource_pool_t* q)
+{
+  if (q == NULL || q->sf_bitmap_tm34_len == 0 || q->sf_bitmap_tm34_len > SRSRAN_SL_MAX_PERIOD_LENGTH ||
+      q->sl_offset_ind >= SRSRAN_SL_DFN_PERIOD || q->nof_slss_offset > SRSRAN_SL_MAX_NOF_SLSS_OFFSET) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  bool     slss[SRSRAN_SL_V2X_SLSS_PERIOD] = {};
+  uint32_t nof_slss                        = 0;
+  for (uint32_t i = 0; i < q->nof_slss_offset; i++) {
+    if (q->slss_offset[i] >= SRSRAN_SL_V2X_SLSS_PERIOD) {
+      return SRSRAN_ERROR_INVALID_INPUTS;
+    }
+    if (!slss[q->slss_offset[i]]) {
+      slss[q->slss_offset[i]] = true;
+      nof_slss += SRSRAN_SL_DFN_PERIOD / SRSRAN_SL_V2X_SLSS_PERIOD;
+    }
+  }
+
+  // The reserved subframes l_r = floor(r * N / N_reserved) make the remaining ones a multiple of the bitmap length
+  uint32_t nof_sf       = SRSRAN_SL_DFN_PERIOD - nof_slss;
+  uint32_t nof_reserved = nof_sf % q->sf_bitmap_tm34_len;
+
+  bzero(q->sf_map, sizeof(q->sf_map));
+  uint32_t l = 0; // Index among the subframes without SLSS
+  uint32_t r = 0; // Next reserved subframe
+  uint32_t k = 0; // Index among the subframes the bitmap applies to
+  for (uint32_t j = 0; j < SRSRAN_SL_DFN_PERIOD; j++) {
+    uint32_t sf = (q->sl_offset_ind + j) % SRSRAN_SL_DFN_PERIOD;
+    if (slss[sf % SRSRAN_SL_V2X_SLSS_PERIOD]) {
+      continue;
+    }
+    if (r < nof_reserved && l == (uint32_t)((uint64_t)r * nof_sf / nof_reserved)) {
+      r++;
+      l++;
+      continue;
+    }
+    l++;
+    if (q->sf_bitmap_tm34[k % q->sf_bitmap_tm34_len]) {
+      q->sf_map[sf / 8] |= (uint8_t)(1 << (sf % 8));
+    }
+    k++;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+bool srsran_sl_comm_resource_pool_is_valid(const srsran_sl_comm_resource_pool_t* q, srsran_cell_sl_t cell)
+{
+  if (q == NULL || q->num_sub_channel == 0 || q->num_sub_channel > SRSRAN_MAX_NUM_SUB_CHANNEL ||
+      q->size_sub_channel == 0) {
+    return false;
+  }
+  if (q->start_prb_sub_channel + q->num_sub_channel * q->size_sub_channel > cell.nof_prb) {
+    return false;
+  }
+  if (!q->adjacency_pscch_pssch &&
+      q->start_prb_pscch_pool + q->num_sub_channel * SRSRAN_PSCCH_TM34_NOF_PRB > cell.nof_prb) {
+    return false;
+  }
+  return true;
+}
+
+uint32_t srsran_sl_comm_resource_pool_get_pscch_prb(const srsran_sl_comm_resource_pool_t* q, uint32_t sub_channel_idx)
+{
+  if (q->adjacency_pscch_pssch) {
+    return q->start_prb_sub_channel + sub_channel_idx * q->size_sub_channel;
+  }
+  return q->start_prb_pscch_pool + sub_channel_idx * SRSRAN_PSCCH_TM34_NOF_PRB;
+}
+
+void srsran_sl_comm_resource_pool_get_pssch_prb(const srsran_sl_comm_resource_pool_t* q,
+                                                uint32_t                              sub_channel_idx,
+                                                uint32_t                              L_subCH,
+                                                uint32_t*                             prb_start_idx,
+                                                uint32_t*                             nof_prb)
+{
+  *prb_start_idx = q->start_prb_sub_channel + sub_channel_idx * q->size_sub_channel;
+  *nof_prb       = L_subCH * q->size_sub_channel;
+
+  // The PSCCH takes the first PRBs of the first sub-channel
+  if (q->adjacency_pscch_pssch) {
+    *prb_start_idx += SRSRAN_PSCCH_TM34_NOF_PRB;
+    *nof_prb -= SRSRAN_PSCCH_TM34_NOF_PRB;
+  }
+}
@@ -530,4 +530,54 @@ void srsran_sequence_apply_c(const int8_t* in, int8_t* out, uint32_t length, uin
     x1 = sequence_gen_LTE_pr_memless_step_x1(x1);
     x2 = sequence_gen_LTE_pr_memless_step_x2(x2);
   }
-}
\ No newline at end of file
+}
+
+/* Mirrors the bits of a byte, the sequence is generated LSB first and packed bits are MSB first */
+static inline uint8_t sequence_reverse_byte(uint8_t b)
+{
+  return (uint8_t)((((b * 0x0802LU) & 0x22110LU) | ((b * 0x8020LU) & 0x88440LU)) * 0x10101LU >> 16U);
+}
+
+void srsran_sequence_apply_packed(const uint8_t* in, uint8_t* out, uint32_t length, uint32_t seed)
+{
+  uint32_t x1 = sequence_x1_init;           // X1 initial state is fix
+  uint32_t x2 = sequence_get_x2_init(seed); // loads x2 initial state
+
+  uint32_t i        = 0;
+  uint64_t buffer   = 0; // Sequence bits not applied yet, the next one in the LSB
+  uint32_t nof_bits = 0;
+
+  // Two parallel steps give exactly 7 bytes
+  for (; i + 7 <= length / 8; i += 7) {
+    buffer = (uint64_t)((x1 ^ x2) & SEQUENCE_MASK);
+    x1     = sequence_gen_LTE_pr_memless_step_par_x1(x1);
+    x2     = sequence_gen_LTE_pr_memless_step_par_x2(x2);
+    buffer |= (uint64_t)((x1 ^ x2) & SEQUENCE_MASK) << SEQUENCE_PAR_BITS;
+    x1 = sequence_gen_LTE_pr_memless_step_par_x1(x1);
+    x2 = sequence_gen_LTE_pr_memless_step_par_x2(x2);
+
+    for (uint32_t j = 0; j < 7; j++) {
+      out[i + j] = in[i + j] ^ sequence_reverse_byte((uint8_t)(buffer >> (8U * j)));
+    }
+  }
+
+  buffer = 0;
+  for (; i < (length + 7) / 8; i++) {
+    if (nof_bits < 8) {
+      buffer |= (uint64_t)((x1 ^ x2) & SEQUENCE_MASK) << nof_bits;
+      nof_bits += SEQUENCE_PAR_BITS;
+      x1 = sequence_gen_LTE_pr_memless_step_par_x1(x1);
+      x2 = sequence_gen_LTE_pr_memless_step_par_x2(x2);
+    }
+
+    uint8_t c = sequence_reverse_byte((uint8_t)buffer);
+    if (8 * (i + 1) > length) {
+      // Only the MSBs of the last byte belong to the sequence
+      c &= (uint8_t)(0xffU << (8 * (i + 1) - length));
+    }
+    out[i] = in[i] ^ c;
+
+    buffer >>= 8U;
+    nof_bits -= 8;
+  }
+}
@@ -0,0 +1,282 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "srsran/phy/common/sl_precfg.h"
+#include "srsran/phy/utils/debug.h"
+
+#define SL_PRECFG_MAX_LINE_LEN 512
+
+static char* sl_precfg_trim(char* s)
+{
+  while (isspace((unsigned char)*s)) {
+    s++;
+  }
+  char* end = s + strlen(s);
+  while (end > s && isspace((unsigned char)end[-1])) {
+    end--;
+  }
+  *end = '\0';
+  return s;
+}
+
+static int sl_precfg_parse_uint(const char* value, uint32_t max, uint32_t* out)
+{
+  char*         end = NULL;
+  unsigned long v   = strtoul(value, &end, 10);
+  if (end == value || *sl_precfg_trim(end) != '\0' || v > max) {
+    return SRSRAN_ERROR;
+  }
+  *out = (uint32_t)v;
+  return SRSRAN_SUCCESS;
+}
+
+static int sl_precfg_parse_bitmap(const char* value, srsran_sl_comm_resource_pool_t* pool)
+{
+  uint32_t len = (uint32_t)strlen(value);
+  if (len == 0 || len > SRSRAN_SL_MAX_PERIOD_LENGTH) {
+    return SRSRAN_ERROR;
+  }
+  bzero(pool->sf_bitmap_tm34, SRSRAN_SL_MAX_PERIOD_LENGTH);
+  for (uint32_t i = 0; i < len; i++) {
+    if (value[i] != '0' && value[i] != '1') {
+      return SRSRAN_ERROR;
+    }
+    pool->sf_bitmap_tm34[i] = (uint8_t)(value[i] - '0');
+  }
+  pool->sf_bitmap_tm34_len = len;
+  return SRSRAN_SUCCESS;
+}
+
+static int sl_precfg_parse_pool_key(srsran_sl_comm_resource_pool_t* pool, const char* key, const char* value)
+{
+  uint32_t v = 0;
+  if (!strcmp(key, "sl_subframe")) {
+    return sl_precfg_parse_bitmap(value, pool);
+  }
+  if (!strcmp(key, "sl_offset_ind")) {
+    if (sl_precfg_parse_uint(value, SRSRAN_SL_DFN_PERIOD - 1, &v)) {
+      return SRSRAN_ERROR;
+    }
+    pool->sl_offset_ind = v;
+  } else if (!strcmp(key, "adjacency_pscch_pssch")) {
+    if (sl_precfg_parse_uint(value, 1, &v)) {
+      return SRSRAN_ERROR;
+    }
+    pool->adjacency_pscch_pssch = v == 1;
+  } else if (!strcmp(key, "size_subchannel")) {
+    if (sl_precfg_parse_uint(value, SRSRAN_MAX_PRB, &v)) {
+      return SRSRAN_ERROR;
+    }
+    pool->size_sub_channel = v;
+  } else if (!strcmp(key, "num_subchannel")) {
+    if (sl_precfg_parse_uint(value, SRSRAN_MAX_NUM_SUB_CHANNEL, &v)) {
+      return SRSRAN_ERROR;
+    }
+    pool->num_sub_channel = v;
+  } else if (!strcmp(key, "start_rb_subchannel")) {
+    if (sl_precfg_parse_uint(value, SRSRAN_MAX_PRB - 1, &v)) {
+      return SRSRAN_ERROR;
+    }
+    pool->start_prb_sub_channel = v;
+  } else if (!strcmp(key, "start_rb_pscch_pool")) {
+    if (sl_precfg_parse_uint(value, SRSRAN_MAX_PRB - 1, &v)) {
+      return SRSRAN_ERROR;
+    }
+    pool->start_prb_pscch_pool = v;
+  } else {
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+/* Comma separated list of SLSS subframe offsets */
+static int sl_precfg_parse_slss(char* value, uint32_t* slss_offset, uint32_t* nof_slss_offset)
+{
+  char* save_ptr   = NULL;
+  *nof_slss_offset = 0;
+  for (char* tok = strtok_r(value, ",", &save_ptr); tok != NULL; tok = strtok_r(NULL, ",", &save_ptr)) {
+    if (*nof_slss_offset == SRSRAN_SL_MAX_NOF_SLSS_OFFSET ||
+        sl_precfg_parse_uint(sl_precfg_trim(tok), SRSRAN_SL_V2X_SLSS_PERIOD - 1, &slss_offset[*nof_slss_offset])) {
+      return SRSRAN_ERROR;
+    }
+    (*nof_slss_offset)++;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int srsran_sl_v2x_precfg_freq_read_file(srsran_sl_v2x_precfg_freq_t* q, srsran_cell_sl_t cell, const char* path)
+{
+  if (q == NULL || path == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  bzero(q, sizeof(srsran_sl_v2x_precfg_freq_t));
+
+  FILE* f = fopen(path, "r");
+  if (f == NULL) {
+    perror("fopen");
+    return SRSRAN_ERROR;
+  }
+
+  int                             ret                                        = SRSRAN_ERROR;
+  srsran_sl_comm_resource_pool_t* pool                                       = NULL;
+  uint32_t                        slss_offset[SRSRAN_SL_MAX_NOF_SLSS_OFFSET] = {};
+  uint32_t                        nof_slss_offset                            = 0;
+  uint32_t                        line_idx                                   = 0;
+  char                            line[SL_PRECFG_MAX_LINE_LEN];
+
+  while (fgets(line, SL_PRECFG_MAX_LINE_LEN, f) != NULL) {
+    line_idx++;
+    char* comment = strchr(line, '#');
+    if (comment) {
+      *comment = '\0';
+    }
+    char* s = sl_precfg_trim(line);
+    if (*s == '\0') {
+      continue;
+    }
+
+    // A new pool starts from the default configuration of the cell
+    if (*s == '[') {
+      if (!strcmp(s, "[rx_pool]") && q->nof_rx_pools < SRSRAN_SL_MAX_NOF_RX_POOLS) {
+        pool = &q->rx_pools[q->nof_rx_pools++];
+      } else if (!strcmp(s, "[tx_pool]") && q->nof_tx_pools < SRSRAN_SL_MAX_NOF_TX_POOLS) {
+        pool = &q->tx_pools[q->nof_tx_pools++];
+      } else {
+        ERROR("%s:%d: unknown section %s, or too many pools\n", path, line_idx, s);
+        goto clean_exit;
+      }
+      if (srsran_sl_comm_resource_pool_get_default_config(pool, cell) != SRSRAN_SUCCESS) {
+        goto clean_exit;
+      }
+      continue;
+    }
+
+    char* eq = strchr(s, '=');
+    if (eq == NULL) {
+      ERROR("%s:%d: expected key = value\n", path, line_idx);
+      goto clean_exit;
+    }
+    *eq         = '\0';
+    char* key   = sl_precfg_trim(s);
+    char* value = sl_precfg_trim(eq + 1);
+
+    int err = SRSRAN_ERROR;
+    if (!strcmp(key, "sync_offset_ind")) {
+      err = sl_precfg_parse_slss(value, slss_offset, &nof_slss_offset);
+    } else if (pool != NULL) {
+      err = sl_precfg_parse_pool_key(pool, key, value);
+    }
+    if (err != SRSRAN_SUCCESS) {
+      ERROR("%s:%d: invalid %s\n", path, line_idx, key);
+      goto clean_exit;
+    }
+  }
+
+  // The SLSS subframes are known once the whole file is read
+  for (uint32_t i = 0; i < q->nof_rx_pools + q->nof_tx_pools; i++) {
+    pool                  = (i < q->nof_rx_pools) ? &q->rx_pools[i] : &q->tx_pools[i - q->nof_rx_pools];
+    pool->nof_slss_offset = nof_slss_offset;
+    memcpy(pool->slss_offset, slss_offset, sizeof(slss_offset));
+    if (srsran_sl_comm_resource_pool_update_sf_map(pool) != SRSRAN_SUCCESS ||
+        !srsran_sl_comm_resource_pool_is_valid(pool, cell)) {
+      ERROR("%s: %s pool %d does not fit a %d PRB cell\n",
+            path,
+            (i < q->nof_rx_pools) ? "rx" : "tx",
+            (i < q->nof_rx_pools) ? i : i - q->nof_rx_pools,
+            cell.nof_prb);
+      goto clean_exit;
+    }
+  }
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  fclose(f);
+  return ret;
+}
+
+static void sl_precfg_write_pool(FILE* f, const char* section, const srsran_sl_comm_resource_pool_t* pool)
+{
+  fprintf(f, "\n[%s]\n", section);
+  fprintf(f, "sl_offset_ind = %d\n", pool->sl_offset_ind);
+  fprintf(f, "sl_subframe = ");
+  for (uint32_t i = 0; i < pool->sf_bitmap_tm34_len; i++) {
+    fputc(pool->sf_bitmap_tm34[i] ? '1' : '0', f);
+  }
+  fprintf(f, "\n");
+  fprintf(f, "adjacency_pscch_pssch = %d\n", pool->adjacency_pscch_pssch ? 1 : 0);
+  fprintf(f, "size_subchannel = %d\n", pool->size_sub_channel);
+  fprintf(f, "num_subchannel = %d\n", pool->num_sub_channel);
+  fprintf(f, "start_rb_subchannel = %d\n", pool->start_prb_sub_channel);
+  fprintf(f, "start_rb_pscch_pool = %d\n", pool->start_prb_pscch_pool);
+}
+
+int srsran_sl_v2x_precfg_freq_write_file(const srsran_sl_v2x_precfg_freq_t* q, const char* path)
+{
+  if (q == NULL || path == NULL || q->nof_rx_pools > SRSRAN_SL_MAX_NOF_RX_POOLS ||
+      q->nof_tx_pools > SRSRAN_SL_MAX_NOF_TX_POOLS) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  FILE* f = fopen(path, "w");
+  if (f == NULL) {
+    perror("fopen");
+    return SRSRAN_ERROR;
+  }
+
+  // The SLSS subframes belong to the carrier, every pool has a copy
+  fprintf(f, "# SL-V2X-PreconfigFreqInfo-r14\n");
+  const srsran_sl_comm_resource_pool_t* first = q->nof_rx_pools ? &q->rx_pools[0] : &q->tx_pools[0];
+  if ((q->nof_rx_pools || q->nof_tx_pools) && first->nof_slss_offset > 0) {
+    fprintf(f, "sync_offset_ind = ");
+    for (uint32_t i = 0; i < first->nof_slss_offset; i++) {
+      fprintf(f, "%s%d", i ? ", " : "", first->slss_offset[i]);
+    }
+    fprintf(f, "\n");
+  }
+  for (uint32_t i = 0; i < q->nof_rx_pools; i++) {
+    sl_precfg_write_pool(f, "rx_pool", &q->rx_pools[i]);
+  }
+  for (uint32_t i = 0; i < q->nof_tx_pools; i++) {
+    sl_precfg_write_pool(f, "tx_pool", &q->tx_pools[i]);
+  }
+
+  int ret = ferror(f) ? SRSRAN_ERROR : SRSRAN_SUCCESS;
+  if (fclose(f) != 0) {
+    ret = SRSRAN_ERROR;
+  }
+  return ret;
+}
+
+bool srsran_sl_v2x_precfg_freq_sf_in_rx_pools(const srsran_sl_v2x_precfg_freq_t* q, uint32_t tti)
+{
+  for (uint32_t i = 0; i < q->nof_rx_pools; i++) {
+    if (srsran_sl_comm_resource_pool_sf_in_pool(&q->rx_pools[i], tti)) {
+      return true;
+    }
+  }
+  return false;
+}
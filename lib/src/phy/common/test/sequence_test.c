@@ -24,6 +24,14 @@
 #include <srsran/phy/utils/bit.h>
 #include <srsran/phy/utils/random.h>
 
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
 #define Nc 1600
 #define MAX_SEQ_LEN (256 * 1024)
 
@@ -39,6 +47,7 @@ static float   ones_float[Nc + MAX_SEQ_LEN + 31];
 static int16_t ones_short[Nc + MAX_SEQ_LEN + 31];
 static int8_t  ones_char[Nc + MAX_SEQ_LEN + 31];
 static uint8_t ones_packed[MAX_SEQ_LEN / 8];
+static uint8_t xor_packed[MAX_SEQ_LEN / 8];
 
 static int test_sequence(srsran_sequence_t* sequence, uint32_t seed, uint32_t length, uint32_t repetitions)
 {
@@ -48,6 +57,7 @@ static int test_sequence(srsran_sequence_t* sequence, uint32_t seed, uint32_t le
   uint64_t       interval_xor_float_us = 0;
   uint64_t       interval_xor_short_us = 0;
   uint64_t       interval_xor_char_us  = 0;
+  uint64_t       interval_xor_bit_us   = 0;
 
   gettimeofday(&t[1], NULL);
 
@@ -145,16 +155,34 @@ static int test_sequence(srsran_sequence_t* sequence, uint32_t seed, uint32_t le
     ret = SRSRAN_ERROR;
   }
 
-  printf("%08x; %8d; %8.1f; %8.1f; %8.1f; %8.1f; %8c\n",
+  // Test packed XOR, the bits past the sequence in the last byte are copied
+  gettimeofday(&t[1], NULL);
+  for (uint32_t r = 0; r < repetitions; r++) {
+    srsran_sequence_apply_packed(ones_packed, xor_packed, length, seed);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  interval_xor_bit_us = t->tv_sec * 1000000UL + t->tv_usec;
+
+  for (uint32_t i = 0; i < (length + 7) / 8; i++) {
+    if (xor_packed[i] != (uint8_t)~c_packed[i]) {
+      ERROR("Unmatched XOR packed");
+      ret = SRSRAN_ERROR;
+      break;
+    }
+  }
+
+  printf("%08x; %8d; %8.1f; %8.1f; %8.1f; %8.1f; %8.1f; %8c\n",
          seed,
          length,
          (double)(length * repetitions) / (double)interval_gen_us,
          (double)(length * repetitions) / (double)interval_xor_float_us,
          (double)(length * repetitions) / (double)interval_xor_short_us,
          (double)(length * repetitions) / (double)interval_xor_char_us,
+         (double)(length * repetitions) / (double)interval_xor_bit_us,
          ret == SRSRAN_SUCCESS ? 'y' : 'n');
 
-  return SRSRAN_SUCCESS;
+  return ret;
 }
 
 int main(int argc, char** argv)
@@ -182,10 +210,19 @@ int main(int argc, char** argv)
     return SRSRAN_ERROR;
   }
 
-  printf("%8s; %8s; %8s; %8s; %8s; %8s; %8s\n", "seed", "length", "GEN", "XOR PS", "XOR 16", "XOR 8", "Passed");
+  printf("%8s; %8s; %8s; %8s; %8s; %8s; %8s; %8s\n",
+         "seed",
+         "length",
+         "GEN",
+         "XOR PS",
+         "XOR 16",
+         "XOR 8",
+         "XOR 1",
+         "Passed");
 
   for (uint32_t length = min_length; length <= max_length; length = (length * 5) / 4) {
-    test_sequence(&sequence, (uint32_t)srsran_random_uniform_int_dist(random_gen, 1, INT32_MAX), length, repetitions);
+    uint32_t seed = (uint32_t)srsran_random_uniform_int_dist(random_gen, 1, INT32_MAX);
+    TESTASSERT(test_sequence(&sequence, seed, length, repetitions) == SRSRAN_SUCCESS);
   }
 
   // Free sequence object
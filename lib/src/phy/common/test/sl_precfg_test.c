@@ -0,0 +1,246 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "srsran/srsran.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+static char*            file_path = "sl_precfg_test.txt";
+static srsran_cell_sl_t cell      = {.nof_prb = 50, .N_sl_id = 0, .tm = SRSRAN_SIDELINK_TM4, .cp = SRSRAN_CP_NORM};
+
+static uint32_t count_sf_in_pool(const srsran_sl_comm_resource_pool_t* pool)
+{
+  uint32_t n = 0;
+  for (uint32_t tti = 0; tti < SRSRAN_SL_DFN_PERIOD; tti++) {
+    n += srsran_sl_comm_resource_pool_sf_in_pool(pool, tti);
+  }
+  return n;
+}
+
+static int write_text(const char* text)
+{
+  FILE* f = fopen(file_path, "w");
+  if (f == NULL) {
+    return SRSRAN_ERROR;
+  }
+  fputs(text, f);
+  fclose(f);
+  return SRSRAN_SUCCESS;
+}
+
+static int test_sf_map()
+{
+  srsran_sl_comm_resource_pool_t pool;
+  TESTASSERT(srsran_sl_comm_resource_pool_get_default_config(&pool, cell) == SRSRAN_SUCCESS);
+  TESTASSERT(count_sf_in_pool(&pool) == SRSRAN_SL_DFN_PERIOD);
+
+  // Two subframes out of ten, 10240 is a multiple of the bitmap length so nothing is reserved
+  bzero(pool.sf_bitmap_tm34, SRSRAN_SL_MAX_PERIOD_LENGTH);
+  pool.sf_bitmap_tm34[0] = 1;
+  pool.sf_bitmap_tm34[2] = 1;
+  TESTASSERT(srsran_sl_comm_resource_pool_update_sf_map(&pool) == SRSRAN_SUCCESS);
+  TESTASSERT(count_sf_in_pool(&pool) == 2048);
+  for (uint32_t tti = 0; tti < 2 * SRSRAN_SL_DFN_PERIOD; tti++) {
+    TESTASSERT(srsran_sl_comm_resource_pool_sf_in_pool(&pool, tti) == (tti % 10 == 0 || tti % 10 == 2));
+  }
+
+  // The offset moves the start of the bitmap
+  pool.sl_offset_ind = 5;
+  TESTASSERT(srsran_sl_comm_resource_pool_update_sf_map(&pool) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_sl_comm_resource_pool_sf_in_pool(&pool, 5));
+  TESTASSERT(srsran_sl_comm_resource_pool_sf_in_pool(&pool, 7));
+  TESTASSERT(!srsran_sl_comm_resource_pool_sf_in_pool(&pool, 10));
+
+  // Two SLSS subframes every 160 leave 10112 subframes, 12 of them reserved with a 20 subframe bitmap
+  pool.sl_offset_ind      = 0;
+  pool.sf_bitmap_tm34_len = 20;
+  memset(pool.sf_bitmap_tm34, 1, pool.sf_bitmap_tm34_len);
+  pool.nof_slss_offset = 2;
+  pool.slss_offset[0]  = 0;
+  pool.slss_offset[1]  = 80;
+  TESTASSERT(srsran_sl_comm_resource_pool_update_sf_map(&pool) == SRSRAN_SUCCESS);
+  TESTASSERT(count_sf_in_pool(&pool) == 10112 - 12);
+  for (uint32_t tti = 0; tti < SRSRAN_SL_DFN_PERIOD; tti += SRSRAN_SL_V2X_SLSS_PERIOD) {
+    TESTASSERT(!srsran_sl_comm_resource_pool_sf_in_pool(&pool, tti));
+    TESTASSERT(!srsran_sl_comm_resource_pool_sf_in_pool(&pool, tti + 80));
+  }
+
+  // The first bitmap bit maps to the first subframe that is neither SLSS nor reserved, l_0 = 0 is reserved
+  bzero(pool.sf_bitmap_tm34, SRSRAN_SL_MAX_PERIOD_LENGTH);
+  pool.sf_bitmap_tm34[0] = 1;
+  TESTASSERT(srsran_sl_comm_resource_pool_update_sf_map(&pool) == SRSRAN_SUCCESS);
+  TESTASSERT(count_sf_in_pool(&pool) == (10112 - 12) / 20);
+  TESTASSERT(!srsran_sl_comm_resource_pool_sf_in_pool(&pool, 1));
+  TESTASSERT(srsran_sl_comm_resource_pool_sf_in_pool(&pool, 2));
+  TESTASSERT(srsran_sl_comm_resource_pool_sf_in_pool(&pool, 22));
+
+  pool.slss_offset[1] = SRSRAN_SL_V2X_SLSS_PERIOD;
+  TESTASSERT(srsran_sl_comm_resource_pool_update_sf_map(&pool) == SRSRAN_ERROR_INVALID_INPUTS);
+  return SRSRAN_SUCCESS;
+}
+
+static int test_prb()
+{
+  srsran_sl_comm_resource_pool_t pool;
+  uint32_t                       prb_start_idx = 0;
+  uint32_t                       nof_prb       = 0;
+  TESTASSERT(srsran_sl_comm_resource_pool_get_default_config(&pool, cell) == SRSRAN_SUCCESS);
+  pool.start_prb_sub_channel = 3;
+  TESTASSERT(srsran_sl_comm_resource_pool_is_valid(&pool, cell) == false);
+
+  // Adjacent: the PSCCH takes the first two PRBs of the first sub-channel
+  pool.num_sub_channel = 4;
+  TESTASSERT(srsran_sl_comm_resource_pool_is_valid(&pool, cell));
+  TESTASSERT(srsran_sl_comm_resource_pool_get_pscch_prb(&pool, 2) == 23);
+  srsran_sl_comm_resource_pool_get_pssch_prb(&pool, 2, 2, &prb_start_idx, &nof_prb);
+  TESTASSERT(prb_start_idx == 25 && nof_prb == 18);
+
+  // Non adjacent: the PSCCH resources follow each other from startRB-PSCCH-Pool
+  pool.adjacency_pscch_pssch = false;
+  pool.start_prb_pscch_pool  = 42;
+  TESTASSERT(srsran_sl_comm_resource_pool_is_valid(&pool, cell));
+  TESTASSERT(srsran_sl_comm_resource_pool_get_pscch_prb(&pool, 2) == 46);
+  srsran_sl_comm_resource_pool_get_pssch_prb(&pool, 2, 2, &prb_start_idx, &nof_prb);
+  TESTASSERT(prb_start_idx == 23 && nof_prb == 20);
+  pool.start_prb_pscch_pool = 43;
+  TESTASSERT(srsran_sl_comm_resource_pool_is_valid(&pool, cell) == false);
+  return SRSRAN_SUCCESS;
+}
+
+static int test_file()
+{
+  static srsran_sl_v2x_precfg_freq_t precfg;
+  static srsran_sl_v2x_precfg_freq_t precfg2;
+
+  TESTASSERT(write_text("# Two RX pools sharing the carrier\n"
+                        "sync_offset_ind = 0, 80\n"
+                        "[rx_pool]\n"
+                        "sl_subframe = 10101010101010101010  # every other subframe\n"
+                        "num_subchannel = 2\n"
+                        "\n"
+                        "[rx_pool]\n"
+                        "sl_offset_ind = 0\n"
+                        "sl_subframe = 01010101010101010101\n"
+                        "adjacency_pscch_pssch = 0\n"
+                        "size_subchannel = 5\n"
+                        "num_subchannel = 6\n"
+                        "start_rb_subchannel = 20\n"
+                        "start_rb_pscch_pool = 0\n"
+                        "[tx_pool]\n"
+                        "num_subchannel = 2\n") == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_sl_v2x_precfg_freq_read_file(&precfg, cell, file_path) == SRSRAN_SUCCESS);
+  TESTASSERT(precfg.nof_rx_pools == 2 && precfg.nof_tx_pools == 1);
+  TESTASSERT(precfg.rx_pools[0].size_sub_channel == 10 && precfg.rx_pools[0].num_sub_channel == 2);
+  TESTASSERT(precfg.rx_pools[0].adjacency_pscch_pssch && precfg.rx_pools[0].sf_bitmap_tm34_len == 20);
+  TESTASSERT(precfg.rx_pools[1].start_prb_sub_channel == 20 && !precfg.rx_pools[1].adjacency_pscch_pssch);
+  TESTASSERT(precfg.rx_pools[1].nof_slss_offset == 2 && precfg.rx_pools[1].slss_offset[1] == 80);
+  TESTASSERT(precfg.tx_pools[0].num_sub_channel == 2 && precfg.tx_pools[0].nof_slss_offset == 2);
+
+  // The pools take turns on all but the SLSS and reserved subframes
+  uint32_t nof_sf_in_pools = 0;
+  for (uint32_t tti = 0; tti < SRSRAN_SL_DFN_PERIOD; tti++) {
+    bool in_0 = srsran_sl_comm_resource_pool_sf_in_pool(&precfg.rx_pools[0], tti);
+    bool in_1 = srsran_sl_comm_resource_pool_sf_in_pool(&precfg.rx_pools[1], tti);
+    TESTASSERT(!(in_0 && in_1));
+    TESTASSERT(srsran_sl_v2x_precfg_freq_sf_in_rx_pools(&precfg, tti) == (in_0 || in_1));
+    nof_sf_in_pools += in_0 || in_1;
+  }
+  TESTASSERT(nof_sf_in_pools == 10112 - 12);
+  TESTASSERT(!srsran_sl_v2x_precfg_freq_sf_in_rx_pools(&precfg, 160));
+
+  // Writing and reading back gives the same pools
+  TESTASSERT(srsran_sl_v2x_precfg_freq_write_file(&precfg, file_path) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_sl_v2x_precfg_freq_read_file(&precfg2, cell, file_path) == SRSRAN_SUCCESS);
+  TESTASSERT(precfg2.nof_rx_pools == 2 && precfg2.nof_tx_pools == 1);
+  for (uint32_t i = 0; i < precfg.nof_rx_pools; i++) {
+    const srsran_sl_comm_resource_pool_t* a = &precfg.rx_pools[i];
+    const srsran_sl_comm_resource_pool_t* b = &precfg2.rx_pools[i];
+    TESTASSERT(a->sl_offset_ind == b->sl_offset_ind && a->start_prb_pscch_pool == b->start_prb_pscch_pool);
+    TESTASSERT(a->size_sub_channel == b->size_sub_channel && a->num_sub_channel == b->num_sub_channel);
+    TESTASSERT(a->start_prb_sub_channel == b->start_prb_sub_channel);
+    TESTASSERT(a->adjacency_pscch_pssch == b->adjacency_pscch_pssch);
+    TESTASSERT(a->nof_slss_offset == b->nof_slss_offset);
+    TESTASSERT(memcmp(a->sf_map, b->sf_map, sizeof(a->sf_map)) == 0);
+  }
+
+  // Errors point at the offending line
+  TESTASSERT(write_text("[rx_pool]\nsize_subchannel = ten\n") == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_sl_v2x_precfg_freq_read_file(&precfg, cell, file_path) == SRSRAN_ERROR);
+  TESTASSERT(write_text("[rx_pool]\nsl_subframe = 1012\n") == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_sl_v2x_precfg_freq_read_file(&precfg, cell, file_path) == SRSRAN_ERROR);
+  TESTASSERT(write_text("[rx_pool]\nzone_id = 1\n") == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_sl_v2x_precfg_freq_read_file(&precfg, cell, file_path) == SRSRAN_ERROR);
+  TESTASSERT(write_text("num_subchannel = 1\n") == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_sl_v2x_precfg_freq_read_file(&precfg, cell, file_path) == SRSRAN_ERROR);
+  TESTASSERT(write_text("[rx_pool]\nsize_subchannel = 20\nnum_subchannel = 3\n") == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_sl_v2x_precfg_freq_read_file(&precfg, cell, file_path) == SRSRAN_ERROR);
+  TESTASSERT(srsran_sl_v2x_precfg_freq_read_file(&precfg, cell, "/nonexistent/sl_precfg") == SRSRAN_ERROR);
+  return SRSRAN_SUCCESS;
+}
+
+static void usage(char* prog)
+{
+  printf("Usage: %s\n", prog);
+  printf("\t-f pool file written and read by the test [Default %s]\n", file_path);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "f")) != -1) {
+    switch (opt) {
+      case 'f':
+        file_path = argv[optind];
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  int ret = SRSRAN_ERROR;
+  if (test_sf_map() || test_prb() || test_file()) {
+    goto clean_exit;
+  }
+
+  printf("Ok\n");
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  unlink(file_path);
+  return ret;
+}
@@ -228,6 +228,39 @@ int srsran_dft_plan_c(srsran_dft_plan_t* plan, const int dft_points, srsran_dft_
   return 0;
 }
 
+int srsran_dft_plan_batch_c(srsran_dft_plan_t* plan, const int dft_points, const int how_many, srsran_dft_dir_t dir)
+{
+  allocate(plan, sizeof(fftwf_complex), sizeof(fftwf_complex), dft_points * how_many);
+  if (!plan->in || !plan->out) {
+    return -1;
+  }
+
+  pthread_mutex_lock(&fft_mutex);
+
+  int sign = (dir == SRSRAN_DFT_FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD;
+  plan->p  = fftwf_plan_many_dft(
+      1, &dft_points, how_many, plan->in, NULL, 1, dft_points, plan->out, NULL, 1, dft_points, sign, FFTW_TYPE);
+
+  pthread_mutex_unlock(&fft_mutex);
+
+  if (!plan->p) {
+    return -1;
+  }
+  plan->size      = dft_points;
+  plan->init_size = plan->size;
+  plan->how_many  = how_many;
+  plan->mode      = SRSRAN_DFT_COMPLEX;
+  plan->dir       = dir;
+  plan->forward   = (dir == SRSRAN_DFT_FORWARD) ? true : false;
+  plan->mirror    = false;
+  plan->db        = false;
+  plan->norm      = false;
+  plan->dc        = false;
+  plan->is_guru   = false;
+
+  return 0;
+}
+
 int srsran_dft_replan_r(srsran_dft_plan_t* plan, const int new_dft_points)
 {
   int sign = (plan->dir == SRSRAN_DFT_FORWARD) ? FFTW_R2HC : FFTW_HC2R;
@@ -357,6 +390,25 @@ void srsran_dft_run_guru_c(srsran_dft_plan_t* plan)
   }
 }
 
+void srsran_dft_run_batch_c(srsran_dft_plan_t* plan, const cf_t* in, cf_t* out)
+{
+  int len = plan->size * plan->how_many;
+
+  // The plan runs on the given buffers if they keep the alignment and the out-of-place layout it was made for
+  if (in != out && fftwf_alignment_of((float*)in) == fftwf_alignment_of(plan->in) &&
+      fftwf_alignment_of((float*)out) == fftwf_alignment_of(plan->out)) {
+    fftwf_execute_dft(plan->p, (cf_t*)in, out);
+  } else {
+    memcpy(plan->in, in, sizeof(cf_t) * len);
+    fftwf_execute(plan->p);
+    memcpy(out, plan->out, sizeof(cf_t) * len);
+  }
+
+  if (plan->norm) {
+    srsran_vec_sc_prod_cfc(out, 1.0f / sqrtf(plan->size), out, len);
+  }
+}
+
 void srsran_dft_run_r(srsran_dft_plan_t* plan, const float* in, float* out)
 {
   float  norm;
@@ -34,16 +34,17 @@
 #include "srsran/phy/utils/debug.h"
 #include "srsran/phy/utils/vector.h"
 
-/* Create DFT plans for transform precoding */
-
-int srsran_dft_precoding_init(srsran_dft_precoding_t* q, uint32_t max_prb, bool is_tx)
+/* Create DFT plans for transform precoding, for every valid number of PRB from min_prb to max_prb */
+static int dft_precoding_init(srsran_dft_precoding_t* q, uint32_t min_prb, uint32_t max_prb, bool is_tx)
 {
   int ret = SRSRAN_ERROR_INVALID_INPUTS;
   bzero(q, sizeof(srsran_dft_precoding_t));
 
-  if (max_prb <= SRSRAN_MAX_PRB) {
-    ret = SRSRAN_ERROR;
-    for (uint32_t i = 1; i <= max_prb; i++) {
+  if (min_prb > 0 && min_prb <= max_prb && max_prb <= SRSRAN_MAX_PRB) {
+    ret        = SRSRAN_ERROR;
+    q->min_prb = min_prb;
+    q->max_prb = max_prb;
+    for (uint32_t i = min_prb; i <= max_prb; i++) {
       if (srsran_dft_precoding_valid_prb(i)) {
         DEBUG("Initiating DFT precoding plan for %d PRBs\n", i);
         if (srsran_dft_plan_c(&q->dft_plan[i], i * SRSRAN_NRE, is_tx ? SRSRAN_DFT_FORWARD : SRSRAN_DFT_BACKWARD)) {
@@ -53,8 +54,8 @@ int srsran_dft_precoding_init(srsran_dft_precoding_t* q, uint32_t max_prb, bool
         srsran_dft_plan_set_norm(&q->dft_plan[i], true);
       }
     }
-    q->max_prb = max_prb;
-    ret        = SRSRAN_SUCCESS;
+    q->is_tx = is_tx;
+    ret      = SRSRAN_SUCCESS;
   }
 
 clean_exit:
@@ -64,6 +65,20 @@ clean_exit:
   return ret;
 }
 
+int srsran_dft_precoding_init(srsran_dft_precoding_t* q, uint32_t max_prb, bool is_tx)
+{
+  return dft_precoding_init(q, 1, max_prb, is_tx);
+}
+
+int srsran_dft_precoding_init_nof_prb(srsran_dft_precoding_t* q, uint32_t nof_prb, bool is_tx)
+{
+  if (!srsran_dft_precoding_valid_prb(nof_prb)) {
+    ERROR("Error invalid number of PRB (%d)\n", nof_prb);
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  return dft_precoding_init(q, nof_prb, nof_prb, is_tx);
+}
+
 int srsran_dft_precoding_init_rx(srsran_dft_precoding_t* q, uint32_t max_prb)
 {
   return srsran_dft_precoding_init(q, max_prb, false);
@@ -74,17 +89,61 @@ int srsran_dft_precoding_init_tx(srsran_dft_precoding_t* q, uint32_t max_prb)
   return srsran_dft_precoding_init(q, max_prb, true);
 }
 
+static void dft_precoding_free_batch(srsran_dft_precoding_t* q)
+{
+  for (uint32_t i = SRSRAN_MAX(q->min_prb, 1); i <= q->max_prb; i++) {
+    if (srsran_dft_precoding_valid_prb(i)) {
+      srsran_dft_plan_free(&q->batch_plan[i]);
+    }
+  }
+  q->nof_batch_symbols = 0;
+}
+
 /* Free DFT plans for transform precoding */
 void srsran_dft_precoding_free(srsran_dft_precoding_t* q)
 {
-  for (uint32_t i = 1; i <= q->max_prb; i++) {
+  for (uint32_t i = SRSRAN_MAX(q->min_prb, 1); i <= q->max_prb; i++) {
     if (srsran_dft_precoding_valid_prb(i)) {
       srsran_dft_plan_free(&q->dft_plan[i]);
     }
   }
+  dft_precoding_free_batch(q);
   bzero(q, sizeof(srsran_dft_precoding_t));
 }
 
+/* Plans the transform of nof_symbols symbols at once for every planned number of PRB. Allocations of any other number
+ * of symbols are transformed symbol by symbol, so no plan is ever made while precoding. 0 frees the batch plans. */
+int srsran_dft_precoding_set_nof_symbols(srsran_dft_precoding_t* q, uint32_t nof_symbols)
+{
+  if (q == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  if (nof_symbols == q->nof_batch_symbols) {
+    return SRSRAN_SUCCESS;
+  }
+
+  dft_precoding_free_batch(q);
+  if (nof_symbols == 0) {
+    return SRSRAN_SUCCESS;
+  }
+
+  for (uint32_t i = SRSRAN_MAX(q->min_prb, 1); i <= q->max_prb; i++) {
+    if (srsran_dft_precoding_valid_prb(i)) {
+      DEBUG("Initiating DFT precoding batch plan for %d PRBs and %d symbols\n", i, nof_symbols);
+      if (srsran_dft_plan_batch_c(
+              &q->batch_plan[i], i * SRSRAN_NRE, nof_symbols, q->is_tx ? SRSRAN_DFT_FORWARD : SRSRAN_DFT_BACKWARD)) {
+        ERROR("Error: Creating DFT batch plan %d x %d\n", i, nof_symbols);
+        dft_precoding_free_batch(q);
+        return SRSRAN_ERROR;
+      }
+      srsran_dft_plan_set_norm(&q->batch_plan[i], true);
+    }
+  }
+  q->nof_batch_symbols = nof_symbols;
+
+  return SRSRAN_SUCCESS;
+}
+
 static bool valid_prb[101] = {true,  true,  true,  true,  true,  true,  true,  false, true,  true,  true,  false, true,
                               false, false, true,  true,  false, true,  false, true,  false, false, false, true,  true,
                               false, true,  false, false, true,  false, true,  false, false, false, true,  false, false,
@@ -114,11 +173,16 @@ uint32_t srsran_dft_precoding_get_valid_prb(uint32_t nof_prb)
 int srsran_dft_precoding(srsran_dft_precoding_t* q, cf_t* input, cf_t* output, uint32_t nof_prb, uint32_t nof_symbols)
 {
 
-  if (!srsran_dft_precoding_valid_prb(nof_prb) && nof_prb <= q->max_prb) {
+  if (!srsran_dft_precoding_valid_prb(nof_prb) || nof_prb < q->min_prb || nof_prb > q->max_prb) {
     ERROR("Error invalid number of PRB (%d)\n", nof_prb);
     return SRSRAN_ERROR;
   }
 
+  if (nof_symbols == q->nof_batch_symbols) {
+    srsran_dft_run_batch_c(&q->batch_plan[nof_prb], input, output);
+    return SRSRAN_SUCCESS;
+  }
+
   for (uint32_t i = 0; i < nof_symbols; i++) {
     srsran_dft_run_c(&q->dft_plan[nof_prb], &input[i * SRSRAN_NRE * nof_prb], &output[i * SRSRAN_NRE * nof_prb]);
   }
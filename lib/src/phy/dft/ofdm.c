@@ -92,6 +92,10 @@ static int ofdm_init_mbsfn_(srsran_ofdm_t* q, srsran_ofdm_cfg_t* cfg, srsran_dft
       free(q->tmp);
       free(q->shift_buffer);
     }
+    if (q->sl_shift) {
+      free(q->sl_shift);
+      q->sl_shift = NULL;
+    }
 
 #ifdef AVOID_GURU
     q->tmp = srsran_vec_cf_malloc(symbol_sz);
@@ -115,6 +119,14 @@ static int ofdm_init_mbsfn_(srsran_ofdm_t* q, srsran_ofdm_cfg_t* cfg, srsran_dft
       return SRSRAN_ERROR;
     }
 
+    if (q->cfg.sidelink) {
+      q->sl_shift = srsran_vec_cf_malloc(q->sf_sz);
+      if (!q->sl_shift) {
+        perror("malloc");
+        return SRSRAN_ERROR;
+      }
+    }
+
     q->max_prb = cfg->nof_prb;
   }
 
@@ -186,6 +198,19 @@ static int ofdm_init_mbsfn_(srsran_ofdm_t* q, srsran_ofdm_cfg_t* cfg, srsran_dft
   }
 #endif
 
+  // Sidelink transforms all symbols but the guard in one batch, from and to buffers of its own
+  if (q->cfg.sidelink) {
+    uint32_t nof_symbols_sl = SRSRAN_NOF_SLOTS_PER_SF * q->nof_symbols - 1;
+    if (q->fft_plan_sl.size) {
+      srsran_dft_plan_free(&q->fft_plan_sl);
+    }
+    if (srsran_dft_plan_batch_c(&q->fft_plan_sl, symbol_sz, nof_symbols_sl, dir)) {
+      ERROR("Creating sidelink DFT plan\n");
+      return SRSRAN_ERROR;
+    }
+    srsran_vec_cf_zero(q->fft_plan_sl.in, symbol_sz * nof_symbols_sl);
+  }
+
   srsran_dft_plan_set_mirror(&q->fft_plan, true);
   srsran_dft_plan_set_dc(&q->fft_plan, true);
 
@@ -220,6 +245,7 @@ void srsran_ofdm_set_non_mbsfn_region(srsran_ofdm_t* q, uint8_t non_mbsfn_region
 void srsran_ofdm_free_(srsran_ofdm_t* q)
 {
   srsran_dft_plan_free(&q->fft_plan);
+  srsran_dft_plan_free(&q->fft_plan_sl);
 
 #ifndef AVOID_GURU
   for (int slot = 0; slot < 2; slot++) {
@@ -238,6 +264,9 @@ void srsran_ofdm_free_(srsran_ofdm_t* q)
   if (q->window_offset_buffer) {
     free(q->window_offset_buffer);
   }
+  if (q->sl_shift) {
+    free(q->sl_shift);
+  }
   bzero(q, sizeof(srsran_ofdm_t));
 }
 
@@ -360,6 +389,14 @@ int srsran_ofdm_set_freq_shift(srsran_ofdm_t* q, float freq_shift)
     }
   }
 
+  // Once the CP is removed the shift is the same for every symbol, sl_shift[cp_max + t] holds it for t >= -cp_max
+  if (q->sl_shift) {
+    int cp_max = SRSRAN_CP_LEN_EXT(symbol_sz);
+    for (int t = -cp_max; t < (int)symbol_sz; t++) {
+      q->sl_shift[cp_max + t] = cexpf(I * 2 * M_PI * (float)t * freq_shift / symbol_sz);
+    }
+  }
+
   /* Disable DC carrier addition */
   srsran_dft_plan_set_dc(&q->fft_plan, false);
 
@@ -455,8 +492,55 @@ void srsran_ofdm_rx_slot_zerocopy(srsran_ofdm_t* q, cf_t* input, cf_t* output)
   }
 }
 
+/* Sidelink subframe demodulation, 3GPP TS 36.211 Section 9.9. The frequency shift is applied to the FFT windows
+ * only, and the guard symbol at the end of the subframe is neither transformed nor written. The FFT shift, guard band
+ * removal and normalization take a single pass per half of the band.
+ */
+static void ofdm_rx_sf_sl(srsran_ofdm_t* q)
+{
+  uint32_t    symbol_sz   = q->cfg.symbol_sz;
+  srsran_cp_t cp          = q->cfg.cp;
+  uint32_t    nof_re      = q->nof_re;
+  uint32_t    nof_symbols = q->fft_plan_sl.how_many;
+  bool        shift       = isnormal(q->cfg.freq_shift_f);
+  cf_t*       sl_shift    = q->sl_shift + SRSRAN_CP_LEN_EXT(symbol_sz) - q->window_offset_n;
+  cf_t*       input       = q->cfg.in_buffer;
+  cf_t*       fft_in      = q->fft_plan_sl.in;
+
+  for (uint32_t i = 0; i < nof_symbols; i++) {
+    input += SRSRAN_CP_ISNORM(cp) ? SRSRAN_CP_LEN_NORM(i % q->nof_symbols, symbol_sz) : SRSRAN_CP_LEN_EXT(symbol_sz);
+    if (shift) {
+      srsran_vec_prod_ccc(input - q->window_offset_n, sl_shift, fft_in, symbol_sz);
+    } else {
+      memcpy(fft_in, input - q->window_offset_n, sizeof(cf_t) * symbol_sz);
+    }
+    input += symbol_sz;
+    fft_in += symbol_sz;
+  }
+
+  srsran_dft_run_batch_c(&q->fft_plan_sl, q->fft_plan_sl.in, q->fft_plan_sl.out);
+
+  float    norm   = q->fft_plan.norm ? 1.0f / sqrtf(symbol_sz) : 1.0f;
+  uint32_t dc     = (q->fft_plan.dc) ? 1 : 0;
+  cf_t*    tmp    = q->fft_plan_sl.out;
+  cf_t*    output = q->cfg.out_buffer;
+  for (uint32_t i = 0; i < nof_symbols; i++) {
+    if (q->window_offset_n) {
+      srsran_vec_prod_ccc(tmp, q->window_offset_buffer, tmp, symbol_sz);
+    }
+    srsran_vec_sc_prod_cfc(tmp + symbol_sz - nof_re / 2, norm, output, nof_re / 2);
+    srsran_vec_sc_prod_cfc(tmp + dc, norm, output + nof_re / 2, nof_re / 2);
+    tmp += symbol_sz;
+    output += nof_re;
+  }
+}
+
 void srsran_ofdm_rx_sf(srsran_ofdm_t* q)
 {
+  if (q->cfg.sidelink) {
+    ofdm_rx_sf_sl(q);
+    return;
+  }
   if (isnormal(q->cfg.freq_shift_f)) {
     srsran_vec_prod_ccc(q->cfg.in_buffer, q->shift_buffer, q->cfg.in_buffer, q->sf_sz);
   }
@@ -564,9 +648,59 @@ void srsran_ofdm_set_normalize(srsran_ofdm_t* q, bool normalize_enable)
   srsran_dft_plan_set_norm(&q->fft_plan, normalize_enable);
 }
 
+/* Sidelink subframe modulation, 3GPP TS 36.211 Section 9.9. The normalization is applied while mapping the subcarriers,
+ * the frequency shift while adding the CP, and the guard symbol at the end of the subframe is sent as zeros.
+ */
+static void ofdm_tx_sf_sl(srsran_ofdm_t* q)
+{
+  uint32_t    symbol_sz   = q->cfg.symbol_sz;
+  srsran_cp_t cp          = q->cfg.cp;
+  uint32_t    nof_re      = q->nof_re;
+  uint32_t    nof_symbols = q->fft_plan_sl.how_many;
+  float       norm        = q->fft_plan.norm ? 1.0f / sqrtf(symbol_sz) : 1.0f;
+  uint32_t    dc          = (q->fft_plan.dc) ? 1 : 0;
+  cf_t*       input       = q->cfg.in_buffer;
+  cf_t*       ifft_in     = q->fft_plan_sl.in;
+
+  // The guard band and DC of the IFFT input stay zero from the initialization
+  for (uint32_t i = 0; i < nof_symbols; i++) {
+    srsran_vec_sc_prod_cfc(input + nof_re / 2, norm, ifft_in + dc, nof_re / 2);
+    srsran_vec_sc_prod_cfc(input, norm, ifft_in + symbol_sz - nof_re / 2, nof_re / 2);
+    input += nof_re;
+    ifft_in += symbol_sz;
+  }
+
+  srsran_dft_run_batch_c(&q->fft_plan_sl, q->fft_plan_sl.in, q->fft_plan_sl.out);
+
+  bool  shift    = isnormal(q->cfg.freq_shift_f);
+  cf_t* sl_shift = q->sl_shift + SRSRAN_CP_LEN_EXT(symbol_sz);
+  cf_t* tmp      = q->fft_plan_sl.out;
+  cf_t* output   = q->cfg.out_buffer;
+  for (uint32_t i = 0; i < nof_symbols; i++) {
+    int cp_len = SRSRAN_CP_ISNORM(cp) ? SRSRAN_CP_LEN_NORM(i % q->nof_symbols, symbol_sz) : SRSRAN_CP_LEN_EXT(symbol_sz);
+    if (shift) {
+      srsran_vec_prod_ccc(tmp + symbol_sz - cp_len, sl_shift - cp_len, output, cp_len);
+      srsran_vec_prod_ccc(tmp, sl_shift, output + cp_len, symbol_sz);
+    } else {
+      memcpy(output, tmp + symbol_sz - cp_len, sizeof(cf_t) * cp_len);
+      memcpy(output + cp_len, tmp, sizeof(cf_t) * symbol_sz);
+    }
+    tmp += symbol_sz;
+    output += symbol_sz + cp_len;
+  }
+
+  // The guard is never the first symbol of a slot
+  int cp_len = SRSRAN_CP_ISNORM(cp) ? SRSRAN_CP_LEN_NORM(1, symbol_sz) : SRSRAN_CP_LEN_EXT(symbol_sz);
+  srsran_vec_cf_zero(output, symbol_sz + cp_len);
+}
+
 void srsran_ofdm_tx_sf(srsran_ofdm_t* q)
 {
   uint32_t n;
+  if (q->cfg.sidelink) {
+    ofdm_tx_sf_sl(q);
+    return;
+  }
   if (!q->mbsfn_subframe) {
     for (n = 0; n < SRSRAN_NOF_SLOTS_PER_SF; n++) {
       ofdm_tx_slot(q, n);
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/dft/dft_precoding.h"
+#include "srsran/phy/utils/random.h"
+#include "srsran/srsran.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+static uint32_t max_prb         = SRSRAN_MAX_PRB;
+static uint32_t nof_symbols     = SRSRAN_PSSCH_TM34_NUM_DATA_SYMBOLS;
+static uint32_t nof_repetitions = 10000;
+
+static srsran_random_t random_gen = NULL;
+
+/* Reference transform, one normalized DFT per symbol */
+static void
+reference_precoding(srsran_dft_plan_t* plan, cf_t* input, cf_t* output, uint32_t nof_prb, uint32_t nof_symb)
+{
+  for (uint32_t i = 0; i < nof_symb; i++) {
+    srsran_dft_run_c(plan, &input[i * SRSRAN_NRE * nof_prb], &output[i * SRSRAN_NRE * nof_prb]);
+  }
+}
+
+static int test_all_prb(srsran_dft_precoding_t* tx, srsran_dft_precoding_t* rx, cf_t* x, cf_t* y, cf_t* z)
+{
+  for (uint32_t nof_prb = 1; nof_prb <= max_prb; nof_prb++) {
+    if (!srsran_dft_precoding_valid_prb(nof_prb)) {
+      continue;
+    }
+    uint32_t len = nof_prb * SRSRAN_NRE * nof_symbols;
+    srsran_random_uniform_complex_dist_vector(random_gen, x, len, -1.0f, 1.0f);
+
+    srsran_dft_plan_t plan = {};
+    TESTASSERT(srsran_dft_plan_c(&plan, nof_prb * SRSRAN_NRE, SRSRAN_DFT_FORWARD) == SRSRAN_SUCCESS);
+    srsran_dft_plan_set_norm(&plan, true);
+    reference_precoding(&plan, x, z, nof_prb, nof_symbols);
+    srsran_dft_plan_free(&plan);
+
+    TESTASSERT(srsran_dft_precoding(tx, x, y, nof_prb, nof_symbols) == SRSRAN_SUCCESS);
+    srsran_vec_sub_ccc(y, z, z, len);
+    float err = sqrtf(srsran_vec_avg_power_cf(z, len));
+    TESTASSERT(err < 1e-5f);
+
+    // Misaligned and in-place buffers take the copying path
+    srsran_vec_cf_copy(&z[1], x, len);
+    TESTASSERT(srsran_dft_precoding(tx, &z[1], &z[1], nof_prb, nof_symbols) == SRSRAN_SUCCESS);
+    srsran_vec_sub_ccc(&z[1], y, z, len);
+    TESTASSERT(sqrtf(srsran_vec_avg_power_cf(z, len)) < 1e-5f);
+
+    TESTASSERT(srsran_dft_precoding(rx, y, z, nof_prb, nof_symbols) == SRSRAN_SUCCESS);
+    srsran_vec_sub_ccc(z, x, z, len);
+    TESTASSERT(sqrtf(srsran_vec_avg_power_cf(z, len)) < 1e-5f);
+
+    // Any other number of symbols is transformed symbol by symbol
+    if (nof_symbols > 1) {
+      TESTASSERT(srsran_dft_precoding(tx, x, z, nof_prb, nof_symbols - 1) == SRSRAN_SUCCESS);
+      srsran_vec_sub_ccc(z, y, z, len - nof_prb * SRSRAN_NRE);
+      TESTASSERT(sqrtf(srsran_vec_avg_power_cf(z, len - nof_prb * SRSRAN_NRE)) < 1e-5f);
+    }
+  }
+
+  return SRSRAN_SUCCESS;
+}
+
+/* A precoder planned for a single number of PRB, as used by PSCCH and PSBCH, rejects every other size */
+static int test_single_prb(cf_t* x, cf_t* y)
+{
+  const uint32_t         nof_prb = SRSRAN_MIN(2, max_prb);
+  srsran_dft_precoding_t tx      = {};
+  TESTASSERT(srsran_dft_precoding_init_nof_prb(&tx, 7, true) == SRSRAN_ERROR_INVALID_INPUTS);
+  TESTASSERT(srsran_dft_precoding_init_nof_prb(&tx, nof_prb, true) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_dft_precoding_set_nof_symbols(&tx, nof_symbols) == SRSRAN_SUCCESS);
+
+  int ret = srsran_dft_precoding(&tx, x, y, nof_prb, nof_symbols);
+  for (uint32_t i = 1; i <= SRSRAN_MIN(max_prb + 1, SRSRAN_MAX_PRB) && ret == SRSRAN_SUCCESS; i++) {
+    if (i != nof_prb && srsran_dft_precoding_valid_prb(i) && srsran_dft_precoding(&tx, x, y, i, 1) != SRSRAN_ERROR) {
+      ret = SRSRAN_ERROR;
+    }
+  }
+  srsran_dft_precoding_free(&tx);
+  TESTASSERT(ret == SRSRAN_SUCCESS);
+
+  return SRSRAN_SUCCESS;
+}
+
+static double benchmark(srsran_dft_precoding_t* rx, cf_t* x, cf_t* y, uint32_t nof_prb, bool batch)
+{
+  srsran_dft_plan_t* plan = &rx->dft_plan[nof_prb];
+  struct timeval     t[3];
+
+  gettimeofday(&t[1], NULL);
+  for (uint32_t r = 0; r < nof_repetitions; r++) {
+    if (batch) {
+      srsran_dft_precoding(rx, x, y, nof_prb, nof_symbols);
+    } else {
+      reference_precoding(plan, x, y, nof_prb, nof_symbols);
+    }
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+
+  return (t[0].tv_sec * 1e6 + t[0].tv_usec) * 1e3 / nof_repetitions;
+}
+
+static void usage(char* prog)
+{
+  printf("Usage: %s\n", prog);
+  printf("\t-p max_prb [Default %d]\n", max_prb);
+  printf("\t-n nof_symbols [Default %d]\n", nof_symbols);
+  printf("\t-r nof_repetitions for the benchmark [Default %d]\n", nof_repetitions);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "pnr")) != -1) {
+    switch (opt) {
+      case 'p':
+        max_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'n':
+        nof_symbols = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'r':
+        nof_repetitions = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  int ret = SRSRAN_ERROR;
+  parse_args(argc, argv);
+
+  random_gen = srsran_random_init(0x1234);
+
+  srsran_dft_precoding_t tx = {}, rx = {};
+  uint32_t               len = SRSRAN_MAX_PRB * SRSRAN_NRE * nof_symbols;
+  cf_t*                  x   = srsran_vec_cf_malloc(len);
+  cf_t*                  y   = srsran_vec_cf_malloc(len);
+  cf_t*                  z   = srsran_vec_cf_malloc(len + 1);
+  if (!x || !y || !z || srsran_dft_precoding_init_tx(&tx, max_prb) || srsran_dft_precoding_init_rx(&rx, max_prb) ||
+      srsran_dft_precoding_set_nof_symbols(&tx, nof_symbols) || srsran_dft_precoding_set_nof_symbols(&rx, nof_symbols)) {
+    ERROR("Error initiating test\n");
+    goto clean_exit;
+  }
+
+  if (test_all_prb(&tx, &rx, x, y, z) || test_single_prb(x, y)) {
+    goto clean_exit;
+  }
+
+  // PSCCH and a full band PSSCH of 50 PRB, sizeSubchannel=10
+  uint32_t bench_prb[2] = {SRSRAN_MIN(2, max_prb), srsran_dft_precoding_get_valid_prb(SRSRAN_MIN(48, max_prb))};
+  for (uint32_t i = 0; i < 2; i++) {
+    srsran_random_uniform_complex_dist_vector(random_gen, x, bench_prb[i] * SRSRAN_NRE * nof_symbols, -1.0f, 1.0f);
+    double per_symbol = benchmark(&rx, x, y, bench_prb[i], false);
+    double batched    = benchmark(&rx, x, y, bench_prb[i], true);
+    printf("%2d PRB x %2d symbols: %8.1f ns per symbol loop, %8.1f ns batched (%.2fx)\n",
+           bench_prb[i],
+           nof_symbols,
+           per_symbol,
+           batched,
+           per_symbol / batched);
+  }
+
+  printf("Ok\n");
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_dft_precoding_free(&tx);
+  srsran_dft_precoding_free(&rx);
+  free(x);
+  free(y);
+  free(z);
+  srsran_random_free(random_gen);
+  return ret;
+}
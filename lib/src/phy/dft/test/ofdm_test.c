@@ -35,6 +35,7 @@ static int         nof_repetitions  = 1;
 static float       rx_window_offset = 0.5f;
 static float       freq_shift_f     = 0.0f;
 static uint32_t    force_symbol_sz  = 0;
+static bool        sidelink         = false;
 static double      elapsed_us(struct timeval* ts_start, struct timeval* ts_end)
 {
   if (ts_end->tv_usec > ts_start->tv_usec) {
@@ -55,12 +56,13 @@ static void usage(char* prog)
   printf("\t-r nof_repetitions [Default %d]\n", nof_repetitions);
   printf("\t-o rx window offset (portion of CP length) [Default %.1f]\n", rx_window_offset);
   printf("\t-s frequency shift (normalised with sampling rate) [Default %.1f]\n", freq_shift_f);
+  printf("\t-S sidelink subframe, compared against the generic modulator [Default %s]\n", sidelink ? "yes" : "no");
 }
 
 static void parse_args(int argc, char** argv)
 {
   int opt;
-  while ((opt = getopt(argc, argv, "Nneros")) != -1) {
+  while ((opt = getopt(argc, argv, "NnerosS")) != -1) {
     switch (opt) {
       case 'n':
         nof_prb = (int)strtol(argv[optind], NULL, 10);
@@ -80,6 +82,9 @@ static void parse_args(int argc, char** argv)
       case 's':
         freq_shift_f = SRSRAN_MIN(1.0f, SRSRAN_MAX(0.0f, strtof(argv[optind], NULL)));
         break;
+      case 'S':
+        sidelink = true;
+        break;
       default:
         usage(argv[0]);
         exit(-1);
@@ -91,8 +96,8 @@ int main(int argc, char** argv)
 {
   srsran_random_t random_gen = srsran_random_init(0);
   struct timeval  start, end;
-  srsran_ofdm_t   fft = {}, ifft = {};
-  cf_t *          input, *outfft, *outifft;
+  srsran_ofdm_t   fft = {}, ifft = {}, fft_ref = {}, ifft_ref = {};
+  cf_t *          input, *outfft, *outifft, *outifft_ref;
   float           mse;
   uint32_t        n_prb, max_prb;
 
@@ -109,14 +114,16 @@ int main(int argc, char** argv)
     uint32_t symbol_sz = (force_symbol_sz) ? force_symbol_sz : (uint32_t)srsran_symbol_sz(n_prb);
     uint32_t n_re      = SRSRAN_CP_NSYMB(cp) * n_prb * SRSRAN_NRE * SRSRAN_NOF_SLOTS_PER_SF;
     uint32_t sf_len    = SRSRAN_SF_LEN(symbol_sz);
+    uint32_t guard_re  = sidelink ? n_prb * SRSRAN_NRE : 0; // The last symbol is not transmitted in sidelink
 
     printf("Running test for %d PRB, %d RE... ", n_prb, n_re);
     fflush(stdout);
 
     input   = srsran_vec_cf_malloc(n_re);
     outfft  = srsran_vec_cf_malloc(n_re);
-    outifft = srsran_vec_cf_malloc(sf_len);
-    if (!input || !outfft || !outifft) {
+    outifft     = srsran_vec_cf_malloc(sf_len);
+    outifft_ref = srsran_vec_cf_malloc(sf_len);
+    if (!input || !outfft || !outifft || !outifft_ref) {
       perror("malloc");
       exit(-1);
     }
@@ -130,6 +137,16 @@ int main(int argc, char** argv)
     ofdm_cfg.symbol_sz         = symbol_sz;
     ofdm_cfg.freq_shift_f      = freq_shift_f;
     ofdm_cfg.normalize         = true;
+    if (sidelink) {
+      // Generic modulator for reference
+      ofdm_cfg.out_buffer = outifft_ref;
+      if (srsran_ofdm_tx_init_cfg(&ifft_ref, &ofdm_cfg)) {
+        ERROR("Error initializing iFFT\n");
+        exit(-1);
+      }
+      ofdm_cfg.out_buffer = outifft;
+      ofdm_cfg.sidelink   = true;
+    }
     if (srsran_ofdm_tx_init_cfg(&ifft, &ofdm_cfg)) {
       ERROR("Error initializing iFFT\n");
       exit(-1);
@@ -143,13 +160,23 @@ int main(int argc, char** argv)
       ERROR("Error initializing FFT\n");
       exit(-1);
     }
+    if (sidelink) {
+      ofdm_cfg.in_buffer = outifft_ref;
+      ofdm_cfg.sidelink  = false;
+      if (srsran_ofdm_rx_init_cfg(&fft_ref, &ofdm_cfg)) {
+        ERROR("Error initializing FFT\n");
+        exit(-1);
+      }
+    }
 
-    if (isnormal(freq_shift_f)) {
+    // The generic demodulator shifts its input in place
+    if (isnormal(freq_shift_f) && !sidelink) {
       nof_repetitions = 1;
     }
 
     // Generate Random data
     srsran_random_uniform_complex_dist_vector(random_gen, input, n_re, -1.0f, +1.0f);
+    srsran_vec_cf_zero(&input[n_re - guard_re], guard_re);
 
     // Execute Tx
     gettimeofday(&start, NULL);
@@ -159,6 +186,32 @@ int main(int argc, char** argv)
     gettimeofday(&end, NULL);
     printf(" Tx@%.1fMsps", (float)(sf_len * nof_repetitions) / elapsed_us(&start, &end));
 
+    if (sidelink) {
+      gettimeofday(&start, NULL);
+      for (uint32_t i = 0; i < nof_repetitions; i++) {
+        srsran_ofdm_tx_sf(&ifft_ref);
+      }
+      gettimeofday(&end, NULL);
+      printf(" (generic Tx@%.1fMsps)", (float)(sf_len * nof_repetitions) / elapsed_us(&start, &end));
+
+      srsran_vec_sub_ccc(outifft, outifft_ref, outifft_ref, sf_len);
+      mse = sqrtf(srsran_vec_avg_power_cf(outifft_ref, sf_len));
+      if (mse >= 0.0001) {
+        printf(" Tx MSE=%.6f too large\n", mse);
+        exit(-1);
+      }
+    }
+
+    // Generic demodulator for reference, it does not use the modulated signal
+    if (sidelink) {
+      gettimeofday(&start, NULL);
+      for (uint32_t i = 0; i < nof_repetitions; i++) {
+        srsran_ofdm_rx_sf(&fft_ref);
+      }
+      gettimeofday(&end, NULL);
+      printf(" (generic Rx@%.1fMsps)", (double)(sf_len * nof_repetitions) / elapsed_us(&start, &end));
+    }
+
     // Execute Rx
     gettimeofday(&start, NULL);
     for (uint32_t i = 0; i < nof_repetitions; i++) {
@@ -168,8 +221,8 @@ int main(int argc, char** argv)
     printf(" Rx@%.1fMsps", (double)(sf_len * nof_repetitions) / elapsed_us(&start, &end));
 
     // compute Mean Square Error
-    srsran_vec_sub_ccc(input, outfft, outfft, n_re);
-    mse = sqrtf(srsran_vec_avg_power_cf(outfft, n_re));
+    srsran_vec_sub_ccc(input, outfft, outfft, n_re - guard_re);
+    mse = sqrtf(srsran_vec_avg_power_cf(outfft, n_re - guard_re));
 
     printf(" MSE=%.6f\n", mse);
 
@@ -180,10 +233,13 @@ int main(int argc, char** argv)
 
     srsran_ofdm_rx_free(&fft);
     srsran_ofdm_tx_free(&ifft);
+    srsran_ofdm_rx_free(&fft_ref);
+    srsran_ofdm_tx_free(&ifft_ref);
 
     free(input);
     free(outfft);
     free(outifft);
+    free(outifft_ref);
 
     n_prb++;
   }
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/utils/random.h"
+#include "srsran/srsran.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+#define MAX_FRAMES SRSRAN_VITERBI_BATCH_MAX_FRAMES
+
+// SCI format 1 plus CRC, the PSCCH frame length
+static uint32_t frame_length    = SRSRAN_SCI_MAX_LEN + SRSRAN_SCI_CRC_LEN;
+static uint32_t nof_batches     = 100;
+static uint32_t nof_repetitions = 1000;
+static float    ebno_db         = 2.0f;
+
+static srsran_random_t random_gen = NULL;
+
+static srsran_viterbi_t dec = {};
+static uint8_t*         data_tx[MAX_FRAMES];
+static uint8_t*         data_rx[MAX_FRAMES];
+static uint8_t*         data_batch[MAX_FRAMES];
+static int16_t*         llr[MAX_FRAMES];
+
+static void generate_frames(srsran_convcoder_t* cod, uint32_t nof_frames, float ebno)
+{
+  uint32_t coded_length = 3 * frame_length;
+  float    std_dev      = srsran_convert_dB_to_amplitude(-ebno - srsran_convert_power_to_dB(1.0f / 3.0f));
+  uint8_t  symbols[3 * frame_length];
+  float    llr_f[3 * frame_length];
+
+  for (uint32_t f = 0; f < nof_frames; f++) {
+    for (uint32_t j = 0; j < frame_length; j++) {
+      data_tx[f][j] = (uint8_t)srsran_random_uniform_int_dist(random_gen, 0, 1);
+    }
+    srsran_convcoder_encode(cod, data_tx[f], symbols, frame_length);
+    for (uint32_t j = 0; j < coded_length; j++) {
+      llr_f[j] = symbols[j] ? M_SQRT2 : -M_SQRT2;
+    }
+    srsran_ch_awgn_f(llr_f, llr_f, std_dev, coded_length);
+    srsran_vec_convert_fi(llr_f, 1000, llr[f], coded_length);
+  }
+}
+
+static int test_batch(srsran_convcoder_t* cod)
+{
+  uint32_t errors_serial = 0, errors_batch = 0;
+
+  for (uint32_t b = 0; b < nof_batches; b++) {
+    // Every batch size, including partially filled lanes
+    uint32_t nof_frames = b % MAX_FRAMES + 1;
+    generate_frames(cod, nof_frames, ebno_db);
+
+    TESTASSERT(srsran_viterbi_decode_s_batch(&dec, llr, data_batch, nof_frames, frame_length) == frame_length);
+    for (uint32_t f = 0; f < nof_frames; f++) {
+      srsran_viterbi_decode_s(&dec, llr[f], data_rx[f], frame_length);
+      errors_serial += srsran_bit_diff(data_tx[f], data_rx[f], frame_length);
+      errors_batch += srsran_bit_diff(data_tx[f], data_batch[f], frame_length);
+#ifdef LV_HAVE_AVX2
+      // Same arithmetic as the 16-bit AVX2 decoder, the decisions must match
+      TESTASSERT(srsran_bit_diff(data_rx[f], data_batch[f], frame_length) == 0);
+#endif /* LV_HAVE_AVX2 */
+    }
+  }
+  printf("Eb/No %.1f dB, %d batches: %d errors serial, %d errors batched\n",
+         ebno_db,
+         nof_batches,
+         errors_serial,
+         errors_batch);
+
+  // Noiseless frames decode without errors
+  generate_frames(cod, MAX_FRAMES, 100.0f);
+  TESTASSERT(srsran_viterbi_decode_s_batch(&dec, llr, data_batch, MAX_FRAMES, frame_length) == frame_length);
+  for (uint32_t f = 0; f < MAX_FRAMES; f++) {
+    TESTASSERT(srsran_bit_diff(data_tx[f], data_batch[f], frame_length) == 0);
+  }
+
+  // Without the multi-frame decoder the frames are decoded one by one
+  srsran_viterbi_t serial_dec = {};
+  TESTASSERT(srsran_viterbi_init(&serial_dec, SRSRAN_VITERBI_37, cod->poly, frame_length, true) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_viterbi_decode_s_batch(&serial_dec, llr, data_batch, MAX_FRAMES, frame_length) == frame_length);
+  for (uint32_t f = 0; f < MAX_FRAMES; f++) {
+    TESTASSERT(srsran_bit_diff(data_tx[f], data_batch[f], frame_length) == 0);
+  }
+  srsran_viterbi_free(&serial_dec);
+
+  // Limits
+  TESTASSERT(srsran_viterbi_decode_s_batch(&dec, llr, data_batch, MAX_FRAMES + 1, frame_length) == SRSRAN_ERROR);
+  TESTASSERT(srsran_viterbi_decode_s_batch(&dec, llr, data_batch, 1, frame_length + 1) == SRSRAN_ERROR);
+  return SRSRAN_SUCCESS;
+}
+
+static double benchmark(uint32_t nof_frames, bool batch)
+{
+  struct timeval t[3];
+
+  gettimeofday(&t[1], NULL);
+  for (uint32_t r = 0; r < nof_repetitions; r++) {
+    if (batch) {
+      srsran_viterbi_decode_s_batch(&dec, llr, data_batch, nof_frames, frame_length);
+    } else {
+      for (uint32_t f = 0; f < nof_frames; f++) {
+        srsran_viterbi_decode_s(&dec, llr[f], data_rx[f], frame_length);
+      }
+    }
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+
+  return (t[0].tv_sec * 1e6 + t[0].tv_usec) / nof_repetitions;
+}
+
+static void usage(char* prog)
+{
+  printf("Usage: %s\n", prog);
+  printf("\t-l frame_length [Default %d]\n", frame_length);
+  printf("\t-n nof_batches [Default %d]\n", nof_batches);
+  printf("\t-e Eb/No in dB [Default %.1f]\n", ebno_db);
+  printf("\t-r nof_repetitions for the benchmark [Default %d]\n", nof_repetitions);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "lner")) != -1) {
+    switch (opt) {
+      case 'l':
+        frame_length = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'n':
+        nof_batches = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'e':
+        ebno_db = strtof(argv[optind], NULL);
+        break;
+      case 'r':
+        nof_repetitions = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  int ret = SRSRAN_ERROR;
+  parse_args(argc, argv);
+
+  random_gen = srsran_random_init(0x1234);
+
+  srsran_convcoder_t cod = {};
+  cod.R                  = 3;
+  cod.K                  = 7;
+  cod.tail_biting        = true;
+  cod.poly[0]            = 0x6D;
+  cod.poly[1]            = 0x4F;
+  cod.poly[2]            = 0x57;
+
+  bool alloc_ok = srsran_viterbi_init(&dec, SRSRAN_VITERBI_37, cod.poly, frame_length, true) == SRSRAN_SUCCESS &&
+                  srsran_viterbi_init_batch(&dec) == SRSRAN_SUCCESS;
+  for (uint32_t f = 0; f < MAX_FRAMES; f++) {
+    data_tx[f]    = srsran_vec_u8_malloc(frame_length);
+    data_rx[f]    = srsran_vec_u8_malloc(frame_length);
+    data_batch[f] = srsran_vec_u8_malloc(frame_length);
+    llr[f]        = srsran_vec_i16_malloc(3 * frame_length);
+    alloc_ok      = alloc_ok && data_tx[f] && data_rx[f] && data_batch[f] && llr[f];
+  }
+  if (!alloc_ok) {
+    ERROR("Error initiating test\n");
+    goto clean_exit;
+  }
+
+  if (test_batch(&cod)) {
+    goto clean_exit;
+  }
+
+  // Typical number of PSCCH candidates left in a subframe, and full batches
+  uint32_t bench_frames[3] = {4, 8, MAX_FRAMES};
+  for (uint32_t i = 0; i < 3; i++) {
+    generate_frames(&cod, bench_frames[i], ebno_db);
+    double serial  = benchmark(bench_frames[i], false);
+    double batched = benchmark(bench_frames[i], true);
+    printf("%2d frames of %d bits: %8.1f us one by one, %8.1f us batched (%.2fx)\n",
+           bench_frames[i],
+           frame_length,
+           serial,
+           batched,
+           serial / batched);
+  }
+
+  printf("Ok\n");
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_viterbi_free(&dec);
+  for (uint32_t f = 0; f < MAX_FRAMES; f++) {
+    free(data_tx[f]);
+    free(data_rx[f]);
+    free(data_batch[f]);
+    free(llr[f]);
+  }
+  srsran_random_free(random_gen);
+  return ret;
+}
@@ -38,6 +38,9 @@
 
 #define DEFAULT_GAIN 100
 
+// Below this number of frames, decoding them one by one is faster than running all the batch lanes
+#define BATCH_MIN_FRAMES 6
+
 #define DEFAULT_GAIN_16 1000
 #define VITERBI_16
 
@@ -487,31 +490,52 @@ int srsran_viterbi_init(srsran_viterbi_t*     q,
                         uint32_t              max_frame_length,
                         bool                  tail_bitting)
 {
+  int ret = -1;
   bzero(q, sizeof(srsran_viterbi_t));
+  memcpy(q->poly, poly, 3 * sizeof(int));
   switch (type) {
     case SRSRAN_VITERBI_37:
 #ifdef LV_HAVE_SSE
 
 #ifdef LV_HAVE_AVX2
 #ifdef VITERBI_16
-      return init37_avx2_16bit(q, poly, max_frame_length, tail_bitting);
+      ret = init37_avx2_16bit(q, poly, max_frame_length, tail_bitting);
 #else
-      return init37_avx2(q, poly, max_frame_length, tail_bitting);
+      ret = init37_avx2(q, poly, max_frame_length, tail_bitting);
 #endif
 #else
-      return init37_sse(q, poly, max_frame_length, tail_bitting);
+      ret = init37_sse(q, poly, max_frame_length, tail_bitting);
 #endif
 #else
 #ifdef HAVE_NEON
-      return init37_neon(q, poly, max_frame_length, tail_bitting);
+      ret = init37_neon(q, poly, max_frame_length, tail_bitting);
 #else
-      return init37(q, poly, max_frame_length, tail_bitting);
+      ret = init37(q, poly, max_frame_length, tail_bitting);
 #endif
 #endif
+      break;
     default:
       ERROR("Decoder not implemented\n");
       return -1;
   }
+  return ret;
+}
+
+int srsran_viterbi_init_batch(srsran_viterbi_t* q)
+{
+  if (q == NULL || !q->tail_biting || q->K != 7 || q->R != 3) {
+    ERROR("The multi-frame decoder needs a tail biting decoder of type 37\n");
+    return SRSRAN_ERROR;
+  }
+  if (q->ptr_batch != NULL) {
+    return SRSRAN_SUCCESS;
+  }
+  q->ptr_batch = create_viterbi37_batch(q->poly, q->framebits, TB_ITER * q->framebits);
+  if (q->ptr_batch == NULL) {
+    ERROR("create_viterbi37_batch failed\n");
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
 }
 
 #ifdef LV_HAVE_SSE
@@ -541,6 +565,7 @@ void srsran_viterbi_free(srsran_viterbi_t* q)
   if (q->free) {
     q->free(q);
   }
+  delete_viterbi37_batch(q->ptr_batch);
   bzero(q, sizeof(srsran_viterbi_t));
 }
 
@@ -605,6 +630,41 @@ int srsran_viterbi_decode_s(srsran_viterbi_t* q, int16_t* symbols, uint8_t* data
 #endif
 }
 
+int srsran_viterbi_decode_s_batch(srsran_viterbi_t* q,
+                                  int16_t**         symbols,
+                                  uint8_t**         data,
+                                  uint32_t          nof_frames,
+                                  uint32_t          frame_length)
+{
+  uint32_t best_state[SRSRAN_VITERBI_BATCH_MAX_FRAMES];
+
+  if (q == NULL || symbols == NULL || data == NULL ||
+      nof_frames > SRSRAN_VITERBI_BATCH_MAX_FRAMES || frame_length == 0) {
+    return SRSRAN_ERROR;
+  }
+  if (frame_length > q->framebits) {
+    ERROR("Initialized decoder for max frame length %d bits\n", q->framebits);
+    return SRSRAN_ERROR;
+  }
+  if (nof_frames < BATCH_MIN_FRAMES || q->ptr_batch == NULL) {
+    for (uint32_t f = 0; f < nof_frames; f++) {
+      if (srsran_viterbi_decode_s(q, symbols[f], data[f], frame_length) < 0) {
+        return SRSRAN_ERROR;
+      }
+    }
+    return frame_length;
+  }
+
+  // Same wrap around as the single frame tail biting decoders, the middle copy is kept
+  if (init_viterbi37_batch(q->ptr_batch, symbols, nof_frames, frame_length) ||
+      update_viterbi37_blk_batch(q->ptr_batch, TB_ITER * frame_length, best_state) ||
+      chainback_viterbi37_batch(
+          q->ptr_batch, data, nof_frames, TB_ITER * frame_length, (TB_ITER / 2) * frame_length, best_state)) {
+    return SRSRAN_ERROR;
+  }
+  return frame_length;
+}
+
 int srsran_viterbi_decode_us(srsran_viterbi_t* q, uint16_t* symbols, uint8_t* data, uint32_t frame_length)
 {
   int ret = SRSRAN_ERROR;
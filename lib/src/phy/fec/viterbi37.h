@@ -82,4 +82,19 @@ void delete_viterbi37_avx2_16bit(void* p);
 
 int update_viterbi37_blk_avx2_16bit(void* p, uint16_t* syms, uint32_t nbits, uint32_t* best_state);
 
+void* create_viterbi37_batch(int polys[3], uint32_t max_frame_length, uint32_t len);
+
+int init_viterbi37_batch(void* p, int16_t** symbols, uint32_t nof_frames, uint32_t frame_length);
+
+int chainback_viterbi37_batch(void*     p,
+                              uint8_t** data,
+                              uint32_t  nof_frames,
+                              uint32_t  nbits,
+                              uint32_t  first_bit,
+                              uint32_t* endstate);
+
+void delete_viterbi37_batch(void* p);
+
+int update_viterbi37_blk_batch(void* p, uint32_t nbits, uint32_t* best_state);
+
 #endif /* SRSRAN_VITERBI37_H_ */
@@ -0,0 +1,373 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/* r=1/3 k=7 Viterbi decoder running several frames of the same length at once, one frame per 16-bit lane.
+ *
+ * The arithmetic is the one of the 16-bit AVX2 decoder (viterbi37_avx2_16bit.c): same branch metrics, same modulo
+ * compare and select and same chainback. Instead of normalizing, the path metrics are left to wrap around: the compare
+ * and select and the search of the best end state only look at metric differences, so every lane makes the same
+ * decisions as the single frame decoder would.
+ *
+ * The 64 states are kept as 64 vectors of lanes, so a butterfly is a handful of vertical operations and no shuffling
+ * is needed. The decisions of a butterfly are packed into one word per bit, see v37_batch_bit(). AVX512 runs 32 lanes,
+ * AVX2 and the generic version 16.
+ */
+
+#include "parity.h"
+#include "srsran/phy/fec/viterbi.h"
+#include "viterbi37.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#if defined(LV_HAVE_AVX2) || defined(LV_HAVE_AVX512)
+#include <immintrin.h>
+#endif /* LV_HAVE_AVX2 || LV_HAVE_AVX512 */
+
+#define NOF_LANES SRSRAN_VITERBI_BATCH_MAX_FRAMES
+#define NOF_STATES 64
+#define NOF_BUTTERFLIES (NOF_STATES / 2)
+#define NOF_PATTERNS 8
+
+#if NOF_LANES == 32
+typedef uint64_t decision_t;
+
+/* Bit of a decision word holding the decision of the even (odd = 0) or odd state of a butterfly for a lane. With
+ * AVX512 these are the two compare masks one after the other. */
+static inline uint32_t v37_batch_bit(uint32_t lane, uint32_t odd)
+{
+  return 32 * odd + lane;
+}
+#else  /* NOF_LANES == 32 */
+typedef uint32_t decision_t;
+
+/* Bit of a decision word holding the decision of the even (odd = 0) or odd state of a butterfly for a lane. It is the
+ * layout _mm256_packs_epi16() followed by _mm256_movemask_epi8() gives. */
+static inline uint32_t v37_batch_bit(uint32_t lane, uint32_t odd)
+{
+  return 16 * (lane / 8) + 8 * odd + (lane % 8);
+}
+#endif /* NOF_LANES == 32 */
+
+struct v37_batch {
+  uint16_t    metrics[2][NOF_STATES][NOF_LANES]; /* path metrics, swapped on every bit */
+  uint16_t    bm[NOF_PATTERNS][NOF_LANES];       /* branch metric of every coded bit pattern for the current bit */
+  uint8_t     pattern[NOF_BUTTERFLIES];          /* coded bits expected by each butterfly */
+  uint16_t*   syms;                              /* lane interleaved input symbols, 3 * NOF_LANES per bit */
+  decision_t* decisions;                         /* NOF_BUTTERFLIES words per bit */
+  uint32_t    max_frame_length;
+  uint32_t    len;
+  uint32_t    frame_length;
+};
+
+void* create_viterbi37_batch(int polys[3], uint32_t max_frame_length, uint32_t len)
+{
+  struct v37_batch* vp = NULL;
+  if (posix_memalign((void**)&vp, 64, sizeof(struct v37_batch))) {
+    return NULL;
+  }
+  bzero(vp, sizeof(struct v37_batch));
+
+  for (uint32_t j = 0; j < NOF_BUTTERFLIES; j++) {
+    vp->pattern[j] = 0;
+    for (uint32_t k = 0; k < 3; k++) {
+      vp->pattern[j] |= (((polys[k] < 0) ^ parity((2 * j) & polys[k])) & 1) << k;
+    }
+  }
+
+  vp->max_frame_length = max_frame_length;
+  vp->len              = len;
+  if (posix_memalign((void**)&vp->syms, 64, 3 * NOF_LANES * max_frame_length * sizeof(uint16_t)) ||
+      posix_memalign((void**)&vp->decisions, 64, NOF_BUTTERFLIES * (len + 6) * sizeof(decision_t))) {
+    delete_viterbi37_batch(vp);
+    return NULL;
+  }
+  return vp;
+}
+
+void delete_viterbi37_batch(void* p)
+{
+  struct v37_batch* vp = p;
+  if (vp != NULL) {
+    free(vp->syms);
+    free(vp->decisions);
+    free(vp);
+  }
+}
+
+/* Loads the frames into the lanes and resets the path metrics. The symbols are quantized as
+ * srsran_viterbi_decode_s() does, unused lanes get erasures */
+int init_viterbi37_batch(void* p, int16_t** symbols, uint32_t nof_frames, uint32_t frame_length)
+{
+  struct v37_batch* vp = p;
+  if (vp == NULL || nof_frames > NOF_LANES || frame_length > vp->max_frame_length) {
+    return -1;
+  }
+
+  for (uint32_t i = 0; i < 3 * frame_length; i++) {
+    uint16_t* s = &vp->syms[i * NOF_LANES];
+    uint32_t  f = 0;
+    for (; f < nof_frames; f++) {
+      int32_t tmp = (int32_t)symbols[f][i] + INT16_MAX;
+      s[f]        = (uint16_t)(tmp < 0 ? 0 : tmp);
+    }
+    for (; f < NOF_LANES; f++) {
+      s[f] = INT16_MAX;
+    }
+  }
+  vp->frame_length = frame_length;
+
+  for (uint32_t i = 0; i < NOF_STATES; i++) {
+    for (uint32_t f = 0; f < NOF_LANES; f++) {
+      vp->metrics[0][i][f] = 63;
+    }
+  }
+  return 0;
+}
+
+#ifdef LV_HAVE_AVX512
+
+static void update_viterbi37_batch_avx512(struct v37_batch* vp, uint32_t nbits)
+{
+  const __m512i max_bm   = _mm512_set1_epi16(8191);
+
+  __m512i* old_metrics = (__m512i*)vp->metrics[0];
+  __m512i* new_metrics = (__m512i*)vp->metrics[1];
+
+  for (uint32_t t = 0; t < nbits; t++) {
+    const uint16_t* syms  = &vp->syms[(t % vp->frame_length) * 3 * NOF_LANES];
+    __m512i         sym0v = _mm512_load_si512((__m512i*)&syms[0]);
+    __m512i         sym1v = _mm512_load_si512((__m512i*)&syms[NOF_LANES]);
+    __m512i         sym2v = _mm512_load_si512((__m512i*)&syms[2 * NOF_LANES]);
+    __m512i         nsym0 = _mm512_ternarylogic_epi32(sym0v, sym0v, sym0v, 0x55);
+    __m512i         nsym1 = _mm512_ternarylogic_epi32(sym1v, sym1v, sym1v, 0x55);
+    __m512i         nsym2 = _mm512_ternarylogic_epi32(sym2v, sym2v, sym2v, 0x55);
+
+    /* Form the branch metrics of the 8 possible coded bit patterns */
+    __m512i bm[NOF_PATTERNS], m_bm[NOF_PATTERNS];
+    for (uint32_t p = 0; p < NOF_PATTERNS; p++) {
+      __m512i m0 = _mm512_avg_epu16((p & 1) ? nsym0 : sym0v, (p & 2) ? nsym1 : sym1v);
+      __m512i m  = _mm512_avg_epu16((p & 4) ? nsym2 : sym2v, m0);
+      bm[p]      = _mm512_srli_epi16(m, 3);
+      m_bm[p]    = _mm512_sub_epi16(max_bm, bm[p]);
+    }
+
+    decision_t* d = &vp->decisions[t * NOF_BUTTERFLIES];
+    for (uint32_t j = 0; j < NOF_BUTTERFLIES; j++) {
+      __m512i metric   = bm[vp->pattern[j]];
+      __m512i m_metric = m_bm[vp->pattern[j]];
+
+      /* Add branch metrics to path metrics */
+      __m512i m0 = _mm512_add_epi16(old_metrics[j], metric);
+      __m512i m1 = _mm512_add_epi16(old_metrics[j + NOF_BUTTERFLIES], m_metric);
+      __m512i m2 = _mm512_add_epi16(old_metrics[j], m_metric);
+      __m512i m3 = _mm512_add_epi16(old_metrics[j + NOF_BUTTERFLIES], metric);
+
+      /* Compare and select, using modulo arithmetic */
+      __mmask32 decision0 = _mm512_cmpgt_epi16_mask(_mm512_sub_epi16(m0, m1), _mm512_setzero_si512());
+      __mmask32 decision1 = _mm512_cmpgt_epi16_mask(_mm512_sub_epi16(m2, m3), _mm512_setzero_si512());
+
+      new_metrics[2 * j]     = _mm512_mask_blend_epi16(decision0, m0, m1);
+      new_metrics[2 * j + 1] = _mm512_mask_blend_epi16(decision1, m2, m3);
+
+      d[j] = ((decision_t)decision1 << 32) | decision0;
+    }
+
+    __m512i* tmp = old_metrics;
+    old_metrics  = new_metrics;
+    new_metrics  = tmp;
+  }
+}
+
+#elif defined(LV_HAVE_AVX2)
+
+static void update_viterbi37_batch_avx2(struct v37_batch* vp, uint32_t nbits)
+{
+  const __m256i ones     = _mm256_set1_epi16(-1);
+  const __m256i zero     = _mm256_setzero_si256();
+  const __m256i max_bm   = _mm256_set1_epi16(8191);
+
+  __m256i* old_metrics = (__m256i*)vp->metrics[0];
+  __m256i* new_metrics = (__m256i*)vp->metrics[1];
+
+  for (uint32_t t = 0; t < nbits; t++) {
+    const uint16_t* syms  = &vp->syms[(t % vp->frame_length) * 3 * NOF_LANES];
+    __m256i         sym0v = _mm256_load_si256((__m256i*)&syms[0]);
+    __m256i         sym1v = _mm256_load_si256((__m256i*)&syms[NOF_LANES]);
+    __m256i         sym2v = _mm256_load_si256((__m256i*)&syms[2 * NOF_LANES]);
+
+    /* Form the branch metrics of the 8 possible coded bit patterns */
+    __m256i bm[NOF_PATTERNS], m_bm[NOF_PATTERNS];
+    for (uint32_t p = 0; p < NOF_PATTERNS; p++) {
+      __m256i m0 = _mm256_avg_epu16(_mm256_xor_si256((p & 1) ? ones : zero, sym0v),
+                                    _mm256_xor_si256((p & 2) ? ones : zero, sym1v));
+      __m256i m  = _mm256_avg_epu16(_mm256_xor_si256((p & 4) ? ones : zero, sym2v), m0);
+      bm[p]      = _mm256_srli_epi16(m, 3);
+      m_bm[p]    = _mm256_sub_epi16(max_bm, bm[p]);
+    }
+
+    decision_t* d = &vp->decisions[t * NOF_BUTTERFLIES];
+    for (uint32_t j = 0; j < NOF_BUTTERFLIES; j++) {
+      __m256i metric   = bm[vp->pattern[j]];
+      __m256i m_metric = m_bm[vp->pattern[j]];
+
+      /* Add branch metrics to path metrics */
+      __m256i m0 = _mm256_add_epi16(old_metrics[j], metric);
+      __m256i m1 = _mm256_add_epi16(old_metrics[j + NOF_BUTTERFLIES], m_metric);
+      __m256i m2 = _mm256_add_epi16(old_metrics[j], m_metric);
+      __m256i m3 = _mm256_add_epi16(old_metrics[j + NOF_BUTTERFLIES], metric);
+
+      /* Compare and select, using modulo arithmetic */
+      __m256i decision0 = _mm256_cmpgt_epi16(_mm256_sub_epi16(m0, m1), zero);
+      __m256i decision1 = _mm256_cmpgt_epi16(_mm256_sub_epi16(m2, m3), zero);
+
+      new_metrics[2 * j]     = _mm256_blendv_epi8(m0, m1, decision0);
+      new_metrics[2 * j + 1] = _mm256_blendv_epi8(m2, m3, decision1);
+
+      d[j] = (uint32_t)_mm256_movemask_epi8(_mm256_packs_epi16(decision0, decision1));
+    }
+
+    __m256i* tmp = old_metrics;
+    old_metrics  = new_metrics;
+    new_metrics  = tmp;
+  }
+}
+
+#else /* LV_HAVE_AVX512 */
+
+static void update_viterbi37_batch_gen(struct v37_batch* vp, uint32_t nbits)
+{
+  uint16_t(*old_metrics)[NOF_LANES] = vp->metrics[0];
+  uint16_t(*new_metrics)[NOF_LANES] = vp->metrics[1];
+
+  for (uint32_t t = 0; t < nbits; t++) {
+    const uint16_t* syms = &vp->syms[(t % vp->frame_length) * 3 * NOF_LANES];
+
+    for (uint32_t p = 0; p < NOF_PATTERNS; p++) {
+      for (uint32_t f = 0; f < NOF_LANES; f++) {
+        uint32_t s0     = (uint16_t)(((p & 1) ? 0xffff : 0) ^ syms[f]);
+        uint32_t s1     = (uint16_t)(((p & 2) ? 0xffff : 0) ^ syms[NOF_LANES + f]);
+        uint32_t s2     = (uint16_t)(((p & 4) ? 0xffff : 0) ^ syms[2 * NOF_LANES + f]);
+        uint32_t m0     = (s0 + s1 + 1) >> 1;
+        vp->bm[p][f]    = (uint16_t)(((s2 + m0 + 1) >> 1) >> 3);
+      }
+    }
+
+    decision_t* d = &vp->decisions[t * NOF_BUTTERFLIES];
+    for (uint32_t j = 0; j < NOF_BUTTERFLIES; j++) {
+      const uint16_t* metric = vp->bm[vp->pattern[j]];
+      d[j]                   = 0;
+      for (uint32_t f = 0; f < NOF_LANES; f++) {
+        uint16_t m_metric = (uint16_t)(8191 - metric[f]);
+        uint16_t m0       = (uint16_t)(old_metrics[j][f] + metric[f]);
+        uint16_t m1       = (uint16_t)(old_metrics[j + NOF_BUTTERFLIES][f] + m_metric);
+        uint16_t m2       = (uint16_t)(old_metrics[j][f] + m_metric);
+        uint16_t m3       = (uint16_t)(old_metrics[j + NOF_BUTTERFLIES][f] + metric[f]);
+        uint32_t d0       = (int16_t)(m0 - m1) > 0;
+        uint32_t d1       = (int16_t)(m2 - m3) > 0;
+
+        new_metrics[2 * j][f]     = d0 ? m1 : m0;
+        new_metrics[2 * j + 1][f] = d1 ? m3 : m2;
+        d[j] |= ((decision_t)d0 << v37_batch_bit(f, 0)) | ((decision_t)d1 << v37_batch_bit(f, 1));
+      }
+    }
+
+    uint16_t(*tmp)[NOF_LANES] = old_metrics;
+    old_metrics               = new_metrics;
+    new_metrics               = tmp;
+  }
+}
+
+#endif /* LV_HAVE_AVX512 */
+
+/* Runs nbits trellis steps, wrapping around the loaded frames, and returns the best end state of every lane */
+int update_viterbi37_blk_batch(void* p, uint32_t nbits, uint32_t* best_state)
+{
+  struct v37_batch* vp = p;
+  if (vp == NULL || nbits > vp->len || vp->frame_length == 0) {
+    return -1;
+  }
+
+#ifdef LV_HAVE_AVX512
+  update_viterbi37_batch_avx512(vp, nbits);
+#elif defined(LV_HAVE_AVX2)
+  update_viterbi37_batch_avx2(vp, nbits);
+#else  /* LV_HAVE_AVX512 */
+  update_viterbi37_batch_gen(vp, nbits);
+#endif /* LV_HAVE_AVX512 */
+
+  // The chainback starts 6 bits past the end, those decisions are all zero
+  bzero(&vp->decisions[nbits * NOF_BUTTERFLIES], 6 * NOF_BUTTERFLIES * sizeof(decision_t));
+
+  if (best_state) {
+    uint16_t(*metrics)[NOF_LANES] = vp->metrics[nbits % 2];
+    for (uint32_t f = 0; f < NOF_LANES; f++) {
+      uint32_t bst       = 0;
+      int16_t  minmetric = INT16_MAX;
+      for (uint32_t i = 0; i < NOF_STATES; i++) {
+        int16_t metric = (int16_t)(metrics[i][f] - metrics[0][f]);
+        if (metric <= minmetric) {
+          bst       = i;
+          minmetric = metric;
+        }
+      }
+      best_state[f] = bst;
+    }
+  }
+  return 0;
+}
+
+/* Traces back each of the first nof_frames lanes from its end state and writes the bits [first_bit, first_bit +
+ * frame_length) of the trellis path to data[f] */
+int chainback_viterbi37_batch(void*     p,
+                              uint8_t** data,
+                              uint32_t  nof_frames,
+                              uint32_t  nbits,
+                              uint32_t  first_bit,
+                              uint32_t* endstate)
+{
+  struct v37_batch* vp = p;
+  if (vp == NULL || nof_frames > NOF_LANES || first_bit + vp->frame_length > nbits) {
+    return -1;
+  }
+
+  uint32_t state[NOF_LANES];
+  for (uint32_t f = 0; f < nof_frames; f++) {
+    state[f] = (endstate[f] % 64) << 2;
+  }
+
+  /* The lanes are traced back side by side, their dependency chains are independent */
+  const decision_t* d = &vp->decisions[6 * NOF_BUTTERFLIES]; /* Look past tail */
+  for (uint32_t n = nbits; n-- > first_bit;) {
+    const decision_t* dn = &d[n * NOF_BUTTERFLIES];
+    for (uint32_t f = 0; f < nof_frames; f++) {
+      uint32_t s = state[f] >> 2;
+      uint32_t k = (dn[s / 2] >> v37_batch_bit(f, s % 2)) & 1;
+      state[f]   = (state[f] >> 1) | (k << 7);
+      if (n < first_bit + vp->frame_length) {
+        data[f][n - first_bit] = k;
+      }
+    }
+  }
+  return 0;
+}
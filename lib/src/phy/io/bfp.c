@@ -0,0 +1,257 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "srsran/phy/io/bfp.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/simd.h"
+#include "srsran/phy/utils/vector.h"
+
+#define BFP_BLOCK_FLOATS (2 * SRSRAN_BFP_BLOCK_LEN)
+
+// Keeps 2^-e a normal float for blocks of zeros and denormals
+#define BFP_MIN_EXP (-100)
+
+bool srsran_bfp_valid_bits(uint32_t bits)
+{
+  return bits == 8 || bits == 12;
+}
+
+uint32_t srsran_bfp_nof_bytes(uint32_t nof_samples, uint32_t bits)
+{
+  return nof_samples / SRSRAN_BFP_BLOCK_LEN * SRSRAN_BFP_BLOCK_BYTES(bits);
+}
+
+static inline float bfp_pow2(int e)
+{
+  uint32_t u = (uint32_t)(127 + e) << 23;
+  float    f;
+  memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+/* Smallest e such that max_abs * 2^-e rounds within bits - 1 bits */
+static inline int bfp_exponent(float max_abs, uint32_t bits)
+{
+  uint32_t u;
+  memcpy(&u, &max_abs, sizeof(u));
+  int e = (int)((u >> 23) & 0xff) - 126 - (int)(bits - 1);
+  return e < BFP_MIN_EXP ? BFP_MIN_EXP : e;
+}
+
+static inline void bfp_pack12(const int16_t* m, uint8_t* z)
+{
+  for (uint32_t i = 0; i < BFP_BLOCK_FLOATS; i += 2) {
+    uint32_t v = ((uint32_t)m[i] & 0xfff) | (((uint32_t)m[i + 1] & 0xfff) << 12);
+    z[0]       = (uint8_t)v;
+    z[1]       = (uint8_t)(v >> 8);
+    z[2]       = (uint8_t)(v >> 16);
+    z += 3;
+  }
+}
+
+static inline void bfp_unpack12(const uint8_t* x, int16_t* m)
+{
+  for (uint32_t i = 0; i < BFP_BLOCK_FLOATS; i += 2) {
+    uint32_t v = (uint32_t)x[0] | ((uint32_t)x[1] << 8) | ((uint32_t)x[2] << 16);
+    m[i]       = (int16_t)((int32_t)(v << 20) >> 20);
+    m[i + 1]   = (int16_t)((int32_t)(v << 8) >> 20);
+    x += 3;
+  }
+}
+
+#ifndef LV_HAVE_AVX2
+static void bfp_encode_block_gen(const float* x, uint8_t* z, uint32_t bits)
+{
+  float max_abs = 0.0f;
+  for (uint32_t i = 0; i < BFP_BLOCK_FLOATS; i++) {
+    max_abs = fmaxf(max_abs, fabsf(x[i]));
+  }
+  int     e     = bfp_exponent(max_abs, bits);
+  float   scale = bfp_pow2(-e);
+  int32_t limit = (1 << (bits - 1)) - 1;
+
+  int16_t m[BFP_BLOCK_FLOATS];
+  for (uint32_t i = 0; i < BFP_BLOCK_FLOATS; i++) {
+    int32_t v = (int32_t)lrintf(x[i] * scale);
+    m[i]      = (int16_t)SRSRAN_MAX(-limit, SRSRAN_MIN(limit, v));
+  }
+
+  z[0] = (uint8_t)(int8_t)e;
+  if (bits == 8) {
+    for (uint32_t i = 0; i < BFP_BLOCK_FLOATS; i++) {
+      z[1 + i] = (uint8_t)(int8_t)m[i];
+    }
+  } else {
+    bfp_pack12(m, z + 1);
+  }
+}
+
+static void bfp_decode_block_gen(const uint8_t* x, float* z, uint32_t bits)
+{
+  float scale = bfp_pow2((int8_t)x[0]);
+  if (bits == 8) {
+    for (uint32_t i = 0; i < BFP_BLOCK_FLOATS; i++) {
+      z[i] = (float)(int8_t)x[1 + i] * scale;
+    }
+  } else {
+    int16_t m[BFP_BLOCK_FLOATS];
+    bfp_unpack12(x + 1, m);
+    for (uint32_t i = 0; i < BFP_BLOCK_FLOATS; i++) {
+      z[i] = (float)m[i] * scale;
+    }
+  }
+}
+#else /* LV_HAVE_AVX2 */
+
+static void bfp_encode_block_avx2(const float* x, uint8_t* z, uint32_t bits)
+{
+  __m256 a0 = _mm256_loadu_ps(x);
+  __m256 a1 = _mm256_loadu_ps(x + 8);
+  __m256 a2 = _mm256_loadu_ps(x + 16);
+  __m256 a3 = _mm256_loadu_ps(x + 24);
+
+  // Largest magnitude of the block in every element
+  __m256 sign = _mm256_set1_ps(-0.0f);
+  __m256 m    = _mm256_max_ps(_mm256_max_ps(_mm256_andnot_ps(sign, a0), _mm256_andnot_ps(sign, a1)),
+                           _mm256_max_ps(_mm256_andnot_ps(sign, a2), _mm256_andnot_ps(sign, a3)));
+  m           = _mm256_max_ps(m, _mm256_permute2f128_ps(m, m, 1));
+  m           = _mm256_max_ps(m, _mm256_permute_ps(m, _MM_SHUFFLE(1, 0, 3, 2)));
+  m           = _mm256_max_ps(m, _mm256_permute_ps(m, _MM_SHUFFLE(2, 3, 0, 1)));
+
+  int     e     = bfp_exponent(_mm256_cvtss_f32(m), bits);
+  __m256  scale = _mm256_set1_ps(bfp_pow2(-e));
+  int32_t limit = (1 << (bits - 1)) - 1;
+  __m256i hi    = _mm256_set1_epi32(limit);
+  __m256i lo    = _mm256_set1_epi32(-limit);
+
+  __m256i q0 = _mm256_min_epi32(_mm256_max_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(a0, scale)), lo), hi);
+  __m256i q1 = _mm256_min_epi32(_mm256_max_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(a1, scale)), lo), hi);
+  __m256i q2 = _mm256_min_epi32(_mm256_max_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(a2, scale)), lo), hi);
+  __m256i q3 = _mm256_min_epi32(_mm256_max_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(a3, scale)), lo), hi);
+
+  z[0] = (uint8_t)(int8_t)e;
+
+  // The packs work within 128 bit lanes, the permutes restore the order of the samples
+  __m256i p01 = _mm256_packs_epi32(q0, q1);
+  __m256i p23 = _mm256_packs_epi32(q2, q3);
+  if (bits == 8) {
+    __m256i p = _mm256_packs_epi16(p01, p23);
+    p         = _mm256_permutevar8x32_epi32(p, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+    _mm256_storeu_si256((__m256i*)(z + 1), p);
+  } else {
+    int16_t q[BFP_BLOCK_FLOATS];
+    _mm256_storeu_si256((__m256i*)q, _mm256_permute4x64_epi64(p01, 0xd8));
+    _mm256_storeu_si256((__m256i*)(q + 16), _mm256_permute4x64_epi64(p23, 0xd8));
+    bfp_pack12(q, z + 1);
+  }
+}
+
+static void bfp_decode_block_avx2(const uint8_t* x, float* z, uint32_t bits)
+{
+  __m256  scale = _mm256_set1_ps(bfp_pow2((int8_t)x[0]));
+  __m256i q0, q1, q2, q3;
+  if (bits == 8) {
+    __m128i lo = _mm_loadu_si128((__m128i*)(x + 1));
+    __m128i hi = _mm_loadu_si128((__m128i*)(x + 17));
+    q0         = _mm256_cvtepi8_epi32(lo);
+    q1         = _mm256_cvtepi8_epi32(_mm_srli_si128(lo, 8));
+    q2         = _mm256_cvtepi8_epi32(hi);
+    q3         = _mm256_cvtepi8_epi32(_mm_srli_si128(hi, 8));
+  } else {
+    int16_t m[BFP_BLOCK_FLOATS];
+    bfp_unpack12(x + 1, m);
+    q0 = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i*)m));
+    q1 = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i*)(m + 8)));
+    q2 = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i*)(m + 16)));
+    q3 = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i*)(m + 24)));
+  }
+  _mm256_storeu_ps(z, _mm256_mul_ps(_mm256_cvtepi32_ps(q0), scale));
+  _mm256_storeu_ps(z + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(q1), scale));
+  _mm256_storeu_ps(z + 16, _mm256_mul_ps(_mm256_cvtepi32_ps(q2), scale));
+  _mm256_storeu_ps(z + 24, _mm256_mul_ps(_mm256_cvtepi32_ps(q3), scale));
+}
+#endif /* LV_HAVE_AVX2 */
+
+int srsran_bfp_encode(const cf_t* x, uint8_t* z, uint32_t nof_samples, uint32_t bits)
+{
+  if (x == NULL || z == NULL || !srsran_bfp_valid_bits(bits) || nof_samples % SRSRAN_BFP_BLOCK_LEN != 0) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  const float* xf          = (const float*)x;
+  uint32_t     block_bytes = SRSRAN_BFP_BLOCK_BYTES(bits);
+  for (uint32_t i = 0; i < nof_samples / SRSRAN_BFP_BLOCK_LEN; i++) {
+#ifdef LV_HAVE_AVX2
+    bfp_encode_block_avx2(xf + i * BFP_BLOCK_FLOATS, z + i * block_bytes, bits);
+#else
+    bfp_encode_block_gen(xf + i * BFP_BLOCK_FLOATS, z + i * block_bytes, bits);
+#endif
+  }
+  return (int)srsran_bfp_nof_bytes(nof_samples, bits);
+}
+
+int srsran_bfp_decode(const uint8_t* x, cf_t* z, uint32_t nof_samples, uint32_t bits)
+{
+  if (x == NULL || z == NULL || !srsran_bfp_valid_bits(bits) || nof_samples % SRSRAN_BFP_BLOCK_LEN != 0) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  float*   zf          = (float*)z;
+  uint32_t block_bytes = SRSRAN_BFP_BLOCK_BYTES(bits);
+  for (uint32_t i = 0; i < nof_samples / SRSRAN_BFP_BLOCK_LEN; i++) {
+#ifdef LV_HAVE_AVX2
+    bfp_decode_block_avx2(x + i * block_bytes, zf + i * BFP_BLOCK_FLOATS, bits);
+#else
+    bfp_decode_block_gen(x + i * block_bytes, zf + i * BFP_BLOCK_FLOATS, bits);
+#endif
+  }
+  return (int)srsran_bfp_nof_bytes(nof_samples, bits);
+}
+
+void srsran_bfp_file_header_init(srsran_bfp_file_header_t* h, uint32_t bits)
+{
+  memset(h, 0, sizeof(srsran_bfp_file_header_t));
+  h->magic        = SRSRAN_BFP_FILE_MAGIC;
+  h->version      = SRSRAN_BFP_FILE_VERSION;
+  h->header_size  = sizeof(srsran_bfp_file_header_t);
+  h->bits         = bits;
+  h->block_len    = SRSRAN_BFP_BLOCK_LEN;
+  h->record_len   = SRSRAN_BFP_RECORD_LEN;
+  h->record_bytes = srsran_bfp_nof_bytes(SRSRAN_BFP_RECORD_LEN, bits);
+}
+
+int srsran_bfp_file_header_check(const srsran_bfp_file_header_t* h)
+{
+  if (h->magic != SRSRAN_BFP_FILE_MAGIC) {
+    ERROR("Not a block floating point file\n");
+    return SRSRAN_ERROR;
+  }
+  if (h->version != SRSRAN_BFP_FILE_VERSION || h->header_size < sizeof(srsran_bfp_file_header_t) ||
+      !srsran_bfp_valid_bits(h->bits) || h->block_len != SRSRAN_BFP_BLOCK_LEN || h->record_len == 0 ||
+      h->record_len % SRSRAN_BFP_BLOCK_LEN != 0 || h->record_bytes != srsran_bfp_nof_bytes(h->record_len, h->bits)) {
+    ERROR("Unsupported block floating point file, version %d, %d bits\n", h->version, h->bits);
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
@@ -25,6 +25,77 @@
 #include <strings.h>
 
 #include "srsran/phy/io/filesink.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+static int filesink_init_bfp(srsran_filesink_t* q, uint32_t bits)
+{
+  srsran_bfp_file_header_init(&q->bfp_header, bits);
+  q->bfp_samples = srsran_vec_cf_malloc(q->bfp_header.record_len);
+  q->bfp_record  = srsran_vec_u8_malloc(q->bfp_header.record_bytes);
+  if (q->bfp_samples == NULL || q->bfp_record == NULL) {
+    return SRSRAN_ERROR;
+  }
+
+  // The number of samples is only known when the file is closed
+  if (fwrite(&q->bfp_header, sizeof(srsran_bfp_file_header_t), 1, q->f) != 1) {
+    perror("fwrite");
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+static int filesink_write_record(srsran_filesink_t* q, const cf_t* x)
+{
+  srsran_bfp_encode(x, q->bfp_record, q->bfp_header.record_len, q->bfp_header.bits);
+  if (fwrite(q->bfp_record, q->bfp_header.record_bytes, 1, q->f) != 1) {
+    perror("fwrite");
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+static int filesink_write_bfp(srsran_filesink_t* q, const cf_t* x, uint32_t nsamples)
+{
+  uint32_t record_len = q->bfp_header.record_len;
+  uint32_t count      = 0;
+  while (count < nsamples) {
+    // Whole records are encoded from the input, the others are gathered first
+    const cf_t* record = x + count;
+    uint32_t    n      = SRSRAN_MIN(nsamples - count, record_len - q->bfp_fill);
+    if (n < record_len) {
+      srsran_vec_cf_copy(q->bfp_samples + q->bfp_fill, x + count, n);
+      q->bfp_fill += n;
+      count += n;
+      if (q->bfp_fill < record_len) {
+        break;
+      }
+      record = q->bfp_samples;
+    } else {
+      count += n;
+    }
+    if (filesink_write_record(q, record) < SRSRAN_SUCCESS) {
+      return SRSRAN_ERROR;
+    }
+    q->bfp_fill = 0;
+  }
+  q->bfp_header.nof_samples += nsamples;
+  return (int)nsamples;
+}
+
+static void filesink_close_bfp(srsran_filesink_t* q)
+{
+  if (q->bfp_samples == NULL || q->bfp_record == NULL) {
+    return;
+  }
+  if (q->bfp_fill > 0) {
+    srsran_vec_cf_zero(q->bfp_samples + q->bfp_fill, q->bfp_header.record_len - q->bfp_fill);
+    filesink_write_record(q, q->bfp_samples);
+  }
+  if (fseek(q->f, 0, SEEK_SET) != 0 || fwrite(&q->bfp_header, sizeof(srsran_bfp_file_header_t), 1, q->f) != 1) {
+    perror("srsran_filesink_free");
+  }
+}
 
 int srsran_filesink_init(srsran_filesink_t* q, char* filename, srsran_datatype_t type)
 {
@@ -35,14 +106,29 @@ int srsran_filesink_init(srsran_filesink_t* q, char* filename, srsran_datatype_t
     return -1;
   }
   q->type = type;
+  if (type == SRSRAN_COMPLEX_BFP8_BIN || type == SRSRAN_COMPLEX_BFP12_BIN) {
+    if (filesink_init_bfp(q, type == SRSRAN_COMPLEX_BFP8_BIN ? 8 : 12) < SRSRAN_SUCCESS) {
+      srsran_filesink_free(q);
+      return -1;
+    }
+  }
   return 0;
 }
 
 void srsran_filesink_free(srsran_filesink_t* q)
 {
   if (q->f) {
+    if (q->type == SRSRAN_COMPLEX_BFP8_BIN || q->type == SRSRAN_COMPLEX_BFP12_BIN) {
+      filesink_close_bfp(q);
+    }
     fclose(q->f);
   }
+  if (q->bfp_samples) {
+    free(q->bfp_samples);
+  }
+  if (q->bfp_record) {
+    free(q->bfp_record);
+  }
   bzero(q, sizeof(srsran_filesink_t));
 }
 
@@ -90,6 +176,9 @@ int srsran_filesink_write(srsran_filesink_t* q, void* buffer, int nsamples)
         size = sizeof(_Complex short);
       }
       return fwrite(buffer, size, nsamples, q->f);
+    case SRSRAN_COMPLEX_BFP8_BIN:
+    case SRSRAN_COMPLEX_BFP12_BIN:
+      return filesink_write_bfp(q, cbuf, nsamples);
     default:
       i = -1;
       break;
@@ -149,6 +238,14 @@ int srsran_filesink_write_multi(srsran_filesink_t* q, void** buffer, int nsample
         return fwrite(buffer[0], size, nsamples, q->f);
       }
       break;
+    case SRSRAN_COMPLEX_BFP8_BIN:
+    case SRSRAN_COMPLEX_BFP12_BIN:
+      // One file per channel
+      if (nchannels > 1) {
+        ERROR("%s.%d:Write Mode not implemented\n", __FILE__, __LINE__);
+        return SRSRAN_ERROR;
+      }
+      return filesink_write_bfp(q, cbuf[0], nsamples);
     default:
       i = -1;
       break;
@@ -25,6 +25,72 @@
 
 #include "srsran/phy/io/filesource.h"
 #include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+static bool filesource_is_bfp(srsran_datatype_t type)
+{
+  return type == SRSRAN_COMPLEX_BFP8_BIN || type == SRSRAN_COMPLEX_BFP12_BIN;
+}
+
+static int filesource_init_bfp(srsran_filesource_t* q)
+{
+  srsran_bfp_file_header_t* h = &q->bfp_header;
+  if (fread(h, sizeof(srsran_bfp_file_header_t), 1, q->f) != 1 || srsran_bfp_file_header_check(h) < SRSRAN_SUCCESS) {
+    ERROR("Error reading block floating point header\n");
+    return SRSRAN_ERROR;
+  }
+  q->type = h->bits == 8 ? SRSRAN_COMPLEX_BFP8_BIN : SRSRAN_COMPLEX_BFP12_BIN;
+
+  // Files that were not closed hold their whole records
+  if (h->nof_samples == 0) {
+    if (fseeko(q->f, 0, SEEK_END) != 0) {
+      perror("fseeko");
+      return SRSRAN_ERROR;
+    }
+    off_t size     = ftello(q->f);
+    h->nof_samples = size > h->header_size ? (uint64_t)(size - h->header_size) / h->record_bytes * h->record_len : 0;
+  }
+
+  q->bfp_samples = srsran_vec_cf_malloc(h->record_len);
+  q->bfp_record  = srsran_vec_u8_malloc(h->record_bytes);
+  if (q->bfp_samples == NULL || q->bfp_record == NULL) {
+    return SRSRAN_ERROR;
+  }
+  return srsran_filesource_seek_sample(q, 0);
+}
+
+static int filesource_read_bfp(srsran_filesource_t* q, cf_t* y, uint32_t nsamples)
+{
+  srsran_bfp_file_header_t* h     = &q->bfp_header;
+  uint32_t                  count = 0;
+  while (count < nsamples) {
+    if (q->bfp_pos == q->bfp_len) {
+      uint64_t first = q->bfp_record_idx * h->record_len;
+      if (first >= h->nof_samples || fread(q->bfp_record, h->record_bytes, 1, q->f) != 1) {
+        break;
+      }
+      q->bfp_record_idx++;
+
+      // Whole records are decoded to the output, the others are kept for the next reads
+      uint32_t len = (uint32_t)SRSRAN_MIN(h->record_len, h->nof_samples - first);
+      if (q->bfp_skip == 0 && len == h->record_len && nsamples - count >= len) {
+        srsran_bfp_decode(q->bfp_record, y + count, len, h->bits);
+        count += len;
+        continue;
+      }
+      srsran_bfp_decode(q->bfp_record, q->bfp_samples, h->record_len, h->bits);
+      q->bfp_len  = len;
+      q->bfp_pos  = SRSRAN_MIN(q->bfp_skip, len);
+      q->bfp_skip = 0;
+      continue;
+    }
+    uint32_t n = SRSRAN_MIN(nsamples - count, q->bfp_len - q->bfp_pos);
+    srsran_vec_cf_copy(y + count, q->bfp_samples + q->bfp_pos, n);
+    q->bfp_pos += n;
+    count += n;
+  }
+  return (int)count;
+}
 
 int srsran_filesource_init(srsran_filesource_t* q, char* filename, srsran_datatype_t type)
 {
@@ -35,6 +101,10 @@ int srsran_filesource_init(srsran_filesource_t* q, char* filename, srsran_dataty
     return -1;
   }
   q->type = type;
+  if (filesource_is_bfp(type) && filesource_init_bfp(q) < SRSRAN_SUCCESS) {
+    srsran_filesource_free(q);
+    return -1;
+  }
   return 0;
 }
 
@@ -43,16 +113,57 @@ void srsran_filesource_free(srsran_filesource_t* q)
   if (q->f) {
     fclose(q->f);
   }
+  if (q->bfp_samples) {
+    free(q->bfp_samples);
+  }
+  if (q->bfp_record) {
+    free(q->bfp_record);
+  }
   bzero(q, sizeof(srsran_filesource_t));
 }
 
 void srsran_filesource_seek(srsran_filesource_t* q, int pos)
 {
-  if (fseek(q->f, pos, SEEK_SET) != 0) {
+  if (filesource_is_bfp(q->type)) {
+    srsran_filesource_seek_sample(q, (uint64_t)pos / sizeof(cf_t));
+  } else if (fseek(q->f, pos, SEEK_SET) != 0) {
     perror("srsran_filesource_seek");
   }
 }
 
+int srsran_filesource_seek_sample(srsran_filesource_t* q, uint64_t sample)
+{
+  off_t offset = 0;
+  switch (q->type) {
+    case SRSRAN_FLOAT_BIN:
+      offset = (off_t)(sample * sizeof(float));
+      break;
+    case SRSRAN_COMPLEX_FLOAT_BIN:
+      offset = (off_t)(sample * sizeof(cf_t));
+      break;
+    case SRSRAN_COMPLEX_SHORT_BIN:
+      offset = (off_t)(sample * sizeof(_Complex short));
+      break;
+    case SRSRAN_COMPLEX_BFP8_BIN:
+    case SRSRAN_COMPLEX_BFP12_BIN:
+      // Records have a fixed size, the one holding the sample is decoded at the next read
+      q->bfp_record_idx = sample / q->bfp_header.record_len;
+      q->bfp_skip       = (uint32_t)(sample % q->bfp_header.record_len);
+      q->bfp_pos        = 0;
+      q->bfp_len        = 0;
+      offset            = (off_t)(q->bfp_header.header_size + q->bfp_record_idx * q->bfp_header.record_bytes);
+      break;
+    default:
+      ERROR("Seeking a sample of a text file is not supported\n");
+      return SRSRAN_ERROR;
+  }
+  if (fseeko(q->f, offset, SEEK_SET) != 0) {
+    perror("srsran_filesource_seek_sample");
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
 int read_complex_f(FILE* f, _Complex float* y)
 {
   char           in_str[64];
@@ -111,6 +222,9 @@ int srsran_filesource_read(srsran_filesource_t* q, void* buffer, int nsamples)
       }
       return fread(buffer, size, nsamples, q->f);
       break;
+    case SRSRAN_COMPLEX_BFP8_BIN:
+    case SRSRAN_COMPLEX_BFP12_BIN:
+      return filesource_read_bfp(q, cbuf, nsamples);
     default:
       i = -1;
       break;
@@ -129,6 +243,8 @@ int srsran_filesource_read_multi(srsran_filesource_t* q, void** buffer, int nsam
     case SRSRAN_COMPLEX_SHORT:
     case SRSRAN_FLOAT_BIN:
     case SRSRAN_COMPLEX_SHORT_BIN:
+    case SRSRAN_COMPLEX_BFP8_BIN:
+    case SRSRAN_COMPLEX_BFP12_BIN:
       ERROR("%s.%d:Read Mode not implemented\n", __FILE__, __LINE__);
       count = SRSRAN_ERROR;
       break;
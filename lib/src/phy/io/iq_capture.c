@@ -0,0 +1,562 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/io/bfp.h"
+#include "srsran/phy/io/iq_capture.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+// Alignment of buffers, lengths and file offsets in O_DIRECT writes, a multiple of every logical block size
+#define IQ_CAPTURE_DIO_ALIGN 4096
+
+// Staging of the samples that are not aligned in memory, per antenna
+#define IQ_CAPTURE_BOUNCE_SIZE (1024 * 1024)
+
+// Subframes written at once, and committed subframes between two wake ups of the writer
+#define IQ_CAPTURE_CHUNK_SF 64
+
+// Time constant of the long term SCI average, and subframes before the SCI rule is armed
+#define IQ_CAPTURE_SCI_AVG_SF 10000
+#define IQ_CAPTURE_SCI_WARMUP_SF 1000
+
+static const char* reason_names[SRSRAN_IQ_CAPTURE_NOF_REASONS] = {"manual", "crc_burst", "sci_spike", "sync_loss"};
+
+/* Output file of one antenna */
+typedef struct {
+  int      fd;
+  bool     direct;
+  uint8_t* bounce;
+  uint32_t fill;
+  uint64_t offset;
+} dio_file_t;
+
+void srsran_iq_capture_cfg_default(srsran_iq_capture_cfg_t* cfg)
+{
+  bzero(cfg, sizeof(srsran_iq_capture_cfg_t));
+  cfg->nof_ports           = 1;
+  cfg->history_sf          = 4000;
+  cfg->pre_sf              = 500;
+  cfg->post_sf             = 500;
+  cfg->rules.window_sf     = 100;
+  cfg->rules.sci_spike_min = 10;
+}
+
+int srsran_iq_capture_cfg_parse(srsran_iq_capture_cfg_t* cfg, const char* spec)
+{
+  char  buffer[256];
+  char* save_ptr = NULL;
+  if (cfg == NULL || spec == NULL || strlen(spec) >= sizeof(buffer)) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  strcpy(buffer, spec);
+
+  for (char* key = strtok_r(buffer, ",", &save_ptr); key != NULL; key = strtok_r(NULL, ",", &save_ptr)) {
+    char* value = strchr(key, '=');
+    if (value != NULL) {
+      *value++ = '\0';
+    }
+    if (strcmp(key, "sync") == 0 && value == NULL) {
+      cfg->rules.sync_loss = true;
+      continue;
+    }
+    if (value == NULL) {
+      ERROR("Missing value of IQ capture option %s\n", key);
+      return SRSRAN_ERROR;
+    }
+    if (strcmp(key, "history") == 0) {
+      cfg->history_sf = (uint32_t)(strtof(value, NULL) * 1000);
+    } else if (strcmp(key, "pre") == 0) {
+      cfg->pre_sf = (uint32_t)strtol(value, NULL, 10);
+    } else if (strcmp(key, "post") == 0) {
+      cfg->post_sf = (uint32_t)strtol(value, NULL, 10);
+    } else if (strcmp(key, "win") == 0) {
+      cfg->rules.window_sf = (uint32_t)strtol(value, NULL, 10);
+    } else if (strcmp(key, "crc") == 0) {
+      cfg->rules.crc_fail_burst = (uint32_t)strtol(value, NULL, 10);
+    } else if (strcmp(key, "sci") == 0) {
+      cfg->rules.sci_spike = strtof(value, NULL);
+    } else if (strcmp(key, "scimin") == 0) {
+      cfg->rules.sci_spike_min = (uint32_t)strtol(value, NULL, 10);
+    } else if (strcmp(key, "bfp") == 0) {
+      cfg->bfp_bits = (uint32_t)strtol(value, NULL, 10);
+    } else {
+      ERROR("Unknown IQ capture option %s\n", key);
+      return SRSRAN_ERROR;
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+static void* iq_capture_writer(void* arg);
+
+int srsran_iq_capture_init(srsran_iq_capture_t* q, const srsran_iq_capture_cfg_t* cfg, const char* prefix)
+{
+  if (q == NULL || cfg == NULL || prefix == NULL || cfg->nof_ports == 0 || cfg->nof_ports > SRSRAN_MAX_PORTS ||
+      cfg->sf_len == 0 || cfg->rules.window_sf == 0 || strlen(prefix) >= SRSRAN_IQ_CAPTURE_MAX_PREFIX) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  // The oldest subframe of the window must survive the one being received
+  if (cfg->pre_sf + 2 > cfg->history_sf) {
+    ERROR("IQ capture history of %d subframes cannot hold %d subframes before the trigger\n",
+          cfg->history_sf,
+          cfg->pre_sf);
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  // Every subframe is a whole number of records, the files can be cut anywhere between subframes
+  if (cfg->bfp_bits != 0 && (!srsran_bfp_valid_bits(cfg->bfp_bits) || cfg->sf_len % SRSRAN_BFP_RECORD_LEN != 0)) {
+    ERROR("IQ capture cannot write %d bit block floating point subframes of %d samples\n", cfg->bfp_bits, cfg->sf_len);
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  bzero(q, sizeof(srsran_iq_capture_t));
+  q->cfg = *cfg;
+  strcpy(q->prefix, prefix);
+
+  // Aligned for O_DIRECT, and touched now so that the first seconds of reception do not take the page faults
+  size_t ring_size = sizeof(cf_t) * (size_t)cfg->sf_len * cfg->history_sf;
+  for (uint32_t p = 0; p < cfg->nof_ports; p++) {
+    if (posix_memalign((void**)&q->ring[p], IQ_CAPTURE_DIO_ALIGN, ring_size)) {
+      q->ring[p] = NULL;
+      perror("posix_memalign");
+      goto clean_exit;
+    }
+    memset(q->ring[p], 0, ring_size);
+  }
+  if (posix_memalign((void**)&q->bounce, IQ_CAPTURE_DIO_ALIGN, (size_t)IQ_CAPTURE_BOUNCE_SIZE * cfg->nof_ports)) {
+    q->bounce = NULL;
+    perror("posix_memalign");
+    goto clean_exit;
+  }
+  if (cfg->bfp_bits != 0) {
+    q->encoded = srsran_vec_u8_malloc(srsran_bfp_nof_bytes(IQ_CAPTURE_CHUNK_SF * cfg->sf_len, cfg->bfp_bits));
+    if (q->encoded == NULL) {
+      goto clean_exit;
+    }
+  }
+  q->slot_time = calloc(cfg->history_sf, sizeof(srsran_timestamp_t));
+  q->sci_hist  = calloc(cfg->rules.window_sf, sizeof(uint16_t));
+  q->crc_hist  = calloc(cfg->rules.window_sf, sizeof(uint16_t));
+  if (!q->slot_time || !q->sci_hist || !q->crc_hist) {
+    perror("calloc");
+    goto clean_exit;
+  }
+
+  if (sem_init(&q->sem, 0, 0)) {
+    perror("sem_init");
+    goto clean_exit;
+  }
+  if (pthread_create(&q->thread, NULL, iq_capture_writer, q)) {
+    perror("pthread_create");
+    sem_destroy(&q->sem);
+    goto clean_exit;
+  }
+  q->thread_running = true;
+  return SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_iq_capture_free(q);
+  return SRSRAN_ERROR;
+}
+
+void srsran_iq_capture_stop(srsran_iq_capture_t* q)
+{
+  if (q != NULL && q->thread_running) {
+    __atomic_store_n(&q->stop, true, __ATOMIC_RELEASE);
+    sem_post(&q->sem);
+    pthread_join(q->thread, NULL);
+    sem_destroy(&q->sem);
+    q->thread_running = false;
+  }
+}
+
+void srsran_iq_capture_free(srsran_iq_capture_t* q)
+{
+  if (q == NULL) {
+    return;
+  }
+  srsran_iq_capture_stop(q);
+  for (uint32_t p = 0; p < SRSRAN_MAX_PORTS; p++) {
+    free(q->ring[p]);
+  }
+  free(q->bounce);
+  free(q->encoded);
+  free(q->slot_time);
+  free(q->sci_hist);
+  free(q->crc_hist);
+  bzero(q, sizeof(srsran_iq_capture_t));
+}
+
+cf_t* srsran_iq_capture_slot(srsran_iq_capture_t* q, uint32_t port)
+{
+  return &q->ring[port][(q->write_idx % q->cfg.history_sf) * q->cfg.sf_len];
+}
+
+cf_t* srsran_iq_capture_last(srsran_iq_capture_t* q, uint32_t port)
+{
+  return &q->ring[port][((q->write_idx + q->cfg.history_sf - 1) % q->cfg.history_sf) * q->cfg.sf_len];
+}
+
+void srsran_iq_capture_trigger(srsran_iq_capture_t* q)
+{
+  q->manual = 1;
+}
+
+/* Queues the window around subframe n, the last committed one */
+static void iq_capture_start(srsran_iq_capture_t* q, uint64_t n, srsran_iq_capture_reason_t reason)
+{
+  __atomic_fetch_add(&q->stats.nof_triggers[reason], 1, __ATOMIC_RELAXED);
+  if (n < q->capture_end) {
+    __atomic_fetch_add(&q->stats.nof_suppressed, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  if (q->queue_tail - __atomic_load_n(&q->queue_head, __ATOMIC_ACQUIRE) == SRSRAN_IQ_CAPTURE_MAX_QUEUE) {
+    __atomic_fetch_add(&q->stats.nof_dropped, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  // The subframes older than the one received next are still in the ring
+  uint64_t oldest = (n + 2 > q->cfg.history_sf) ? n + 2 - q->cfg.history_sf : 0;
+
+  srsran_iq_capture_job_t* job = &q->queue[q->queue_tail % SRSRAN_IQ_CAPTURE_MAX_QUEUE];
+  job->id                      = q->nof_jobs++;
+  job->trigger_sf              = n;
+  job->first_sf                = SRSRAN_MAX(n - SRSRAN_MIN(n, q->cfg.pre_sf), oldest);
+  job->end_sf                  = n + 1 + q->cfg.post_sf;
+  job->reason                  = reason;
+  q->capture_end               = job->end_sf;
+  __atomic_store_n(&q->queue_tail, q->queue_tail + 1, __ATOMIC_RELEASE);
+  sem_post(&q->sem);
+}
+
+/* Adds the counts of subframe n to a rule window and returns the new sum */
+static uint32_t window_add(uint16_t* hist, uint32_t* sum, uint32_t window_sf, uint64_t n, uint32_t count)
+{
+  uint16_t* h = &hist[n % window_sf];
+  count       = SRSRAN_MIN(count, UINT16_MAX);
+  *sum        = *sum - *h + count;
+  *h          = (uint16_t)count;
+  return *sum;
+}
+
+void srsran_iq_capture_commit(srsran_iq_capture_t* q, const srsran_timestamp_t* t, const srsran_iq_capture_sf_stats_t* s)
+{
+  const srsran_iq_capture_rules_t* rules = &q->cfg.rules;
+
+  // Publishes the subframe, its samples are already in the ring
+  uint64_t n                             = q->write_idx;
+  q->slot_time[n % q->cfg.history_sf] = t ? *t : (srsran_timestamp_t){};
+  __atomic_store_n(&q->write_idx, n + 1, __ATOMIC_RELEASE);
+
+  // Every rule triggers when its condition starts to hold
+  uint32_t crc_before = q->crc_window;
+  uint32_t sci_before = q->sci_window;
+  double   sci_limit  = rules->sci_spike * q->sci_avg * rules->window_sf;
+  uint32_t crc        = window_add(q->crc_hist, &q->crc_window, rules->window_sf, n, s->nof_crc_fail);
+  uint32_t sci        = window_add(q->sci_hist, &q->sci_window, rules->window_sf, n, s->nof_sci);
+  q->sci_avg += (s->nof_sci - q->sci_avg) * SRSRAN_MAX(1.0 / (n + 1), 1.0 / IQ_CAPTURE_SCI_AVG_SF);
+
+  if (q->manual) {
+    q->manual = 0;
+    iq_capture_start(q, n, SRSRAN_IQ_CAPTURE_MANUAL);
+  }
+  if (rules->crc_fail_burst > 0 && crc >= rules->crc_fail_burst && crc_before < rules->crc_fail_burst) {
+    iq_capture_start(q, n, SRSRAN_IQ_CAPTURE_CRC_BURST);
+  }
+  if (rules->sci_spike > 0 && n >= IQ_CAPTURE_SCI_WARMUP_SF && sci >= rules->sci_spike_min && sci > sci_limit &&
+      !(sci_before >= rules->sci_spike_min && sci_before > sci_limit)) {
+    iq_capture_start(q, n, SRSRAN_IQ_CAPTURE_SCI_SPIKE);
+  }
+  if (rules->sync_loss && q->synced && !s->synced) {
+    iq_capture_start(q, n, SRSRAN_IQ_CAPTURE_SYNC_LOSS);
+  }
+  q->synced = s->synced;
+
+  // The writer follows the windows being received a chunk at a time
+  if (n < q->capture_end && ((n + 1) % IQ_CAPTURE_CHUNK_SF == 0 || n + 1 == q->capture_end)) {
+    sem_post(&q->sem);
+  }
+}
+
+static int dio_write_all(dio_file_t* f, const uint8_t* data, size_t len)
+{
+  while (len > 0) {
+    ssize_t n = pwrite(f->fd, data, len, (off_t)f->offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    // Some file systems accept O_DIRECT when opening and refuse it when writing
+    if (n < 0 && errno == EINVAL && f->direct) {
+      f->direct = false;
+      fcntl(f->fd, F_SETFL, fcntl(f->fd, F_GETFL) & ~O_DIRECT);
+      continue;
+    }
+    if (n <= 0) {
+      perror("pwrite");
+      return SRSRAN_ERROR;
+    }
+    data += n;
+    len -= n;
+    f->offset += n;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+/* Writes straight from the ring whenever the samples are aligned, through the staging buffer otherwise */
+static int dio_write(dio_file_t* f, const uint8_t* data, size_t len)
+{
+  while (len > 0) {
+    if (f->fill == 0 && len >= IQ_CAPTURE_DIO_ALIGN && ((uintptr_t)data & (IQ_CAPTURE_DIO_ALIGN - 1)) == 0) {
+      size_t n = len & ~(size_t)(IQ_CAPTURE_DIO_ALIGN - 1);
+      if (dio_write_all(f, data, n)) {
+        return SRSRAN_ERROR;
+      }
+      data += n;
+      len -= n;
+      continue;
+    }
+    size_t n = SRSRAN_MIN(len, IQ_CAPTURE_BOUNCE_SIZE - f->fill);
+    memcpy(&f->bounce[f->fill], data, n);
+    f->fill += n;
+    data += n;
+    len -= n;
+    if (f->fill == IQ_CAPTURE_BOUNCE_SIZE) {
+      if (dio_write_all(f, f->bounce, IQ_CAPTURE_BOUNCE_SIZE)) {
+        return SRSRAN_ERROR;
+      }
+      f->fill = 0;
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+/* Writes the staged samples padded to a whole block and cuts the file at len bytes */
+static int dio_close(dio_file_t* f, uint64_t len)
+{
+  int ret = SRSRAN_SUCCESS;
+  if (f->fill > 0) {
+    uint32_t padded = (f->fill + IQ_CAPTURE_DIO_ALIGN - 1) & ~(uint32_t)(IQ_CAPTURE_DIO_ALIGN - 1);
+    ret             = dio_write_all(f, f->bounce, padded);
+  }
+  if (ftruncate(f->fd, (off_t)len) < 0) {
+    perror("ftruncate");
+    ret = SRSRAN_ERROR;
+  }
+  close(f->fd);
+  return ret;
+}
+
+static void iq_capture_describe(srsran_iq_capture_t*           q,
+                                const srsran_iq_capture_job_t* job,
+                                const srsran_timestamp_t*      t,
+                                uint64_t                       nof_sf,
+                                bool                           overrun,
+                                bool                           truncated)
+{
+  char path[SRSRAN_IQ_CAPTURE_MAX_PREFIX + 32];
+  snprintf(path, sizeof(path), "%s_%" PRIu64 ".txt", q->prefix, job->id);
+  FILE* f = fopen(path, "w");
+  if (f == NULL) {
+    perror("fopen");
+    return;
+  }
+  fprintf(f, "reason=%s\n", reason_names[job->reason]);
+  fprintf(f, "trigger_sf=%" PRIu64 "\n", job->trigger_sf - job->first_sf);
+  fprintf(f, "nof_sf=%" PRIu64 "\n", nof_sf);
+  fprintf(f, "sf_len=%d\n", q->cfg.sf_len);
+  fprintf(f, "nof_ports=%d\n", q->cfg.nof_ports);
+  fprintf(f, "srate=%.0f\n", q->cfg.srate);
+  fprintf(f, "bfp_bits=%d\n", q->cfg.bfp_bits);
+  fprintf(f, "full_secs=%ld\n", (long)t->full_secs);
+  fprintf(f, "frac_secs=%.9f\n", t->frac_secs);
+  fprintf(f, "sf_idx=%d\n", (uint32_t)(llround(srsran_timestamp_real(t) * 1e3) % SRSRAN_NOF_SF_X_FRAME));
+  fprintf(f, "overrun=%d\n", overrun);
+  fprintf(f, "truncated=%d\n", truncated);
+  fclose(f);
+}
+
+static void iq_capture_write_job(srsran_iq_capture_t* q, const srsran_iq_capture_job_t* job)
+{
+  uint32_t   history = q->cfg.history_sf;
+  uint32_t   bits    = q->cfg.bfp_bits;
+  size_t     sf_size = bits ? srsran_bfp_nof_bytes(q->cfg.sf_len, bits) : sizeof(cf_t) * q->cfg.sf_len;
+  dio_file_t files[SRSRAN_MAX_PORTS];
+  uint32_t   nof_files = 0;
+  bool       failed    = false;
+  uint64_t   usec      = 0;
+
+  // The number of samples is left out of the header, readers take the records in the file
+  srsran_bfp_file_header_t header      = {};
+  size_t                   header_size = 0;
+  if (bits) {
+    srsran_bfp_file_header_init(&header, bits);
+    header_size = sizeof(srsran_bfp_file_header_t);
+  }
+
+  for (; nof_files < q->cfg.nof_ports; nof_files++) {
+    char path[SRSRAN_IQ_CAPTURE_MAX_PREFIX + 32];
+    snprintf(path, sizeof(path), "%s_%" PRIu64 "_%d.%s", q->prefix, job->id, nof_files, bits ? "bfp" : "fc32");
+    dio_file_t* f = &files[nof_files];
+    bzero(f, sizeof(dio_file_t));
+    f->bounce = &q->bounce[(size_t)nof_files * IQ_CAPTURE_BOUNCE_SIZE];
+    f->direct = true;
+    f->fd     = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    if (f->fd < 0 && errno == EINVAL) {
+      f->direct = false;
+      f->fd     = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    if (f->fd < 0) {
+      perror("open");
+      failed = true;
+      break;
+    }
+    if (bits && dio_write(f, (uint8_t*)&header, header_size)) {
+      failed = true;
+      nof_files++;
+      break;
+    }
+  }
+
+  srsran_timestamp_t t         = {};
+  uint64_t           next      = job->first_sf;
+  uint64_t           end       = job->end_sf;
+  bool               overrun   = false;
+  bool               truncated = false;
+  while (!failed && next < end) {
+    uint64_t avail = __atomic_load_n(&q->write_idx, __ATOMIC_ACQUIRE);
+    if (avail >= next + history) {
+      overrun = true;
+      break;
+    }
+    if (avail <= next) {
+      if (__atomic_load_n(&q->stop, __ATOMIC_ACQUIRE)) {
+        truncated = true;
+        break;
+      }
+      sem_wait(&q->sem);
+      continue;
+    }
+
+    uint32_t n = (uint32_t)SRSRAN_MIN(SRSRAN_MIN(avail, end) - next, IQ_CAPTURE_CHUNK_SF);
+    n          = SRSRAN_MIN(n, history - next % history);
+    if (next == job->first_sf) {
+      t = q->slot_time[next % history];
+    }
+    struct timeval tv[3];
+    gettimeofday(&tv[1], NULL);
+    for (uint32_t p = 0; p < nof_files && !failed; p++) {
+      const cf_t* samples = &q->ring[p][(next % history) * q->cfg.sf_len];
+      if (bits) {
+        srsran_bfp_encode(samples, q->encoded, n * q->cfg.sf_len, bits);
+        failed = dio_write(&files[p], q->encoded, n * sf_size) != 0;
+      } else {
+        failed = dio_write(&files[p], (const uint8_t*)samples, n * sf_size) != 0;
+      }
+    }
+    gettimeofday(&tv[2], NULL);
+    get_time_interval(tv);
+    usec += tv[0].tv_sec * 1000000 + tv[0].tv_usec;
+
+    // The receiver may have lapped the writer while it was copying, the chunk is lost then
+    if (__atomic_load_n(&q->write_idx, __ATOMIC_ACQUIRE) >= next + history) {
+      overrun = true;
+      break;
+    }
+    next += n;
+  }
+
+  uint64_t nof_sf = next - job->first_sf;
+  for (uint32_t p = 0; p < nof_files; p++) {
+    failed |= dio_close(&files[p], header_size + nof_sf * sf_size) != 0;
+  }
+  iq_capture_describe(q, job, &t, nof_sf, overrun, truncated);
+
+  // Time spent writing, not waiting for the subframes after the trigger
+  srsran_iq_capture_stats_t* s = &q->stats;
+  __atomic_fetch_add(&s->bytes_written, (header_size + nof_sf * sf_size) * nof_files, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&s->write_usec, usec, __ATOMIC_RELAXED);
+  __atomic_fetch_add(overrun ? &s->nof_overrun : truncated ? &s->nof_truncated : &s->nof_captures, 1, __ATOMIC_RELAXED);
+  if (failed) {
+    ERROR("Error writing IQ capture %s_%" PRIu64 "\n", q->prefix, job->id);
+  }
+}
+
+static void* iq_capture_writer(void* arg)
+{
+  srsran_iq_capture_t* q = (srsran_iq_capture_t*)arg;
+
+  while (true) {
+    uint64_t head = q->queue_head;
+    if (head == __atomic_load_n(&q->queue_tail, __ATOMIC_ACQUIRE)) {
+      if (__atomic_load_n(&q->stop, __ATOMIC_ACQUIRE)) {
+        break;
+      }
+      sem_wait(&q->sem);
+      continue;
+    }
+    iq_capture_write_job(q, &q->queue[head % SRSRAN_IQ_CAPTURE_MAX_QUEUE]);
+    __atomic_store_n(&q->queue_head, head + 1, __ATOMIC_RELEASE);
+  }
+  return NULL;
+}
+
+void srsran_iq_capture_get_stats(srsran_iq_capture_t* q, srsran_iq_capture_stats_t* stats)
+{
+  uint64_t* src = (uint64_t*)&q->stats;
+  uint64_t* dst = (uint64_t*)stats;
+  for (uint32_t i = 0; i < sizeof(srsran_iq_capture_stats_t) / sizeof(uint64_t); i++) {
+    dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+  }
+}
+
+void srsran_iq_capture_fprint_stats(FILE* f, srsran_iq_capture_t* q)
+{
+  srsran_iq_capture_stats_t s;
+  srsran_iq_capture_get_stats(q, &s);
+
+  fprintf(f, "IQ capture: triggers");
+  for (uint32_t i = 0; i < SRSRAN_IQ_CAPTURE_NOF_REASONS; i++) {
+    fprintf(f, " %s=%" PRIu64, reason_names[i], s.nof_triggers[i]);
+  }
+  fprintf(f,
+          ", %" PRIu64 " captures, %" PRIu64 " suppressed, %" PRIu64 " dropped, %" PRIu64 " overrun, %" PRIu64
+          " truncated, %.1f MB written at %.1f MB/s\n",
+          s.nof_captures,
+          s.nof_suppressed,
+          s.nof_dropped,
+          s.nof_overrun,
+          s.nof_truncated,
+          s.bytes_written / 1e6,
+          s.write_usec ? (double)s.bytes_written / s.write_usec : 0.0);
+}
+
+const char* srsran_iq_capture_reason_string(srsran_iq_capture_reason_t reason)
+{
+  return reason < SRSRAN_IQ_CAPTURE_NOF_REASONS ? reason_names[reason] : "unknown";
+}
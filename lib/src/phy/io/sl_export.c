@@ -0,0 +1,247 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "srsran/phy/io/sl_export.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+// The layout is shared with other processes, it must not depend on the compiler
+_Static_assert(sizeof(srsran_sl_export_header_t) == SRSRAN_SL_EXPORT_HEADER_SIZE, "Unexpected export header size");
+_Static_assert(sizeof(srsran_sl_export_record_t) == 64, "Unexpected export record size");
+_Static_assert(__builtin_offsetof(srsran_sl_export_header_t, write_idx) == 64, "Unexpected write index offset");
+
+#define SL_EXPORT_ALIGN 64
+
+static srsran_sl_export_record_t* sl_export_slot(uint8_t* map, const srsran_sl_export_header_t* h, uint64_t idx)
+{
+  return (srsran_sl_export_record_t*)(map + h->header_size + (idx & (h->nof_records - 1)) * h->record_size);
+}
+
+int srsran_sl_export_init(srsran_sl_export_t* q, const char* path, uint32_t nof_records, uint32_t max_tb_bytes)
+{
+  if (q == NULL || path == NULL || nof_records == 0 || nof_records > (1U << 31)) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  bzero(q, sizeof(srsran_sl_export_t));
+
+  uint32_t nof_slots = 1;
+  while (nof_slots < nof_records) {
+    nof_slots <<= 1;
+  }
+  uint32_t record_size = sizeof(srsran_sl_export_record_t) + max_tb_bytes;
+  record_size          = (record_size + SL_EXPORT_ALIGN - 1) / SL_EXPORT_ALIGN * SL_EXPORT_ALIGN;
+  q->map_size          = SRSRAN_SL_EXPORT_HEADER_SIZE + (uint64_t)nof_slots * record_size;
+
+  q->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (q->fd < 0) {
+    perror("open");
+    return SRSRAN_ERROR;
+  }
+  if (ftruncate(q->fd, (off_t)q->map_size) < 0) {
+    perror("ftruncate");
+    goto clean_exit;
+  }
+  q->map = mmap(NULL, q->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, q->fd, 0);
+  if (q->map == MAP_FAILED) {
+    perror("mmap");
+    q->map = NULL;
+    goto clean_exit;
+  }
+
+  // The file is zero filled: every seq is 0 and no record is valid yet
+  q->header               = (srsran_sl_export_header_t*)q->map;
+  q->header->version      = SRSRAN_SL_EXPORT_VERSION;
+  q->header->header_size  = SRSRAN_SL_EXPORT_HEADER_SIZE;
+  q->header->record_size  = record_size;
+  q->header->nof_records  = nof_slots;
+  q->header->max_tb_bytes = record_size - sizeof(srsran_sl_export_record_t);
+  __atomic_store_n(&q->header->magic, SRSRAN_SL_EXPORT_MAGIC, __ATOMIC_RELEASE);
+
+  return SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_sl_export_free(q);
+  return SRSRAN_ERROR;
+}
+
+void srsran_sl_export_free(srsran_sl_export_t* q)
+{
+  if (q == NULL) {
+    return;
+  }
+  if (q->map) {
+    munmap(q->map, q->map_size);
+  }
+  if (q->fd > 0) {
+    close(q->fd);
+  }
+  bzero(q, sizeof(srsran_sl_export_t));
+}
+
+srsran_sl_export_record_t* srsran_sl_export_begin(srsran_sl_export_t* q, uint8_t** tb)
+{
+  if (q == NULL || q->map == NULL) {
+    return NULL;
+  }
+  srsran_sl_export_record_t* record = sl_export_slot(q->map, q->header, q->write_idx);
+
+  // Readers that copy the slot from here on see an odd seq and drop it
+  __atomic_store_n(&record->seq, 2 * q->write_idx + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  if (tb) {
+    *tb = (uint8_t*)(record + 1);
+  }
+  return record;
+}
+
+void srsran_sl_export_commit(srsran_sl_export_t* q)
+{
+  if (q == NULL || q->map == NULL) {
+    return;
+  }
+  srsran_sl_export_record_t* record = sl_export_slot(q->map, q->header, q->write_idx);
+
+  // seq is part of the record, the caller may have overwritten it
+  __atomic_store_n(&record->seq, 2 * q->write_idx + 2, __ATOMIC_RELEASE);
+  q->write_idx++;
+  __atomic_store_n(&q->header->write_idx, q->write_idx, __ATOMIC_RELEASE);
+}
+
+int srsran_sl_export_reader_init(srsran_sl_export_reader_t* q, const char* path)
+{
+  if (q == NULL || path == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  bzero(q, sizeof(srsran_sl_export_reader_t));
+
+  q->fd = open(path, O_RDONLY);
+  if (q->fd < 0) {
+    perror("open");
+    return SRSRAN_ERROR;
+  }
+
+  struct stat st = {};
+  if (fstat(q->fd, &st) < 0) {
+    perror("fstat");
+    goto clean_exit;
+  }
+  if (st.st_size < SRSRAN_SL_EXPORT_HEADER_SIZE) {
+    ERROR("%s is not a sidelink export ring\n", path);
+    goto clean_exit;
+  }
+  q->map_size = (uint64_t)st.st_size;
+  q->map      = mmap(NULL, q->map_size, PROT_READ, MAP_SHARED, q->fd, 0);
+  if (q->map == MAP_FAILED) {
+    perror("mmap");
+    q->map = NULL;
+    goto clean_exit;
+  }
+
+  const srsran_sl_export_header_t* h = (const srsran_sl_export_header_t*)q->map;
+  if (__atomic_load_n(&h->magic, __ATOMIC_ACQUIRE) != SRSRAN_SL_EXPORT_MAGIC ||
+      h->version != SRSRAN_SL_EXPORT_VERSION) {
+    ERROR("%s is not a version %d sidelink export ring\n", path, SRSRAN_SL_EXPORT_VERSION);
+    goto clean_exit;
+  }
+  if (h->header_size < SRSRAN_SL_EXPORT_HEADER_SIZE || h->nof_records == 0 ||
+      (h->nof_records & (h->nof_records - 1)) != 0 ||
+      h->record_size < sizeof(srsran_sl_export_record_t) + h->max_tb_bytes ||
+      h->header_size + (uint64_t)h->nof_records * h->record_size > q->map_size) {
+    ERROR("Invalid sidelink export ring layout in %s\n", path);
+    goto clean_exit;
+  }
+  q->header = h;
+
+  uint64_t write_idx = __atomic_load_n(&h->write_idx, __ATOMIC_ACQUIRE);
+  q->read_idx        = write_idx > h->nof_records ? write_idx - h->nof_records : 0;
+
+  return SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_sl_export_reader_free(q);
+  return SRSRAN_ERROR;
+}
+
+void srsran_sl_export_reader_free(srsran_sl_export_reader_t* q)
+{
+  if (q == NULL) {
+    return;
+  }
+  if (q->map) {
+    munmap(q->map, q->map_size);
+  }
+  if (q->fd > 0) {
+    close(q->fd);
+  }
+  bzero(q, sizeof(srsran_sl_export_reader_t));
+}
+
+int srsran_sl_export_read(srsran_sl_export_reader_t* q, srsran_sl_export_record_t* record, uint8_t* tb, uint32_t tb_size)
+{
+  if (q == NULL || q->header == NULL || record == NULL || (tb == NULL && tb_size > 0)) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  const srsran_sl_export_header_t* h = q->header;
+
+  while (true) {
+    uint64_t write_idx = __atomic_load_n(&h->write_idx, __ATOMIC_ACQUIRE);
+    if (q->read_idx >= write_idx) {
+      return 0;
+    }
+
+    // Fell more than a ring behind, the oldest records are gone
+    if (write_idx - q->read_idx > h->nof_records) {
+      q->nof_lost += write_idx - h->nof_records - q->read_idx;
+      q->read_idx = write_idx - h->nof_records;
+    }
+
+    const srsran_sl_export_record_t* slot = sl_export_slot(q->map, h, q->read_idx);
+    uint64_t                         seq  = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq == 2 * q->read_idx + 2) {
+      memcpy(record, slot, sizeof(srsran_sl_export_record_t));
+      uint32_t len = SRSRAN_MIN(SRSRAN_MIN(record->tb_len, h->max_tb_bytes), tb_size);
+      if (len > 0) {
+        memcpy(tb, slot + 1, len);
+      }
+
+      // Any copy that raced with the writer shows up as a different seq
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq) {
+        record->seq = seq;
+        q->read_idx++;
+        return 1;
+      }
+    }
+
+    // Slot already reused by the writer
+    q->nof_lost++;
+    q->read_idx++;
+  }
+}
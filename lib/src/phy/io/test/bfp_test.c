@@ -0,0 +1,329 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/io/bfp.h"
+#include "srsran/phy/io/filesink.h"
+#include "srsran/phy/io/filesource.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/random.h"
+#include "srsran/phy/utils/vector.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+#define NOF_SAMPLES (10 * SRSRAN_BFP_RECORD_LEN + 1008)
+#define SF_LEN 30720
+
+static uint32_t       nof_iterations = 1000;
+static srsran_random_t random_gen     = NULL;
+static char           dir[]          = "/tmp/bfp_testXXXXXX";
+
+static void gauss(cf_t* x, uint32_t len, float std)
+{
+  for (uint32_t i = 0; i < len; i++) {
+    x[i] = srsran_random_gauss_dist(random_gen, std) + _Complex_I * srsran_random_gauss_dist(random_gen, std);
+  }
+}
+
+/* Noise whose power changes every few blocks, with silent, tiny and saturating blocks in between */
+static void generate(cf_t* x, uint32_t len)
+{
+  for (uint32_t i = 0; i < len; i += 64) {
+    float    std = powf(10.0f, srsran_random_uniform_real_dist(random_gen, -4.0f, 4.0f));
+    uint32_t n   = SRSRAN_MIN(64, len - i);
+    switch (srsran_random_uniform_int_dist(random_gen, 0, 9)) {
+      case 0:
+        srsran_vec_cf_zero(x + i, n);
+        break;
+      case 1:
+        gauss(x + i, n, 1e-38f);
+        break;
+      default:
+        gauss(x + i, n, std);
+        break;
+    }
+  }
+}
+
+/* Quantization of a block, written independently of the kernels */
+static void reference_encode(const cf_t* x, uint8_t* z, uint32_t nof_samples, uint32_t bits)
+{
+  const float* xf    = (const float*)x;
+  int32_t      limit = (1 << (bits - 1)) - 1;
+  for (uint32_t b = 0; b < nof_samples / SRSRAN_BFP_BLOCK_LEN; b++) {
+    float max_abs = 0.0f;
+    for (uint32_t i = 0; i < 2 * SRSRAN_BFP_BLOCK_LEN; i++) {
+      max_abs = fmaxf(max_abs, fabsf(xf[i]));
+    }
+    int e = -100;
+    if (max_abs >= 0x1p-126f) {
+      frexpf(max_abs, &e);
+      e = SRSRAN_MAX(e - (int)(bits - 1), -100);
+    }
+    int32_t m[2 * SRSRAN_BFP_BLOCK_LEN];
+    for (uint32_t i = 0; i < 2 * SRSRAN_BFP_BLOCK_LEN; i++) {
+      m[i] = SRSRAN_MAX(-limit, SRSRAN_MIN(limit, (int32_t)lrintf(ldexpf(xf[i], -e))));
+    }
+
+    *z++ = (uint8_t)(int8_t)e;
+    for (uint32_t i = 0; i < 2 * SRSRAN_BFP_BLOCK_LEN; i += (bits == 8) ? 1 : 2) {
+      if (bits == 8) {
+        *z++ = (uint8_t)m[i];
+      } else {
+        *z++ = (uint8_t)m[i];
+        *z++ = (uint8_t)(((m[i] >> 8) & 0xf) | ((m[i + 1] & 0xf) << 4));
+        *z++ = (uint8_t)(m[i + 1] >> 4);
+      }
+    }
+    xf += 2 * SRSRAN_BFP_BLOCK_LEN;
+  }
+}
+
+static int test_kernels(uint32_t bits)
+{
+  uint32_t nof_bytes = srsran_bfp_nof_bytes(NOF_SAMPLES, bits);
+  cf_t*    x         = srsran_vec_cf_malloc(NOF_SAMPLES);
+  cf_t*    y         = srsran_vec_cf_malloc(NOF_SAMPLES);
+  uint8_t* z         = srsran_vec_u8_malloc(nof_bytes);
+  uint8_t* z_ref     = srsran_vec_u8_malloc(nof_bytes);
+  TESTASSERT(x != NULL && y != NULL && z != NULL && z_ref != NULL);
+  generate(x, NOF_SAMPLES);
+
+  TESTASSERT(srsran_bfp_encode(x, z, NOF_SAMPLES, bits) == nof_bytes);
+  reference_encode(x, z_ref, NOF_SAMPLES, bits);
+  TESTASSERT(memcmp(z, z_ref, nof_bytes) == 0);
+  TESTASSERT(srsran_bfp_decode(z, y, NOF_SAMPLES, bits) == nof_bytes);
+
+  // Every component within a quantization step of the largest in its block, which sets the SNR of the block. The
+  // smallest exponent flushes denormal blocks to zero
+  float snr_min = INFINITY;
+  for (uint32_t b = 0; b < NOF_SAMPLES / SRSRAN_BFP_BLOCK_LEN; b++) {
+    const float* xf      = (float*)(x + b * SRSRAN_BFP_BLOCK_LEN);
+    const float* yf      = (float*)(y + b * SRSRAN_BFP_BLOCK_LEN);
+    float        max_abs = 0.0f, p_signal = 0.0f, p_error = 0.0f;
+    for (uint32_t i = 0; i < 2 * SRSRAN_BFP_BLOCK_LEN; i++) {
+      max_abs = fmaxf(max_abs, fabsf(xf[i]));
+      p_signal += xf[i] * xf[i];
+      p_error += (xf[i] - yf[i]) * (xf[i] - yf[i]);
+    }
+    for (uint32_t i = 0; i < 2 * SRSRAN_BFP_BLOCK_LEN; i++) {
+      TESTASSERT(fabsf(xf[i] - yf[i]) <= fmaxf(max_abs / (1 << (bits - 2)), 0x1p-100f));
+    }
+    if (max_abs > 1e-30f) {
+      snr_min = SRSRAN_MIN(snr_min, srsran_convert_power_to_dB(p_signal / p_error));
+    }
+  }
+  printf("%d bits: %.1f:1, lowest SNR of a block %.1f dB\n",
+         bits,
+         (float)sizeof(cf_t) * NOF_SAMPLES / nof_bytes,
+         snr_min);
+  TESTASSERT(snr_min > 6.02f * bits - 20.0f);
+
+  // Decoded samples are encoded again as they were
+  TESTASSERT(srsran_bfp_encode(y, z_ref, NOF_SAMPLES, bits) == nof_bytes);
+  TESTASSERT(memcmp(z, z_ref, nof_bytes) == 0);
+
+  TESTASSERT(srsran_bfp_encode(x, z, SRSRAN_BFP_BLOCK_LEN + 1, bits) == SRSRAN_ERROR_INVALID_INPUTS);
+  TESTASSERT(srsran_bfp_encode(x, z, SRSRAN_BFP_BLOCK_LEN, 10) == SRSRAN_ERROR_INVALID_INPUTS);
+
+  free(x);
+  free(y);
+  free(z);
+  free(z_ref);
+  return SRSRAN_SUCCESS;
+}
+
+static int test_file(uint32_t bits)
+{
+  // What the file holds: the samples as decoded, padded to a whole record
+  uint32_t nof_records = (NOF_SAMPLES + SRSRAN_BFP_RECORD_LEN - 1) / SRSRAN_BFP_RECORD_LEN;
+  uint32_t padded_len  = nof_records * SRSRAN_BFP_RECORD_LEN;
+  cf_t*    x           = srsran_vec_cf_malloc(padded_len);
+  cf_t*    y           = srsran_vec_cf_malloc(padded_len);
+  cf_t*    expected    = srsran_vec_cf_malloc(padded_len);
+  uint8_t* z           = srsran_vec_u8_malloc(srsran_bfp_nof_bytes(padded_len, bits));
+  TESTASSERT(x != NULL && y != NULL && expected != NULL && z != NULL);
+  srsran_vec_cf_zero(x, padded_len);
+  generate(x, NOF_SAMPLES);
+  srsran_bfp_encode(x, z, padded_len, bits);
+  srsran_bfp_decode(z, expected, padded_len, bits);
+
+  // Written in chunks that do not follow the records
+  char path[64];
+  snprintf(path, sizeof(path), "%s/iq_%d.bfp", dir, bits);
+  srsran_filesink_t fsink;
+  TESTASSERT(srsran_filesink_init(&fsink, path, bits == 8 ? SRSRAN_COMPLEX_BFP8_BIN : SRSRAN_COMPLEX_BFP12_BIN) ==
+             SRSRAN_SUCCESS);
+  for (uint32_t i = 0; i < NOF_SAMPLES;) {
+    uint32_t n = srsran_random_uniform_int_dist(random_gen, 1, 2 * SRSRAN_BFP_RECORD_LEN);
+    n          = SRSRAN_MIN(n, NOF_SAMPLES - i);
+    TESTASSERT(srsran_filesink_write(&fsink, x + i, n) == n);
+    i += n;
+  }
+  srsran_filesink_free(&fsink);
+
+  FILE* f = fopen(path, "r");
+  TESTASSERT(f != NULL);
+  fseek(f, 0, SEEK_END);
+  TESTASSERT(ftell(f) == sizeof(srsran_bfp_file_header_t) + srsran_bfp_nof_bytes(padded_len, bits));
+  fclose(f);
+
+  // The width comes from the file
+  srsran_filesource_t fsrc;
+  TESTASSERT(srsran_filesource_init(&fsrc, path, SRSRAN_COMPLEX_BFP8_BIN) == SRSRAN_SUCCESS);
+  for (uint32_t i = 0; i < NOF_SAMPLES;) {
+    uint32_t n = srsran_random_uniform_int_dist(random_gen, 1, 2 * SRSRAN_BFP_RECORD_LEN);
+    int      r = srsran_filesource_read(&fsrc, y + i, n);
+    TESTASSERT(r == SRSRAN_MIN(n, NOF_SAMPLES - i));
+    i += r;
+  }
+  TESTASSERT(srsran_filesource_read(&fsrc, y, 1) == 0);
+  TESTASSERT(memcmp(y, expected, sizeof(cf_t) * NOF_SAMPLES) == 0);
+
+  // Seeking anywhere, forwards and backwards
+  for (uint32_t i = 0; i < 100; i++) {
+    uint32_t s = srsran_random_uniform_int_dist(random_gen, 0, NOF_SAMPLES - 1);
+    uint32_t n = SRSRAN_MIN(NOF_SAMPLES - s, 3000);
+    if (i % 2) {
+      TESTASSERT(srsran_filesource_seek_sample(&fsrc, s) == SRSRAN_SUCCESS);
+    } else {
+      srsran_filesource_seek(&fsrc, s * sizeof(cf_t));
+    }
+    TESTASSERT(srsran_filesource_read(&fsrc, y, 3000) == n);
+    TESTASSERT(memcmp(y, expected + s, sizeof(cf_t) * n) == 0);
+  }
+  TESTASSERT(srsran_filesource_seek_sample(&fsrc, padded_len) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_filesource_read(&fsrc, y, 1) == 0);
+  TESTASSERT(srsran_filesource_read_multi(&fsrc, (void**)&y, 1, 1) == SRSRAN_ERROR);
+  srsran_filesource_free(&fsrc);
+
+  // A file that was not closed gives its whole records
+  f = fopen(path, "r+");
+  TESTASSERT(f != NULL);
+  uint64_t nof_samples = 0;
+  fseek(f, offsetof(srsran_bfp_file_header_t, nof_samples), SEEK_SET);
+  TESTASSERT(fwrite(&nof_samples, sizeof(nof_samples), 1, f) == 1);
+  fclose(f);
+  TESTASSERT(srsran_filesource_init(&fsrc, path, SRSRAN_COMPLEX_BFP12_BIN) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_filesource_read(&fsrc, y, padded_len + 1) == padded_len);
+  TESTASSERT(memcmp(y, expected, sizeof(cf_t) * padded_len) == 0);
+  srsran_filesource_free(&fsrc);
+
+  free(x);
+  free(y);
+  free(expected);
+  free(z);
+  return SRSRAN_SUCCESS;
+}
+
+/* Samples per second of a 20 MHz subframe, against the 30.72 Msps of real time */
+static int benchmark(uint32_t bits)
+{
+  cf_t*    x = srsran_vec_cf_malloc(SF_LEN);
+  uint8_t* z = srsran_vec_u8_malloc(srsran_bfp_nof_bytes(SF_LEN, bits));
+  TESTASSERT(x != NULL && z != NULL);
+  gauss(x, SF_LEN, 0.1f);
+
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+  for (uint32_t i = 0; i < nof_iterations; i++) {
+    srsran_bfp_encode(x, z, SF_LEN, bits);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  double encode_us = t[0].tv_sec * 1e6 + t[0].tv_usec;
+
+  gettimeofday(&t[1], NULL);
+  for (uint32_t i = 0; i < nof_iterations; i++) {
+    srsran_bfp_decode(z, x, SF_LEN, bits);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  double decode_us = t[0].tv_sec * 1e6 + t[0].tv_usec;
+
+  printf("%d bits: encode %.1f Msps, decode %.1f Msps\n",
+         bits,
+         (double)SF_LEN * nof_iterations / encode_us,
+         (double)SF_LEN * nof_iterations / decode_us);
+  free(x);
+  free(z);
+  return SRSRAN_SUCCESS;
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "n")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_iterations = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        printf("Usage: %s [n]\n", argv[0]);
+        printf("\t-n number of subframes in the benchmark [Default %d]\n", nof_iterations);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+  random_gen = srsran_random_init(1234);
+  if (mkdtemp(dir) == NULL) {
+    perror("mkdtemp");
+    return SRSRAN_ERROR;
+  }
+
+  int ret = SRSRAN_SUCCESS;
+  for (uint32_t bits = 8; bits <= 12 && ret == SRSRAN_SUCCESS; bits += 4) {
+    if (test_kernels(bits) != SRSRAN_SUCCESS || test_file(bits) != SRSRAN_SUCCESS ||
+        benchmark(bits) != SRSRAN_SUCCESS) {
+      ret = SRSRAN_ERROR;
+    }
+  }
+  if (ret == SRSRAN_SUCCESS) {
+    printf("Ok\n");
+  }
+
+  char cmd[64];
+  snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+  if (system(cmd) != 0) {
+    perror("system");
+  }
+  srsran_random_free(random_gen);
+  return ret;
+}
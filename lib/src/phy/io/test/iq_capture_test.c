@@ -0,0 +1,331 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <complex.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/io/bfp.h"
+#include "srsran/phy/io/filesource.h"
+#include "srsran/phy/io/iq_capture.h"
+#include "srsran/phy/utils/debug.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+#define NOF_PORTS 2
+#define NOF_SF 2000
+
+static uint32_t sf_len         = 1920;
+static uint32_t nof_iterations = 1000000;
+static char     dir[]          = "/tmp/iq_capture_testXXXXXX";
+
+/* Every sample tells its subframe, position and antenna */
+static cf_t sample(uint64_t sf, uint32_t i, uint32_t port)
+{
+  return (float)sf + _Complex_I * (float)(i + port * sf_len);
+}
+
+/* Reads capture id back with srsran_filesource and checks it holds subframes first_sf to first_sf + nof_sf */
+static int check_capture(uint32_t id, const char* reason, uint64_t first_sf, uint64_t nof_sf, uint32_t trigger_sf)
+{
+  char path[128];
+  snprintf(path, sizeof(path), "%s/cap_%d.txt", dir, id);
+  FILE* f = fopen(path, "r");
+  TESTASSERT(f != NULL);
+  char     line[64], read_reason[32] = {};
+  uint32_t read_nof_sf = 0, read_trigger_sf = 0;
+  while (fgets(line, sizeof(line), f)) {
+    sscanf(line, "reason=%31s", read_reason);
+    sscanf(line, "nof_sf=%u", &read_nof_sf);
+    sscanf(line, "trigger_sf=%u", &read_trigger_sf);
+  }
+  fclose(f);
+  TESTASSERT(strcmp(read_reason, reason) == 0);
+  TESTASSERT(read_nof_sf == nof_sf);
+  TESTASSERT(read_trigger_sf == trigger_sf);
+
+  cf_t* buffer = malloc(sizeof(cf_t) * sf_len);
+  TESTASSERT(buffer != NULL);
+  for (uint32_t p = 0; p < NOF_PORTS; p++) {
+    srsran_filesource_t fsrc;
+    snprintf(path, sizeof(path), "%s/cap_%d_%d.fc32", dir, id, p);
+    TESTASSERT(srsran_filesource_init(&fsrc, path, SRSRAN_COMPLEX_FLOAT_BIN) == SRSRAN_SUCCESS);
+    for (uint64_t sf = first_sf; sf < first_sf + nof_sf; sf++) {
+      TESTASSERT(srsran_filesource_read(&fsrc, buffer, sf_len) == sf_len);
+      for (uint32_t i = 0; i < sf_len; i++) {
+        TESTASSERT(buffer[i] == sample(sf, i, p));
+      }
+    }
+    TESTASSERT(srsran_filesource_read(&fsrc, buffer, sf_len) == 0);
+    srsran_filesource_free(&fsrc);
+  }
+  free(buffer);
+  return SRSRAN_SUCCESS;
+}
+
+static int test_triggers()
+{
+  srsran_iq_capture_cfg_t cfg;
+  srsran_iq_capture_cfg_default(&cfg);
+  cfg.nof_ports = NOF_PORTS;
+  cfg.sf_len    = sf_len;
+  TESTASSERT(srsran_iq_capture_cfg_parse(&cfg, "history=0.6,pre=20,post=30,win=10,crc=5,sci=3,scimin=10,sync") ==
+             SRSRAN_SUCCESS);
+  TESTASSERT(srsran_iq_capture_cfg_parse(&cfg, "pre") == SRSRAN_ERROR);
+  TESTASSERT(srsran_iq_capture_cfg_parse(&cfg, "foo=1") == SRSRAN_ERROR);
+  TESTASSERT(cfg.history_sf == 600 && cfg.pre_sf == 20 && cfg.post_sf == 30 && cfg.rules.sync_loss);
+
+  char prefix[64];
+  snprintf(prefix, sizeof(prefix), "%s/cap", dir);
+  srsran_iq_capture_t q;
+  TESTASSERT(srsran_iq_capture_init(&q, &cfg, prefix) == SRSRAN_SUCCESS);
+
+  // Received in real time, at a tenth of it
+  for (uint64_t sf = 0; sf < NOF_SF; sf++) {
+    for (uint32_t p = 0; p < NOF_PORTS; p++) {
+      cf_t* slot = srsran_iq_capture_slot(&q, p);
+      for (uint32_t i = 0; i < sf_len; i++) {
+        slot[i] = sample(sf, i, p);
+      }
+    }
+
+    // Two CRC bursts, the second inside the window of the first, sync lost at 400, SCI spike at 1500
+    srsran_iq_capture_sf_stats_t s = {};
+    s.nof_crc_fail                 = ((sf >= 100 && sf < 105) || (sf >= 120 && sf < 125)) ? 1 : 0;
+    s.nof_sci                      = (sf >= 1500 && sf < 1510) ? 10 : 1;
+    s.synced                       = sf < 400 || sf >= 410;
+    if (sf == 700 || sf == NOF_SF - 10) {
+      srsran_iq_capture_trigger(&q);
+    }
+    srsran_timestamp_t t = {};
+    srsran_timestamp_init(&t, 1000, sf * 1e-3);
+    srsran_iq_capture_commit(&q, &t, &s);
+    TESTASSERT(srsran_iq_capture_last(&q, 0)[0] == sample(sf, 0, 0));
+    usleep(100);
+  }
+  srsran_iq_capture_free(&q);
+
+  TESTASSERT(check_capture(0, "crc_burst", 84, 51, 20) == SRSRAN_SUCCESS);
+  TESTASSERT(check_capture(1, "sync_loss", 380, 51, 20) == SRSRAN_SUCCESS);
+  TESTASSERT(check_capture(2, "manual", 680, 51, 20) == SRSRAN_SUCCESS);
+  TESTASSERT(check_capture(3, "sci_spike", 1482, 51, 20) == SRSRAN_SUCCESS);
+
+  // Stopped before the end of its window
+  TESTASSERT(check_capture(4, "manual", NOF_SF - 30, 30, 20) == SRSRAN_SUCCESS);
+  char path[128];
+  snprintf(path, sizeof(path), "%s/cap_5.txt", dir);
+  TESTASSERT(access(path, F_OK) != 0);
+  return SRSRAN_SUCCESS;
+}
+
+/* Captures in block floating point hold the subframes as the format decodes them */
+static int test_bfp()
+{
+  srsran_iq_capture_cfg_t cfg;
+  srsran_iq_capture_cfg_default(&cfg);
+  cfg.nof_ports = NOF_PORTS;
+  cfg.sf_len    = sf_len;
+  TESTASSERT(srsran_iq_capture_cfg_parse(&cfg, "history=0.1,pre=5,post=4,bfp=8") == SRSRAN_SUCCESS);
+  TESTASSERT(cfg.bfp_bits == 8);
+
+  char prefix[64];
+  snprintf(prefix, sizeof(prefix), "%s/bfp", dir);
+  srsran_iq_capture_t q;
+  TESTASSERT(srsran_iq_capture_init(&q, &cfg, prefix) == SRSRAN_SUCCESS);
+  srsran_iq_capture_sf_stats_t s = {.synced = true};
+  for (uint64_t sf = 0; sf < 100; sf++) {
+    for (uint32_t p = 0; p < NOF_PORTS; p++) {
+      cf_t* slot = srsran_iq_capture_slot(&q, p);
+      for (uint32_t i = 0; i < sf_len; i++) {
+        slot[i] = sample(sf, i, p);
+      }
+    }
+    if (sf == 50) {
+      srsran_iq_capture_trigger(&q);
+    }
+    srsran_iq_capture_commit(&q, NULL, &s);
+  }
+  srsran_iq_capture_free(&q);
+
+  cf_t*    expected = malloc(sizeof(cf_t) * sf_len);
+  cf_t*    buffer   = malloc(sizeof(cf_t) * sf_len);
+  uint8_t* encoded  = malloc(srsran_bfp_nof_bytes(sf_len, 8));
+  TESTASSERT(expected != NULL && buffer != NULL && encoded != NULL);
+  for (uint32_t p = 0; p < NOF_PORTS; p++) {
+    char                path[128];
+    srsran_filesource_t fsrc;
+    snprintf(path, sizeof(path), "%s/bfp_0_%d.bfp", dir, p);
+    TESTASSERT(srsran_filesource_init(&fsrc, path, SRSRAN_COMPLEX_BFP8_BIN) == SRSRAN_SUCCESS);
+    for (uint64_t sf = 45; sf < 55; sf++) {
+      for (uint32_t i = 0; i < sf_len; i++) {
+        expected[i] = sample(sf, i, p);
+      }
+      srsran_bfp_encode(expected, encoded, sf_len, 8);
+      srsran_bfp_decode(encoded, expected, sf_len, 8);
+      TESTASSERT(srsran_filesource_read(&fsrc, buffer, sf_len) == sf_len);
+      TESTASSERT(memcmp(buffer, expected, sizeof(cf_t) * sf_len) == 0);
+    }
+    TESTASSERT(srsran_filesource_read(&fsrc, buffer, sf_len) == 0);
+    srsran_filesource_free(&fsrc);
+  }
+  free(expected);
+  free(buffer);
+  free(encoded);
+
+  // Subframes must be whole records
+  cfg.sf_len = 1000;
+  TESTASSERT(srsran_iq_capture_init(&q, &cfg, prefix) == SRSRAN_ERROR_INVALID_INPUTS);
+  return SRSRAN_SUCCESS;
+}
+
+static int test_stats()
+{
+  srsran_iq_capture_cfg_t cfg;
+  srsran_iq_capture_cfg_default(&cfg);
+  cfg.sf_len     = sf_len;
+  cfg.history_sf = 64;
+  cfg.pre_sf     = 10;
+  cfg.post_sf    = 100000;
+
+  char prefix[64];
+  snprintf(prefix, sizeof(prefix), "%s/overrun", dir);
+  srsran_iq_capture_t q;
+  TESTASSERT(srsran_iq_capture_init(&q, &cfg, prefix) == SRSRAN_SUCCESS);
+
+  // Committed much faster than the writer copies, which gets lapped
+  srsran_iq_capture_sf_stats_t s = {.synced = true};
+  srsran_iq_capture_trigger(&q);
+  srsran_iq_capture_commit(&q, NULL, &s);
+  srsran_iq_capture_trigger(&q);
+  for (uint32_t sf = 1; sf < 20000; sf++) {
+    srsran_iq_capture_commit(&q, NULL, &s);
+  }
+
+  // Let the writer notice before stopping it, otherwise it may only see the truncation
+  usleep(100000);
+  srsran_iq_capture_stats_t stats;
+  srsran_iq_capture_get_stats(&q, &stats);
+  TESTASSERT(stats.nof_triggers[SRSRAN_IQ_CAPTURE_MANUAL] == 2);
+  TESTASSERT(stats.nof_suppressed == 1);
+  TESTASSERT(stats.nof_overrun == 1);
+  TESTASSERT(stats.nof_captures == 0);
+  srsran_iq_capture_fprint_stats(stdout, &q);
+  srsran_iq_capture_free(&q);
+
+  // A history that cannot hold the subframes before the trigger
+  cfg.pre_sf = 63;
+  TESTASSERT(srsran_iq_capture_init(&q, &cfg, prefix) == SRSRAN_ERROR_INVALID_INPUTS);
+  return SRSRAN_SUCCESS;
+}
+
+/* Cost of a commit in the receive thread, with every rule enabled */
+static int benchmark()
+{
+  srsran_iq_capture_cfg_t cfg;
+  srsran_iq_capture_cfg_default(&cfg);
+  cfg.sf_len     = sf_len;
+  cfg.history_sf = 1000;
+  TESTASSERT(srsran_iq_capture_cfg_parse(&cfg, "post=0,crc=1000000,sci=1000000,sync") == SRSRAN_SUCCESS);
+
+  char prefix[64];
+  snprintf(prefix, sizeof(prefix), "%s/bench", dir);
+  srsran_iq_capture_t q;
+  TESTASSERT(srsran_iq_capture_init(&q, &cfg, prefix) == SRSRAN_SUCCESS);
+
+  srsran_iq_capture_sf_stats_t s = {.nof_sci = 3, .nof_crc_fail = 1, .synced = true};
+  srsran_timestamp_t           t = {};
+  struct timeval               tv[3];
+  gettimeofday(&tv[1], NULL);
+  for (uint32_t i = 0; i < nof_iterations; i++) {
+    srsran_iq_capture_commit(&q, &t, &s);
+  }
+  gettimeofday(&tv[2], NULL);
+  get_time_interval(tv);
+  printf("%d commits in %ld us, %.1f ns per subframe\n",
+         nof_iterations,
+         tv[0].tv_sec * 1000000 + tv[0].tv_usec,
+         (tv[0].tv_sec * 1e9 + tv[0].tv_usec * 1e3) / nof_iterations);
+
+  // Write speed of a window that ends with the trigger
+  srsran_iq_capture_stats_t stats = {};
+  srsran_iq_capture_trigger(&q);
+  srsran_iq_capture_commit(&q, &t, &s);
+  while (stats.nof_captures == 0) {
+    usleep(1000);
+    srsran_iq_capture_get_stats(&q, &stats);
+  }
+  srsran_iq_capture_fprint_stats(stdout, &q);
+  srsran_iq_capture_free(&q);
+  return SRSRAN_SUCCESS;
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "ln")) != -1) {
+    switch (opt) {
+      case 'l':
+        sf_len = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'n':
+        nof_iterations = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        printf("Usage: %s [ln]\n", argv[0]);
+        printf("\t-l samples per subframe [Default %d]\n", sf_len);
+        printf("\t-n number of commits in the benchmark [Default %d]\n", nof_iterations);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+  if (mkdtemp(dir) == NULL) {
+    perror("mkdtemp");
+    return SRSRAN_ERROR;
+  }
+
+  int ret = SRSRAN_ERROR;
+  if (test_triggers() == SRSRAN_SUCCESS && test_bfp() == SRSRAN_SUCCESS && test_stats() == SRSRAN_SUCCESS &&
+      benchmark() == SRSRAN_SUCCESS) {
+    printf("Ok\n");
+    ret = SRSRAN_SUCCESS;
+  }
+
+  char cmd[64];
+  snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+  if (system(cmd) != 0) {
+    perror("system");
+  }
+  return ret;
+}
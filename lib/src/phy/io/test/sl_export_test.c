@@ -0,0 +1,235 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "srsran/srsran.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+#define MAX_TB_BYTES 1000
+
+static char*    ring_path   = "sl_export_test.ring";
+static uint32_t nof_records = 64;
+static uint32_t nof_stress  = 1000000;
+
+static uint8_t tb_rx[MAX_TB_BYTES];
+
+/* Record n carries a transport block of n % MAX_TB_BYTES bytes, filled from n, and fields derived from n */
+static void write_record(srsran_sl_export_t* w, uint64_t n)
+{
+  uint8_t*                   tb = NULL;
+  srsran_sl_export_record_t* r  = srsran_sl_export_begin(w, &tb);
+  r->timestamp_us               = n * 1000;
+  r->sf_idx                     = n % 10;
+  r->sub_channel_idx            = n % 5;
+  r->N_x_id                     = (uint32_t)(n * 2654435761u) & 0xffff;
+  r->mcs_idx                    = n % 29;
+  r->flags                      = SRSRAN_SL_EXPORT_TB_OK;
+  r->rsrp_db                    = -(float)(n % 100);
+  r->tb_len                     = n % MAX_TB_BYTES;
+  for (uint32_t i = 0; i < r->tb_len; i++) {
+    tb[i] = (uint8_t)(n + i);
+  }
+  srsran_sl_export_commit(w);
+}
+
+static int check_record(const srsran_sl_export_record_t* r, const uint8_t* tb, uint64_t n)
+{
+  TESTASSERT(r->seq == 2 * n + 2);
+  TESTASSERT(r->timestamp_us == n * 1000);
+  TESTASSERT(r->sf_idx == n % 10);
+  TESTASSERT(r->sub_channel_idx == n % 5);
+  TESTASSERT(r->N_x_id == ((uint32_t)(n * 2654435761u) & 0xffff));
+  TESTASSERT(r->mcs_idx == n % 29);
+  TESTASSERT(r->flags == SRSRAN_SL_EXPORT_TB_OK);
+  TESTASSERT(r->rsrp_db == -(float)(n % 100));
+  TESTASSERT(r->tb_len == n % MAX_TB_BYTES);
+  for (uint32_t i = 0; i < r->tb_len; i++) {
+    TESTASSERT(tb[i] == (uint8_t)(n + i));
+  }
+  return SRSRAN_SUCCESS;
+}
+
+static int test_round_trip()
+{
+  srsran_sl_export_t        w = {};
+  srsran_sl_export_reader_t r = {};
+  srsran_sl_export_record_t record;
+
+  TESTASSERT(srsran_sl_export_init(&w, ring_path, nof_records - 1, MAX_TB_BYTES) == SRSRAN_SUCCESS);
+  TESTASSERT(w.header->nof_records == nof_records);
+  TESTASSERT(w.header->record_size % 64 == 0);
+  TESTASSERT(w.header->max_tb_bytes >= MAX_TB_BYTES);
+
+  TESTASSERT(srsran_sl_export_reader_init(&r, ring_path) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_sl_export_read(&r, &record, tb_rx, MAX_TB_BYTES) == 0);
+
+  // Every record read back in order
+  for (uint64_t n = 0; n < 3 * nof_records; n++) {
+    write_record(&w, n);
+    TESTASSERT(srsran_sl_export_read(&r, &record, tb_rx, MAX_TB_BYTES) == 1);
+    TESTASSERT(check_record(&record, tb_rx, n) == SRSRAN_SUCCESS);
+    TESTASSERT(srsran_sl_export_read(&r, &record, tb_rx, MAX_TB_BYTES) == 0);
+  }
+  TESTASSERT(r.nof_lost == 0);
+
+  // A reader lapped by the writer skips to the oldest record left and counts the rest as lost
+  uint64_t first = 3 * nof_records;
+  for (uint64_t n = first; n < first + nof_records + 10; n++) {
+    write_record(&w, n);
+  }
+  for (uint64_t n = first + 10; n < first + nof_records + 10; n++) {
+    TESTASSERT(srsran_sl_export_read(&r, &record, tb_rx, MAX_TB_BYTES) == 1);
+    TESTASSERT(check_record(&record, tb_rx, n) == SRSRAN_SUCCESS);
+  }
+  TESTASSERT(srsran_sl_export_read(&r, &record, tb_rx, MAX_TB_BYTES) == 0);
+  TESTASSERT(r.nof_lost == 10);
+
+  // A reader attached late starts at the oldest record in the ring, and a short buffer truncates the TB copy
+  srsran_sl_export_reader_t late = {};
+  TESTASSERT(srsran_sl_export_reader_init(&late, ring_path) == SRSRAN_SUCCESS);
+  TESTASSERT(late.read_idx == first + 10);
+  TESTASSERT(srsran_sl_export_read(&late, &record, tb_rx, 4) == 1);
+  TESTASSERT(record.seq == 2 * (first + 10) + 2);
+  srsran_sl_export_reader_free(&late);
+
+  srsran_sl_export_reader_free(&r);
+  srsran_sl_export_free(&w);
+
+  // Not a ring
+  FILE* f = fopen(ring_path, "w");
+  TESTASSERT(f != NULL);
+  fprintf(f, "not a ring, but long enough to hold a ring header if it were one ................................\n");
+  fclose(f);
+  TESTASSERT(srsran_sl_export_reader_init(&r, ring_path) == SRSRAN_ERROR);
+
+  return SRSRAN_SUCCESS;
+}
+
+/* Writer and reader in different processes: every record read must be intact, none can be read twice */
+static int test_concurrent()
+{
+  srsran_sl_export_t w = {};
+  TESTASSERT(srsran_sl_export_init(&w, ring_path, nof_records, MAX_TB_BYTES) == SRSRAN_SUCCESS);
+
+  pid_t pid = fork();
+  TESTASSERT(pid >= 0);
+  if (pid == 0) {
+    struct timeval t[3];
+    gettimeofday(&t[1], NULL);
+    for (uint64_t n = 0; n < nof_stress; n++) {
+      write_record(&w, n);
+    }
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    printf("Writer: %d records in %.1f ms\n", nof_stress, t[0].tv_sec * 1e3 + t[0].tv_usec / 1e3);
+    srsran_sl_export_free(&w);
+    exit(0);
+  }
+
+  srsran_sl_export_reader_t r = {};
+  srsran_sl_export_record_t record;
+  TESTASSERT(srsran_sl_export_reader_init(&r, ring_path) == SRSRAN_SUCCESS);
+
+  uint64_t nof_read = 0;
+  uint64_t last     = 0;
+  bool     done     = false;
+  while (!done) {
+    // Poll the writer only once the ring is drained, the last records are read after it exits
+    done = waitpid(pid, NULL, WNOHANG) == pid;
+    int n;
+    while ((n = srsran_sl_export_read(&r, &record, tb_rx, MAX_TB_BYTES)) == 1) {
+      uint64_t idx = (record.seq - 2) / 2;
+      TESTASSERT(nof_read == 0 || idx > last);
+      TESTASSERT(check_record(&record, tb_rx, idx) == SRSRAN_SUCCESS);
+      last = idx;
+      nof_read++;
+    }
+    TESTASSERT(n == 0);
+  }
+  printf("Reader: %ld records read, %ld lost\n", nof_read, r.nof_lost);
+  TESTASSERT(last == nof_stress - 1);
+  TESTASSERT(nof_read + r.nof_lost == nof_stress);
+
+  srsran_sl_export_reader_free(&r);
+  srsran_sl_export_free(&w);
+  return SRSRAN_SUCCESS;
+}
+
+static void usage(char* prog)
+{
+  printf("Usage: %s\n", prog);
+  printf("\t-f ring file [Default %s]\n", ring_path);
+  printf("\t-n nof_records in the ring [Default %d]\n", nof_records);
+  printf("\t-s nof_records written in the concurrent test [Default %d]\n", nof_stress);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "fns")) != -1) {
+    switch (opt) {
+      case 'f':
+        ring_path = argv[optind];
+        break;
+      case 'n':
+        nof_records = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        nof_stress = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  int ret = SRSRAN_ERROR;
+  if (test_round_trip()) {
+    goto clean_exit;
+  }
+  if (test_concurrent()) {
+    goto clean_exit;
+  }
+  printf("Ok\n");
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  unlink(ring_path);
+  return ret;
+}
@@ -171,7 +171,7 @@ int srsran_psbch_init(srsran_psbch_t* q, uint32_t nof_prb, uint32_t N_sl_id, srs
 
   // Transform precoding
   q->precoding_scaling = 1.0f;
-  if (srsran_dft_precoding_init_tx(&q->dft_precoder, SRSRAN_PSBCH_NOF_PRB) != SRSRAN_SUCCESS) {
+  if (srsran_dft_precoding_init_nof_prb(&q->dft_precoder, SRSRAN_PSBCH_NOF_PRB, true) != SRSRAN_SUCCESS) {
     ERROR("Error srsran_dft_precoding_init\n");
     return SRSRAN_ERROR;
   }
@@ -184,10 +184,15 @@ int srsran_psbch_init(srsran_psbch_t* q, uint32_t nof_prb, uint32_t N_sl_id, srs
   ///< Make sure last bits are zero as they are not considered during unpack
   srsran_vec_cf_zero(q->scfdma_symbols, q->nof_data_re);
 
-  if (srsran_dft_precoding_init_rx(&q->idft_precoder, SRSRAN_PSBCH_NOF_PRB) != SRSRAN_SUCCESS) {
+  if (srsran_dft_precoding_init_nof_prb(&q->idft_precoder, SRSRAN_PSBCH_NOF_PRB, false) != SRSRAN_SUCCESS) {
     ERROR("Error srsran_idft_precoding_init\n");
     return SRSRAN_ERROR;
   }
+  if (srsran_dft_precoding_set_nof_symbols(&q->dft_precoder, q->nof_data_symbols) != SRSRAN_SUCCESS ||
+      srsran_dft_precoding_set_nof_symbols(&q->idft_precoder, q->nof_data_symbols) != SRSRAN_SUCCESS) {
+    ERROR("Error planning the DFT precoding of %d symbols\n", q->nof_data_symbols);
+    return SRSRAN_ERROR;
+  }
 
   return SRSRAN_SUCCESS;
 }
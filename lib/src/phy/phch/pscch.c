@@ -31,6 +31,7 @@
 #include "srsran/phy/scrambling/scrambling.h"
 #include "srsran/phy/utils/bit.h"
 #include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/sl_prof.h"
 #include "srsran/phy/utils/vector.h"
 
 int srsran_pscch_init(srsran_pscch_t* q, uint32_t max_prb)
@@ -124,6 +125,7 @@ int srsran_pscch_init(srsran_pscch_t* q, uint32_t max_prb)
     if (srsran_modem_table_lte(&q->mod, SRSRAN_MOD_QPSK)) {
       return SRSRAN_ERROR;
     }
+    srsran_modem_table_bytes(&q->mod);
 
     q->mod_symbols = srsran_vec_cf_malloc(E_max / SRSRAN_PSCCH_QM);
     if (!q->mod_symbols) {
@@ -138,8 +140,8 @@ int srsran_pscch_init(srsran_pscch_t* q, uint32_t max_prb)
       return SRSRAN_ERROR;
     }
 
-    // DFT Precoding
-    if (srsran_dft_precoding_init(&q->dft_precoder, SRSRAN_PSCCH_MAX_NOF_PRB, true)) {
+    // DFT Precoding, planned again by srsran_pscch_set_cell() if the transmission mode uses another number of PRB
+    if (srsran_dft_precoding_init_nof_prb(&q->dft_precoder, SRSRAN_PSCCH_TM12_NOF_PRB, true)) {
       return SRSRAN_ERROR;
     }
     q->scfdma_symbols = srsran_vec_cf_malloc(E_max / SRSRAN_PSCCH_QM);
@@ -150,7 +152,7 @@ int srsran_pscch_init(srsran_pscch_t* q, uint32_t max_prb)
     srsran_vec_cf_zero(q->scfdma_symbols, E_max / SRSRAN_PSCCH_QM);
 
     // IDFT Predecoding
-    if (srsran_dft_precoding_init(&q->idft_precoder, SRSRAN_PSCCH_MAX_NOF_PRB, false)) {
+    if (srsran_dft_precoding_init_nof_prb(&q->idft_precoder, SRSRAN_PSCCH_TM12_NOF_PRB, false)) {
       return SRSRAN_ERROR;
     }
 
@@ -187,6 +189,22 @@ int srsran_pscch_set_cell(srsran_pscch_t* q, srsran_cell_sl_t cell)
 
     q->cell = cell;
 
+    if (q->dft_precoder.max_prb != q->pscch_nof_prb) {
+      srsran_dft_precoding_free(&q->dft_precoder);
+      srsran_dft_precoding_free(&q->idft_precoder);
+      if (srsran_dft_precoding_init_nof_prb(&q->dft_precoder, q->pscch_nof_prb, true) ||
+          srsran_dft_precoding_init_nof_prb(&q->idft_precoder, q->pscch_nof_prb, false)) {
+        ERROR("Error planning the DFT precoding of %d PRB\n", q->pscch_nof_prb);
+        return ret;
+      }
+    }
+
+    if (srsran_dft_precoding_set_nof_symbols(&q->dft_precoder, q->nof_symbols) ||
+        srsran_dft_precoding_set_nof_symbols(&q->idft_precoder, q->nof_symbols)) {
+      ERROR("Error planning the DFT precoding of %d symbols\n", q->nof_symbols);
+      return ret;
+    }
+
     ///< Last OFDM symbol is processed but not transmitted
     q->nof_tx_re = (q->nof_symbols - 1) * SRSRAN_NRE * q->pscch_nof_prb;
 
@@ -219,13 +237,12 @@ int srsran_pscch_encode(srsran_pscch_t* q, uint8_t* sci, cf_t* sf_buffer, uint32
                              q->nof_symbols,         // nof pscch symbols
                              q->codeword_bytes       // output
   );
-  srsran_bit_unpack_vector(q->codeword_bytes, q->codeword, q->E);
 
   // Scrambling
-  srsran_scrambling_b(&q->seq, q->codeword);
+  srsran_scrambling_bytes(&q->seq, q->codeword_bytes, q->E);
 
   // Modulation
-  srsran_mod_modulate(&q->mod, q->codeword, q->mod_symbols, q->E);
+  srsran_mod_modulate_bytes(&q->mod, q->codeword_bytes, q->mod_symbols, q->E);
 
   // Layer Mapping
   // Void: Single layer
@@ -253,6 +270,35 @@ int srsran_pscch_decode(srsran_pscch_t* q, cf_t* equalized_sf_syms, uint8_t* sci
     return SRSRAN_ERROR;
   }
 
+  return srsran_pscch_decode_scfdma(q, sci);
+}
+
+int srsran_pscch_decode_scfdma(srsran_pscch_t* q, uint8_t* sci)
+{
+  srsran_pscch_demod_scfdma(q, q->d_16);
+
+  // Channel decoding
+  srsran_viterbi_decode_s(&q->dec, q->d_16, q->c, q->sci_len + SRSRAN_SCI_CRC_LEN);
+
+  // Copy received crc
+  memcpy(q->sci_crc, &q->c[q->sci_len], sizeof(uint8_t) * SRSRAN_SCI_CRC_LEN);
+
+  // Re-attach crc
+  srsran_crc_attach(&q->crc, q->c, q->sci_len);
+
+  // CRC check
+  if (srsran_bit_diff(q->sci_crc, &q->c[q->sci_len], SRSRAN_SCI_CRC_LEN) != 0) {
+    return SRSRAN_ERROR;
+  }
+
+  // Remove CRC and copy content to sci buffer
+  memcpy(sci, q->c, sizeof(uint8_t) * q->sci_len);
+
+  return SRSRAN_SUCCESS;
+}
+
+int srsran_pscch_demod_scfdma(srsran_pscch_t* q, int16_t* d_16)
+{
   // Precoding
   // Void: Single antenna port
   // 3GPP TS 36.211 version 15.6.0 Release 15 Sec. 9.4.5
@@ -275,26 +321,44 @@ int srsran_pscch_decode(srsran_pscch_t* q, cf_t* equalized_sf_syms, uint8_t* sci
       q->llr, SRSRAN_PSCCH_QM, q->E / SRSRAN_PSCCH_QM, q->nof_symbols, q->e_16, q->interleaver_lut);
 
   // Rate matching
-  srsran_rm_conv_rx_s(q->e_16, q->E, q->d_16, (3 * (q->sci_len + SRSRAN_SCI_CRC_LEN)));
+  return srsran_rm_conv_rx_s(q->e_16, q->E, d_16, (3 * (q->sci_len + SRSRAN_SCI_CRC_LEN)));
+}
 
-  // Channel decoding
-  srsran_viterbi_decode_s(&q->dec, q->d_16, q->c, q->sci_len + SRSRAN_SCI_CRC_LEN);
+int srsran_pscch_init_batch(srsran_pscch_t* q)
+{
+  if (q == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  return srsran_viterbi_init_batch(&q->dec);
+}
 
-  // Copy received crc
-  memcpy(q->sci_crc, &q->c[q->sci_len], sizeof(uint8_t) * SRSRAN_SCI_CRC_LEN);
+int srsran_pscch_decode_batch(srsran_pscch_t* q, int16_t** d_16, uint8_t** c, bool* crc_ok, uint32_t nof_candidates)
+{
+  if (q == NULL || d_16 == NULL || c == NULL || crc_ok == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
 
-  // Re-attach crc
-  srsran_crc_attach(&q->crc, q->c, q->sci_len);
+  SRSRAN_SL_PROF_START(t_decode);
+  uint32_t frame_length = q->sci_len + SRSRAN_SCI_CRC_LEN;
+  uint32_t nof_crc_ok   = 0;
+  for (uint32_t k = 0; k < nof_candidates; k += SRSRAN_VITERBI_BATCH_MAX_FRAMES) {
+    uint32_t nof_frames = SRSRAN_MIN(nof_candidates - k, SRSRAN_VITERBI_BATCH_MAX_FRAMES);
 
-  // CRC check
-  if (srsran_bit_diff(q->sci_crc, &q->c[q->sci_len], SRSRAN_SCI_CRC_LEN) != 0) {
-    return SRSRAN_ERROR;
-  }
+    // Channel decoding
+    if (srsran_viterbi_decode_s_batch(&q->dec, &d_16[k], &c[k], nof_frames, frame_length) < SRSRAN_SUCCESS) {
+      return SRSRAN_ERROR;
+    }
 
-  // Remove CRC and copy content to sci buffer
-  memcpy(sci, q->c, sizeof(uint8_t) * q->sci_len);
+    // CRC check
+    for (uint32_t i = k; i < k + nof_frames; i++) {
+      uint8_t* crc_rx = &c[i][q->sci_len];
+      crc_ok[i]       = srsran_crc_checksum(&q->crc, c[i], q->sci_len) == srsran_bit_pack(&crc_rx, SRSRAN_SCI_CRC_LEN);
+      nof_crc_ok += crc_ok[i];
+    }
+  }
+  SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_RX_PSCCH_DECODE, t_decode);
 
-  return SRSRAN_SUCCESS;
+  return nof_crc_ok;
 }
 
 int srsran_pscch_put(srsran_pscch_t* q, cf_t* sf_buffer, uint32_t prb_start_idx)
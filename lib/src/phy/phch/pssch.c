@@ -28,6 +28,7 @@
 #include "srsran/phy/phch/sch.h"
 #include "srsran/phy/utils/bit.h"
 #include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/sl_prof.h"
 #include "srsran/phy/utils/vector.h"
 
 int srsran_pssch_init(srsran_pssch_t* q, srsran_cell_sl_t cell, srsran_sl_comm_resource_pool_t sl_comm_resource_pool)
@@ -63,6 +64,11 @@ int srsran_pssch_init(srsran_pssch_t* q, srsran_cell_sl_t cell, srsran_sl_comm_r
     ERROR("Error allocating memory\n");
     return SRSRAN_ERROR;
   }
+  q->b_bytes = srsran_vec_u8_malloc((SRSRAN_SL_SCH_MAX_TB_LEN + SRSRAN_PSSCH_CRC_LEN) / 8);
+  if (!q->b_bytes) {
+    ERROR("Error allocating memory\n");
+    return SRSRAN_ERROR;
+  }
 
   // Transport Block CRC
   if (srsran_crc_init(&q->tb_crc, SRSRAN_LTE_CRC24A, SRSRAN_PSSCH_CRC_LEN)) {
@@ -193,6 +199,7 @@ int srsran_pssch_init(srsran_pssch_t* q, srsran_cell_sl_t cell, srsran_sl_comm_r
       ERROR("Error initiating modem tables\n");
       return SRSRAN_ERROR;
     }
+    srsran_modem_table_bytes(&q->mod[i]);
   }
 
   // Demodulation
@@ -208,14 +215,20 @@ int srsran_pssch_init(srsran_pssch_t* q, srsran_cell_sl_t cell, srsran_sl_comm_r
     ERROR("Error allocating memory\n");
     return SRSRAN_ERROR;
   }
-  if (srsran_dft_precoding_init(&q->dft_precoder, SRSRAN_MAX_PRB, true)) {
+  // Allocations never exceed the cell bandwidth, so larger sizes are not planned
+  if (srsran_dft_precoding_init(&q->dft_precoder, q->cell.nof_prb, true)) {
     ERROR("Error DFT precoder init\n");
     return SRSRAN_ERROR;
   }
-  if (srsran_dft_precoding_init(&q->idft_precoder, SRSRAN_MAX_PRB, false)) {
+  if (srsran_dft_precoding_init(&q->idft_precoder, q->cell.nof_prb, false)) {
     ERROR("Error in DFT precoder init\n");
     return SRSRAN_ERROR;
   }
+  if (srsran_dft_precoding_set_nof_symbols(&q->dft_precoder, q->nof_data_symbols) ||
+      srsran_dft_precoding_set_nof_symbols(&q->idft_precoder, q->nof_data_symbols)) {
+    ERROR("Error planning the DFT precoding of %d symbols\n", q->nof_data_symbols);
+    return SRSRAN_ERROR;
+  }
 
   return SRSRAN_SUCCESS;
 }
@@ -226,12 +239,21 @@ int srsran_pssch_set_cfg(srsran_pssch_t* q, srsran_pssch_cfg_t pssch_cfg)
     return SRSRAN_ERROR_INVALID_INPUTS;
   }
 
+  if (pssch_cfg.nof_prb > q->cell.nof_prb) {
+    ERROR("PSSCH allocation of %d PRB exceeds the cell bandwidth of %d PRB\n", pssch_cfg.nof_prb, q->cell.nof_prb);
+    return SRSRAN_ERROR;
+  }
+
   q->pssch_cfg = pssch_cfg;
 
   q->mod_idx = srsran_ra_ul_mod_from_mcs(pssch_cfg.mcs_idx);
   q->Qm      = srsran_mod_bits_x_symbol(q->mod_idx);
   q->sl_sch_tb_len =
       srsran_ra_tbs_from_idx(srsran_ra_tbs_idx_from_mcs(pssch_cfg.mcs_idx, false, true), pssch_cfg.nof_prb);
+  if (q->sl_sch_tb_len > SRSRAN_SL_SCH_MAX_TB_LEN) {
+    ERROR("PSSCH TBS %d exceeds the maximum of %d bits\n", q->sl_sch_tb_len, SRSRAN_SL_SCH_MAX_TB_LEN);
+    return SRSRAN_ERROR;
+  }
 
   if (q->cell.tm == SRSRAN_SIDELINK_TM1 || q->cell.tm == SRSRAN_SIDELINK_TM2) {
     q->nof_data_symbols = SRSRAN_PSSCH_TM12_NUM_DATA_SYMBOLS;
@@ -256,39 +278,42 @@ int srsran_pssch_set_cfg(srsran_pssch_t* q, srsran_pssch_cfg_t pssch_cfg)
   return SRSRAN_SUCCESS;
 }
 
-int srsran_pssch_encode(srsran_pssch_t* q, uint8_t* input, uint32_t input_len, cf_t* sf_buffer)
+/* CRC attachment, segmentation, turbo coding, rate matching and concatenation of the packed TB in q->b_bytes, into
+ * q->f_bytes. The CRCs are computed while the turbo coder reads the bytes, see srsran_tcod_encode_lut() */
+static int pssch_encode_cbs(srsran_pssch_t* q)
 {
-  if (!input || input_len > q->sl_sch_tb_len) {
-    ERROR("Can't encode PSSCH, input too long (%d > %d)\n", input_len, q->sl_sch_tb_len);
+  srsran_cbsegm(&q->cb_segm, q->sl_sch_tb_len);
+  if (q->cb_segm.F) {
+    ERROR("Error filler bits are not supported. Use standard TBS\n");
     return SRSRAN_ERROR;
   }
 
-  srsran_cbsegm(&q->cb_segm, q->sl_sch_tb_len);
   uint32_t L = SRSRAN_PSSCH_CRC_LEN;
   if (q->cb_segm.C == 1) {
     L = 0;
   }
 
-  uint32_t K_r   = 0;
-  uint32_t E_r   = 0;
-  uint32_t s     = 0;
-  q->G           = 0;
-  uint32_t Gp    = q->E / q->Qm;
-  uint32_t gamma = Gp % q->cb_segm.C;
-
-  // Copy into codeword buffer
-  memcpy(q->b, input, sizeof(uint8_t) * input_len);
+  uint32_t K_r       = 0;
+  uint32_t cblen_idx = 0;
+  uint32_t E_r       = 0;
+  uint32_t s         = 0;
+  q->G               = 0;
+  uint32_t Gp        = q->E / q->Qm;
+  uint32_t gamma     = Gp % q->cb_segm.C;
+  uint32_t rv        = srsran_pssch_rv[q->pssch_cfg.rv_idx];
 
-  // Transport block CRC attachment
-  srsran_crc_attach(&q->tb_crc, q->b, q->sl_sch_tb_len);
+  // Transport block CRC
+  srsran_crc_set_init(&q->tb_crc, 0);
 
   for (int r = 0; r < q->cb_segm.C; r++) {
 
     // Code block segmentation
     if (r < q->cb_segm.C2) {
-      K_r = q->cb_segm.K2;
+      K_r       = q->cb_segm.K2;
+      cblen_idx = q->cb_segm.K2_idx;
     } else {
-      K_r = q->cb_segm.K1;
+      K_r       = q->cb_segm.K1;
+      cblen_idx = q->cb_segm.K1_idx;
     }
 
     if (r <= (q->cb_segm.C - gamma - 1)) {
@@ -297,60 +322,74 @@ int srsran_pssch_encode(srsran_pssch_t* q, uint8_t* input, uint32_t input_len, c
       E_r = q->Qm * ((uint32_t)ceilf((float)Gp / q->cb_segm.C));
     }
 
-    if (r == 0) {
-      memset(q->c_r, SRSRAN_TX_NULL, sizeof(uint8_t) * q->cb_segm.F);
-      memcpy(&q->c_r[q->cb_segm.F], q->b, sizeof(uint8_t) * (K_r - L));
-      s += (K_r - L - q->cb_segm.F);
-    } else {
-      memcpy(q->c_r, &q->b[s], sizeof(uint8_t) * (K_r - L));
-      s += (K_r - L);
+    // The last code block leaves room for the transport block CRC
+    bool last_cb = (r == q->cb_segm.C - 1);
+    memcpy(q->c_r_bytes, &q->b_bytes[s / 8], (K_r - L - (last_cb ? SRSRAN_PSSCH_CRC_LEN : 0)) / 8);
+
+    // Channel coding with code block and transport block CRC attachment
+    srsran_tcod_encode_lut(
+        &q->tcod, &q->tb_crc, (q->cb_segm.C > 1) ? &q->cb_crc : NULL, q->c_r_bytes, q->d_r, cblen_idx, last_cb);
+
+    // Rate matching, the circular buffer is only written for rv 0
+    if (rv > 0) {
+      srsran_rm_turbo_tx_lut(q->buff_b, q->c_r_bytes, q->d_r, q->f_bytes, cblen_idx, 0, 0, 0);
     }
 
-    // Code block CRC attachment
-    if (q->cb_segm.C > 1) {
-      if (r == 0) {
-        srsran_vec_u8_zero(q->c_r, q->cb_segm.F);
-      }
-      srsran_crc_attach(&q->cb_crc, q->c_r, (int)(K_r - L));
-      if (r == 0) {
-        memset(q->c_r, SRSRAN_TX_NULL, sizeof(uint8_t) * q->cb_segm.F);
-      }
+    // Code block concatenation
+    if (srsran_rm_turbo_tx_lut(
+            q->buff_b, q->c_r_bytes, q->d_r, &q->f_bytes[q->G / 8], cblen_idx, E_r, q->G % 8, rv)) {
+      ERROR("Error in rate matching\n");
+      return SRSRAN_ERROR;
     }
 
-    // Channel coding
-    srsran_tcod_encode(&q->tcod, q->c_r, q->d_r, K_r);
+    s += K_r - L;
+    q->G += E_r;
+  }
 
-    // Rate matching
-    srsran_vec_u8_zero(q->buff_b, SRSRAN_PSSCH_MAX_CODED_BITS);
-    srsran_rm_turbo_tx(q->buff_b, SRSRAN_PSSCH_MAX_CODED_BITS, q->d_r, 3 * K_r + SRSRAN_TCOD_TOTALTAIL, q->e_r, E_r, 0);
+  return SRSRAN_SUCCESS;
+}
 
-    if (q->pssch_cfg.rv_idx > 0) {
-      srsran_rm_turbo_tx(q->buff_b,
-                         SRSRAN_PSSCH_MAX_CODED_BITS,
-                         q->d_r,
-                         3 * K_r + SRSRAN_TCOD_TOTALTAIL,
-                         q->e_r,
-                         E_r,
-                         srsran_pssch_rv[q->pssch_cfg.rv_idx]);
-    }
+int srsran_pssch_encode(srsran_pssch_t* q, uint8_t* input, uint32_t input_len, cf_t* sf_buffer)
+{
+  if (!input || input_len > q->sl_sch_tb_len) {
+    ERROR("Can't encode PSSCH, input too long (%d > %d)\n", input_len, q->sl_sch_tb_len);
+    return SRSRAN_ERROR;
+  }
 
-    // Code block concatenation
-    memcpy(&q->f[q->G], q->e_r, sizeof(uint8_t) * E_r);
-    q->G += E_r;
+  // Copy into codeword buffer
+  memcpy(q->b, input, sizeof(uint8_t) * input_len);
+  srsran_bit_pack_vector(q->b, q->b_bytes, q->sl_sch_tb_len);
+
+  return srsran_pssch_encode_bytes(q, q->b_bytes, q->sl_sch_tb_len, sf_buffer);
+}
+
+int srsran_pssch_encode_bytes(srsran_pssch_t* q, uint8_t* input, uint32_t input_len, cf_t* sf_buffer)
+{
+  if (!input || input_len > q->sl_sch_tb_len) {
+    ERROR("Can't encode PSSCH, input too long (%d > %d)\n", input_len, q->sl_sch_tb_len);
+    return SRSRAN_ERROR;
+  }
+
+  // Copy into codeword buffer
+  if (input != q->b_bytes) {
+    memcpy(q->b_bytes, input, sizeof(uint8_t) * ((input_len + 7) / 8));
+  }
+
+  if (pssch_encode_cbs(q)) {
+    return SRSRAN_ERROR;
   }
 
   // Interleaving
-  srsran_bit_pack_vector(q->f, q->f_bytes, q->G);
   srsran_sl_ulsch_interleave(q->f_bytes, q->Qm, q->G / q->Qm, q->nof_data_symbols, q->codeword_bytes);
-  srsran_bit_unpack_vector(q->codeword_bytes, q->codeword, q->G);
 
   // Scrambling follows 3GPP TS 36.211 version 15.6.0 Release 15 Sec. 9.3.1
-  srsran_sequence_LTE_pr(
-      &q->scrambling_seq, q->G, q->pssch_cfg.N_x_id * 16384 + (q->pssch_cfg.sf_idx % 10) * 512 + 510);
-  srsran_scrambling_b(&q->scrambling_seq, q->codeword);
+  srsran_sequence_apply_packed(q->codeword_bytes,
+                               q->codeword_bytes,
+                               q->G,
+                               q->pssch_cfg.N_x_id * 16384 + (q->pssch_cfg.sf_idx % 10) * 512 + 510);
 
   // Modulation
-  srsran_mod_modulate(&q->mod[q->mod_idx], q->codeword, q->symbols, q->G);
+  srsran_mod_modulate_bytes(&q->mod[q->mod_idx], q->codeword_bytes, q->symbols, q->G);
 
   // Layer Mapping
   // Voided: Single layer
@@ -374,40 +413,18 @@ int srsran_pssch_encode(srsran_pssch_t* q, uint8_t* input, uint32_t input_len, c
 
 int srsran_pssch_decode(srsran_pssch_t* q, cf_t* equalized_sf_syms, uint8_t* output, uint32_t output_len)
 {
-  if (output_len < q->sl_sch_tb_len) {
-    ERROR("Can't decode PSSCH, provided buffer too small (%d < %d)\n", output_len, q->sl_sch_tb_len);
-    return SRSRAN_ERROR;
-  }
-
   // RE extraction
   if (q->nof_tx_re != srsran_pssch_get(q, equalized_sf_syms, q->scfdma_symbols)) {
     ERROR("There was an error getting the PSSCH symbols\n");
     return SRSRAN_ERROR;
   }
 
-  // Precoding
-  // Voided: Single antenna port
-  // 3GPP TS 36.211 version 15.6.0 Release 15 Sec. 9.3.5
-
-  // Transform Predecoding
-  if (srsran_dft_precoding(
-          &q->idft_precoder, q->scfdma_symbols, q->symbols, q->pssch_cfg.nof_prb, q->nof_data_symbols) !=
-      SRSRAN_SUCCESS) {
-    return SRSRAN_ERROR;
-  }
-
-  // Layer Mapping
-  // Voided: Single layer
-  // 3GPP TS 36.211 version 15.6.0 Release 15 Sec. 9.3.3
-
-  // Demodulation
-  srsran_demod_soft_demodulate_s(q->Qm / 2, q->symbols, q->llr, q->G / q->Qm);
-
-  // Descramble follows 3GPP TS 36.211 version 15.6.0 Release 15 Sec. 9.3.1
-  srsran_sequence_LTE_pr(
-      &q->scrambling_seq, q->G, q->pssch_cfg.N_x_id * 16384 + (q->pssch_cfg.sf_idx % 10) * 512 + 510);
-  srsran_scrambling_s(&q->scrambling_seq, q->llr);
+  return srsran_pssch_decode_scfdma(q, output, output_len);
+}
 
+/* Rate matching, turbo decoding and CRC checks of the deinterleaved LLRs in q->f_16 */
+static int pssch_decode_cbs(srsran_pssch_t* q, uint8_t* output)
+{
   srsran_cbsegm(&q->cb_segm, q->sl_sch_tb_len);
   uint32_t L = SRSRAN_PSSCH_CRC_LEN;
   if (q->cb_segm.C == 1) {
@@ -421,9 +438,6 @@ int srsran_pssch_decode(srsran_pssch_t* q, cf_t* equalized_sf_syms, uint8_t* out
   uint32_t Gp    = q->E / q->Qm;
   uint32_t gamma = Gp % q->cb_segm.C;
 
-  // Deinterleaving
-  srsran_sl_ulsch_deinterleave(q->llr, q->Qm, q->G / q->Qm, q->nof_data_symbols, q->f_16, q->interleaver_lut);
-
   for (int r = 0; r < q->cb_segm.C; r++) {
     // Code block segmentation
     if (r < q->cb_segm.C2) {
@@ -492,6 +506,50 @@ int srsran_pssch_decode(srsran_pssch_t* q, cf_t* equalized_sf_syms, uint8_t* out
   return SRSRAN_SUCCESS;
 }
 
+int srsran_pssch_decode_scfdma(srsran_pssch_t* q, uint8_t* output, uint32_t output_len)
+{
+  if (output_len < q->sl_sch_tb_len) {
+    ERROR("Can't decode PSSCH, provided buffer too small (%d < %d)\n", output_len, q->sl_sch_tb_len);
+    return SRSRAN_ERROR;
+  }
+
+  SRSRAN_SL_PROF_START(t_demod);
+
+  // Precoding
+  // Voided: Single antenna port
+  // 3GPP TS 36.211 version 15.6.0 Release 15 Sec. 9.3.5
+
+  // Transform Predecoding
+  if (srsran_dft_precoding(
+          &q->idft_precoder, q->scfdma_symbols, q->symbols, q->pssch_cfg.nof_prb, q->nof_data_symbols) !=
+      SRSRAN_SUCCESS) {
+    return SRSRAN_ERROR;
+  }
+
+  // Layer Mapping
+  // Voided: Single layer
+  // 3GPP TS 36.211 version 15.6.0 Release 15 Sec. 9.3.3
+
+  // Demodulation
+  srsran_demod_soft_demodulate_s(q->Qm / 2, q->symbols, q->llr, q->G / q->Qm);
+
+  // Descramble follows 3GPP TS 36.211 version 15.6.0 Release 15 Sec. 9.3.1
+  srsran_sequence_LTE_pr(
+      &q->scrambling_seq, q->G, q->pssch_cfg.N_x_id * 16384 + (q->pssch_cfg.sf_idx % 10) * 512 + 510);
+  srsran_scrambling_s(&q->scrambling_seq, q->llr);
+
+  // Deinterleaving
+  srsran_sl_ulsch_deinterleave(q->llr, q->Qm, q->G / q->Qm, q->nof_data_symbols, q->f_16, q->interleaver_lut);
+
+  SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_RX_PSSCH_DEMOD, t_demod);
+
+  SRSRAN_SL_PROF_START(t_turbo);
+  int ret = pssch_decode_cbs(q, output);
+  SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_RX_PSSCH_TURBO, t_turbo);
+
+  return ret;
+}
+
 int srsran_pssch_put(srsran_pssch_t* q, cf_t* sf_buffer, cf_t* symbols)
 {
   uint32_t sample_pos = 0;
@@ -600,6 +658,9 @@ void srsran_pssch_free(srsran_pssch_t* q)
     if (q->b) {
       free(q->b);
     }
+    if (q->b_bytes) {
+      free(q->b_bytes);
+    }
     if (q->tb_crc_temp) {
       free(q->tb_crc_temp);
     }
@@ -0,0 +1,366 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/* Checks the packed PSSCH encoder against the former bit per byte chain, for every MCS and redundancy version, and
+ * times both per transport block */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/fec/rm_turbo.h"
+#include "srsran/phy/phch/pssch.h"
+#include "srsran/phy/phch/ra.h"
+#include "srsran/phy/phch/sch.h"
+#include "srsran/phy/scrambling/scrambling.h"
+#include "srsran/phy/utils/bit.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/random.h"
+#include "srsran/phy/utils/vector.h"
+
+srsran_cell_sl_t cell = {.nof_prb = 50, .N_sl_id = 0, .tm = SRSRAN_SIDELINK_TM4, .cp = SRSRAN_CP_NORM};
+
+// The circular buffer includes the sub-block interleaver dummy bits, 3 x 193 rows x 32 columns for 6144 bit CBs
+#define BIT_ENCODER_W_BUFF_LEN (3 * 193 * 32)
+
+static uint32_t nof_repetitions = 20;
+
+/* Buffers of the bit per byte encoder */
+typedef struct {
+  srsran_crc_t         tb_crc;
+  srsran_crc_t         cb_crc;
+  srsran_tcod_t        tcod;
+  srsran_sequence_t    seq;
+  srsran_modem_table_t mod[SRSRAN_MOD_NITEMS];
+  uint8_t*             b;
+  uint8_t*             c_r;
+  uint8_t*             d_r;
+  uint8_t*             e_r;
+  uint8_t*             buff_b;
+  uint8_t*             f;
+  uint8_t*             f_bytes;
+  uint8_t*             codeword;
+  uint8_t*             codeword_bytes;
+  cf_t*                symbols;
+} bit_encoder_t;
+
+void usage(char* prog)
+{
+  printf("Usage: %s [eprt]\n", prog);
+  printf("\t-p nof_prb [Default %d]\n", cell.nof_prb);
+  printf("\t-e extended CP [Default normal]\n");
+  printf("\t-r repetitions per MCS for the timing [Default %d]\n", nof_repetitions);
+  printf("\t-t Sidelink transmission mode {1,2,3,4} [Default %d]\n", (cell.tm + 1));
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "eprt")) != -1) {
+    switch (opt) {
+      case 'e':
+        cell.cp = SRSRAN_CP_EXT;
+        break;
+      case 'p':
+        cell.nof_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'r':
+        nof_repetitions = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 't':
+        if (srsran_sl_tm_to_cell_sl_tm_t(&cell, strtol(argv[optind], NULL, 10)) != SRSRAN_SUCCESS) {
+          usage(argv[0]);
+          exit(-1);
+        }
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  if (SRSRAN_CP_ISEXT(cell.cp) && cell.tm >= SRSRAN_SIDELINK_TM3) {
+    ERROR("Selected TM does not support extended CP");
+    usage(argv[0]);
+    exit(-1);
+  }
+}
+
+static int bit_encoder_init(bit_encoder_t* e)
+{
+  if (srsran_crc_init(&e->tb_crc, SRSRAN_LTE_CRC24A, SRSRAN_PSSCH_CRC_LEN) ||
+      srsran_crc_init(&e->cb_crc, SRSRAN_LTE_CRC24B, SRSRAN_PSSCH_CRC_LEN) ||
+      srsran_tcod_init(&e->tcod, SRSRAN_TCOD_MAX_LEN_CB) || srsran_sequence_init(&e->seq, SRSRAN_MAX_CODEWORD_LEN)) {
+    return SRSRAN_ERROR;
+  }
+  for (int i = 0; i < SRSRAN_MOD_NITEMS; i++) {
+    if (srsran_modem_table_lte(&e->mod[i], (srsran_mod_t)i)) {
+      return SRSRAN_ERROR;
+    }
+  }
+  e->b              = srsran_vec_u8_malloc(SRSRAN_SL_SCH_MAX_TB_LEN + SRSRAN_PSSCH_CRC_LEN);
+  e->c_r            = srsran_vec_u8_malloc(SRSRAN_TCOD_MAX_LEN_CB);
+  e->d_r            = srsran_vec_u8_malloc(SRSRAN_PSSCH_MAX_CODED_BITS);
+  e->e_r            = srsran_vec_u8_malloc(SRSRAN_MAX_CODEWORD_LEN);
+  e->buff_b         = srsran_vec_u8_malloc(BIT_ENCODER_W_BUFF_LEN);
+  e->f              = srsran_vec_u8_malloc(SRSRAN_MAX_CODEWORD_LEN);
+  e->f_bytes        = srsran_vec_u8_malloc(SRSRAN_MAX_CODEWORD_LEN / 8);
+  e->codeword       = srsran_vec_u8_malloc(SRSRAN_MAX_CODEWORD_LEN);
+  e->codeword_bytes = srsran_vec_u8_malloc(SRSRAN_MAX_CODEWORD_LEN / 8);
+  e->symbols        = srsran_vec_cf_malloc(SRSRAN_MAX_CODEWORD_LEN);
+  if (!e->b || !e->c_r || !e->d_r || !e->e_r || !e->buff_b || !e->f || !e->f_bytes || !e->codeword ||
+      !e->codeword_bytes || !e->symbols) {
+    ERROR("Error allocating memory\n");
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+static void bit_encoder_free(bit_encoder_t* e)
+{
+  srsran_tcod_free(&e->tcod);
+  srsran_sequence_free(&e->seq);
+  for (int i = 0; i < SRSRAN_MOD_NITEMS; i++) {
+    srsran_modem_table_free(&e->mod[i]);
+  }
+  free(e->b);
+  free(e->c_r);
+  free(e->d_r);
+  free(e->e_r);
+  free(e->buff_b);
+  free(e->f);
+  free(e->f_bytes);
+  free(e->codeword);
+  free(e->codeword_bytes);
+  free(e->symbols);
+}
+
+/* One bit per byte up to the modulation, as srsran_pssch_encode() used to do. Shares the DFT precoder and the RE
+ * mapping with q */
+static int bit_encode(bit_encoder_t* e, srsran_pssch_t* q, uint8_t* input, cf_t* sf_buffer)
+{
+  srsran_cbsegm_t cb_segm = {};
+  srsran_cbsegm(&cb_segm, q->sl_sch_tb_len);
+  uint32_t L = (cb_segm.C == 1) ? 0 : SRSRAN_PSSCH_CRC_LEN;
+
+  uint32_t K_r   = 0;
+  uint32_t E_r   = 0;
+  uint32_t s     = 0;
+  uint32_t G     = 0;
+  uint32_t Gp    = q->E / q->Qm;
+  uint32_t gamma = Gp % cb_segm.C;
+
+  memcpy(e->b, input, sizeof(uint8_t) * q->sl_sch_tb_len);
+  srsran_crc_attach(&e->tb_crc, e->b, q->sl_sch_tb_len);
+
+  for (int r = 0; r < cb_segm.C; r++) {
+    K_r = (r < cb_segm.C2) ? cb_segm.K2 : cb_segm.K1;
+    if (r <= (cb_segm.C - gamma - 1)) {
+      E_r = q->Qm * (Gp / cb_segm.C);
+    } else {
+      E_r = q->Qm * ((uint32_t)ceilf((float)Gp / cb_segm.C));
+    }
+
+    memcpy(e->c_r, &e->b[s], sizeof(uint8_t) * (K_r - L));
+    s += K_r - L;
+    if (cb_segm.C > 1) {
+      srsran_crc_attach(&e->cb_crc, e->c_r, (int)(K_r - L));
+    }
+
+    srsran_tcod_encode(&e->tcod, e->c_r, e->d_r, K_r);
+
+    srsran_vec_u8_zero(e->buff_b, BIT_ENCODER_W_BUFF_LEN);
+    srsran_rm_turbo_tx(e->buff_b, BIT_ENCODER_W_BUFF_LEN, e->d_r, 3 * K_r + SRSRAN_TCOD_TOTALTAIL, e->e_r, E_r, 0);
+    if (q->pssch_cfg.rv_idx > 0) {
+      srsran_rm_turbo_tx(e->buff_b,
+                         BIT_ENCODER_W_BUFF_LEN,
+                         e->d_r,
+                         3 * K_r + SRSRAN_TCOD_TOTALTAIL,
+                         e->e_r,
+                         E_r,
+                         srsran_pssch_rv[q->pssch_cfg.rv_idx]);
+    }
+
+    memcpy(&e->f[G], e->e_r, sizeof(uint8_t) * E_r);
+    G += E_r;
+  }
+
+  srsran_bit_pack_vector(e->f, e->f_bytes, G);
+  srsran_sl_ulsch_interleave(e->f_bytes, q->Qm, G / q->Qm, q->nof_data_symbols, e->codeword_bytes);
+  srsran_bit_unpack_vector(e->codeword_bytes, e->codeword, G);
+
+  srsran_sequence_LTE_pr(&e->seq, G, q->pssch_cfg.N_x_id * 16384 + (q->pssch_cfg.sf_idx % 10) * 512 + 510);
+  srsran_scrambling_b(&e->seq, e->codeword);
+
+  srsran_mod_modulate(&e->mod[q->mod_idx], e->codeword, e->symbols, G);
+  srsran_dft_precoding(&q->dft_precoder, e->symbols, q->scfdma_symbols, q->pssch_cfg.nof_prb, q->nof_data_symbols);
+  if (q->nof_tx_re != srsran_pssch_put(q, sf_buffer, q->scfdma_symbols)) {
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+static double time_us_per_tb(struct timeval* t)
+{
+  get_time_interval(t);
+  return (t[0].tv_sec * 1e6 + t[0].tv_usec) / nof_repetitions;
+}
+
+int main(int argc, char** argv)
+{
+  int ret = SRSRAN_ERROR;
+
+  parse_args(argc, argv);
+
+  srsran_sl_comm_resource_pool_t sl_comm_resource_pool;
+  if (srsran_sl_comm_resource_pool_get_default_config(&sl_comm_resource_pool, cell) != SRSRAN_SUCCESS) {
+    ERROR("Error initializing sl_comm_resource_pool\n");
+    return SRSRAN_ERROR;
+  }
+
+  srsran_pssch_t  pssch      = {};
+  bit_encoder_t   bit_enc    = {};
+  srsran_random_t random_gen = srsran_random_init(1234);
+  uint32_t        sf_n_re    = SRSRAN_SF_LEN_RE(cell.nof_prb, cell.cp);
+  cf_t*           sf_bits    = srsran_vec_cf_malloc(sf_n_re);
+  cf_t*           sf_bytes   = srsran_vec_cf_malloc(sf_n_re);
+  uint8_t*        tb         = srsran_vec_u8_malloc(SRSRAN_SL_SCH_MAX_TB_LEN);
+  uint8_t*        tb_bytes   = srsran_vec_u8_malloc(SRSRAN_SL_SCH_MAX_TB_LEN / 8);
+  if (!sf_bits || !sf_bytes || !tb || !tb_bytes) {
+    ERROR("Error allocating memory\n");
+    goto clean_exit;
+  }
+  srsran_vec_cf_zero(sf_bits, sf_n_re);
+  srsran_vec_cf_zero(sf_bytes, sf_n_re);
+
+  if (srsran_pssch_init(&pssch, cell, sl_comm_resource_pool) != SRSRAN_SUCCESS || bit_encoder_init(&bit_enc)) {
+    ERROR("Error initializing PSSCH\n");
+    goto clean_exit;
+  }
+
+  // Transform precoding and RE mapping are common to both encoders and left out of the timing
+  uint32_t nof_prb_pssch = srsran_dft_precoding_get_valid_prb(cell.nof_prb);
+  printf("%d PRB, time per TB in us without transform precoding\n", nof_prb_pssch);
+  printf("%4s %6s %10s %10s %10s %8s %10s\n", "mcs", "tbs", "bit/byte", "packed", "bytes in", "speedup", "dft+map");
+
+  for (uint32_t mcs = 0; mcs <= 28; mcs++) {
+    uint32_t tbs = srsran_ra_tbs_from_idx(srsran_ra_tbs_idx_from_mcs(mcs, false, true), nof_prb_pssch);
+    if (tbs > SRSRAN_SL_SCH_MAX_TB_LEN) {
+      printf("%4d %6d exceeds the maximum TBS\n", mcs, tbs);
+      continue;
+    }
+
+    for (uint32_t rv_idx = 0; rv_idx < 4; rv_idx++) {
+      srsran_pssch_cfg_t pssch_cfg = {0, nof_prb_pssch, 255, mcs, rv_idx, rv_idx + 3};
+      if (srsran_pssch_set_cfg(&pssch, pssch_cfg) != SRSRAN_SUCCESS) {
+        ERROR("Error configuring PSSCH\n");
+        goto clean_exit;
+      }
+      for (uint32_t i = 0; i < pssch.sl_sch_tb_len; i++) {
+        tb[i] = srsran_random_uniform_int_dist(random_gen, 0, 1);
+      }
+      srsran_bit_pack_vector(tb, tb_bytes, pssch.sl_sch_tb_len);
+
+      // Both encoders fill the same REs with the same symbols
+      if (bit_encode(&bit_enc, &pssch, tb, sf_bits) || srsran_pssch_encode(&pssch, tb, pssch.sl_sch_tb_len, sf_bytes)) {
+        ERROR("Error encoding PSSCH\n");
+        goto clean_exit;
+      }
+      if (memcmp(sf_bits, sf_bytes, sizeof(cf_t) * sf_n_re) != 0) {
+        ERROR("Packed encoder output differs for mcs=%d, rv_idx=%d\n", mcs, rv_idx);
+        goto clean_exit;
+      }
+      srsran_vec_cf_zero(sf_bytes, sf_n_re);
+      if (srsran_pssch_encode_bytes(&pssch, tb_bytes, pssch.sl_sch_tb_len, sf_bytes) ||
+          memcmp(sf_bits, sf_bytes, sizeof(cf_t) * sf_n_re) != 0) {
+        ERROR("Packed input encoder output differs for mcs=%d, rv_idx=%d\n", mcs, rv_idx);
+        goto clean_exit;
+      }
+    }
+
+    // Timing of the first transmission
+    srsran_pssch_cfg_t pssch_cfg = {0, nof_prb_pssch, 255, mcs, 0, 0};
+    srsran_pssch_set_cfg(&pssch, pssch_cfg);
+
+    struct timeval t[3];
+    gettimeofday(&t[1], NULL);
+    for (uint32_t i = 0; i < nof_repetitions; i++) {
+      srsran_dft_precoding(
+          &pssch.dft_precoder, pssch.symbols, pssch.scfdma_symbols, pssch.pssch_cfg.nof_prb, pssch.nof_data_symbols);
+      srsran_pssch_put(&pssch, sf_bytes, pssch.scfdma_symbols);
+    }
+    gettimeofday(&t[2], NULL);
+    double dft_us = time_us_per_tb(t);
+
+    gettimeofday(&t[1], NULL);
+    for (uint32_t i = 0; i < nof_repetitions; i++) {
+      bit_encode(&bit_enc, &pssch, tb, sf_bits);
+    }
+    gettimeofday(&t[2], NULL);
+    double bits_us = time_us_per_tb(t) - dft_us;
+
+    gettimeofday(&t[1], NULL);
+    for (uint32_t i = 0; i < nof_repetitions; i++) {
+      srsran_pssch_encode(&pssch, tb, pssch.sl_sch_tb_len, sf_bytes);
+    }
+    gettimeofday(&t[2], NULL);
+    double packed_us = time_us_per_tb(t) - dft_us;
+
+    gettimeofday(&t[1], NULL);
+    for (uint32_t i = 0; i < nof_repetitions; i++) {
+      srsran_pssch_encode_bytes(&pssch, tb_bytes, pssch.sl_sch_tb_len, sf_bytes);
+    }
+    gettimeofday(&t[2], NULL);
+    double bytes_us = time_us_per_tb(t) - dft_us;
+
+    printf("%4d %6d %10.1f %10.1f %10.1f %7.1fx %10.1f\n",
+           mcs,
+           pssch.sl_sch_tb_len,
+           bits_us,
+           packed_us,
+           bytes_us,
+           packed_us > 0 ? bits_us / packed_us : 0,
+           dft_us);
+  }
+
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_random_free(random_gen);
+  if (sf_bits) {
+    free(sf_bits);
+  }
+  if (sf_bytes) {
+    free(sf_bytes);
+  }
+  if (tb) {
+    free(tb);
+  }
+  if (tb_bytes) {
+    free(tb_bytes);
+  }
+  bit_encoder_free(&bit_enc);
+  srsran_pssch_free(&pssch);
+
+  printf("%s", ret == SRSRAN_SUCCESS ? "SUCCESS\n" : "FAILED\n");
+  return ret;
+}
@@ -19,9 +19,12 @@
  *
  */
 
+#include <complex.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/time.h>
 #include <unistd.h>
 
 #include "srsran/phy/ch_estimation/chest_sl.h"
@@ -40,32 +43,58 @@ static char*            input_file_name = NULL;
 static srsran_cell_sl_t cell            = {.nof_prb = 6, .N_sl_id = 0, .tm = SRSRAN_SIDELINK_TM2, .cp = SRSRAN_CP_NORM};
 static bool             use_standard_lte_rates = false;
 static uint32_t         file_offset            = 0;
-
-static uint32_t                       sf_n_samples          = 0;
-static uint32_t                       sf_n_re               = 0;
-static cf_t*                          sf_buffer             = NULL;
-static cf_t*                          equalized_sf_buffer   = NULL;
-static cf_t*                          input_buffer          = NULL;
-static srsran_sci_t                   sci                   = {};
-static srsran_pscch_t                 pscch                 = {};
-static srsran_chest_sl_t              pscch_chest           = {};
-static srsran_pssch_t                 pssch                 = {};
-static srsran_chest_sl_t              pssch_chest           = {};
-static srsran_ofdm_t                  fft                   = {};
-static srsran_sl_comm_resource_pool_t sl_comm_resource_pool = {};
-static uint32_t                       size_sub_channel      = 10;
-static uint32_t                       num_sub_channel       = 5;
-static uint32_t                       current_sf_idx        = 0;
+static bool             use_wiener             = false;
+static float            awgn_snr_db            = NAN;
+static uint32_t         nof_passes             = 1;
+static uint32_t         nof_rx_antennas        = 1;
+
+static uint32_t                       sf_n_samples                   = 0;
+static uint32_t                       sf_n_re                        = 0;
+static cf_t*                          sf_buffer[SRSRAN_MAX_PORTS]    = {};
+static cf_t*                          equalized_sf_buffer            = NULL;
+static cf_t*                          input_buffer[SRSRAN_MAX_PORTS] = {};
+static cf_t                           port_phase[SRSRAN_MAX_PORTS]   = {};
+static srsran_sci_t                   sci                            = {};
+static srsran_pscch_t                 pscch                          = {};
+static srsran_chest_sl_t              pscch_chest                    = {};
+static srsran_pssch_t                 pssch                          = {};
+static srsran_chest_sl_t              pssch_chest                    = {};
+static srsran_ofdm_t                  fft[SRSRAN_MAX_PORTS]          = {};
+static srsran_sl_comm_resource_pool_t sl_comm_resource_pool          = {};
+static uint32_t                       size_sub_channel               = 10;
+static uint32_t                       num_sub_channel                = 5;
+static uint32_t                       current_sf_idx                 = 0;
 
 static srsran_chest_sl_cfg_t pscch_chest_sl_cfg = {};
 static srsran_chest_sl_cfg_t pssch_chest_sl_cfg = {};
 
-static srsran_filesource_t fsrc = {};
+static srsran_filesource_t   fsrc = {};
+static srsran_channel_awgn_t awgn = {};
+
+// Time spent in the FFTs and in the channel estimation and combining
+static struct timeval fft_time   = {};
+static struct timeval chest_time = {};
+static uint32_t       nof_chest  = 0;
+
+// Decoded over all the passes
+static uint32_t num_decoded_sci = 0;
+static uint32_t num_decoded_tb  = 0;
+
+static void add_time(struct timeval* acc, struct timeval* t)
+{
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  timeradd(acc, &t[0], acc);
+}
 
 void usage(char* prog)
 {
-  printf("Usage: %s [deinopstv]\n", prog);
+  printf("Usage: %s [AadeinopRstvw]\n", prog);
   printf("\t-i input_file_name\n");
+  printf("\t-A receive antennas, each gets the file with its own phase and noise [Default %d]\n", nof_rx_antennas);
+  printf("\t-a add AWGN at this SNR in dB, relative to the power of each subframe [Default none]\n");
+  printf("\t-R passes over the file, each with a new noise realization [Default %d]\n", nof_passes);
+  printf("\t-w Wiener channel estimation instead of LS [Default %i]\n", use_wiener);
   printf("\t-o File offset samples [Default %d]\n", file_offset);
   printf("\t-p nof_prb [Default %d]\n", cell.nof_prb);
   printf("\t-s size_sub_channel [Default for 50 prbs %d]\n", size_sub_channel);
@@ -80,8 +109,20 @@ void usage(char* prog)
 void parse_args(int argc, char** argv)
 {
   int opt;
-  while ((opt = getopt(argc, argv, "deinmopstv")) != -1) {
+  while ((opt = getopt(argc, argv, "Aa:deinmopRstvw")) != -1) {
     switch (opt) {
+      case 'a':
+        awgn_snr_db = strtof(optarg, NULL); // Takes negative values
+        break;
+      case 'A':
+        nof_rx_antennas = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'R':
+        nof_passes = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'w':
+        use_wiener = true;
+        break;
       case 'd':
         use_standard_lte_rates = true;
         break;
@@ -125,6 +166,11 @@ void parse_args(int argc, char** argv)
     usage(argv[0]);
     exit(-1);
   }
+  if (nof_rx_antennas == 0 || nof_rx_antennas > SRSRAN_MAX_PORTS) {
+    ERROR("Invalid number of receive antennas\n");
+    usage(argv[0]);
+    exit(-1);
+  }
 }
 
 int base_init()
@@ -139,12 +185,19 @@ int base_init()
   sl_comm_resource_pool.num_sub_channel  = num_sub_channel;
   sl_comm_resource_pool.size_sub_channel = size_sub_channel;
 
-  sf_buffer = srsran_vec_cf_malloc(sf_n_re);
-  if (!sf_buffer) {
-    ERROR("Error allocating memory\n");
-    return SRSRAN_ERROR;
+  for (uint32_t p = 0; p < nof_rx_antennas; p++) {
+    sf_buffer[p]    = srsran_vec_cf_malloc(sf_n_re);
+    input_buffer[p] = srsran_vec_cf_malloc(sf_n_samples);
+    if (!sf_buffer[p] || !input_buffer[p]) {
+      ERROR("Error allocating memory\n");
+      return SRSRAN_ERROR;
+    }
+    srsran_vec_cf_zero(sf_buffer[p], sf_n_re);
+    srsran_vec_cf_zero(input_buffer[p], sf_n_samples);
+
+    // The antennas see the same channel up to a phase, and their own noise
+    port_phase[p] = cexpf(_Complex_I * 2.0f * (float)M_PI * p / nof_rx_antennas);
   }
-  srsran_vec_cf_zero(sf_buffer, sf_n_re);
 
   equalized_sf_buffer = srsran_vec_cf_malloc(sf_n_re);
   if (!equalized_sf_buffer) {
@@ -153,13 +206,6 @@ int base_init()
   }
   srsran_vec_cf_zero(equalized_sf_buffer, sf_n_re);
 
-  input_buffer = srsran_vec_cf_malloc(sf_n_samples);
-  if (!input_buffer) {
-    ERROR("Error allocating memory\n");
-    return SRSRAN_ERROR;
-  }
-  srsran_vec_cf_zero(input_buffer, sf_n_samples);
-
   srsran_sci_init(&sci, cell, sl_comm_resource_pool);
 
   if (srsran_pscch_init(&pscch, SRSRAN_MAX_PRB) != SRSRAN_SUCCESS) {
@@ -197,12 +243,25 @@ int base_init()
     return SRSRAN_ERROR;
   }
 
-  if (srsran_ofdm_rx_init(&fft, cell.cp, input_buffer, sf_buffer, cell.nof_prb)) {
-    fprintf(stderr, "Error creating FFT object\n");
+  if (srsran_channel_awgn_init(&awgn, 1234) != SRSRAN_SUCCESS) {
+    ERROR("Error initializing AWGN channel\n");
     return SRSRAN_ERROR;
   }
-  srsran_ofdm_set_normalize(&fft, true);
-  srsran_ofdm_set_freq_shift(&fft, -0.5);
+
+  // The Wiener estimator and the combining of several antennas are only available with the estimation and
+  // equalization straight into the SC-FDMA symbols
+  srsran_chest_sl_estimator_alg_t alg = use_wiener ? SRSRAN_SL_ESTIMATOR_ALG_WIENER : SRSRAN_SL_ESTIMATOR_ALG_LS;
+  pscch_chest_sl_cfg.estimator_alg    = alg;
+  pssch_chest_sl_cfg.estimator_alg    = alg;
+
+  for (uint32_t p = 0; p < nof_rx_antennas; p++) {
+    if (srsran_ofdm_rx_init(&fft[p], cell.cp, input_buffer[p], sf_buffer[p], cell.nof_prb)) {
+      fprintf(stderr, "Error creating FFT object\n");
+      return SRSRAN_ERROR;
+    }
+    srsran_ofdm_set_normalize(&fft[p], true);
+    srsran_ofdm_set_freq_shift(&fft[p], -0.5);
+  }
 
   return SRSRAN_SUCCESS;
 }
@@ -210,7 +269,16 @@ int base_init()
 void base_free()
 {
   srsran_filesource_free(&fsrc);
-  srsran_ofdm_rx_free(&fft);
+  srsran_channel_awgn_free(&awgn);
+  for (uint32_t p = 0; p < SRSRAN_MAX_PORTS; p++) {
+    srsran_ofdm_rx_free(&fft[p]);
+    if (sf_buffer[p]) {
+      free(sf_buffer[p]);
+    }
+    if (input_buffer[p]) {
+      free(input_buffer[p]);
+    }
+  }
 
   srsran_sci_free(&sci);
   srsran_pscch_free(&pscch);
@@ -219,37 +287,54 @@ void base_free()
   srsran_pssch_free(&pssch);
   srsran_chest_sl_free(&pssch_chest);
 
-  if (sf_buffer) {
-    free(sf_buffer);
-  }
   if (equalized_sf_buffer) {
     free(equalized_sf_buffer);
   }
-  if (input_buffer) {
-    free(input_buffer);
-  }
 }
 
-int main(int argc, char** argv)
+static bool use_scfdma_chest()
 {
-  uint8_t sci_rx[SRSRAN_SCI_MAX_LEN] = {};
-  int     ret                        = SRSRAN_ERROR;
+  return use_wiener || nof_rx_antennas > 1;
+}
 
-  parse_args(argc, argv);
-  srsran_use_standard_symbol_size(use_standard_lte_rates);
+static int pscch_estimate_decode(uint8_t* sci_rx, uint32_t prb_start_idx)
+{
+  struct timeval t[3];
+  srsran_chest_sl_set_cfg(&pscch_chest, pscch_chest_sl_cfg);
+  if (use_scfdma_chest()) {
+    gettimeofday(&t[1], NULL);
+    srsran_chest_sl_ls_estimate_equalize_symbols_multi(&pscch_chest, sf_buffer, nof_rx_antennas, pscch.scfdma_symbols);
+    add_time(&chest_time, t);
+    nof_chest++;
+    return srsran_pscch_decode_scfdma(&pscch, sci_rx);
+  }
+  srsran_chest_sl_ls_estimate_equalize(&pscch_chest, sf_buffer[0], equalized_sf_buffer);
+  return srsran_pscch_decode(&pscch, equalized_sf_buffer, sci_rx, prb_start_idx);
+}
 
-  if (base_init()) {
-    ERROR("Error initializing\n");
-    base_free();
-    return SRSRAN_ERROR;
+static int pssch_estimate_decode(uint8_t* tb)
+{
+  struct timeval t[3];
+  srsran_chest_sl_set_cfg(&pssch_chest, pssch_chest_sl_cfg);
+  if (use_scfdma_chest()) {
+    gettimeofday(&t[1], NULL);
+    srsran_chest_sl_ls_estimate_equalize_symbols_multi(&pssch_chest, sf_buffer, nof_rx_antennas, pssch.scfdma_symbols);
+    add_time(&chest_time, t);
+    nof_chest++;
+    return srsran_pssch_decode_scfdma(&pssch, tb, SRSRAN_SL_SCH_MAX_TB_LEN);
   }
+  srsran_chest_sl_ls_estimate_equalize(&pssch_chest, sf_buffer[0], equalized_sf_buffer);
+  return srsran_pssch_decode(&pssch, equalized_sf_buffer, tb, SRSRAN_SL_SCH_MAX_TB_LEN);
+}
 
+/* Processes the file from file_offset until its end, or up to max_num_subframes. Returns the number of subframes
+ * processed, or SRSRAN_ERROR if the file could not be read */
+static int process_file()
+{
+  uint8_t  sci_rx[SRSRAN_SCI_MAX_LEN]      = {};
   bool     sci_decoded                     = false;
-  uint32_t num_decoded_sci                 = 0;
   char     sci_msg[SRSRAN_SCI_MSG_MAX_LEN] = {};
-
-  uint32_t num_decoded_tb               = 0;
-  uint8_t  tb[SRSRAN_SL_SCH_MAX_TB_LEN] = {};
+  uint8_t  tb[SRSRAN_SL_SCH_MAX_TB_LEN]    = {};
 
   int max_num_subframes = 128;
   int num_subframes     = 0;
@@ -258,25 +343,42 @@ int main(int argc, char** argv)
   uint32_t period_sf_idx        = 0;
   uint32_t allowed_pssch_sf_idx = 0;
 
-  if (file_offset > 0) {
-    printf("Offsetting file by %d samples.\n", file_offset);
-    srsran_filesource_seek(&fsrc, file_offset * sizeof(cf_t));
-  }
+  srsran_filesource_seek(&fsrc, file_offset * sizeof(cf_t));
 
   do {
-    nread = srsran_filesource_read(&fsrc, input_buffer, sf_n_samples);
+    nread = srsran_filesource_read(&fsrc, input_buffer[0], sf_n_samples);
     if (nread < 0) {
       fprintf(stderr, "Error reading from file\n");
-      return ret;
+      return SRSRAN_ERROR;
     } else if (nread == 0) {
-      goto clean_exit;
+      break;
     } else if (nread < sf_n_samples) {
       fprintf(stderr, "Couldn't read entire subframe. Still processing ..\n");
       nread = -1;
     }
 
+    for (uint32_t p = 1; p < nof_rx_antennas; p++) {
+      srsran_vec_sc_prod_ccc(input_buffer[0], port_phase[p], input_buffer[p], sf_n_samples);
+    }
+
+    // The SNR is relative to the whole subframe, so an allocation narrower than the carrier sees a lower one
+    if (!isnan(awgn_snr_db)) {
+      float signal_power = srsran_vec_avg_power_cf(input_buffer[0], sf_n_samples);
+      if (signal_power > 0.0f) {
+        srsran_channel_awgn_set_n0(&awgn, srsran_convert_power_to_dB(signal_power) - awgn_snr_db);
+        for (uint32_t p = 0; p < nof_rx_antennas; p++) {
+          srsran_channel_awgn_run_c(&awgn, input_buffer[p], input_buffer[p], sf_n_samples);
+        }
+      }
+    }
+
     // Convert to frequency domain
-    srsran_ofdm_rx_sf(&fft);
+    struct timeval t[3];
+    gettimeofday(&t[1], NULL);
+    for (uint32_t p = 0; p < nof_rx_antennas; p++) {
+      srsran_ofdm_rx_sf(&fft[p]);
+    }
+    add_time(&fft_time, t);
 
     if (cell.tm == SRSRAN_SIDELINK_TM1 || cell.tm == SRSRAN_SIDELINK_TM2) {
 
@@ -290,10 +392,7 @@ int main(int argc, char** argv)
 
           // PSCCH Channel estimation
           pscch_chest_sl_cfg.prb_start_idx = pscch_prb_start_idx;
-          srsran_chest_sl_set_cfg(&pscch_chest, pscch_chest_sl_cfg);
-          srsran_chest_sl_ls_estimate_equalize(&pscch_chest, sf_buffer, equalized_sf_buffer);
-
-          if (srsran_pscch_decode(&pscch, equalized_sf_buffer, sci_rx, pscch_prb_start_idx) == SRSRAN_SUCCESS) {
+          if (pscch_estimate_decode(sci_rx, pscch_prb_start_idx) == SRSRAN_SUCCESS) {
             if (srsran_sci_format0_unpack(&sci, sci_rx) == SRSRAN_SUCCESS) {
 
               srsran_sci_info(&sci, sci_msg, sizeof(sci_msg));
@@ -329,13 +428,11 @@ int main(int argc, char** argv)
           pssch_chest_sl_cfg.sf_idx        = current_sf_idx;
           pssch_chest_sl_cfg.prb_start_idx = pssch_prb_start_idx;
           pssch_chest_sl_cfg.nof_prb       = nof_prb_pssch;
-          srsran_chest_sl_set_cfg(&pssch_chest, pssch_chest_sl_cfg);
-          srsran_chest_sl_ls_estimate_equalize(&pssch_chest, sf_buffer, equalized_sf_buffer);
 
           srsran_pssch_cfg_t pssch_cfg = {
               pssch_prb_start_idx, nof_prb_pssch, sci.N_sa_id, sci.mcs_idx, rv_idx, current_sf_idx};
           if (srsran_pssch_set_cfg(&pssch, pssch_cfg) == SRSRAN_SUCCESS) {
-            if (srsran_pssch_decode(&pssch, equalized_sf_buffer, tb, SRSRAN_SL_SCH_MAX_TB_LEN) == SRSRAN_SUCCESS) {
+            if (pssch_estimate_decode(tb) == SRSRAN_SUCCESS) {
               srsran_vec_fprint_byte(stdout, tb, pssch.sl_sch_tb_len);
               num_decoded_tb++;
               printf("> Transport Block SUCCESS! TB count: %i\n", num_decoded_tb);
@@ -353,10 +450,7 @@ int main(int argc, char** argv)
           // PSCCH Channel estimation
           pscch_chest_sl_cfg.cyclic_shift  = cyclic_shift;
           pscch_chest_sl_cfg.prb_start_idx = pscch_prb_start_idx;
-          srsran_chest_sl_set_cfg(&pscch_chest, pscch_chest_sl_cfg);
-          srsran_chest_sl_ls_estimate_equalize(&pscch_chest, sf_buffer, equalized_sf_buffer);
-
-          if (srsran_pscch_decode(&pscch, equalized_sf_buffer, sci_rx, pscch_prb_start_idx) == SRSRAN_SUCCESS) {
+          if (pscch_estimate_decode(sci_rx, pscch_prb_start_idx) == SRSRAN_SUCCESS) {
             if (srsran_sci_format1_unpack(&sci, sci_rx) == SRSRAN_SUCCESS) {
               srsran_sci_info(&sci, sci_msg, sizeof(sci_msg));
               fprintf(stdout, "%s", sci_msg);
@@ -393,13 +487,11 @@ int main(int argc, char** argv)
               pssch_chest_sl_cfg.sf_idx        = current_sf_idx;
               pssch_chest_sl_cfg.prb_start_idx = pssch_prb_start_idx;
               pssch_chest_sl_cfg.nof_prb       = nof_prb_pssch;
-              srsran_chest_sl_set_cfg(&pssch_chest, pssch_chest_sl_cfg);
-              srsran_chest_sl_ls_estimate_equalize(&pssch_chest, sf_buffer, equalized_sf_buffer);
 
               srsran_pssch_cfg_t pssch_cfg = {
                   pssch_prb_start_idx, nof_prb_pssch, N_x_id, sci.mcs_idx, rv_idx, current_sf_idx};
               if (srsran_pssch_set_cfg(&pssch, pssch_cfg) == SRSRAN_SUCCESS) {
-                if (srsran_pssch_decode(&pssch, equalized_sf_buffer, tb, SRSRAN_SL_SCH_MAX_TB_LEN) == SRSRAN_SUCCESS) {
+                if (pssch_estimate_decode(tb) == SRSRAN_SUCCESS) {
                   srsran_vec_fprint_byte(stdout, tb, pssch.sl_sch_tb_len);
                   num_decoded_tb++;
                 }
@@ -435,10 +527,49 @@ int main(int argc, char** argv)
     period_sf_idx++;
   } while (nread > 0 && num_subframes < max_num_subframes);
 
-clean_exit:
+  return num_subframes;
+}
+
+int main(int argc, char** argv)
+{
+  int ret = SRSRAN_ERROR;
+
+  parse_args(argc, argv);
+  srsran_use_standard_symbol_size(use_standard_lte_rates);
+
+  if (base_init()) {
+    ERROR("Error initializing\n");
+    base_free();
+    return SRSRAN_ERROR;
+  }
+
+  if (file_offset > 0) {
+    printf("Offsetting file by %d samples.\n", file_offset);
+  }
+
+  // Every pass starts over from the same subframe, each with a new noise realization
+  uint32_t first_sf_idx  = current_sf_idx;
+  int      num_subframes = 0;
+  for (uint32_t pass = 0; pass < nof_passes; pass++) {
+    current_sf_idx = first_sf_idx;
+    num_subframes  = process_file();
+    if (num_subframes < 0) {
+      base_free();
+      return ret;
+    }
+  }
 
   base_free();
 
+  uint32_t total_subframes = SRSRAN_MAX(num_subframes, 1) * nof_passes;
+  printf("%d antennas: FFT %.1f us per subframe",
+         nof_rx_antennas,
+         (fft_time.tv_sec * 1e6 + fft_time.tv_usec) / total_subframes);
+  if (nof_chest) {
+    printf(", estimation and combining %.1f us per allocation",
+           (chest_time.tv_sec * 1e6 + chest_time.tv_usec) / nof_chest);
+  }
+  printf("\n");
   printf("num_decoded_sci=%d num_decoded_tb=%d\n", num_decoded_sci, num_decoded_tb);
 
   ret = (num_decoded_sci > 0) ? SRSRAN_SUCCESS : SRSRAN_ERROR;
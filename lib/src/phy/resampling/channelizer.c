@@ -0,0 +1,373 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "srsran/phy/resampling/channelizer.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/simd.h"
+#include "srsran/phy/utils/vector.h"
+
+// Taps are processed in blocks of two SIMD registers of interleaved complex samples
+#if SRSRAN_SIMD_F_SIZE
+#define CHANNELIZER_TAPS_ALIGN SRSRAN_SIMD_F_SIZE
+#else
+#define CHANNELIZER_TAPS_ALIGN 1
+#endif
+
+/* Zeroth order modified Bessel function of the first kind */
+static double bessel_i0(double x)
+{
+  double sum  = 1.0;
+  double term = 1.0;
+  for (uint32_t k = 1; k < 32; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+uint32_t srsran_channelizer_lowpass_nof_taps(float transition)
+{
+  // Kaiser's estimate of the filter order
+  uint32_t order = (uint32_t)ceil((SRSRAN_CHANNELIZER_ATTENUATION_DB - 8.0) / (2.285 * 2.0 * M_PI * transition));
+  return order + 1 + (order % 2);
+}
+
+void srsran_channelizer_lowpass(float* h, uint32_t nof_taps, float cutoff)
+{
+  double beta = 0.1102 * (SRSRAN_CHANNELIZER_ATTENUATION_DB - 8.7);
+  double M    = (nof_taps - 1) / 2.0;
+  double sum  = 0.0;
+
+  for (uint32_t n = 0; n < nof_taps; n++) {
+    double t    = n - M;
+    double sinc = (t == 0.0) ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+    double r    = (M > 0.0) ? t / M : 0.0;
+    double w    = bessel_i0(beta * sqrt(SRSRAN_MAX(0.0, 1.0 - r * r))) / bessel_i0(beta);
+    h[n]        = (float)(sinc * w);
+    sum += h[n];
+  }
+
+  // Unity DC gain
+  for (uint32_t n = 0; n < nof_taps; n++) {
+    h[n] = (float)(h[n] / sum);
+  }
+}
+
+/* Rounds the prototype length up, so that its group delay is an integer number of narrowband samples */
+static uint32_t channelizer_nof_taps(float transition, uint32_t ratio)
+{
+  uint32_t delay = (srsran_channelizer_lowpass_nof_taps(transition) - 1 + 2 * ratio - 1) / (2 * ratio);
+  return 2 * ratio * delay + 1;
+}
+
+int srsran_channelizer_init(srsran_channelizer_t* q,
+                            uint32_t              nof_channels,
+                            const float*          freq,
+                            uint32_t              decimation,
+                            float                 cutoff,
+                            float                 transition,
+                            uint32_t              max_nsamples)
+{
+  if (q == NULL || freq == NULL || nof_channels == 0 || nof_channels > SRSRAN_CHANNELIZER_MAX_CHANNELS ||
+      decimation == 0 || cutoff <= 0.0f || cutoff >= 0.5f || transition <= 0.0f || max_nsamples == 0) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  bzero(q, sizeof(srsran_channelizer_t));
+
+  q->nof_channels = nof_channels;
+  q->decimation   = decimation;
+  q->max_nsamples = max_nsamples;
+
+  q->nof_taps     = channelizer_nof_taps(transition, decimation);
+  q->nof_taps_pad = ((q->nof_taps + CHANNELIZER_TAPS_ALIGN - 1) / CHANNELIZER_TAPS_ALIGN) * CHANNELIZER_TAPS_ALIGN;
+
+  q->prototype = srsran_vec_f_malloc(q->nof_taps);
+  q->taps      = srsran_vec_f_malloc(2 * q->nof_taps_pad);
+  if (!q->prototype || !q->taps) {
+    ERROR("Error allocating memory\n");
+    goto clean_exit;
+  }
+  srsran_channelizer_lowpass(q->prototype, q->nof_taps, cutoff);
+
+  // Reverse and duplicate the taps. The padding goes first, so that the newest sample meets the first tap
+  srsran_vec_f_zero(q->taps, 2 * q->nof_taps_pad);
+  for (uint32_t i = 0; i < q->nof_taps; i++) {
+    uint32_t j         = q->nof_taps_pad - 1 - i;
+    q->taps[2 * j]     = q->prototype[i];
+    q->taps[2 * j + 1] = q->prototype[i];
+  }
+
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    q->freq[k]  = freq[k];
+    q->mixed[k] = srsran_vec_cf_malloc(q->nof_taps_pad - 1 + max_nsamples);
+    if (!q->mixed[k]) {
+      ERROR("Error allocating memory\n");
+      goto clean_exit;
+    }
+  }
+
+  srsran_channelizer_reset(q);
+
+  return SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_channelizer_free(q);
+  return SRSRAN_ERROR;
+}
+
+void srsran_channelizer_free(srsran_channelizer_t* q)
+{
+  if (q->prototype) {
+    free(q->prototype);
+  }
+  if (q->taps) {
+    free(q->taps);
+  }
+  for (uint32_t k = 0; k < SRSRAN_CHANNELIZER_MAX_CHANNELS; k++) {
+    if (q->mixed[k]) {
+      free(q->mixed[k]);
+    }
+  }
+  bzero(q, sizeof(srsran_channelizer_t));
+}
+
+void srsran_channelizer_reset(srsran_channelizer_t* q)
+{
+  for (uint32_t k = 0; k < q->nof_channels; k++) {
+    srsran_vec_cf_zero(q->mixed[k], q->nof_taps_pad - 1 + q->max_nsamples);
+    q->phase[k] = 0.0;
+  }
+}
+
+uint32_t srsran_channelizer_get_delay(const srsran_channelizer_t* q)
+{
+  return (q->nof_taps - 1) / (2 * q->decimation);
+}
+
+/* Filters interleaved complex samples with the duplicated real taps, len is a multiple of CHANNELIZER_TAPS_ALIGN */
+static inline cf_t channelizer_dot_prod(const float* x, const float* taps, uint32_t len)
+{
+  float re = 0.0f;
+  float im = 0.0f;
+
+#if SRSRAN_SIMD_F_SIZE
+  simd_f_t acc0 = srsran_simd_f_zero();
+  simd_f_t acc1 = srsran_simd_f_zero();
+  for (uint32_t i = 0; i < 2 * len; i += 2 * SRSRAN_SIMD_F_SIZE) {
+    acc0 = srsran_simd_f_add(acc0, srsran_simd_f_mul(srsran_simd_f_loadu(&x[i]), srsran_simd_f_load(&taps[i])));
+    acc1 = srsran_simd_f_add(acc1,
+                             srsran_simd_f_mul(srsran_simd_f_loadu(&x[i + SRSRAN_SIMD_F_SIZE]),
+                                               srsran_simd_f_load(&taps[i + SRSRAN_SIMD_F_SIZE])));
+  }
+
+  srsran_simd_aligned float acc[SRSRAN_SIMD_F_SIZE];
+  srsran_simd_f_store(acc, srsran_simd_f_add(acc0, acc1));
+  for (uint32_t i = 0; i < SRSRAN_SIMD_F_SIZE; i += 2) {
+    re += acc[i];
+    im += acc[i + 1];
+  }
+#else
+  for (uint32_t i = 0; i < 2 * len; i += 2) {
+    re += x[i] * taps[i];
+    im += x[i + 1] * taps[i + 1];
+  }
+#endif
+
+  return re + _Complex_I * im;
+}
+
+int srsran_channelizer_execute(srsran_channelizer_t* q,
+                               const cf_t*           input,
+                               cf_t*                 output[SRSRAN_CHANNELIZER_MAX_CHANNELS],
+                               uint32_t              nsamples)
+{
+  if (q == NULL || input == NULL || output == NULL || nsamples > q->max_nsamples || nsamples % q->decimation != 0) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t history = q->nof_taps_pad - 1;
+  uint32_t nof_out = nsamples / q->decimation;
+
+  for (uint32_t k = 0; k < q->nof_channels; k++) {
+    if (output[k] == NULL) {
+      return SRSRAN_ERROR_INVALID_INPUTS;
+    }
+
+    // Shift the channel to baseband, keeping the mixer phase continuous across calls
+    cf_t* mixed = q->mixed[k];
+    srsran_vec_apply_cfo(input, -q->freq[k], &mixed[history], nsamples);
+    cf_t phase = cexpf(-_Complex_I * 2.0f * (float)M_PI * (float)q->phase[k]);
+    srsran_vec_sc_prod_ccc(&mixed[history], phase, &mixed[history], nsamples);
+    q->phase[k] = fmod(q->phase[k] + (double)q->freq[k] * nsamples, 1.0);
+
+    // Only the kept outputs are computed
+    const float* x = (const float*)mixed;
+    for (uint32_t i = 0; i < nof_out; i++) {
+      output[k][i] = channelizer_dot_prod(&x[2 * i * q->decimation], q->taps, q->nof_taps_pad);
+    }
+
+    memmove(mixed, &mixed[nsamples], sizeof(cf_t) * history);
+  }
+
+  return (int)nof_out;
+}
+
+int srsran_channelizer_synth_init(srsran_channelizer_synth_t* q,
+                                  uint32_t                    nof_channels,
+                                  const float*                freq,
+                                  uint32_t                    interpolation,
+                                  float                       cutoff,
+                                  float                       transition,
+                                  uint32_t                    max_nsamples)
+{
+  if (q == NULL || freq == NULL || nof_channels == 0 || nof_channels > SRSRAN_CHANNELIZER_MAX_CHANNELS ||
+      interpolation == 0 || cutoff <= 0.0f || cutoff >= 0.5f || transition <= 0.0f || max_nsamples == 0) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  bzero(q, sizeof(srsran_channelizer_synth_t));
+
+  q->nof_channels  = nof_channels;
+  q->interpolation = interpolation;
+  q->max_nsamples  = max_nsamples;
+  q->nof_taps      = channelizer_nof_taps(transition, interpolation);
+
+  uint32_t branch_len = (q->nof_taps + interpolation - 1) / interpolation;
+  q->nof_phase_taps   = ((branch_len + CHANNELIZER_TAPS_ALIGN - 1) / CHANNELIZER_TAPS_ALIGN) * CHANNELIZER_TAPS_ALIGN;
+
+  q->prototype    = srsran_vec_f_malloc(q->nof_taps);
+  q->taps         = srsran_vec_f_malloc(2 * q->nof_phase_taps * interpolation);
+  q->interpolated = srsran_vec_cf_malloc(max_nsamples * interpolation);
+  if (!q->prototype || !q->taps || !q->interpolated) {
+    ERROR("Error allocating memory\n");
+    goto clean_exit;
+  }
+  srsran_channelizer_lowpass(q->prototype, q->nof_taps, cutoff);
+
+  /* Branch p holds the taps p, p + I, p + 2I, ... scaled by I to keep the channel power. Every branch is reversed
+   * and duplicated like the channelizer taps */
+  srsran_vec_f_zero(q->taps, 2 * q->nof_phase_taps * interpolation);
+  for (uint32_t i = 0; i < q->nof_taps; i++) {
+    float*   branch   = &q->taps[2 * q->nof_phase_taps * (i % interpolation)];
+    uint32_t j        = q->nof_phase_taps - 1 - i / interpolation;
+    branch[2 * j]     = q->prototype[i] * interpolation;
+    branch[2 * j + 1] = q->prototype[i] * interpolation;
+  }
+
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    q->freq[k]    = freq[k];
+    q->history[k] = srsran_vec_cf_malloc(q->nof_phase_taps - 1 + max_nsamples);
+    if (!q->history[k]) {
+      ERROR("Error allocating memory\n");
+      goto clean_exit;
+    }
+  }
+
+  srsran_channelizer_synth_reset(q);
+
+  return SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_channelizer_synth_free(q);
+  return SRSRAN_ERROR;
+}
+
+void srsran_channelizer_synth_free(srsran_channelizer_synth_t* q)
+{
+  if (q->prototype) {
+    free(q->prototype);
+  }
+  if (q->taps) {
+    free(q->taps);
+  }
+  if (q->interpolated) {
+    free(q->interpolated);
+  }
+  for (uint32_t k = 0; k < SRSRAN_CHANNELIZER_MAX_CHANNELS; k++) {
+    if (q->history[k]) {
+      free(q->history[k]);
+    }
+  }
+  bzero(q, sizeof(srsran_channelizer_synth_t));
+}
+
+void srsran_channelizer_synth_reset(srsran_channelizer_synth_t* q)
+{
+  for (uint32_t k = 0; k < q->nof_channels; k++) {
+    srsran_vec_cf_zero(q->history[k], q->nof_phase_taps - 1 + q->max_nsamples);
+    q->phase[k] = 0.0;
+  }
+}
+
+uint32_t srsran_channelizer_synth_get_delay(const srsran_channelizer_synth_t* q)
+{
+  return (q->nof_taps - 1) / (2 * q->interpolation);
+}
+
+int srsran_channelizer_synth_execute(srsran_channelizer_synth_t* q,
+                                     const cf_t*                 input[SRSRAN_CHANNELIZER_MAX_CHANNELS],
+                                     cf_t*                       output,
+                                     uint32_t                    nsamples)
+{
+  if (q == NULL || input == NULL || output == NULL || nsamples > q->max_nsamples) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t history = q->nof_phase_taps - 1;
+  uint32_t nof_out = nsamples * q->interpolation;
+
+  for (uint32_t k = 0; k < q->nof_channels; k++) {
+    if (input[k] == NULL) {
+      return SRSRAN_ERROR_INVALID_INPUTS;
+    }
+
+    // Every input sample produces one output sample per polyphase branch
+    cf_t* x = q->history[k];
+    srsran_vec_cf_copy(&x[history], input[k], nsamples);
+    for (uint32_t i = 0; i < nsamples; i++) {
+      for (uint32_t p = 0; p < q->interpolation; p++) {
+        q->interpolated[i * q->interpolation + p] = channelizer_dot_prod(
+            (const float*)&x[i], &q->taps[2 * q->nof_phase_taps * p], q->nof_phase_taps);
+      }
+    }
+    memmove(x, &x[nsamples], sizeof(cf_t) * history);
+
+    // Shift the channel to its center frequency, keeping the mixer phase continuous across calls
+    cf_t* mixed = (k == 0) ? output : q->interpolated;
+    srsran_vec_apply_cfo(q->interpolated, q->freq[k], mixed, nof_out);
+    cf_t phase = cexpf(_Complex_I * 2.0f * (float)M_PI * (float)q->phase[k]);
+    srsran_vec_sc_prod_ccc(mixed, phase, mixed, nof_out);
+    q->phase[k] = fmod(q->phase[k] + (double)q->freq[k] * nof_out, 1.0);
+
+    if (k > 0) {
+      srsran_vec_sum_ccc(output, mixed, output, nof_out);
+    }
+  }
+
+  return (int)nof_out;
+}
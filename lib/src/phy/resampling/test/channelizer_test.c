@@ -0,0 +1,381 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/ch_estimation/chest_sl.h"
+#include "srsran/phy/common/phy_common_sl.h"
+#include "srsran/phy/dft/ofdm.h"
+#include "srsran/phy/io/filesink.h"
+#include "srsran/phy/io/filesource.h"
+#include "srsran/phy/phch/pscch.h"
+#include "srsran/phy/phch/sci.h"
+#include "srsran/phy/resampling/channelizer.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+static char*            input_file_name  = NULL;
+static char*            output_file_name = NULL;
+static srsran_cell_sl_t cell = {.nof_prb = 50, .N_sl_id = 0, .tm = SRSRAN_SIDELINK_TM4, .cp = SRSRAN_CP_NORM};
+static bool             use_standard_lte_rates = false;
+static uint32_t         size_sub_channel       = 10;
+static uint32_t         num_sub_channel        = 5;
+static uint32_t         nof_channels           = 3;
+static float            channel_spacing        = 10e6;
+static float            weak_channel_db        = 20.0f; ///< Odd channels are weaker than their neighbours
+
+/* Minimal PSCCH receiver, one per channel output */
+typedef struct {
+  srsran_ofdm_t                  fft;
+  srsran_sci_t                   sci;
+  srsran_pscch_t                 pscch;
+  srsran_chest_sl_t              chest;
+  srsran_sl_comm_resource_pool_t pool;
+  cf_t*                          input;
+  cf_t*                          sf_buffer;
+  cf_t*                          equalized;
+} sci_rx_t;
+
+static int sci_rx_init(sci_rx_t* q, uint32_t sf_len)
+{
+  uint32_t sf_n_re = SRSRAN_SF_LEN_RE(cell.nof_prb, cell.cp);
+
+  if (srsran_sl_comm_resource_pool_get_default_config(&q->pool, cell) != SRSRAN_SUCCESS) {
+    return SRSRAN_ERROR;
+  }
+  q->pool.size_sub_channel = size_sub_channel;
+  q->pool.num_sub_channel  = num_sub_channel;
+
+  q->input     = srsran_vec_cf_malloc(sf_len);
+  q->sf_buffer = srsran_vec_cf_malloc(sf_n_re);
+  q->equalized = srsran_vec_cf_malloc(sf_n_re);
+  if (!q->input || !q->sf_buffer || !q->equalized) {
+    return SRSRAN_ERROR;
+  }
+
+  srsran_sci_init(&q->sci, cell, q->pool);
+  if (srsran_pscch_init(&q->pscch, SRSRAN_MAX_PRB) || srsran_pscch_set_cell(&q->pscch, cell) ||
+      srsran_chest_sl_init(&q->chest, SRSRAN_SIDELINK_PSCCH, cell, q->pool)) {
+    return SRSRAN_ERROR;
+  }
+
+  if (srsran_ofdm_rx_init(&q->fft, cell.cp, q->input, q->sf_buffer, cell.nof_prb)) {
+    return SRSRAN_ERROR;
+  }
+  srsran_ofdm_set_normalize(&q->fft, true);
+  srsran_ofdm_set_freq_shift(&q->fft, -0.5);
+
+  return SRSRAN_SUCCESS;
+}
+
+static void sci_rx_free(sci_rx_t* q)
+{
+  srsran_ofdm_rx_free(&q->fft);
+  srsran_sci_free(&q->sci);
+  srsran_pscch_free(&q->pscch);
+  srsran_chest_sl_free(&q->chest);
+  free(q->input);
+  free(q->sf_buffer);
+  free(q->equalized);
+}
+
+/* Returns the number of SCIs decoded in one subframe */
+static uint32_t sci_rx_decode(sci_rx_t* q, const cf_t* sf, uint32_t sf_len)
+{
+  uint8_t               sci_rx[SRSRAN_SCI_MAX_LEN] = {};
+  srsran_chest_sl_cfg_t chest_cfg                  = {};
+  uint32_t              nof_sci                    = 0;
+
+  srsran_vec_cf_copy(q->input, sf, sf_len);
+  srsran_ofdm_rx_sf(&q->fft);
+
+  for (uint32_t sub_channel_idx = 0; sub_channel_idx < q->pool.num_sub_channel; sub_channel_idx++) {
+    uint32_t prb_start_idx = sub_channel_idx * q->pool.size_sub_channel;
+    for (uint32_t cyclic_shift = 0; cyclic_shift <= 9; cyclic_shift += 3) {
+      chest_cfg.cyclic_shift  = cyclic_shift;
+      chest_cfg.prb_start_idx = prb_start_idx;
+      srsran_chest_sl_set_cfg(&q->chest, chest_cfg);
+      srsran_chest_sl_ls_estimate_equalize(&q->chest, q->sf_buffer, q->equalized);
+
+      if (srsran_pscch_decode(&q->pscch, q->equalized, sci_rx, prb_start_idx) == SRSRAN_SUCCESS &&
+          srsran_sci_format1_unpack(&q->sci, sci_rx) == SRSRAN_SUCCESS) {
+        nof_sci++;
+      }
+    }
+  }
+  return nof_sci;
+}
+
+void usage(char* prog)
+{
+  printf("Usage: %s [cdfinpsw]\n", prog);
+  printf("\t-i input narrowband sidelink file, replicated on every channel\n");
+  printf("\t-w write the synthetic wideband signal to a file\n");
+  printf("\t-c nof_channels [Default %d]\n", nof_channels);
+  printf("\t-f channel spacing in Hz [Default %.1f MHz]\n", channel_spacing / 1e6);
+  printf("\t-p nof_prb [Default %d]\n", cell.nof_prb);
+  printf("\t-s size_sub_channel [Default %d]\n", size_sub_channel);
+  printf("\t-n num_sub_channel [Default %d]\n", num_sub_channel);
+  printf("\t-d use_standard_lte_rates [Default %i]\n", use_standard_lte_rates);
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "cdfinpsw")) != -1) {
+    switch (opt) {
+      case 'c':
+        nof_channels = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'd':
+        use_standard_lte_rates = true;
+        break;
+      case 'f':
+        channel_spacing = strtof(argv[optind], NULL);
+        break;
+      case 'i':
+        input_file_name = argv[optind];
+        break;
+      case 'n':
+        num_sub_channel = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'p':
+        cell.nof_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        size_sub_channel = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'w':
+        output_file_name = argv[optind];
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  if (input_file_name == NULL || nof_channels == 0 || nof_channels > SRSRAN_CHANNELIZER_MAX_CHANNELS) {
+    usage(argv[0]);
+    exit(-1);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+  srsran_use_standard_symbol_size(use_standard_lte_rates);
+
+  uint32_t sf_len = srsran_symbol_sz(cell.nof_prb) * 15;
+  double   srate  = sf_len * 1000.0;
+
+  // Load the narrowband signal
+  srsran_filesource_t fsrc = {};
+  if (srsran_filesource_init(&fsrc, input_file_name, SRSRAN_COMPLEX_FLOAT_BIN)) {
+    ERROR("Error opening file %s\n", input_file_name);
+    return SRSRAN_ERROR;
+  }
+  uint32_t max_nof_sf = 20;
+  cf_t*    narrow     = srsran_vec_cf_malloc(max_nof_sf * sf_len);
+  int      nread      = srsran_filesource_read(&fsrc, narrow, max_nof_sf * sf_len);
+  srsran_filesource_free(&fsrc);
+  TESTASSERT(nread >= (int)sf_len);
+  uint32_t nof_sf = (uint32_t)nread / sf_len;
+  uint32_t len    = nof_sf * sf_len;
+
+  // The wideband rate covers all channels plus one channel bandwidth
+  uint32_t decimation = (uint32_t)ceil(((nof_channels - 1) * channel_spacing + srate) / srate);
+  double   srate_wide = srate * decimation;
+  float    occupied   = cell.nof_prb * SRSRAN_NRE * 15e3f;
+
+  float freq[SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
+  float gain[SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    freq[k] = (float)(((float)k - (nof_channels - 1) / 2.0f) * channel_spacing / srate_wide);
+    gain[k] = (k % 2) ? powf(10.0f, -weak_channel_db / 20.0f) : 1.0f;
+  }
+
+  srsran_channelizer_t channelizer = {};
+  TESTASSERT(srsran_channelizer_init(&channelizer,
+                                     nof_channels,
+                                     freq,
+                                     decimation,
+                                     (float)(channel_spacing / 2.0 / srate_wide),
+                                     (float)((channel_spacing - occupied) / srate_wide),
+                                     sf_len * decimation) == SRSRAN_SUCCESS);
+  uint32_t delay = srsran_channelizer_get_delay(&channelizer);
+
+  printf("%d channels spaced %.1f MHz, wideband rate %.2f MHz, decimation %d, %d taps, delay %d samples\n",
+         nof_channels,
+         channel_spacing / 1e6,
+         srate_wide / 1e6,
+         decimation,
+         channelizer.nof_taps,
+         delay);
+
+  srsran_channelizer_synth_t synth = {};
+  TESTASSERT(srsran_channelizer_synth_init(&synth,
+                                           nof_channels,
+                                           freq,
+                                           decimation,
+                                           (float)(channel_spacing / 2.0 / srate_wide),
+                                           (float)((channel_spacing - occupied) / srate_wide),
+                                           sf_len) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_channelizer_synth_get_delay(&synth) == delay);
+
+  // Every channel carries the input scaled by its gain, zero padded to flush both filters
+  uint32_t out_len                             = ((len + 2 * delay + sf_len - 1) / sf_len) * sf_len;
+  uint32_t wide_len                            = out_len * decimation;
+  cf_t*    wide                                = srsran_vec_cf_malloc(wide_len);
+  cf_t*    tx[SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
+  TESTASSERT(wide != NULL);
+
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    tx[k] = srsran_vec_cf_malloc(out_len);
+    TESTASSERT(tx[k] != NULL);
+    srsran_vec_cf_zero(tx[k], out_len);
+    srsran_vec_sc_prod_cfc(narrow, gain[k], tx[k], len);
+  }
+
+  // Synthesize the wideband signal one subframe at a time
+  struct timeval t[2];
+  gettimeofday(&t[0], NULL);
+  for (uint32_t sf = 0; sf < out_len / sf_len; sf++) {
+    const cf_t* ptr[SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
+    for (uint32_t k = 0; k < nof_channels; k++) {
+      ptr[k] = &tx[k][sf * sf_len];
+    }
+    TESTASSERT(srsran_channelizer_synth_execute(&synth, ptr, &wide[sf * sf_len * decimation], sf_len) ==
+               (int)(sf_len * decimation));
+  }
+  gettimeofday(&t[1], NULL);
+  double usec = (t[1].tv_sec - t[0].tv_sec) * 1e6 + (t[1].tv_usec - t[0].tv_usec);
+  printf("Synthesized %d samples in %.0f us, %.1f Msps (%.2f x real time)\n",
+         wide_len,
+         usec,
+         wide_len / usec,
+         (wide_len / srate_wide) / (usec / 1e6));
+
+  if (output_file_name) {
+    srsran_filesink_t fsink = {};
+    if (srsran_filesink_init(&fsink, output_file_name, SRSRAN_COMPLEX_FLOAT_BIN) == SRSRAN_SUCCESS) {
+      srsran_filesink_write(&fsink, wide, wide_len);
+      srsran_filesink_free(&fsink);
+      printf("Wideband signal written to %s\n", output_file_name);
+    }
+  }
+
+  // Channelize one subframe at a time
+  cf_t* rx[SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    rx[k] = srsran_vec_cf_malloc(out_len);
+  }
+
+  gettimeofday(&t[0], NULL);
+  for (uint32_t sf = 0; sf < out_len / sf_len; sf++) {
+    cf_t* ptr[SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
+    for (uint32_t k = 0; k < nof_channels; k++) {
+      ptr[k] = &rx[k][sf * sf_len];
+    }
+    TESTASSERT(srsran_channelizer_execute(&channelizer, &wide[sf * sf_len * decimation], ptr, sf_len * decimation) ==
+               (int)sf_len);
+  }
+  gettimeofday(&t[1], NULL);
+  usec = (t[1].tv_sec - t[0].tv_sec) * 1e6 + (t[1].tv_usec - t[0].tv_usec);
+  printf("Channelized %d samples in %.0f us, %.1f Msps (%.2f x real time)\n",
+         wide_len,
+         usec,
+         wide_len / usec,
+         (wide_len / srate_wide) / (usec / 1e6));
+
+  // Every channel must match its transmitted signal and decode as well as the original
+  sci_rx_t sci_rx = {};
+  TESTASSERT(sci_rx_init(&sci_rx, sf_len) == SRSRAN_SUCCESS);
+
+  uint32_t nof_sci_ref = 0;
+  for (uint32_t sf = 0; sf < nof_sf; sf++) {
+    nof_sci_ref += sci_rx_decode(&sci_rx, &narrow[sf * sf_len], sf_len);
+  }
+
+  // The error is measured on the resource grid, the input files carry noise outside the occupied band
+  uint32_t sf_n_re = SRSRAN_SF_LEN_RE(cell.nof_prb, cell.cp);
+  cf_t*    tx_re   = srsran_vec_cf_malloc(sf_n_re);
+
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    const cf_t* y   = &rx[k][2 * delay];
+    float       err = 0.0f;
+    float       pwr = 0.0f;
+    for (uint32_t sf = 0; sf < nof_sf; sf++) {
+      srsran_vec_cf_copy(sci_rx.input, &tx[k][sf * sf_len], sf_len);
+      srsran_ofdm_rx_sf(&sci_rx.fft);
+      srsran_vec_cf_copy(tx_re, sci_rx.sf_buffer, sf_n_re);
+      srsran_vec_cf_copy(sci_rx.input, &y[sf * sf_len], sf_len);
+      srsran_ofdm_rx_sf(&sci_rx.fft);
+      srsran_vec_sub_ccc(sci_rx.sf_buffer, tx_re, sci_rx.sf_buffer, sf_n_re);
+      err += srsran_vec_avg_power_cf(sci_rx.sf_buffer, sf_n_re);
+      pwr += srsran_vec_avg_power_cf(tx_re, sf_n_re);
+    }
+    float nmse_db = srsran_convert_power_to_dB(err / pwr);
+
+    uint32_t nof_sci = 0;
+    for (uint32_t sf = 0; sf < nof_sf; sf++) {
+      nof_sci += sci_rx_decode(&sci_rx, &y[sf * sf_len], sf_len);
+    }
+
+    printf("Channel %d: %+.1f MHz, gain %+.1f dB, NMSE %.1f dB, num_decoded_sci=%d/%d\n",
+           k,
+           freq[k] * srate_wide / 1e6,
+           20.0f * log10f(gain[k]),
+           nmse_db,
+           nof_sci,
+           nof_sci_ref);
+
+    TESTASSERT(nmse_db < -25.0f);
+    TESTASSERT(nof_sci == nof_sci_ref);
+  }
+  TESTASSERT(nof_sci_ref > 0);
+
+  free(tx_re);
+  sci_rx_free(&sci_rx);
+  srsran_channelizer_free(&channelizer);
+  srsran_channelizer_synth_free(&synth);
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    free(tx[k]);
+    free(rx[k]);
+  }
+  free(wide);
+  free(narrow);
+
+  printf("Ok\n");
+  return SRSRAN_SUCCESS;
+}
@@ -77,6 +77,7 @@ typedef struct {
                                     bool   blocking,
                                     bool   is_start_of_burst,
                                     bool   is_end_of_burst);
+  int (*srsran_rf_start_rx_stream_timed)(void* h, time_t secs, double frac_secs); ///< Optional, NULL if unsupported
 } rf_dev_t;
 
 /* Define implementation for UHD */
@@ -110,7 +111,8 @@ static rf_dev_t dev_uhd = {"UHD",
                            rf_uhd_recv_with_time,
                            rf_uhd_recv_with_time_multi,
                            rf_uhd_send_timed,
-                           .srsran_rf_send_timed_multi = rf_uhd_send_timed_multi};
+                           .srsran_rf_send_timed_multi      = rf_uhd_send_timed_multi,
+                           .srsran_rf_start_rx_stream_timed = rf_uhd_start_rx_stream_timed};
 #endif
 
 /* Define implementation for bladeRF */
@@ -177,7 +179,8 @@ static rf_dev_t dev_soapy = {"soapy",
                              rf_soapy_recv_with_time,
                              rf_soapy_recv_with_time_multi,
                              rf_soapy_send_timed,
-                             .srsran_rf_send_timed_multi = rf_soapy_send_timed_multi};
+                             .srsran_rf_send_timed_multi      = rf_soapy_send_timed_multi,
+                             .srsran_rf_start_rx_stream_timed = rf_soapy_start_rx_stream_timed};
 
 #endif
 
@@ -141,6 +141,22 @@ int srsran_rf_start_rx_stream(srsran_rf_t* rf, bool now)
   return ((rf_dev_t*)rf->dev)->srsran_rf_start_rx_stream(rf->handler, now);
 }
 
+/* Starts the Rx stream so the first received sample is at the given device time. Returns
+ * SRSRAN_ERROR_INVALID_COMMAND if the device does not support it, in which case the stream state is left untouched.
+ */
+int srsran_rf_start_rx_stream_timed(srsran_rf_t* rf, time_t secs, double frac_secs)
+{
+  if (!srsran_rf_has_start_rx_stream_timed(rf)) {
+    return SRSRAN_ERROR_INVALID_COMMAND;
+  }
+  return ((rf_dev_t*)rf->dev)->srsran_rf_start_rx_stream_timed(rf->handler, secs, frac_secs);
+}
+
+bool srsran_rf_has_start_rx_stream_timed(srsran_rf_t* rf)
+{
+  return rf != NULL && rf->dev != NULL && ((rf_dev_t*)rf->dev)->srsran_rf_start_rx_stream_timed != NULL;
+}
+
 int srsran_rf_stop_rx_stream(srsran_rf_t* rf)
 {
   return ((rf_dev_t*)rf->dev)->srsran_rf_stop_rx_stream(rf->handler);
@@ -223,6 +223,38 @@ int rf_soapy_start_rx_stream(void* h, bool now)
   return SRSRAN_SUCCESS;
 }
 
+int rf_soapy_start_rx_stream_timed(void* h, time_t secs, double frac_secs)
+{
+  rf_soapy_handler_t* handler = (rf_soapy_handler_t*)h;
+
+  // a start time in the past is rejected before the running stream is touched
+  long long timeNs = (long long)secs * 1000000000LL + llround(frac_secs * 1e9);
+  long long nowNs  = SoapySDRDevice_getHardwareTime(handler->device, NULL);
+  if (timeNs <= nowNs) {
+    printf("Requested Rx start time is %.3f s in the past.\n", (nowNs - timeNs) * 1e-9);
+    return SRSRAN_ERROR;
+  }
+
+  bool was_active = handler->rx_stream_active;
+  if (was_active) {
+    if (rf_soapy_stop_rx_stream(h) != SRSRAN_SUCCESS) {
+      return SRSRAN_ERROR;
+    }
+  }
+
+  if (SoapySDRDevice_activateStream(handler->device, handler->rxStream, SOAPY_SDR_HAS_TIME, timeNs, 0) != 0) {
+    printf("Error starting timed Rx streaming.\n");
+    // leave the stream as it was found
+    if (was_active) {
+      rf_soapy_start_rx_stream(h, true);
+    }
+    return SRSRAN_ERROR;
+  }
+
+  handler->rx_stream_active = true;
+  return SRSRAN_SUCCESS;
+}
+
 int rf_soapy_start_tx_stream(void* h)
 {
   rf_soapy_handler_t* handler = (rf_soapy_handler_t*)h;
@@ -40,6 +40,8 @@ SRSRAN_API int rf_soapy_close(void* h);
 
 SRSRAN_API int rf_soapy_start_rx_stream(void* h, bool now);
 
+SRSRAN_API int rf_soapy_start_rx_stream_timed(void* h, time_t secs, double frac_secs);
+
 SRSRAN_API int rf_soapy_stop_rx_stream(void* h);
 
 SRSRAN_API void rf_soapy_calibrate_tx(void* h);
@@ -50,6 +50,7 @@ typedef struct {
   srsran_rf_info_t info;
   size_t           rx_nof_samples;
   size_t           tx_nof_samples;
+  double           rx_start_timeout; ///< Extra timeout for the first reception after a timed stream start
   double           tx_rate;
   bool             dynamic_rate;
   bool             has_rssi;
@@ -413,6 +414,42 @@ int rf_uhd_start_rx_stream(void* h, bool now)
   return 0;
 }
 
+/* Starts streaming exactly at the given device time. Any running stream is stopped and its buffered samples are
+ * dropped, so the first sample received afterwards is the one at (secs, frac_secs). A start time in the past is
+ * rejected before the running stream is touched.
+ */
+int rf_uhd_start_rx_stream_timed(void* h, time_t secs, double frac_secs)
+{
+  rf_uhd_handler_t* handler = (rf_uhd_handler_t*)h;
+
+  time_t now_secs = 0;
+  double now_frac = 0.0;
+  uhd_usrp_get_time_now(handler->usrp, 0, &now_secs, &now_frac);
+  double wait = (double)(secs - now_secs) + (frac_secs - now_frac);
+  if (wait <= 0.0) {
+    ERROR("Requested Rx start time is %.3f s in the past\n", -wait);
+    return SRSRAN_ERROR;
+  }
+
+  rf_uhd_stop_rx_stream(h);
+  rf_uhd_flush_buffer(h);
+
+  uhd_stream_cmd_t stream_cmd = {.stream_mode         = UHD_STREAM_MODE_START_CONTINUOUS,
+                                 .stream_now          = false,
+                                 .time_spec_full_secs = secs,
+                                 .time_spec_frac_secs = frac_secs};
+  if (uhd_rx_streamer_issue_stream_cmd(handler->rx_stream, &stream_cmd) != UHD_ERROR_NONE) {
+    ERROR("Error starting timed Rx streaming\n");
+    rf_uhd_start_rx_stream(h, true);
+    return SRSRAN_ERROR;
+  }
+
+  // The first reception has to wait until the stream actually starts
+  handler->rx_start_timeout = wait;
+
+  return SRSRAN_SUCCESS;
+}
+
 int rf_uhd_stop_rx_stream(void* h)
 {
   rf_uhd_handler_t* handler    = (rf_uhd_handler_t*)h;
@@ -1010,8 +1047,9 @@ int rf_uhd_recv_with_time_multi(void*    h,
       size_t num_rx_samples = (num_samps_left > handler->rx_nof_samples) ? handler->rx_nof_samples : num_samps_left;
 
       rxd_samples = 0;
-      uhd_error error =
-          uhd_rx_streamer_recv(handler->rx_stream, buffs_ptr, num_rx_samples, md, 1.0, false, &rxd_samples);
+      uhd_error error = uhd_rx_streamer_recv(
+          handler->rx_stream, buffs_ptr, num_rx_samples, md, 1.0 + handler->rx_start_timeout, false, &rxd_samples);
+      handler->rx_start_timeout = 0.0;
       if (error) {
         ERROR("Error receiving from UHD: %d\n", error);
         log_rx_error(handler);
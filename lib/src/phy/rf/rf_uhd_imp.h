@@ -45,6 +45,8 @@ SRSRAN_API int rf_uhd_start_rx_stream(void* h, bool now);
 
 SRSRAN_API int rf_uhd_start_rx_stream_nsamples(void* h, uint32_t nsamples);
 
+SRSRAN_API int rf_uhd_start_rx_stream_timed(void* h, time_t secs, double frac_secs);
+
 SRSRAN_API int rf_uhd_stop_rx_stream(void* h);
 
 SRSRAN_API void rf_uhd_flush_buffer(void* h);
@@ -80,6 +80,22 @@ int srsran_psss_init(srsran_psss_t* q, uint32_t nof_prb, srsran_cp_t cp)
     srsran_ofdm_set_normalize(&psss_tx, true);
     srsran_ofdm_set_freq_shift(&psss_tx, 0.5);
 
+    // Both PSSS symbols are kept in time domain, including their cyclic prefixes, for tracking
+    uint32_t symbol_sz = srsran_symbol_sz(nof_prb);
+    if (SRSRAN_CP_ISNORM(cp)) {
+      q->psss_time_start = SRSRAN_CP_LEN_NORM(0, symbol_sz) + symbol_sz;
+      q->psss_time_len   = 2 * (SRSRAN_CP_LEN_NORM(1, symbol_sz) + symbol_sz);
+    } else {
+      q->psss_time_start = 0;
+      q->psss_time_len   = 2 * (SRSRAN_CP_LEN_EXT(symbol_sz) + symbol_sz);
+    }
+    for (uint32_t i = 0; i < 2; ++i) {
+      q->psss_time[i] = srsran_vec_cf_malloc(q->psss_time_len);
+      if (!q->psss_time[i]) {
+        return SRSRAN_ERROR;
+      }
+    }
+
     srsran_dft_plan_t plan;
     if (srsran_dft_plan(&plan, fft_size, SRSRAN_DFT_FORWARD, SRSRAN_DFT_COMPLEX)) {
       return SRSRAN_ERROR;
@@ -95,6 +111,10 @@ int srsran_psss_init(srsran_psss_t* q, uint32_t nof_prb, srsran_cp_t cp)
       srsran_psss_put_sf_buffer(q->psss_signal[N_id_2], q->input_pad_freq, nof_prb, cp);
       srsran_ofdm_tx_sf(&psss_tx);
 
+      srsran_vec_cf_copy(q->psss_time[N_id_2], &q->input_pad_time[q->psss_time_start], q->psss_time_len);
+      q->psss_time_energy[N_id_2] =
+          srsran_vec_avg_power_cf(q->psss_time[N_id_2], q->psss_time_len) * (float)q->psss_time_len;
+
       srsran_dft_run_c(&plan, q->input_pad_time, q->psss_sf_freq[N_id_2]);
       srsran_vec_conj_cc(q->psss_sf_freq[N_id_2], q->psss_sf_freq[N_id_2], fft_size);
     }
@@ -302,9 +322,58 @@ int srsran_psss_find(srsran_psss_t* q, cf_t* input, uint32_t nof_prb, srsran_cp_
   return SRSRAN_SUCCESS;
 }
 
+/** Tracks a known PSSS in time domain around its expected position.
+ * The input buffer must hold one subframe starting at its expected position. Only the 2 PSSS symbols are correlated
+ * against the stored replica, for each lag in [-max_offset, max_offset], which is much cheaper than the full-subframe
+ * search done by srsran_psss_find(). Negative lags are limited to the samples available before the PSSS symbols.
+ *
+ * On success, corr_peak_pos holds the lag (in samples) of the subframe start with respect to the expected
+ * position and corr_peak_value the normalized correlation (between 0 and 1).
+ */
+int srsran_psss_track(srsran_psss_t* q, const cf_t* input, uint32_t N_id_2, uint32_t max_offset)
+{
+  if (q == NULL || input == NULL || N_id_2 > 1 || q->psss_time[N_id_2] == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  const cf_t* ref     = q->psss_time[N_id_2];
+  float       ref_pow = q->psss_time_energy[N_id_2];
+  uint32_t    len     = q->psss_time_len;
+
+  int min_lag = -(int)SRSRAN_MIN(max_offset, q->psss_time_start);
+
+  float best_value = 0.0f;
+  int   best_lag   = 0;
+
+  for (int lag = min_lag; lag <= (int)max_offset; lag++) {
+    const cf_t* x     = &input[(int)q->psss_time_start + lag];
+    float       x_pow = srsran_vec_avg_power_cf(x, len) * (float)len;
+    if (!isnormal(x_pow)) {
+      continue;
+    }
+    cf_t  corr  = srsran_vec_dot_prod_conj_ccc(x, ref, len);
+    float value = (__real__ corr * __real__ corr + __imag__ corr * __imag__ corr) / (x_pow * ref_pow);
+    if (value > best_value) {
+      best_value = value;
+      best_lag   = lag;
+    }
+  }
+
+  q->N_id_2          = N_id_2;
+  q->corr_peak_pos   = best_lag;
+  q->corr_peak_value = best_value;
+
+  return (best_value >= SRSRAN_PSSS_TRACK_THRESHOLD) ? SRSRAN_SUCCESS : SRSRAN_ERROR;
+}
+
 void srsran_psss_free(srsran_psss_t* q)
 {
   if (q) {
+    for (int N_id_2 = 0; N_id_2 < 2; ++N_id_2) {
+      if (q->psss_time[N_id_2]) {
+        free(q->psss_time[N_id_2]);
+      }
+    }
     srsran_dft_plan_free(&q->plan_out);
     srsran_dft_plan_free(&q->plan_input);
 
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "srsran/phy/ue/ue_sl.h"
+#include "srsran/phy/ue/ue_sl_reservation.h"
+#include "srsran/srsran.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+uint32_t num_sub_channel = 5;
+uint32_t nof_subframes   = 3000;
+uint32_t start_tti       = 0xFFFFFFFF - 1000; ///< Subframe counter wraps around during the test
+
+/* Periodic sender, transmitting in subframe offset + k * period and retransmitting time_gap subframes later */
+typedef struct {
+  uint32_t period;
+  uint32_t offset;
+  uint32_t sub_channel_idx;
+  uint32_t l_sub_channel;
+  uint32_t cyclic_shift;
+  uint32_t priority;
+  uint32_t time_gap;
+} sender_t;
+
+static const sender_t senders[] = {
+    {100, 3, 0, 2, 3, 2, 4},
+    {50, 7, 2, 1, 9, 5, 0},
+    {20, 11, 3, 2, 0, 1, 2},
+    {100, 3, 4, 1, 6, 7, 0},
+};
+
+#define NOF_SENDERS (sizeof(senders) / sizeof(sender_t))
+
+static bool sender_is_active(const sender_t* s, uint32_t tti, bool* retransmission)
+{
+  uint32_t phase = (tti - start_tti) % s->period;
+  *retransmission = s->time_gap > 0 && phase == (s->offset + s->time_gap) % s->period;
+  return phase == s->offset || *retransmission;
+}
+
+static int test_periodic_senders()
+{
+  srsran_ue_sl_reservation_t q = {};
+  TESTASSERT(srsran_ue_sl_reservation_init(&q, num_sub_channel) == SRSRAN_SUCCESS);
+
+  srsran_ue_sl_candidate_t candidates[SRSRAN_MAX_NUM_SUB_CHANNEL];
+  uint32_t                 nof_tx = 0, nof_hit = 0, nof_predicted = 0;
+
+  for (uint32_t i = 0; i < nof_subframes; i++) {
+    uint32_t tti = start_tti + i;
+    uint32_t n   = srsran_ue_sl_reservation_get(&q, tti, candidates);
+    nof_predicted += n;
+
+    // Candidates are sorted by priority
+    for (uint32_t k = 1; k < n; k++) {
+      TESTASSERT(candidates[k - 1].priority <= candidates[k].priority);
+    }
+
+    for (uint32_t j = 0; j < NOF_SENDERS; j++) {
+      const sender_t* s              = &senders[j];
+      bool            retransmission = false;
+      if (!sender_is_active(s, tti, &retransmission)) {
+        continue;
+      }
+      nof_tx++;
+
+      // Once a full period has been observed, every transmission must have been predicted with its cyclic shift
+      bool hit = false;
+      for (uint32_t k = 0; k < n; k++) {
+        if (candidates[k].sub_channel_idx == s->sub_channel_idx) {
+          TESTASSERT(candidates[k].cyclic_shift == s->cyclic_shift);
+          TESTASSERT(candidates[k].priority == s->priority);
+          hit = true;
+        }
+      }
+      if (i >= s->period) {
+        TESTASSERT(hit);
+      }
+      nof_hit += hit;
+
+      srsran_sci_t sci = {};
+      srsran_set_sci(&sci, s->priority, s->period, s->time_gap, retransmission, 0, 10);
+      sci.riv = srsran_ra_sl_type0_to_riv(num_sub_channel, s->sub_channel_idx, s->l_sub_channel);
+      TESTASSERT(srsran_ue_sl_reservation_add(&q, &sci, tti, s->sub_channel_idx, s->cyclic_shift) >= 0);
+    }
+  }
+
+  // Nothing is predicted that is not transmitted
+  TESTASSERT(nof_predicted == nof_hit);
+
+  printf("Periodic senders: %d transmissions, %d predicted (%.1f%%)\n",
+         nof_tx,
+         nof_hit,
+         100.0f * nof_hit / nof_tx);
+
+  srsran_ue_sl_reservation_free(&q);
+  return SRSRAN_SUCCESS;
+}
+
+static int test_collision()
+{
+  srsran_ue_sl_reservation_t q = {};
+  TESTASSERT(srsran_ue_sl_reservation_init(&q, num_sub_channel) == SRSRAN_SUCCESS);
+
+  srsran_sci_t low = {}, high = {}, none = {};
+  srsran_set_sci(&low, 6, 100, 0, false, 0, 10);
+  srsran_set_sci(&high, 1, 100, 0, false, 0, 10);
+  srsran_set_sci(&none, 0, 0, 0, false, 0, 10);
+  none.resource_reserv = 0;
+
+  // Two senders announce the same resource, the higher priority one is kept regardless of the order
+  TESTASSERT(srsran_ue_sl_reservation_add(&q, &high, 10, 1, 3) == 1);
+  TESTASSERT(srsran_ue_sl_reservation_add(&q, &low, 10, 1, 6) == 0);
+  TESTASSERT(srsran_ue_sl_reservation_add(&q, &none, 10, 2, 9) == 0);
+
+  srsran_ue_sl_candidate_t candidates[SRSRAN_MAX_NUM_SUB_CHANNEL];
+  TESTASSERT(srsran_ue_sl_reservation_get(&q, 110, candidates) == 1);
+  TESTASSERT(candidates[0].cyclic_shift == 3);
+
+  // Stale entries of the same calendar slot are not returned
+  TESTASSERT(srsran_ue_sl_reservation_get(&q, 110 + SRSRAN_UE_SL_RESERVATION_HORIZON, candidates) == 0);
+
+  srsran_ue_sl_reservation_reset(&q);
+  TESTASSERT(srsran_ue_sl_reservation_get(&q, 110, candidates) == 0);
+
+  srsran_ue_sl_reservation_free(&q);
+  return SRSRAN_SUCCESS;
+}
+
+void usage(char* prog)
+{
+  printf("Usage: %s [ns]\n", prog);
+  printf("\t-n nof_subframes [Default %d]\n", nof_subframes);
+  printf("\t-s num_sub_channel [Default %d]\n", num_sub_channel);
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "ns")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_subframes = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        num_sub_channel = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  TESTASSERT(test_periodic_senders() == SRSRAN_SUCCESS);
+  TESTASSERT(test_collision() == SRSRAN_SUCCESS);
+
+  printf("Ok\n");
+  return SRSRAN_SUCCESS;
+}
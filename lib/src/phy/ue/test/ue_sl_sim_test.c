@@ -0,0 +1,269 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/ue/ue_sl_sim.h"
+#include "srsran/srsran.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+static uint32_t nof_vehicles = 5000;
+static uint32_t nof_seconds  = 10;
+static uint32_t nof_threads  = 1;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [jns]\n", prog);
+  printf("\t-j number of threads of the benchmark [Default %d]\n", nof_threads);
+  printf("\t-n number of vehicles of the benchmark [Default %d]\n", nof_vehicles);
+  printf("\t-s simulated seconds of the benchmark [Default %d]\n", nof_seconds);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "jns")) != -1) {
+    switch (opt) {
+      case 'j':
+        nof_threads = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'n':
+        nof_vehicles = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        nof_seconds = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+static srsran_cell_sl_t cell = {.nof_prb = 50, .N_sl_id = 0, .tm = SRSRAN_SIDELINK_TM4, .cp = SRSRAN_CP_NORM};
+static srsran_sl_comm_resource_pool_t pool = {};
+
+/* PRR over the distance buckets [0, max_m) */
+static double prr(const srsran_ue_sl_sim_stats_t* s, float bucket_m, float max_m)
+{
+  uint64_t nof_tx = 0, nof_rx = 0;
+  for (uint32_t b = 0; b < s->nof_buckets && b * bucket_m < max_m; b++) {
+    nof_tx += s->distance[b].nof_tx;
+    nof_rx += s->distance[b].nof_rx;
+  }
+  return nof_tx ? (double)nof_rx / nof_tx : NAN;
+}
+
+static int test_bler_tables()
+{
+  srsran_ue_sl_sim_cfg_t cfg;
+  srsran_ue_sl_sim_cfg_default(&cfg);
+  cfg.nof_vehicles = 10;
+
+  srsran_ue_sl_sim_t q = {};
+  TESTASSERT(srsran_ue_sl_sim_init(&q, &cfg, cell, &pool) == SRSRAN_SUCCESS);
+  TESTASSERT(q.tbs > 0 && q.code_rate > 0.0f && q.code_rate < 1.0f);
+
+  for (uint32_t c = 0; c < SRSRAN_UE_SL_SIM_NOF_CHANNELS; c++) {
+    TESTASSERT(srsran_ue_sl_sim_get_bler(&q, c, -20.0f) > 0.999f);
+    TESTASSERT(srsran_ue_sl_sim_get_bler(&q, c, 40.0f) < 1e-6f);
+    for (uint32_t i = 1; i < SRSRAN_UE_SL_SIM_BLER_LEN; i++) {
+      TESTASSERT(q.bler[c][i] <= q.bler[c][i - 1]);
+    }
+  }
+
+  // A higher MCS needs a higher SINR
+  float snr_low = 0.0f;
+  while (srsran_ue_sl_sim_get_bler(&q, SRSRAN_UE_SL_SIM_PSSCH, snr_low) > 0.1f) {
+    snr_low += 0.1f;
+  }
+  srsran_ue_sl_sim_free(&q);
+  cfg.mcs_idx = 20;
+  TESTASSERT(srsran_ue_sl_sim_init(&q, &cfg, cell, &pool) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_ue_sl_sim_get_bler(&q, SRSRAN_UE_SL_SIM_PSSCH, snr_low) > 0.5f);
+
+  // Curves given as points are interpolated and held outside
+  float sinr[] = {0.0f, 10.0f};
+  float bler[] = {1.0f, 0.0f};
+  TESTASSERT(srsran_ue_sl_sim_set_bler(&q, SRSRAN_UE_SL_SIM_PSSCH, sinr, bler, 2) == SRSRAN_SUCCESS);
+  TESTASSERT(fabsf(srsran_ue_sl_sim_get_bler(&q, SRSRAN_UE_SL_SIM_PSSCH, 5.0f) - 0.5f) < 0.01f);
+  TESTASSERT(srsran_ue_sl_sim_get_bler(&q, SRSRAN_UE_SL_SIM_PSSCH, -5.0f) == 1.0f);
+  TESTASSERT(srsran_ue_sl_sim_get_bler(&q, SRSRAN_UE_SL_SIM_PSSCH, 15.0f) == 0.0f);
+  float unsorted[] = {10.0f, 0.0f};
+  TESTASSERT(srsran_ue_sl_sim_set_bler(&q, SRSRAN_UE_SL_SIM_PSSCH, unsorted, bler, 2) != SRSRAN_SUCCESS);
+
+  srsran_ue_sl_sim_free(&q);
+  return SRSRAN_SUCCESS;
+}
+
+/* Two parked vehicles, distance_m apart, without shadowing nor fading */
+static int test_pair(float distance_m, bool in_coverage)
+{
+  srsran_ue_sl_sim_cfg_t cfg;
+  srsran_ue_sl_sim_cfg_default(&cfg);
+  cfg.nof_vehicles  = 2;
+  cfg.nof_lanes     = 1;
+  cfg.road_length_m = 2 * distance_m;
+  cfg.speed_kmph    = 0.0f;
+  cfg.shadowing_db  = 0.0f;
+  cfg.fading        = false;
+
+  srsran_ue_sl_sim_t q = {};
+  TESTASSERT(srsran_ue_sl_sim_init(&q, &cfg, cell, &pool) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_ue_sl_sim_run(&q, 10000) == SRSRAN_SUCCESS);
+
+  srsran_ue_sl_sim_stats_t s = {};
+  srsran_ue_sl_sim_get_stats(&q, &s);
+  srsran_ue_sl_sim_free(&q);
+
+  // One packet per vehicle and period, heard by the other one
+  TESTASSERT(s.nof_subframes == 10000);
+  TESTASSERT(s.nof_transmissions >= 2 * 10000 / cfg.period_ms - 2 && s.nof_transmissions <= 2 * 10000 / cfg.period_ms);
+  TESTASSERT(s.nof_links == s.nof_transmissions);
+  TESTASSERT(s.nof_reselections > 0);
+
+  uint64_t nof_rx = 0;
+  for (uint32_t b = 0; b < s.nof_buckets; b++) {
+    nof_rx += s.distance[b].nof_rx;
+    TESTASSERT(s.distance[b].nof_tx == 0 || b == (uint32_t)(hypotf(distance_m, cfg.lane_width_m) / 50.0f));
+  }
+  if (in_coverage) {
+    TESTASSERT(s.nof_pscch_fail == 0 && s.nof_pssch_fail == 0);
+    TESTASSERT(nof_rx + s.nof_half_duplex == s.nof_links);
+  } else {
+    TESTASSERT(nof_rx == 0);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+static int run_scenario(srsran_ue_sl_sim_cfg_t* cfg, uint32_t nof_subframes, srsran_ue_sl_sim_stats_t* s)
+{
+  srsran_ue_sl_sim_t q = {};
+  TESTASSERT(srsran_ue_sl_sim_init(&q, cfg, cell, &pool) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_ue_sl_sim_run(&q, nof_subframes) == SRSRAN_SUCCESS);
+  srsran_ue_sl_sim_get_stats(&q, s);
+  srsran_ue_sl_sim_free(&q);
+  return SRSRAN_SUCCESS;
+}
+
+/* The draws of the receivers do not depend on how they are split among threads */
+static int test_threads()
+{
+  srsran_ue_sl_sim_cfg_t cfg;
+  srsran_ue_sl_sim_cfg_default(&cfg);
+  cfg.nof_vehicles  = 1000;
+  cfg.road_length_m = 5000.0f;
+
+  srsran_ue_sl_sim_stats_t s1 = {}, s4 = {};
+  TESTASSERT(run_scenario(&cfg, 2000, &s1) == SRSRAN_SUCCESS);
+  cfg.nof_threads = 4;
+  TESTASSERT(run_scenario(&cfg, 2000, &s4) == SRSRAN_SUCCESS);
+
+  TESTASSERT(s1.nof_links > 0 && s1.nof_pscch_fail > 0 && s1.nof_pssch_fail > 0 && s1.nof_half_duplex > 0);
+  TESTASSERT(memcmp(&s1, &s4, sizeof(srsran_ue_sl_sim_stats_t)) == 0);
+
+  // PRR falls with the distance
+  TESTASSERT(prr(&s1, cfg.distance_bucket_m, 100.0f) > 0.9);
+  TESTASSERT(prr(&s1, cfg.distance_bucket_m, 100.0f) > prr(&s1, cfg.distance_bucket_m, 1000.0f));
+  return SRSRAN_SUCCESS;
+}
+
+/* With more vehicles than resources in range, sensing avoids the resources of the closest ones */
+static int test_sensing()
+{
+  srsran_ue_sl_sim_cfg_t cfg;
+  srsran_ue_sl_sim_cfg_default(&cfg);
+  cfg.nof_vehicles  = 1500;
+  cfg.road_length_m = 4000.0f;
+
+  srsran_ue_sl_sim_stats_t sensing = {}, random = {};
+  TESTASSERT(run_scenario(&cfg, 5000, &sensing) == SRSRAN_SUCCESS);
+  cfg.sensing = false;
+  TESTASSERT(run_scenario(&cfg, 5000, &random) == SRSRAN_SUCCESS);
+
+  double prr_sensing = prr(&sensing, cfg.distance_bucket_m, 200.0f);
+  double prr_random  = prr(&random, cfg.distance_bucket_m, 200.0f);
+  printf("PRR within 200 m: %.4f with sensing, %.4f with random selection\n", prr_sensing, prr_random);
+  TESTASSERT(prr_sensing > prr_random);
+  return SRSRAN_SUCCESS;
+}
+
+static int benchmark()
+{
+  srsran_ue_sl_sim_cfg_t cfg;
+  srsran_ue_sl_sim_cfg_default(&cfg);
+  cfg.road_length_m *= (float)nof_vehicles / cfg.nof_vehicles;
+  cfg.nof_vehicles = nof_vehicles;
+  cfg.nof_threads  = nof_threads;
+
+  srsran_ue_sl_sim_t q = {};
+  TESTASSERT(srsran_ue_sl_sim_init(&q, &cfg, cell, &pool) == SRSRAN_SUCCESS);
+
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+  TESTASSERT(srsran_ue_sl_sim_run(&q, nof_seconds * 1000) == SRSRAN_SUCCESS);
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+
+  srsran_ue_sl_sim_stats_t s = {};
+  srsran_ue_sl_sim_get_stats(&q, &s);
+  srsran_ue_sl_sim_fprint_stats(stdout, &q);
+  srsran_ue_sl_sim_free(&q);
+
+  double elapsed = t[0].tv_sec + t[0].tv_usec * 1e-6;
+  printf("%d s simulated in %.2f s on %d threads, %.1f times real time, %.1f Mlinks/s\n",
+         nof_seconds,
+         elapsed,
+         nof_threads,
+         nof_seconds / elapsed,
+         s.nof_links / elapsed / 1e6);
+  return SRSRAN_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  if (srsran_sl_comm_resource_pool_get_default_config(&pool, cell) != SRSRAN_SUCCESS) {
+    return SRSRAN_ERROR;
+  }
+
+  if (test_bler_tables() || test_pair(100.0f, true) || test_pair(990.0f, false) || test_threads() ||
+      test_sensing() || benchmark()) {
+    return SRSRAN_ERROR;
+  }
+
+  printf("Ok\n");
+  return SRSRAN_SUCCESS;
+}
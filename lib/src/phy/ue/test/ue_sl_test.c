@@ -0,0 +1,139 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "srsran/phy/ue/ue_sl.h"
+#include "srsran/srsran.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+#define NOF_TX 2
+
+static srsran_cell_sl_t cell = {.nof_prb = 50, .N_sl_id = 0, .tm = SRSRAN_SIDELINK_TM4, .cp = SRSRAN_CP_NORM};
+
+// Sub-channel start and length of every transmitter, with their MCS
+static const uint32_t tx_sub_channel[NOF_TX]   = {0, 3};
+static const uint32_t tx_l_sub_channel[NOF_TX] = {2, 1};
+static const uint32_t tx_mcs_idx[NOF_TX]       = {4, 8};
+
+// Too large for the stack
+static srsran_ue_sl_t ue_tx[NOF_TX];
+static srsran_ue_sl_t ue_rx;
+static uint8_t        tb_tx[NOF_TX][SRSRAN_SL_SCH_MAX_TB_LEN];
+static uint8_t        tb_rx[SRSRAN_MAX_NUM_SUB_CHANNEL][SRSRAN_SL_SCH_MAX_TB_LEN];
+
+/* Two transmitters on different sub-channels of the same subframe, decoded by one receiver with all the PSCCH
+ * candidates of the subframe in one batch */
+static int test_decode_sf(srsran_sl_comm_resource_pool_t* pool)
+{
+  srsran_random_t    random_gen = srsran_random_init(0x1234);
+  srsran_sl_sf_cfg_t sf         = {};
+  sf.tti                        = 3;
+
+  srsran_vec_cf_zero(ue_rx.signal_buffer_rx[0], ue_rx.sf_len);
+  uint32_t tbs[NOF_TX] = {};
+  for (uint32_t k = 0; k < NOF_TX; k++) {
+    srsran_set_sci(&ue_tx[k].sci_tx, 1, 100, 0, false, 0, tx_mcs_idx[k]);
+    tbs[k] = srsran_ue_sl_get_tbs(&ue_tx[k], tx_l_sub_channel[k]);
+    TESTASSERT(tbs[k] > 0);
+    for (uint32_t i = 0; i < tbs[k]; i++) {
+      tb_tx[k][i] = (uint8_t)srsran_random_uniform_int_dist(random_gen, 0, 1);
+    }
+
+    srsran_pssch_data_t data   = {};
+    data.ptr                   = tb_tx[k];
+    data.sub_channel_start_idx = tx_sub_channel[k];
+    data.l_sub_channel         = tx_l_sub_channel[k];
+    TESTASSERT(srsran_ue_sl_encode(&ue_tx[k], &sf, &data) == SRSRAN_SUCCESS);
+    srsran_vec_sum_ccc(ue_rx.signal_buffer_rx[0], ue_tx[k].signal_buffer_tx, ue_rx.signal_buffer_rx[0], ue_rx.sf_len);
+  }
+  srsran_random_free(random_gen);
+
+  srsran_ue_sl_res_t res = {};
+  for (uint32_t s = 0; s < SRSRAN_MAX_NUM_SUB_CHANNEL; s++) {
+    res.data[s] = tb_rx[s];
+  }
+  bool decoded[SRSRAN_MAX_NUM_SUB_CHANNEL] = {};
+  TESTASSERT(srsran_ue_sl_decode_fft_estimate(&ue_rx) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_ue_sl_decode_sf(&ue_rx, &sf, &res, decoded) == NOF_TX);
+
+  for (uint32_t s = 0; s < pool->num_sub_channel; s++) {
+    bool expected = false;
+    for (uint32_t k = 0; k < NOF_TX; k++) {
+      if (tx_sub_channel[k] != s) {
+        continue;
+      }
+      expected = true;
+      TESTASSERT(res.sci[s].mcs_idx == tx_mcs_idx[k]);
+      TESTASSERT(memcmp(tb_rx[s], tb_tx[k], tbs[k]) == 0);
+    }
+    TESTASSERT(decoded[s] == expected);
+  }
+
+  // The single sub-channel decoding finds the same transmissions
+  TESTASSERT(srsran_ue_sl_decode_subch(&ue_rx, &sf, tx_sub_channel[1], &res) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_ue_sl_decode_subch(&ue_rx, &sf, tx_sub_channel[1] - 1, &res) == SRSRAN_ERROR);
+  return SRSRAN_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  int ret = SRSRAN_ERROR;
+
+  srsran_sl_comm_resource_pool_t pool = {};
+  if (srsran_sl_comm_resource_pool_get_default_config(&pool, cell) != SRSRAN_SUCCESS) {
+    ERROR("Error getting the default resource pool\n");
+    return SRSRAN_ERROR;
+  }
+
+  bool init_ok = srsran_ue_sl_init(&ue_rx, cell, pool, 1) == SRSRAN_SUCCESS;
+  for (uint32_t k = 0; k < NOF_TX; k++) {
+    init_ok = init_ok && srsran_ue_sl_init(&ue_tx[k], cell, pool, 0) == SRSRAN_SUCCESS;
+  }
+  if (!init_ok) {
+    ERROR("Error initiating sidelink UEs\n");
+    goto clean_exit;
+  }
+
+  if (test_decode_sf(&pool)) {
+    goto clean_exit;
+  }
+
+  printf("Ok\n");
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  srsran_ue_sl_free(&ue_rx);
+  for (uint32_t k = 0; k < NOF_TX; k++) {
+    srsran_ue_sl_free(&ue_tx[k]);
+  }
+  return ret;
+}
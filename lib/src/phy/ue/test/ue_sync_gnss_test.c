@@ -0,0 +1,293 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "srsran/phy/io/filesink.h"
+#include "srsran/phy/io/filesource.h"
+#include "srsran/phy/ue/ue_sync.h"
+#include "srsran/srsran.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+uint32_t    nof_prb       = 50;
+uint32_t    nof_subframes = 20;
+double      start_time    = 1000.3712; ///< Device time of the first received sample
+uint32_t    file_dfn_sf   = SRSRAN_SL_DFN_PERIOD - 10; ///< DFN subframe of the first sample of the replayed file
+static char dir[]         = "/tmp/ue_sync_gnss_testXXXXXX";
+
+/* Virtual radio whose time is derived from the number of delivered samples */
+typedef struct {
+  double   srate;
+  uint64_t sample_idx;
+  uint64_t nof_delivered;
+  bool     timed_start_supported;
+} virtual_radio_t;
+
+static int radio_recv(void* h, cf_t* data[SRSRAN_MAX_CHANNELS], uint32_t nsamples, srsran_timestamp_t* t)
+{
+  virtual_radio_t* r = (virtual_radio_t*)h;
+  if (t) {
+    srsran_timestamp_init(t, 0, 0);
+    srsran_timestamp_add(t, (time_t)floor(start_time), start_time - floor(start_time));
+    srsran_timestamp_add(
+        t, (time_t)(r->sample_idx / (uint64_t)r->srate), fmod((double)r->sample_idx, r->srate) / r->srate);
+  }
+  srsran_vec_cf_zero(data[0], nsamples);
+  r->sample_idx += nsamples;
+  r->nof_delivered += nsamples;
+  return (int)nsamples;
+}
+
+static int radio_start_rx_timed(void* h, srsran_timestamp_t* t)
+{
+  virtual_radio_t* r = (virtual_radio_t*)h;
+  if (!r->timed_start_supported) {
+    return SRSRAN_ERROR_INVALID_COMMAND;
+  }
+  double wait = srsran_timestamp_real(t) - start_time;
+  if (wait < 0) {
+    return SRSRAN_ERROR;
+  }
+  r->sample_idx = (uint64_t)llround(wait * r->srate);
+  return SRSRAN_SUCCESS;
+}
+
+static int run_test(bool timed_start, uint32_t* tti, uint64_t* nof_delivered, uint64_t* usec)
+{
+  srsran_cell_t cell = {};
+  cell.nof_prb       = nof_prb;
+  cell.cp            = SRSRAN_CP_NORM;
+  cell.nof_ports     = 1;
+
+  uint32_t sf_len = SRSRAN_SF_LEN_PRB(nof_prb);
+
+  virtual_radio_t radio = {};
+  radio.srate                 = sf_len * 1000.0;
+  radio.timed_start_supported = timed_start;
+
+  cf_t* buffer[SRSRAN_MAX_CHANNELS] = {NULL};
+  buffer[0]                         = srsran_vec_cf_malloc(sf_len);
+
+  srsran_ue_sync_t ue_sync;
+  if (srsran_ue_sync_init_multi_decim_mode(&ue_sync, nof_prb, false, radio_recv, 1, &radio, 1, SYNC_MODE_GNSS)) {
+    ERROR("Error initiating ue_sync\n");
+    return SRSRAN_ERROR;
+  }
+  if (srsran_ue_sync_set_cell(&ue_sync, cell)) {
+    ERROR("Error setting ue_sync cell\n");
+    return SRSRAN_ERROR;
+  }
+  srsran_ue_sync_set_start_rx_timed_callback(&ue_sync, radio_start_rx_timed);
+
+  for (uint32_t i = 0; i < nof_subframes; i++) {
+    TESTASSERT(srsran_ue_sync_zerocopy(&ue_sync, buffer, sf_len) == 1);
+  }
+
+  // Subframes must be aligned to the millisecond
+  double frac_ms = ue_sync.last_timestamp.frac_secs * 1000.0;
+  TESTASSERT(fabs(frac_ms - round(frac_ms)) * sf_len < 1.0);
+
+  *tti           = srsran_ue_sync_get_sfn(&ue_sync) * 10 + srsran_ue_sync_get_sfidx(&ue_sync);
+  *nof_delivered = radio.nof_delivered;
+  *usec          = ue_sync.gnss_align_usec;
+
+  printf("%-14s: aligned in %6" PRIu64 " us, %8" PRIu64 " samples discarded, %8" PRIu64
+         " samples received, tti=%d\n",
+         timed_start ? "timed start" : "discard",
+         ue_sync.gnss_align_usec,
+         ue_sync.gnss_align_nof_samples,
+         radio.nof_delivered,
+         *tti);
+
+  if (timed_start) {
+    TESTASSERT(ue_sync.gnss_align_nof_samples == 0);
+  }
+
+  srsran_ue_sync_free(&ue_sync);
+  free(buffer[0]);
+  return SRSRAN_SUCCESS;
+}
+
+/* File replay as done by pssch_ue -i -m, the first sample of the file is labeled with a known DFN subframe */
+typedef struct {
+  srsran_filesource_t fsrc;
+  double              srate;
+  uint64_t            nof_samples;
+  srsran_timestamp_t  start_time;
+} file_radio_t;
+
+static int file_recv(void* h, cf_t* data[SRSRAN_MAX_CHANNELS], uint32_t nsamples, srsran_timestamp_t* t)
+{
+  file_radio_t* r = (file_radio_t*)h;
+  if (t) {
+    srsran_timestamp_copy(t, &r->start_time);
+    srsran_timestamp_add(t, 0, r->nof_samples / r->srate);
+  }
+  int nread = srsran_filesource_read(&r->fsrc, data[0], nsamples);
+  r->nof_samples += nsamples;
+  return nread;
+}
+
+static int file_start_rx_timed(void* h, srsran_timestamp_t* t)
+{
+  file_radio_t* r = (file_radio_t*)h;
+  srsran_filesource_seek(&r->fsrc, 0);
+  r->nof_samples  = 0;
+  uint32_t offset = (file_dfn_sf + SRSRAN_SL_DFN_PERIOD - srsran_ue_sync_gnss_dfn_sf(t, 0)) % SRSRAN_SL_DFN_PERIOD;
+  srsran_timestamp_copy(&r->start_time, t);
+  srsran_timestamp_add(&r->start_time, 0, offset * 1e-3);
+  return SRSRAN_SUCCESS;
+}
+
+/* Writes subframes carrying their index in the file, replays them and checks that every subframe is given the DFN
+ * subframe it was labeled with, across the DFN wrap */
+static int test_file_dfn()
+{
+  srsran_cell_t cell = {};
+  cell.nof_prb       = nof_prb;
+  cell.cp            = SRSRAN_CP_NORM;
+  cell.nof_ports     = 1;
+
+  uint32_t sf_len                      = SRSRAN_SF_LEN_PRB(nof_prb);
+  cf_t*    buffer[SRSRAN_MAX_CHANNELS] = {NULL};
+  buffer[0]                            = srsran_vec_cf_malloc(sf_len);
+
+  char path[64];
+  snprintf(path, sizeof(path), "%s/dfn.fc32", dir);
+  srsran_filesink_t fsink = {};
+  TESTASSERT(srsran_filesink_init(&fsink, path, SRSRAN_COMPLEX_FLOAT_BIN) == SRSRAN_SUCCESS);
+  for (uint32_t i = 0; i < nof_subframes; i++) {
+    for (uint32_t j = 0; j < sf_len; j++) {
+      buffer[0][j] = (float)i;
+    }
+    TESTASSERT(srsran_filesink_write(&fsink, buffer[0], sf_len) == sf_len);
+  }
+  srsran_filesink_free(&fsink);
+
+  file_radio_t radio = {};
+  radio.srate        = sf_len * 1000.0;
+  TESTASSERT(srsran_filesource_init(&radio.fsrc, path, SRSRAN_COMPLEX_FLOAT_BIN) == SRSRAN_SUCCESS);
+
+  srsran_ue_sync_t ue_sync;
+  if (srsran_ue_sync_init_multi_decim_mode(&ue_sync, nof_prb, false, file_recv, 1, &radio, 1, SYNC_MODE_GNSS)) {
+    ERROR("Error initiating ue_sync\n");
+    return SRSRAN_ERROR;
+  }
+  if (srsran_ue_sync_set_cell(&ue_sync, cell)) {
+    ERROR("Error setting ue_sync cell\n");
+    return SRSRAN_ERROR;
+  }
+  srsran_ue_sync_set_start_rx_timed_callback(&ue_sync, file_start_rx_timed);
+
+  uint32_t nof_wraps = 0;
+  uint32_t dfn_prev  = 0;
+  for (uint32_t i = 0; i < nof_subframes; i++) {
+    TESTASSERT(srsran_ue_sync_zerocopy(&ue_sync, buffer, sf_len) == 1);
+    uint32_t file_sf = (uint32_t)crealf(buffer[0][sf_len / 2]);
+    uint32_t dfn_sf  = srsran_ue_sync_get_sfn(&ue_sync) * SRSRAN_NOF_SF_X_FRAME + srsran_ue_sync_get_sfidx(&ue_sync);
+    TESTASSERT(file_sf == i);
+    TESTASSERT(dfn_sf == (file_dfn_sf + file_sf) % SRSRAN_SL_DFN_PERIOD);
+    nof_wraps += (i > 0 && dfn_sf < dfn_prev) ? 1 : 0;
+    dfn_prev = dfn_sf;
+  }
+  printf("file replay   : DFN subframe %d to %d\n", file_dfn_sf, dfn_prev);
+  TESTASSERT(nof_subframes < SRSRAN_SL_DFN_PERIOD - file_dfn_sf || nof_wraps == 1);
+
+  srsran_ue_sync_free(&ue_sync);
+  srsran_filesource_free(&radio.fsrc);
+  free(buffer[0]);
+  return SRSRAN_SUCCESS;
+}
+
+void usage(char* prog)
+{
+  printf("Usage: %s [dnp]\n", prog);
+  printf("\t-d DFN subframe of the replayed file [Default %d]\n", file_dfn_sf);
+  printf("\t-n nof_subframes [Default %d]\n", nof_subframes);
+  printf("\t-p nof_prb [Default %d]\n", nof_prb);
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "dnp")) != -1) {
+    switch (opt) {
+      case 'd':
+        file_dfn_sf = (uint32_t)strtol(argv[optind], NULL, 10) % SRSRAN_SL_DFN_PERIOD;
+        break;
+      case 'n':
+        nof_subframes = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'p':
+        nof_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  uint32_t tti_discard = 0, tti_timed = 0;
+  uint64_t rx_discard = 0, rx_timed = 0;
+  uint64_t usec_discard = 0, usec_timed = 0;
+
+  TESTASSERT(run_test(false, &tti_discard, &rx_discard, &usec_discard) == SRSRAN_SUCCESS);
+  TESTASSERT(run_test(true, &tti_timed, &rx_timed, &usec_timed) == SRSRAN_SUCCESS);
+
+  /* Both ways must lead to the same timing, with far fewer samples going through the receiver. Discarding leaves up
+   * to one subframe before the boundary, hence the first aligned subframe may be one earlier */
+  TESTASSERT((tti_timed + 10240 - tti_discard) % 10240 <= 1);
+  TESTASSERT(rx_timed < rx_discard);
+
+  if (mkdtemp(dir) == NULL) {
+    perror("mkdtemp");
+    return SRSRAN_ERROR;
+  }
+  int ret = test_file_dfn();
+  if (ret == SRSRAN_SUCCESS) {
+    printf("Ok\n");
+  }
+
+  char cmd[64];
+  snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+  if (system(cmd) != 0) {
+    perror("system");
+  }
+  return ret;
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "srsran/phy/ue/ue_sync.h"
+#include "srsran/srsran.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+srsran_cell_sl_t cell = {.nof_prb = 50, .N_sl_id = 74, .tm = SRSRAN_SIDELINK_TM4, .cp = SRSRAN_CP_NORM};
+
+uint32_t nof_subframes  = 1000;
+uint32_t initial_offset = 5000;
+float    drift_ppm      = 5.0f;
+float    snr_db         = 20.0f;
+
+/* Synthetic sidelink stream: an SLSS (PSSS, SSSS and PSBCH carrying the MIB-SL) is transmitted every
+ * SRSRAN_SL_V2X_SLSS_PERIOD subframes. The receiver samples it with a time offset and a sampling drift. */
+typedef struct {
+  srsran_psss_t     psss;
+  srsran_ssss_t     ssss;
+  srsran_psbch_t    psbch;
+  srsran_chest_sl_t chest;
+  srsran_mib_sl_t   mib_sl;
+  srsran_ofdm_t     ifft;
+
+  cf_t*    sf_symbols;
+  cf_t*    sf_time;
+  uint32_t sf_len;
+  int64_t  cached_sf;
+  float    noise_std;
+
+  uint64_t rx_cnt;       ///< Number of samples received so far
+  uint64_t last_rx_tx;   ///< Transmitted sample index of the first sample of the last reception
+  uint32_t last_rx_len;
+} sl_stream_t;
+
+static void stream_gen_sf(sl_stream_t* s, int64_t sf)
+{
+  srsran_vec_cf_zero(s->sf_time, s->sf_len);
+  if (sf % SRSRAN_SL_V2X_SLSS_PERIOD == 0) {
+    uint32_t sf_n_re = SRSRAN_SF_LEN_RE(cell.nof_prb, cell.cp);
+    srsran_vec_cf_zero(s->sf_symbols, sf_n_re);
+
+    srsran_mib_sl_set(&s->mib_sl, cell.nof_prb, 0, (uint32_t)((sf / 10) % 1024), (uint32_t)(sf % 10), false);
+    uint8_t mib_sl_tx[SRSRAN_MIB_SL_MAX_LEN] = {};
+    srsran_mib_sl_pack(&s->mib_sl, mib_sl_tx);
+
+    srsran_psbch_encode(&s->psbch, mib_sl_tx, s->mib_sl.mib_sl_len, s->sf_symbols);
+    srsran_psss_put_sf_buffer(s->psss.psss_signal[cell.N_sl_id < 168 ? 0 : 1], s->sf_symbols, cell.nof_prb, cell.cp);
+    srsran_ssss_put_sf_buffer(s->ssss.ssss_signal[cell.N_sl_id], s->sf_symbols, cell.nof_prb, cell.cp);
+    srsran_chest_sl_put_dmrs(&s->chest, s->sf_symbols);
+
+    srsran_ofdm_tx_sf(&s->ifft);
+  }
+  s->cached_sf = sf;
+}
+
+static int stream_recv(void* h, cf_t* data[SRSRAN_MAX_CHANNELS], uint32_t nsamples, srsran_timestamp_t* t)
+{
+  sl_stream_t* s = (sl_stream_t*)h;
+
+  double scale = 1.0 + drift_ppm * 1e-6;
+  for (uint32_t i = 0; i < nsamples; i++) {
+    uint64_t tx_idx = initial_offset + (uint64_t)floor((double)(s->rx_cnt + i) * scale);
+    if (i == 0) {
+      s->last_rx_tx = tx_idx;
+    }
+    int64_t sf = (int64_t)(tx_idx / s->sf_len);
+    if (sf != s->cached_sf) {
+      stream_gen_sf(s, sf);
+    }
+    data[0][i] = s->sf_time[tx_idx % s->sf_len];
+  }
+  srsran_ch_awgn_c(data[0], data[0], s->noise_std, nsamples);
+
+  if (t) {
+    srsran_timestamp_init_uint64(t, s->rx_cnt, s->sf_len * 1000.0);
+  }
+  s->rx_cnt += nsamples;
+  s->last_rx_len = nsamples;
+  return (int)nsamples;
+}
+
+static int stream_init(sl_stream_t* s)
+{
+  bzero(s, sizeof(sl_stream_t));
+
+  uint32_t sf_n_re = SRSRAN_SF_LEN_RE(cell.nof_prb, cell.cp);
+  s->sf_len        = SRSRAN_SF_LEN_PRB(cell.nof_prb);
+  s->sf_symbols    = srsran_vec_cf_malloc(sf_n_re);
+  s->sf_time       = srsran_vec_cf_malloc(s->sf_len);
+  s->cached_sf     = -1;
+  if (!s->sf_symbols || !s->sf_time) {
+    return SRSRAN_ERROR;
+  }
+
+  if (srsran_psss_init(&s->psss, cell.nof_prb, cell.cp) || srsran_ssss_init(&s->ssss, cell.nof_prb, cell.cp, cell.tm) ||
+      srsran_psbch_init(&s->psbch, cell.nof_prb, cell.N_sl_id, cell.tm, cell.cp) ||
+      srsran_mib_sl_init(&s->mib_sl, cell.tm)) {
+    return SRSRAN_ERROR;
+  }
+
+  srsran_sl_comm_resource_pool_t sl_comm_resource_pool;
+  if (srsran_sl_comm_resource_pool_get_default_config(&sl_comm_resource_pool, cell) ||
+      srsran_chest_sl_init(&s->chest, SRSRAN_SIDELINK_PSBCH, cell, sl_comm_resource_pool)) {
+    return SRSRAN_ERROR;
+  }
+
+  if (srsran_ofdm_tx_init(&s->ifft, cell.cp, s->sf_symbols, s->sf_time, cell.nof_prb)) {
+    return SRSRAN_ERROR;
+  }
+  srsran_ofdm_set_normalize(&s->ifft, true);
+  srsran_ofdm_set_freq_shift(&s->ifft, 0.5);
+
+  // Noise is relative to the SLSS subframe power
+  stream_gen_sf(s, 0);
+  float sig_pow = srsran_vec_avg_power_cf(s->sf_time, s->sf_len);
+  s->noise_std  = sqrtf(sig_pow) * powf(10.0f, -snr_db / 20.0f);
+
+  return SRSRAN_SUCCESS;
+}
+
+static void stream_free(sl_stream_t* s)
+{
+  srsran_psss_free(&s->psss);
+  srsran_ssss_free(&s->ssss);
+  srsran_psbch_free(&s->psbch);
+  srsran_chest_sl_free(&s->chest);
+  srsran_mib_sl_free(&s->mib_sl);
+  srsran_ofdm_tx_free(&s->ifft);
+  free(s->sf_symbols);
+  free(s->sf_time);
+}
+
+void usage(char* prog)
+{
+  printf("Usage: %s [nods]\n", prog);
+  printf("\t-n nof_subframes [Default %d]\n", nof_subframes);
+  printf("\t-o initial time offset in samples [Default %d]\n", initial_offset);
+  printf("\t-d sampling drift in ppm [Default %.1f]\n", drift_ppm);
+  printf("\t-s SNR in dB [Default %.1f]\n", snr_db);
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "nods")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_subframes = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'o':
+        initial_offset = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'd':
+        drift_ppm = strtof(argv[optind], NULL);
+        break;
+      case 's':
+        snr_db = strtof(argv[optind], NULL);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  sl_stream_t stream;
+  if (stream_init(&stream)) {
+    ERROR("Error initiating stream\n");
+    return SRSRAN_ERROR;
+  }
+
+  cf_t* buffer[SRSRAN_MAX_CHANNELS] = {NULL};
+  buffer[0]                         = srsran_vec_cf_malloc(stream.sf_len);
+
+  srsran_ue_sync_t ue_sync;
+  if (srsran_ue_sync_init_multi_decim_mode(
+          &ue_sync, cell.nof_prb, false, stream_recv, 1, (void*)&stream, 1, SYNC_MODE_SLSS)) {
+    ERROR("Error initiating ue_sync\n");
+    return SRSRAN_ERROR;
+  }
+
+  // N_sl_id is not known by the receiver
+  srsran_cell_sl_t rx_cell = cell;
+  rx_cell.N_sl_id          = 0;
+  if (srsran_ue_sync_set_cell_sl(&ue_sync, rx_cell)) {
+    ERROR("Error setting ue_sync cell\n");
+    return SRSRAN_ERROR;
+  }
+
+  uint32_t nof_synced   = 0;
+  uint32_t nof_tti_ok   = 0;
+  int32_t  max_time_err = 0;
+  for (uint32_t i = 0; i < nof_subframes; i++) {
+    int ret = srsran_ue_sync_zerocopy(&ue_sync, buffer, stream.sf_len);
+    TESTASSERT(ret >= 0);
+    if (ret != 1) {
+      continue;
+    }
+    nof_synced++;
+
+    // Transmitted sample index of the first sample in the buffer
+    int64_t start = (int64_t)stream.last_rx_tx - (int64_t)(stream.sf_len - stream.last_rx_len);
+    int64_t sf    = (start + stream.sf_len / 2) / stream.sf_len;
+    int32_t err   = (int32_t)(start - sf * stream.sf_len);
+
+    uint32_t tti = srsran_ue_sync_get_sfn(&ue_sync) * 10 + srsran_ue_sync_get_sfidx(&ue_sync);
+    if (tti == (uint32_t)(sf % 10240)) {
+      nof_tti_ok++;
+    }
+    max_time_err = SRSRAN_MAX(max_time_err, abs(err));
+  }
+
+  printf("Synchronized %d/%d subframes, %d with correct TTI, max time error %d samples\n",
+         nof_synced,
+         nof_subframes,
+         nof_tti_ok,
+         max_time_err);
+  srsran_ue_sync_slss_fprint_stats(stdout, &ue_sync);
+
+  TESTASSERT(ue_sync.cell_sl.N_sl_id == cell.N_sl_id);
+  TESTASSERT(nof_synced > 0);
+  TESTASSERT(nof_tti_ok == nof_synced);
+  TESTASSERT(max_time_err <= (int32_t)ue_sync.slss_track_max_offset);
+  TESTASSERT(ue_sync.slss_track_cnt >= nof_synced / SRSRAN_SL_V2X_SLSS_PERIOD - 1);
+  TESTASSERT(ue_sync.slss_lost_cnt == 0);
+
+  srsran_ue_sync_free(&ue_sync);
+  stream_free(&stream);
+  free(buffer[0]);
+
+  printf("Ok\n");
+  return SRSRAN_SUCCESS;
+}
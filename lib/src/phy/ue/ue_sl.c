@@ -56,6 +56,7 @@
 #include <string.h>
 
 #include "srsran/phy/ue/ue_sl.h"
+#include "srsran/phy/utils/sl_prof.h"
 
 #define CURRENT_FFTSIZE srsran_symbol_sz(q->cell.nof_prb)
 #define CURRENT_SFLEN SRSRAN_SF_LEN(CURRENT_FFTSIZE)
@@ -63,6 +64,9 @@
 #define CURRENT_SLOTLEN_RE SRSRAN_SLOT_LEN_RE(q->cell.nof_prb, q->cell.cp)
 #define CURRENT_SFLEN_RE SRSRAN_NOF_RE(q->cell)
 
+// PSCCH DMRS cyclic shifts 0, 3, 6 and 9, 3GPP TS 36.213 Section 14.2.1
+#define SL_NOF_PSCCH_CYCLIC_SHIFTS 4
+
 #define MAX_SFLEN SRSRAN_SF_LEN(srsran_symbol_sz(max_prb))
 
 
@@ -105,6 +109,7 @@ int srsran_ue_sl_init(srsran_ue_sl_t* q,
     ofdm_cfg_tx.freq_shift_f      = 0.5f;
     ofdm_cfg_tx.normalize         = true;
     ofdm_cfg_tx.sf_type           = SRSRAN_SF_NORM;
+    ofdm_cfg_tx.sidelink          = true;
     if (srsran_ofdm_tx_init_cfg(&q->ifft, &ofdm_cfg_tx)) {
       ERROR("Error initiating IFFT\n");
       goto clean_exit;
@@ -136,6 +141,7 @@ int srsran_ue_sl_init(srsran_ue_sl_t* q,
     ofdm_cfg_rx.freq_shift_f      = -0.5f;
     ofdm_cfg_rx.normalize         = true;
     ofdm_cfg_rx.sf_type           = SRSRAN_SF_NORM;
+    ofdm_cfg_rx.sidelink          = true;
 
     for (int i = 0; i < q->nof_rx_antennas; i++) {
       ofdm_cfg_rx.in_buffer  = q->signal_buffer_rx[0];
@@ -181,6 +187,11 @@ int srsran_ue_sl_init(srsran_ue_sl_t* q,
         goto clean_exit;
       }
 
+      if (subch_idx == 0 && srsran_pscch_init_batch(&q->pscch_rx[subch_idx])) {
+        ERROR("Error creating PSCCH batch decoder\n");
+        goto clean_exit;
+      }
+
       if (srsran_sci_init(&q->sci_rx[subch_idx], q->cell, q->sl_comm_resource_pool)) {
         ERROR("Error creating SCI RX object for sub channel %d\n", subch_idx);
         goto clean_exit;
@@ -414,7 +425,7 @@ static int pscch_encode(srsran_ue_sl_t* q, uint32_t sub_channel_start_idx)
       return SRSRAN_ERROR;
     }
 
-    srsran_chest_sl_cfg_t pscch_chest_sl_cfg;
+    srsran_chest_sl_cfg_t pscch_chest_sl_cfg = {};
     pscch_chest_sl_cfg.prb_start_idx = pscch_prb_start_idx;
     pscch_chest_sl_cfg.cyclic_shift = 0;
     srsran_chest_sl_set_cfg(&q->pscch_chest_tx, pscch_chest_sl_cfg);
@@ -426,6 +437,20 @@ static int pscch_encode(srsran_ue_sl_t* q, uint32_t sub_channel_start_idx)
   return ret;
 }
 
+/* PSSCH PRBs of a transmission over l_sub_channel sub-channels, which start with the PSCCH */
+static uint32_t pssch_nof_prb(srsran_ue_sl_t* q, uint32_t l_sub_channel)
+{
+  uint32_t nof_prb_pssch = l_sub_channel * q->sl_comm_resource_pool.size_sub_channel - q->pscch_tx.pscch_nof_prb;
+  return srsran_dft_precoding_get_valid_prb(nof_prb_pssch);
+}
+
+uint32_t srsran_ue_sl_get_tbs(srsran_ue_sl_t* q, uint32_t l_sub_channel)
+{
+  int tbs = srsran_ra_tbs_from_idx(srsran_ra_tbs_idx_from_mcs(q->sci_tx.mcs_idx, false, true),
+                                   pssch_nof_prb(q, l_sub_channel));
+  return tbs > 0 ? (uint32_t)tbs : 0;
+}
+
 /* Generate PSSCH signal
  */
 static int pssch_encode(srsran_ue_sl_t* q,
@@ -449,8 +474,7 @@ static int pssch_encode(srsran_ue_sl_t* q,
     if (q->sci_tx.retransmission == true) {
       rv_idx = 1;
     }
-    uint32_t nof_prb_pssch = data->l_sub_channel * q->sl_comm_resource_pool.size_sub_channel - q->pscch_tx.pscch_nof_prb;
-    nof_prb_pssch = srsran_dft_precoding_get_valid_prb(nof_prb_pssch);
+    uint32_t nof_prb_pssch = pssch_nof_prb(q, data->l_sub_channel);
 
     srsran_pssch_cfg_t pssch_cfg = {pssch_prb_start_idx_tx, nof_prb_pssch, N_x_id, q->sci_tx.mcs_idx, rv_idx, sf->tti % 10};
     if (srsran_pssch_set_cfg(&q->pssch_tx, pssch_cfg)) {
@@ -471,7 +495,7 @@ static int pssch_encode(srsran_ue_sl_t* q,
       return SRSRAN_ERROR;
     }
 
-    srsran_chest_sl_cfg_t pssch_chest_sl_cfg;
+    srsran_chest_sl_cfg_t pssch_chest_sl_cfg = {};
     pssch_chest_sl_cfg.N_x_id        = N_x_id;
     pssch_chest_sl_cfg.sf_idx        = sf->tti % 10;
     pssch_chest_sl_cfg.prb_start_idx = pssch_prb_start_idx_tx;
@@ -492,14 +516,21 @@ int srsran_ue_sl_encode(srsran_ue_sl_t* q,
 
   srsran_set_sci_riv(q, data->sub_channel_start_idx, data->l_sub_channel);
 
+  SRSRAN_SL_PROF_START(t_pscch);
   if (pscch_encode(q, data->sub_channel_start_idx)) {
     return SRSRAN_ERROR;
   }
+  SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_TX_PSCCH_ENCODE, t_pscch);
+
+  SRSRAN_SL_PROF_START(t_pssch);
   if (pssch_encode(q, sf, data)) {
     return SRSRAN_ERROR;
   }
+  SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_TX_PSSCH_ENCODE, t_pssch);
 
+  SRSRAN_SL_PROF_START(t_ifft);
   srsran_ofdm_tx_sf(&q->ifft);
+  SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_TX_IFFT, t_ifft);
 
   srsran_vec_cf_zero(q->sf_symbols_tx, q->sf_len);
 
@@ -510,9 +541,11 @@ int srsran_ue_sl_decode_fft_estimate(srsran_ue_sl_t* q)
 {
   if (q) {
     /* Run FFT for all subframe data */
+    SRSRAN_SL_PROF_START(t_fft);
     for (int j = 0; j < q->nof_rx_antennas; j++) {
       srsran_ofdm_rx_sf(&q->fft[j]);
     }
+    SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_RX_FFT, t_fft);
   } else {
     return SRSRAN_ERROR_INVALID_INPUTS;
   }
@@ -523,11 +556,14 @@ int srsran_ue_sl_decode_fft_estimate(srsran_ue_sl_t* q)
  */
 void estimate_pscch(srsran_ue_sl_t* q, uint32_t sub_channel_idx, uint32_t pscch_prb_start_idx, uint32_t cyclic_shift)
 {
-  srsran_chest_sl_cfg_t pscch_chest_sl_cfg;
+  srsran_chest_sl_cfg_t pscch_chest_sl_cfg = {};
   pscch_chest_sl_cfg.cyclic_shift  = cyclic_shift;
   pscch_chest_sl_cfg.prb_start_idx = pscch_prb_start_idx;
   srsran_chest_sl_set_cfg(&q->pscch_chest_rx[sub_channel_idx], pscch_chest_sl_cfg);
-  srsran_chest_sl_ls_estimate_equalize(&q->pscch_chest_rx[sub_channel_idx], q->sf_symbols_rx[0], q->equalized_sf_buffer);
+  SRSRAN_SL_PROF_START(t_chest);
+  srsran_chest_sl_ls_estimate_equalize_symbols(
+      &q->pscch_chest_rx[sub_channel_idx], q->sf_symbols_rx[0], q->pscch_rx[sub_channel_idx].scfdma_symbols);
+  SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_RX_PSCCH_CHEST, t_chest);
 }
 
 void estimate_pssch(srsran_ue_sl_t* q,
@@ -537,52 +573,42 @@ void estimate_pssch(srsran_ue_sl_t* q,
                     uint32_t pssch_prb_start_idx,
                     uint32_t nof_prb_pssch)
 {
-  srsran_chest_sl_cfg_t pssch_chest_sl_cfg;
+  srsran_chest_sl_cfg_t pssch_chest_sl_cfg = {};
   pssch_chest_sl_cfg.N_x_id        = N_x_id;
   pssch_chest_sl_cfg.sf_idx        = sf->tti % 10;
   pssch_chest_sl_cfg.prb_start_idx = pssch_prb_start_idx;
   pssch_chest_sl_cfg.nof_prb       = nof_prb_pssch;
   srsran_chest_sl_set_cfg(&q->pssch_chest_rx[sub_channel_idx], pssch_chest_sl_cfg);
-  srsran_chest_sl_ls_estimate_equalize(&q->pssch_chest_rx[sub_channel_idx], q->sf_symbols_rx[0], q->equalized_sf_buffer);
+  SRSRAN_SL_PROF_START(t_chest);
+  srsran_chest_sl_ls_estimate_equalize_symbols(
+      &q->pssch_chest_rx[sub_channel_idx], q->sf_symbols_rx[0], q->pssch_rx[sub_channel_idx].scfdma_symbols);
+  SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_RX_PSSCH_CHEST, t_chest);
 }
 
-/* Decode PSCCH signal
+/* Unpacks the SCI of a PSCCH candidate decoded by srsran_pscch_decode_batch()
  */
-static int pscch_decode(srsran_ue_sl_t* q,
+static int pscch_unpack(srsran_ue_sl_t* q,
                         uint32_t sub_channel_idx,
+                        uint8_t* c,
                         uint32_t cyclic_shift,
                         uint32_t pscch_prb_start_idx,
                         srsran_ue_sl_res_t* sl_res)
 {
+  // The received CRC gives the PSSCH scrambling identity
+  memcpy(q->pscch_rx[sub_channel_idx].sci_crc, &c[q->pscch_rx[sub_channel_idx].sci_len], SRSRAN_SCI_CRC_LEN);
 
-  int ret = SRSRAN_ERROR_INVALID_INPUTS;
-
-  if (q != NULL) {
-
-    estimate_pscch(q, sub_channel_idx, pscch_prb_start_idx, cyclic_shift);
-
-    uint8_t sci_rx[SRSRAN_SCI_MAX_LEN] = {};
-    if (srsran_pscch_decode(&q->pscch_rx[sub_channel_idx], q->equalized_sf_buffer, sci_rx, pscch_prb_start_idx)) {
-      DEBUG("Error decoding PSCCH (cyclic shift: %d, pscch_prb_start_idx: %d)\n", cyclic_shift, pscch_prb_start_idx);
-      return SRSRAN_ERROR;
-    } else {
-
-      if (srsran_sci_format1_unpack(&q->sci_rx[sub_channel_idx], sci_rx)) {
-        DEBUG("ERROR unpacking SCI Format 1 (cyclic shift: %d, pscch_prb_start_idx: %d)\n", cyclic_shift, pscch_prb_start_idx);
-        return SRSRAN_ERROR;
-      } else {
-        q->sci_rx[sub_channel_idx].resource_reserv = srsran_intvl_from_reserv(q->sci_rx[sub_channel_idx].resource_reserv);
-        sl_res->sci[sub_channel_idx] = q->sci_rx[sub_channel_idx];
-
-        char sci_msg[SRSRAN_SCI_MSG_MAX_LEN] = {};
-        srsran_sci_info(&q->sci_rx[sub_channel_idx], sci_msg, sizeof(sci_msg));
-        INFO("%s", sci_msg);
-      }
-    }
-    ret = SRSRAN_SUCCESS;
+  if (srsran_sci_format1_unpack(&q->sci_rx[sub_channel_idx], c)) {
+    DEBUG("ERROR unpacking SCI Format 1 (cyclic shift: %d, pscch_prb_start_idx: %d)\n", cyclic_shift, pscch_prb_start_idx);
+    return SRSRAN_ERROR;
   }
+  q->sci_rx[sub_channel_idx].resource_reserv = srsran_intvl_from_reserv(q->sci_rx[sub_channel_idx].resource_reserv);
+  sl_res->sci[sub_channel_idx] = q->sci_rx[sub_channel_idx];
 
-  return ret;
+  char sci_msg[SRSRAN_SCI_MSG_MAX_LEN] = {};
+  srsran_sci_info(&q->sci_rx[sub_channel_idx], sci_msg, sizeof(sci_msg));
+  INFO("%s", sci_msg);
+
+  return SRSRAN_SUCCESS;
 }
 
 /* Decode PSSCH signal
@@ -636,7 +662,7 @@ static int pssch_decode(srsran_ue_sl_t* q,
           q->pssch_rx[sub_channel_idx].pssch_cfg.sf_idx);
 
 
-    if (srsran_pssch_decode(&q->pssch_rx[sub_channel_idx], q->equalized_sf_buffer, sl_res->data[sub_channel_idx], SRSRAN_SL_SCH_MAX_TB_LEN)) {
+    if (srsran_pssch_decode_scfdma(&q->pssch_rx[sub_channel_idx], sl_res->data[sub_channel_idx], SRSRAN_SL_SCH_MAX_TB_LEN)) {
       DEBUG("Error decoding PSSCH\n");
       ret = SRSRAN_ERROR;
     } else {
@@ -647,31 +673,81 @@ static int pssch_decode(srsran_ue_sl_t* q,
   return ret;
 }
 
-int srsran_ue_sl_decode_subch(srsran_ue_sl_t* q,
-                              srsran_sl_sf_cfg_t* sf,
-                              uint32_t sub_channel_idx,
-                              srsran_ue_sl_res_t* sl_res)
+/* Demodulates the PSCCH of every cyclic shift on the given sub-channels, channel decodes all of them in one batch and
+ * decodes the PSSCH of every SCI found. Flags the sub-channels with a decoded PSSCH in decoded.
+ */
+static int decode_sub_channels(srsran_ue_sl_t*     q,
+                               srsran_sl_sf_cfg_t* sf,
+                               uint32_t            first_sub_channel_idx,
+                               uint32_t            nof_sub_channels,
+                               srsran_ue_sl_res_t* sl_res,
+                               bool*               decoded)
 {
-  int ret = SRSRAN_ERROR;
+  int16_t  llr[SRSRAN_MAX_NUM_SUB_CHANNEL * SL_NOF_PSCCH_CYCLIC_SHIFTS][3 * (SRSRAN_SCI_MAX_LEN + SRSRAN_SCI_CRC_LEN)];
+  uint8_t  c[SRSRAN_MAX_NUM_SUB_CHANNEL * SL_NOF_PSCCH_CYCLIC_SHIFTS][SRSRAN_SCI_MAX_LEN + SRSRAN_SCI_CRC_LEN];
+  int16_t* llr_ptr[SRSRAN_MAX_NUM_SUB_CHANNEL * SL_NOF_PSCCH_CYCLIC_SHIFTS];
+  uint8_t* c_ptr[SRSRAN_MAX_NUM_SUB_CHANNEL * SL_NOF_PSCCH_CYCLIC_SHIFTS];
+  bool     crc_ok[SRSRAN_MAX_NUM_SUB_CHANNEL * SL_NOF_PSCCH_CYCLIC_SHIFTS] = {};
+  uint32_t pscch_prb_start_idx[SRSRAN_MAX_NUM_SUB_CHANNEL];
+
+  uint32_t nof_candidates = 0;
+  for (uint32_t s = first_sub_channel_idx; s < first_sub_channel_idx + nof_sub_channels; s++) {
+    if (q->sl_comm_resource_pool.adjacency_pscch_pssch) {
+      pscch_prb_start_idx[s] = s * q->sl_comm_resource_pool.size_sub_channel;
+    } else {
+      pscch_prb_start_idx[s] = s * 2;
+    }
+    for (uint32_t i = 0; i < SL_NOF_PSCCH_CYCLIC_SHIFTS; i++, nof_candidates++) {
+      llr_ptr[nof_candidates] = llr[nof_candidates];
+      c_ptr[nof_candidates]   = c[nof_candidates];
+      estimate_pscch(q, s, pscch_prb_start_idx[s], 3 * i);
+      srsran_pscch_demod_scfdma(&q->pscch_rx[s], llr[nof_candidates]);
+    }
+  }
 
-  uint32_t pscch_prb_start_idx;
-  if (q->sl_comm_resource_pool.adjacency_pscch_pssch) {
-    pscch_prb_start_idx = sub_channel_idx * q->sl_comm_resource_pool.size_sub_channel;
-  } else {
-    pscch_prb_start_idx = sub_channel_idx * 2;
+  // The PSCCH objects of all sub-channels share the same SCI length, the first one holds the multi-frame decoder
+  if (srsran_pscch_decode_batch(&q->pscch_rx[0], llr_ptr, c_ptr, crc_ok, nof_candidates) < SRSRAN_SUCCESS) {
+    return SRSRAN_ERROR;
   }
 
-  for (uint32_t cyclic_shift = 0; cyclic_shift <= 9; cyclic_shift += 3) {
-    if (pscch_decode(q, sub_channel_idx, cyclic_shift, pscch_prb_start_idx, sl_res) == SRSRAN_SUCCESS) {
-      if (pssch_decode(q, sf, sub_channel_idx, sl_res) == SRSRAN_SUCCESS) {
-        ret = SRSRAN_SUCCESS;
+  int nof_decoded = 0;
+  for (uint32_t k = 0; k < nof_candidates; k++) {
+    uint32_t s            = first_sub_channel_idx + k / SL_NOF_PSCCH_CYCLIC_SHIFTS;
+    uint32_t cyclic_shift = 3 * (k % SL_NOF_PSCCH_CYCLIC_SHIFTS);
+    if (!crc_ok[k]) {
+      DEBUG("Error decoding PSCCH (cyclic shift: %d, pscch_prb_start_idx: %d)\n", cyclic_shift, pscch_prb_start_idx[s]);
+      continue;
+    }
+    if (pscch_unpack(q, s, c[k], cyclic_shift, pscch_prb_start_idx[s], sl_res) == SRSRAN_SUCCESS) {
+      if (pssch_decode(q, sf, s, sl_res) == SRSRAN_SUCCESS) {
+        nof_decoded += decoded[s] ? 0 : 1;
+        decoded[s] = true;
       }
     }
   }
-//  if (ret == SRSRAN_ERROR) {
-//    printf("Error decoding PSCCH or PSSCH (sub_channel_idx: %d, pscch_prb_start_idx: %d)\n",
-//           sub_channel_idx, pscch_prb_start_idx);
-//  }
+  return nof_decoded;
+}
 
-  return ret;
+int srsran_ue_sl_decode_subch(srsran_ue_sl_t* q,
+                              srsran_sl_sf_cfg_t* sf,
+                              uint32_t sub_channel_idx,
+                              srsran_ue_sl_res_t* sl_res)
+{
+  bool decoded[SRSRAN_MAX_NUM_SUB_CHANNEL] = {};
+  int  ret                                 = decode_sub_channels(q, sf, sub_channel_idx, 1, sl_res, decoded);
+  if (ret < SRSRAN_SUCCESS) {
+    return ret;
+  }
+  return decoded[sub_channel_idx] ? SRSRAN_SUCCESS : SRSRAN_ERROR;
+}
+
+int srsran_ue_sl_decode_sf(srsran_ue_sl_t* q, srsran_sl_sf_cfg_t* sf, srsran_ue_sl_res_t* sl_res, bool* decoded)
+{
+  if (q == NULL || sf == NULL || sl_res == NULL || decoded == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  for (uint32_t s = 0; s < q->sl_comm_resource_pool.num_sub_channel; s++) {
+    decoded[s] = false;
+  }
+  return decode_sub_channels(q, sf, 0, q->sl_comm_resource_pool.num_sub_channel, sl_res, decoded);
 }
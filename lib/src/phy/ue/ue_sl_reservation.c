@@ -0,0 +1,161 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "srsran/phy/ue/ue_sl.h"
+#include "srsran/phy/ue/ue_sl_reservation.h"
+#include "srsran/phy/utils/debug.h"
+
+#define SLOT_IDX(q, tti, sub_channel)                                                                                  \
+  (((tti) % SRSRAN_UE_SL_RESERVATION_HORIZON) * (q)->num_sub_channel + (sub_channel))
+
+int srsran_ue_sl_reservation_init(srsran_ue_sl_reservation_t* q, uint32_t num_sub_channel)
+{
+  if (q == NULL || num_sub_channel == 0 || num_sub_channel > SRSRAN_MAX_NUM_SUB_CHANNEL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  bzero(q, sizeof(srsran_ue_sl_reservation_t));
+  q->num_sub_channel = num_sub_channel;
+
+  uint32_t nof_entries = SRSRAN_UE_SL_RESERVATION_HORIZON * num_sub_channel;
+  q->slot_tti          = calloc(SRSRAN_UE_SL_RESERVATION_HORIZON, sizeof(uint32_t));
+  q->slot_valid        = calloc(nof_entries, sizeof(uint8_t));
+  q->slot_shift        = calloc(nof_entries, sizeof(uint8_t));
+  q->slot_priority     = calloc(nof_entries, sizeof(uint8_t));
+  if (!q->slot_tti || !q->slot_valid || !q->slot_shift || !q->slot_priority) {
+    ERROR("Error allocating reservation calendar\n");
+    srsran_ue_sl_reservation_free(q);
+    return SRSRAN_ERROR;
+  }
+
+  return SRSRAN_SUCCESS;
+}
+
+void srsran_ue_sl_reservation_free(srsran_ue_sl_reservation_t* q)
+{
+  if (q) {
+    if (q->slot_tti) {
+      free(q->slot_tti);
+    }
+    if (q->slot_valid) {
+      free(q->slot_valid);
+    }
+    if (q->slot_shift) {
+      free(q->slot_shift);
+    }
+    if (q->slot_priority) {
+      free(q->slot_priority);
+    }
+    bzero(q, sizeof(srsran_ue_sl_reservation_t));
+  }
+}
+
+void srsran_ue_sl_reservation_reset(srsran_ue_sl_reservation_t* q)
+{
+  if (q && q->slot_valid) {
+    bzero(q->slot_valid, SRSRAN_UE_SL_RESERVATION_HORIZON * q->num_sub_channel);
+    q->nof_predictions = 0;
+  }
+}
+
+/* Stores one predicted candidate. A slot still holding entries of an older subframe is cleared first, and when two
+ * senders announce the same sub-channel the one with the higher priority (lower value) is kept. */
+static int reservation_put(srsran_ue_sl_reservation_t* q,
+                           uint32_t                    tti,
+                           uint32_t                    sub_channel_idx,
+                           uint32_t                    cyclic_shift,
+                           uint32_t                    priority)
+{
+  uint32_t slot = tti % SRSRAN_UE_SL_RESERVATION_HORIZON;
+  if (q->slot_tti[slot] != tti) {
+    bzero(&q->slot_valid[SLOT_IDX(q, tti, 0)], q->num_sub_channel);
+    q->slot_tti[slot] = tti;
+  }
+
+  uint32_t idx = SLOT_IDX(q, tti, sub_channel_idx);
+  if (q->slot_valid[idx] && q->slot_priority[idx] < priority) {
+    return 0;
+  }
+  q->slot_valid[idx]    = 1;
+  q->slot_shift[idx]    = (uint8_t)cyclic_shift;
+  q->slot_priority[idx] = (uint8_t)priority;
+  q->nof_predictions++;
+  return 1;
+}
+
+int srsran_ue_sl_reservation_add(srsran_ue_sl_reservation_t* q,
+                                 const srsran_sci_t*         sci,
+                                 uint32_t                    tti,
+                                 uint32_t                    sub_channel_idx,
+                                 uint32_t                    cyclic_shift)
+{
+  if (q == NULL || sci == NULL || sub_channel_idx >= q->num_sub_channel) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  int nof_candidates = 0;
+
+  // The sender keeps the sub-channel for the next reservation period, 3GPP TS 36.213 Table 14.2.1-2
+  uint32_t period = srsran_intvl_from_reserv(sci->resource_reserv);
+  if (period > 0 && period < SRSRAN_UE_SL_RESERVATION_HORIZON) {
+    nof_candidates += reservation_put(q, tti + period, sub_channel_idx, cyclic_shift, sci->priority);
+  }
+
+  // An initial transmission announces where its retransmission starts, 3GPP TS 36.213 Section 14.1.1.4C
+  if (!sci->retransmission && sci->time_gap > 0) {
+    uint32_t L_subCH               = 0;
+    uint32_t sub_channel_start_idx = 0;
+    srsran_ra_sl_type0_from_riv(sci->riv, q->num_sub_channel, &L_subCH, &sub_channel_start_idx);
+    if (sub_channel_start_idx < q->num_sub_channel) {
+      nof_candidates += reservation_put(q, tti + sci->time_gap, sub_channel_start_idx, cyclic_shift, sci->priority);
+    }
+  }
+
+  return nof_candidates;
+}
+
+uint32_t srsran_ue_sl_reservation_get(srsran_ue_sl_reservation_t* q, uint32_t tti, srsran_ue_sl_candidate_t* candidates)
+{
+  if (q == NULL || candidates == NULL || q->slot_tti[tti % SRSRAN_UE_SL_RESERVATION_HORIZON] != tti) {
+    return 0;
+  }
+
+  // Insertion sort by priority, there are at most num_sub_channel entries
+  uint32_t n = 0;
+  for (uint32_t k = 0; k < q->num_sub_channel; k++) {
+    uint32_t idx = SLOT_IDX(q, tti, k);
+    if (!q->slot_valid[idx]) {
+      continue;
+    }
+    uint32_t i = n++;
+    while (i > 0 && candidates[i - 1].priority > q->slot_priority[idx]) {
+      candidates[i] = candidates[i - 1];
+      i--;
+    }
+    candidates[i].sub_channel_idx = k;
+    candidates[i].cyclic_shift    = q->slot_shift[idx];
+    candidates[i].priority        = q->slot_priority[idx];
+  }
+  return n;
+}
@@ -0,0 +1,996 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "srsran/phy/phch/ra.h"
+#include "srsran/phy/phch/ra_sl.h"
+#include "srsran/phy/ue/ue_sl.h"
+#include "srsran/phy/ue/ue_sl_sim.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+#define SIM_NONE UINT32_MAX
+
+// Float exponent and upper mantissa bits of the lowest SINR of the linear BLER tables, 2^-7 or -21 dB
+#define SIM_BLER_LIN_BASE ((127 - 7) << SRSRAN_UE_SL_SIM_BLER_LIN_BITS)
+
+// WINNER+ B1 beyond the breakpoint is 40 log10(d) plus this, 3GPP TR 36.885 Table A.1.4-1 with antennas at 1.5 m
+#define SIM_PL_FAR_DB(FC_GHZ) (7.56f - 34.6f * log10f(0.5f) + 2.7f * log10f(FC_GHZ))
+
+// Fraction of the attenuated Shannon capacity reached at 10% BLER, 3GPP TR 36.942 Annex A.1
+#define SIM_SHANNON_ALPHA 0.6f
+#define SIM_BLER_Q10 1.2816f
+#define SIM_PSSCH_SLOPE_DB 0.5f
+#define SIM_PSCCH_SLOPE_DB 1.0f
+
+// Share of the candidate resources that must be left after the exclusion, 3GPP TS 36.213 Section 14.1.1.6
+#define SIM_MIN_CANDIDATES_PCT 20
+#define SIM_RSRP_STEP_DB 3
+
+// Bits of the link hash of the uniform draws of each channel. The fading of every sub-channel hashes it again
+#define SIM_PSCCH_DRAW 30
+#define SIM_PSSCH_DRAW 0
+#define SIM_FADES_PER_HASH (64 / SRSRAN_UE_SL_SIM_TABLE_BITS)
+
+// Entries of the sensing map keep the subframe modulo 2^24 above the PSSCH-RSRP in dBm plus 200
+#define SIM_SENSING_TTI_MASK 0xffffffU
+
+typedef struct {
+  uint32_t batch_idx;
+  uint32_t bucket;
+  float    power; ///< Received in mW per sub-channel, before the fading
+  uint64_t draws; ///< Hash of the link in the subframe
+} sim_link_t;
+
+/* Shared by the receivers of a subframe */
+typedef struct {
+  uint64_t shd_key;
+  uint64_t tti_key;
+  uint32_t sensing_slot;
+} sim_subframe_t;
+
+typedef struct {
+  /* Thread identifier: they must set before thread creation */
+  pthread_t           pthread;
+  srsran_ue_sl_sim_t* q;
+  uint32_t            cell_begin;
+  uint32_t            cell_end;
+
+  /* Scratch of the receivers */
+  uint32_t*   candidates;
+  sim_link_t* links;
+
+  srsran_ue_sl_sim_stats_t stats;
+
+  /* Semaphores */
+  sem_t start;
+  sem_t finish;
+
+  /* Thread flags */
+  bool started;
+  bool quit;
+} sim_worker_t;
+
+void srsran_ue_sl_sim_cfg_default(srsran_ue_sl_sim_cfg_t* cfg)
+{
+  // 3GPP TR 36.885 freeway, 3 lanes per direction with 2.5 s between vehicles at 70 km/h
+  cfg->nof_vehicles       = 1000;
+  cfg->road_length_m      = 8000.0f;
+  cfg->nof_lanes          = 3;
+  cfg->lane_width_m       = 4.0f;
+  cfg->speed_kmph         = 70.0f;
+  cfg->period_ms          = 100;
+  cfg->mcs_idx            = 7;
+  cfg->L_subCH            = 2;
+  cfg->priority           = 0;
+  cfg->prob_keep          = 0.0f;
+  cfg->sensing            = true;
+  cfg->rsrp_threshold_dbm = -110.0f;
+  cfg->tx_power_dbm       = 23.0f;
+  cfg->noise_figure_db    = 9.0f;
+  cfg->carrier_ghz        = 5.9f;
+  cfg->shadowing_db       = 3.0f;
+  cfg->shadowing_ms       = 100;
+  cfg->fading             = true;
+  cfg->ibe_db             = -30.0f;
+  cfg->max_range_m        = 1000.0f;
+  cfg->distance_bucket_m  = 50.0f;
+  cfg->nof_threads        = 1;
+  cfg->seed               = 0;
+}
+
+/************ Random draws ************/
+
+/* splitmix64 finalizer of a combination of two keys */
+static inline uint64_t sim_hash(uint64_t a, uint64_t b)
+{
+  uint64_t z = (a + 0x9e3779b97f4a7c15ULL) * 0xbf58476d1ce4e5b9ULL ^ b;
+  z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z          = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/* Uniform draw in [0, 1) from 24 bits of a hash */
+static inline float sim_uniform(uint64_t h, uint32_t shift)
+{
+  return (float)((h >> shift) & 0xffffff) * (1.0f / 16777216.0f);
+}
+
+static inline uint32_t sim_table_idx(uint64_t h)
+{
+  return (uint32_t)(h >> (64 - SRSRAN_UE_SL_SIM_TABLE_BITS));
+}
+
+/* Fading power of the j-th sub-channel of a transmission, independent from the other sub-channels. Every hash of the
+ * link, taken at each multiple of SIM_FADES_PER_HASH, gives the table entries of that many sub-channels */
+static inline float sim_fade(const srsran_ue_sl_sim_t* q, uint64_t* h, uint64_t draws, uint32_t j)
+{
+  if (j % SIM_FADES_PER_HASH == 0) {
+    *h = sim_hash(draws, j);
+  }
+  return q->fade[sim_table_idx(*h << (j % SIM_FADES_PER_HASH * SRSRAN_UE_SL_SIM_TABLE_BITS))];
+}
+
+/* Inverse of the standard normal CDF by bisection */
+static double sim_normal_quantile(double p)
+{
+  double lo = -10.0, hi = 10.0;
+  for (uint32_t i = 0; i < 64; i++) {
+    double mid = (lo + hi) / 2;
+    if (0.5 * erfc(-mid / M_SQRT2) < p) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return (lo + hi) / 2;
+}
+
+/************ Link abstraction ************/
+
+/* 10 * log10(x) within 0.02 dB, enough for the 0.1 dB grid of the BLER tables */
+static inline float sim_db(float x)
+{
+  union {
+    float    f;
+    uint32_t i;
+  } u;
+  u.f     = x;
+  float e = (float)((int32_t)(u.i >> 23) - 127);
+  u.i     = (u.i & 0x7fffff) | 0x3f800000;
+  return 3.0103f * (e + (-0.34484843f * u.f + 2.02466578f) * u.f - 1.67487759f);
+}
+
+static inline float sim_bler_db(const float* table, float sinr_db)
+{
+  float idx = (sinr_db - SRSRAN_UE_SL_SIM_BLER_MIN_DB) * (1.0f / SRSRAN_UE_SL_SIM_BLER_STEP_DB) + 0.5f;
+  if (idx <= 0.0f) {
+    return table[0];
+  }
+  if (idx >= SRSRAN_UE_SL_SIM_BLER_LEN - 1) {
+    return table[SRSRAN_UE_SL_SIM_BLER_LEN - 1];
+  }
+  return table[(uint32_t)idx];
+}
+
+/* BLER of a linear SINR, indexed by its exponent and upper mantissa bits, without any logarithm */
+static inline float sim_bler(const float* table, float sinr)
+{
+  union {
+    float    f;
+    uint32_t i;
+  } u;
+  u.f         = sinr;
+  int32_t idx = (int32_t)(u.i >> (23 - SRSRAN_UE_SL_SIM_BLER_LIN_BITS)) - SIM_BLER_LIN_BASE;
+  idx         = SRSRAN_MAX(idx, 0);
+  idx         = SRSRAN_MIN(idx, SRSRAN_UE_SL_SIM_BLER_LIN_LEN - 1);
+  return table[idx];
+}
+
+/* Fills the table of a channel indexed by linear SINR from the one in dB, at the centre of every entry */
+static void sim_bler_update(srsran_ue_sl_sim_t* q, srsran_ue_sl_sim_channel_t channel)
+{
+  for (uint32_t i = 0; i < SRSRAN_UE_SL_SIM_BLER_LIN_LEN; i++) {
+    union {
+      float    f;
+      uint32_t i;
+    } u;
+    u.i = (i + SIM_BLER_LIN_BASE) << (23 - SRSRAN_UE_SL_SIM_BLER_LIN_BITS);
+    u.i |= 1U << (22 - SRSRAN_UE_SL_SIM_BLER_LIN_BITS);
+    q->bler_lin[channel][i] = sim_bler_db(q->bler[channel], 10.0f * log10f(u.f));
+  }
+}
+
+/* Step of a code of bits_per_re information bits per resource element, centred where the attenuated Shannon
+ * capacity matches its spectral efficiency, which is taken as the 10% BLER point */
+static void sim_bler_default(float* table, float bits_per_re, float slope_db)
+{
+  float threshold_db = 10.0f * log10f(powf(2.0f, bits_per_re / SIM_SHANNON_ALPHA) - 1.0f);
+  for (uint32_t i = 0; i < SRSRAN_UE_SL_SIM_BLER_LEN; i++) {
+    float sinr_db = SRSRAN_UE_SL_SIM_BLER_MIN_DB + i * SRSRAN_UE_SL_SIM_BLER_STEP_DB;
+    float x       = (sinr_db - threshold_db) / slope_db + SIM_BLER_Q10;
+    table[i]      = 0.5f * erfcf(x / (float)M_SQRT2);
+  }
+}
+
+/* 3GPP TR 36.885 Table A.1.4-1, WINNER+ B1 line of sight with antennas at 1.5 m, and never below free space */
+static float sim_pathloss_db(float d, float fc_ghz)
+{
+  d               = SRSRAN_MAX(d, 3.0f);
+  float h_eff     = 1.5f - 1.0f;
+  float d_bp      = 4.0f * h_eff * h_eff * fc_ghz * 1e9f / 3e8f;
+  float pl_free   = 20.0f * log10f(4.0f * (float)M_PI * d * fc_ghz * 1e9f / 3e8f);
+  float pl_winner = 0.0f;
+  if (d < d_bp) {
+    pl_winner = 22.7f * log10f(d) + 27.0f + 20.0f * log10f(fc_ghz);
+  } else {
+    pl_winner = 40.0f * log10f(d) + SIM_PL_FAR_DB(fc_ghz);
+  }
+  return SRSRAN_MAX(pl_free, pl_winner);
+}
+
+/************ Resource selection ************/
+
+static inline uint32_t sim_nof_slots(const srsran_ue_sl_sim_t* q)
+{
+  return SRSRAN_MIN(q->cfg.period_ms, SRSRAN_UE_SL_SIM_SENSING_SLOTS);
+}
+
+/* Reselection counter, 3GPP TS 36.321 Section 5.14.1.1 */
+static uint32_t sim_counter(srsran_ue_sl_sim_t* q)
+{
+  uint32_t scale = q->cfg.period_ms >= 100 ? 1 : 100 / q->cfg.period_ms;
+  return (uint32_t)srsran_random_uniform_int_dist(q->random, 5 * scale, 15 * scale);
+}
+
+/* Whether the last SCI seen on a sub-channel, in the slot of subframe t, reserves t */
+static inline uint8_t sim_sensed_rsrp(const srsran_ue_sl_sim_t* q, uint32_t v, uint64_t t, uint32_t sub_channel_idx)
+{
+  uint32_t slot = (uint32_t)(t % sim_nof_slots(q));
+  uint32_t idx  = (slot * q->cfg.nof_vehicles + v) * q->pool.num_sub_channel + sub_channel_idx;
+  uint8_t  rsrp = (uint8_t)(q->sensing[idx] & 0xff);
+  uint32_t dt   = ((uint32_t)t - (q->sensing[idx] >> 8)) & SIM_SENSING_TTI_MASK;
+  if (rsrp == 0 || dt == 0 || dt > SRSRAN_UE_SL_SIM_SENSING_WINDOW || dt % q->cfg.period_ms != 0) {
+    return 0;
+  }
+  return rsrp;
+}
+
+/* Picks the resource of the next packet of a vehicle within the selection window, at random among the candidates
+ * whose PSSCH-RSRP stays below a threshold raised until 20% of them are left. The ranking of the survivors by
+ * S-RSSI is not done, they are all equally likely */
+static int sim_select(srsran_ue_sl_sim_t* q, uint32_t v)
+{
+  uint32_t window    = sim_nof_slots(q);
+  uint32_t nof_start = q->pool.num_sub_channel - q->cfg.L_subCH + 1;
+  uint8_t  rsrp[SRSRAN_UE_SL_SIM_SENSING_SLOTS * SRSRAN_MAX_NUM_SUB_CHANNEL];
+
+  uint32_t nof_total = 0;
+  for (uint32_t k = 0; k < window; k++) {
+    uint64_t t = q->gen_tti[v] + 1 + k;
+    for (uint32_t s = 0; s < nof_start; s++) {
+      uint8_t r = UINT8_MAX;
+      if (srsran_sl_comm_resource_pool_sf_in_pool(&q->pool, (uint32_t)t)) {
+        r = 0;
+        for (uint32_t l = 0; q->cfg.sensing && l < q->cfg.L_subCH; l++) {
+          r = SRSRAN_MAX(r, sim_sensed_rsrp(q, v, t, s + l));
+        }
+        nof_total++;
+      }
+      rsrp[k * nof_start + s] = r;
+    }
+  }
+  if (nof_total == 0) {
+    ERROR("No subframe of the pool in the selection window\n");
+    return SRSRAN_ERROR;
+  }
+
+  int      threshold = (int)lrintf(q->cfg.rsrp_threshold_dbm) + 200;
+  uint32_t nof_left  = 0;
+  for (;; threshold += SIM_RSRP_STEP_DB) {
+    nof_left = 0;
+    for (uint32_t i = 0; i < window * nof_start; i++) {
+      nof_left += rsrp[i] < UINT8_MAX && rsrp[i] <= threshold;
+    }
+    if (nof_left * 100 >= nof_total * SIM_MIN_CANDIDATES_PCT) {
+      break;
+    }
+  }
+
+  uint32_t pick = (uint32_t)srsran_random_uniform_int_dist(q->random, 0, (int)nof_left - 1);
+  for (uint32_t i = 0; i < window * nof_start; i++) {
+    if (rsrp[i] < UINT8_MAX && rsrp[i] <= threshold && pick-- == 0) {
+      q->tx_tti[v]          = q->gen_tti[v] + 1 + i / nof_start;
+      q->sub_channel_idx[v] = i % nof_start;
+      break;
+    }
+  }
+  q->stats.nof_reselections++;
+  return SRSRAN_SUCCESS;
+}
+
+static void sim_schedule(srsran_ue_sl_sim_t* q, uint32_t v)
+{
+  uint32_t slot     = (uint32_t)(q->tx_tti[v] % SRSRAN_UE_SL_SIM_HORIZON);
+  q->next[v]        = q->calendar[slot];
+  q->calendar[slot] = v;
+}
+
+/* Keeps the resource for the next packet or selects a new one */
+static int sim_reschedule(srsran_ue_sl_sim_t* q, uint32_t v)
+{
+  uint64_t next     = q->tx_tti[v] + q->cfg.period_ms;
+  bool     reselect = false;
+
+  q->gen_tti[v] += q->cfg.period_ms;
+  if (--q->counter[v] == 0) {
+    q->counter[v] = sim_counter(q);
+    reselect      = srsran_random_uniform_real_dist(q->random, 0.0f, 1.0f) >= q->cfg.prob_keep;
+  }
+  if (!srsran_sl_comm_resource_pool_sf_in_pool(&q->pool, (uint32_t)next)) {
+    reselect = true;
+  }
+
+  if (reselect) {
+    if (sim_select(q, v) != SRSRAN_SUCCESS) {
+      return SRSRAN_ERROR;
+    }
+  } else {
+    q->tx_tti[v] = next;
+  }
+  sim_schedule(q, v);
+  return SRSRAN_SUCCESS;
+}
+
+/************ Reception ************/
+
+static void
+sim_receive(srsran_ue_sl_sim_t* q, sim_worker_t* w, const sim_subframe_t* sf, uint32_t r, uint32_t nof_candidates)
+{
+  const srsran_ue_sl_sim_cfg_t* cfg      = &q->cfg;
+  srsran_ue_sl_sim_stats_t*     stats    = &w->stats;
+  uint32_t                      nof_sub  = q->pool.num_sub_channel;
+  float                         range2   = cfg->max_range_m * cfg->max_range_m;
+  float                         half     = cfg->road_length_m / 2;
+  float                         inv_step = 1.0f / SRSRAN_UE_SL_SIM_PL_STEP_M;
+  float                         ibe      = q->ibe;
+  float                         inv_L    = 1.0f / cfg->L_subCH;
+  float                         x_r      = q->x[r];
+  float                         y_r      = q->y[r];
+  uint32_t                      nof_link = 0;
+  float                         ibe_sum  = 0.0f;
+  float                         interference[SRSRAN_MAX_NUM_SUB_CHANNEL];
+
+  for (uint32_t s = 0; s < nof_sub; s++) {
+    interference[s] = 0.0f;
+  }
+
+  // Received power of every transmission in range. The in-band emission falls on every sub-channel, the rest on the
+  // ones of the transmission
+  for (uint32_t i = 0; i < nof_candidates; i++) {
+    const srsran_ue_sl_sim_tx_t* tx = &q->batch_sorted[w->candidates[i]];
+    float                        dx = fabsf(tx->x - x_r);
+    dx                              = dx > half ? cfg->road_length_m - dx : dx;
+    float dy                        = tx->y - y_r;
+    float d2                        = dx * dx + dy * dy;
+    if (d2 > range2 || tx->vehicle == r) {
+      continue;
+    }
+    float d = sqrtf(d2);
+
+    // One hash of the link in this subframe gives its fading and the draws of both channels
+    uint64_t pair  = tx->vehicle < r ? (uint64_t)tx->vehicle << 32 | r : (uint64_t)r << 32 | tx->vehicle;
+    uint64_t draws = sim_hash(sf->tti_key, (uint64_t)tx->vehicle << 32 | r);
+    float    p     = d < SRSRAN_UE_SL_SIM_PL_NEAR_M ? q->pl_near[(uint32_t)(d * inv_step)] : q->pl_far / (d2 * d2);
+    p *= q->shadow[sim_table_idx(sim_hash(sf->shd_key, pair))] * inv_L;
+
+    // The in-band emission follows the average power of the used sub-channels
+    float    p_sum = 0.0f;
+    uint64_t h     = 0;
+    for (uint32_t j = 0; j < tx->L_subCH; j++) {
+      float p_s = p * sim_fade(q, &h, draws, j);
+      interference[tx->sub_channel_idx + j] += p_s - p_s * ibe;
+      p_sum += p_s;
+    }
+    ibe_sum += p_sum * inv_L * ibe;
+
+    w->links[nof_link].batch_idx = w->candidates[i];
+    w->links[nof_link].bucket    = (uint32_t)(d / cfg->distance_bucket_m);
+    w->links[nof_link].power     = p;
+    w->links[nof_link].draws     = draws;
+    nof_link++;
+  }
+  stats->nof_links += nof_link;
+
+  if (q->tx_tti[r] == q->tti) {
+    for (uint32_t k = 0; k < nof_link; k++) {
+      stats->distance[w->links[k].bucket].nof_tx++;
+    }
+    stats->nof_half_duplex += nof_link;
+    return;
+  }
+
+  for (uint32_t s = 0; s < nof_sub; s++) {
+    interference[s] += q->noise_mw + ibe_sum;
+  }
+
+  uint32_t* sensing        = &q->sensing[(sf->sensing_slot * cfg->nof_vehicles + r) * nof_sub];
+  float     rsrp_scale     = (float)cfg->L_subCH / (q->nof_prb * SRSRAN_NRE);
+  uint32_t  nof_pscch_fail = 0;
+  uint32_t  nof_pssch_fail = 0;
+  for (uint32_t k = 0; k < nof_link; k++) {
+    const sim_link_t*            l  = &w->links[k];
+    const srsran_ue_sl_sim_tx_t* tx = &q->batch_sorted[l->batch_idx];
+    srsran_ue_sl_sim_count_t*    c  = &stats->distance[l->bucket];
+    c->nof_tx++;
+
+    // The PSCCH is on the first sub-channel
+    uint64_t h    = 0;
+    uint32_t s0   = tx->sub_channel_idx;
+    float    p_s0 = l->power * sim_fade(q, &h, l->draws, 0);
+    float    sinr = p_s0 / (interference[s0] - p_s0);
+    if (sim_uniform(l->draws, SIM_PSCCH_DRAW) < sim_bler(q->bler_lin[SRSRAN_UE_SL_SIM_PSCCH], sinr)) {
+      nof_pscch_fail++;
+      continue;
+    }
+
+    // The PSSCH sees every sub-channel with its own fading. Its effective SINR has the mean Shannon capacity of them
+    float p_sum    = p_s0;
+    float capacity = log2f(1.0f + sinr);
+    for (uint32_t j = 1; j < tx->L_subCH; j++) {
+      float p_s = l->power * sim_fade(q, &h, l->draws, j);
+      p_sum += p_s;
+      capacity += log2f(1.0f + p_s / (interference[s0 + j] - p_s));
+    }
+
+    // The SCI announces the resource of the next period. The receivers of a subframe write the same slot, so the map
+    // is laid out by slot first
+    if (tx->sci.resource_reserv != 0) {
+      float    rsrp  = sim_db(p_sum * inv_L * rsrp_scale) + 200.0f;
+      uint32_t entry = (uint32_t)q->tti << 8 | (uint32_t)SRSRAN_MAX(1.0f, SRSRAN_MIN(rsrp, 254.0f));
+      for (uint32_t s = s0; s < s0 + tx->L_subCH; s++) {
+        sensing[s] = entry;
+      }
+    }
+
+    sinr = exp2f(capacity / tx->L_subCH) - 1.0f;
+    if (sim_uniform(l->draws, SIM_PSSCH_DRAW) < sim_bler(q->bler_lin[SRSRAN_UE_SL_SIM_PSSCH], sinr)) {
+      nof_pssch_fail++;
+      continue;
+    }
+    c->nof_rx++;
+  }
+  stats->nof_pscch_fail += nof_pscch_fail;
+  stats->nof_pssch_fail += nof_pssch_fail;
+}
+
+/* Receivers of the cells of a worker, against the transmissions of their cell and the neighbouring ones */
+static void sim_run_cells(srsran_ue_sl_sim_t* q, sim_worker_t* w)
+{
+  sim_subframe_t sf;
+  uint64_t       seed_key = (uint64_t)q->cfg.seed << 40;
+  sf.shd_key              = seed_key | (q->tti / q->cfg.shadowing_ms) << 8;
+  sf.tti_key              = seed_key | q->tti << 8;
+  sf.sensing_slot         = (uint32_t)(q->tti % sim_nof_slots(q));
+
+  for (uint32_t c = w->cell_begin; c < w->cell_end; c++) {
+    uint32_t nof_candidates = 0;
+    for (int dc = -1; dc <= 1; dc++) {
+      if (q->nof_cells < 3 && dc != 0) {
+        continue;
+      }
+      uint32_t cc = (c + q->nof_cells + dc) % q->nof_cells;
+      for (uint32_t b = q->tx_cell_start[cc]; b < q->tx_cell_start[cc + 1]; b++) {
+        w->candidates[nof_candidates++] = b;
+      }
+    }
+    if (nof_candidates == 0) {
+      continue;
+    }
+    for (uint32_t i = q->cell_start[c]; i < q->cell_start[c + 1]; i++) {
+      sim_receive(q, w, &sf, q->cell_vehicles[i], nof_candidates);
+    }
+  }
+}
+
+static void* sim_worker_thread(void* arg)
+{
+  sim_worker_t* w = (sim_worker_t*)arg;
+
+  sem_wait(&w->start);
+  while (!w->quit) {
+    sim_run_cells(w->q, w);
+
+    /* Post finish semaphore */
+    sem_post(&w->finish);
+
+    /* Wait for next loop */
+    sem_wait(&w->start);
+  }
+  sem_post(&w->finish);
+
+  pthread_exit(NULL);
+  return w;
+}
+
+/************ Subframe ************/
+
+/* Positions of all vehicles in the current subframe, sorted by cell */
+static void sim_update_positions(srsran_ue_sl_sim_t* q)
+{
+  uint32_t N = q->cfg.nof_vehicles;
+
+  memset(q->cell_start, 0, sizeof(uint32_t) * (q->nof_cells + 1));
+  for (uint32_t v = 0; v < N; v++) {
+    double x = fmod(q->x0[v] + q->v[v] * (double)q->tti, q->cfg.road_length_m);
+    x        = x < 0 ? x + q->cfg.road_length_m : x;
+    q->x[v]  = (float)x;
+    uint32_t c = (uint32_t)(x / q->cell_len);
+    c          = SRSRAN_MIN(c, q->nof_cells - 1);
+    q->cell_of[v] = c;
+    q->cell_start[c + 1]++;
+  }
+  for (uint32_t c = 0; c < q->nof_cells; c++) {
+    q->cell_start[c + 1] += q->cell_start[c];
+  }
+  for (uint32_t v = 0; v < N; v++) {
+    q->cell_vehicles[q->cell_start[q->cell_of[v]]++] = v;
+  }
+  for (uint32_t c = q->nof_cells; c > 0; c--) {
+    q->cell_start[c] = q->cell_start[c - 1];
+  }
+  q->cell_start[0] = 0;
+}
+
+/* Builds the SCI of every transmission of the subframe, as its receivers decode it, sorted by cell */
+static void sim_prepare_batch(srsran_ue_sl_sim_t* q, uint32_t head)
+{
+  q->nof_batch = 0;
+  for (uint32_t v = head; v != SIM_NONE; v = q->next[v]) {
+    srsran_ue_sl_sim_tx_t* tx = &q->batch[q->nof_batch++];
+    srsran_sci_t*          sci = &tx->sci;
+
+    bzero(sci, sizeof(srsran_sci_t));
+    sci->format           = SRSRAN_SCI_FORMAT1;
+    sci->tm               = q->cell.tm;
+    sci->nof_prb          = q->cell.nof_prb;
+    sci->size_sub_channel = q->pool.size_sub_channel;
+    sci->num_sub_channel  = q->pool.num_sub_channel;
+    sci->riv = srsran_ra_sl_type0_to_riv(q->pool.num_sub_channel, q->sub_channel_idx[v], q->cfg.L_subCH);
+    srsran_set_sci(sci, q->cfg.priority, q->cfg.period_ms, 0, false, 0, q->cfg.mcs_idx);
+
+    tx->vehicle = v;
+    tx->cell    = q->cell_of[v];
+    tx->x       = q->x[v];
+    tx->y       = q->y[v];
+    srsran_ra_sl_type0_from_riv(sci->riv, q->pool.num_sub_channel, &tx->L_subCH, &tx->sub_channel_idx);
+  }
+
+  memset(q->tx_cell_start, 0, sizeof(uint32_t) * (q->nof_cells + 1));
+  for (uint32_t b = 0; b < q->nof_batch; b++) {
+    q->tx_cell_start[q->batch[b].cell + 1]++;
+  }
+  for (uint32_t c = 0; c < q->nof_cells; c++) {
+    q->tx_cell_start[c + 1] += q->tx_cell_start[c];
+  }
+  for (uint32_t b = 0; b < q->nof_batch; b++) {
+    q->batch_sorted[q->tx_cell_start[q->batch[b].cell]++] = q->batch[b];
+  }
+  for (uint32_t c = q->nof_cells; c > 0; c--) {
+    q->tx_cell_start[c] = q->tx_cell_start[c - 1];
+  }
+  q->tx_cell_start[0] = 0;
+}
+
+int srsran_ue_sl_sim_run(srsran_ue_sl_sim_t* q, uint64_t nof_subframes)
+{
+  if (q == NULL || q->workers == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  sim_worker_t* workers = (sim_worker_t*)q->workers;
+  uint64_t      end     = q->tti + nof_subframes;
+  for (; q->tti < end; q->tti++) {
+    q->stats.nof_subframes++;
+
+    uint32_t slot = (uint32_t)(q->tti % SRSRAN_UE_SL_SIM_HORIZON);
+    uint32_t head = q->calendar[slot];
+    if (head == SIM_NONE) {
+      continue;
+    }
+    q->calendar[slot] = SIM_NONE;
+    q->stats.nof_busy++;
+
+    sim_update_positions(q);
+    sim_prepare_batch(q, head);
+    q->stats.nof_transmissions += q->nof_batch;
+
+    for (uint32_t i = 1; i < q->cfg.nof_threads; i++) {
+      sem_post(&workers[i].start);
+    }
+    sim_run_cells(q, &workers[0]);
+    for (uint32_t i = 1; i < q->cfg.nof_threads; i++) {
+      sem_wait(&workers[i].finish);
+    }
+
+    for (uint32_t b = 0; b < q->nof_batch; b++) {
+      if (sim_reschedule(q, q->batch[b].vehicle) != SRSRAN_SUCCESS) {
+        return SRSRAN_ERROR;
+      }
+    }
+  }
+
+  return SRSRAN_SUCCESS;
+}
+
+/************ Setup ************/
+
+static bool sim_cfg_is_valid(const srsran_ue_sl_sim_cfg_t* cfg, const srsran_sl_comm_resource_pool_t* pool)
+{
+  uint32_t P = cfg->period_ms;
+  if (P != 20 && P != 50 && (P % 100 != 0 || P == 0 || P > 1000)) {
+    ERROR("Invalid period %d ms, valid values are 20, 50, 100, 200, ... 1000\n", P);
+    return false;
+  }
+  if (cfg->nof_vehicles == 0 || cfg->nof_lanes == 0 || cfg->road_length_m <= 0 || cfg->max_range_m <= 0) {
+    ERROR("Invalid scenario\n");
+    return false;
+  }
+  if (cfg->mcs_idx > 28 || cfg->L_subCH == 0 || cfg->L_subCH > pool->num_sub_channel ||
+      pool->num_sub_channel > SRSRAN_MAX_NUM_SUB_CHANNEL) {
+    ERROR("Invalid transmission of %d sub-channels with MCS %d\n", cfg->L_subCH, cfg->mcs_idx);
+    return false;
+  }
+  if (cfg->distance_bucket_m <= 0 || cfg->max_range_m / cfg->distance_bucket_m >= SRSRAN_UE_SL_SIM_MAX_BUCKETS) {
+    ERROR("Distance buckets of %.1f m do not cover %.1f m\n", cfg->distance_bucket_m, cfg->max_range_m);
+    return false;
+  }
+  if (cfg->nof_threads == 0 || cfg->nof_threads > SRSRAN_UE_SL_SIM_MAX_THREADS || cfg->shadowing_ms == 0) {
+    ERROR("Invalid number of threads %d\n", cfg->nof_threads);
+    return false;
+  }
+  return true;
+}
+
+static int sim_transport_init(srsran_ue_sl_sim_t* q)
+{
+  uint32_t prb_start = 0;
+  srsran_sl_comm_resource_pool_get_pssch_prb(&q->pool, 0, q->cfg.L_subCH, &prb_start, &q->nof_prb);
+
+  int tbs = srsran_ra_tbs_from_idx(srsran_ra_tbs_idx_from_mcs(q->cfg.mcs_idx, false, true), q->nof_prb);
+  if (tbs <= 0 || q->nof_prb == 0) {
+    ERROR("No transport block of MCS %d fits %d PRB\n", q->cfg.mcs_idx, q->nof_prb);
+    return SRSRAN_ERROR;
+  }
+  q->tbs = (uint32_t)tbs;
+
+  // As srsran_pssch_set_cfg(), the last data symbol is not transmitted
+  uint32_t nof_symbols = 0;
+  for (uint32_t i = 0; i < srsran_sl_get_num_symbols(q->cell.tm, q->cell.cp); i++) {
+    nof_symbols += srsran_pssch_is_symbol(SRSRAN_SIDELINK_DATA_SYMBOL, q->cell.tm, i, q->cell.cp);
+  }
+  uint32_t nof_re = (nof_symbols - 1) * SRSRAN_NRE * q->nof_prb;
+  uint32_t Qm     = srsran_mod_bits_x_symbol(srsran_ra_ul_mod_from_mcs(q->cfg.mcs_idx));
+  q->code_rate    = (float)(q->tbs + 24) / (nof_re * Qm); // Transport block and its CRC
+
+  float pscch_bits_per_re =
+      (float)(SRSRAN_SCI_TM34_LEN + SRSRAN_SCI_CRC_LEN) / (SRSRAN_PSCCH_TM34_NOF_CODED_BITS / SRSRAN_PSCCH_QM);
+  sim_bler_default(q->bler[SRSRAN_UE_SL_SIM_PSCCH], pscch_bits_per_re, SIM_PSCCH_SLOPE_DB);
+  sim_bler_default(q->bler[SRSRAN_UE_SL_SIM_PSSCH], q->code_rate * Qm, SIM_PSSCH_SLOPE_DB);
+  sim_bler_update(q, SRSRAN_UE_SL_SIM_PSCCH);
+  sim_bler_update(q, SRSRAN_UE_SL_SIM_PSSCH);
+  return SRSRAN_SUCCESS;
+}
+
+static int sim_link_init(srsran_ue_sl_sim_t* q)
+{
+  const srsran_ue_sl_sim_cfg_t* cfg = &q->cfg;
+
+  // Far away, the path loss needs neither the table nor a logarithm
+  float d_near  = SRSRAN_UE_SL_SIM_PL_NEAR_M;
+  float pl_near = sim_pathloss_db(d_near, cfg->carrier_ghz);
+  if (fabsf(pl_near - 40.0f * log10f(d_near) - SIM_PL_FAR_DB(cfg->carrier_ghz)) > 0.01f) {
+    ERROR("The path loss at %.1f GHz is not past its breakpoint at %.0f m\n", cfg->carrier_ghz, d_near);
+    return SRSRAN_ERROR;
+  }
+  for (uint32_t i = 0; i < SRSRAN_UE_SL_SIM_PL_NEAR_LEN; i++) {
+    float d       = (i + 0.5f) * SRSRAN_UE_SL_SIM_PL_STEP_M;
+    q->pl_near[i] = srsran_convert_dB_to_power(cfg->tx_power_dbm - sim_pathloss_db(d, cfg->carrier_ghz));
+  }
+  q->pl_far = srsran_convert_dB_to_power(cfg->tx_power_dbm - SIM_PL_FAR_DB(cfg->carrier_ghz));
+
+  // Quantiles, so that the tables do not depend on any random generator
+  for (uint32_t i = 0; i < SRSRAN_UE_SL_SIM_TABLE_LEN; i++) {
+    double p     = (i + 0.5) / SRSRAN_UE_SL_SIM_TABLE_LEN;
+    q->shadow[i] = srsran_convert_dB_to_power(cfg->shadowing_db * (float)sim_normal_quantile(p));
+    q->fade[i]   = cfg->fading ? (float)-log(p) : 1.0f;
+  }
+
+  q->noise_mw = srsran_convert_dB_to_power(-174.0f + cfg->noise_figure_db +
+                                           10.0f * log10f(q->pool.size_sub_channel * SRSRAN_NRE * 15e3f));
+  q->ibe      = srsran_convert_dB_to_power(cfg->ibe_db);
+  return SRSRAN_SUCCESS;
+}
+
+static int sim_vehicles_init(srsran_ue_sl_sim_t* q)
+{
+  const srsran_ue_sl_sim_cfg_t* cfg = &q->cfg;
+  uint32_t                      N   = cfg->nof_vehicles;
+  uint32_t                      M   = N * sim_nof_slots(q) * q->pool.num_sub_channel;
+
+  q->x0              = srsran_vec_f_malloc(N);
+  q->y               = srsran_vec_f_malloc(N);
+  q->v               = srsran_vec_f_malloc(N);
+  q->x               = srsran_vec_f_malloc(N);
+  q->cell_of         = srsran_vec_u32_malloc(N);
+  q->gen_tti         = calloc(N, sizeof(uint64_t));
+  q->tx_tti          = calloc(N, sizeof(uint64_t));
+  q->sub_channel_idx = srsran_vec_u32_malloc(N);
+  q->counter         = srsran_vec_u32_malloc(N);
+  q->next            = srsran_vec_u32_malloc(N);
+  q->sensing         = calloc(M, sizeof(uint32_t));
+  q->cell_start      = calloc(q->nof_cells + 1, sizeof(uint32_t));
+  q->tx_cell_start   = calloc(q->nof_cells + 1, sizeof(uint32_t));
+  q->cell_vehicles   = srsran_vec_u32_malloc(N);
+  q->batch           = calloc(N, sizeof(srsran_ue_sl_sim_tx_t));
+  q->batch_sorted    = calloc(N, sizeof(srsran_ue_sl_sim_tx_t));
+  if (!q->x0 || !q->y || !q->v || !q->x || !q->cell_of || !q->gen_tti || !q->tx_tti || !q->sub_channel_idx ||
+      !q->counter || !q->next || !q->sensing || !q->cell_start || !q->tx_cell_start ||
+      !q->cell_vehicles || !q->batch || !q->batch_sorted) {
+    ERROR("Error allocating %d vehicles\n", N);
+    return SRSRAN_ERROR;
+  }
+
+  for (uint32_t i = 0; i < SRSRAN_UE_SL_SIM_HORIZON; i++) {
+    q->calendar[i] = SIM_NONE;
+  }
+
+  // Consecutive vehicles take consecutive lanes, the first half of the lanes in one direction
+  for (uint32_t v = 0; v < N; v++) {
+    uint32_t lane = v % (2 * cfg->nof_lanes);
+    float    dir  = lane < cfg->nof_lanes ? 1.0f : -1.0f;
+    q->x0[v]      = cfg->road_length_m * v / N;
+    q->y[v]       = cfg->lane_width_m * lane;
+    q->v[v]       = dir * cfg->speed_kmph / 3.6f / 1000.0f;
+  }
+
+  // First packets are spread over one period
+  for (uint32_t v = 0; v < N; v++) {
+    q->gen_tti[v] = (uint64_t)srsran_random_uniform_int_dist(q->random, 0, (int)cfg->period_ms - 1);
+    q->counter[v] = sim_counter(q);
+    if (sim_select(q, v) != SRSRAN_SUCCESS) {
+      return SRSRAN_ERROR;
+    }
+    sim_schedule(q, v);
+  }
+  q->stats.nof_reselections = 0;
+  return SRSRAN_SUCCESS;
+}
+
+static int sim_workers_init(srsran_ue_sl_sim_t* q)
+{
+  q->workers = calloc(q->cfg.nof_threads, sizeof(sim_worker_t));
+  if (q->workers == NULL) {
+    return SRSRAN_ERROR;
+  }
+
+  sim_worker_t* workers = (sim_worker_t*)q->workers;
+  for (uint32_t i = 0; i < q->cfg.nof_threads; i++) {
+    workers[i].q          = q;
+    workers[i].cell_begin = (q->nof_cells * i) / q->cfg.nof_threads;
+    workers[i].cell_end   = (q->nof_cells * (i + 1)) / q->cfg.nof_threads;
+    workers[i].candidates = srsran_vec_u32_malloc(q->cfg.nof_vehicles);
+    workers[i].links      = calloc(q->cfg.nof_vehicles, sizeof(sim_link_t));
+    if (!workers[i].candidates || !workers[i].links) {
+      ERROR("Error allocating simulation worker\n");
+      return SRSRAN_ERROR;
+    }
+    if (i == 0) {
+      continue;
+    }
+
+    if (sem_init(&workers[i].start, 0, 0) || sem_init(&workers[i].finish, 0, 0)) {
+      ERROR("Error creating semaphore\n");
+      return SRSRAN_ERROR;
+    }
+    if (pthread_create(&workers[i].pthread, NULL, sim_worker_thread, &workers[i])) {
+      ERROR("Error creating simulation thread\n");
+      sem_destroy(&workers[i].start);
+      sem_destroy(&workers[i].finish);
+      return SRSRAN_ERROR;
+    }
+    workers[i].started = true;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int srsran_ue_sl_sim_init(srsran_ue_sl_sim_t*                   q,
+                          const srsran_ue_sl_sim_cfg_t*         cfg,
+                          srsran_cell_sl_t                      cell,
+                          const srsran_sl_comm_resource_pool_t* pool)
+{
+  if (q == NULL || cfg == NULL || pool == NULL || !sim_cfg_is_valid(cfg, pool)) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  bzero(q, sizeof(srsran_ue_sl_sim_t));
+  q->cfg  = *cfg;
+  q->cell = cell;
+  q->pool = *pool;
+
+  // Cells at least as long as the range, so that a receiver only hears its cell and the two next to it
+  q->nof_cells = (uint32_t)(cfg->road_length_m / cfg->max_range_m);
+  q->nof_cells = q->nof_cells < 3 ? 1 : q->nof_cells;
+  q->cell_len  = cfg->road_length_m / q->nof_cells;
+
+  q->random = srsran_random_init(cfg->seed);
+  if (q->random == NULL || sim_transport_init(q) != SRSRAN_SUCCESS || sim_link_init(q) != SRSRAN_SUCCESS ||
+      sim_vehicles_init(q) != SRSRAN_SUCCESS || sim_workers_init(q) != SRSRAN_SUCCESS) {
+    srsran_ue_sl_sim_free(q);
+    return SRSRAN_ERROR;
+  }
+
+  return SRSRAN_SUCCESS;
+}
+
+void srsran_ue_sl_sim_free(srsran_ue_sl_sim_t* q)
+{
+  if (q == NULL) {
+    return;
+  }
+
+  sim_worker_t* workers = (sim_worker_t*)q->workers;
+  if (workers) {
+    for (uint32_t i = 0; i < q->cfg.nof_threads; i++) {
+      if (workers[i].started) {
+        workers[i].quit = true;
+        sem_post(&workers[i].start);
+        pthread_join(workers[i].pthread, NULL);
+        sem_destroy(&workers[i].start);
+        sem_destroy(&workers[i].finish);
+      }
+      free(workers[i].candidates);
+      free(workers[i].links);
+    }
+    free(workers);
+  }
+
+  void* arrays[] = {q->x0,
+                    q->y,
+                    q->v,
+                    q->x,
+                    q->cell_of,
+                    q->gen_tti,
+                    q->tx_tti,
+                    q->sub_channel_idx,
+                    q->counter,
+                    q->next,
+                    q->sensing,
+                    q->cell_start,
+                    q->tx_cell_start,
+                    q->cell_vehicles,
+                    q->batch,
+                    q->batch_sorted};
+  for (uint32_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++) {
+    free(arrays[i]);
+  }
+  if (q->random) {
+    srsran_random_free(q->random);
+  }
+
+  bzero(q, sizeof(srsran_ue_sl_sim_t));
+}
+
+int srsran_ue_sl_sim_set_bler(srsran_ue_sl_sim_t*        q,
+                              srsran_ue_sl_sim_channel_t channel,
+                              const float*               sinr_db,
+                              const float*               bler,
+                              uint32_t                   nof_points)
+{
+  if (q == NULL || channel >= SRSRAN_UE_SL_SIM_NOF_CHANNELS || sinr_db == NULL || bler == NULL || nof_points == 0) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  for (uint32_t i = 1; i < nof_points; i++) {
+    if (sinr_db[i] <= sinr_db[i - 1]) {
+      ERROR("BLER curve SINR must be increasing\n");
+      return SRSRAN_ERROR_INVALID_INPUTS;
+    }
+  }
+
+  uint32_t k = 0;
+  for (uint32_t i = 0; i < SRSRAN_UE_SL_SIM_BLER_LEN; i++) {
+    float x = SRSRAN_UE_SL_SIM_BLER_MIN_DB + i * SRSRAN_UE_SL_SIM_BLER_STEP_DB;
+    while (k + 1 < nof_points && sinr_db[k + 1] <= x) {
+      k++;
+    }
+    float y = bler[k];
+    if (k + 1 < nof_points && x > sinr_db[k]) {
+      y += (bler[k + 1] - bler[k]) * (x - sinr_db[k]) / (sinr_db[k + 1] - sinr_db[k]);
+    }
+    q->bler[channel][i] = SRSRAN_MAX(0.0f, SRSRAN_MIN(y, 1.0f));
+  }
+  sim_bler_update(q, channel);
+  return SRSRAN_SUCCESS;
+}
+
+float srsran_ue_sl_sim_get_bler(const srsran_ue_sl_sim_t* q, srsran_ue_sl_sim_channel_t channel, float sinr_db)
+{
+  if (q == NULL || channel >= SRSRAN_UE_SL_SIM_NOF_CHANNELS) {
+    return NAN;
+  }
+  return sim_bler_db(q->bler[channel], sinr_db);
+}
+
+void srsran_ue_sl_sim_get_stats(srsran_ue_sl_sim_t* q, srsran_ue_sl_sim_stats_t* stats)
+{
+  if (q == NULL || stats == NULL) {
+    return;
+  }
+
+  *stats             = q->stats;
+  stats->nof_buckets = (uint32_t)ceilf(q->cfg.max_range_m / q->cfg.distance_bucket_m);
+
+  sim_worker_t* workers = (sim_worker_t*)q->workers;
+  for (uint32_t i = 0; workers && i < q->cfg.nof_threads; i++) {
+    const srsran_ue_sl_sim_stats_t* w = &workers[i].stats;
+    stats->nof_links += w->nof_links;
+    stats->nof_half_duplex += w->nof_half_duplex;
+    stats->nof_pscch_fail += w->nof_pscch_fail;
+    stats->nof_pssch_fail += w->nof_pssch_fail;
+    for (uint32_t b = 0; b < SRSRAN_UE_SL_SIM_MAX_BUCKETS; b++) {
+      stats->distance[b].nof_tx += w->distance[b].nof_tx;
+      stats->distance[b].nof_rx += w->distance[b].nof_rx;
+    }
+  }
+}
+
+void srsran_ue_sl_sim_fprint_stats(FILE* f, srsran_ue_sl_sim_t* q)
+{
+  srsran_ue_sl_sim_stats_t s = {};
+  srsran_ue_sl_sim_get_stats(q, &s);
+
+  uint64_t nof_rx = 0;
+  for (uint32_t b = 0; b < s.nof_buckets; b++) {
+    nof_rx += s.distance[b].nof_rx;
+  }
+  fprintf(f,
+          "%d vehicles, %.1f s, TBS %d bits in %d PRB (rate %.2f): %" PRIu64 " transmissions, %" PRIu64
+          " reselections, %" PRIu64 " links, PRR %.4f, lost %" PRIu64 " half duplex, %" PRIu64 " PSCCH, %" PRIu64
+          " PSSCH\n",
+          q->cfg.nof_vehicles,
+          s.nof_subframes / 1000.0,
+          q->tbs,
+          q->nof_prb,
+          q->code_rate,
+          s.nof_transmissions,
+          s.nof_reselections,
+          s.nof_links,
+          s.nof_links ? (double)nof_rx / s.nof_links : 0.0,
+          s.nof_half_duplex,
+          s.nof_pscch_fail,
+          s.nof_pssch_fail);
+}
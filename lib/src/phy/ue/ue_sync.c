@@ -25,6 +25,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <sys/time.h>
 #include <unistd.h>
 
 #include "srsran/phy/ue/ue_sync.h"
@@ -314,11 +315,38 @@ uint32_t srsran_ue_sync_sf_len(srsran_ue_sync_t* q)
   return q->frame_len;
 }
 
+static void ue_sync_slss_free(srsran_ue_sync_t* q)
+{
+  if (!q->slss_is_init) {
+    return;
+  }
+  srsran_psss_free(&q->psss);
+  srsran_ssss_free(&q->ssss);
+  srsran_psbch_free(&q->psbch);
+  srsran_chest_sl_free(&q->psbch_chest);
+  bzero(&q->psbch_chest, sizeof(srsran_chest_sl_t));
+  srsran_ofdm_rx_free(&q->slss_fft);
+  if (q->slss_sf_time) {
+    free(q->slss_sf_time);
+  }
+  if (q->slss_sf_symbols) {
+    free(q->slss_sf_symbols);
+  }
+  if (q->slss_equalized) {
+    free(q->slss_equalized);
+  }
+  q->slss_sf_time    = NULL;
+  q->slss_sf_symbols = NULL;
+  q->slss_equalized  = NULL;
+  q->slss_is_init    = false;
+}
+
 void srsran_ue_sync_free(srsran_ue_sync_t* q)
 {
   if (q->do_agc) {
     srsran_agc_free(&q->agc);
   }
+  ue_sync_slss_free(q);
   if (!q->file_mode && q->mode == SYNC_MODE_PSS) {
     srsran_sync_free(&q->sfind);
     srsran_sync_free(&q->strack);
@@ -435,6 +463,95 @@ int srsran_ue_sync_set_cell(srsran_ue_sync_t* q, srsran_cell_t cell)
   return ret;
 }
 
+/** Configures the sidelink cell for SLSS-based synchronization (SYNC_MODE_SLSS).
+ * The UE searches PSSS/SSSS over full subframes until the PSBCH (MIB-SL) is decoded, which provides the direct
+ * frame and subframe numbers. Once locked, only a narrow window around the expected SLSS is correlated every
+ * SRSRAN_SL_V2X_SLSS_PERIOD subframes.
+ */
+int srsran_ue_sync_set_cell_sl(srsran_ue_sync_t* q, srsran_cell_sl_t cell_sl)
+{
+  int ret = SRSRAN_ERROR_INVALID_INPUTS;
+
+  if (q != NULL && q->mode == SYNC_MODE_SLSS && srsran_nofprb_isvalid(cell_sl.nof_prb)) {
+    ret = SRSRAN_ERROR;
+
+    if (cell_sl.nof_prb > q->max_prb) {
+      ERROR("Error in ue_sync_set_cell_sl(): cell_sl.nof_prb must be lower than initialized\n");
+      return SRSRAN_ERROR;
+    }
+
+    ue_sync_slss_free(q);
+
+    q->cell_sl      = cell_sl;
+    q->cell.nof_prb = cell_sl.nof_prb;
+    q->cell.cp      = cell_sl.cp;
+    q->fft_size     = srsran_symbol_sz(cell_sl.nof_prb);
+    q->sf_len       = SRSRAN_SF_LEN(q->fft_size);
+    q->nof_recv_sf  = 1;
+    q->frame_len    = q->nof_recv_sf * q->sf_len;
+
+    // Tracking window, wide enough for the drift accumulated within one SLSS period
+    q->slss_track_max_offset = SRSRAN_MAX(8, q->fft_size / 32);
+
+    if (srsran_psss_init(&q->psss, cell_sl.nof_prb, cell_sl.cp) != SRSRAN_SUCCESS) {
+      ERROR("Error initiating PSSS\n");
+      goto clean_exit;
+    }
+    if (srsran_ssss_init(&q->ssss, cell_sl.nof_prb, cell_sl.cp, cell_sl.tm) != SRSRAN_SUCCESS) {
+      ERROR("Error initiating SSSS\n");
+      goto clean_exit;
+    }
+    if (srsran_psbch_init(&q->psbch, cell_sl.nof_prb, cell_sl.N_sl_id, cell_sl.tm, cell_sl.cp) != SRSRAN_SUCCESS) {
+      ERROR("Error initiating PSBCH\n");
+      goto clean_exit;
+    }
+
+    srsran_sl_comm_resource_pool_t sl_comm_resource_pool;
+    if (srsran_sl_comm_resource_pool_get_default_config(&sl_comm_resource_pool, cell_sl) != SRSRAN_SUCCESS) {
+      ERROR("Error initializing sl_comm_resource_pool\n");
+      goto clean_exit;
+    }
+    if (srsran_chest_sl_init(&q->psbch_chest, SRSRAN_SIDELINK_PSBCH, cell_sl, sl_comm_resource_pool) !=
+        SRSRAN_SUCCESS) {
+      ERROR("Error initiating PSBCH channel estimator\n");
+      goto clean_exit;
+    }
+
+    uint32_t sf_n_re   = SRSRAN_SF_LEN_RE(cell_sl.nof_prb, cell_sl.cp);
+    q->slss_sf_time    = srsran_vec_cf_malloc(q->sf_len);
+    q->slss_sf_symbols = srsran_vec_cf_malloc(sf_n_re);
+    q->slss_equalized  = srsran_vec_cf_malloc(sf_n_re);
+    if (!q->slss_sf_time || !q->slss_sf_symbols || !q->slss_equalized) {
+      ERROR("Error allocating SLSS buffers\n");
+      goto clean_exit;
+    }
+
+    if (srsran_ofdm_rx_init(&q->slss_fft, cell_sl.cp, q->slss_sf_time, q->slss_sf_symbols, cell_sl.nof_prb)) {
+      ERROR("Error creating FFT object\n");
+      goto clean_exit;
+    }
+    srsran_ofdm_set_normalize(&q->slss_fft, true);
+    srsran_ofdm_set_freq_shift(&q->slss_fft, -0.5);
+
+    q->slss_is_init    = true;
+    q->slss_find_cnt   = 0;
+    q->slss_find_usec  = 0;
+    q->slss_track_cnt  = 0;
+    q->slss_track_usec = 0;
+
+    srsran_ue_sync_reset(q);
+
+    ret = SRSRAN_SUCCESS;
+  }
+
+clean_exit:
+  if (ret == SRSRAN_ERROR) {
+    q->slss_is_init = true;
+    ue_sync_slss_free(q);
+  }
+  return ret;
+}
+
 void srsran_ue_sync_set_nof_find_frames(srsran_ue_sync_t* q, uint32_t nof_frames)
 {
   q->nof_avg_find_frames = nof_frames;
@@ -556,6 +673,16 @@ void srsran_ue_sync_set_N_id_2(srsran_ue_sync_t* q, uint32_t N_id_2)
   }
 }
 
+/** In GNSS mode, the receiver aligns to the next second boundary. If the radio is able to start streaming at a
+ * given time, this callback is used to do so instead of receiving and discarding the samples up to the boundary.
+ * The callback shall return SRSRAN_SUCCESS if the stream will start at the requested timestamp.
+ */
+void srsran_ue_sync_set_start_rx_timed_callback(srsran_ue_sync_t* q,
+                                                int (*start_rx_timed_callback)(void*, srsran_timestamp_t*))
+{
+  q->start_rx_timed_callback = start_rx_timed_callback;
+}
+
 void srsran_ue_sync_set_agc_period(srsran_ue_sync_t* q, uint32_t period)
 {
   q->agc_period = period;
@@ -793,6 +920,8 @@ int srsran_ue_sync_zerocopy(srsran_ue_sync_t* q,
             ret = srsran_ue_sync_run_find_pss_mode(q, input_buffer);
           } else if (q->mode == SYNC_MODE_GNSS) {
             ret = srsran_ue_sync_run_find_gnss_mode(q, input_buffer, max_num_samples);
+          } else if (q->mode == SYNC_MODE_SLSS) {
+            ret = srsran_ue_sync_run_find_slss_mode(q, input_buffer);
           }
 
           if (q->do_agc) {
@@ -822,6 +951,8 @@ int srsran_ue_sync_zerocopy(srsran_ue_sync_t* q,
 
           if (q->mode == SYNC_MODE_PSS) {
             srsran_ue_sync_run_track_pss_mode(q, input_buffer);
+          } else if (q->mode == SYNC_MODE_SLSS) {
+            ret = srsran_ue_sync_run_track_slss_mode(q, input_buffer);
           } else {
             srsran_ue_sync_run_track_gnss_mode(q, input_buffer);
           }
@@ -933,56 +1064,87 @@ int srsran_ue_sync_run_track_pss_mode(srsran_ue_sync_t* q, cf_t* input_buffer[SR
   return 1; ///< 1 means subframe in sync
 }
 
-int srsran_ue_sync_run_find_gnss_mode(srsran_ue_sync_t* q,
-                                      cf_t*             input_buffer[SRSRAN_MAX_CHANNELS],
-                                      const uint32_t    max_num_samples)
+/* Asks the radio to start streaming at ts_next_rx. Returns true if the next reception starts at that time. */
+static bool gnss_align_timed_start(srsran_ue_sync_t* q, srsran_timestamp_t* ts_next_rx)
 {
-  INFO("Calibration samples received start at %ld + %f\n", q->last_timestamp.full_secs, q->last_timestamp.frac_secs);
-
-  // round to nearest second
-  srsran_timestamp_t ts_next_rx, ts_next_rx_tmp, ts_tmp;
-  srsran_timestamp_copy(&ts_next_rx, &q->last_timestamp);
-  ts_next_rx.full_secs++;
-  ts_next_rx.frac_secs = 0.0;
-
-  srsran_timestamp_copy(&ts_next_rx_tmp, &ts_next_rx);
+  if (q->start_rx_timed_callback == NULL) {
+    return false;
+  }
+  if (q->start_rx_timed_callback(q->stream, ts_next_rx) != SRSRAN_SUCCESS) {
+    INFO("Timed Rx start not available, discarding samples instead\n");
+    return false;
+  }
+  return true;
+}
 
-  INFO("Next desired recv at %ld + %f\n", ts_next_rx_tmp.full_secs, ts_next_rx_tmp.frac_secs);
+/* Receives and discards samples until the next reception starts roughly at ts_next_rx */
+static uint64_t gnss_align_discard(srsran_ue_sync_t* q, srsran_timestamp_t* ts_next_rx)
+{
+  srsran_timestamp_t ts_tmp;
+  uint64_t           nof_samples = 0;
 
   // get difference in time between second rx and now
-  srsran_timestamp_sub(&ts_next_rx_tmp, q->last_timestamp.full_secs, q->last_timestamp.frac_secs);
-  srsran_timestamp_sub(&ts_next_rx_tmp, 0, 0.001); ///< account for samples that have already been rx'ed
+  srsran_timestamp_copy(&ts_tmp, ts_next_rx);
+  srsran_timestamp_sub(&ts_tmp, q->last_timestamp.full_secs, q->last_timestamp.frac_secs);
+  srsran_timestamp_sub(&ts_tmp, 0, 0.001); ///< account for samples that have already been rx'ed
 
-  uint64_t align_len = srsran_timestamp_uint64(&ts_next_rx_tmp, q->sf_len * 1000);
+  uint64_t align_len = srsran_timestamp_uint64(&ts_tmp, q->sf_len * 1000);
 
   DEBUG("Difference between first recv is %ld + %f, realigning %" PRIu64 " samples\n",
-        ts_next_rx_tmp.full_secs,
-        ts_next_rx_tmp.frac_secs,
+        ts_tmp.full_secs,
+        ts_tmp.frac_secs,
         align_len);
 
   // receive align_len samples into dummy_buffer, make sure to not exceed buffer len
-  uint32_t sample_count = 0;
   while (align_len > q->sf_len) {
     uint32_t actual_rx_len = SRSRAN_MIN(align_len, q->sf_len);
     actual_rx_len          = SRSRAN_MIN(align_len, actual_rx_len);
     q->recv_callback(q->stream, dummy_offset_buffer, actual_rx_len, &q->last_timestamp);
+    nof_samples += actual_rx_len;
 
-    srsran_timestamp_copy(&ts_tmp, &ts_next_rx);
+    srsran_timestamp_copy(&ts_tmp, ts_next_rx);
     srsran_timestamp_sub(&ts_tmp, q->last_timestamp.full_secs, q->last_timestamp.frac_secs);
     srsran_timestamp_sub(&ts_tmp, 0, 0.001); ///< account for samples that have already been rx'ed
     align_len = srsran_timestamp_uint64(&ts_tmp, q->sf_len * 1000);
 
     if (align_len > q->sf_len * 1000) {
-      ts_next_rx.full_secs++;
-      ts_next_rx.frac_secs = 0.0;
-      srsran_timestamp_copy(&ts_tmp, &ts_next_rx);
+      ts_next_rx->full_secs++;
+      ts_next_rx->frac_secs = 0.0;
+      srsran_timestamp_copy(&ts_tmp, ts_next_rx);
       srsran_timestamp_sub(&ts_tmp, q->last_timestamp.full_secs, q->last_timestamp.frac_secs);
       srsran_timestamp_sub(&ts_tmp, 0, 0.001); ///< account for samples that have already been rx'ed
       align_len = srsran_timestamp_uint64(&ts_tmp, q->sf_len * 1000);
     }
   }
 
-  DEBUG("Received %d samples during alignment\n", sample_count);
+  return nof_samples;
+}
+
+int srsran_ue_sync_run_find_gnss_mode(srsran_ue_sync_t* q,
+                                      cf_t*             input_buffer[SRSRAN_MAX_CHANNELS],
+                                      const uint32_t    max_num_samples)
+{
+  INFO("Calibration samples received start at %ld + %f\n", q->last_timestamp.full_secs, q->last_timestamp.frac_secs);
+
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+
+  // round to nearest second
+  srsran_timestamp_t ts_next_rx;
+  srsran_timestamp_copy(&ts_next_rx, &q->last_timestamp);
+  ts_next_rx.full_secs++;
+  ts_next_rx.frac_secs = 0.0;
+
+  INFO("Next desired recv at %ld + %f\n", ts_next_rx.full_secs, ts_next_rx.frac_secs);
+
+  // Start streaming at the second boundary if the radio supports it, otherwise discard samples until then
+  q->gnss_align_nof_samples = 0;
+  if (!gnss_align_timed_start(q, &ts_next_rx)) {
+    q->gnss_align_nof_samples = gnss_align_discard(q, &ts_next_rx);
+  }
+  q->next_rf_sample_offset = 0;
+
+  DEBUG("Received %" PRIu64 " samples during alignment\n", q->gnss_align_nof_samples);
 
   // do one normal receive, the first time-aligned subframe
   if (receive_samples(q, input_buffer, max_num_samples)) {
@@ -990,7 +1152,14 @@ int srsran_ue_sync_run_find_gnss_mode(srsran_ue_sync_t* q,
     return SRSRAN_ERROR;
   }
 
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  q->gnss_align_usec = t[0].tv_sec * 1000000 + t[0].tv_usec;
+
   INFO("First aligned samples received start at %ld + %f\n", q->last_timestamp.full_secs, q->last_timestamp.frac_secs);
+  INFO("GNSS alignment took %" PRIu64 " us, %" PRIu64 " samples discarded\n",
+       q->gnss_align_usec,
+       q->gnss_align_nof_samples);
 
   // switch to track state, from here on, samples should be ms aligned
   q->state = SF_TRACK;
@@ -1048,18 +1217,187 @@ int srsran_ue_sync_run_track_gnss_mode(srsran_ue_sync_t* q, cf_t* input_buffer[S
   return 1; ///< 1 means subframe in sync
 }
 
-/** Calculate TTI for UEs that are synced using GNSS time reference (TS 36.331 Sec. 5.10.14)
- *
- * @param q Pointer to current object
- * @param rx_timestamp Pointer to receive timestamp
- * @return SRSRAN_SUCCESS on success
+/** Full SLSS search (PSSS, SSSS and PSBCH) over the received subframe.
+ * When a PSSS is found, the buffer is realigned to the start of the subframe carrying the SLSS and completed with
+ * new samples. The SLSS is accepted once the MIB-SL is decoded, which sets the direct frame and subframe numbers.
  */
-int srsran_ue_sync_set_tti_from_timestamp(srsran_ue_sync_t* q, srsran_timestamp_t* rx_timestamp)
+int srsran_ue_sync_run_find_slss_mode(srsran_ue_sync_t* q, cf_t* input_buffer[SRSRAN_MAX_CHANNELS])
 {
-  // calculate time_t of Rx time
-  time_t t_cur = rx_timestamp->full_secs;
-  DEBUG("t_cur=%ld\n", t_cur);
+  int            ret = 0;
+  struct timeval t[3];
+
+  gettimeofday(&t[1], NULL);
+
+  q->next_rf_sample_offset = 0;
+
+  if (srsran_psss_find(&q->psss, input_buffer[0], q->cell_sl.nof_prb, q->cell_sl.cp) != SRSRAN_SUCCESS) {
+    /* A PSSS whose subframe starts slightly before the buffer is not detected. If no SLSS is found during a whole
+     * period, discard half a subframe to look at it with a different alignment */
+    q->slss_miss_cnt++;
+    if (q->slss_miss_cnt > SRSRAN_SL_V2X_SLSS_PERIOD) {
+      INFO("No SLSS found in %d subframes. Realigning frame...\n", q->slss_miss_cnt);
+      if (q->recv_callback(q->stream, dummy_offset_buffer, q->sf_len / 2, NULL) < 0) {
+        ERROR("Error receiving samples\n");
+        return SRSRAN_ERROR;
+      }
+      q->slss_miss_cnt = 0;
+    }
+    goto exit;
+  }
+  q->slss_miss_cnt = 0;
+
+  // The subframe carrying the PSSS starts at corr_peak_pos - sf_len
+  uint32_t sf_start = (uint32_t)q->psss.corr_peak_pos - q->sf_len;
+  if (sf_start > 0) {
+    cf_t* ptr[SRSRAN_MAX_CHANNELS] = {NULL};
+    for (int i = 0; i < q->nof_rx_antennas; i++) {
+      memmove(input_buffer[i], &input_buffer[i][sf_start], sizeof(cf_t) * (q->sf_len - sf_start));
+      ptr[i] = &input_buffer[i][q->sf_len - sf_start];
+    }
+    if (q->recv_callback(q->stream, ptr, sf_start, NULL) < 0) {
+      ERROR("Error receiving samples\n");
+      return SRSRAN_ERROR;
+    }
+    srsran_timestamp_add(&q->last_timestamp, 0, (double)sf_start / (q->sf_len * 1000.0));
+  }
+
+  if (srsran_ssss_find(&q->ssss, input_buffer[0], q->cell_sl.nof_prb, q->psss.N_id_2, q->cell_sl.cp) !=
+      SRSRAN_SUCCESS) {
+    goto exit;
+  }
+
+  if (q->ssss.N_sl_id != q->cell_sl.N_sl_id) {
+    q->cell_sl.N_sl_id = q->ssss.N_sl_id;
+    if (srsran_psbch_reset(&q->psbch, q->cell_sl.N_sl_id) != SRSRAN_SUCCESS) {
+      ERROR("Error setting N_sl_id for PSBCH\n");
+      goto exit;
+    }
+    if (srsran_chest_sl_set_cell(&q->psbch_chest, q->cell_sl) != SRSRAN_SUCCESS) {
+      ERROR("Error setting cell for PSBCH channel estimator\n");
+      goto exit;
+    }
+  }
+
+  // Demodulate on a copy, the input buffer is returned untouched
+  srsran_vec_cf_copy(q->slss_sf_time, input_buffer[0], q->sf_len);
+  srsran_ofdm_rx_sf(&q->slss_fft);
+  srsran_chest_sl_ls_estimate_equalize(&q->psbch_chest, q->slss_sf_symbols, q->slss_equalized);
+
+  uint8_t mib_sl_rx[SRSRAN_MIB_SL_MAX_LEN] = {};
+  if (srsran_psbch_decode(&q->psbch, q->slss_equalized, mib_sl_rx, sizeof(mib_sl_rx)) != SRSRAN_SUCCESS) {
+    INFO("SYNC FIND: SLSS N_sl_id=%d found but PSBCH not decoded\n", q->cell_sl.N_sl_id);
+    goto exit;
+  }
+
+  srsran_mib_sl_t mib_sl;
+  srsran_mib_sl_init(&mib_sl, q->cell_sl.tm);
+  srsran_mib_sl_unpack(&mib_sl, mib_sl_rx);
 
+  q->frame_number  = mib_sl.direct_frame_number_r12 % 1024;
+  q->sf_idx        = mib_sl.direct_subframe_number_r12 % SRSRAN_NOF_SF_X_FRAME;
+  q->slss_sf_cnt   = 0;
+  q->slss_lost_cnt = 0;
+  q->state         = SF_TRACK;
+
+  srsran_mib_sl_free(&mib_sl);
+
+  ret = 1;
+
+exit:
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  q->slss_find_cnt++;
+  q->slss_find_usec += t[0].tv_sec * 1000000 + t[0].tv_usec;
+
+  INFO("SYNC FIND: N_sl_id=%d, sfn=%d, sf_idx=%d, peak_pos=%d, peak_value=%.2f, ret=%d\n",
+       q->cell_sl.N_sl_id,
+       q->frame_number,
+       q->sf_idx,
+       q->psss.corr_peak_pos,
+       q->psss.corr_peak_value,
+       ret);
+
+  return ret;
+}
+
+/** SLSS tracking. Every SRSRAN_SL_V2X_SLSS_PERIOD subframes the known PSSS is correlated in time domain within
+ * +/- slss_track_max_offset samples of its expected position and the sampling time is corrected. Other subframes
+ * are passed through without any processing.
+ */
+int srsran_ue_sync_run_track_slss_mode(srsran_ue_sync_t* q, cf_t* input_buffer[SRSRAN_MAX_CHANNELS])
+{
+  // A negative offset has been applied by the last reception
+  if (q->next_rf_sample_offset) {
+    q->next_rf_sample_offset = 0;
+  }
+
+  q->slss_sf_cnt++;
+  if (q->slss_sf_cnt < SRSRAN_SL_V2X_SLSS_PERIOD) {
+    return 1;
+  }
+  q->slss_sf_cnt = 0;
+
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+
+  int n = srsran_psss_track(&q->psss, input_buffer[0], q->psss.N_id_2, q->slss_track_max_offset);
+
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  q->slss_track_cnt++;
+  q->slss_track_usec += t[0].tv_sec * 1000000 + t[0].tv_usec;
+
+  if (n != SRSRAN_SUCCESS) {
+    q->slss_lost_cnt++;
+    INFO("SYNC TRACK: SLSS not found (value=%.2f), %d lost\n", q->psss.corr_peak_value, q->slss_lost_cnt);
+    if (q->slss_lost_cnt >= DEFAULT_SLSS_TRACK_MAX_LOST) {
+      INFO("%d SLSS lost. Going back to FIND\n", q->slss_lost_cnt);
+      q->state = SF_FIND;
+      return 0;
+    }
+    return 1;
+  }
+
+  q->slss_lost_cnt      = 0;
+  q->last_sample_offset = q->psss.corr_peak_pos;
+
+  if (q->last_sample_offset > 0) {
+    // We sample too slowly, discard the offset samples to align the next subframe
+    if (q->recv_callback(q->stream, dummy_offset_buffer, (uint32_t)q->last_sample_offset, NULL) < 0) {
+      ERROR("Error receiving samples\n");
+      return SRSRAN_ERROR;
+    }
+  } else if (q->last_sample_offset < 0) {
+    // We sample too fast, the next reception is shortened
+    q->next_rf_sample_offset = q->last_sample_offset;
+  }
+
+  INFO("SYNC TRACK: sfn=%d, sf_idx=%d, offset=%d, value=%.2f\n",
+       q->frame_number,
+       q->sf_idx,
+       q->last_sample_offset,
+       q->psss.corr_peak_value);
+
+  return 1;
+}
+
+/** Prints the computational cost of SLSS acquisition and tracking */
+void srsran_ue_sync_slss_fprint_stats(FILE* f, srsran_ue_sync_t* q)
+{
+  float find_avg  = q->slss_find_cnt ? (float)q->slss_find_usec / q->slss_find_cnt : 0.0f;
+  float track_avg = q->slss_track_cnt ? (float)q->slss_track_usec / q->slss_track_cnt : 0.0f;
+
+  fprintf(f,
+          "SLSS sync: find=%" PRIu64 " (%.1f us avg), track=%" PRIu64 " (%.1f us avg, window=%d samples)\n",
+          q->slss_find_cnt,
+          find_avg,
+          q->slss_track_cnt,
+          track_avg,
+          2 * q->slss_track_max_offset + 1);
+}
+
+uint32_t srsran_ue_sync_gnss_dfn_sf(const srsran_timestamp_t* t, uint32_t sfn_offset)
+{
   // 3GPP Reference UTC time is 1. Jan 1900 at 0:00
   // If we put this date in https://www.epochconverter.com it returns a negative number (-2208988800)
   // as epoch time starts at 1. Jan 1970 at 0:00
@@ -1067,15 +1405,29 @@ int srsran_ue_sync_set_tti_from_timestamp(srsran_ue_sync_t* q, srsran_timestamp_
 
   static const uint32_t MSECS_PER_SEC = 1000;
 
-  uint64_t time_3gpp_secs = t_cur + epoch_offset_3gpp;
+  uint64_t time_3gpp_secs = t->full_secs + epoch_offset_3gpp;
 
-  // convert to ms and add fractional part
-  uint64_t time_3gpp_msecs = (time_3gpp_secs + rx_timestamp->frac_secs) * MSECS_PER_SEC;
+  // convert to ms and add fractional part, a time on a subframe boundary may be off by rounding errors
+  uint64_t time_3gpp_msecs = time_3gpp_secs * MSECS_PER_SEC + (uint64_t)floor(t->frac_secs * MSECS_PER_SEC + 1e-6);
   DEBUG("rx time with 3gpp base in ms %lu\n", time_3gpp_msecs);
 
+  return (uint32_t)((time_3gpp_msecs - sfn_offset) % SRSRAN_SL_DFN_PERIOD);
+}
+
+/** Calculate TTI for UEs that are synced using GNSS time reference (TS 36.331 Sec. 5.10.14)
+ *
+ * @param q Pointer to current object
+ * @param rx_timestamp Pointer to receive timestamp
+ * @return SRSRAN_SUCCESS on success
+ */
+int srsran_ue_sync_set_tti_from_timestamp(srsran_ue_sync_t* q, srsran_timestamp_t* rx_timestamp)
+{
+  DEBUG("t_cur=%ld\n", rx_timestamp->full_secs);
+
   // calculate SFN and SF index according to TS 36.331 Sec. 5.10.14
-  q->frame_number = (uint32_t)(((uint64_t)floor(0.1 * (time_3gpp_msecs - q->sfn_offset))) % 1024);
-  q->sf_idx       = (uint32_t)(((uint64_t)floor(time_3gpp_msecs - q->sfn_offset)) % 10);
+  uint32_t dfn_sf = srsran_ue_sync_gnss_dfn_sf(rx_timestamp, q->sfn_offset);
+  q->frame_number = dfn_sf / SRSRAN_NOF_SF_X_FRAME;
+  q->sf_idx       = dfn_sf % SRSRAN_NOF_SF_X_FRAME;
 
   return SRSRAN_SUCCESS;
 }
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/sl_prof.h"
+#include "srsran/phy/utils/vector.h"
+
+typedef struct {
+  uint64_t bins[SRSRAN_SL_PROF_NOF_BINS];
+  uint64_t max_ns;
+} sl_prof_hist_t;
+
+static const char* stage_names[SRSRAN_SL_PROF_NOF_STAGES] = {"rx_fft",
+                                                             "rx_pscch_chest",
+                                                             "rx_pscch_decode",
+                                                             "rx_pssch_chest",
+                                                             "rx_pssch_demod",
+                                                             "rx_pssch_turbo",
+                                                             "rx_log",
+                                                             "rx_subframe",
+                                                             "tx_pscch_encode",
+                                                             "tx_pssch_encode",
+                                                             "tx_ifft",
+                                                             "tx_send",
+                                                             "tx_log"};
+
+// Written by the measured threads
+static sl_prof_hist_t hist[SRSRAN_SL_PROF_NOF_STAGES];
+static uint64_t       late;
+
+// Owned by the thread taking the snapshots
+static uint64_t                   hist_prev[SRSRAN_SL_PROF_NOF_STAGES][SRSRAN_SL_PROF_NOF_BINS];
+static uint64_t                   late_prev;
+static uint64_t                   snapshot_prev_ns;
+static int                        publish_fd = -1;
+static srsran_sl_prof_snapshot_t* publish_page;
+
+/* Bins 0 to 3 hold 0 to 3 ns, above that each octave [2^e, 2^(e+1)) is split in 4 */
+static inline uint32_t sl_prof_bin(uint64_t v)
+{
+  if (v < 4) {
+    return (uint32_t)v;
+  }
+  uint32_t e   = 63 - __builtin_clzll(v);
+  uint32_t bin = 4 * (e - 1) + ((v >> (e - 2)) & 3);
+  return bin < SRSRAN_SL_PROF_NOF_BINS ? bin : SRSRAN_SL_PROF_NOF_BINS - 1;
+}
+
+/* First value above the bin */
+static uint64_t sl_prof_bin_upper(uint32_t bin)
+{
+  if (bin < 3) {
+    return bin + 1;
+  }
+  uint32_t next = bin + 1;
+  uint32_t e    = next / 4 + 1;
+  return (uint64_t)(4 + next % 4) << (e - 2);
+}
+
+const char* srsran_sl_prof_stage_name(srsran_sl_prof_stage_t stage)
+{
+  return stage < SRSRAN_SL_PROF_NOF_STAGES ? stage_names[stage] : "unknown";
+}
+
+void srsran_sl_prof_add(srsran_sl_prof_stage_t stage, uint64_t duration_ns)
+{
+  if (stage >= SRSRAN_SL_PROF_NOF_STAGES) {
+    return;
+  }
+  sl_prof_hist_t* h = &hist[stage];
+  __atomic_fetch_add(&h->bins[sl_prof_bin(duration_ns)], 1, __ATOMIC_RELAXED);
+
+  uint64_t max = __atomic_load_n(&h->max_ns, __ATOMIC_RELAXED);
+  while (duration_ns > max &&
+         !__atomic_compare_exchange_n(&h->max_ns, &max, duration_ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+void srsran_sl_prof_add_late()
+{
+  __atomic_fetch_add(&late, 1, __ATOMIC_RELAXED);
+}
+
+static uint64_t sl_prof_percentile(const uint64_t* bins, uint64_t count, double p)
+{
+  uint64_t rank = (uint64_t)(p * (double)count + 0.5);
+  rank          = rank < 1 ? 1 : rank;
+  uint64_t acc  = 0;
+  for (uint32_t b = 0; b < SRSRAN_SL_PROF_NOF_BINS; b++) {
+    acc += bins[b];
+    if (acc >= rank) {
+      return sl_prof_bin_upper(b);
+    }
+  }
+  return 0;
+}
+
+void srsran_sl_prof_snapshot(srsran_sl_prof_snapshot_t* s)
+{
+  if (s == NULL) {
+    return;
+  }
+  bzero(s, sizeof(srsran_sl_prof_snapshot_t));
+
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  uint64_t now_ns  = srsran_sl_prof_now_ns();
+  s->magic         = SRSRAN_SL_PROF_MAGIC;
+  s->version       = SRSRAN_SL_PROF_VERSION;
+  s->nof_stages    = SRSRAN_SL_PROF_NOF_STAGES;
+  s->timestamp_us  = (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+  s->period_us     = snapshot_prev_ns ? (now_ns - snapshot_prev_ns) / 1000 : 0;
+  snapshot_prev_ns = now_ns;
+
+  s->total_late = __atomic_load_n(&late, __ATOMIC_RELAXED);
+  s->late       = s->total_late - late_prev;
+  late_prev     = s->total_late;
+
+  for (uint32_t i = 0; i < SRSRAN_SL_PROF_NOF_STAGES; i++) {
+    uint64_t bins[SRSRAN_SL_PROF_NOF_BINS];
+    for (uint32_t b = 0; b < SRSRAN_SL_PROF_NOF_BINS; b++) {
+      uint64_t total  = __atomic_load_n(&hist[i].bins[b], __ATOMIC_RELAXED);
+      bins[b]         = total - hist_prev[i][b];
+      hist_prev[i][b] = total;
+      s->stage[i].count += bins[b];
+      s->stage[i].total_count += total;
+    }
+    // The bin edges can overshoot the largest measurement
+    s->stage[i].max_ns = __atomic_exchange_n(&hist[i].max_ns, 0, __ATOMIC_RELAXED);
+    s->stage[i].p50_ns = SRSRAN_MIN(sl_prof_percentile(bins, s->stage[i].count, 0.50), s->stage[i].max_ns);
+    s->stage[i].p99_ns = SRSRAN_MIN(sl_prof_percentile(bins, s->stage[i].count, 0.99), s->stage[i].max_ns);
+  }
+}
+
+int srsran_sl_prof_publish_init(const char* path)
+{
+  if (path == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  srsran_sl_prof_publish_free();
+
+  publish_fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (publish_fd < 0) {
+    perror("open");
+    return SRSRAN_ERROR;
+  }
+  if (ftruncate(publish_fd, sizeof(srsran_sl_prof_snapshot_t)) < 0) {
+    perror("ftruncate");
+    srsran_sl_prof_publish_free();
+    return SRSRAN_ERROR;
+  }
+  void* map = mmap(NULL, sizeof(srsran_sl_prof_snapshot_t), PROT_READ | PROT_WRITE, MAP_SHARED, publish_fd, 0);
+  if (map == MAP_FAILED) {
+    perror("mmap");
+    srsran_sl_prof_publish_free();
+    return SRSRAN_ERROR;
+  }
+  publish_page = (srsran_sl_prof_snapshot_t*)map;
+
+  // Starts the first period
+  srsran_sl_prof_snapshot_t s;
+  srsran_sl_prof_snapshot(&s);
+  return SRSRAN_SUCCESS;
+}
+
+void srsran_sl_prof_publish()
+{
+  srsran_sl_prof_snapshot_t s;
+  srsran_sl_prof_snapshot(&s);
+  if (publish_page == NULL) {
+    return;
+  }
+
+  uint64_t seq = __atomic_load_n(&publish_page->seq, __ATOMIC_RELAXED);
+  __atomic_store_n(&publish_page->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  s.seq = seq + 1;
+  memcpy(publish_page, &s, sizeof(srsran_sl_prof_snapshot_t));
+  __atomic_store_n(&publish_page->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void srsran_sl_prof_publish_free()
+{
+  if (publish_page) {
+    munmap(publish_page, sizeof(srsran_sl_prof_snapshot_t));
+    publish_page = NULL;
+  }
+  if (publish_fd >= 0) {
+    close(publish_fd);
+    publish_fd = -1;
+  }
+}
+
+int srsran_sl_prof_reader_init(srsran_sl_prof_reader_t* q, const char* path)
+{
+  if (q == NULL || path == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  bzero(q, sizeof(srsran_sl_prof_reader_t));
+
+  q->fd = open(path, O_RDONLY);
+  if (q->fd < 0) {
+    perror("open");
+    return SRSRAN_ERROR;
+  }
+  struct stat st = {};
+  if (fstat(q->fd, &st) < 0 || (size_t)st.st_size < sizeof(srsran_sl_prof_snapshot_t)) {
+    ERROR("%s is not a sidelink latency page\n", path);
+    srsran_sl_prof_reader_free(q);
+    return SRSRAN_ERROR;
+  }
+  void* map = mmap(NULL, sizeof(srsran_sl_prof_snapshot_t), PROT_READ, MAP_SHARED, q->fd, 0);
+  if (map == MAP_FAILED) {
+    perror("mmap");
+    srsran_sl_prof_reader_free(q);
+    return SRSRAN_ERROR;
+  }
+  q->page = (const srsran_sl_prof_snapshot_t*)map;
+  return SRSRAN_SUCCESS;
+}
+
+int srsran_sl_prof_reader_read(srsran_sl_prof_reader_t* q, srsran_sl_prof_snapshot_t* s)
+{
+  if (q == NULL || q->page == NULL || s == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  // The page is rewritten about once a second, a copy rarely needs a second try
+  while (true) {
+    uint64_t seq = __atomic_load_n(&q->page->seq, __ATOMIC_ACQUIRE);
+    if (seq & 1) {
+      continue;
+    }
+    memcpy(s, q->page, sizeof(srsran_sl_prof_snapshot_t));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&q->page->seq, __ATOMIC_RELAXED) == seq) {
+      s->seq = seq;
+      break;
+    }
+  }
+
+  if (s->seq == 0) {
+    return 0; // Nothing published yet
+  }
+  if (s->magic != SRSRAN_SL_PROF_MAGIC || s->version != SRSRAN_SL_PROF_VERSION ||
+      s->nof_stages != SRSRAN_SL_PROF_NOF_STAGES) {
+    ERROR("Unsupported sidelink latency page\n");
+    return SRSRAN_ERROR;
+  }
+  return 1;
+}
+
+void srsran_sl_prof_reader_free(srsran_sl_prof_reader_t* q)
+{
+  if (q == NULL) {
+    return;
+  }
+  if (q->page) {
+    munmap((void*)q->page, sizeof(srsran_sl_prof_snapshot_t));
+  }
+  if (q->fd > 0) {
+    close(q->fd);
+  }
+  bzero(q, sizeof(srsran_sl_prof_reader_t));
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "srsran/srsran.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+#define NOF_THREADS 4
+
+static char*    page_path         = "sl_prof_test.page";
+static uint32_t nof_thread_events = 1000000;
+
+/* Percentiles are reported as the upper edge of their bin, capped to the maximum */
+static bool within_bin(uint64_t reported, uint64_t exact)
+{
+  return reported >= exact && reported <= exact + exact / 4 + 1;
+}
+
+static int test_percentiles()
+{
+  srsran_sl_prof_snapshot_t s;
+  srsran_sl_prof_snapshot(&s);
+
+  // 1 us to 100 us uniformly, and one outlier
+  for (uint64_t v = 1; v <= 100; v++) {
+    srsran_sl_prof_add(SRSRAN_SL_PROF_RX_FFT, v * 1000);
+  }
+  srsran_sl_prof_add(SRSRAN_SL_PROF_RX_FFT, 5000000);
+  srsran_sl_prof_add_late();
+
+  srsran_sl_prof_snapshot(&s);
+  const srsran_sl_prof_stats_t* fft = &s.stage[SRSRAN_SL_PROF_RX_FFT];
+  TESTASSERT(fft->count == 101);
+  TESTASSERT(fft->total_count == 101);
+  TESTASSERT(within_bin(fft->p50_ns, 51000));
+  TESTASSERT(within_bin(fft->p99_ns, 100000));
+  TESTASSERT(fft->max_ns == 5000000);
+  TESTASSERT(s.stage[SRSRAN_SL_PROF_RX_PSSCH_TURBO].count == 0);
+  TESTASSERT(s.late == 1 && s.total_late == 1);
+
+  // Each snapshot covers the measurements since the previous one
+  srsran_sl_prof_add(SRSRAN_SL_PROF_RX_FFT, 3000);
+  srsran_sl_prof_snapshot(&s);
+  TESTASSERT(fft->count == 1);
+  TESTASSERT(fft->total_count == 102);
+  TESTASSERT(within_bin(fft->p50_ns, 3000));
+  TESTASSERT(fft->max_ns == 3000);
+  TESTASSERT(s.late == 0 && s.total_late == 1);
+
+  // Tiny and huge values land in the first and last bins
+  srsran_sl_prof_add(SRSRAN_SL_PROF_TX_LOG, 0);
+  srsran_sl_prof_add(SRSRAN_SL_PROF_TX_LOG, UINT64_MAX);
+  srsran_sl_prof_add(SRSRAN_SL_PROF_NOF_STAGES, 1000);
+  srsran_sl_prof_snapshot(&s);
+  TESTASSERT(s.stage[SRSRAN_SL_PROF_TX_LOG].count == 2);
+  TESTASSERT(s.stage[SRSRAN_SL_PROF_TX_LOG].p50_ns == 1);
+  TESTASSERT(s.stage[SRSRAN_SL_PROF_TX_LOG].max_ns == UINT64_MAX);
+  return SRSRAN_SUCCESS;
+}
+
+static void* record_thread(void* arg)
+{
+  uint64_t id = (uint64_t)(uintptr_t)arg;
+  for (uint32_t i = 0; i < nof_thread_events; i++) {
+    srsran_sl_prof_add(SRSRAN_SL_PROF_RX_PSSCH_TURBO, 1000 + (i % 1000) * 10 + id);
+  }
+  return NULL;
+}
+
+/* No measurement is lost while several threads record into the same stage */
+static int test_threads()
+{
+  srsran_sl_prof_snapshot_t s;
+  srsran_sl_prof_snapshot(&s);
+
+  pthread_t threads[NOF_THREADS];
+  for (uint64_t t = 0; t < NOF_THREADS; t++) {
+    TESTASSERT(pthread_create(&threads[t], NULL, record_thread, (void*)(uintptr_t)t) == 0);
+  }
+  for (uint32_t t = 0; t < NOF_THREADS; t++) {
+    pthread_join(threads[t], NULL);
+  }
+
+  srsran_sl_prof_snapshot(&s);
+  TESTASSERT(s.stage[SRSRAN_SL_PROF_RX_PSSCH_TURBO].count == (uint64_t)NOF_THREADS * nof_thread_events);
+  TESTASSERT(s.stage[SRSRAN_SL_PROF_RX_PSSCH_TURBO].max_ns == 1000 + 999 * 10 + NOF_THREADS - 1);
+  return SRSRAN_SUCCESS;
+}
+
+static int test_publish()
+{
+  srsran_sl_prof_reader_t   reader = {};
+  srsran_sl_prof_snapshot_t s;
+
+  TESTASSERT(srsran_sl_prof_publish_init(page_path) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_sl_prof_reader_init(&reader, page_path) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_sl_prof_reader_read(&reader, &s) == 0);
+
+  srsran_sl_prof_add(SRSRAN_SL_PROF_TX_SEND, 20000);
+  srsran_sl_prof_add(SRSRAN_SL_PROF_TX_SEND, 40000);
+  srsran_sl_prof_publish();
+  TESTASSERT(srsran_sl_prof_reader_read(&reader, &s) == 1);
+  TESTASSERT(s.seq == 2);
+  TESTASSERT(s.stage[SRSRAN_SL_PROF_TX_SEND].count == 2);
+  TESTASSERT(s.stage[SRSRAN_SL_PROF_TX_SEND].max_ns == 40000);
+  TESTASSERT(within_bin(s.stage[SRSRAN_SL_PROF_TX_SEND].p50_ns, 20000));
+
+  srsran_sl_prof_publish();
+  TESTASSERT(srsran_sl_prof_reader_read(&reader, &s) == 1);
+  TESTASSERT(s.seq == 4);
+  TESTASSERT(s.stage[SRSRAN_SL_PROF_TX_SEND].count == 0);
+  TESTASSERT(s.stage[SRSRAN_SL_PROF_TX_SEND].total_count == 2);
+
+  srsran_sl_prof_reader_free(&reader);
+  srsran_sl_prof_publish_free();
+  return SRSRAN_SUCCESS;
+}
+
+static void benchmark()
+{
+  srsran_sl_prof_snapshot_t s;
+  struct timeval            t[3];
+  uint32_t                  nof_repetitions = 1000000;
+
+  gettimeofday(&t[1], NULL);
+  for (uint32_t i = 0; i < nof_repetitions; i++) {
+    uint64_t t0 = srsran_sl_prof_now_ns();
+    srsran_sl_prof_add(SRSRAN_SL_PROF_RX_LOG, srsran_sl_prof_now_ns() - t0);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  printf("Timing a stage: %.1f ns\n", (t[0].tv_sec * 1e9 + t[0].tv_usec * 1e3) / nof_repetitions);
+
+  gettimeofday(&t[1], NULL);
+  srsran_sl_prof_snapshot(&s);
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  printf("Snapshot: %ld us, rx_log p50 %ld ns, p99 %ld ns, max %ld ns\n",
+         t[0].tv_usec,
+         s.stage[SRSRAN_SL_PROF_RX_LOG].p50_ns,
+         s.stage[SRSRAN_SL_PROF_RX_LOG].p99_ns,
+         s.stage[SRSRAN_SL_PROF_RX_LOG].max_ns);
+}
+
+static void usage(char* prog)
+{
+  printf("Usage: %s\n", prog);
+  printf("\t-f latency file [Default %s]\n", page_path);
+  printf("\t-n measurements per thread [Default %d]\n", nof_thread_events);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "fn")) != -1) {
+    switch (opt) {
+      case 'f':
+        page_path = argv[optind];
+        break;
+      case 'n':
+        nof_thread_events = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  int ret = SRSRAN_ERROR;
+  if (test_percentiles() || test_threads() || test_publish()) {
+    goto clean_exit;
+  }
+  benchmark();
+
+  printf("Ok\n");
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+  unlink(page_path);
+  return ret;
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/simd.h"
+#include "srsran/phy/utils/vec_alloc.h"
+#include "srsran/phy/utils/vector.h"
+
+#define TESTASSERT(cond)                                                                                               \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("[%s][Line %d]. Fail at %s\n", __FUNCTION__, __LINE__, #cond);                                            \
+      return -1;                                                                                                       \
+    }                                                                                                                  \
+  } while (false)
+
+#define HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+static uint32_t nof_iterations = 100000;
+
+static bool is_aligned(void* ptr, size_t align)
+{
+  return ((uintptr_t)ptr & (align - 1)) == 0;
+}
+
+static int test_default()
+{
+  srsran_vec_alloc_stats_t before, after;
+  srsran_vec_alloc_get_stats(&before);
+
+  // Existing callers get SIMD aligned buffers they release with free()
+  cf_t* x = srsran_vec_cf_malloc(1000);
+  TESTASSERT(x != NULL && is_aligned(x, SRSRAN_SIMD_BIT_ALIGN));
+  srsran_vec_cf_zero(x, 1000);
+  x = srsran_vec_realloc(x, sizeof(cf_t) * 1000, sizeof(cf_t) * 2000);
+  TESTASSERT(x != NULL && is_aligned(x, SRSRAN_SIMD_BIT_ALIGN));
+  TESTASSERT(x[999] == 0);
+  free(x);
+
+  srsran_vec_alloc_get_stats(&after);
+  TESTASSERT(after.nof_allocs - before.nof_allocs == 2);
+  TESTASSERT(after.bytes - before.bytes == sizeof(cf_t) * 3000);
+  return SRSRAN_SUCCESS;
+}
+
+static int test_hugepage()
+{
+  srsran_vec_alloc_stats_t before, after;
+  srsran_vec_alloc_get_stats(&before);
+  srsran_vec_alloc_set_backend(SRSRAN_VEC_ALLOC_HUGEPAGE);
+  TESTASSERT(srsran_vec_alloc_get_backend() == SRSRAN_VEC_ALLOC_HUGEPAGE);
+
+  // Large buffers start on a hugepage and cover whole hugepages, small ones keep their alignment
+  uint8_t* large = srsran_vec_u8_malloc(2 * HUGEPAGE_SIZE + 1);
+  float*   small = srsran_vec_f_malloc(100);
+  TESTASSERT(large != NULL && is_aligned(large, HUGEPAGE_SIZE));
+  TESTASSERT(small != NULL && is_aligned(small, SRSRAN_SIMD_BIT_ALIGN));
+  memset(large, 1, 2 * HUGEPAGE_SIZE + 1);
+  free(large);
+  free(small);
+
+  // Transparent hugepages may be compiled out of the kernel
+  srsran_vec_alloc_get_stats(&after);
+  TESTASSERT(after.nof_allocs - before.nof_allocs == 2);
+  TESTASSERT(after.bytes_hugepage - before.bytes_hugepage == 0 ||
+             after.bytes_hugepage - before.bytes_hugepage == 3 * HUGEPAGE_SIZE + sizeof(float) * 100);
+
+  srsran_vec_alloc_set_backend(SRSRAN_VEC_ALLOC_DEFAULT);
+  return SRSRAN_SUCCESS;
+}
+
+static void* custom_alloc(void* arg, size_t size, size_t align)
+{
+  (*(uint32_t*)arg)++;
+  void* ptr = NULL;
+  return posix_memalign(&ptr, align, size) ? NULL : ptr;
+}
+
+static int test_custom()
+{
+  uint32_t nof_calls = 0;
+  srsran_vec_alloc_set_custom(custom_alloc, &nof_calls);
+  TESTASSERT(srsran_vec_alloc_get_backend() == SRSRAN_VEC_ALLOC_CUSTOM);
+
+  int16_t* x = srsran_vec_i16_malloc(10);
+  TESTASSERT(x != NULL && nof_calls == 1);
+  free(x);
+
+  srsran_vec_alloc_set_custom(NULL, NULL);
+  TESTASSERT(srsran_vec_alloc_get_backend() == SRSRAN_VEC_ALLOC_DEFAULT);
+  x = srsran_vec_i16_malloc(10);
+  TESTASSERT(x != NULL && nof_calls == 1);
+  free(x);
+  return SRSRAN_SUCCESS;
+}
+
+static void* other_thread(void* arg)
+{
+  *(int*)arg = srsran_vec_alloc_get_thread_node();
+  return NULL;
+}
+
+static int test_numa()
+{
+  // Node 0 exists on every NUMA kernel, there may be none in a container
+  if (access("/sys/devices/system/node/node0", F_OK) != 0) {
+    TESTASSERT(srsran_vec_alloc_set_thread_node(0) == SRSRAN_ERROR);
+    return SRSRAN_SUCCESS;
+  }
+  TESTASSERT(srsran_vec_alloc_set_thread_node(SRSRAN_VEC_ALLOC_MAX_NODES) == SRSRAN_ERROR);
+
+  srsran_vec_alloc_stats_t before, after;
+  srsran_vec_alloc_get_stats(&before);
+  int node_before = srsran_vec_alloc_get_thread_node();
+  TESTASSERT(srsran_vec_alloc_set_thread_node(0) == SRSRAN_SUCCESS);
+  TESTASSERT(srsran_vec_alloc_get_thread_node() == 0);
+
+  // Bound buffers own their pages
+  uint32_t* x = srsran_vec_u32_malloc(10);
+  TESTASSERT(x != NULL && is_aligned(x, 4096));
+  free(x);
+
+  // The node is per thread
+  int       node = 0;
+  pthread_t t;
+  TESTASSERT(pthread_create(&t, NULL, other_thread, &node) == 0);
+  pthread_join(t, NULL);
+  TESTASSERT(node == node_before);
+
+  // The node given for a buffer overrides the one of the thread. mbind is not allowed in every container
+  x = srsran_vec_alloc(100, SRSRAN_VEC_ALLOC_NODE_ANY);
+  TESTASSERT(x != NULL);
+  free(x);
+  srsran_vec_alloc_get_stats(&after);
+  TESTASSERT(after.nof_allocs - before.nof_allocs == 2);
+  TESTASSERT((after.bytes_node[0] - before.bytes_node[0]) / 4096 + after.nof_bind_failed - before.nof_bind_failed ==
+             1);
+
+  TESTASSERT(srsran_vec_alloc_set_thread_node(SRSRAN_VEC_ALLOC_NODE_ANY) == SRSRAN_SUCCESS);
+  return SRSRAN_SUCCESS;
+}
+
+/* Cost of the dispatch and the statistics on top of posix_memalign */
+static void benchmark()
+{
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+  for (uint32_t i = 0; i < nof_iterations; i++) {
+    free(srsran_vec_cf_malloc(1024));
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  printf("%d allocations in %ld us\n", nof_iterations, t[0].tv_sec * 1000000 + t[0].tv_usec);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "n")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_iterations = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        printf("Usage: %s [n]\n", argv[0]);
+        printf("\t-n number of allocations in the benchmark [Default %d]\n", nof_iterations);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  TESTASSERT(test_default() == SRSRAN_SUCCESS);
+  TESTASSERT(test_hugepage() == SRSRAN_SUCCESS);
+  TESTASSERT(test_custom() == SRSRAN_SUCCESS);
+  TESTASSERT(test_numa() == SRSRAN_SUCCESS);
+  benchmark();
+  srsran_vec_alloc_fprint_stats(stdout);
+
+  printf("Ok\n");
+  return SRSRAN_SUCCESS;
+}
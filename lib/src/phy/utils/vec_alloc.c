@@ -0,0 +1,217 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/simd.h"
+#include "srsran/phy/utils/vec_alloc.h"
+#include "srsran/phy/utils/vector.h"
+
+#define VEC_ALLOC_PAGE_SIZE 4096
+#define VEC_ALLOC_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+// From linux/mempolicy.h, the preferred node falls back to the others when it is full
+#define VEC_ALLOC_MPOL_PREFERRED 1
+#define VEC_ALLOC_MPOL_MF_MOVE (1 << 1)
+
+static pthread_once_t             init_once   = PTHREAD_ONCE_INIT;
+static srsran_vec_alloc_backend_t backend     = SRSRAN_VEC_ALLOC_DEFAULT;
+static bool                       backend_set = false;
+static srsran_vec_alloc_func_t    custom_func = NULL;
+static void*                      custom_arg  = NULL;
+
+// Node of the threads that did not choose one
+static int          default_node = SRSRAN_VEC_ALLOC_NODE_ANY;
+static __thread int thread_node  = SRSRAN_VEC_ALLOC_NODE_THREAD;
+
+// Updated with relaxed atomics, allocations are not on the hot path but may come from any thread
+static srsran_vec_alloc_stats_t stats = {};
+
+static bool node_exists(int node)
+{
+  char path[64];
+  snprintf(path, sizeof(path), "/sys/devices/system/node/node%d", node);
+  return node >= 0 && node < SRSRAN_VEC_ALLOC_MAX_NODES && access(path, F_OK) == 0;
+}
+
+static void vec_alloc_init(void)
+{
+  const char* env = getenv("SRSRAN_VEC_ALLOC");
+  if (!backend_set && env != NULL) {
+    if (strcmp(env, "hugepage") == 0) {
+      backend = SRSRAN_VEC_ALLOC_HUGEPAGE;
+    } else if (strcmp(env, "default") != 0) {
+      ERROR("Unknown SRSRAN_VEC_ALLOC=%s, using the default allocator\n", env);
+    }
+  }
+
+  env = getenv("SRSRAN_VEC_NUMA_NODE");
+  if (env != NULL) {
+    int node = (int)strtol(env, NULL, 10);
+    if (node_exists(node)) {
+      default_node = node;
+    } else {
+      ERROR("NUMA node %s in SRSRAN_VEC_NUMA_NODE does not exist\n", env);
+    }
+  }
+}
+
+void srsran_vec_alloc_set_backend(srsran_vec_alloc_backend_t backend_)
+{
+  backend     = backend_;
+  backend_set = true;
+}
+
+void srsran_vec_alloc_set_custom(srsran_vec_alloc_func_t func, void* arg)
+{
+  custom_func = func;
+  custom_arg  = arg;
+  srsran_vec_alloc_set_backend(func ? SRSRAN_VEC_ALLOC_CUSTOM : SRSRAN_VEC_ALLOC_DEFAULT);
+}
+
+srsran_vec_alloc_backend_t srsran_vec_alloc_get_backend(void)
+{
+  pthread_once(&init_once, vec_alloc_init);
+  return backend;
+}
+
+int srsran_vec_alloc_set_thread_node(int node)
+{
+  if (node != SRSRAN_VEC_ALLOC_NODE_ANY && !node_exists(node)) {
+    return SRSRAN_ERROR;
+  }
+  thread_node = node;
+  return SRSRAN_SUCCESS;
+}
+
+int srsran_vec_alloc_get_thread_node(void)
+{
+  pthread_once(&init_once, vec_alloc_init);
+  return thread_node == SRSRAN_VEC_ALLOC_NODE_THREAD ? default_node : thread_node;
+}
+
+static inline size_t round_up(size_t size, size_t align)
+{
+  return (size + align - 1) & ~(align - 1);
+}
+
+void* srsran_vec_alloc(size_t size, int node)
+{
+  pthread_once(&init_once, vec_alloc_init);
+  if (node == SRSRAN_VEC_ALLOC_NODE_THREAD) {
+    node = srsran_vec_alloc_get_thread_node();
+  }
+
+  // Hugepages and NUMA policies apply to whole pages, which the buffer must not share
+  bool   hugepage = backend == SRSRAN_VEC_ALLOC_HUGEPAGE && size >= VEC_ALLOC_HUGEPAGE_SIZE;
+  size_t align    = SRSRAN_SIMD_BIT_ALIGN;
+  size_t len      = size;
+  if (hugepage) {
+    align = VEC_ALLOC_HUGEPAGE_SIZE;
+    len   = round_up(size, VEC_ALLOC_HUGEPAGE_SIZE);
+  } else if (node >= 0) {
+    align = SRSRAN_MAX(align, VEC_ALLOC_PAGE_SIZE);
+    len   = round_up(size, VEC_ALLOC_PAGE_SIZE);
+  }
+
+  void* ptr = NULL;
+  if (backend == SRSRAN_VEC_ALLOC_CUSTOM && custom_func) {
+    ptr = custom_func(custom_arg, len, align);
+  } else if (posix_memalign(&ptr, align, len)) {
+    ptr = NULL;
+  }
+  if (ptr == NULL) {
+    __atomic_fetch_add(&stats.nof_failed, 1, __ATOMIC_RELAXED);
+    return NULL;
+  }
+
+  // Smaller buffers mark their pages, so that the heap ranges they fill can be collapsed into hugepages as well
+  if (backend == SRSRAN_VEC_ALLOC_HUGEPAGE) {
+    uintptr_t start = (uintptr_t)ptr & ~(uintptr_t)(VEC_ALLOC_PAGE_SIZE - 1);
+    uintptr_t end   = round_up((uintptr_t)ptr + len, VEC_ALLOC_PAGE_SIZE);
+    if (madvise((void*)start, end - start, MADV_HUGEPAGE) == 0) {
+      __atomic_fetch_add(&stats.bytes_hugepage, len, __ATOMIC_RELAXED);
+    }
+  }
+
+  // Moves the pages the allocator already touched, the others are placed on the node at first touch
+  if (node >= 0 && node < SRSRAN_VEC_ALLOC_MAX_NODES) {
+    unsigned long mask = 1UL << node;
+    if (syscall(SYS_mbind,
+                ptr,
+                len,
+                VEC_ALLOC_MPOL_PREFERRED,
+                &mask,
+                sizeof(mask) * 8,
+                VEC_ALLOC_MPOL_MF_MOVE) == 0) {
+      __atomic_fetch_add(&stats.bytes_node[node], len, __ATOMIC_RELAXED);
+    } else {
+      __atomic_fetch_add(&stats.nof_bind_failed, 1, __ATOMIC_RELAXED);
+    }
+  }
+
+  __atomic_fetch_add(&stats.nof_allocs, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&stats.bytes, size, __ATOMIC_RELAXED);
+  return ptr;
+}
+
+void srsran_vec_alloc_get_stats(srsran_vec_alloc_stats_t* s)
+{
+  s->nof_allocs      = __atomic_load_n(&stats.nof_allocs, __ATOMIC_RELAXED);
+  s->nof_failed      = __atomic_load_n(&stats.nof_failed, __ATOMIC_RELAXED);
+  s->bytes           = __atomic_load_n(&stats.bytes, __ATOMIC_RELAXED);
+  s->bytes_hugepage  = __atomic_load_n(&stats.bytes_hugepage, __ATOMIC_RELAXED);
+  s->nof_bind_failed = __atomic_load_n(&stats.nof_bind_failed, __ATOMIC_RELAXED);
+  for (uint32_t i = 0; i < SRSRAN_VEC_ALLOC_MAX_NODES; i++) {
+    s->bytes_node[i] = __atomic_load_n(&stats.bytes_node[i], __ATOMIC_RELAXED);
+  }
+}
+
+void srsran_vec_alloc_fprint_stats(FILE* f)
+{
+  const char* names[] = {"default", "hugepage", "custom"};
+
+  srsran_vec_alloc_stats_t s;
+  srsran_vec_alloc_get_stats(&s);
+  fprintf(f,
+          "Vector buffers: %s allocator, %" PRIu64 " buffers, %.1f MB, %.1f MB on hugepages, %" PRIu64
+          " failed, %" PRIu64 " not bound",
+          names[srsran_vec_alloc_get_backend()],
+          s.nof_allocs,
+          s.bytes / 1e6,
+          s.bytes_hugepage / 1e6,
+          s.nof_failed,
+          s.nof_bind_failed);
+  for (uint32_t i = 0; i < SRSRAN_VEC_ALLOC_MAX_NODES; i++) {
+    if (s.bytes_node[i] > 0) {
+      fprintf(f, ", %.1f MB on node %d", s.bytes_node[i] / 1e6, i);
+    }
+  }
+  fprintf(f, "\n");
+}
@@ -28,6 +28,7 @@
 #include "srsran/phy/utils/bit.h"
 #include "srsran/phy/utils/debug.h"
 #include "srsran/phy/utils/simd.h"
+#include "srsran/phy/utils/vec_alloc.h"
 #include "srsran/phy/utils/vector.h"
 #include "srsran/phy/utils/vector_simd.h"
 
@@ -137,12 +138,7 @@ void srsran_vec_lut_sis(const short* x, const unsigned int* lut, short* y, const
 
 void* srsran_vec_malloc(uint32_t size)
 {
-  void* ptr;
-  if (posix_memalign(&ptr, SRSRAN_SIMD_BIT_ALIGN, size)) {
-    return NULL;
-  } else {
-    return ptr;
-  }
+  return srsran_vec_alloc(size, SRSRAN_VEC_ALLOC_NODE_THREAD);
 }
 
 cf_t* srsran_vec_cf_malloc(uint32_t nsamples)
@@ -230,8 +226,8 @@ void* srsran_vec_realloc(void* ptr, uint32_t old_size, uint32_t new_size)
 #ifndef LV_HAVE_SSE
   return realloc(ptr, new_size);
 #else
-  void* new_ptr;
-  if (posix_memalign(&new_ptr, SRSRAN_SIMD_BIT_ALIGN, new_size)) {
+  void* new_ptr = srsran_vec_malloc(new_size);
+  if (new_ptr == NULL) {
     return NULL;
   } else {
     memcpy(new_ptr, ptr, old_size);
@@ -19,37 +19,58 @@
  *
  */
 
+#include <inttypes.h>
 #include <semaphore.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "srsran/mac/sl_sch.h"
 #include "srsran/phy/ch_estimation/chest_sl.h"
 #include "srsran/phy/common/phy_common_sl.h"
+#include "srsran/phy/common/sl_precfg.h"
 #include "srsran/phy/dft/ofdm.h"
+#include "srsran/phy/io/filesource.h"
+#include "srsran/phy/io/iq_capture.h"
+#include "srsran/phy/io/sl_export.h"
 #include "srsran/phy/phch/pscch.h"
 #include "srsran/phy/phch/pssch.h"
 #include "srsran/phy/phch/ra_sl.h"
 #include "srsran/phy/phch/sci.h"
+#include "srsran/phy/resampling/channelizer.h"
 #include "srsran/phy/rf/rf.h"
+#include "srsran/phy/ue/ue_sl_reservation.h"
 #include "srsran/phy/ue/ue_sync.h"
 #include "srsran/phy/utils/bit.h"
 #include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/sl_prof.h"
+#include "srsran/phy/utils/vec_alloc.h"
 #include "srsran/phy/utils/vector.h"
 
 
+// PSCCH DMRS cyclic shifts 0, 3, 6 and 9, 3GPP TS 36.211 Section 9.8
+#define SL_NOF_CYCLIC_SHIFTS 4
+
 bool keep_running = true;
 
 srsran_cell_sl_t cell_sl = {.nof_prb = 50, .tm = SRSRAN_SIDELINK_TM4, .cp = SRSRAN_CP_NORM, .N_sl_id = 0};
 
 typedef struct {
   bool     use_standard_lte_rates;
+  char*    input_file_name;
   char*    log_file_name;
+  char*    export_file_name;
+  char*    prof_file_name;
+  char*    pool_file_name;
+  char*    capture_prefix;
+  char*    capture_spec;
   uint32_t file_start_sf_idx;
   uint32_t nof_rx_antennas;
   char*    rf_dev;
@@ -57,28 +78,69 @@ typedef struct {
   double   rf_freq;
   float    rf_gain;
 
+  // Wideband capture
+  uint32_t nof_channels;
+  float    channel_spacing;
+
   // Sidelink specific args
   uint32_t size_sub_channel;
   uint32_t num_sub_channel;
+  bool     use_slss_sync;
+  bool     use_prediction;
+  bool     use_wiener;
+  uint32_t budget_usec;
+  uint32_t seq_period_s;
 } prog_args_t;
 
 void args_default(prog_args_t* args)
 {
   args->use_standard_lte_rates = false;
+  args->input_file_name        = NULL;
   args->log_file_name          = NULL;
+  args->export_file_name       = NULL;
+  args->prof_file_name         = NULL;
+  args->pool_file_name         = NULL;
+  args->capture_prefix         = NULL;
+  args->capture_spec           = "";
   args->file_start_sf_idx      = 0;
   args->nof_rx_antennas        = 1;
   args->rf_dev                 = "";
   args->rf_args                = "";
   args->rf_freq                = 5.92e9;
   args->rf_gain                = 50;
+  args->nof_channels           = 1;
+  args->channel_spacing        = 10e6;
   args->size_sub_channel       = 10;
   args->num_sub_channel        = 5;
+  args->use_slss_sync          = false;
+  args->use_prediction         = true;
+  args->use_wiener             = false;
+  args->budget_usec            = 0;
+  args->seq_period_s           = 0;
 }
 
 static srsran_rf_t radio;
 static prog_args_t prog_args;
 
+// Number of records kept in the export ring, 4 s of a fully loaded channel
+#define SL_EXPORT_NOF_RECORDS 4096
+
+static srsran_sl_export_t sl_export;
+
+// Decoded SL-SCH PDUs are counted per source Layer-2 ID, across all channels
+#define SL_SCH_MAX_SOURCES 4096
+
+static srsran_sl_sch_rx_t sl_sch_rx;
+
+// Bin width of the one-way latency histograms of the sequence headers
+#define SL_SCH_LAT_BIN_US 100
+
+// Resource pools of the carrier, only the subframes and sub-channels of the RX pools are decoded
+static srsran_sl_v2x_precfg_freq_t sl_precfg;
+
+// History of the received subframes, ue_sync receives straight into it
+static srsran_iq_capture_t iq_capture;
+
 void sig_int_handler(int signo)
 {
   printf("SIGINT received. Exiting...\n");
@@ -89,23 +151,51 @@ void sig_int_handler(int signo)
   }
 }
 
+void sig_usr1_handler(int signo)
+{
+  srsran_iq_capture_trigger(&iq_capture);
+}
+
 void usage(prog_args_t* args, char* prog)
 {
-  printf("Usage: %s [aAcdgmnoprstv] -f rx_frequency_hz\n", prog);
+  printf("Usage: %s [aABbCcdegiILmnoPpqrsStTvWx] -f rx_frequency_hz\n", prog);
   printf("\t-a RF args [Default %s]\n", args->rf_args);
   printf("\t-A nof_rx_antennas [Default %d]\n", args->nof_rx_antennas);
+  printf("\t-B channel spacing in Hz for wideband capture [Default %.1f MHz]\n", args->channel_spacing / 1e6);
+  printf("\t-b decode budget per subframe in us, work left when it is spent is shed [Default %d, unlimited]\n",
+         args->budget_usec);
+  printf("\t-C resource pool file, see sl_precfg.h, replaces -n and -s [Default a single pool on every subframe]\n");
   printf("\t-c N_sl_id [Default %d]\n", cell_sl.N_sl_id);
   printf("\t-d RF devicename [Default %s]\n", args->rf_dev);
+  printf("\t-e Wiener channel estimation of PSCCH and PSSCH instead of LS [Default %i]\n", args->use_wiener);
   printf("\t-g RF Gain [Default %.2f dB]\n", args->rf_gain);
-  printf("\t-m Start subframe_idx [Default %d]\n", args->file_start_sf_idx);
+  printf("\t-i input_file_name, read samples at the RF sampling rate instead of using the radio. With -A, one "
+         "comma separated file per antenna. Files ending in .bfp are block floating point\n");
+  printf("\t-I IQ capture prefix, the subframes around a trigger are written to <prefix>_<n>_<antenna>.fc32, or .bfp, "
+         "which -i reads. SIGUSR1 triggers a capture. With -W, the first channel is captured [Default none]\n");
+  printf("\t-L latency file, stage latency statistics published every second, e.g. /dev/shm/pssch_ue_prof\n");
+  printf("\t-m DFN subframe, 0 to 10239, of the first sample of the input file [Default %d]\n",
+         args->file_start_sf_idx);
   printf("\t-n num_sub_channel [Default for 50 prbs %d]\n", args->num_sub_channel);
   printf("\t-o log_file_name.\n");
+  printf("\t-P disable the prediction of PSCCH candidates from reserved resources [Default %i]\n",
+         !args->use_prediction);
   printf("\t-p nof_prb [Default %d]\n", cell_sl.nof_prb);
+  printf("\t-q period in s of the loss, reordering and latency summary of the sequence headers of "
+         "cv2x_traffic_generator -H [Default %d, disabled]\n",
+         args->seq_period_s);
   printf("\t-r use_standard_lte_rates [Default %i]\n", args->use_standard_lte_rates);
   printf("\t-s size_sub_channel [Default for 50 prbs %d]\n", args->size_sub_channel);
+  printf("\t-S synchronize to SLSS instead of GNSS [Default %i]\n", args->use_slss_sync);
   printf("\t-t Sidelink transmission mode {1,2,3,4} [Default %d]\n", (cell_sl.tm + 1));
+  printf("\t-T IQ capture history and trigger rules, comma separated history=<s>,pre=<ms>,post=<ms>,win=<ms>,"
+         "crc=<CRC failures in win>,sci=<ratio of SCIs in win to their average>,scimin=<SCIs in win>,sync,"
+         "bfp=<8 or 12 bit block floating point files> "
+         "[Default history=4,pre=500,post=500,win=100,scimin=10]\n");
   printf("\t-v srsran_verbose\n");
-
+  printf("\t-W number of adjacent channels in a wideband capture centered at rx_frequency [Default %d]\n",
+         args->nof_channels);
+  printf("\t-x export file, shared memory ring of the decoded SCIs and TBs, e.g. /dev/shm/pssch_ue [Default none]\n");
 }
 
 void parse_args(prog_args_t* args, int argc, char** argv)
@@ -113,7 +203,7 @@ void parse_args(prog_args_t* args, int argc, char** argv)
   int opt;
   args_default(args);
 
-  while ((opt = getopt(argc, argv, "aAcdfgmnoprsv")) != -1) {
+  while ((opt = getopt(argc, argv, "aABbCcdefgiILmnoPpqrsSTvWx")) != -1) {
     switch (opt) {
       case 'a':
         args->rf_args = argv[optind];
@@ -121,20 +211,41 @@ void parse_args(prog_args_t* args, int argc, char** argv)
       case 'A':
         args->nof_rx_antennas = (int32_t)strtol(argv[optind], NULL, 10);
         break;
+      case 'B':
+        args->channel_spacing = strtof(argv[optind], NULL);
+        break;
+      case 'b':
+        args->budget_usec = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'C':
+        args->pool_file_name = argv[optind];
+        break;
       case 'c':
         cell_sl.N_sl_id = (int32_t)strtol(argv[optind], NULL, 10);
         break;
       case 'd':
         args->rf_dev = argv[optind];
         break;
+      case 'e':
+        args->use_wiener = true;
+        break;
       case 'f':
         args->rf_freq = strtof(argv[optind], NULL);
         break;
       case 'g':
         args->rf_gain = strtof(argv[optind], NULL);
         break;
+      case 'i':
+        args->input_file_name = argv[optind];
+        break;
+      case 'I':
+        args->capture_prefix = argv[optind];
+        break;
+      case 'L':
+        args->prof_file_name = argv[optind];
+        break;
       case 'm':
-        args->file_start_sf_idx = (uint32_t)strtol(argv[optind], NULL, 10);
+        args->file_start_sf_idx = (uint32_t)strtol(argv[optind], NULL, 10) % SRSRAN_SL_DFN_PERIOD;
         break;
       case 'n':
         args->num_sub_channel = (int32_t)strtol(argv[optind], NULL, 10);
@@ -142,18 +253,36 @@ void parse_args(prog_args_t* args, int argc, char** argv)
       case 'o':
         args->log_file_name = argv[optind];
         break;
+      case 'P':
+        args->use_prediction = false;
+        break;
       case 'p':
         cell_sl.nof_prb = (int32_t)strtol(argv[optind], NULL, 10);
         break;
+      case 'q':
+        args->seq_period_s = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
       case 'r':
         args->use_standard_lte_rates = true;
         break;
       case 's':
         args->size_sub_channel = (int32_t)strtol(argv[optind], NULL, 10);
         break;
+      case 'S':
+        args->use_slss_sync = true;
+        break;
+      case 'T':
+        args->capture_spec = argv[optind];
+        break;
       case 'v':
         srsran_verbose++;
         break;
+      case 'W':
+        args->nof_channels = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'x':
+        args->export_file_name = argv[optind];
+        break;
       default:
         usage(args, argv[0]);
         exit(-1);
@@ -163,6 +292,17 @@ void parse_args(prog_args_t* args, int argc, char** argv)
     usage(args, argv[0]);
     exit(-1);
   }
+  if (args->nof_rx_antennas == 0 || args->nof_rx_antennas > SRSRAN_MAX_PORTS) {
+    ERROR("Up to %d receive antennas are supported\n", SRSRAN_MAX_PORTS);
+    usage(args, argv[0]);
+    exit(-1);
+  }
+  if (args->nof_channels == 0 || args->nof_channels > SRSRAN_CHANNELIZER_MAX_CHANNELS ||
+      (args->nof_channels > 1 && args->nof_rx_antennas > 1)) {
+    ERROR("Wideband capture supports up to %d channels on a single antenna\n", SRSRAN_CHANNELIZER_MAX_CHANNELS);
+    usage(args, argv[0]);
+    exit(-1);
+  }
 }
 
 #ifndef DISABLE_RF
@@ -175,8 +315,842 @@ int srsran_rf_recv_wrapper(void* h, cf_t* data[SRSRAN_MAX_PORTS], uint32_t nsamp
   }
   return srsran_rf_recv_with_time_multi(h, ptr, nsamples, true, &t->full_secs, &t->frac_secs);
 }
+
+int srsran_rf_start_rx_timed_wrapper(void* h, srsran_timestamp_t* t)
+{
+  DEBUG(" ----  Start Rx stream at %ld + %f  ---- \n", t->full_secs, t->frac_secs);
+  return srsran_rf_start_rx_stream_timed(h, t->full_secs, t->frac_secs);
+}
 #endif // DISABLE_RF
 
+typedef int (*recv_callback_t)(void*, cf_t* [SRSRAN_MAX_PORTS], uint32_t, srsran_timestamp_t*);
+typedef int (*start_rx_timed_callback_t)(void*, srsran_timestamp_t*);
+
+/* Offline input, samples are read from a file at the RF sampling rate. The file replaces a radio whose stream
+ * starts at the requested time, so it is rewound when ue_sync aligns to the GNSS second boundary. */
+typedef struct {
+  srsran_filesource_t fsrc[SRSRAN_MAX_PORTS]; ///< One per antenna
+  uint32_t            nof_files;
+  double              srate;
+  uint64_t            nof_samples;
+  srsran_timestamp_t  start_time;
+} file_rx_t;
+
+int file_recv(void* h, cf_t* data[SRSRAN_MAX_PORTS], uint32_t nsamples, srsran_timestamp_t* t)
+{
+  file_rx_t* q = (file_rx_t*)h;
+
+  if (t) {
+    srsran_timestamp_copy(t, &q->start_time);
+    srsran_timestamp_add(t, 0, q->nof_samples / q->srate);
+  }
+
+  int nread = 0;
+  for (uint32_t i = 0; i < q->nof_files; i++) {
+    nread = srsran_filesource_read(&q->fsrc[i], data[i], nsamples);
+    if (nread < (int)nsamples) {
+      printf("End of file reached. Exiting...\n");
+      keep_running = false;
+      return SRSRAN_ERROR;
+    }
+  }
+  q->nof_samples += nsamples;
+  return nread;
+}
+
+int file_start_rx_timed(void* h, srsran_timestamp_t* t)
+{
+  file_rx_t* q = (file_rx_t*)h;
+
+  // The first sample of the file belongs to the DFN subframe file_start_sf_idx, it is given the first time from t on
+  // that the GNSS DFN rule maps to that subframe
+  for (uint32_t i = 0; i < q->nof_files; i++) {
+    srsran_filesource_seek(&q->fsrc[i], 0);
+  }
+  q->nof_samples  = 0;
+  uint32_t offset = (prog_args.file_start_sf_idx + SRSRAN_SL_DFN_PERIOD - srsran_ue_sync_gnss_dfn_sf(t, 0)) %
+                    SRSRAN_SL_DFN_PERIOD;
+  srsran_timestamp_copy(&q->start_time, t);
+  srsran_timestamp_add(&q->start_time, 0, offset * 1e-3);
+  return SRSRAN_SUCCESS;
+}
+
+/* Wideband capture. Every received block is split into nof_channels sidelink channels. The first channel is handed
+ * to ue_sync, all of them are kept in a history holding the last subframe, which is what gets decoded. */
+typedef struct {
+  srsran_channelizer_t      channelizer;
+  recv_callback_t           recv;
+  start_rx_timed_callback_t start_rx_timed;
+  void*                     h;
+  uint32_t                  sf_len;
+  double                    srate;
+  uint32_t                  skip; ///< Outputs to drop until the filter has settled
+  cf_t*                     wideband;
+  cf_t*                     out[SRSRAN_CHANNELIZER_MAX_CHANNELS];
+  cf_t*                     history[SRSRAN_CHANNELIZER_MAX_CHANNELS];
+} wideband_rx_t;
+
+int wideband_rx_init(wideband_rx_t* q, uint32_t sf_len, double srate, double* srate_rf)
+{
+  uint32_t nof_channels = prog_args.nof_channels;
+  float    spacing      = prog_args.channel_spacing;
+
+  // The capture covers all channels plus one channel bandwidth
+  uint32_t decimation = (uint32_t)ceil(((nof_channels - 1) * spacing + srate) / srate);
+  *srate_rf           = srate * decimation;
+
+  float freq[SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    freq[k] = (float)(((float)k - (nof_channels - 1) / 2.0f) * spacing / *srate_rf);
+  }
+
+  // Pass the occupied band and reject the adjacent channels
+  float occupied = cell_sl.nof_prb * SRSRAN_NRE * 15e3f;
+  if (srsran_channelizer_init(&q->channelizer,
+                              nof_channels,
+                              freq,
+                              decimation,
+                              (float)(spacing / 2.0 / *srate_rf),
+                              (float)((spacing - occupied) / *srate_rf),
+                              sf_len * decimation)) {
+    ERROR("Error initiating channelizer\n");
+    return SRSRAN_ERROR;
+  }
+
+  q->sf_len   = sf_len;
+  q->srate    = srate;
+  q->skip     = srsran_channelizer_get_delay(&q->channelizer);
+  q->wideband = srsran_vec_cf_malloc(sf_len * decimation);
+  if (!q->wideband) {
+    return SRSRAN_ERROR;
+  }
+  for (uint32_t k = 0; k < nof_channels; k++) {
+    q->out[k]     = srsran_vec_cf_malloc(sf_len);
+    q->history[k] = srsran_vec_cf_malloc(sf_len);
+    if (!q->out[k] || !q->history[k]) {
+      return SRSRAN_ERROR;
+    }
+    srsran_vec_cf_zero(q->history[k], sf_len);
+    printf("Channel %d: %.6f MHz\n", k, (prog_args.rf_freq + freq[k] * *srate_rf) / 1e6);
+  }
+  printf("Wideband capture of %d channels, decimation %d, %d taps\n",
+         nof_channels,
+         decimation,
+         q->channelizer.nof_taps);
+
+  return SRSRAN_SUCCESS;
+}
+
+void wideband_rx_free(wideband_rx_t* q)
+{
+  for (uint32_t k = 0; k < q->channelizer.nof_channels; k++) {
+    free(q->out[k]);
+    free(q->history[k]);
+  }
+  if (q->wideband) {
+    free(q->wideband);
+  }
+  srsran_channelizer_free(&q->channelizer);
+}
+
+int wideband_recv(void* h, cf_t* data[SRSRAN_MAX_PORTS], uint32_t nsamples, srsran_timestamp_t* t)
+{
+  wideband_rx_t* q          = (wideband_rx_t*)h;
+  uint32_t       decimation = q->channelizer.decimation;
+  uint32_t       delay      = srsran_channelizer_get_delay(&q->channelizer);
+  uint32_t       count      = 0;
+
+  while (count < nsamples) {
+    uint32_t           n                     = SRSRAN_MIN(nsamples - count + q->skip, q->sf_len);
+    cf_t*              ptr[SRSRAN_MAX_PORTS] = {q->wideband};
+    srsran_timestamp_t ts                    = {};
+    if (q->recv(q->h, ptr, n * decimation, &ts) < 0) {
+      return SRSRAN_ERROR;
+    }
+    if (srsran_channelizer_execute(&q->channelizer, q->wideband, q->out, n * decimation) != (int)n) {
+      return SRSRAN_ERROR;
+    }
+
+    // The filter transient after a (re)start is dropped, so that the outputs keep the timing of the input
+    uint32_t skip = SRSRAN_MIN(q->skip, n);
+    q->skip -= skip;
+    n -= skip;
+    if (n == 0) {
+      continue;
+    }
+
+    // Time of the first sample, compensated by the channel filter delay
+    if (t && count == 0) {
+      srsran_timestamp_copy(t, &ts);
+      srsran_timestamp_add(t, 0, skip / q->srate);
+      srsran_timestamp_sub(t, 0, delay / q->srate);
+    }
+
+    for (uint32_t k = 0; k < q->channelizer.nof_channels; k++) {
+      memmove(q->history[k], &q->history[k][n], sizeof(cf_t) * (q->sf_len - n));
+      srsran_vec_cf_copy(&q->history[k][q->sf_len - n], &q->out[k][skip], n);
+    }
+    srsran_vec_cf_copy(&data[0][count], &q->out[0][skip], n);
+    count += n;
+  }
+
+  return (int)nsamples;
+}
+
+int wideband_start_rx_timed(void* h, srsran_timestamp_t* t)
+{
+  wideband_rx_t* q = (wideband_rx_t*)h;
+  if (q->start_rx_timed == NULL) {
+    return SRSRAN_ERROR_INVALID_COMMAND;
+  }
+  int ret = q->start_rx_timed(q->h, t);
+  if (ret == SRSRAN_SUCCESS) {
+    srsran_channelizer_reset(&q->channelizer);
+    q->skip = srsran_channelizer_get_delay(&q->channelizer);
+  }
+  return ret;
+}
+
+/* SCI decoded in the current subframe whose PSSCH is still to be decoded */
+typedef struct {
+  srsran_sci_t sci;
+  uint32_t     pool_idx;
+  uint32_t     sub_channel_idx;
+  uint32_t     N_x_id;
+} rx_pending_t;
+
+/* PSCCH candidate demodulated and waiting for the batched channel decoding */
+typedef struct {
+  uint32_t pool_idx;
+  uint32_t sub_channel_idx;
+  uint32_t cyclic_shift;
+  bool     predicted;
+  int16_t  llr[3 * (SRSRAN_SCI_MAX_LEN + SRSRAN_SCI_CRC_LEN)];
+  uint8_t  c[SRSRAN_SCI_MAX_LEN + SRSRAN_SCI_CRC_LEN];
+} rx_pscch_candidate_t;
+
+/* Sidelink decoder for one channel, received on one or more antennas */
+typedef struct {
+  uint32_t          idx;
+  uint32_t          nof_ports;
+  cf_t**            input; ///< Received subframe of every antenna, moved by the IQ capture every subframe
+  cf_t*             sf_buffer[SRSRAN_MAX_PORTS];
+  srsran_ofdm_t     fft[SRSRAN_MAX_PORTS];
+  srsran_sci_t      sci[SRSRAN_SL_MAX_NOF_RX_POOLS];
+  srsran_pscch_t    pscch;
+  srsran_chest_sl_t pscch_chest;
+  srsran_pssch_t    pssch;
+  srsran_chest_sl_t pssch_chest;
+
+  // Resources reserved by the decoded SCIs, per RX pool
+  srsran_ue_sl_reservation_t reservation[SRSRAN_SL_MAX_NOF_RX_POOLS];
+  srsran_ue_sl_candidate_t   candidates[SRSRAN_SL_MAX_NOF_RX_POOLS * SRSRAN_MAX_NUM_SUB_CHANNEL];
+  uint32_t                   candidate_pool[SRSRAN_SL_MAX_NOF_RX_POOLS * SRSRAN_MAX_NUM_SUB_CHANNEL];
+
+  // PSCCH candidates decoded together, one per SIMD lane
+  rx_pscch_candidate_t pscch_batch[SRSRAN_VITERBI_BATCH_MAX_FRAMES];
+  uint32_t             nof_pscch_batch;
+
+  // PSSCH decoding queue of the current subframe, highest priority first
+  rx_pending_t pending[SRSRAN_SL_MAX_NOF_RX_POOLS * SRSRAN_MAX_NUM_SUB_CHANNEL];
+  uint32_t     nof_pending;
+  uint32_t     sf_shed_pscch;
+  uint32_t     sf_shed_pssch;
+
+  uint32_t num_decoded_sci;
+  uint32_t num_decoded_tb;
+  uint32_t num_crc_fail;
+  uint32_t num_subframes;
+  uint32_t num_skipped_subframes;
+  uint64_t num_pscch_exhaustive;
+  uint64_t num_pscch_attempts;
+  uint64_t num_predicted;
+  uint64_t num_predicted_hits;
+  uint64_t num_shed_pscch;
+  uint64_t num_shed_pssch;
+} rx_chain_t;
+
+int rx_chain_init(rx_chain_t* q, uint32_t idx, cf_t** input, uint32_t nof_ports, srsran_sl_v2x_precfg_freq_t* precfg)
+{
+  // The pool dependent fields of PSCCH and PSSCH only apply to TM1 and TM2
+  srsran_sl_comm_resource_pool_t* sl_comm_resource_pool = &precfg->rx_pools[0];
+
+  q->idx       = idx;
+  q->nof_ports = nof_ports;
+  q->input     = input;
+
+  // One FFT per antenna, the antennas are combined after channel estimation
+  uint32_t sf_n_re = SRSRAN_CP_NSYMB(SRSRAN_CP_NORM) * SRSRAN_NRE * 2 * cell_sl.nof_prb;
+  for (uint32_t p = 0; p < nof_ports; p++) {
+    q->sf_buffer[p] = srsran_vec_cf_malloc(sf_n_re);
+    if (!q->sf_buffer[p]) {
+      perror("malloc");
+      return SRSRAN_ERROR;
+    }
+    // The sidelink demodulator never writes the guard symbol
+    srsran_vec_cf_zero(q->sf_buffer[p], sf_n_re);
+
+    srsran_ofdm_cfg_t ofdm_cfg = {};
+    ofdm_cfg.nof_prb           = cell_sl.nof_prb;
+    ofdm_cfg.cp                = SRSRAN_CP_NORM;
+    ofdm_cfg.rx_window_offset  = 0.0f;
+    ofdm_cfg.normalize         = true;
+    ofdm_cfg.sf_type           = SRSRAN_SF_NORM;
+    ofdm_cfg.freq_shift_f      = -0.5;
+    ofdm_cfg.sidelink          = true;
+    ofdm_cfg.in_buffer         = input[p];
+    ofdm_cfg.out_buffer        = q->sf_buffer[p];
+    if (srsran_ofdm_rx_init_cfg(&q->fft[p], &ofdm_cfg)) {
+      ERROR("Error initiating FFT\n");
+      return SRSRAN_ERROR;
+    }
+  }
+
+  // SCI, the size of the resource indication depends on the pool
+  for (uint32_t i = 0; i < precfg->nof_rx_pools; i++) {
+    srsran_sci_init(&q->sci[i], cell_sl, precfg->rx_pools[i]);
+  }
+
+  // PSCCH
+  if (srsran_pscch_init(&q->pscch, SRSRAN_MAX_PRB) != SRSRAN_SUCCESS) {
+    ERROR("Error in PSCCH init\n");
+    return SRSRAN_ERROR;
+  }
+  if (srsran_pscch_init_batch(&q->pscch) != SRSRAN_SUCCESS) {
+    ERROR("Error in PSCCH batch decoder init\n");
+    return SRSRAN_ERROR;
+  }
+  if (srsran_pscch_set_cell(&q->pscch, cell_sl) != SRSRAN_SUCCESS) {
+    ERROR("Error in PSCCH set cell\n");
+    return SRSRAN_ERROR;
+  }
+  if (srsran_chest_sl_init(&q->pscch_chest, SRSRAN_SIDELINK_PSCCH, cell_sl, *sl_comm_resource_pool) !=
+      SRSRAN_SUCCESS) {
+    ERROR("Error in chest PSCCH init\n");
+    return SRSRAN_ERROR;
+  }
+
+  // PSSCH
+  if (srsran_pssch_init(&q->pssch, cell_sl, *sl_comm_resource_pool) != SRSRAN_SUCCESS) {
+    ERROR("Error initializing PSSCH\n");
+    return SRSRAN_ERROR;
+  }
+  if (srsran_chest_sl_init(&q->pssch_chest, SRSRAN_SIDELINK_PSSCH, cell_sl, *sl_comm_resource_pool) !=
+      SRSRAN_SUCCESS) {
+    ERROR("Error in chest PSSCH init\n");
+    return SRSRAN_ERROR;
+  }
+
+  for (uint32_t i = 0; i < precfg->nof_rx_pools; i++) {
+    if (srsran_ue_sl_reservation_init(&q->reservation[i], precfg->rx_pools[i].num_sub_channel) != SRSRAN_SUCCESS) {
+      ERROR("Error initializing reservation tracker\n");
+      return SRSRAN_ERROR;
+    }
+  }
+
+  return SRSRAN_SUCCESS;
+}
+
+void rx_chain_free(rx_chain_t* q)
+{
+  for (uint32_t p = 0; p < q->nof_ports; p++) {
+    srsran_ofdm_rx_free(&q->fft[p]);
+    if (q->sf_buffer[p]) {
+      free(q->sf_buffer[p]);
+    }
+  }
+  for (uint32_t i = 0; i < SRSRAN_SL_MAX_NOF_RX_POOLS; i++) {
+    srsran_sci_free(&q->sci[i]);
+    srsran_ue_sl_reservation_free(&q->reservation[i]);
+  }
+  srsran_pscch_free(&q->pscch);
+  srsran_chest_sl_free(&q->pscch_chest);
+  srsran_pssch_free(&q->pssch);
+  srsran_chest_sl_free(&q->pssch_chest);
+}
+
+/* Per-subframe decode budget. Work is ordered by expected value and, once the budget is spent, whatever is left is
+ * counted as shed instead of delaying the reception of the next subframe */
+static bool budget_exhausted(const struct timeval* sf_start)
+{
+  if (prog_args.budget_usec == 0) {
+    return false;
+  }
+  struct timeval t[3];
+  t[1] = *sf_start;
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  return (uint32_t)(t[0].tv_sec * 1000000 + t[0].tv_usec) >= prog_args.budget_usec;
+}
+
+/* Estimates, equalizes and demodulates one PSCCH candidate into the batch */
+static void rx_chain_demod_pscch(rx_chain_t* q,
+                                 uint32_t    pool_idx,
+                                 uint32_t    sub_channel_idx,
+                                 uint32_t    cyclic_shift,
+                                 bool        predicted,
+                                 uint32_t    subframe_count)
+{
+  rx_pscch_candidate_t* candidate          = &q->pscch_batch[q->nof_pscch_batch++];
+  srsran_chest_sl_cfg_t pscch_chest_sl_cfg = {};
+  uint32_t              pscch_prb_start_idx =
+      srsran_sl_comm_resource_pool_get_pscch_prb(&sl_precfg.rx_pools[pool_idx], sub_channel_idx);
+
+  q->num_pscch_attempts++;
+  candidate->pool_idx        = pool_idx;
+  candidate->sub_channel_idx = sub_channel_idx;
+  candidate->cyclic_shift    = cyclic_shift;
+  candidate->predicted       = predicted;
+
+  // PSCCH Channel estimation
+  pscch_chest_sl_cfg.cyclic_shift  = cyclic_shift;
+  pscch_chest_sl_cfg.prb_start_idx = pscch_prb_start_idx;
+  pscch_chest_sl_cfg.estimator_alg = prog_args.use_wiener ? SRSRAN_SL_ESTIMATOR_ALG_WIENER : SRSRAN_SL_ESTIMATOR_ALG_LS;
+  srsran_chest_sl_set_cfg(&q->pscch_chest, pscch_chest_sl_cfg);
+  SRSRAN_SL_PROF_START(t_chest);
+  srsran_chest_sl_ls_estimate_equalize_symbols_multi(
+      &q->pscch_chest, q->sf_buffer, q->nof_ports, q->pscch.scfdma_symbols);
+  SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_RX_PSCCH_CHEST, t_chest);
+
+  srsran_pscch_demod_scfdma(&q->pscch, candidate->llr);
+
+  if (SRSRAN_VERBOSE_ISDEBUG()) {
+    char filename[64];
+    snprintf(filename,
+             64,
+             "pscch_rx_syms_ch%d_sf%d_shift%d_prbidx%d.bin",
+             q->idx,
+             subframe_count,
+             cyclic_shift,
+             pscch_prb_start_idx);
+    printf("Saving PSCCH symbols (%d) to %s\n", q->pscch.E / SRSRAN_PSCCH_QM, filename);
+    srsran_vec_save_file(filename, q->pscch.mod_symbols, q->pscch.E / SRSRAN_PSCCH_QM * sizeof(cf_t));
+  }
+}
+
+/* Channel decodes the batched PSCCH candidates together. In candidate order, a decoded SCI is queued for PSSCH
+ * decoding, in priority order, and marks the sub-channels its transmission occupies. Candidates on sub-channels
+ * already taken are dropped, as the one by one search would not have tried them. */
+static void rx_chain_decode_pscch(rx_chain_t* q,
+                                  uint32_t    tti,
+                                  bool        occupied[SRSRAN_SL_MAX_NOF_RX_POOLS][SRSRAN_MAX_NUM_SUB_CHANNEL])
+{
+  int16_t* llr[SRSRAN_VITERBI_BATCH_MAX_FRAMES];
+  uint8_t* c[SRSRAN_VITERBI_BATCH_MAX_FRAMES];
+  bool     crc_ok[SRSRAN_VITERBI_BATCH_MAX_FRAMES] = {};
+  char     sci_msg[SRSRAN_SCI_MSG_MAX_LEN]         = {};
+
+  uint32_t nof_candidates = q->nof_pscch_batch;
+  q->nof_pscch_batch      = 0;
+  for (uint32_t k = 0; k < nof_candidates; k++) {
+    llr[k] = q->pscch_batch[k].llr;
+    c[k]   = q->pscch_batch[k].c;
+  }
+  if (srsran_pscch_decode_batch(&q->pscch, llr, c, crc_ok, nof_candidates) < SRSRAN_SUCCESS) {
+    return;
+  }
+
+  for (uint32_t k = 0; k < nof_candidates; k++) {
+    rx_pscch_candidate_t* candidate       = &q->pscch_batch[k];
+    uint32_t              pool_idx        = candidate->pool_idx;
+    uint32_t              sub_channel_idx = candidate->sub_channel_idx;
+    srsran_sci_t*         sci             = &q->sci[pool_idx];
+    if (occupied[pool_idx][sub_channel_idx]) {
+      continue;
+    }
+    if (candidate->predicted) {
+      q->num_predicted++;
+    }
+    if (!crc_ok[k] || srsran_sci_format1_unpack(sci, candidate->c) != SRSRAN_SUCCESS) {
+      continue;
+    }
+    SRSRAN_SL_PROF_START(t_log);
+    srsran_sci_info(sci, sci_msg, sizeof(sci_msg));
+    fprintf(stdout, "%s", sci_msg);
+    SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_RX_LOG, t_log);
+
+    q->num_decoded_sci++;
+    q->num_predicted_hits += candidate->predicted;
+
+    uint32_t sub_channel_start_idx = 0;
+    uint32_t L_subCH               = 0;
+    srsran_ra_sl_type0_from_riv(sci->riv, sci->num_sub_channel, &L_subCH, &sub_channel_start_idx);
+    uint32_t nof_sub_channels = SRSRAN_MAX(L_subCH, 1);
+
+    // The received CRC gives the PSSCH scrambling identity
+    uint32_t N_x_id = 0;
+    for (int j = 0; j < SRSRAN_SCI_CRC_LEN; j++) {
+      N_x_id += candidate->c[q->pscch.sci_len + j] * exp2(SRSRAN_SCI_CRC_LEN - 1 - j);
+    }
+
+    // Lower values have higher priority, equal priorities keep the decoding order
+    uint32_t i = q->nof_pending++;
+    while (i > 0 && q->pending[i - 1].sci.priority > sci->priority) {
+      q->pending[i] = q->pending[i - 1];
+      i--;
+    }
+    q->pending[i].sci             = *sci;
+    q->pending[i].pool_idx        = pool_idx;
+    q->pending[i].sub_channel_idx = sub_channel_idx;
+    q->pending[i].N_x_id          = N_x_id;
+
+    srsran_ue_sl_reservation_add(&q->reservation[pool_idx], sci, tti, sub_channel_idx, candidate->cyclic_shift);
+    for (uint32_t n = 0; n < nof_sub_channels && sub_channel_idx + n < SRSRAN_MAX_NUM_SUB_CHANNEL; n++) {
+      occupied[pool_idx][sub_channel_idx + n] = true;
+    }
+  }
+}
+
+/* PSSCH allocation of a queued SCI, 3GPP TS 36.213 Section 14.1.1.4C */
+static void rx_chain_pssch_alloc(const rx_pending_t* pending, uint32_t* prb_start_idx, uint32_t* nof_prb)
+{
+  srsran_sl_comm_resource_pool_t* sl_comm_resource_pool = &sl_precfg.rx_pools[pending->pool_idx];
+  uint32_t                        sub_channel_start_idx = 0;
+  uint32_t                        L_subCH               = 0;
+  srsran_ra_sl_type0_from_riv(
+      pending->sci.riv, sl_comm_resource_pool->num_sub_channel, &L_subCH, &sub_channel_start_idx);
+  srsran_sl_comm_resource_pool_get_pssch_prb(
+      sl_comm_resource_pool, pending->sub_channel_idx, L_subCH, prb_start_idx, nof_prb);
+
+  // make sure PRBs are valid for DFT precoding
+  *nof_prb = srsran_dft_precoding_get_valid_prb(*nof_prb);
+}
+
+/* Publishes a queued SCI in the export ring, with the decoded transport block packed in bytes */
+static void rx_chain_export(rx_chain_t*         q,
+                            const rx_pending_t* pending,
+                            uint32_t            current_sf_idx,
+                            srsran_timestamp_t* rx_timestamp,
+                            const uint8_t*      tb_packed,
+                            uint8_t             flags)
+{
+  if (sl_export.map == NULL) {
+    return;
+  }
+
+  uint8_t*                   tb_bytes = NULL;
+  srsran_sl_export_record_t* record   = srsran_sl_export_begin(&sl_export, &tb_bytes);
+  record->timestamp_us                = (uint64_t)round(srsran_timestamp_real(rx_timestamp) * 1e6);
+  record->channel_idx                 = q->idx;
+  record->sf_idx                      = current_sf_idx;
+  record->sub_channel_idx             = pending->sub_channel_idx;
+  rx_chain_pssch_alloc(pending, &record->prb_start_idx, &record->nof_prb);
+  record->N_x_id              = pending->N_x_id;
+  record->priority            = (uint8_t)pending->sci.priority;
+  record->resource_reserv     = (uint8_t)pending->sci.resource_reserv;
+  record->time_gap            = (uint8_t)pending->sci.time_gap;
+  record->mcs_idx             = (uint8_t)pending->sci.mcs_idx;
+  record->rv_idx              = pending->sci.retransmission ? 1 : 0;
+  record->retransmission      = pending->sci.retransmission;
+  record->transmission_format = (uint8_t)pending->sci.transmission_format;
+  record->flags               = flags;
+  record->riv                 = (uint16_t)pending->sci.riv;
+  record->reserved            = 0;
+  record->rsrp_db             = NAN;
+  record->snr_db              = NAN;
+  record->tb_len              = 0;
+
+  if (!(flags & SRSRAN_SL_EXPORT_TB_SHED)) {
+    // The noise estimate of a clean signal can come out slightly negative
+    float rsrp      = q->pssch_chest.rsrp_corr;
+    float noise     = q->pssch_chest.noise_estimated;
+    record->rsrp_db = srsran_convert_power_to_dB(rsrp);
+    record->snr_db  = noise > 0.0f ? srsran_convert_power_to_dB(rsrp / noise) : INFINITY;
+  }
+  if (flags & SRSRAN_SL_EXPORT_TB_OK) {
+    record->tb_len = SRSRAN_MIN(q->pssch.sl_sch_tb_len / 8, sl_export.header->max_tb_bytes);
+    memcpy(tb_bytes, tb_packed, record->tb_len);
+  }
+  srsran_sl_export_commit(&sl_export);
+}
+
+/* Decodes the PSSCH a queued SCI points to */
+static void rx_chain_decode_pssch(rx_chain_t*         q,
+                                  const rx_pending_t* pending,
+                                  uint32_t            current_sf_idx,
+                                  srsran_timestamp_t* rx_timestamp,
+                                  FILE*               logfile)
+{
+  uint8_t               tb[SRSRAN_SL_SCH_MAX_TB_LEN]            = {};
+  uint8_t               tb_packed[SRSRAN_SL_SCH_MAX_TB_LEN / 8] = {};
+  srsran_chest_sl_cfg_t pssch_chest_sl_cfg                      = {};
+  uint32_t              N_x_id                       = pending->N_x_id;
+
+  uint32_t pssch_prb_start_idx = 0;
+  uint32_t nof_prb_pssch       = 0;
+  rx_chain_pssch_alloc(pending, &pssch_prb_start_idx, &nof_prb_pssch);
+
+  uint32_t rv_idx = 0;
+  if (pending->sci.retransmission == true) {
+    rv_idx = 1;
+  }
+
+  // PSSCH Channel estimation
+  pssch_chest_sl_cfg.N_x_id        = N_x_id;
+  pssch_chest_sl_cfg.sf_idx        = current_sf_idx;
+  pssch_chest_sl_cfg.prb_start_idx = pssch_prb_start_idx;
+  pssch_chest_sl_cfg.nof_prb       = nof_prb_pssch;
+  pssch_chest_sl_cfg.estimator_alg = prog_args.use_wiener ? SRSRAN_SL_ESTIMATOR_ALG_WIENER : SRSRAN_SL_ESTIMATOR_ALG_LS;
+  srsran_chest_sl_set_cfg(&q->pssch_chest, pssch_chest_sl_cfg);
+  SRSRAN_SL_PROF_START(t_chest);
+  srsran_chest_sl_ls_estimate_equalize_symbols_multi(
+      &q->pssch_chest, q->sf_buffer, q->nof_ports, q->pssch.scfdma_symbols);
+  SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_RX_PSSCH_CHEST, t_chest);
+
+  uint8_t            flags     = 0;
+  srsran_pssch_cfg_t pssch_cfg = {
+      pssch_prb_start_idx, nof_prb_pssch, N_x_id, pending->sci.mcs_idx, rv_idx, current_sf_idx};
+  if (srsran_pssch_set_cfg(&q->pssch, pssch_cfg) == SRSRAN_SUCCESS) {
+    if (srsran_pssch_decode_scfdma(&q->pssch, tb, SRSRAN_SL_SCH_MAX_TB_LEN) == SRSRAN_SUCCESS) {
+      q->num_decoded_tb++;
+      flags = SRSRAN_SL_EXPORT_TB_OK;
+
+      // The MAC PDU is parsed in place, the export ring takes the same bytes
+      uint64_t rx_timestamp_us = (uint64_t)round(srsran_timestamp_real(rx_timestamp) * 1e6);
+      srsran_bit_pack_vector(tb, tb_packed, q->pssch.sl_sch_tb_len);
+      srsran_sl_sch_rx_set_time(sl_sch_rx, rx_timestamp_us);
+      srsran_sl_sch_rx_parse(sl_sch_rx, tb_packed, q->pssch.sl_sch_tb_len / 8);
+
+      // write logfile
+      SRSRAN_SL_PROF_START(t_log);
+      fprintf(logfile,
+              "%lu,%d,%d,%d,%d,%d,%d,%d,0,0\n",
+              rx_timestamp_us,
+              pssch_prb_start_idx,
+              nof_prb_pssch,
+              N_x_id,
+              pending->sci.mcs_idx,
+              rv_idx,
+              current_sf_idx,
+              q->idx);
+      SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_RX_LOG, t_log);
+    } else {
+      q->num_crc_fail++;
+    }
+  }
+  rx_chain_export(q, pending, current_sf_idx, rx_timestamp, tb_packed, flags);
+}
+
+/* Candidates predicted for subframe tti in the given pools, highest priority first across pools */
+static uint32_t rx_chain_predict(rx_chain_t* q, const uint32_t* pools, uint32_t nof_pools, uint32_t tti)
+{
+  uint32_t                 nof_candidates = 0;
+  srsran_ue_sl_candidate_t pool_candidates[SRSRAN_MAX_NUM_SUB_CHANNEL];
+  for (uint32_t p = 0; p < nof_pools; p++) {
+    uint32_t n = srsran_ue_sl_reservation_get(&q->reservation[pools[p]], tti, pool_candidates);
+    for (uint32_t k = 0; k < n; k++) {
+      // Equal priorities keep the pool order
+      uint32_t i = nof_candidates++;
+      while (i > 0 && q->candidates[i - 1].priority > pool_candidates[k].priority) {
+        q->candidates[i]     = q->candidates[i - 1];
+        q->candidate_pool[i] = q->candidate_pool[i - 1];
+        i--;
+      }
+      q->candidates[i]     = pool_candidates[k];
+      q->candidate_pool[i] = pools[p];
+    }
+  }
+  return nof_candidates;
+}
+
+/* Searches all PSCCH candidates of the received subframe and queues the decoded SCIs. The resources reserved by
+ * earlier SCIs are tried first, with the cyclic shift their sender used, then the remaining candidates are searched
+ * blindly. The candidates are demodulated one by one and channel decoded in batches; the predicted ones form batches
+ * of their own, so the sub-channels taken by their transmissions are not searched any further. Only the RX pools the
+ * subframe belongs to are searched, and a subframe in none of them is not even transformed. The subframe is counted
+ * from DFN 0 without wrapping at the DFN period, so that reservations made before the wrap are still found after it. */
+void rx_chain_search(rx_chain_t* q, uint64_t sl_tti, uint32_t subframe_count, const struct timeval* sf_start)
+{
+  q->nof_pending     = 0;
+  q->nof_pscch_batch = 0;
+  q->sf_shed_pscch   = 0;
+  q->sf_shed_pssch   = 0;
+  q->num_subframes++;
+
+  // the reservation horizon divides 2^32, so the truncated count keeps the reservation slots in phase
+  uint32_t tti       = (uint32_t)sl_tti;
+  uint32_t dfn_sf    = (uint32_t)(sl_tti % SRSRAN_SL_DFN_PERIOD);
+  uint32_t pools[SRSRAN_SL_MAX_NOF_RX_POOLS];
+  uint32_t nof_pools = 0;
+  uint32_t nof_blind = 0;
+  for (uint32_t p = 0; p < sl_precfg.nof_rx_pools; p++) {
+    if (srsran_sl_comm_resource_pool_sf_in_pool(&sl_precfg.rx_pools[p], dfn_sf)) {
+      pools[nof_pools++] = p;
+      nof_blind += sl_precfg.rx_pools[p].num_sub_channel * SL_NOF_CYCLIC_SHIFTS;
+    }
+  }
+  if (nof_pools == 0) {
+    q->num_skipped_subframes++;
+    return;
+  }
+  q->num_pscch_exhaustive += nof_blind;
+
+  // do FFT on every port
+  SRSRAN_SL_PROF_START(t_fft);
+  for (uint32_t p = 0; p < q->nof_ports; p++) {
+    q->fft[p].cfg.in_buffer = q->input[p];
+    srsran_ofdm_rx_sf(&q->fft[p]);
+  }
+  SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_RX_FFT, t_fft);
+
+  uint32_t nof_candidates = prog_args.use_prediction ? rx_chain_predict(q, pools, nof_pools, tti) : 0;
+
+  // Predicted candidates first, followed by the blind search over all sub-channels and cyclic shifts of every pool
+  bool tried[SRSRAN_SL_MAX_NOF_RX_POOLS][SRSRAN_MAX_NUM_SUB_CHANNEL][SL_NOF_CYCLIC_SHIFTS] = {};
+  bool occupied[SRSRAN_SL_MAX_NOF_RX_POOLS][SRSRAN_MAX_NUM_SUB_CHANNEL]                    = {};
+  bool shedding                                                                            = false;
+  for (uint32_t k = 0; k < nof_candidates + nof_blind; k++) {
+    bool     predicted = k < nof_candidates;
+    uint32_t pool_idx, sub_channel_idx, cyclic_shift;
+    if (predicted) {
+      pool_idx        = q->candidate_pool[k];
+      sub_channel_idx = q->candidates[k].sub_channel_idx;
+      cyclic_shift    = q->candidates[k].cyclic_shift;
+    } else {
+      uint32_t b = k - nof_candidates;
+      uint32_t p = 0;
+      while (b >= sl_precfg.rx_pools[pools[p]].num_sub_channel * SL_NOF_CYCLIC_SHIFTS) {
+        b -= sl_precfg.rx_pools[pools[p]].num_sub_channel * SL_NOF_CYCLIC_SHIFTS;
+        p++;
+      }
+      pool_idx        = pools[p];
+      sub_channel_idx = b / SL_NOF_CYCLIC_SHIFTS;
+      cyclic_shift    = (b % SL_NOF_CYCLIC_SHIFTS) * 3;
+    }
+    if (k == nof_candidates && q->nof_pscch_batch > 0) {
+      rx_chain_decode_pscch(q, tti, occupied);
+    }
+    if (occupied[pool_idx][sub_channel_idx] || tried[pool_idx][sub_channel_idx][cyclic_shift / 3]) {
+      continue;
+    }
+    tried[pool_idx][sub_channel_idx][cyclic_shift / 3] = true;
+
+    shedding = shedding || budget_exhausted(sf_start);
+    if (shedding) {
+      q->sf_shed_pscch++;
+      continue;
+    }
+
+    rx_chain_demod_pscch(q, pool_idx, sub_channel_idx, cyclic_shift, predicted, subframe_count);
+    if (q->nof_pscch_batch == SRSRAN_VITERBI_BATCH_MAX_FRAMES) {
+      rx_chain_decode_pscch(q, tti, occupied);
+    }
+  }
+  if (q->nof_pscch_batch > 0) {
+    rx_chain_decode_pscch(q, tti, occupied);
+  }
+}
+
+/* Decodes the PSSCH of the SCIs queued by all channels, highest priority first across channels, as long as the
+ * budget allows. Subframes with shed work get a log line of their own carrying the counts. */
+void rx_chains_decode_pssch(rx_chain_t*           chains,
+                            uint32_t              nof_chains,
+                            uint32_t              current_sf_idx,
+                            srsran_timestamp_t*   rx_timestamp,
+                            const struct timeval* sf_start,
+                            FILE*                 logfile)
+{
+  uint32_t next[SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
+  bool     shedding                              = false;
+
+  while (true) {
+    rx_chain_t* q = NULL;
+    for (uint32_t k = 0; k < nof_chains; k++) {
+      rx_chain_t* c = &chains[k];
+      if (next[k] < c->nof_pending &&
+          (q == NULL || c->pending[next[k]].sci.priority < q->pending[next[q->idx]].sci.priority)) {
+        q = c;
+      }
+    }
+    if (q == NULL) {
+      break;
+    }
+
+    const rx_pending_t* pending = &q->pending[next[q->idx]++];
+    shedding                    = shedding || budget_exhausted(sf_start);
+    if (shedding) {
+      q->sf_shed_pssch++;
+      rx_chain_export(q, pending, current_sf_idx, rx_timestamp, NULL, SRSRAN_SL_EXPORT_TB_SHED);
+      continue;
+    }
+    rx_chain_decode_pssch(q, pending, current_sf_idx, rx_timestamp, logfile);
+  }
+
+  for (uint32_t k = 0; k < nof_chains; k++) {
+    rx_chain_t* q = &chains[k];
+    if (q->sf_shed_pscch == 0 && q->sf_shed_pssch == 0) {
+      continue;
+    }
+    q->num_shed_pscch += q->sf_shed_pscch;
+    q->num_shed_pssch += q->sf_shed_pssch;
+    fprintf(logfile,
+            "%lu,,,,,,%d,%d,%d,%d\n",
+            (uint64_t)round(srsran_timestamp_real(rx_timestamp) * 1e6),
+            current_sf_idx,
+            q->idx,
+            q->sf_shed_pscch,
+            q->sf_shed_pssch);
+  }
+}
+
+/* Commits the subframe ue_sync received into the capture ring, with the SCIs decoded and the PSSCH CRCs failed in it,
+ * and points the receive buffers at the next slot */
+void iq_capture_subframe(cf_t** rx_buffer, srsran_ue_sync_t* ue_sync, rx_chain_t* chains, bool synced)
+{
+  static uint32_t last_sci      = 0;
+  static uint32_t last_crc_fail = 0;
+
+  uint32_t nof_sci = 0, nof_crc_fail = 0;
+  for (uint32_t k = 0; k < prog_args.nof_channels; k++) {
+    nof_sci += chains[k].num_decoded_sci;
+    nof_crc_fail += chains[k].num_crc_fail;
+  }
+  srsran_iq_capture_sf_stats_t s = {nof_sci - last_sci, nof_crc_fail - last_crc_fail, synced};
+  srsran_iq_capture_commit(&iq_capture, &ue_sync->last_timestamp, &s);
+  last_sci      = nof_sci;
+  last_crc_fail = nof_crc_fail;
+
+  for (uint32_t p = 0; p < prog_args.nof_rx_antennas; p++) {
+    rx_buffer[p] = srsran_iq_capture_slot(&iq_capture, p);
+  }
+
+  // A negative time offset keeps the first samples of the buffer, which are the last ones of the previous subframe
+  if (ue_sync->next_rf_sample_offset < 0) {
+    uint32_t n = (uint32_t)-ue_sync->next_rf_sample_offset;
+    for (uint32_t p = 0; p < prog_args.nof_rx_antennas; p++) {
+      srsran_vec_cf_copy(rx_buffer[p], srsran_iq_capture_last(&iq_capture, p) + ue_sync->frame_len - n, n);
+    }
+  }
+}
+
+/* One line per source that sent sequence headers, counted since the start */
+void print_seq_summary()
+{
+  const srsran_sl_sch_src_stats_t* src_stats   = NULL;
+  uint32_t                         nof_sources = srsran_sl_sch_rx_get_stats(sl_sch_rx, &src_stats);
+  for (uint32_t i = 0; i < nof_sources; i++) {
+    const srsran_sl_sch_src_stats_t* s = &src_stats[i];
+    if (s->nof_seq == 0) {
+      continue;
+    }
+    printf("SEQ: SRC=0x%06x GEN=%d rx=%" PRIu64 " lost=%" PRIu64 " (%.2f%%) reordered=%" PRIu64 " dup=%" PRIu64
+           " latency_us min=%" PRId64 " mean=%.1f p50=%" PRId64 " p99=%" PRId64 " max=%" PRId64 "\n",
+           s->src_id,
+           s->gen_id,
+           s->nof_seq,
+           s->nof_lost,
+           100.0 * s->nof_lost / (s->nof_seq + s->nof_lost),
+           s->nof_reordered,
+           s->nof_duplicated,
+           s->lat_min_us,
+           (double)s->lat_sum_us / s->nof_seq,
+           srsran_sl_sch_rx_get_lat_percentile(sl_sch_rx, s, 0.5f),
+           srsran_sl_sch_rx_get_lat_percentile(sl_sch_rx, s, 0.99f),
+           s->lat_max_us);
+  }
+  fflush(stdout);
+}
+
 int main(int argc, char** argv)
 {
   signal(SIGINT, sig_int_handler);
@@ -185,8 +1159,18 @@ int main(int argc, char** argv)
   sigaddset(&sigset, SIGINT);
   sigprocmask(SIG_UNBLOCK, &sigset, NULL);
 
-  uint32_t num_decoded_sci = 0;
-  uint32_t num_decoded_tb  = 0;
+  uint32_t num_decoded_sci    = 0;
+  uint32_t num_decoded_tb     = 0;
+  uint32_t num_subframes      = 0;
+  uint64_t num_pscch_attempts = 0;
+  uint64_t num_predicted      = 0;
+  uint64_t num_predicted_hits = 0;
+  uint64_t num_shed_pscch     = 0;
+  uint64_t num_shed_pssch     = 0;
+  uint64_t nof_exhaustive     = 0;
+  uint32_t num_skipped        = 0;
+  uint64_t decode_usec        = 0;
+  uint64_t decode_usec_max    = 0;
 
   parse_args(&prog_args, argc, argv);
 
@@ -224,39 +1208,54 @@ int main(int argc, char** argv)
     free(path);
   }
 
-  // write header
-  fprintf(logfile, "rx_timestamp_us,prb_start_idx,nof_prb,N_x_id,mcs_idx,rv_idx,sf_idx\n");
-
-  /***** Init *******/
-  srsran_use_standard_symbol_size(prog_args.use_standard_lte_rates);
-
-  srsran_sl_comm_resource_pool_t sl_comm_resource_pool;
-  if (srsran_sl_comm_resource_pool_get_default_config(&sl_comm_resource_pool, cell_sl) != SRSRAN_SUCCESS) {
-    ERROR("Error initializing sl_comm_resource_pool\n");
-    return SRSRAN_ERROR;
+  if (prog_args.export_file_name &&
+      srsran_sl_export_init(
+          &sl_export, prog_args.export_file_name, SL_EXPORT_NOF_RECORDS, SRSRAN_SL_SCH_MAX_TB_LEN / 8) !=
+          SRSRAN_SUCCESS) {
+    ERROR("Error creating export ring %s\n", prog_args.export_file_name);
+    exit(-1);
   }
 
+  sl_sch_rx = srsran_sl_sch_rx_init(SL_SCH_MAX_SOURCES);
+  if (sl_sch_rx && prog_args.seq_period_s > 0) {
+    srsran_sl_sch_rx_enable_seq(sl_sch_rx, SL_SCH_LAT_BIN_US);
+  }
+  if (!sl_sch_rx) {
+    ERROR("Error initiating SL-SCH parser\n");
+    exit(-1);
+  }
 
-  printf("Opening RF device...\n");
-
-  if (srsran_rf_open_multi(&radio, prog_args.rf_args, prog_args.nof_rx_antennas)) {
-    ERROR("Error opening rf\n");
+  if (prog_args.prof_file_name && srsran_sl_prof_publish_init(prog_args.prof_file_name) != SRSRAN_SUCCESS) {
+    ERROR("Error creating latency file %s\n", prog_args.prof_file_name);
     exit(-1);
   }
 
-  printf("Set RX freq: %.6f MHz\n",
-         srsran_rf_set_rx_freq(&radio, prog_args.nof_rx_antennas, prog_args.rf_freq) / 1e6);
-  printf("Set RX gain: %.1f dB\n", srsran_rf_set_rx_gain(&radio, prog_args.rf_gain));
-  int srate = srsran_sampling_freq_hz(cell_sl.nof_prb);
+  // write header
+  fprintf(logfile,
+          "rx_timestamp_us,prb_start_idx,nof_prb,N_x_id,mcs_idx,rv_idx,sf_idx,channel_idx,shed_pscch,shed_pssch\n");
 
-  if (srate != -1) {
-    printf("Setting sampling rate %.2f MHz\n", (float)srate / 1000000);
-    float srate_rf = srsran_rf_set_rx_srate(&radio, (double)srate);
-    if (srate_rf != srate) {
-      ERROR("Could not set sampling rate\n");
+  /***** Init *******/
+  srsran_use_standard_symbol_size(prog_args.use_standard_lte_rates);
+
+  if (prog_args.pool_file_name) {
+    if (srsran_sl_v2x_precfg_freq_read_file(&sl_precfg, cell_sl, prog_args.pool_file_name) != SRSRAN_SUCCESS ||
+        sl_precfg.nof_rx_pools == 0) {
+      ERROR("Error reading RX resource pools from %s\n", prog_args.pool_file_name);
       exit(-1);
     }
   } else {
+    srsran_sl_comm_resource_pool_t* sl_comm_resource_pool = &sl_precfg.rx_pools[0];
+    if (srsran_sl_comm_resource_pool_get_default_config(sl_comm_resource_pool, cell_sl) != SRSRAN_SUCCESS) {
+      ERROR("Error initializing sl_comm_resource_pool\n");
+      return SRSRAN_ERROR;
+    }
+    sl_comm_resource_pool->num_sub_channel  = prog_args.num_sub_channel;
+    sl_comm_resource_pool->size_sub_channel = prog_args.size_sub_channel;
+    sl_precfg.nof_rx_pools                  = 1;
+  }
+
+  int srate = srsran_sampling_freq_hz(cell_sl.nof_prb);
+  if (srate == -1) {
     ERROR("Invalid number of PRB %d\n", cell_sl.nof_prb);
     exit(-1);
   }
@@ -265,86 +1264,119 @@ int main(int argc, char** argv)
   uint32_t sf_len = SRSRAN_SF_LEN_PRB(cell_sl.nof_prb);
   printf("Using a SF len of %d samples\n", sf_len);
 
-  cf_t* rx_buffer[SRSRAN_MAX_CHANNELS] = {};     //< For radio to receive samples
-  cf_t* sf_buffer[SRSRAN_MAX_PORTS]    = {NULL}; ///< For OFDM object to store subframe after FFT
+  // Several channels are received at once by capturing a wider band and channelizing it
+  static wideband_rx_t wideband = {};
+  double               srate_rf = srate;
+  if (prog_args.nof_channels > 1 && wideband_rx_init(&wideband, sf_len, srate, &srate_rf)) {
+    ERROR("Error initiating wideband capture\n");
+    exit(-1);
+  }
 
-  for (int i = 0; i < prog_args.nof_rx_antennas; i++) {
-    rx_buffer[i] = srsran_vec_cf_malloc(sf_len);
-    if (!rx_buffer[i]) {
-      perror("malloc");
-      exit(-1);
+  // Samples come from the radio or, for offline processing, from a file
+  static file_rx_t          file_rx        = {};
+  recv_callback_t           recv           = NULL;
+  start_rx_timed_callback_t start_rx_timed = NULL;
+  void*                     stream         = NULL;
+  if (prog_args.input_file_name) {
+    char* save_ptr = NULL;
+    for (char* name = strtok_r(prog_args.input_file_name, ",", &save_ptr); name != NULL;
+         name       = strtok_r(NULL, ",", &save_ptr)) {
+      size_t            len  = strlen(name);
+      srsran_datatype_t type = SRSRAN_COMPLEX_FLOAT_BIN;
+      if (len > 4 && strcmp(name + len - 4, ".bfp") == 0) {
+        type = SRSRAN_COMPLEX_BFP8_BIN;
+      }
+      if (file_rx.nof_files == SRSRAN_MAX_PORTS ||
+          srsran_filesource_init(&file_rx.fsrc[file_rx.nof_files], name, type)) {
+        ERROR("Error opening file %s\n", name);
+        exit(-1);
+      }
+      file_rx.nof_files++;
     }
-    sf_buffer[i] = srsran_vec_cf_malloc(sf_len);
-    if (!sf_buffer[i]) {
-      perror("malloc");
+    if (file_rx.nof_files != prog_args.nof_rx_antennas) {
+      ERROR("One input file per antenna is needed, got %d for %d antennas\n",
+            file_rx.nof_files,
+            prog_args.nof_rx_antennas);
       exit(-1);
     }
-  }
-
-  uint32_t sf_n_re             = SRSRAN_CP_NSYMB(SRSRAN_CP_NORM) * SRSRAN_NRE * 2 * cell_sl.nof_prb;
-  cf_t*    equalized_sf_buffer = srsran_vec_malloc(sizeof(cf_t) * sf_n_re);
+    file_rx.srate  = srate_rf;
+    recv           = file_recv;
+    start_rx_timed = file_start_rx_timed;
+    stream         = &file_rx;
+  } else {
+    printf("Opening RF device...\n");
 
-  // RX
-  srsran_ofdm_t     fft[SRSRAN_MAX_PORTS];
-  srsran_ofdm_cfg_t ofdm_cfg = {};
-  ofdm_cfg.nof_prb           = cell_sl.nof_prb;
-  ofdm_cfg.cp                = SRSRAN_CP_NORM;
-  ofdm_cfg.rx_window_offset  = 0.0f;
-  ofdm_cfg.normalize         = true;
-  ofdm_cfg.sf_type           = SRSRAN_SF_NORM;
-  ofdm_cfg.freq_shift_f      = -0.5;
-  for (int i = 0; i < prog_args.nof_rx_antennas; i++) {
-    ofdm_cfg.in_buffer  = rx_buffer[0];
-    ofdm_cfg.out_buffer = sf_buffer[0];
-
-    if (srsran_ofdm_rx_init_cfg(&fft[i], &ofdm_cfg)) {
-      ERROR("Error initiating FFT\n");
+    if (srsran_rf_open_multi(&radio, prog_args.rf_args, prog_args.nof_rx_antennas)) {
+      ERROR("Error opening rf\n");
       exit(-1);
     }
-  }
 
-  // SCI
-  srsran_sci_t sci;
-  srsran_sci_init(&sci, cell_sl, sl_comm_resource_pool);
-  uint8_t sci_rx[SRSRAN_SCI_MAX_LEN]      = {};
-  char    sci_msg[SRSRAN_SCI_MSG_MAX_LEN] = {};
-
-  // init PSCCH object
-  static srsran_pscch_t pscch = {};
-  if (srsran_pscch_init(&pscch, SRSRAN_MAX_PRB) != SRSRAN_SUCCESS) {
-    ERROR("Error in PSCCH init\n");
-    return SRSRAN_ERROR;
+    printf("Set RX freq: %.6f MHz\n",
+           srsran_rf_set_rx_freq(&radio, prog_args.nof_rx_antennas, prog_args.rf_freq) / 1e6);
+    printf("Set RX gain: %.1f dB\n", srsran_rf_set_rx_gain(&radio, prog_args.rf_gain));
+    printf("Setting sampling rate %.2f MHz\n", srate_rf / 1000000);
+    double srate_set = srsran_rf_set_rx_srate(&radio, srate_rf);
+    if (srate_set != srate_rf) {
+      ERROR("Could not set sampling rate\n");
+      exit(-1);
+    }
+    recv           = srsran_rf_recv_wrapper;
+    start_rx_timed = srsran_rf_start_rx_timed_wrapper;
+    stream         = &radio;
   }
 
-  if (srsran_pscch_set_cell(&pscch, cell_sl) != SRSRAN_SUCCESS) {
-    ERROR("Error in PSCCH set cell\n");
-    return SRSRAN_ERROR;
+  if (prog_args.nof_channels > 1) {
+    wideband.recv           = recv;
+    wideband.start_rx_timed = start_rx_timed;
+    wideband.h              = stream;
+    recv                    = wideband_recv;
+    start_rx_timed          = wideband_start_rx_timed;
+    stream                  = &wideband;
   }
 
-  // PSCCH Channel estimation
-  srsran_chest_sl_cfg_t pscch_chest_sl_cfg = {};
-  srsran_chest_sl_t     pscch_chest        = {};
-  if (srsran_chest_sl_init(&pscch_chest, SRSRAN_SIDELINK_PSCCH, cell_sl, sl_comm_resource_pool) != SRSRAN_SUCCESS) {
-    ERROR("Error in chest PSCCH init\n");
-    return SRSRAN_ERROR;
+  cf_t* rx_buffer[SRSRAN_MAX_CHANNELS] = {}; //< For radio to receive samples
+
+  // With the IQ capture, every subframe is received into the next slot of its ring
+  if (prog_args.capture_prefix) {
+    srsran_iq_capture_cfg_t capture_cfg;
+    srsran_iq_capture_cfg_default(&capture_cfg);
+    capture_cfg.nof_ports = prog_args.nof_rx_antennas;
+    capture_cfg.sf_len    = sf_len;
+    capture_cfg.srate     = srate;
+    if (srsran_iq_capture_cfg_parse(&capture_cfg, prog_args.capture_spec) ||
+        srsran_iq_capture_init(&iq_capture, &capture_cfg, prog_args.capture_prefix)) {
+      ERROR("Error initiating IQ capture %s\n", prog_args.capture_prefix);
+      exit(-1);
+    }
+    for (int i = 0; i < prog_args.nof_rx_antennas; i++) {
+      rx_buffer[i] = srsran_iq_capture_slot(&iq_capture, i);
+    }
+    signal(SIGUSR1, sig_usr1_handler);
+    printf("IQ capture: %.1f s of history, %d ms before and %d ms after a trigger\n",
+           capture_cfg.history_sf / 1000.0,
+           capture_cfg.pre_sf,
+           capture_cfg.post_sf);
   }
 
-  // init PSSCH object
-  static srsran_pssch_t pssch = {};
-  if (srsran_pssch_init(&pssch, cell_sl, sl_comm_resource_pool) != SRSRAN_SUCCESS) {
-    ERROR("Error initializing PSSCH\n");
-    return SRSRAN_ERROR;
+  for (int i = 0; i < prog_args.nof_rx_antennas && !prog_args.capture_prefix; i++) {
+    rx_buffer[i] = srsran_vec_cf_malloc(sf_len);
+    if (!rx_buffer[i]) {
+      perror("malloc");
+      exit(-1);
+    }
   }
 
-  srsran_chest_sl_cfg_t pssch_chest_sl_cfg = {};
-  srsran_chest_sl_t     pssch_chest        = {};
-  if (srsran_chest_sl_init(&pssch_chest, SRSRAN_SIDELINK_PSSCH, cell_sl, sl_comm_resource_pool) != SRSRAN_SUCCESS) {
-    ERROR("Error in chest PSSCH init\n");
-    return SRSRAN_ERROR;
+  // One decoder per channel. With a single channel, the subframe is decoded from the ue_sync buffers of every antenna
+  static rx_chain_t chains[SRSRAN_CHANNELIZER_MAX_CHANNELS] = {};
+  for (uint32_t k = 0; k < prog_args.nof_channels; k++) {
+    cf_t**   input     = (prog_args.nof_channels > 1) ? &wideband.history[k] : rx_buffer;
+    uint32_t nof_ports = (prog_args.nof_channels > 1) ? 1 : prog_args.nof_rx_antennas;
+    if (rx_chain_init(&chains[k], k, input, nof_ports, &sl_precfg)) {
+      ERROR("Error initiating decoder for channel %d\n", k);
+      exit(-1);
+    }
   }
 
-  uint8_t tb[SRSRAN_SL_SCH_MAX_TB_LEN] = {};
-
   srsran_ue_sync_t ue_sync = {};
   srsran_cell_t cell = {};
   cell.nof_prb       = cell_sl.nof_prb;
@@ -354,26 +1386,35 @@ int main(int argc, char** argv)
   if (srsran_ue_sync_init_multi_decim_mode(&ue_sync,
                                            cell.nof_prb,
                                            false,
-                                           srsran_rf_recv_wrapper,
+                                           recv,
                                            prog_args.nof_rx_antennas,
-                                           (void*)&radio,
+                                           stream,
                                            1,
-                                           SYNC_MODE_GNSS)) {
-    fprintf(stderr, "Error initiating sync_gnss\n");
+                                           prog_args.use_slss_sync ? SYNC_MODE_SLSS : SYNC_MODE_GNSS)) {
+    fprintf(stderr, "Error initiating ue_sync\n");
     exit(-1);
   }
 
-  if (srsran_ue_sync_set_cell(&ue_sync, cell)) {
+  // align to the GNSS second boundary by starting the stream at that time, if the radio supports it
+  srsran_ue_sync_set_start_rx_timed_callback(&ue_sync, start_rx_timed);
+
+  if (prog_args.use_slss_sync) {
+    if (srsran_ue_sync_set_cell_sl(&ue_sync, cell_sl)) {
+      ERROR("Error initiating ue_sync\n");
+      exit(-1);
+    }
+  } else if (srsran_ue_sync_set_cell(&ue_sync, cell)) {
     ERROR("Error initiating ue_sync\n");
     exit(-1);
   }
 
-  srsran_rf_start_rx_stream(&radio, false);
-
-  uint32_t subframe_count      = 0;
-  uint32_t pscch_prb_start_idx = 0;
+  if (!prog_args.input_file_name) {
+    srsran_rf_start_rx_stream(&radio, false);
+  }
 
+  uint32_t subframe_count = 0;
   uint32_t current_sf_idx = 0;
+  uint64_t sl_tti         = 0;
 
   while (keep_running) {
 
@@ -383,125 +1424,161 @@ int main(int argc, char** argv)
       ERROR("Error calling srsran_ue_sync_work()\n");
     }
 
+    // skip subframes until the receiver is synchronized
+    if (ret != 1) {
+      if (prog_args.capture_prefix && ret == 0) {
+        iq_capture_subframe(rx_buffer, &ue_sync, chains, false);
+      }
+      continue;
+    }
+
     // update SF index
     current_sf_idx = srsran_ue_sync_get_sfidx(&ue_sync);
 
-    // do FFT (on first port)
-    srsran_ofdm_rx_sf(&fft[0]);
-
-    for (int sub_channel_idx = 0; sub_channel_idx < sl_comm_resource_pool.num_sub_channel; sub_channel_idx++) {
-      pscch_prb_start_idx = sub_channel_idx * sl_comm_resource_pool.size_sub_channel;
-
-      for (uint32_t cyclic_shift = 0; cyclic_shift <= 9; cyclic_shift += 3) {
-
-        // PSCCH Channel estimation
-        pscch_chest_sl_cfg.cyclic_shift  = cyclic_shift;
-        pscch_chest_sl_cfg.prb_start_idx = pscch_prb_start_idx;
-        srsran_chest_sl_set_cfg(&pscch_chest, pscch_chest_sl_cfg);
-        srsran_chest_sl_ls_estimate_equalize(&pscch_chest, sf_buffer[0], equalized_sf_buffer);
-
-        if (srsran_pscch_decode(&pscch, equalized_sf_buffer, sci_rx, pscch_prb_start_idx) == SRSRAN_SUCCESS) {
-          if (srsran_sci_format1_unpack(&sci, sci_rx) == SRSRAN_SUCCESS) {
-            srsran_sci_info(&sci, sci_msg, sizeof(sci_msg));
-            fprintf(stdout, "%s", sci_msg);
-
-            num_decoded_sci++;
-
-            // Decode PSSCH
-            uint32_t sub_channel_start_idx = 0;
-            uint32_t L_subCH               = 0;
-            srsran_ra_sl_type0_from_riv(
-                sci.riv, sl_comm_resource_pool.num_sub_channel, &L_subCH, &sub_channel_start_idx);
-
-            // 3GPP TS 36.213 Section 14.1.1.4C
-            uint32_t pssch_prb_start_idx = (sub_channel_idx * sl_comm_resource_pool.size_sub_channel) +
-                                           pscch.pscch_nof_prb + sl_comm_resource_pool.start_prb_sub_channel;
-            uint32_t nof_prb_pssch = ((L_subCH + sub_channel_idx) * sl_comm_resource_pool.size_sub_channel) -
-                                     pssch_prb_start_idx + sl_comm_resource_pool.start_prb_sub_channel;
-
-            // make sure PRBs are valid for DFT precoding
-            nof_prb_pssch = srsran_dft_precoding_get_valid_prb(nof_prb_pssch);
-
-            uint32_t N_x_id = 0;
-            for (int j = 0; j < SRSRAN_SCI_CRC_LEN; j++) {
-              N_x_id += pscch.sci_crc[j] * exp2(SRSRAN_SCI_CRC_LEN - 1 - j);
-            }
-
-            uint32_t rv_idx = 0;
-            if (sci.retransmission == true) {
-              rv_idx = 1;
-            }
-
-            // PSSCH Channel estimation
-            pssch_chest_sl_cfg.N_x_id        = N_x_id;
-            pssch_chest_sl_cfg.sf_idx        = current_sf_idx;
-            pssch_chest_sl_cfg.prb_start_idx = pssch_prb_start_idx;
-            pssch_chest_sl_cfg.nof_prb       = nof_prb_pssch;
-            srsran_chest_sl_set_cfg(&pssch_chest, pssch_chest_sl_cfg);
-            srsran_chest_sl_ls_estimate_equalize(&pssch_chest, sf_buffer[0], equalized_sf_buffer);
-
-            srsran_pssch_cfg_t pssch_cfg = {
-                pssch_prb_start_idx, nof_prb_pssch, N_x_id, sci.mcs_idx, rv_idx, current_sf_idx};
-            if (srsran_pssch_set_cfg(&pssch, pssch_cfg) == SRSRAN_SUCCESS) {
-              if (srsran_pssch_decode(&pssch, equalized_sf_buffer, tb, SRSRAN_SL_SCH_MAX_TB_LEN) == SRSRAN_SUCCESS) {
-                num_decoded_tb++;
-
-                // write logfile
-                fprintf(logfile,"%lu,%d,%d,%d,%d,%d,%d\n",
-                        (uint64_t) round(srsran_timestamp_real(&ue_sync.last_timestamp) * 1e6),
-                        pssch_prb_start_idx,
-                        nof_prb_pssch,
-                        N_x_id,
-                        sci.mcs_idx,
-                        rv_idx,
-                        current_sf_idx);
-
-
-              }
-            }
-          }
-        }
-        if (SRSRAN_VERBOSE_ISDEBUG()) {
-          char filename[64];
-          snprintf(filename,
-                   64,
-                   "pscch_rx_syms_sf%d_shift%d_prbidx%d.bin",
-                   subframe_count,
-                   cyclic_shift,
-                   pscch_prb_start_idx);
-          printf("Saving PSCCH symbols (%d) to %s\n", pscch.E / SRSRAN_PSCCH_QM, filename);
-          srsran_vec_save_file(filename, pscch.mod_symbols, pscch.E / SRSRAN_PSCCH_QM * sizeof(cf_t));
-        }
-      }
+    // advance the running subframe count to the DFN and subframe ue_sync is at, from the SLSS or the GNSS time
+    uint32_t dfn_sf = srsran_ue_sync_get_sfn(&ue_sync) * SRSRAN_NOF_SF_X_FRAME + current_sf_idx;
+    dfn_sf %= SRSRAN_SL_DFN_PERIOD;
+    sl_tti += (dfn_sf + SRSRAN_SL_DFN_PERIOD - sl_tti % SRSRAN_SL_DFN_PERIOD) % SRSRAN_SL_DFN_PERIOD;
+
+    // PSCCH of every channel before any PSSCH, the budget is shared by all channels
+    struct timeval t[3];
+    gettimeofday(&t[1], NULL);
+    SRSRAN_SL_PROF_START(t_sf);
+    for (uint32_t k = 0; k < prog_args.nof_channels; k++) {
+      rx_chain_search(&chains[k], sl_tti, subframe_count, &t[1]);
+    }
+    rx_chains_decode_pssch(
+        chains, prog_args.nof_channels, current_sf_idx, &ue_sync.last_timestamp, &t[1], logfile);
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    uint64_t sf_usec = t[0].tv_sec * 1000000 + t[0].tv_usec;
+    decode_usec += sf_usec;
+    decode_usec_max = SRSRAN_MAX(decode_usec_max, sf_usec);
+    SRSRAN_SL_PROF_STOP(SRSRAN_SL_PROF_RX_SUBFRAME, t_sf);
+    if (sf_usec > 1000) {
+      SRSRAN_SL_PROF_LATE();
+    }
+    if (prog_args.capture_prefix) {
+      iq_capture_subframe(rx_buffer, &ue_sync, chains, true);
     }
 
-    current_sf_idx = (current_sf_idx + 1) % 10;
     subframe_count++;
+    if (prog_args.prof_file_name && subframe_count % 1000 == 0) {
+      srsran_sl_prof_publish();
+    }
+    if (prog_args.seq_period_s > 0 && subframe_count % (prog_args.seq_period_s * 1000) == 0) {
+      print_seq_summary();
+    }
+  }
+
+  // The windows triggered last are completed with the subframes received so far
+  if (prog_args.capture_prefix) {
+    srsran_iq_capture_stop(&iq_capture);
   }
 
   fclose(logfile);
+  for (uint32_t k = 0; k < prog_args.nof_channels; k++) {
+    if (prog_args.nof_channels > 1) {
+      printf("channel=%d num_decoded_sci=%d num_decoded_tb=%d\n",
+             k,
+             chains[k].num_decoded_sci,
+             chains[k].num_decoded_tb);
+    }
+    num_decoded_sci += chains[k].num_decoded_sci;
+    num_decoded_tb += chains[k].num_decoded_tb;
+    num_subframes += chains[k].num_subframes;
+    num_pscch_attempts += chains[k].num_pscch_attempts;
+    num_predicted += chains[k].num_predicted;
+    num_predicted_hits += chains[k].num_predicted_hits;
+    num_shed_pscch += chains[k].num_shed_pscch;
+    num_shed_pssch += chains[k].num_shed_pssch;
+    nof_exhaustive += chains[k].num_pscch_exhaustive;
+    num_skipped += chains[k].num_skipped_subframes;
+  }
   printf("num_decoded_sci=%d num_decoded_tb=%d\n", num_decoded_sci, num_decoded_tb);
 
-  srsran_rf_stop_rx_stream(&radio);
-  srsran_rf_close(&radio);
-  srsran_ue_sync_free(&ue_sync);
-  srsran_sci_free(&sci);
-  srsran_pscch_free(&pscch);
-  srsran_chest_sl_free(&pscch_chest);
-  srsran_chest_sl_free(&pssch_chest);
+  // Search effort compared to trying every cyclic shift on every sub-channel of the RX pools
+  if (nof_exhaustive > 0) {
+    printf("PSCCH search: %" PRIu64 " of %" PRIu64 " candidates tried (%.1f%% saved), %" PRIu64 " shed\n",
+           num_pscch_attempts,
+           nof_exhaustive,
+           100.0 * (nof_exhaustive - num_pscch_attempts - num_shed_pscch) / nof_exhaustive,
+           num_shed_pscch);
+    printf("Decode time: %.1f us per subframe, %" PRIu64 " us max, %" PRIu64 " PSSCH shed\n",
+           (double)decode_usec / subframe_count,
+           decode_usec_max,
+           num_shed_pssch);
+  }
+  if (num_skipped > 0) {
+    printf("Pools: %d of %d subframes outside every RX pool, FFT skipped\n", num_skipped, num_subframes);
+  }
+  if (num_predicted > 0) {
+    printf("Prediction: %" PRIu64 " predicted candidates, %" PRIu64 " decoded (%.1f%% hit rate)\n",
+           num_predicted,
+           num_predicted_hits,
+           100.0 * num_predicted_hits / num_predicted);
+  }
+  if (prog_args.use_slss_sync) {
+    srsran_ue_sync_slss_fprint_stats(stdout, &ue_sync);
+  }
 
-  for (int i = 0; i < prog_args.nof_rx_antennas; i++) {
-    if (rx_buffer[i]) {
-      free(rx_buffer[i]);
+  // MAC level attribution of the decoded transport blocks
+  const srsran_sl_sch_src_stats_t* src_stats      = NULL;
+  uint32_t                         nof_sources    = srsran_sl_sch_rx_get_stats(sl_sch_rx, &src_stats);
+  uint64_t                         nof_sl_invalid = srsran_sl_sch_rx_get_nof_invalid(sl_sch_rx);
+  if (nof_sources > 0 || nof_sl_invalid > 0) {
+    printf("SL-SCH: %d sources, %" PRIu64 " PDUs not V2X SL-SCH, %" PRIu64 " PDUs from sources beyond %d\n",
+           nof_sources,
+           nof_sl_invalid,
+           srsran_sl_sch_rx_get_nof_overflow(sl_sch_rx),
+           SL_SCH_MAX_SOURCES);
+    for (uint32_t i = 0; i < nof_sources; i++) {
+      printf("  SRC=0x%06x pdus=%" PRIu64 " sdus=%" PRIu64 " sdu_bytes=%" PRIu64 "\n",
+             src_stats[i].src_id,
+             src_stats[i].nof_pdus,
+             src_stats[i].nof_sdus,
+             src_stats[i].nof_sdu_bytes);
     }
-    if (sf_buffer[i]) {
-      free(sf_buffer[i]);
+  }
+  if (prog_args.seq_period_s > 0) {
+    print_seq_summary();
+  }
+  if (prog_args.capture_prefix) {
+    srsran_iq_capture_fprint_stats(stdout, &iq_capture);
+  }
+  srsran_vec_alloc_fprint_stats(stdout);
+
+  if (prog_args.input_file_name) {
+    for (uint32_t i = 0; i < file_rx.nof_files; i++) {
+      srsran_filesource_free(&file_rx.fsrc[i]);
     }
-    srsran_ofdm_rx_free(&fft[i]);
+  } else {
+    srsran_rf_stop_rx_stream(&radio);
+    srsran_rf_close(&radio);
+  }
+  srsran_ue_sync_free(&ue_sync);
+  for (uint32_t k = 0; k < prog_args.nof_channels; k++) {
+    rx_chain_free(&chains[k]);
+  }
+  if (prog_args.nof_channels > 1) {
+    wideband_rx_free(&wideband);
   }
+  // The ring file is left behind for the readers still attached to it
+  srsran_sl_export_free(&sl_export);
+  srsran_sl_sch_rx_free(sl_sch_rx);
+  if (prog_args.prof_file_name) {
+    // Last, partial, period
+    srsran_sl_prof_publish();
+  }
+  srsran_sl_prof_publish_free();
 
-  if (equalized_sf_buffer) {
-    free(equalized_sf_buffer);
+  if (prog_args.capture_prefix) {
+    srsran_iq_capture_free(&iq_capture);
+  }
+  for (int i = 0; i < prog_args.nof_rx_antennas && !prog_args.capture_prefix; i++) {
+    if (rx_buffer[i]) {
+      free(rx_buffer[i]);
+    }
   }
 
   return SRSRAN_SUCCESS;
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/* Follows the export ring of pssch_ue (option -x) and prints one CSV line per record */
+
+#include <inttypes.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "srsran/phy/io/sl_export.h"
+#include "srsran/phy/phch/pssch.h"
+#include "srsran/phy/utils/debug.h"
+
+static bool     keep_running = true;
+static char*    ring_path    = NULL;
+static bool     follow       = true;
+static bool     print_tb     = false;
+static uint32_t poll_usec    = 1000;
+
+static uint8_t tb[SRSRAN_SL_SCH_MAX_TB_LEN / 8];
+
+static void sig_int_handler(int signo)
+{
+  if (signo == SIGINT) {
+    keep_running = false;
+  }
+}
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [dpt] -f export_file\n", prog);
+  printf("\t-d dump the records in the ring and exit, instead of following it\n");
+  printf("\t-p poll interval in us while the ring is empty [Default %d]\n", poll_usec);
+  printf("\t-t print the transport blocks in hexadecimal\n");
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "dfpt")) != -1) {
+    switch (opt) {
+      case 'd':
+        follow = false;
+        break;
+      case 'f':
+        ring_path = argv[optind];
+        break;
+      case 'p':
+        poll_usec = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 't':
+        print_tb = true;
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  if (ring_path == NULL) {
+    usage(argv[0]);
+    exit(-1);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+  signal(SIGINT, sig_int_handler);
+
+  srsran_sl_export_reader_t reader = {};
+  if (srsran_sl_export_reader_init(&reader, ring_path) != SRSRAN_SUCCESS) {
+    ERROR("Error opening export ring %s\n", ring_path);
+    exit(-1);
+  }
+
+  printf("rx_timestamp_us,channel_idx,sf_idx,sub_channel_idx,prb_start_idx,nof_prb,N_x_id,priority,resource_reserv,"
+         "time_gap,mcs_idx,rv_idx,riv,flags,rsrp_db,snr_db,tb_len%s\n",
+         print_tb ? ",tb" : "");
+
+  uint64_t                  nof_records = 0;
+  srsran_sl_export_record_t r;
+  while (keep_running) {
+    int n = srsran_sl_export_read(&reader, &r, tb, sizeof(tb));
+    if (n < 0) {
+      break;
+    }
+    if (n == 0) {
+      if (!follow) {
+        break;
+      }
+      usleep(poll_usec);
+      continue;
+    }
+    nof_records++;
+
+    printf("%" PRIu64 ",%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%.1f,%.1f,%d",
+           r.timestamp_us,
+           r.channel_idx,
+           r.sf_idx,
+           r.sub_channel_idx,
+           r.prb_start_idx,
+           r.nof_prb,
+           r.N_x_id,
+           r.priority,
+           r.resource_reserv,
+           r.time_gap,
+           r.mcs_idx,
+           r.rv_idx,
+           r.riv,
+           r.flags,
+           r.rsrp_db,
+           r.snr_db,
+           r.tb_len);
+    if (print_tb) {
+      printf(",");
+      for (uint32_t i = 0; i < r.tb_len && i < sizeof(tb); i++) {
+        printf("%02x", tb[i]);
+      }
+    }
+    printf("\n");
+  }
+
+  fprintf(stderr, "%" PRIu64 " records read, %" PRIu64 " lost\n", nof_records, reader.nof_lost);
+  srsran_sl_export_reader_free(&reader);
+  return SRSRAN_SUCCESS;
+}
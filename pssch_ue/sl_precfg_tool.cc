@@ -0,0 +1,176 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/* Converts between a UPER encoded SL-V2X-Preconfiguration-r14 and the resource pool file of pssch_ue (option -C) */
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <unistd.h>
+#include <vector>
+
+#include "srsran/asn1/rrc_asn1.h"
+#include "srsran/asn1/rrc_asn1_utils.h"
+#include "srsran/srsran.h"
+
+using namespace asn1::rrc;
+
+static char*    input_path  = nullptr;
+static char*    output_path = nullptr;
+static bool     encode      = false;
+static bool     print_json  = false;
+static uint32_t freq_idx    = 0;
+static uint32_t nof_prb     = 0;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [efjp] -i input -o output\n", prog);
+  printf("\t-e encode a pool file into SL-V2X-Preconfiguration-r14 instead of decoding [Default decode]\n");
+  printf("\t-f index of SL-V2X-PreconfigFreqInfo-r14 to decode [Default %d]\n", freq_idx);
+  printf("\t-j print the decoded message as JSON\n");
+  printf("\t-p nof_prb [Default sl-Bandwidth-r12 when decoding, 50 when encoding]\n");
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "efijop")) != -1) {
+    switch (opt) {
+      case 'e':
+        encode = true;
+        break;
+      case 'f':
+        freq_idx = (uint32_t)strtol(argv[optind], nullptr, 10);
+        break;
+      case 'i':
+        input_path = argv[optind];
+        break;
+      case 'j':
+        print_json = true;
+        break;
+      case 'o':
+        output_path = argv[optind];
+        break;
+      case 'p':
+        nof_prb = (uint32_t)strtol(argv[optind], nullptr, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  if (input_path == nullptr || (output_path == nullptr && not print_json)) {
+    usage(argv[0]);
+    exit(-1);
+  }
+}
+
+static srsran_cell_sl_t make_cell(uint32_t cell_nof_prb)
+{
+  srsran_cell_sl_t cell = {};
+  cell.tm               = SRSRAN_SIDELINK_TM4;
+  cell.nof_prb          = cell_nof_prb;
+  cell.cp               = SRSRAN_CP_NORM;
+  return cell;
+}
+
+static int decode()
+{
+  std::ifstream        file(input_path, std::ios::binary);
+  std::vector<uint8_t> buf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (not file.good() && not file.eof()) {
+    fprintf(stderr, "Error reading %s\n", input_path);
+    return SRSRAN_ERROR;
+  }
+
+  sl_v2x_precfg_r14_s precfg;
+  asn1::cbit_ref      bref(buf.data(), buf.size());
+  if (precfg.unpack(bref) != asn1::SRSASN_SUCCESS) {
+    fprintf(stderr, "Error unpacking SL-V2X-Preconfiguration-r14\n");
+    return SRSRAN_ERROR;
+  }
+  if (print_json) {
+    asn1::json_writer j;
+    precfg.to_json(j);
+    printf("%s\n", j.to_string().c_str());
+  }
+  if (freq_idx >= precfg.v2x_precfg_freq_list_r14.size()) {
+    fprintf(stderr, "There are %d carriers\n", (int)precfg.v2x_precfg_freq_list_r14.size());
+    return SRSRAN_ERROR;
+  }
+  if (output_path == nullptr) {
+    return SRSRAN_SUCCESS;
+  }
+
+  const sl_v2x_precfg_freq_info_r14_s& freq = precfg.v2x_precfg_freq_list_r14[freq_idx];
+  srsran_cell_sl_t cell = make_cell(nof_prb ? nof_prb : freq.v2x_comm_precfg_general_r14.sl_bw_r12.to_number());
+
+  static srsran_sl_v2x_precfg_freq_t cfg;
+  if (srsran::make_sl_v2x_precfg_freq(&cfg, cell, freq) != SRSRAN_SUCCESS) {
+    fprintf(stderr, "The pools of carrier %d do not fit a %d PRB cell\n", freq_idx, cell.nof_prb);
+    return SRSRAN_ERROR;
+  }
+  return srsran_sl_v2x_precfg_freq_write_file(&cfg, output_path);
+}
+
+static int encode_file()
+{
+  srsran_cell_sl_t cell = make_cell(nof_prb ? nof_prb : 50);
+
+  static srsran_sl_v2x_precfg_freq_t cfg;
+  if (srsran_sl_v2x_precfg_freq_read_file(&cfg, cell, input_path) != SRSRAN_SUCCESS) {
+    return SRSRAN_ERROR;
+  }
+  if (cfg.nof_rx_pools == 0 || cfg.nof_tx_pools == 0) {
+    fprintf(stderr, "SL-V2X-PreconfigFreqInfo-r14 needs at least one RX and one TX pool\n");
+    return SRSRAN_ERROR;
+  }
+
+  sl_v2x_precfg_r14_s precfg;
+  precfg.v2x_precfg_freq_list_r14.resize(1);
+  sl_v2x_precfg_freq_info_r14_s& freq = precfg.v2x_precfg_freq_list_r14[0];
+  asn1::number_to_enum(freq.v2x_comm_precfg_general_r14.sl_bw_r12, cell.nof_prb);
+  freq.v2x_comm_precfg_general_r14.tdd_cfg_sl_r12.sf_assign_sl_r12 = tdd_cfg_sl_r12_s::sf_assign_sl_r12_opts::none;
+  freq.sync_prio_r14 = sl_v2x_precfg_freq_info_r14_s::sync_prio_r14_opts::gnss;
+  srsran::to_asn1(&freq, cfg);
+
+  uint8_t       buf[4096];
+  asn1::bit_ref bref(buf, sizeof(buf));
+  if (precfg.pack(bref) != asn1::SRSASN_SUCCESS) {
+    fprintf(stderr, "Error packing SL-V2X-Preconfiguration-r14\n");
+    return SRSRAN_ERROR;
+  }
+  if (print_json) {
+    asn1::json_writer j;
+    precfg.to_json(j);
+    printf("%s\n", j.to_string().c_str());
+  }
+
+  std::ofstream file(output_path, std::ios::binary);
+  file.write((const char*)buf, bref.distance_bytes());
+  return file.good() ? SRSRAN_SUCCESS : SRSRAN_ERROR;
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+  return encode ? encode_file() : decode();
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/* Polls the stage latency page of pssch_ue or cv2x_traffic_generator (option -L) and prints every new snapshot */
+
+#include <inttypes.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/sl_prof.h"
+
+static bool     keep_running = true;
+static char*    page_path    = NULL;
+static bool     once         = false;
+static uint32_t poll_ms      = 200;
+
+static void sig_int_handler(int signo)
+{
+  if (signo == SIGINT) {
+    keep_running = false;
+  }
+}
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [op] -f latency_file\n", prog);
+  printf("\t-o print the current snapshot and exit\n");
+  printf("\t-p poll interval in ms [Default %d]\n", poll_ms);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "fop")) != -1) {
+    switch (opt) {
+      case 'f':
+        page_path = argv[optind];
+        break;
+      case 'o':
+        once = true;
+        break;
+      case 'p':
+        poll_ms = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  if (page_path == NULL) {
+    usage(argv[0]);
+    exit(-1);
+  }
+}
+
+static void print_snapshot(const srsran_sl_prof_snapshot_t* s)
+{
+  printf("%" PRIu64 ".%06" PRIu64 ": %.1f s, %" PRIu64 " subframes late (%" PRIu64 " total)\n",
+         s->timestamp_us / 1000000,
+         s->timestamp_us % 1000000,
+         s->period_us / 1e6,
+         s->late,
+         s->total_late);
+  printf("  %-16s %10s %10s %10s %10s\n", "stage", "count", "p50 us", "p99 us", "max us");
+  for (uint32_t i = 0; i < SRSRAN_SL_PROF_NOF_STAGES; i++) {
+    const srsran_sl_prof_stats_t* st = &s->stage[i];
+    if (st->total_count == 0) {
+      continue;
+    }
+    printf("  %-16s %10" PRIu64 " %10.1f %10.1f %10.1f\n",
+           srsran_sl_prof_stage_name((srsran_sl_prof_stage_t)i),
+           st->count,
+           st->p50_ns / 1e3,
+           st->p99_ns / 1e3,
+           st->max_ns / 1e3);
+  }
+  fflush(stdout);
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+  signal(SIGINT, sig_int_handler);
+
+  srsran_sl_prof_reader_t reader = {};
+  if (srsran_sl_prof_reader_init(&reader, page_path) != SRSRAN_SUCCESS) {
+    ERROR("Error opening latency file %s\n", page_path);
+    exit(-1);
+  }
+
+  uint64_t                  last_seq = 0;
+  srsran_sl_prof_snapshot_t s;
+  while (keep_running) {
+    int ret = srsran_sl_prof_reader_read(&reader, &s);
+    if (ret < 0) {
+      break;
+    }
+    if (ret == 1 && s.seq != last_seq) {
+      print_snapshot(&s);
+      last_seq = s.seq;
+    }
+    if (once) {
+      break;
+    }
+    usleep(poll_ms * 1000);
+  }
+
+  srsran_sl_prof_reader_free(&reader);
+  return SRSRAN_SUCCESS;
+}
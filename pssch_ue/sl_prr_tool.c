@@ -0,0 +1,661 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/* Joins the TX log of cv2x_traffic_generator with the RX logs of pssch_ue and prints the packet reception ratio per
+ * time, sub-channel, MCS and distance bucket.
+ *
+ * A transmission is received when an RX row has the same channel_idx, N_x_id, prb_start_idx and nof_prb, and a
+ * timestamp at most the window away. Both logs are in time order, so each RX log is merged with the TX log in a
+ * single pass that keeps only the transmissions of the last window in a ring with a hash chain per key. Every RX log
+ * is joined by its own thread. TX rows outside the time span of an RX log are not counted for it.
+ */
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+#define MAX_RX_LOGS 256
+#define MAX_MCS 32
+#define MAX_SUB_CHANNELS 128
+
+static char*    tx_path                  = NULL;
+static char*    out_path                 = NULL;
+static char*    rx_paths[MAX_RX_LOGS]    = {};
+static double   rx_distance[MAX_RX_LOGS] = {};
+static uint32_t nof_rx_logs              = 0;
+static uint64_t window_us                = 500;
+static uint64_t time_bucket_us           = 1000000;
+static double   distance_bucket_m        = 50.0;
+static uint32_t size_sub_channel         = 10;
+static uint32_t max_pending              = 4096;
+static uint32_t nof_threads              = 0;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [bdjmnotw] -t tx_log -r rx_log[@distance_m] [-r rx_log[@distance_m] ...]\n", prog);
+  printf("\t-b time bucket in seconds [Default %.1f]\n", time_bucket_us / 1e6);
+  printf("\t-d distance bucket in meters [Default %.1f]\n", distance_bucket_m);
+  printf("\t-j number of threads [Default one per RX log]\n");
+  printf("\t-m maximum pending transmissions per RX log [Default %d]\n", max_pending);
+  printf("\t-n size_sub_channel in PRB [Default %d]\n", size_sub_channel);
+  printf("\t-o output CSV file [Default stdout]\n");
+  printf("\t-w matching window in us [Default %" PRIu64 "]\n", window_us);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "bdjmnortw")) != -1) {
+    switch (opt) {
+      case 'b':
+        time_bucket_us = (uint64_t)(strtod(argv[optind], NULL) * 1e6);
+        break;
+      case 'd':
+        distance_bucket_m = strtod(argv[optind], NULL);
+        break;
+      case 'j':
+        nof_threads = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'm':
+        max_pending = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'n':
+        size_sub_channel = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'o':
+        out_path = argv[optind];
+        break;
+      case 'r':
+        if (nof_rx_logs == MAX_RX_LOGS) {
+          ERROR("At most %d RX logs are supported\n", MAX_RX_LOGS);
+          exit(-1);
+        }
+        rx_paths[nof_rx_logs]    = argv[optind];
+        rx_distance[nof_rx_logs] = -1.0;
+        char* at                 = strrchr(argv[optind], '@');
+        if (at != NULL) {
+          *at                      = '\0';
+          rx_distance[nof_rx_logs] = strtod(at + 1, NULL);
+        }
+        nof_rx_logs++;
+        break;
+      case 't':
+        tx_path = argv[optind];
+        break;
+      case 'w':
+        window_us = (uint64_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  if (tx_path == NULL || nof_rx_logs == 0 || time_bucket_us == 0 || distance_bucket_m <= 0 || size_sub_channel == 0 ||
+      max_pending == 0) {
+    usage(argv[0]);
+    exit(-1);
+  }
+}
+
+/************ Log files ************/
+
+typedef struct {
+  const char* data;
+  size_t      len; // Up to the end of the last complete line
+  size_t      map_len;
+} log_file_t;
+
+static int log_file_open(log_file_t* f, const char* path)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    ERROR("Error opening %s\n", path);
+    return SRSRAN_ERROR;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return SRSRAN_ERROR;
+  }
+  f->map_len = st.st_size;
+  f->len     = 0;
+  f->data    = "";
+  if (f->map_len > 0) {
+    f->data = mmap(NULL, f->map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (f->data == MAP_FAILED) {
+      ERROR("Error mapping %s\n", path);
+      close(fd);
+      return SRSRAN_ERROR;
+    }
+    madvise((void*)f->data, f->map_len, MADV_SEQUENTIAL);
+
+    // A line still being written is ignored, so every row parsed ends with a newline
+    const char* nl = memrchr(f->data, '\n', f->map_len);
+    f->len         = nl ? (size_t)(nl + 1 - f->data) : 0;
+  }
+  close(fd);
+  return SRSRAN_SUCCESS;
+}
+
+static void log_file_close(log_file_t* f)
+{
+  if (f->map_len > 0) {
+    munmap((void*)f->data, f->map_len);
+  }
+}
+
+/* One row of either log. Decoded RX rows and TX rows have all fields, the rows of subframes where pssch_ue shed work
+ * have no allocation */
+typedef struct {
+  uint64_t timestamp_us;
+  uint32_t prb_start_idx;
+  uint32_t nof_prb;
+  uint32_t N_x_id;
+  uint32_t mcs_idx;
+  uint32_t channel_idx;
+  uint32_t shed;
+  bool     has_alloc;
+} log_row_t;
+
+typedef struct {
+  const char* ptr;
+  const char* end;
+  uint64_t    nof_rows;
+  uint64_t    nof_bad;
+} log_reader_t;
+
+static void log_reader_init(log_reader_t* r, const log_file_t* f)
+{
+  r->ptr      = f->data;
+  r->end      = f->data + f->len;
+  r->nof_rows = 0;
+  r->nof_bad  = 0;
+
+  // Skip the header
+  const char* nl = memchr(r->ptr, '\n', r->end - r->ptr);
+  r->ptr         = nl ? nl + 1 : r->end;
+}
+
+/* Reads a decimal number. The newline at the end of the line stops it, so there is no bounds check */
+static inline const char* parse_uint(const char* s, uint64_t* value)
+{
+  uint64_t v = 0;
+  while ((uint8_t)(*s - '0') < 10) {
+    v = v * 10 + (uint64_t)(*s - '0');
+    s++;
+  }
+  *value = v;
+  return s;
+}
+
+/* Parses the next well formed row. Returns false at the end of the file */
+static bool log_reader_next(log_reader_t* r, log_row_t* row)
+{
+  while (r->ptr < r->end) {
+    // timestamp,prb_start_idx,nof_prb,N_x_id,mcs_idx,rv_idx,sf_idx,channel_idx[,shed_pscch,shed_pssch]
+    const char* p     = r->ptr;
+    uint64_t    v[10] = {};
+    uint32_t    found = 0;
+    uint32_t    n     = 0;
+    while (n < 10) {
+      const char* s = parse_uint(p, &v[n]);
+      found |= (uint32_t)(s != p) << n;
+      n++;
+      p = s + 1;
+      if (*s != ',') {
+        break;
+      }
+    }
+    const char* s = p - 1;
+    if (*s == '\r') {
+      s++;
+    }
+
+    if (*s != '\n' || n < 8 || (found & 0x81) != 0x81) {
+      const char* nl = memchr(r->ptr, '\n', r->end - r->ptr);
+      r->nof_bad += nl != r->ptr;
+      r->ptr = nl + 1;
+      continue;
+    }
+    r->ptr = s + 1;
+
+    r->nof_rows++;
+    row->timestamp_us  = v[0];
+    row->has_alloc     = (found & 0x1e) == 0x1e;
+    row->prb_start_idx = (uint32_t)v[1];
+    row->nof_prb       = (uint32_t)v[2];
+    row->N_x_id        = (uint32_t)v[3];
+    row->mcs_idx       = (uint32_t)v[4];
+    row->channel_idx   = (uint32_t)v[7];
+    row->shed          = (uint32_t)(v[8] + v[9]);
+    return true;
+  }
+  return false;
+}
+
+/* Timestamp of the last row, found from the end of the file */
+static uint64_t log_file_last_timestamp(const log_file_t* f)
+{
+  const char* end = f->data + f->len;
+  while (end > f->data) {
+    const char* line = end - 1;
+    while (line > f->data && line[-1] != '\n') {
+      line--;
+    }
+    uint64_t ts;
+    if (parse_uint(line, &ts) != line && *line != '\n') {
+      return ts;
+    }
+    end = line;
+  }
+  return 0;
+}
+
+/************ Statistics ************/
+
+typedef struct {
+  uint64_t nof_tx;
+  uint64_t nof_rx;
+} prr_count_t;
+
+typedef struct {
+  prr_count_t  total;
+  prr_count_t  mcs[MAX_MCS];
+  prr_count_t  sub_channel[MAX_SUB_CHANNELS];
+  prr_count_t* time;
+  uint32_t     nof_time;
+  uint64_t     nof_tx_outside;
+  uint64_t     nof_rx_unmatched;
+  uint64_t     nof_rx_duplicate;
+  uint64_t     nof_evicted;
+  uint64_t     nof_shed;
+  uint64_t     nof_rows;
+  uint64_t     nof_bad_rows;
+} prr_stats_t;
+
+static void prr_count(prr_count_t* c, bool received)
+{
+  c->nof_tx++;
+  c->nof_rx += received;
+}
+
+/************ Join ************/
+
+typedef struct {
+  uint64_t timestamp_us;
+  uint64_t key;
+  uint64_t prev; // Sequence number + 1 of the previous transmission with the same hash, 0 if none
+  uint8_t  mcs_idx;
+  uint8_t  sub_channel_idx;
+  bool     received;
+} pending_tx_t;
+
+typedef struct {
+  pending_tx_t* ring;
+  uint64_t*     heads;
+  uint64_t      ring_mask;
+  uint32_t      hash_bits;
+  uint64_t      head_seq; // Next sequence number to insert
+  uint64_t      tail_seq; // Oldest sequence number still pending
+  uint64_t      t0_us;
+  prr_stats_t*  stats;
+} prr_join_t;
+
+static inline uint64_t join_key(const log_row_t* row)
+{
+  return ((uint64_t)row->channel_idx << 48) | ((uint64_t)row->N_x_id << 16) | ((uint64_t)row->prb_start_idx << 8) |
+         (uint64_t)row->nof_prb;
+}
+
+static inline uint64_t join_hash(const prr_join_t* q, uint64_t key)
+{
+  return (key * 0x9e3779b97f4a7c15ULL) >> (64 - q->hash_bits);
+}
+
+static int prr_join_init(prr_join_t* q, uint32_t capacity, uint64_t t0_us, prr_stats_t* stats)
+{
+  uint64_t nof_slots = 1;
+  while (nof_slots < capacity) {
+    nof_slots <<= 1;
+  }
+  q->hash_bits = 1;
+  while ((1ULL << q->hash_bits) < 2 * nof_slots) {
+    q->hash_bits++;
+  }
+  q->ring      = calloc(nof_slots, sizeof(pending_tx_t));
+  q->heads     = calloc(1ULL << q->hash_bits, sizeof(uint64_t));
+  q->ring_mask = nof_slots - 1;
+  q->head_seq  = 0;
+  q->tail_seq  = 0;
+  q->t0_us     = t0_us;
+  q->stats     = stats;
+  return (q->ring && q->heads) ? SRSRAN_SUCCESS : SRSRAN_ERROR;
+}
+
+static void prr_join_free(prr_join_t* q)
+{
+  free(q->ring);
+  free(q->heads);
+}
+
+/* Accounts the oldest pending transmission, which can no longer be received */
+static void prr_join_expire(prr_join_t* q)
+{
+  pending_tx_t* e = &q->ring[q->tail_seq & q->ring_mask];
+  prr_stats_t*  s = q->stats;
+  q->tail_seq++;
+
+  uint64_t t = (e->timestamp_us - q->t0_us) / time_bucket_us;
+  if (t >= s->nof_time) {
+    uint32_t n = s->nof_time ? s->nof_time : 64;
+    while (n <= t) {
+      n *= 2;
+    }
+    prr_count_t* time = realloc(s->time, n * sizeof(prr_count_t));
+    if (time == NULL) {
+      return;
+    }
+    memset(&time[s->nof_time], 0, (n - s->nof_time) * sizeof(prr_count_t));
+    s->time     = time;
+    s->nof_time = n;
+  }
+
+  prr_count(&s->total, e->received);
+  prr_count(&s->time[t], e->received);
+  prr_count(&s->mcs[e->mcs_idx], e->received);
+  prr_count(&s->sub_channel[e->sub_channel_idx], e->received);
+}
+
+static void prr_join_push(prr_join_t* q, const log_row_t* row)
+{
+  if (q->head_seq - q->tail_seq > q->ring_mask) {
+    q->stats->nof_evicted++;
+    prr_join_expire(q);
+  }
+
+  uint64_t      key  = join_key(row);
+  uint64_t      h    = join_hash(q, key);
+  pending_tx_t* e    = &q->ring[q->head_seq & q->ring_mask];
+  e->timestamp_us    = row->timestamp_us;
+  e->key             = key;
+  e->prev            = q->heads[h];
+  e->mcs_idx         = (uint8_t)SRSRAN_MIN(row->mcs_idx, MAX_MCS - 1);
+  e->sub_channel_idx = (uint8_t)SRSRAN_MIN(row->prb_start_idx / size_sub_channel, MAX_SUB_CHANNELS - 1);
+  e->received        = false;
+  q->heads[h]        = ++q->head_seq;
+}
+
+/* Walks the hash chain from the newest pending transmission back to the oldest one still in the ring */
+static void prr_join_match(prr_join_t* q, const log_row_t* row)
+{
+  uint64_t key = join_key(row);
+  for (uint64_t seq = q->heads[join_hash(q, key)]; seq > q->tail_seq; seq = q->ring[(seq - 1) & q->ring_mask].prev) {
+    pending_tx_t* e = &q->ring[(seq - 1) & q->ring_mask];
+    if (e->key != key) {
+      continue;
+    }
+    uint64_t dt = e->timestamp_us > row->timestamp_us ? e->timestamp_us - row->timestamp_us
+                                                      : row->timestamp_us - e->timestamp_us;
+    if (dt > window_us) {
+      continue;
+    }
+    if (e->received) {
+      q->stats->nof_rx_duplicate++;
+    } else {
+      e->received = true;
+    }
+    return;
+  }
+  q->stats->nof_rx_unmatched++;
+}
+
+typedef struct {
+  const log_file_t* tx;
+  uint32_t          idx;
+  prr_stats_t       stats;
+  double            elapsed_s;
+} rx_job_t;
+
+static int join_rx_log(rx_job_t* job)
+{
+  log_file_t rx = {};
+  if (log_file_open(&rx, rx_paths[job->idx]) != SRSRAN_SUCCESS) {
+    return SRSRAN_ERROR;
+  }
+
+  log_reader_t tx_reader, rx_reader;
+  log_row_t    tx_row, rx_row;
+  log_reader_init(&tx_reader, job->tx);
+  log_reader_init(&rx_reader, &rx);
+
+  prr_stats_t* s = &job->stats;
+  prr_join_t   q = {};
+
+  bool     has_tx = log_reader_next(&tx_reader, &tx_row);
+  bool     has_rx = log_reader_next(&rx_reader, &rx_row);
+  uint64_t t_lo   = has_rx && rx_row.timestamp_us > window_us ? rx_row.timestamp_us - window_us : 0;
+  uint64_t t_hi   = has_rx ? log_file_last_timestamp(&rx) + window_us : 0;
+  uint64_t t0     = has_tx ? SRSRAN_MAX(tx_row.timestamp_us, t_lo) : 0;
+
+  if (prr_join_init(&q, max_pending, t0, s) != SRSRAN_SUCCESS) {
+    ERROR("Error allocating the join of %s\n", rx_paths[job->idx]);
+    log_file_close(&rx);
+    return SRSRAN_ERROR;
+  }
+
+  for (; has_rx; has_rx = log_reader_next(&rx_reader, &rx_row)) {
+    if (!rx_row.has_alloc) {
+      s->nof_shed += rx_row.shed;
+      continue;
+    }
+
+    // Every transmission that could match this row is pending, older ones are final
+    for (; has_tx && tx_row.timestamp_us <= rx_row.timestamp_us + window_us;
+         has_tx = log_reader_next(&tx_reader, &tx_row)) {
+      if (tx_row.timestamp_us < t_lo || tx_row.timestamp_us > t_hi || !tx_row.has_alloc) {
+        s->nof_tx_outside++;
+        continue;
+      }
+      prr_join_push(&q, &tx_row);
+    }
+    while (q.tail_seq < q.head_seq &&
+           q.ring[q.tail_seq & q.ring_mask].timestamp_us + window_us < rx_row.timestamp_us) {
+      prr_join_expire(&q);
+    }
+
+    prr_join_match(&q, &rx_row);
+  }
+
+  for (; has_tx; has_tx = log_reader_next(&tx_reader, &tx_row)) {
+    if (tx_row.timestamp_us < t_lo || tx_row.timestamp_us > t_hi || !tx_row.has_alloc) {
+      s->nof_tx_outside++;
+      continue;
+    }
+    prr_join_push(&q, &tx_row);
+  }
+  while (q.tail_seq < q.head_seq) {
+    prr_join_expire(&q);
+  }
+
+  s->nof_rows     = tx_reader.nof_rows + rx_reader.nof_rows;
+  s->nof_bad_rows = tx_reader.nof_bad + rx_reader.nof_bad;
+  prr_join_free(&q);
+  log_file_close(&rx);
+  return SRSRAN_SUCCESS;
+}
+
+static rx_job_t jobs[MAX_RX_LOGS];
+static uint32_t next_job = 0;
+
+static void* join_thread(void* arg)
+{
+  uint32_t idx;
+  while ((idx = __atomic_fetch_add(&next_job, 1, __ATOMIC_RELAXED)) < nof_rx_logs) {
+    struct timeval t[3];
+    gettimeofday(&t[1], NULL);
+    if (join_rx_log(&jobs[idx]) != SRSRAN_SUCCESS) {
+      ERROR("Error joining %s\n", rx_paths[idx]);
+    }
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    jobs[idx].elapsed_s = t[0].tv_sec + t[0].tv_usec * 1e-6;
+  }
+  return NULL;
+}
+
+/************ Output ************/
+
+static void print_count(FILE* f, const char* log, const char* dimension, double bucket, const prr_count_t* c)
+{
+  if (c->nof_tx == 0) {
+    return;
+  }
+  fprintf(f,
+          "%s,%s,%g,%" PRIu64 ",%" PRIu64 ",%.4f\n",
+          log,
+          dimension,
+          bucket,
+          c->nof_tx,
+          c->nof_rx,
+          (double)c->nof_rx / c->nof_tx);
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  log_file_t tx = {};
+  if (log_file_open(&tx, tx_path) != SRSRAN_SUCCESS) {
+    exit(-1);
+  }
+
+  FILE* out = stdout;
+  if (out_path) {
+    out = fopen(out_path, "w");
+    if (out == NULL) {
+      ERROR("Error opening %s\n", out_path);
+      exit(-1);
+    }
+  }
+
+  if (nof_threads == 0 || nof_threads > nof_rx_logs) {
+    nof_threads = nof_rx_logs;
+  }
+  for (uint32_t i = 0; i < nof_rx_logs; i++) {
+    jobs[i].tx  = &tx;
+    jobs[i].idx = i;
+  }
+
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+  pthread_t threads[MAX_RX_LOGS];
+  for (uint32_t i = 0; i < nof_threads; i++) {
+    if (pthread_create(&threads[i], NULL, join_thread, NULL)) {
+      ERROR("Error creating join thread\n");
+      exit(-1);
+    }
+  }
+  for (uint32_t i = 0; i < nof_threads; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+
+  fprintf(out, "rx_log,dimension,bucket,nof_tx,nof_rx,prr\n");
+  uint32_t     nof_distance = 0;
+  prr_count_t* distance     = NULL;
+  uint64_t     nof_rows     = 0;
+  for (uint32_t i = 0; i < nof_rx_logs; i++) {
+    prr_stats_t* s = &jobs[i].stats;
+    char         log[16];
+    snprintf(log, sizeof(log), "%d", i);
+
+    print_count(out, log, "total", 0, &s->total);
+    for (uint32_t k = 0; k < s->nof_time; k++) {
+      print_count(out, log, "time_s", k * (time_bucket_us / 1e6), &s->time[k]);
+    }
+    for (uint32_t k = 0; k < MAX_SUB_CHANNELS; k++) {
+      print_count(out, log, "sub_channel", k, &s->sub_channel[k]);
+    }
+    for (uint32_t k = 0; k < MAX_MCS; k++) {
+      print_count(out, log, "mcs", k, &s->mcs[k]);
+    }
+
+    if (rx_distance[i] >= 0) {
+      uint32_t d = (uint32_t)(rx_distance[i] / distance_bucket_m);
+      if (d >= nof_distance) {
+        distance = realloc(distance, (d + 1) * sizeof(prr_count_t));
+        memset(&distance[nof_distance], 0, (d + 1 - nof_distance) * sizeof(prr_count_t));
+        nof_distance = d + 1;
+      }
+      distance[d].nof_tx += s->total.nof_tx;
+      distance[d].nof_rx += s->total.nof_rx;
+    }
+
+    fprintf(stderr,
+            "[%d] %s: PRR %.4f (%" PRIu64 "/%" PRIu64 "), %" PRIu64 " TX outside the RX log, %" PRIu64
+            " RX unmatched, %" PRIu64 " duplicated, %" PRIu64 " evicted, %" PRIu64 " shed, %" PRIu64
+            " bad rows, %.1f Mrows/s\n",
+            i,
+            rx_paths[i],
+            s->total.nof_tx ? (double)s->total.nof_rx / s->total.nof_tx : 0.0,
+            s->total.nof_rx,
+            s->total.nof_tx,
+            s->nof_tx_outside,
+            s->nof_rx_unmatched,
+            s->nof_rx_duplicate,
+            s->nof_evicted,
+            s->nof_shed,
+            s->nof_bad_rows,
+            jobs[i].elapsed_s > 0 ? s->nof_rows / jobs[i].elapsed_s / 1e6 : 0.0);
+    nof_rows += s->nof_rows;
+    free(s->time);
+  }
+  for (uint32_t k = 0; k < nof_distance; k++) {
+    print_count(out, "all", "distance_m", k * distance_bucket_m, &distance[k]);
+  }
+  free(distance);
+
+  double elapsed = t[0].tv_sec + t[0].tv_usec * 1e-6;
+  fprintf(stderr,
+          "%" PRIu64 " rows joined in %.2f s on %d threads, %.1f Mrows/s\n",
+          nof_rows,
+          elapsed,
+          nof_threads,
+          elapsed > 0 ? nof_rows / elapsed / 1e6 : 0.0);
+
+  if (out != stdout) {
+    fclose(out);
+  }
+  log_file_close(&tx);
+  return SRSRAN_SUCCESS;
+}
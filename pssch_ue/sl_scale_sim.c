@@ -0,0 +1,259 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/* Simulates a highway of sidelink mode 4 vehicles with the abstracted PHY of ue_sl_sim.h and prints the packet
+ * reception ratio per distance bucket, in the CSV format of sl_prr_tool, so that both can be plotted together.
+ *
+ * The BLER curves default to the attenuated Shannon bound of the transport format. Measured curves, for instance from
+ * pssch_ue against a channel emulator, are read from CSV files of sinr_db,bler rows in increasing SINR.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/phy/ue/ue_sl_sim.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+#define MAX_BLER_POINTS 1024
+
+static srsran_ue_sl_sim_cfg_t cfg;
+static srsran_cell_sl_t cell = {.nof_prb = 50, .N_sl_id = 0, .tm = SRSRAN_SIDELINK_TM4, .cp = SRSRAN_CP_NORM};
+static char*            out_path                                 = NULL;
+static char*            bler_path[SRSRAN_UE_SL_SIM_NOF_CHANNELS] = {};
+static double           nof_seconds                              = 10.0;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [abcdefjklmnoprsuvx]\n", prog);
+  printf("\t-a nof_prb [Default %d]\n", cell.nof_prb);
+  printf("\t-b PSSCH BLER curve CSV of sinr_db,bler [Default attenuated Shannon]\n");
+  printf("\t-c sub-channels per transmission [Default %d]\n", cfg.L_subCH);
+  printf("\t-d distance bucket in meters [Default %.1f]\n", cfg.distance_bucket_m);
+  printf("\t-e PSCCH BLER curve CSV of sinr_db,bler [Default attenuated Shannon]\n");
+  printf("\t-f disable fading\n");
+  printf("\t-j number of threads [Default %d]\n", cfg.nof_threads);
+  printf("\t-k lanes per direction [Default %d]\n", cfg.nof_lanes);
+  printf("\t-l road length in meters [Default %.1f]\n", cfg.road_length_m);
+  printf("\t-m MCS index [Default %d]\n", cfg.mcs_idx);
+  printf("\t-n number of vehicles [Default %d]\n", cfg.nof_vehicles);
+  printf("\t-o output CSV file [Default stdout]\n");
+  printf("\t-p reservation period in ms [Default %d]\n", cfg.period_ms);
+  printf("\t-r maximum range in meters [Default %.1f]\n", cfg.max_range_m);
+  printf("\t-s simulated seconds [Default %.1f]\n", nof_seconds);
+  printf("\t-u random resource selection instead of sensing\n");
+  printf("\t-v speed in km/h [Default %.1f]\n", cfg.speed_kmph);
+  printf("\t-x random seed [Default %d]\n", cfg.seed);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "abcdefjklmnoprsuvx")) != -1) {
+    switch (opt) {
+      case 'a':
+        cell.nof_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'b':
+        bler_path[SRSRAN_UE_SL_SIM_PSSCH] = argv[optind];
+        break;
+      case 'c':
+        cfg.L_subCH = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'd':
+        cfg.distance_bucket_m = strtof(argv[optind], NULL);
+        break;
+      case 'e':
+        bler_path[SRSRAN_UE_SL_SIM_PSCCH] = argv[optind];
+        break;
+      case 'f':
+        cfg.fading = false;
+        break;
+      case 'j':
+        cfg.nof_threads = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'k':
+        cfg.nof_lanes = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'l':
+        cfg.road_length_m = strtof(argv[optind], NULL);
+        break;
+      case 'm':
+        cfg.mcs_idx = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'n':
+        cfg.nof_vehicles = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'o':
+        out_path = argv[optind];
+        break;
+      case 'p':
+        cfg.period_ms = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'r':
+        cfg.max_range_m = strtof(argv[optind], NULL);
+        break;
+      case 's':
+        nof_seconds = strtod(argv[optind], NULL);
+        break;
+      case 'u':
+        cfg.sensing = false;
+        break;
+      case 'v':
+        cfg.speed_kmph = strtof(argv[optind], NULL);
+        break;
+      case 'x':
+        cfg.seed = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  if (nof_seconds <= 0) {
+    usage(argv[0]);
+    exit(-1);
+  }
+}
+
+/* Reads the sinr_db,bler rows of a CSV file, lines that do not parse, like a header, are skipped */
+static int load_bler(srsran_ue_sl_sim_t* q, srsran_ue_sl_sim_channel_t channel, const char* path)
+{
+  FILE* f = fopen(path, "r");
+  if (f == NULL) {
+    ERROR("Error opening %s\n", path);
+    return SRSRAN_ERROR;
+  }
+
+  float    sinr_db[MAX_BLER_POINTS];
+  float    bler[MAX_BLER_POINTS];
+  uint32_t nof_points = 0;
+  char     line[256];
+  while (fgets(line, sizeof(line), f) != NULL) {
+    if (nof_points == MAX_BLER_POINTS) {
+      ERROR("At most %d points are supported in %s\n", MAX_BLER_POINTS, path);
+      fclose(f);
+      return SRSRAN_ERROR;
+    }
+    if (sscanf(line, "%f,%f", &sinr_db[nof_points], &bler[nof_points]) == 2) {
+      nof_points++;
+    }
+  }
+  fclose(f);
+
+  if (srsran_ue_sl_sim_set_bler(q, channel, sinr_db, bler, nof_points) != SRSRAN_SUCCESS) {
+    ERROR("Invalid BLER curve in %s\n", path);
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+static void print_count(FILE* f, const char* dimension, double bucket, const srsran_ue_sl_sim_count_t* c)
+{
+  if (c->nof_tx == 0) {
+    return;
+  }
+  fprintf(f,
+          "sim,%s,%g,%" PRIu64 ",%" PRIu64 ",%.4f\n",
+          dimension,
+          bucket,
+          c->nof_tx,
+          c->nof_rx,
+          (double)c->nof_rx / c->nof_tx);
+}
+
+int main(int argc, char** argv)
+{
+  srsran_ue_sl_sim_cfg_default(&cfg);
+  parse_args(argc, argv);
+
+  srsran_sl_comm_resource_pool_t pool = {};
+  if (srsran_sl_comm_resource_pool_get_default_config(&pool, cell) != SRSRAN_SUCCESS) {
+    ERROR("Error getting the default resource pool of %d PRB\n", cell.nof_prb);
+    exit(-1);
+  }
+
+  static srsran_ue_sl_sim_t q = {};
+  if (srsran_ue_sl_sim_init(&q, &cfg, cell, &pool) != SRSRAN_SUCCESS) {
+    ERROR("Error initializing the simulation\n");
+    exit(-1);
+  }
+  for (uint32_t i = 0; i < SRSRAN_UE_SL_SIM_NOF_CHANNELS; i++) {
+    if (bler_path[i] && load_bler(&q, (srsran_ue_sl_sim_channel_t)i, bler_path[i]) != SRSRAN_SUCCESS) {
+      srsran_ue_sl_sim_free(&q);
+      exit(-1);
+    }
+  }
+
+  FILE* out = stdout;
+  if (out_path) {
+    out = fopen(out_path, "w");
+    if (out == NULL) {
+      ERROR("Error opening %s\n", out_path);
+      srsran_ue_sl_sim_free(&q);
+      exit(-1);
+    }
+  }
+
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+  if (srsran_ue_sl_sim_run(&q, (uint64_t)(nof_seconds * 1000)) != SRSRAN_SUCCESS) {
+    ERROR("Error running the simulation\n");
+    srsran_ue_sl_sim_free(&q);
+    exit(-1);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+
+  srsran_ue_sl_sim_stats_t s = {};
+  srsran_ue_sl_sim_get_stats(&q, &s);
+
+  srsran_ue_sl_sim_count_t total = {};
+  for (uint32_t k = 0; k < s.nof_buckets; k++) {
+    total.nof_tx += s.distance[k].nof_tx;
+    total.nof_rx += s.distance[k].nof_rx;
+  }
+  fprintf(out, "rx_log,dimension,bucket,nof_tx,nof_rx,prr\n");
+  print_count(out, "total", 0, &total);
+  for (uint32_t k = 0; k < s.nof_buckets; k++) {
+    print_count(out, "distance_m", k * cfg.distance_bucket_m, &s.distance[k]);
+  }
+
+  srsran_ue_sl_sim_fprint_stats(stderr, &q);
+  double elapsed = t[0].tv_sec + t[0].tv_usec * 1e-6;
+  fprintf(stderr,
+          "%.1f s simulated in %.2f s on %d threads, %.1f times real time, %.1f Mlinks/s\n",
+          nof_seconds,
+          elapsed,
+          cfg.nof_threads,
+          elapsed > 0 ? nof_seconds / elapsed : 0.0,
+          elapsed > 0 ? s.nof_links / elapsed / 1e6 : 0.0);
+
+  if (out != stdout) {
+    fclose(out);
+  }
+  srsran_ue_sl_sim_free(&q);
+  return SRSRAN_SUCCESS;
+}